@@ -112,6 +112,11 @@ TCLAP::ValueArg<int> arg_max_iters(
 TCLAP::ValueArg<double> arg_initial_lambda(
 	"", "initial-lambda", "Initial lambda parameter (optional, lev-marq)",
 	false, 0, "val", cmd);
+TCLAP::ValueArg<int> arg_num_threads(
+	"", "threads",
+	"Number of threads to build the linear system in each iteration "
+	"(optional, lev-marq). 0: all CPU cores",
+	false, 1, "N", cmd);
 TCLAP::SwitchArg arg_no_span(
 	"", "no-span", "Don't use dijkstra initial spanning tree guess (optional)",
 	cmd, false);
@@ -387,6 +392,7 @@ IMPLEMENT_OP_FUNCTION(op_levmarq)
 	params["profiler"] = verbose;
 	params["max_iterations"] = arg_max_iters.getValue();
 	params["initial_lambda"] = arg_initial_lambda.getValue();
+	params["num_threads"] = arg_num_threads.getValue();
 
 	graphslam::TResultInfoSpaLevMarq info;
 
@@ -18,12 +18,11 @@
 
 #include <mrpt/slam/CMetricMapBuilderICP.h>
 #include <mrpt/obs/CObservationOdometry.h>
-#include <mrpt/obs/CRawlog.h>
+#include <mrpt/obs/CRawlogStreamReader.h>
 #include <mrpt/opengl/COpenGLScene.h>
 #include <mrpt/opengl/CGridPlaneXY.h>
 #include <mrpt/opengl/stock_objects.h>
 #include <mrpt/config/CConfigFile.h>
-#include <mrpt/io/CFileGZInputStream.h>
 #include <mrpt/io/CFileOutputStream.h>
 #include <mrpt/config/CConfigFile.h>
 #include <mrpt/system/os.h>
@@ -220,8 +219,7 @@ void MapBuilding_ICP(
 	COccupancyGridMap2D::TEntropyInfo entropy;
 
 	size_t rawlogEntry = 0;
-	CFileGZInputStream rawlogFile(RAWLOG_FILE);
-	auto rawlogFileArch = mrpt::serialization::archiveFrom(rawlogFile);
+	CRawlogStreamReader rawlogFile(RAWLOG_FILE);
 
 	// Prepare output directory:
 	// --------------------------------
@@ -266,8 +264,8 @@ void MapBuilding_ICP(
 
 		// Load action/observation pair from the rawlog:
 		// --------------------------------------------------
-		if (!CRawlog::getActionObservationPairOrObservation(
-				rawlogFileArch, action, observations, observation, rawlogEntry))
+		if (!rawlogFile.getActionObservationPairOrObservation(
+				action, observations, observation, rawlogEntry))
 			break;  // file EOF
 
 		const bool isObsBasedRawlog = observation ? true : false;
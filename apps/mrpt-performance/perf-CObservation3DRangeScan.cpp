@@ -56,6 +56,9 @@ double obs3d_test_depth_to_3d(int a, int b)
 	T3DPointsProjectionParams pp;
 	pp.PROJ3D_USE_LUT = (a & 0x01) != 0;
 	pp.USE_SSE2 = (a & 0x02) != 0;
+	pp.numThreads = (a & 0x04) != 0 ? 0 : 1;
+	pp.decimation = (a & 0x08) != 0 ? 2 : 1;
+	pp.takeIntoAccountSensorPoseOnRobot = (a & 0x10) != 0;
 
 	TRangeImageFilterParams fp;
 	mrpt::math::CMatrix minF, maxF;
@@ -207,6 +210,29 @@ void register_tests_CObservation3DRangeScan()
 				"3DRangeScan: 320x240 Depth->3D (LUT,w/SSE2,min/maxFilter)",
 				obs3d_test_depth_to_3d, 0x03, 0x03));
 
+		lstTests.push_back(
+			TestData(
+				"3DRangeScan: 320x240 Depth->3D (LUT,w/SSE2,sensorPose)",
+				obs3d_test_depth_to_3d, 0x13, 0));
+		lstTests.push_back(
+			TestData(
+				"3DRangeScan: 320x240 Depth->3D (all threads,sensorPose)",
+				obs3d_test_depth_to_3d, 0x14, 0));
+		lstTests.push_back(
+			TestData(
+				"3DRangeScan: 320x240 Depth->3D (all threads,sensorPose,"
+				"min/maxFilter)",
+				obs3d_test_depth_to_3d, 0x14, 0x03));
+		lstTests.push_back(
+			TestData(
+				"3DRangeScan: 320x240 Depth->3D (decimation=2,sensorPose)",
+				obs3d_test_depth_to_3d, 0x18, 0));
+		lstTests.push_back(
+			TestData(
+				"3DRangeScan: 320x240 Depth->3D (all threads,decimation=2,"
+				"sensorPose)",
+				obs3d_test_depth_to_3d, 0x1C, 0));
+
 		lstTests.push_back(
 			TestData(
 				"3DRangeScan: 320x240 Depth->2D scan",
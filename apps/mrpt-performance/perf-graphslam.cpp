@@ -57,6 +57,38 @@ double graphslam_levmarq_solve(int nVertices, int N)
 	return ret;
 }
 
+// a1: number of threads
+template <class GRAPH_TYPE>
+double graphslam_levmarq_solve_threads(int a1, int a2)
+{
+	MRPT_UNUSED_PARAM(a2);
+	const int N = 3;
+
+	GRAPH_TYPE graph;
+	GraphSlamLevMarqTest<GRAPH_TYPE>::create_ring_path(graph, 1000);
+
+	mrpt::system::TParametersDouble params;
+	params["max_iterations"] = 1000;
+	params["num_threads"] = a1;
+
+	CTimeLogger timer;
+
+	for (long i = 0; i < N; i++)
+	{
+		GRAPH_TYPE graph0 = graph;
+
+		graphslam::TResultInfoSpaLevMarq levmarq_info;
+
+		timer.enter("test");
+		graphslam::optimize_graph_spa_levmarq(
+			graph0, levmarq_info, nullptr, params);
+		timer.leave("test");
+	}
+	const double ret = timer.getMeanTime("test");
+	timer.clear(true);  // this disables dump to cout upon destruction
+	return ret;
+}
+
 // ------------------------------------------------------
 // register_tests_graphslam
 // ------------------------------------------------------
@@ -71,6 +103,18 @@ void register_tests_graphslam()
 		TestData(
 			"graphslam(2d): levmarq 100 KFs/451 edges",
 			graphslam_levmarq_solve<CNetworkOfPoses2D>, 100, 2));
+	lstTests.push_back(
+		TestData(
+			"graphslam(2d): levmarq 1000 KFs, 1 thread",
+			graphslam_levmarq_solve_threads<CNetworkOfPoses2DInf>, 1));
+	lstTests.push_back(
+		TestData(
+			"graphslam(2d): levmarq 1000 KFs, 4 threads",
+			graphslam_levmarq_solve_threads<CNetworkOfPoses2DInf>, 4));
+	lstTests.push_back(
+		TestData(
+			"graphslam(2d): levmarq 1000 KFs, all cores",
+			graphslam_levmarq_solve_threads<CNetworkOfPoses2DInf>, 0));
 	lstTests.push_back(
 		TestData(
 			"graphslam(3d): levmarq 50 KFs/101 edges",
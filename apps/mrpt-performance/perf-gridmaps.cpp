@@ -128,6 +128,42 @@ double grid_test_5_6(int a1, int a2)
 	return tictac.Tac() / N;
 }
 
+// a1: number of threads
+double grid_test_5_threads(int a1, int a2)
+{
+	getRandomGenerator().randomize(333);
+
+	// prepare a 1080-beam laser scan:
+	const size_t nRays = 1080;
+	CObservation2DRangeScan scan1;
+	scan1.aperture = DEG2RAD(270.0f);
+	scan1.rightToLeft = true;
+	scan1.resizeScan(nRays);
+	for (size_t i = 0; i < nRays; i++)
+	{
+		scan1.setScanRange(
+			i, SCAN_RANGES_1[i * sizeof(SCAN_RANGES_1) /
+							 sizeof(SCAN_RANGES_1[0]) / nRays]);
+		scan1.setScanRangeValidity(i, true);
+	}
+
+	COccupancyGridMap2D gridmap(-20, 20, -20, 20, 0.05f);
+	gridmap.insertionOptions.numThreads = a1;
+	const long N = 1000;
+	CTicTac tictac;
+	for (long i = 0; i < N; i++)
+	{
+		CPose2D pose(
+			getRandomGenerator().drawUniform(-1.0, 1.0),
+			getRandomGenerator().drawUniform(-1.0, 1.0),
+			getRandomGenerator().drawUniform(-M_PI, M_PI));
+		CPose3D pose3D(pose);
+
+		gridmap.insertObservation(&scan1, &pose3D);
+	}
+	return tictac.Tac() / N;
+}
+
 double grid_test_7(int a1, int a2)
 {
 	COccupancyGridMap2D gridmap(-20, 20, -20, 20, 0.05f);
@@ -171,6 +207,43 @@ double grid_test_8(int a1, int a2)
 	return tictac.Tac() / N;
 }
 
+double grid_test_8b(int a1, int a2)
+{
+	getRandomGenerator().randomize(333);
+
+	// prepare the laser scan:
+	CObservation2DRangeScan scan1;
+	scan1.aperture = M_PIf;
+	scan1.rightToLeft = true;
+	scan1.loadFromVectors(
+		sizeof(SCAN_RANGES_1) / sizeof(SCAN_RANGES_1[0]), SCAN_RANGES_1,
+		SCAN_VALID_1);
+
+	COccupancyGridMap2D gridmap(-20, 20, -20, 20, 0.05f);
+
+	// test 8b: Likelihood computation, batch of poses
+	const long N = 5000;
+
+	CPose3D pose3D(0, 0, 0);
+	gridmap.insertObservation(&scan1, &pose3D);
+
+	std::vector<mrpt::math::TPose2D> poses(N);
+	for (long i = 0; i < N; i++)
+		poses[i] = mrpt::math::TPose2D(
+			getRandomGenerator().drawUniform(-1.0, 1.0),
+			getRandomGenerator().drawUniform(-1.0, 1.0),
+			getRandomGenerator().drawUniform(-M_PI, M_PI));
+
+	// Warm up (the likelihood field is built on the first call):
+	std::vector<double> liks;
+	gridmap.computeObservationLikelihoodBatch(&scan1, poses, liks);
+
+	CTicTac tictac;
+	for (long i = 0; i < a1; i++)
+		gridmap.computeObservationLikelihoodBatch(&scan1, poses, liks);
+	return tictac.Tac() / (N * a1);
+}
+
 double grid_test_9(int a1, int a2)
 {
 	// test 9: computeMatchingWith2D
@@ -227,8 +300,27 @@ void register_tests_grids()
 		TestData("gridmap2D: insert scan w/o widening", grid_test_5_6, 0));
 	lstTests.push_back(
 		TestData("gridmap2D: insert scan with widening", grid_test_5_6, 1));
+	lstTests.push_back(
+		TestData(
+			"gridmap2D: insert 1080-ray scan, 1 thread", grid_test_5_threads,
+			1));
+	lstTests.push_back(
+		TestData(
+			"gridmap2D: insert 1080-ray scan, 2 threads", grid_test_5_threads,
+			2));
+	lstTests.push_back(
+		TestData(
+			"gridmap2D: insert 1080-ray scan, 4 threads", grid_test_5_threads,
+			4));
+	lstTests.push_back(
+		TestData(
+			"gridmap2D: insert 1080-ray scan, all cores", grid_test_5_threads,
+			0));
 	lstTests.push_back(TestData("gridmap2D: resize", grid_test_7));
 	lstTests.push_back(TestData("gridmap2D: computeLikelihood", grid_test_8));
+	lstTests.push_back(
+		TestData(
+			"gridmap2D: computeLikelihood batch (per pose)", grid_test_8b, 10));
 	lstTests.push_back(
 		TestData("gridmap2D: determineMatching2D", grid_test_9, 5000));
 }
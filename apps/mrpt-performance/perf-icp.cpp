@@ -13,6 +13,7 @@
 #include <mrpt/maps/CMultiMetricMap.h>
 #include <mrpt/io/CFileGZInputStream.h>
 #include <mrpt/obs/CRawlog.h>
+#include <mrpt/slam/CICP.h>
 
 #include "common.h"
 
@@ -124,6 +125,61 @@ double icp_test_1(int a1, int a2)
 #endif
 }
 
+// ------------------------------------------------------
+//  Benchmark: 3D ICP between two random clouds
+//  a1: number of threads (CICP::TConfigParams::matching_num_threads)
+//  a2: ICP algorithm (TICPAlgorithm)
+// ------------------------------------------------------
+double icp_test_3d_threads(int a1, int a2)
+{
+	getRandomGenerator().randomize(123);
+
+	// Points on the walls, floor and ceiling of a 20x10x3 m room:
+	const size_t N = 100000;
+	CSimplePointsMap m1, m2;
+	m1.reserve(N);
+	for (size_t i = 0; i < N; i++)
+	{
+		float x = getRandomGenerator().drawUniform(-10.0f, 10.0f);
+		float y = getRandomGenerator().drawUniform(-5.0f, 5.0f);
+		float z = getRandomGenerator().drawUniform(0.0f, 3.0f);
+		switch (i % 4)
+		{
+			case 0:
+				x = (i & 4) ? 10.0f : -10.0f;
+				break;
+			case 1:
+				y = (i & 4) ? 5.0f : -5.0f;
+				break;
+			case 2:
+				z = 0;
+				break;
+			default:
+				z = 3.0f;
+				break;
+		};
+		m1.insertPointFast(x, y, z);
+	}
+	m2.changeCoordinatesReference(
+		m1, mrpt::poses::CPose3D(0.2, -0.1, 0.05, DEG2RAD(3.0), 0, 0));
+
+	CICP icp;
+	icp.options.corresponding_points_decimation = 1;
+	icp.options.maxIterations = 20;
+	icp.options.skip_cov_calculation = true;
+	icp.options.matching_num_threads = a1;
+	icp.options.ICP_algorithm = static_cast<TICPAlgorithm>(a2);
+
+	const long REPS = 5;
+	CTicTac tictac;
+	for (long i = 0; i < REPS; i++)
+	{
+		CICP::TReturnInfo info;
+		icp.Align3D(&m1, &m2, mrpt::poses::CPose3D(), nullptr, &info);
+	}
+	return tictac.Tac() / REPS;
+}
+
 // ------------------------------------------------------
 // register_tests_icpslam
 // ------------------------------------------------------
@@ -135,4 +191,20 @@ void register_tests_icpslam()
 	lstTests.push_back(
 		TestData(
 			"icp-slam (match grid): Run with sample dataset", icp_test_1, 1));
+	lstTests.push_back(
+		TestData("icp3D: 100k points, 1 thread", icp_test_3d_threads, 1));
+	lstTests.push_back(
+		TestData("icp3D: 100k points, 2 threads", icp_test_3d_threads, 2));
+	lstTests.push_back(
+		TestData("icp3D: 100k points, 4 threads", icp_test_3d_threads, 4));
+	lstTests.push_back(
+		TestData("icp3D: 100k points, all cores", icp_test_3d_threads, 0));
+	lstTests.push_back(
+		TestData(
+			"icp3D point-to-plane: 100k points, all cores",
+			icp_test_3d_threads, 0, icpPointToPlane));
+	lstTests.push_back(
+		TestData(
+			"icp3D generalized: 100k points, all cores", icp_test_3d_threads,
+			0, icpGeneralized));
 }
@@ -0,0 +1,156 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/slam/CMonteCarloLocalization2D.h>
+#include <mrpt/slam/CBranchAndBoundScanMatcher.h>
+#include <mrpt/bayes/CParticleFilter.h>
+#include <mrpt/maps/COccupancyGridMap2D.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/obs/CObservation2DRangeScan.h>
+#include <mrpt/obs/CActionCollection.h>
+#include <mrpt/obs/CActionRobotMovement2D.h>
+#include <mrpt/obs/CSensoryFrame.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/random.h>
+
+#include "common.h"
+
+using namespace mrpt;
+using namespace mrpt::bayes;
+using namespace mrpt::slam;
+using namespace mrpt::maps;
+using namespace mrpt::obs;
+using namespace mrpt::poses;
+using namespace mrpt::random;
+using namespace std;
+
+// ------------------------------------------------------
+//  Benchmark: one MCL step (prediction + likelihood-field weighting)
+//  a1: number of particles, a2: number of threads (PF_options.numThreads)
+// ------------------------------------------------------
+double pf_test_mcl2d_step(int a1, int a2)
+{
+	getRandomGenerator().randomize(333);
+
+	CObservation2DRangeScan::Ptr scan =
+		mrpt::make_aligned_shared<CObservation2DRangeScan>();
+	scan->aperture = M_PIf;
+	scan->rightToLeft = true;
+	scan->loadFromVectors(
+		sizeof(SCAN_RANGES_1) / sizeof(SCAN_RANGES_1[0]), SCAN_RANGES_1,
+		SCAN_VALID_1);
+
+	COccupancyGridMap2D gridmap(-20, 20, -20, 20, 0.05f);
+	gridmap.likelihoodOptions.likelihoodMethod =
+		COccupancyGridMap2D::lmLikelihoodField_Thrun;
+	const CPose3D pose0(0, 0, 0);
+	gridmap.insertObservation(scan.get(), &pose0);
+
+	CSensoryFrame sf;
+	sf.insert(scan);
+
+	CActionCollection acts;
+	{
+		CActionRobotMovement2D act;
+		act.computeFromOdometry(
+			CPose2D(0.1, 0, DEG2RAD(1.0)),
+			CActionRobotMovement2D::TMotionModelOptions());
+		acts.insert(act);
+	}
+
+	CMonteCarloLocalization2D pdf(a1);
+	pdf.options.metricMap = &gridmap;
+	pdf.resetUniform(-1.0, 1.0, -1.0, 1.0, -M_PI, M_PI, a1);
+
+	CParticleFilter pf;
+	pf.m_options.PF_algorithm = CParticleFilter::pfStandardProposal;
+	pf.m_options.adaptiveSampleSize = false;
+	pf.m_options.numThreads = a2;
+
+	// Warm up (creates the thread pool, likelihood caches, etc.):
+	pf.executeOn(pdf, &acts, &sf);
+
+	const long N = 10;
+	CTicTac tictac;
+	for (long i = 0; i < N; i++) pf.executeOn(pdf, &acts, &sf);
+	return tictac.Tac() / N;
+}
+
+// ------------------------------------------------------
+//  Benchmark: global relocalization of one scan in the whole grid map with
+//  CBranchAndBoundScanMatcher
+//  a1: number of pyramid levels
+// ------------------------------------------------------
+double pf_test_bnb_relocalization(int a1, int a2)
+{
+	MRPT_UNUSED_PARAM(a2);
+
+	CObservation2DRangeScan scan;
+	scan.aperture = M_PIf;
+	scan.rightToLeft = true;
+	scan.loadFromVectors(
+		sizeof(SCAN_RANGES_1) / sizeof(SCAN_RANGES_1[0]), SCAN_RANGES_1,
+		SCAN_VALID_1);
+
+	COccupancyGridMap2D gridmap(-20, 20, -20, 20, 0.05f);
+	const CPose3D pose0(0, 0, 0);
+	gridmap.insertObservation(&scan, &pose0);
+
+	CSimplePointsMap pts;
+	pts.insertionOptions.minDistBetweenLaserPoints = gridmap.getResolution();
+	pts.insertObservation(&scan);
+
+	CBranchAndBoundScanMatcher matcher;
+	matcher.options.pyramid_levels = a1;
+	CBranchAndBoundScanMatcher::TResult res;
+
+	// Warm up (builds the resolution pyramid):
+	matcher.matchGlobal(gridmap, pts, res);
+
+	const long N = 3;
+	CTicTac tictac;
+	for (long i = 0; i < N; i++) matcher.matchGlobal(gridmap, pts, res);
+	return tictac.Tac() / N;
+}
+
+// ------------------------------------------------------
+// register_tests_pf_localization
+// ------------------------------------------------------
+void register_tests_pf_localization()
+{
+	lstTests.push_back(
+		TestData("MCL2D step: 5k particles, 1 thread", pf_test_mcl2d_step,
+				 5000, 1));
+	lstTests.push_back(
+		TestData("MCL2D step: 5k particles, 2 threads", pf_test_mcl2d_step,
+				 5000, 2));
+	lstTests.push_back(
+		TestData("MCL2D step: 5k particles, 4 threads", pf_test_mcl2d_step,
+				 5000, 4));
+	lstTests.push_back(
+		TestData("MCL2D step: 5k particles, 8 threads", pf_test_mcl2d_step,
+				 5000, 8));
+	lstTests.push_back(
+		TestData("MCL2D step: 20k particles, 1 thread", pf_test_mcl2d_step,
+				 20000, 1));
+	lstTests.push_back(
+		TestData("MCL2D step: 20k particles, 4 threads", pf_test_mcl2d_step,
+				 20000, 4));
+	lstTests.push_back(
+		TestData("MCL2D step: 20k particles, all cores", pf_test_mcl2d_step,
+				 20000, 0));
+	lstTests.push_back(
+		TestData(
+			"MCL2D global relocalization: branch-and-bound, 5 levels",
+			pf_test_bnb_relocalization, 5));
+	lstTests.push_back(
+		TestData(
+			"MCL2D global relocalization: branch-and-bound, 7 levels",
+			pf_test_bnb_relocalization, 7));
+}
@@ -30,7 +30,7 @@
 #include <mrpt/obs/CActionRobotMovement2D.h>
 #include <mrpt/obs/CActionCollection.h>
 #include <mrpt/obs/CObservationOdometry.h>
-#include <mrpt/obs/CRawlog.h>
+#include <mrpt/obs/CRawlogStreamReader.h>
 #include <mrpt/maps/CSimpleMap.h>
 #include <mrpt/maps/COccupancyGridMap2D.h>
 #include <mrpt/maps/CMultiMetricMap.h>
@@ -43,6 +43,8 @@
 #include <mrpt/io/CFileOutputStream.h>
 #include <mrpt/io/CFileGZOutputStream.h>
 #include <mrpt/io/CFileGZInputStream.h>
+#include <mrpt/io/CFileMappedInputStream.h>
+#include <mrpt/io/zip.h>
 
 #include <mrpt/opengl/CGridPlaneXY.h>
 #include <mrpt/opengl/CPointCloud.h>
@@ -246,15 +248,27 @@ void do_pf_localization(
 		string mapExt = lowerCase(extractFileExtension(
 			MAP_FILE, true));  // Ignore possible .gz extensions
 
+		// Uncompressed files are mapped into memory:
+		auto loadMapFile = [&MAP_FILE](auto& obj) {
+			if (!mrpt::io::zip::is_gz_file(MAP_FILE))
+			{
+				CFileMappedInputStream f(
+					MAP_FILE, CFileMappedInputStream::ahWillNeed);
+				archiveFrom(f) >> obj;
+			}
+			else
+			{
+				CFileGZInputStream f(MAP_FILE);
+				archiveFrom(f) >> obj;
+			}
+		};
+
 		if (!mapExt.compare("simplemap"))
 		{
 			// It's a ".simplemap":
 			// -------------------------
 			printf("Loading '.simplemap' file...");
-			{
-				CFileGZInputStream f(MAP_FILE);
-				archiveFrom(f) >> simpleMap;
-			}
+			loadMapFile(simpleMap);
 			printf("Ok\n");
 
 			ASSERT_(simpleMap.size() > 0);
@@ -271,10 +285,7 @@ void do_pf_localization(
 			// -------------------------
 			printf("Loading gridmap from '.gridmap'...");
 			ASSERT_(metricMap.m_gridMaps.size() == 1);
-			{
-				CFileGZInputStream f(MAP_FILE);
-				archiveFrom(f) >> (*metricMap.m_gridMaps[0]);
-			}
+			loadMapFile(*metricMap.m_gridMaps[0]);
 			printf("Ok\n");
 		}
 		else
@@ -383,7 +394,7 @@ void do_pf_localization(
 			// Load the rawlog:
 			// --------------------------
 			printf("Opening the rawlog file...");
-			CFileGZInputStream rawlog_in_stream(RAWLOG_FILE);
+			CRawlogStreamReader rawlog_in_stream(RAWLOG_FILE);
 			printf("OK\n");
 
 			// The experiment directory is:
@@ -488,8 +499,6 @@ void do_pf_localization(
 			CPose2D last_used_abs_odo(0, 0, 0),
 				pending_most_recent_odo(0, 0, 0);
 
-			auto arch = archiveFrom(rawlog_in_stream);
-
 			while (!end)
 			{
 				// Finish if ESC is pushed:
@@ -502,8 +511,7 @@ void do_pf_localization(
 				CSensoryFrame::Ptr observations;
 				CObservation::Ptr obs;
 
-				if (!CRawlog::getActionObservationPairOrObservation(
-						arch,  // In stream
+				if (!rawlog_in_stream.getActionObservationPairOrObservation(
 						action, observations,  // Out pair <action,SF>, or:
 						obs,  // Out single observation
 						rawlogEntry  // In/Out index counter.
@@ -15,6 +15,7 @@
 #include <mrpt/img/CImage.h>
 #include <mrpt/system/filesystem.h>
 #include <mrpt/obs/CObservation.h>
+#include <mrpt/obs/CIndexedRawlog.h>
 #include "CRawlogProcessor.h"
 
 // Declarations:
@@ -26,6 +27,12 @@
 		mrpt::io::CFileGZInputStream& in_rawlog, TCLAP::CmdLine& cmdline, \
 		bool verbose)
 
+/** Operations on indexed rawlogs (see mrpt::obs::CIndexedRawlogReader) */
+#define DECLARE_INDEXED_OP_FUNCTION(_NAME)                                   \
+	void _NAME(                                                              \
+		mrpt::obs::CIndexedRawlogReader& in_rawlog, TCLAP::CmdLine& cmdline, \
+		bool verbose)
+
 /** Auxiliary struct that performs all the checks and create the
 	 output rawlog stream, publishing it as "out_rawlog"
 */
@@ -38,6 +45,15 @@ struct TOutputRawlogCreator
 	TOutputRawlogCreator();
 };
 
+/** Like TOutputRawlogCreator, for an indexed output rawlog */
+struct TOutputIndexedRawlogCreator
+{
+	mrpt::obs::CIndexedRawlogWriter out_rawlog;
+	std::string out_rawlog_filename;
+
+	TOutputIndexedRawlogCreator();
+};
+
 // ======================================================================
 //  Search for a specific command-line argument.
 // Return false if not not set, an exception if args doesn't exist
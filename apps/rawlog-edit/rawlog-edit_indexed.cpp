@@ -0,0 +1,263 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "rawlog-edit-declarations.h"
+
+#include <mrpt/obs/CSensoryFrame.h>
+#include <mrpt/obs/CActionCollection.h>
+#include <mrpt/obs/CObservationComment.h>
+#include <mrpt/system/string_utils.h>
+#include <algorithm>
+#include <fstream>
+
+using namespace mrpt;
+using namespace mrpt::obs;
+using namespace mrpt::system;
+using namespace mrpt::rawlogtools;
+using namespace mrpt::serialization;
+using namespace std;
+using namespace mrpt::io;
+
+// ======================================================================
+//		op_to_indexed
+// ======================================================================
+DECLARE_OP_FUNCTION(op_to_indexed)
+{
+	TOutputIndexedRawlogCreator outrawlog;
+	auto in = archiveFrom(in_rawlog);
+
+	const auto t0 = mrpt::system::now();
+	for (;;)
+	{
+		CSerializable::Ptr obj;
+		try
+		{
+			in >> obj;
+		}
+		catch (CExceptionEOF&)
+		{
+			break;
+		}
+		catch (std::exception& e)
+		{
+			cerr << "[rawlog-edit] Stopping after an error reading the input:\n"
+				 << e.what() << endl;
+			break;
+		}
+		outrawlog.out_rawlog.write(*obj);
+	}
+	const size_t nEntries = outrawlog.out_rawlog.size();
+	outrawlog.out_rawlog.close();
+
+	VERBOSE_COUT << "Time to process file (sec)        : "
+				 << mrpt::system::timeDifference(t0, mrpt::system::now())
+				 << "\n";
+	VERBOSE_COUT << "Written entries                   : " << nEntries << "\n";
+}
+
+// ======================================================================
+//		op_indexed_to_plain
+// ======================================================================
+DECLARE_INDEXED_OP_FUNCTION(op_indexed_to_plain)
+{
+	TOutputRawlogCreator outrawlog;
+	std::vector<uint8_t> data;
+	for (size_t i = 0; i < in_rawlog.size(); i++)
+	{
+		// A plain rawlog is just the sequence of serialized entries:
+		in_rawlog.getSerializedEntry(i, data);
+		outrawlog.out_rawlog_io.Write(data.data(), data.size());
+	}
+	VERBOSE_COUT << "Written entries                   : " << in_rawlog.size()
+				 << "\n";
+}
+
+// ======================================================================
+//		op_indexed_cut
+// ======================================================================
+DECLARE_INDEXED_OP_FUNCTION(op_indexed_cut)
+{
+	size_t from_index = 0, to_index = 0;
+	double from_time = 0, to_time = 0;
+	const bool has_from_index =
+		getArgValue<size_t>(cmdline, "from-index", from_index);
+	const bool has_to_index = getArgValue<size_t>(cmdline, "to-index", to_index);
+	const bool has_from_time =
+		getArgValue<double>(cmdline, "from-time", from_time);
+	const bool has_to_time = getArgValue<double>(cmdline, "to-time", to_time);
+
+	if (!has_from_index && !has_to_index && !has_from_time && !has_to_time)
+		throw std::runtime_error(
+			"cut: This operation needs at least one of: --from-index, "
+			"--from-time, --to-index, --to-time.");
+
+	// Range of indices:
+	const size_t N = in_rawlog.size();
+	if (!has_from_index) from_index = 0;
+	if (!has_to_index || to_index >= N) to_index = N ? N - 1 : 0;
+
+	std::vector<size_t> entries;
+	// The leading rawlog comment, if any, is always kept:
+	const bool hasComment = N && in_rawlog.getEntryInfo(0).className ==
+									 CLASS_ID(CObservationComment)->className;
+	if (hasComment) entries.push_back(0);
+	if (has_from_time || has_to_time)
+	{
+		// Time range, looked up in the index:
+		const auto found = in_rawlog.findEntriesInTimeRange(
+			has_from_time ? time_tToTimestamp(from_time) : 0,
+			has_to_time ? time_tToTimestamp(to_time)
+						: std::numeric_limits<TTimeStamp>::max());
+		for (const size_t i : found)
+			if (i >= from_index && i <= to_index && (i || !hasComment))
+				entries.push_back(i);
+	}
+	else
+	{
+		for (size_t i = from_index; i <= to_index && i < N; i++)
+			if (i || !hasComment) entries.push_back(i);
+	}
+
+	TOutputIndexedRawlogCreator outrawlog;
+	std::vector<uint8_t> data;
+	for (const size_t i : entries)
+	{
+		in_rawlog.getSerializedEntry(i, data);
+		outrawlog.out_rawlog.writeSerialized(
+			in_rawlog.getEntryInfo(i), data.data(), data.size());
+	}
+
+	VERBOSE_COUT << "Analyzed entries                  : " << N << "\n";
+	VERBOSE_COUT << "Removed entries                   : "
+				 << N - entries.size() << "\n";
+}
+
+// Whether the entry is an observation subject to label filters (all but the
+// rawlog comments)
+static bool isFilteredObservation(const TIndexedRawlogEntry& e)
+{
+	const auto cls = mrpt::rtti::findRegisteredClass(e.className);
+	return cls && cls->derivedFrom(CLASS_ID(CObservation)) &&
+		   e.className != CLASS_ID(CObservationComment)->className;
+}
+
+// ======================================================================
+//  Keeps or removes the observations with the given sensor labels.
+//  Observations are filtered with the index alone, only sensory frames
+//  have to be deserialized.
+// ======================================================================
+static void filterIndexedByLabels(
+	CIndexedRawlogReader& in_rawlog, const std::string& labels_str,
+	const bool keep, const bool verbose)
+{
+	vector<string> labels;
+	mrpt::system::tokenize(labels_str, " ,", labels);
+	ASSERT_(!labels.empty());
+	auto passes = [&](const std::string& label) {
+		const bool found =
+			std::find(labels.begin(), labels.end(), label) != labels.end();
+		return found == keep;
+	};
+
+	TOutputIndexedRawlogCreator outrawlog;
+	std::vector<uint8_t> data;
+	size_t removed = 0;
+	for (size_t i = 0; i < in_rawlog.size(); i++)
+	{
+		const TIndexedRawlogEntry& e = in_rawlog.getEntryInfo(i);
+		if (e.className == CLASS_ID(CSensoryFrame)->className)
+		{
+			auto sf = std::dynamic_pointer_cast<CSensoryFrame>(
+				in_rawlog.getEntry(i));
+			ASSERT_(sf);
+			for (auto it = sf->begin(); it != sf->end();)
+			{
+				if (passes((*it)->sensorLabel))
+					++it;
+				else
+				{
+					it = sf->erase(it);
+					removed++;
+				}
+			}
+			outrawlog.out_rawlog.write(*sf);
+		}
+		else if (isFilteredObservation(e) && !passes(e.sensorLabel))
+		{
+			removed++;
+		}
+		else
+		{
+			in_rawlog.getSerializedEntry(i, data);
+			outrawlog.out_rawlog.writeSerialized(e, data.data(), data.size());
+		}
+	}
+
+	VERBOSE_COUT << "Analyzed entries                  : " << in_rawlog.size()
+				 << "\n";
+	VERBOSE_COUT << "Removed observations              : " << removed << "\n";
+}
+
+DECLARE_INDEXED_OP_FUNCTION(op_indexed_keep_label)
+{
+	string labels;
+	if (!getArgValue<string>(cmdline, "keep-label", labels) || labels.empty())
+		throw std::runtime_error(
+			"keep-label: This operation needs a non-empty argument.");
+	filterIndexedByLabels(in_rawlog, labels, true, verbose);
+}
+
+DECLARE_INDEXED_OP_FUNCTION(op_indexed_remove_label)
+{
+	string labels;
+	if (!getArgValue<string>(cmdline, "remove-label", labels) ||
+		labels.empty())
+		throw std::runtime_error(
+			"remove-label: This operation needs a non-empty argument.");
+	filterIndexedByLabels(in_rawlog, labels, false, verbose);
+}
+
+// ======================================================================
+//		op_indexed_list_timestamps
+// ======================================================================
+DECLARE_INDEXED_OP_FUNCTION(op_indexed_list_timestamps)
+{
+	string out_file;
+	getArgValue<std::string>(cmdline, "text-file-output", out_file);
+	VERBOSE_COUT << "Writing list to: " << out_file << endl;
+
+	std::ofstream out(out_file.c_str());
+	if (!out.is_open())
+		throw std::runtime_error(
+			"list-timestamps: Cannot open output text file.");
+
+	for (size_t i = 0; i < in_rawlog.size(); i++)
+	{
+		const TIndexedRawlogEntry& e = in_rawlog.getEntryInfo(i);
+		if (e.className == CLASS_ID(CSensoryFrame)->className)
+		{
+			auto sf = std::dynamic_pointer_cast<CSensoryFrame>(
+				in_rawlog.getEntry(i));
+			ASSERT_(sf);
+			for (const auto& obs : *sf)
+				out << std::fixed
+					<< mrpt::system::timestampToDouble(obs->timestamp) << " "
+					<< obs->sensorLabel << " "
+					<< obs->GetRuntimeClass()->className << std::endl;
+		}
+		else if (
+			e.timestamp != INVALID_TIMESTAMP &&
+			e.className != CLASS_ID(CActionCollection)->className)
+		{
+			// An observation, straight from the index:
+			out << std::fixed << mrpt::system::timestampToDouble(e.timestamp)
+				<< " " << e.sensorLabel << " " << e.className << std::endl;
+		}
+	}
+}
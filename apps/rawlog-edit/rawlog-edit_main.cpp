@@ -30,6 +30,9 @@
 using TOperationFunctor = void (*)(
 	mrpt::io::CFileGZInputStream& in_rawlog, TCLAP::CmdLine& cmdline,
 	bool verbose);
+using TIndexedOperationFunctor = void (*)(
+	mrpt::obs::CIndexedRawlogReader& in_rawlog, TCLAP::CmdLine& cmdline,
+	bool verbose);
 
 using namespace mrpt;
 using namespace mrpt::img;
@@ -67,6 +70,12 @@ DECLARE_OP_FUNCTION(op_stereo_rectify);
 DECLARE_OP_FUNCTION(op_rename_externals);
 DECLARE_OP_FUNCTION(op_list_timestamps);
 DECLARE_OP_FUNCTION(op_remap_timestamps);
+DECLARE_OP_FUNCTION(op_to_indexed);
+DECLARE_INDEXED_OP_FUNCTION(op_indexed_to_plain);
+DECLARE_INDEXED_OP_FUNCTION(op_indexed_cut);
+DECLARE_INDEXED_OP_FUNCTION(op_indexed_keep_label);
+DECLARE_INDEXED_OP_FUNCTION(op_indexed_remove_label);
+DECLARE_INDEXED_OP_FUNCTION(op_indexed_list_timestamps);
 
 // Declare the supported command line switches ===========
 TCLAP::CmdLine cmd(
@@ -155,6 +164,8 @@ int main(int argc, char** argv)
 	{
 		// --------------- List of possible operations ---------------
 		map<string, TOperationFunctor> ops_functors;
+		// Operations supported for indexed input rawlogs:
+		map<string, TIndexedOperationFunctor> indexed_ops_functors;
 
 		arg_ops.push_back(new TCLAP::SwitchArg(
 			"", "externalize",
@@ -195,6 +206,7 @@ int main(int argc, char** argv)
 			"--text-file-output.",
 			cmd, false));
 		ops_functors["list-timestamps"] = &op_list_timestamps;
+		indexed_ops_functors["list-timestamps"] = &op_indexed_list_timestamps;
 
 		arg_ops.push_back(new TCLAP::ValueArg<std::string>(
 			"", "remap-timestamps",
@@ -222,6 +234,7 @@ int main(int argc, char** argv)
 			"Requires: -o (or --output)",
 			false, "", "label[,label...]", cmd));
 		ops_functors["remove-label"] = &op_remove_label;
+		indexed_ops_functors["remove-label"] = &op_indexed_remove_label;
 
 		arg_ops.push_back(new TCLAP::ValueArg<std::string>(
 			"", "keep-label",
@@ -231,6 +244,7 @@ int main(int argc, char** argv)
 			"Requires: -o (or --output)",
 			false, "", "label[,label...]", cmd));
 		ops_functors["keep-label"] = &op_keep_label;
+		indexed_ops_functors["keep-label"] = &op_indexed_keep_label;
 
 		arg_ops.push_back(new TCLAP::SwitchArg(
 			"", "export-gps-kml",
@@ -364,6 +378,7 @@ int main(int argc, char** argv)
 			"from its beginning.\n",
 			cmd, false));
 		ops_functors["cut"] = &op_cut;
+		indexed_ops_functors["cut"] = &op_indexed_cut;
 
 		arg_ops.push_back(new TCLAP::SwitchArg(
 			"", "generate-3d-pointclouds",
@@ -427,6 +442,23 @@ int main(int argc, char** argv)
 			cmd, false));
 		ops_functors["rename-externals"] = &op_rename_externals;
 
+		arg_ops.push_back(new TCLAP::SwitchArg(
+			"", "to-indexed",
+			"Op: convert to an indexed rawlog, which supports random access "
+			"and fast --cut, --keep-label, --remove-label and "
+			"--list-timestamps operations.\n"
+			"Requires: -o (or --output)\n",
+			cmd, false));
+		ops_functors["to-indexed"] = &op_to_indexed;
+
+		arg_ops.push_back(new TCLAP::SwitchArg(
+			"", "to-plain",
+			"Op: convert an indexed rawlog back to a plain rawlog, for "
+			"the operations not supported for indexed rawlogs.\n"
+			"Requires: -o (or --output)\n",
+			cmd, false));
+		indexed_ops_functors["to-plain"] = &op_indexed_to_plain;
+
 		// --------------- End of list of possible operations --------
 
 		// Parse arguments:
@@ -468,11 +500,38 @@ int main(int argc, char** argv)
 			throw runtime_error(
 				format("Input file doesn't exist: '%s'", input_rawlog.c_str()));
 
+		// Indexed rawlogs have their own implementation of some operations:
+		const bool is_indexed =
+			CIndexedRawlogReader::isIndexedRawlog(input_rawlog);
+		if (is_indexed &&
+			indexed_ops_functors.find(selected_op) ==
+				indexed_ops_functors.end())
+			throw runtime_error(format(
+				"Operation '--%s' is not supported for indexed rawlogs. "
+				"Convert the input to a plain rawlog first with '--to-plain'.",
+				selected_op.c_str()));
+		if (!is_indexed &&
+			ops_functors.find(selected_op) == ops_functors.end())
+			throw runtime_error(format(
+				"Operation '--%s' requires an indexed rawlog as input.",
+				selected_op.c_str()));
+
 		// Open input rawlog:
 		CFileGZInputStream fil_input;
+		CIndexedRawlogReader indexed_input;
 		VERBOSE_COUT << "Opening '" << input_rawlog << "'...\n";
-		fil_input.open(input_rawlog);
-		VERBOSE_COUT << "Open OK.\n";
+		if (is_indexed)
+		{
+			if (!indexed_input.open(input_rawlog))
+				throw runtime_error("Error reading the indexed rawlog");
+			VERBOSE_COUT << "Open OK. Indexed rawlog with "
+						 << indexed_input.size() << " entries.\n";
+		}
+		else
+		{
+			fil_input.open(input_rawlog);
+			VERBOSE_COUT << "Open OK.\n";
+		}
 
 		// External storage directory?
 		CImage::setImagesPathBase(CRawlog::detectImagesDirectory(input_rawlog));
@@ -491,12 +550,11 @@ int main(int argc, char** argv)
 		// ------------------------------------
 		//  EXECUTE THE REQUESTED OPERATION
 		// ------------------------------------
-		ASSERTMSG_(
-			ops_functors.find(selected_op) != ops_functors.end(),
-			"Internal error: Unknown operation functor!");
-
 		// Call the selected functor:
-		ops_functors[selected_op](fil_input, cmd, verbose);
+		if (is_indexed)
+			indexed_ops_functors[selected_op](indexed_input, cmd, verbose);
+		else
+			ops_functors[selected_op](fil_input, cmd, verbose);
 
 		// successful end of program.
 		ret_val = 0;
@@ -517,22 +575,29 @@ int main(int argc, char** argv)
 // ======================================================================
 //   See TOutputRawlogCreator declaration
 // ======================================================================
-TOutputRawlogCreator::TOutputRawlogCreator()
+// Checks the output file argument, and returns it
+static std::string getOutputRawlogFilename()
 {
 	if (!arg_output_file.isSet())
 		throw runtime_error(
 			"This operation requires an output file. Use '-o file' or "
 			"'--output file'.");
 
-	out_rawlog_filename = arg_output_file.getValue();
+	const std::string out_rawlog_filename = arg_output_file.getValue();
 	if (fileExists(out_rawlog_filename) && !arg_overwrite.getValue())
 		throw runtime_error(
 			string("*ABORTING*: Output file already exists: ") +
 			out_rawlog_filename +
 			string("\n. Select a different output path, remove the file or "
 				   "force overwrite with '-w' or '--overwrite'."));
+	return out_rawlog_filename;
+}
 
-	if (!out_rawlog_io.open(out_rawlog_filename))
+TOutputRawlogCreator::TOutputRawlogCreator()
+{
+	out_rawlog_filename = getOutputRawlogFilename();
+	// Compress in parallel, with as many threads as cores:
+	if (!out_rawlog_io.open(out_rawlog_filename, 1, 0))
 		throw runtime_error(
 			string("*ABORTING*: Cannot open output file: ") +
 			out_rawlog_filename);
@@ -540,6 +605,15 @@ TOutputRawlogCreator::TOutputRawlogCreator()
 					 mrpt::io::CFileGZOutputStream>(out_rawlog_io));
 }
 
+TOutputIndexedRawlogCreator::TOutputIndexedRawlogCreator()
+{
+	out_rawlog_filename = getOutputRawlogFilename();
+	if (!out_rawlog.open(out_rawlog_filename))
+		throw runtime_error(
+			string("*ABORTING*: Cannot open output file: ") +
+			out_rawlog_filename);
+}
+
 bool isFlagSet(TCLAP::CmdLine& cmdline, const std::string& arg_name)
 {
 	using namespace TCLAP;
@@ -107,6 +107,9 @@ int main(int argc, char** argv)
 		int GRABBER_PERIOD_MS = 1000;
 		int rawlog_GZ_compress_level =
 			1;  // 0: No compress, 1-9: compress level
+		// Threads compressing in parallel (1: a single gzip stream, 0: one
+		// per core)
+		int rawlog_GZ_compress_threads = 1;
 
 		MRPT_LOAD_CONFIG_VAR(
 			rawlog_prefix, string, iniFile, GLOBAL_SECTION_NAME);
@@ -121,6 +124,8 @@ int main(int argc, char** argv)
 
 		MRPT_LOAD_CONFIG_VAR(
 			rawlog_GZ_compress_level, int, iniFile, GLOBAL_SECTION_NAME);
+		MRPT_LOAD_CONFIG_VAR(
+			rawlog_GZ_compress_threads, int, iniFile, GLOBAL_SECTION_NAME);
 
 		// Build full rawlog file name:
 		string rawlog_postfix = "_";
@@ -186,7 +191,9 @@ int main(int argc, char** argv)
 		mrpt::io::CFileGZOutputStream out_file;
 		auto out_arch = archiveFrom(out_file);
 
-		out_file.open(rawlog_filename, rawlog_GZ_compress_level);
+		out_file.open(
+			rawlog_filename, rawlog_GZ_compress_level,
+			rawlog_GZ_compress_threads);
 
 		CSensoryFrame curSF;
 		CGenericSensor::TListObservations copy_of_global_list_obs;
@@ -20,7 +20,7 @@
 
 #include <mrpt/obs/CActionRobotMovement2D.h>
 #include <mrpt/obs/CActionRobotMovement3D.h>
-#include <mrpt/obs/CRawlog.h>
+#include <mrpt/obs/CRawlogStreamReader.h>
 #include <mrpt/io/CFileGZInputStream.h>
 #include <mrpt/io/CFileGZOutputStream.h>
 #include <mrpt/io/CFileOutputStream.h>
@@ -231,8 +231,7 @@ void MapBuilding_RBPF()
 	char strFil[1000];
 
 	size_t rawlogEntry = 0;
-	CFileGZInputStream rawlogFile(RAWLOG_FILE);
-	auto rawlogArch = mrpt::serialization::archiveFrom(rawlogFile);
+	CRawlogStreamReader rawlogFile(RAWLOG_FILE);
 
 	// ---------------------------------
 	//		MapPDF opts
@@ -379,8 +378,8 @@ void MapBuilding_RBPF()
 
 		// Load action/observation pair from the rawlog:
 		// --------------------------------------------------
-		if (!CRawlog::readActionObservationPair(
-				rawlogArch, action, observations, rawlogEntry))
+		if (!rawlogFile.readActionObservationPair(
+				action, observations, rawlogEntry))
 			break;  // file EOF
 
 		if (rawlogEntry >= rawlog_offset)
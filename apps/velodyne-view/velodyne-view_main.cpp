@@ -65,6 +65,13 @@ TCLAP::ValueArg<std::string> arg_model(
 	"If no calibration file is specified, set the model to load default values",
 	false, "VLP16",
 	CVelodyneScanner::TModelPropertiesFactory::getListKnownModels(), cmd);
+TCLAP::SwitchArg arg_pcap_fast(
+	"", "pcap-fast",
+	"Replay the PCAP file as fast as possible, e.g. to convert it to a rawlog",
+	cmd, false);
+TCLAP::SwitchArg arg_pcap_once(
+	"", "pcap-once", "Stop at the end of the PCAP file instead of looping",
+	cmd, false);
 TCLAP::SwitchArg arg_nologo(
 	"n", "nologo", "Skip the logo at startup", cmd, false);
 TCLAP::SwitchArg arg_verbose(
@@ -113,6 +120,10 @@ void thread_grabbing(TThreadParam& p)
 				arg_ip_filter.getValue());  // Default: from any IP
 		if (arg_in_pcap.isSet())
 			velodyne.setPCAPInputFile(arg_in_pcap.getValue());
+		if (arg_pcap_fast.isSet()) velodyne.setPCAPInputFileReadFast(true);
+		if (arg_pcap_once.isSet()) velodyne.setPCAPInputFileReadOnce(true);
+		// Read packets in another thread, overlapping I/O and scan assembly:
+		velodyne.setIngestThread(true);
 		if (arg_out_pcap.isSet())
 			velodyne.setPCAPOutputFile(arg_out_pcap.getValue());
 
@@ -32,8 +32,20 @@ serialization with variants(To be replaced by std::variant eventually).
 	- Changes in applications:
 		- RawLogViewer:
 			- The ICP module now supports Velodyne 3D scans.
+		- icp-slam, rbpf-slam, pf-localization:
+			- The rawlog is read in a background thread, with
+mrpt::obs::CRawlogStreamReader.
 		- pf-localization:
 			- Odometry is now used also for observation-only rawlogs.
+		- rawlog-edit:
+			- New operations `--to-indexed` and `--to-plain` to convert
+to/from indexed rawlogs, for which `--cut`, `--keep-label`, `--remove-label`
+and `--list-timestamps` only read the required entries.
+			- Output rawlogs are compressed in parallel, with one thread per
+core.
+		- rawlog-grabber:
+			- New option `rawlog_GZ_compress_threads` to compress the rawlog
+in parallel.
 	- Changes in libraries:
 		- \ref mrpt_base_grp => Refactored into several smaller libraries, one
 per namespace.
@@ -53,16 +65,57 @@ initializator
 			- Removed the include file: `<mrpt/math/jacobians.h>`. Replace by
 `<mrpt/math/num_jacobian.h>` or individual methods in \ref mrpt_poses_grp
 classes.
+			- New methods mrpt::math::CSparseMatrix::setColumnCompressed() and
+mrpt::math::CSparseMatrix::computeFillReducingOrdering(), and a
+mrpt::math::CSparseMatrix::CholeskyDecomp constructor with a given ordering.
+			- New robust kernels mrpt::math::rkHuber, mrpt::math::rkCauchy,
+mrpt::math::rkDCS and mrpt::math::rkGemanMcClure, and the run-time dispatcher
+mrpt::math::evalRobustKernel().
 		- \ref mrpt_config_grp  [NEW IN MRPT 2.0.0]
 			- mrpt::config::CConfigFileBase::write() now supports enum types.
 		- \ref mrpt_serialization_grp  [NEW IN MRPT 2.0.0]
 			- New method mrpt::serialization::CArchive::ReadPOD() and macro
 `MRPT_READ_POD()` for reading unaligned POD variables.-
+			- New method mrpt::serialization::CArchive::ReadBufferNoCopy() to
+access data of archives in memory without copying it, used to decode JPEG
+images in mrpt::img::CImage.
+			- `std::vector<>` and `std::array<>` of POD types are serialized in
+a single block instead of element by element.
 			- Add support for `$env{}` syntax to evaluate environment variables.
+		- \ref mrpt_io_grp  [NEW IN MRPT 2.0.0]
+			- mrpt::io::CFileGZOutputStream can compress in parallel, writing
+independent gzip blocks still readable by standard gzip tools, which
+mrpt::io::CFileGZInputStream decompresses in parallel.
+			- mrpt::io::CMemoryStream grows its buffer geometrically, to write
+large amounts of data in linear time.
+			- New class mrpt::io::CFileMappedInputStream, a read-only stream
+over a memory-mapped file with access pattern hints, which supports
+mrpt::serialization::CArchive::ReadBufferNoCopy().
+		- \ref mrpt_system_grp
+			- New class mrpt::system::thread_pool, and a process-wide pool,
+mrpt::system::shared_thread_pool(), used by all the `numThreads` options of
+MRPT classes through mrpt::system::parallel_for().
+		- \ref mrpt_bayes_grp
+			- New option
+mrpt::bayes::CParticleFilter::TParticleFilterOptions::numThreads to run the
+prediction and weighting stages of particle filters in parallel.
+		- \ref mrpt_poses_grp
+			- mrpt::poses::CPoseRandomSampler::drawSample() can now be given
+an explicit random generator, for use from several threads.
 		- \ref mrpt_slam_grp
 			- rbpf-slam: Add support for simplemap continuation.
 			- CICP: parameter `onlyClosestCorrespondences` deleted (always true
 now).
+			- New class mrpt::slam::CBranchAndBoundScanMatcher: fast global
+scan matching in occupancy grids. Used by the new method
+mrpt::slam::CMonteCarloLocalization2D::resetFromGlobalScanMatch() to
+relocalize kidnapped robots, and by the new method `amBranchAndBound` of
+mrpt::slam::CGridMapAligner.
+			- New option mrpt::slam::CICP::TConfigParams::matching_num_threads
+to search for correspondences in parallel.
+			- New ICP-3D algorithms mrpt::slam::icpPointToPlane and
+mrpt::slam::icpGeneralized (Generalized-ICP), which converge in fewer
+iterations than mrpt::slam::icpClassic, also with sparser point clouds.
 		- \ref mrpt_nav_grp
 			- Removed deprecated mrpt::nav::THolonomicMethod.
 			- mrpt::nav::CAbstractNavigator: callbacks in
@@ -76,15 +129,117 @@ networking classes, with minimal dependencies.
 		- \ref mrpt_maps_grp
 			- Added optional "channel" attribute to CReflectivityGrdMap2D and
 CObservationReflectivity to support different colors of light.
+			- New mrpt::maps::COccupancyGridMap2D::computeObservationLikelihoodBatch()
+to evaluate the likelihood-field model for many poses at once, with a SSE2
+kernel on a precomputed per-cell log-likelihood table.
+			- mrpt::maps::COccupancyGridMap2D: the likelihood-field cache is
+now computed at once with a linear-time distance transform, only the area
+around new observations is recomputed, and it can be optionally serialized
+with the map (see
+mrpt::maps::COccupancyGridMap2D::TLikelihoodOptions::serializeLikelihoodCache,
+serialization version 8). See
+mrpt::maps::COccupancyGridMap2D::updateLikelihoodField().
+			- New option
+mrpt::maps::COccupancyGridMap2D::TInsertionOptions::numThreads for
+multi-threaded insertion of 2D scans.
+			- New class mrpt::maps::CTiledOccupancyGridMap2D: an unbounded,
+sparse occupancy grid made of lazily-allocated tiles, which can be compressed
+in memory when not used, for very large environments.
+			- mrpt::maps::COccupancyGridMap2D can maintain an optional
+max-pooled multi-resolution pyramid, updated incrementally after insertions.
+See mrpt::maps::COccupancyGridMap2D::getResolutionPyramidLevel().
+			- New option mrpt::maps::TMatchingParams::numThreads to run the
+KD-tree queries of mrpt::maps::CPointsMap::determineMatching2D() and
+mrpt::maps::CPointsMap::determineMatching3D() in parallel, with the same
+results than the single-threaded search. Batched, thread-safe KD-tree queries
+are available in mrpt::math::KDTreeCapable::kdTreeClosestPoints2D() and
+mrpt::math::KDTreeCapable::kdTreeClosestPoints3D().
+			- New method mrpt::maps::CPointsMap::getLocalGeometry() to
+estimate (and cache) the normals and covariances of the points.
+			- mrpt::math::KDTreeCapable: points appended to a map no longer
+rebuild the whole KD-tree, but are added to it as a forest of KD-trees of
+geometrically-growing sizes, at O(log N) amortized cost per point. Point maps
+use it via the new mrpt::maps::CPointsMap::mark_as_appended(), e.g. when
+inserting observations in a map or merging another map into it. Likewise,
+removing points via mrpt::maps::CPointsMap::mark_as_removed() only rebuilds
+the KD-trees of the forest which had any of them.
+			- New class mrpt::maps::CVoxelPointsMap: a point map with a bounded
+number of points per voxel (in a hash table) and optional removal of the
+voxels far from the robot (each time it moves a given distance), for
+constant-memory local maps.
 		- \ref mrpt_hwdrivers_grp
 			- COpenNI2Generic: is safer in multithreading apps.
 			- CHokuyoURG:
 				- Rewrite driver to be safer and reduce mem allocs.
 				- New parameter `scan_interval` to decimate scans.
+			- mrpt::hwdrivers::CVelodyneScanner:
+				- New optional packet ingest thread, which receives UDP or
+PCAP packets directly into a ring buffer from which scans are assembled (see
+mrpt::hwdrivers::CVelodyneScanner::setIngestThread()).
+				- `pcap_read_fast` now replays PCAP files as fast as possible
+(see mrpt::hwdrivers::CVelodyneScanner::setPCAPInputFileReadFast()), also
+available as `velodyne-view --pcap-fast`.
+		- \ref mrpt_graphslam_grp
+			- New class mrpt::graphslam::CIncrementalGraphOptimizer: iSAM-like
+incremental optimization of growing pose graphs, which only relinearizes and
+re-factorizes the part of the problem affected by new nodes and edges. It can
+be used from mrpt::graphslam::optimizers::CLevMarqGSO with the new option
+`incremental_optimization`.
+			- mrpt::graphslam::optimize_graph_spa_levmarq() builds the Hessian
+from fixed-size blocks with a sparsity pattern computed once, uses a
+fill-reducing ordering computed for that block structure and reused in all
+iterations, and can evaluate edges and build the linear system in parallel
+(new parameter `num_threads`, also available as `graph-slam --threads`).
+			- mrpt::graphslam::optimize_graph_spa_levmarq() supports robust
+kernels (Huber, Cauchy, DCS, Geman-McClure/switchable constraints), with
+different kernels for odometry and loop closure edges, and returns the final
+weight of each edge. New function mrpt::graphslam::prune_inconsistent_edges()
+to remove outlier loop closures before a full optimization, also available in
+mrpt::graphslam::optimizers::CLevMarqGSO (option `prune_outliers`).
+			- New class mrpt::graphslam::CAsyncGraphOptimizer: runs the
+optimization of a growing graph in a background thread, on a snapshot updated
+only with new nodes and edges, and merges the corrected poses back in time
+proportional to the number of changed nodes. mrpt::graphslam::CGraphSlamEngine
+uses it with the new option `optimize_in_background`, so node and edge
+registration no longer waits for the optimizer.
+			- mrpt::graphslam::deciders::CLoopCloserERD can find loop closure
+candidates in a grid index of the node positions (new class
+mrpt::graphslam::detail::CNodePositionsGrid), within a search radius that grows
+with the accumulated odometry uncertainty, instead of in the map partitions
+(option `LC_use_spatial_index`). The pair-wise consistency matrix is only
+evaluated for valid hypotheses, computing each Dijkstra link once.
 		- \ref mrpt_opengl_grp
 			- Update Assimp lib version 4.0.1 -> 4.1.0 (when built as ExternalProject)
 		- \ref mrpt_obs_grp
 			- mrpt::obs::T3DPointsProjectionParams and mrpt::obs::CObservation3DRangeScan::project3DPointsFromDepthImageInto now together support organized PCL point clouds.
+			- New indexed rawlog file format, with chunk-level compression
+and a trailing index of entry offsets, timestamps, sensor labels and class
+names, for random access to large datasets. See
+mrpt::obs::CIndexedRawlogWriter, mrpt::obs::CIndexedRawlogReader,
+mrpt::obs::CRawlog::saveToIndexedRawLogFile() and
+mrpt::obs::CRawlog::loadFromIndexedRawLogFile().
+			- New class mrpt::obs::CRawlogStreamReader to read rawlogs
+sequentially with bounded memory, decompressing and deserializing a limited
+number of entries ahead in a background thread.
+			- mrpt::obs::CRawlog::loadFromIndexedRawLogFile() can load entries
+lazily, keeping them serialized until they are first accessed, with an
+optional limit of entries kept in memory (see
+mrpt::obs::CRawlog::setMaxLazyEntriesInMemory()).
+			- mrpt::obs::CObservation3DRangeScan::rangeImageCodec selects a
+compressed encoding for range images when serializing observations: lossless,
+or rounded to millimeters.
+			- mrpt::obs::CObservation3DRangeScan::project3DPointsFromDepthImageInto()
+can run in several threads and decimate the range image (see
+mrpt::obs::T3DPointsProjectionParams::numThreads and
+mrpt::obs::T3DPointsProjectionParams::decimation), in a single pass which
+filters, colors and transforms each point as it is generated.
+			- mrpt::obs::CObservationVelodyneScan::generatePointCloud() and
+mrpt::obs::CObservationVelodyneScan::generatePointCloudAlongSE3Trajectory()
+can decode data packets in parallel (see
+mrpt::obs::CObservationVelodyneScan::TGeneratePointCloudParameters::numThreads)
+with identical results, and use look-up tables for the per-return azimuth
+corrections. Point clouds can also be generated directly into user containers
+via mrpt::obs::CObservationVelodyneScan::PointCloudStorageWrapper.
 	- BUG FIXES:
 		- Fix reactive navigator inconsistent state if navigation API is called
 from within rnav callbacks.
@@ -97,6 +252,8 @@ rotation matrices.
 (via the new `MRPT_READ_POD()` macro).
 		- Fix segfault in CMetricMap::loadFromSimpleMap() if the provided
 CMetricMap has empty smart pointers.
+		- Fix wrong coordinates of 3D points projected from depth images with
+the look-up table and without SSE2 after the first invalid range.
 	- Fix crash in CGPSInterface when not setting an external mutex.
 
 <hr>
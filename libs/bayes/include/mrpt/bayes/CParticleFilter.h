@@ -163,6 +163,22 @@ class CParticleFilter : public mrpt::system::COutputLogger
 		 * perform rejection sampling, but just the most-likely (ML) particle
 		 * found in the preliminary weight-determination stage. */
 		bool pfAuxFilterOptimal_MLE{false};
+
+		/** (Default=1) Number of worker threads used to run the prediction
+		 * and weighting stages of pfStandardProposal. 1 means the classic
+		 * single-threaded implementation; 0 means one thread per hardware
+		 * core. With any value other than 1, each block of consecutive
+		 * particles draws its motion noise from its own random stream (seeded
+		 * at each step from the global mrpt::random::getRandomGenerator()), so
+		 * results are deterministic, reproducible by re-seeding the global
+		 * generator, and do not depend on the actual number of threads.
+		 * The first particle is weighted before the others, in the calling
+		 * thread, so lazily-built caches (e.g. the likelihood field of
+		 * occupancy grids) are ready before the parallel stage starts.
+		 * \note The observation likelihood of the map(s) must be safe to be
+		 * evaluated concurrently from several threads.
+		 */
+		unsigned int numThreads{1};
 	};
 
 	/** Statistics for being returned from the "execute" method. */
@@ -16,6 +16,10 @@
 // Graph SLAM: Batch solvers
 #include "graphslam/levmarq.h"
 
+// Graph SLAM: Incremental solvers
+#include "graphslam/CAsyncGraphOptimizer.h"
+#include "graphslam/CIncrementalGraphOptimizer.h"
+
 // Interfaces for implementing deciders/optimizers
 #include "graphslam/interfaces/CRegistrationDeciderOrOptimizer.h"
 #include "graphslam/interfaces/CNodeRegistrationDecider.h"
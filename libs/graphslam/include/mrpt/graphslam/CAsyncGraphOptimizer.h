@@ -0,0 +1,155 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/graphs/TNodeID.h>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace mrpt::graphslam
+{
+/** Runs the optimization of a growing graph in a background thread, on a
+ * snapshot of the graph, so the thread adding nodes and edges to the "live"
+ * graph (the SLAM front-end) never waits for the optimizer.
+ *
+ * The snapshot is a second graph owned by this class, which is only written
+ * by step() while no optimization is running (double buffering):
+ *  - When an optimization is started, the nodes and edges added to the live
+ * graph since the previous one are copied into the snapshot, in time
+ * independent of the graph size. Nodes are looked up by ID (new nodes are
+ * those with an ID above the last one copied); edges must be reported with
+ * addEdge() as they are inserted in the live graph (CGraphSlamEngine does so
+ * with the edges inserted by the registration deciders, see
+ * CRegistrationDeciderOrOptimizer::setNewEdgeCallback()). Edges removed from
+ * the live graph by anyone but the optimizer are not removed from the
+ * snapshot.
+ *  - When an optimization finishes, the background thread prepares the list
+ * of nodes whose pose changed (and of edges removed by the optimizer, e.g.
+ * outliers). The next call to step() writes them into the live graph, in
+ * O(changed nodes), and moves the nodes added to the live graph meanwhile
+ * with the same correction as the last node in the snapshot.
+ *
+ * Usage: call step() from the front-end, with the live graph locked, every
+ * time it may have changed. The job passed to step() (e.g. a call to
+ * mrpt::graphslam::optimize_graph_spa_levmarq() or to a
+ * mrpt::graphslam::optimizers::CGraphSlamOptimizer working on getSnapshot())
+ * is run on the snapshot, while getSnapshotSection() is locked. Exceptions
+ * thrown by the job are re-thrown by the next call to step() or finish().
+ *
+ * \sa mrpt::graphslam::CGraphSlamEngine
+ * \ingroup mrpt_graphslam_grp
+ */
+template <class GRAPH_T>
+class CAsyncGraphOptimizer
+{
+   public:
+	using job_t = std::function<void(GRAPH_T& snapshot)>;
+	using global_pose_t = typename GRAPH_T::global_pose_t;
+	using pose_t = typename GRAPH_T::constraint_no_pdf_t;
+	using constraint_t = typename GRAPH_T::constraint_t;
+	using TNodeID = mrpt::graphs::TNodeID;
+
+	CAsyncGraphOptimizer();
+	/** Waits for the running optimization (if any) to finish */
+	~CAsyncGraphOptimizer();
+
+	CAsyncGraphOptimizer(const CAsyncGraphOptimizer&) = delete;
+	CAsyncGraphOptimizer& operator=(const CAsyncGraphOptimizer&) = delete;
+
+	/** Merges into the live graph the result of the last optimization, if it
+	 * has finished, and then, if the optimizer is idle and the live graph has
+	 * new nodes or edges (reported with addEdge()), updates the snapshot and
+	 * runs \a job on it in the background thread. Never waits for a running
+	 * optimization.
+	 * The caller must hold the lock of the live graph.
+	 * \return true if a new optimization was started.
+	 */
+	bool step(GRAPH_T& live, job_t job);
+
+	/** Reports an edge inserted in the live graph, to be copied into the
+	 * snapshot by the next step() that starts an optimization. The caller
+	 * must hold the lock of the live graph. */
+	void addEdge(TNodeID from, TNodeID to, const constraint_t& edge);
+
+	/** Waits for the running optimization (if any) to finish and merges its
+	 * results into the live graph. The caller must hold the lock of the live
+	 * graph. */
+	void finish(GRAPH_T& live);
+
+	/** Whether an optimization is running, or its results not merged yet */
+	bool isBusy() const;
+
+	/** The graph being optimized. Lock getSnapshotSection() to read it. */
+	GRAPH_T& getSnapshot() { return m_snapshot; }
+	const GRAPH_T& getSnapshot() const { return m_snapshot; }
+	std::mutex& getSnapshotSection() { return m_snapshot_section; }
+
+	struct TStats
+	{
+		/** Number of optimizations started */
+		size_t num_optimizations{0};
+		/** Nodes and edges copied into the snapshot by the last step() that
+		 * started an optimization */
+		size_t num_new_nodes{0}, num_new_edges{0};
+		/** Nodes of the live graph written by the last merge: changed by the
+		 * optimizer, and moved along because they were not in the snapshot */
+		size_t num_changed_nodes{0}, num_propagated_nodes{0};
+		/** Edges removed from the live graph by the last merge */
+		size_t num_removed_edges{0};
+	};
+	/** Statistics, to be read from the thread calling step() */
+	const TStats& getStats() const { return m_stats; }
+
+   private:
+	enum state_t
+	{
+		IDLE = 0,
+		RUNNING,
+		DONE
+	};
+
+	GRAPH_T m_snapshot;
+	/** Locked by the background thread while it runs a job */
+	std::mutex m_snapshot_section;
+
+	std::thread m_thread;
+	/** Protects the state and the job to be run */
+	mutable std::mutex m_state_mtx;
+	std::condition_variable m_state_cv;
+	state_t m_state{IDLE};
+	bool m_exit{false};
+	job_t m_job;
+	std::exception_ptr m_job_exception;
+
+	/** Highest node ID in the snapshot (INVALID_NODEID if none) */
+	TNodeID m_last_node{INVALID_NODEID};
+	/** Edges reported with addEdge() and not in the snapshot yet */
+	typename GRAPH_T::edges_map_t m_new_edges;
+
+	/** Results of the last job, prepared in the background thread */
+	std::vector<std::pair<TNodeID, pose_t>> m_changed_nodes;
+	std::vector<mrpt::graphs::TPairNodeIDs> m_removed_edges;
+
+	TStats m_stats;
+
+	void threadLoop();
+	/** Runs the job and prepares m_changed_nodes & m_removed_edges */
+	void runJob();
+	void sync(const GRAPH_T& live);
+	void merge(GRAPH_T& live);
+};
+
+}  // namespace mrpt::graphslam
+
+#include "CAsyncGraphOptimizer_impl.h"
@@ -0,0 +1,234 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+namespace mrpt::graphslam
+{
+template <class GRAPH_T>
+CAsyncGraphOptimizer<GRAPH_T>::CAsyncGraphOptimizer() = default;
+
+template <class GRAPH_T>
+CAsyncGraphOptimizer<GRAPH_T>::~CAsyncGraphOptimizer()
+{
+	{
+		std::lock_guard<std::mutex> lck(m_state_mtx);
+		m_exit = true;
+	}
+	m_state_cv.notify_all();
+	if (m_thread.joinable()) m_thread.join();
+}
+
+template <class GRAPH_T>
+bool CAsyncGraphOptimizer<GRAPH_T>::isBusy() const
+{
+	std::lock_guard<std::mutex> lck(m_state_mtx);
+	return m_state != IDLE;
+}
+
+template <class GRAPH_T>
+bool CAsyncGraphOptimizer<GRAPH_T>::step(GRAPH_T& live, job_t job)
+{
+	{
+		std::unique_lock<std::mutex> lck(m_state_mtx);
+		if (m_state == RUNNING) return false;
+		if (m_state == DONE)
+		{
+			m_state = IDLE;
+			lck.unlock();
+			merge(live);
+		}
+	}
+
+	// Nothing new to optimize?
+	const bool new_nodes =
+		!live.nodes.empty() && live.nodes.rbegin()->first != m_last_node;
+	if (!new_nodes && m_new_edges.empty()) return false;
+
+	sync(live);
+
+	{
+		std::lock_guard<std::mutex> lck(m_state_mtx);
+		m_job = std::move(job);
+		m_state = RUNNING;
+	}
+	if (!m_thread.joinable())
+		m_thread = std::thread(&CAsyncGraphOptimizer<GRAPH_T>::threadLoop, this);
+	m_state_cv.notify_all();
+	m_stats.num_optimizations++;
+	return true;
+}
+
+template <class GRAPH_T>
+void CAsyncGraphOptimizer<GRAPH_T>::addEdge(
+	TNodeID from, TNodeID to, const constraint_t& edge)
+{
+	alignas(MRPT_MAX_ALIGN_BYTES) typename GRAPH_T::edges_map_t::value_type
+		entry(std::make_pair(from, to), edge);
+	m_new_edges.insert(entry);
+}
+
+template <class GRAPH_T>
+void CAsyncGraphOptimizer<GRAPH_T>::finish(GRAPH_T& live)
+{
+	{
+		std::unique_lock<std::mutex> lck(m_state_mtx);
+		m_state_cv.wait(lck, [this]() { return m_state != RUNNING; });
+		if (m_state == IDLE) return;
+		m_state = IDLE;
+	}
+	merge(live);
+}
+
+template <class GRAPH_T>
+void CAsyncGraphOptimizer<GRAPH_T>::threadLoop()
+{
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lck(m_state_mtx);
+			m_state_cv.wait(lck, [this]() {
+				return m_exit || (m_state == RUNNING && m_job);
+			});
+			if (m_exit) return;
+		}
+		runJob();
+		{
+			std::lock_guard<std::mutex> lck(m_state_mtx);
+			m_job = nullptr;
+			m_state = DONE;
+		}
+		m_state_cv.notify_all();
+	}
+}
+
+template <class GRAPH_T>
+void CAsyncGraphOptimizer<GRAPH_T>::runJob()
+{
+	std::lock_guard<std::mutex> lck(m_snapshot_section);
+
+	// Back up the node poses and edge keys, to find out what the job changed:
+	std::vector<std::pair<TNodeID, pose_t>> old_poses;
+	old_poses.reserve(m_snapshot.nodes.size());
+	for (const auto& n : m_snapshot.nodes)
+		old_poses.emplace_back(n.first, static_cast<const pose_t&>(n.second));
+	std::vector<mrpt::graphs::TPairNodeIDs> old_edges;
+	old_edges.reserve(m_snapshot.edges.size());
+	for (const auto& e : m_snapshot.edges) old_edges.push_back(e.first);
+
+	try
+	{
+		m_job(m_snapshot);
+	}
+	catch (...)
+	{
+		m_job_exception = std::current_exception();
+	}
+
+	m_changed_nodes.clear();
+	for (const auto& p : old_poses)
+	{
+		const auto it = m_snapshot.nodes.find(p.first);
+		if (it != m_snapshot.nodes.end() &&
+			static_cast<const pose_t&>(it->second) != p.second)
+			m_changed_nodes.emplace_back(
+				p.first, static_cast<const pose_t&>(it->second));
+	}
+
+	// Edges removed by the job (both lists are sorted):
+	m_removed_edges.clear();
+	if (m_snapshot.edges.size() != old_edges.size())
+	{
+		auto it = m_snapshot.edges.begin();
+		for (const auto& ids : old_edges)
+		{
+			if (it != m_snapshot.edges.end() && it->first == ids)
+				++it;
+			else
+				m_removed_edges.push_back(ids);
+		}
+	}
+}
+
+template <class GRAPH_T>
+void CAsyncGraphOptimizer<GRAPH_T>::sync(const GRAPH_T& live)
+{
+	std::lock_guard<std::mutex> lck(m_snapshot_section);
+	m_snapshot.root = live.root;
+
+	// New nodes: those after the last one already in the snapshot.
+	size_t num_new_nodes = 0;
+	for (auto it = (m_last_node == INVALID_NODEID)
+					   ? live.nodes.begin()
+					   : live.nodes.upper_bound(m_last_node);
+		 it != live.nodes.end(); ++it, ++num_new_nodes)
+		m_snapshot.nodes.insert(m_snapshot.nodes.end(), *it);
+	if (!live.nodes.empty()) m_last_node = live.nodes.rbegin()->first;
+
+	// New edges, as reported by addEdge():
+	m_snapshot.edges.insert(m_new_edges.begin(), m_new_edges.end());
+
+	m_stats.num_new_nodes = num_new_nodes;
+	m_stats.num_new_edges = m_new_edges.size();
+	m_new_edges.clear();
+}
+
+template <class GRAPH_T>
+void CAsyncGraphOptimizer<GRAPH_T>::merge(GRAPH_T& live)
+{
+	std::lock_guard<std::mutex> lck(m_snapshot_section);
+
+	// Nodes added to the live graph during the optimization follow the
+	// correction of the last node in the snapshot:
+	size_t num_propagated = 0;
+	const auto it_last = live.nodes.find(m_last_node);
+	const auto it_last_opt = m_snapshot.nodes.find(m_last_node);
+	if (it_last != live.nodes.end() && it_last_opt != m_snapshot.nodes.end())
+	{
+		const pose_t old_last = static_cast<const pose_t&>(it_last->second);
+		const pose_t& new_last = static_cast<const pose_t&>(it_last_opt->second);
+		if (old_last != new_last)
+			for (auto it = live.nodes.upper_bound(m_last_node);
+				 it != live.nodes.end(); ++it, ++num_propagated)
+			{
+				pose_t& p = static_cast<pose_t&>(it->second);
+				p = new_last + (p - old_last);
+			}
+	}
+
+	for (const auto& c : m_changed_nodes)
+	{
+		const auto it = live.nodes.find(c.first);
+		if (it != live.nodes.end())
+			static_cast<pose_t&>(it->second) = c.second;
+	}
+
+	size_t num_removed = 0;
+	for (const auto& ids : m_removed_edges)
+	{
+		const auto it = live.edges.find(ids);
+		if (it == live.edges.end()) continue;
+		live.edges.erase(it);
+		num_removed++;
+	}
+
+	m_stats.num_changed_nodes = m_changed_nodes.size();
+	m_stats.num_propagated_nodes = num_propagated;
+	m_stats.num_removed_edges = num_removed;
+	m_changed_nodes.clear();
+	m_removed_edges.clear();
+
+	if (m_job_exception)
+	{
+		std::exception_ptr e;
+		std::swap(e, m_job_exception);
+		std::rethrow_exception(e);
+	}
+}
+
+}  // namespace mrpt::graphslam
@@ -32,9 +32,11 @@
 #include <mrpt/graphslam/interfaces/CNodeRegistrationDecider.h>
 #include <mrpt/graphslam/interfaces/CEdgeRegistrationDecider.h>
 #include <mrpt/graphslam/interfaces/CGraphSlamOptimizer.h>
+#include <mrpt/graphslam/CAsyncGraphOptimizer.h>
 
 #include <string>
 #include <map>
+#include <memory>
 #include <set>
 
 namespace mrpt::graphslam
@@ -66,6 +68,11 @@ namespace mrpt::graphslam
  * \em m_graph_section. Critical section is also <em> locked prior to the calls
  * to the deciders/optimizers </em>.
  *
+ * \note With \b optimize_in_background, the optimizer works on a snapshot of
+ * the graph in a background thread (see CAsyncGraphOptimizer), and its
+ * corrections are merged into the graph in later steps: \em m_graph_section
+ * is never held during an optimization.
+ *
  * ### .ini Configuration Parameters
  *
  * \htmlinclude graphslam-engine_config_params_preamble.txt
@@ -100,6 +107,17 @@ namespace mrpt::graphslam
  *   + \a Default value : 1 (mrpt::system::LVL_INFO)
  *   + \a Required      : FALSE
  *
+ * - \b optimize_in_background
+ *   + \a Section       : GeneralConfiguration
+ *   + \a Default value : FALSE
+ *   + \a Required      : FALSE
+ *   + \a Description   : Run the optimizer in a background thread, on a
+ *   snapshot of the graph, so the registration of new nodes and edges does
+ *   not wait for it. Node poses are then not re-estimated with Dijkstra after
+ *   each new node (which takes time linear in the graph size), but updated
+ *   with the optimizer corrections. The
+ *   \b optimization_on_second_thread option of CLevMarqGSO is then ignored.
+ *
  *
  * - \b visualize_map
  *   + \a Section       : VisualizationParameters
@@ -323,6 +341,13 @@ class CGraphSlamEngine : public mrpt::system::COutputLogger
 
 	/**\brief Return a reference to the underlying GRAPH_T instance. */
 	const GRAPH_T& getGraph() const { return m_graph; }
+	/**\brief Wait for the background optimization (if \b
+	 * optimize_in_background is set and one is running) to finish, and merge
+	 * its results into the graph.
+	 *
+	 * Call it before reading the final graph.
+	 */
+	void waitForBackgroundOptimization();
 	/**\brief Return the filename of the used rawlog file.*/
 	inline std::string getRawlogFname() { return m_rawlog_fname; }
 	/**\name ground-truth parsing methods */
@@ -891,6 +916,11 @@ class CGraphSlamEngine : public mrpt::system::COutputLogger
 	 * implementation
 	 */
 	mutable std::mutex m_graph_section;
+	/**\brief Optimize a snapshot of the graph in a background thread */
+	bool m_optimize_in_background{false};
+	/**\brief Used only if m_optimize_in_background */
+	std::unique_ptr<mrpt::graphslam::CAsyncGraphOptimizer<GRAPH_T>>
+		m_async_optimizer;
 
 	// keep track of the storage directory for the 3DRangeScan depth/range
 	// images
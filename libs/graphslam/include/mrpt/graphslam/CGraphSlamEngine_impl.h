@@ -73,6 +73,9 @@ CGraphSlamEngine<GRAPH_T>::~CGraphSlamEngine()
 	MRPT_LOG_DEBUG_STREAM(
 		"In Destructor: Deleting CGraphSlamEngine instance...");
 
+	// stop the background optimization before anything else is released
+	m_async_optimizer.reset();
+
 	// change back the CImage path
 	if (mrpt::system::strCmpI(m_GT_file_format, "rgbd_tum"))
 	{
@@ -221,6 +224,27 @@ void CGraphSlamEngine<GRAPH_T>::initClass()
 	// needs
 	this->loadParams(m_config_fname);
 
+	// the optimizer works on its own snapshot of the graph, fed with the
+	// edges inserted by the registration deciders
+	if (m_optimize_in_background)
+	{
+		m_async_optimizer = std::make_unique<CAsyncGraphOptimizer<GRAPH_T>>();
+		m_optimizer->setGraphPtr(&m_async_optimizer->getSnapshot());
+		m_optimizer->setCriticalSectionPtr(
+			&m_async_optimizer->getSnapshotSection());
+		m_optimizer->disableOptimizationThread();
+
+		auto* async_optimizer = m_async_optimizer.get();
+		const auto feed_edge = [async_optimizer](
+								   mrpt::graphs::TNodeID from,
+								   mrpt::graphs::TNodeID to,
+								   const constraint_t& edge) {
+			async_optimizer->addEdge(from, to, edge);
+		};
+		m_node_reg->setNewEdgeCallback(feed_edge);
+		m_edge_reg->setNewEdgeCallback(feed_edge);
+	}
+
 	if (!m_enable_visuals)
 	{
 		MRPT_LOG_WARN_STREAM("Switching all visualization parameters off...");
@@ -642,7 +666,21 @@ bool CGraphSlamEngine<GRAPH_T>::_execGraphSlamStep(
 		std::lock_guard<std::mutex> graph_lock(m_graph_section);
 
 		m_time_logger.enter("optimizer");
-		m_optimizer->updateState(action, observations, observation);
+		if (m_async_optimizer)
+		{
+			// merge the results of the last optimization and, if idle, start
+			// a new one with the latest nodes/edges. Never waits.
+			auto optimizer = m_optimizer;
+			m_async_optimizer->step(
+				m_graph, [optimizer, action, observations,
+						  observation](GRAPH_T&) {
+					optimizer->updateState(action, observations, observation);
+				});
+		}
+		else
+		{
+			m_optimizer->updateState(action, observations, observation);
+		}
 		m_time_logger.leave("optimizer");
 	}
 	this->monitorNodeRegistration(registered_new_node, "GraphSlamOptimizer");
@@ -687,7 +725,9 @@ bool CGraphSlamEngine<GRAPH_T>::_execGraphSlamStep(
 
 	if (registered_new_node)
 	{
-		this->execDijkstraNodesEstimation();
+		// in background mode node poses are kept up to date by the optimizer
+		// corrections
+		if (!m_async_optimizer) this->execDijkstraNodesEstimation();
 
 		// keep track of the laser scans so that I can later visualize the map
 		m_nodes_to_laser_scans2D[m_nodeID_max] = m_last_laser_scan2D;
@@ -869,6 +909,18 @@ bool CGraphSlamEngine<GRAPH_T>::_execGraphSlamStep(
 	MRPT_END;
 }  // end of _execGraphSlamStep
 
+template <class GRAPH_T>
+void CGraphSlamEngine<GRAPH_T>::waitForBackgroundOptimization()
+{
+	MRPT_START;
+	if (!m_async_optimizer) return;
+
+	std::lock_guard<std::mutex> graph_lock(m_graph_section);
+	m_async_optimizer->finish(m_graph);
+
+	MRPT_END;
+}
+
 template <class GRAPH_T>
 void CGraphSlamEngine<GRAPH_T>::execDijkstraNodesEstimation()
 {
@@ -1038,6 +1090,8 @@ void CGraphSlamEngine<GRAPH_T>::loadParams(const std::string& fname)
 	// ////////////////////////////////
 	m_user_decides_about_output_dir = cfg_file.read_bool(
 		"GeneralConfiguration", "user_decides_about_output_dir", false, false);
+	m_optimize_in_background = cfg_file.read_bool(
+		"GeneralConfiguration", "optimize_in_background", false, false);
 	m_GT_file_format = cfg_file.read_string(
 		"GeneralConfiguration", "ground_truth_file_format", "NavSimul", false);
 
@@ -1111,6 +1165,8 @@ void CGraphSlamEngine<GRAPH_T>::getParamsAsString(std::string* params_out) const
 	ss_out << "Ground Truth File format        = " << m_GT_file_format
 		   << std::endl;
 	ss_out << "Ground Truth filename           = " << m_fname_GT << std::endl;
+	ss_out << "Optimize in background          = "
+		   << (m_optimize_in_background ? "TRUE" : "FALSE") << std::endl;
 
 	ss_out << "Visualize odometry              = "
 		   << (m_visualize_odometry_poses ? "TRUE" : "FALSE") << std::endl;
@@ -1223,7 +1279,17 @@ void CGraphSlamEngine<GRAPH_T>::updateAllVisuals()
 
 	m_node_reg->updateVisuals();
 	m_edge_reg->updateVisuals();
-	m_optimizer->updateVisuals();
+	if (m_async_optimizer)
+	{
+		// don't wait for a running optimization, just skip its visuals
+		std::unique_lock<std::mutex> opt_lock(
+			m_async_optimizer->getSnapshotSection(), std::try_to_lock);
+		if (opt_lock.owns_lock()) m_optimizer->updateVisuals();
+	}
+	else
+	{
+		m_optimizer->updateVisuals();
+	}
 
 	m_time_logger.leave("Visuals");
 	MRPT_END;
@@ -1655,7 +1721,16 @@ void CGraphSlamEngine<GRAPH_T>::queryObserverForEvents()
 	// MRPT_LOG_DEBUG_STREAM("Notifying deciders/optimizer for events");
 	m_node_reg->notifyOfWindowEvents(events_occurred);
 	m_edge_reg->notifyOfWindowEvents(events_occurred);
-	m_optimizer->notifyOfWindowEvents(events_occurred);
+	if (m_async_optimizer)
+	{
+		std::lock_guard<std::mutex> opt_lock(
+			m_async_optimizer->getSnapshotSection());
+		m_optimizer->notifyOfWindowEvents(events_occurred);
+	}
+	else
+	{
+		m_optimizer->notifyOfWindowEvents(events_occurred);
+	}
 
 	MRPT_END;
 }
@@ -2738,6 +2813,7 @@ void CGraphSlamEngine<GRAPH_T>::generateReportFiles(
 
 	MRPT_LOG_INFO_STREAM("Generating detailed class report...");
 	std::lock_guard<std::mutex> graph_lock(m_graph_section);
+	if (m_async_optimizer) m_async_optimizer->finish(m_graph);
 
 	std::string report_str;
 	std::string fname;
@@ -0,0 +1,182 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/graphslam/types.h>
+#include <mrpt/graphslam/levmarq.h>  // Aux classes
+#include <mrpt/core/aligned_std_vector.h>
+#include <mrpt/core/bits_math.h>
+#include <mrpt/core/exceptions.h>
+#include <Eigen/Dense>
+#include <map>
+#include <vector>
+
+namespace mrpt::graphslam
+{
+/** Incremental optimizer for graphs of pose constraints, for graphs which
+ * grow over time (e.g. SLAM): each call to update() only relinearizes and
+ * re-factorizes the part of the problem touched by the new nodes and edges
+ * since the last call, instead of solving the whole graph again like
+ * mrpt::graphslam::optimize_graph_spa_levmarq().
+ *
+ * The method follows the ideas of iSAM / iSAM2 (Kaess et al.):
+ *  - The Gauss-Newton normal equations are factorized with a block sparse
+ * Cholesky decomposition (one block per node) with a fixed variable ordering,
+ * the order in which nodes are first seen. Columns of the factor before the
+ * first node touched by an update do not change, so only the trailing
+ * columns are recomputed. With odometry-like edges this is a handful of
+ * nodes; a loop closure re-factorizes the nodes since the oldest node in
+ * the loop.
+ *  - Fluid relinearization: each node keeps its own linearization point,
+ * which is only moved (and its edges relinearized) when its increment is
+ * larger than TOptions::relinearize_threshold.
+ *  - Partial back-substitution: the solution of nodes before the touched
+ * part is only updated if the solution of the nodes they depend on changed
+ * by more than TOptions::wildfire_threshold.
+ *
+ * Usage: call update() every time new nodes and edges have been added to the
+ * graph. The graph root is kept fixed, and all other nodes are optimized.
+ * Existing edges and node poses must not be modified by other means between
+ * calls (call reset() if they are, e.g. after a full batch optimization);
+ * removed edges or a new root are detected and lead to a full re-build.
+ *
+ * \note The following graph types are supported:
+ * mrpt::graphs::CNetworkOfPoses2D, mrpt::graphs::CNetworkOfPoses3D,
+ * mrpt::graphs::CNetworkOfPoses2DInf, mrpt::graphs::CNetworkOfPoses3DInf
+ *
+ * \sa optimize_graph_spa_levmarq(),
+ * mrpt::graphslam::optimizers::CLevMarqGSO
+ * \ingroup mrpt_graphslam_grp
+ */
+template <class GRAPH_T>
+class CIncrementalGraphOptimizer
+{
+   public:
+	using gst = graphslam_traits<GRAPH_T>;
+	using pose_t = typename GRAPH_T::constraint_t::type_value;
+	using TNodeID = mrpt::graphs::TNodeID;
+
+	struct TOptions
+	{
+		/** Relinearize a node (and its edges) when the infinity norm of its
+		 * increment from its linearization point exceeds this value. */
+		double relinearize_threshold{0.01};
+		/** Back-substitution does not propagate to older nodes when the
+		 * solution changes by less than this value (infinity norm). */
+		double wildfire_threshold{1e-6};
+		/** Maximum number of relinearize/re-solve steps per update() */
+		size_t max_iterations{10};
+		bool verbose{false};
+	};
+	TOptions options;
+
+	/** Statistics on the last call to update() */
+	struct TUpdateStats
+	{
+		/** Number of new nodes and edges incorporated */
+		size_t num_new_nodes{0}, num_new_edges{0};
+		/** Number of nodes relinearized (not counting new nodes) */
+		size_t num_relinearized_nodes{0};
+		/** Number of factor columns (nodes) recomputed, summed over all the
+		 * iterations */
+		size_t num_refactorized_nodes{0};
+		/** Number of node poses written back to the graph */
+		size_t num_updated_nodes{0};
+	};
+
+	/** Incorporates the nodes and edges added to the graph since the last
+	 * call, and updates the estimate of the node poses in the graph.
+	 * \param[out] out_info Number of iterations, and sum of the squared
+	 * errors of all edges, evaluated at their linearization points.
+	 * \exception std::exception If the problem is not positive definite (e.g.
+	 * nodes not connected to the root). The internal state is reset.
+	 */
+	void update(GRAPH_T& graph, TResultInfoSpaLevMarq& out_info);
+
+	/** Forgets all the internal state: the next call to update() will build
+	 * and solve the whole problem. */
+	void reset();
+
+	/** Number of nodes being optimized (all, except the root) */
+	size_t getNumNodes() const { return m_vars.size(); }
+	size_t getNumEdges() const { return m_edges.size(); }
+	const TUpdateStats& getLastUpdateStats() const { return m_stats; }
+
+   private:
+	static constexpr size_t DIM = gst::SE_TYPE::VECTOR_SIZE;
+	static constexpr size_t INVALID_IDX = static_cast<size_t>(-1);
+	using block_t = Eigen::Matrix<double, DIM, DIM>;
+	using vec_t = Eigen::Matrix<double, DIM, 1>;
+	using row_block_t = std::pair<size_t, block_t>;
+
+	/** A node being optimized, and its column of the Cholesky factor L */
+	struct TVariable
+	{
+		TNodeID id;
+		/** Linearization point */
+		pose_t lin_pose;
+		/** Current solution, as an increment over lin_pose */
+		vec_t delta{vec_t::Zero()};
+		/** Forward substitution solution: L*y = -gradient */
+		vec_t y{vec_t::Zero()};
+		/** Edges connected to this node (indices in m_edges) */
+		std::vector<size_t> edges;
+		/** Diagonal (lower triangular) block of L */
+		block_t L_diag;
+		/** Blocks of L below the diagonal in this column, sorted by row */
+		mrpt::aligned_std_vector<row_block_t> L_below;
+		/** Columns with non-zero blocks of L in this row, sorted */
+		std::vector<size_t> L_row;
+
+		MRPT_MAKE_ALIGNED_OPERATOR_NEW
+	};
+
+	struct TEdge
+	{
+		/** A copy of the graph entry: (IDs, constraint) */
+		std::pair<mrpt::graphs::TPairNodeIDs, typename gst::edge_t> entry;
+		/** Indices in m_vars of the edge nodes, or INVALID_IDX for the root */
+		size_t var1, var2;
+		/** Jacobians and error at the linearization point */
+		typename gst::matrix_VxV_t J1, J2;
+		typename gst::Array_O err;
+
+		MRPT_MAKE_ALIGNED_OPERATOR_NEW
+	};
+
+	mrpt::aligned_std_vector<TVariable> m_vars;
+	mrpt::aligned_std_vector<TEdge> m_edges;
+	std::map<TNodeID, size_t> m_id2var;
+	/** Edge keys, in the same order than in the graph multimap, and their
+	 * index in m_edges */
+	std::vector<std::pair<mrpt::graphs::TPairNodeIDs, size_t>> m_known_edges;
+	TNodeID m_root{INVALID_NODEID};
+	pose_t m_root_pose;
+	TUpdateStats m_stats;
+
+	/** Scratch data for factorizing one column */
+	mrpt::aligned_std_vector<block_t> m_work;
+	std::vector<size_t> m_work_mark, m_work_rows;
+
+	/** Finds the new edges (and nodes) in the graph, returns the index of
+	 * the first variable touched by them, or m_vars.size() if none. Returns
+	 * false if an edge was removed. */
+	bool addNewEdges(const GRAPH_T& graph, size_t& first_affected);
+	void linearizeEdge(TEdge& e) const;
+	void relinearizeVariable(size_t v, size_t& first_affected);
+	/** Re-computes the columns [k,N-1] of L, and the matching part of y */
+	void factorize(const size_t k);
+	/** Back-substitution; returns the list of variables whose solution
+	 * changed */
+	void backSubstitution(const size_t k, std::vector<size_t>& changed);
+};
+
+}  // namespace mrpt::graphslam
+
+#include "CIncrementalGraphOptimizer_impl.h"
@@ -0,0 +1,383 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <algorithm>
+#include <iostream>
+#include <set>
+
+namespace mrpt::graphslam
+{
+template <class GRAPH_T>
+void CIncrementalGraphOptimizer<GRAPH_T>::reset()
+{
+	m_vars.clear();
+	m_edges.clear();
+	m_id2var.clear();
+	m_known_edges.clear();
+	m_root = INVALID_NODEID;
+}
+
+template <class GRAPH_T>
+void CIncrementalGraphOptimizer<GRAPH_T>::update(
+	GRAPH_T& graph, TResultInfoSpaLevMarq& out_info)
+{
+	MRPT_START
+
+	m_stats = TUpdateStats();
+	out_info.num_iters = 0;
+
+	// A new root invalidates everything:
+	if (graph.root != m_root)
+	{
+		reset();
+		m_root = graph.root;
+		auto it_root = graph.nodes.find(m_root);
+		ASSERTMSG_(it_root != graph.nodes.end(), "Root node has no pose");
+		m_root_pose = it_root->second;
+	}
+
+	const size_t nOldVars = m_vars.size();
+	size_t k = nOldVars;
+	if (!addNewEdges(graph, k))
+	{
+		// Edges were removed: start over.
+		if (options.verbose)
+			std::cout << "[CIncrementalGraphOptimizer] Edges were removed, "
+						 "re-building the problem.\n";
+		reset();
+		m_root = graph.root;
+		m_root_pose = graph.nodes.find(m_root)->second;
+		k = 0;
+		const bool ok = addNewEdges(graph, k);
+		ASSERT_(ok);
+	}
+	m_stats.num_new_nodes = m_vars.size() - std::min(nOldVars, m_vars.size());
+
+	// Iterate: solve the (partially) updated system, then relinearize the
+	// variables which moved too far from their linearization point.
+	std::vector<size_t> changed;
+	std::vector<char> is_changed(m_vars.size(), 0);
+	const size_t N = m_vars.size();
+	try
+	{
+		for (size_t iter = 0; iter < options.max_iterations && k < N; iter++)
+		{
+			out_info.num_iters = iter + 1;
+			factorize(k);
+			m_stats.num_refactorized_nodes += N - k;
+
+			backSubstitution(k, changed);
+			for (size_t v : changed) is_changed[v] = 1;
+
+			k = N;
+			for (size_t v : changed)
+			{
+				if (m_vars[v].delta.template lpNorm<Eigen::Infinity>() >
+					options.relinearize_threshold)
+				{
+					relinearizeVariable(v, k);
+					m_stats.num_relinearized_nodes++;
+				}
+			}
+			if (options.verbose)
+				std::cout << "[CIncrementalGraphOptimizer] Iter " << iter
+						  << ": " << changed.size()
+						  << " nodes changed, first to relinearize: "
+						  << (k < N ? std::to_string(k) : std::string("none"))
+						  << "\n";
+		}
+	}
+	catch (...)
+	{
+		reset();
+		throw;
+	}
+
+	// Write the new estimates back into the graph:
+	for (size_t v = 0; v < N; v++)
+	{
+		if (!is_changed[v]) continue;
+		const TVariable& var = m_vars[v];
+		pose_t p = var.lin_pose;
+		typename gst::Array_O incr;
+		for (size_t i = 0; i < DIM; i++) incr[i] = var.delta[i];
+		detail::AuxPoseOPlus<typename gst::edge_t, gst>::sumIncr(p, incr);
+		graph.nodes[var.id] = p;
+		m_stats.num_updated_nodes++;
+	}
+
+	double total_sq_err = 0;
+	for (const auto& e : m_edges) total_sq_err += e.err.squaredNorm();
+	out_info.final_total_sq_error = total_sq_err;
+
+	MRPT_END
+}
+
+template <class GRAPH_T>
+bool CIncrementalGraphOptimizer<GRAPH_T>::addNewEdges(
+	const GRAPH_T& graph, size_t& first_affected)
+{
+	// Walk the graph edges and the known ones in parallel, both sorted in the
+	// multimap order. New edges with repeated IDs are inserted after the
+	// existing ones, so known edges always come first.
+	std::vector<std::pair<mrpt::graphs::TPairNodeIDs, size_t>> all_edges;
+	all_edges.reserve(graph.edges.size());
+	std::vector<const typename gst::edge_map_entry_t*> new_edges;
+	std::set<TNodeID> new_nodes;
+	size_t kp = 0;
+	for (const auto& e : graph.edges)
+	{
+		if (kp < m_known_edges.size())
+		{
+			if (m_known_edges[kp].first == e.first)
+			{
+				all_edges.push_back(m_known_edges[kp++]);
+				continue;
+			}
+			if (m_known_edges[kp].first < e.first) return false;
+		}
+		const TNodeID ids[2] = {e.first.first, e.first.second};
+		if (ids[0] == ids[1]) continue;  // Self-loops are meaningless
+		new_edges.push_back(&e);
+		all_edges.emplace_back(e.first, INVALID_IDX);
+		for (TNodeID id : ids)
+			if (id != m_root && m_id2var.find(id) == m_id2var.end())
+				new_nodes.insert(id);
+	}
+	if (kp != m_known_edges.size()) return false;
+	m_stats.num_new_edges = new_edges.size();
+	if (new_edges.empty()) return true;
+
+	// New variables, in ascending ID order:
+	for (TNodeID id : new_nodes)
+	{
+		auto itP = graph.nodes.find(id);
+		ASSERTMSG_(itP != graph.nodes.end(), "Edge node has no global pose");
+		mrpt::keep_min(first_affected, m_vars.size());
+		m_id2var[id] = m_vars.size();
+		m_vars.resize(m_vars.size() + 1);
+		m_vars.back().id = id;
+		m_vars.back().lin_pose = itP->second;
+	}
+
+	// New edges:
+	size_t ne = 0;
+	for (auto& ke : all_edges)
+	{
+		if (ke.second != INVALID_IDX) continue;
+		const auto* e = new_edges[ne++];
+		ke.second = m_edges.size();
+		m_edges.resize(m_edges.size() + 1);
+		TEdge& edge = m_edges.back();
+		edge.entry = *e;
+		edge.var1 = edge.var2 = INVALID_IDX;
+		if (e->first.first != m_root) edge.var1 = m_id2var[e->first.first];
+		if (e->first.second != m_root) edge.var2 = m_id2var[e->first.second];
+		for (size_t v : {edge.var1, edge.var2})
+		{
+			if (v == INVALID_IDX) continue;
+			m_vars[v].edges.push_back(ke.second);
+			mrpt::keep_min(first_affected, v);
+		}
+		linearizeEdge(edge);
+	}
+	m_known_edges.swap(all_edges);
+	return true;
+}
+
+template <class GRAPH_T>
+void CIncrementalGraphOptimizer<GRAPH_T>::linearizeEdge(TEdge& e) const
+{
+	const pose_t& P1 =
+		e.var1 == INVALID_IDX ? m_root_pose : m_vars[e.var1].lin_pose;
+	const pose_t& P2 =
+		e.var2 == INVALID_IDX ? m_root_pose : m_vars[e.var2].lin_pose;
+	const auto& EDGE_POSE = e.entry.second.getPoseMean();
+
+	// DinvP1invP2 = inv(EDGE) * inv(P1) * P2 = (P2 \ominus P1) \ominus EDGE
+	const pose_t DinvP1invP2 = (P2 - P1) - EDGE_POSE;
+	detail::AuxErrorEval<typename gst::edge_t, gst>::computePseudoLnError(
+		DinvP1invP2, e.err, &e.entry);
+	gst::SE_TYPE::jacobian_dDinvP1invP2_depsilon(
+		-EDGE_POSE, P1, P2, &e.J1, &e.J2);
+}
+
+template <class GRAPH_T>
+void CIncrementalGraphOptimizer<GRAPH_T>::relinearizeVariable(
+	size_t v, size_t& first_affected)
+{
+	TVariable& var = m_vars[v];
+	// Move the linearization point to the current estimate. Since the
+	// estimate is lin_pose (+) delta, it does not change.
+	typename gst::Array_O incr;
+	for (size_t i = 0; i < DIM; i++) incr[i] = var.delta[i];
+	detail::AuxPoseOPlus<typename gst::edge_t, gst>::sumIncr(
+		var.lin_pose, incr);
+	var.delta.setZero();
+
+	mrpt::keep_min(first_affected, v);
+	for (size_t ei : var.edges)
+	{
+		TEdge& e = m_edges[ei];
+		linearizeEdge(e);
+		if (e.var1 != INVALID_IDX) mrpt::keep_min(first_affected, e.var1);
+		if (e.var2 != INVALID_IDX) mrpt::keep_min(first_affected, e.var2);
+	}
+}
+
+template <class GRAPH_T>
+void CIncrementalGraphOptimizer<GRAPH_T>::factorize(const size_t k)
+{
+	const size_t N = m_vars.size();
+
+	// Remove the old columns [k,N-1] of L:
+	for (size_t j = k; j < N; j++) m_vars[j].L_below.clear();
+	for (size_t i = k; i < N; i++)
+	{
+		auto& row = m_vars[i].L_row;
+		row.erase(std::lower_bound(row.begin(), row.end(), k), row.end());
+	}
+
+	m_work.resize(N);
+	m_work_mark.assign(N, INVALID_IDX);
+
+	typename gst::matrix_VxV_t JtJ;
+	for (size_t j = k; j < N; j++)
+	{
+		TVariable& var = m_vars[j];
+
+		// Column j of H (lower part) in a sparse accumulator, plus the
+		// gradient for the forward substitution:
+		m_work_rows.clear();
+		block_t Ajj = block_t::Zero();
+		typename gst::Array_O grad;
+		grad.fill(0);
+		for (size_t ei : var.edges)
+		{
+			const TEdge& e = m_edges[ei];
+			const bool first = (e.var1 == j);
+			const auto& J = first ? e.J1 : e.J2;
+			const auto& J_other = first ? e.J2 : e.J1;
+			const size_t other = first ? e.var2 : e.var1;
+
+			detail::AuxErrorEval<typename gst::edge_t, gst>::multiplyJtLambdaJ(
+				J, JtJ, &e.entry);
+			Ajj += JtJ;
+			detail::AuxErrorEval<typename gst::edge_t, gst>::multiply_Jt_W_err(
+				J, &e.entry, e.err, grad);
+
+			if (other == INVALID_IDX || other < j) continue;
+			// H(other,j) = J_other^t * W * J
+			detail::AuxErrorEval<typename gst::edge_t, gst>::
+				multiplyJ1tLambdaJ2(J_other, J, JtJ, &e.entry);
+			if (m_work_mark[other] != j)
+			{
+				m_work_mark[other] = j;
+				m_work[other] = JtJ;
+				m_work_rows.push_back(other);
+			}
+			else
+				m_work[other] += JtJ;
+		}
+
+		// Left-looking update with the previous columns:
+		//  A(i,j) -= L(i,p) * L(j,p)^t,  for all p with L(j,p)!=0, i>=j
+		vec_t b = -vec_t(grad);
+		for (size_t p : var.L_row)
+		{
+			const auto& Lp = m_vars[p].L_below;
+			auto it = std::lower_bound(
+				Lp.begin(), Lp.end(), j,
+				[](const row_block_t& a, size_t r) { return a.first < r; });
+			ASSERTDEB_(it != Lp.end() && it->first == j);
+			const block_t& Ljp = it->second;
+			Ajj.noalias() -= Ljp * Ljp.transpose();
+			b.noalias() -= Ljp * m_vars[p].y;
+			for (++it; it != Lp.end(); ++it)
+			{
+				const size_t i = it->first;
+				if (m_work_mark[i] != j)
+				{
+					m_work_mark[i] = j;
+					m_work[i].noalias() = -it->second * Ljp.transpose();
+					m_work_rows.push_back(i);
+				}
+				else
+					m_work[i].noalias() -= it->second * Ljp.transpose();
+			}
+		}
+
+		Eigen::LLT<block_t> llt(Ajj);
+		if (llt.info() != Eigen::Success)
+			THROW_EXCEPTION_FMT(
+				"Non positive definite Hessian at node #%u. Is the graph "
+				"connected to its root?",
+				static_cast<unsigned int>(var.id));
+		var.L_diag = llt.matrixL();
+
+		// Forward substitution: L(j,j) * y(j) = b(j)
+		var.y = var.L_diag.template triangularView<Eigen::Lower>().solve(b);
+
+		// L(i,j) = A(i,j) * L(j,j)^-t
+		std::sort(m_work_rows.begin(), m_work_rows.end());
+		var.L_below.reserve(m_work_rows.size());
+		for (size_t i : m_work_rows)
+		{
+			block_t Lij = var.L_diag.template triangularView<Eigen::Lower>()
+							  .solve(m_work[i].transpose())
+							  .transpose();
+			var.L_below.emplace_back(i, Lij);
+			m_vars[i].L_row.push_back(j);
+		}
+	}
+}
+
+template <class GRAPH_T>
+void CIncrementalGraphOptimizer<GRAPH_T>::backSubstitution(
+	const size_t k, std::vector<size_t>& changed)
+{
+	const size_t N = m_vars.size();
+	changed.clear();
+	std::vector<char> is_changed(N, 0);
+
+	// L^t * delta = y
+	for (size_t j = N; j-- > 0;)
+	{
+		TVariable& var = m_vars[j];
+		// Before the re-factorized part, y(j) and L(:,j) did not change, so
+		// delta(j) only changes if the variables it depends on did:
+		if (j < k)
+		{
+			bool any = false;
+			for (const auto& Lij : var.L_below)
+				if (is_changed[Lij.first])
+				{
+					any = true;
+					break;
+				}
+			if (!any) continue;
+		}
+		vec_t b = var.y;
+		for (const auto& Lij : var.L_below)
+			b.noalias() -= Lij.second.transpose() * m_vars[Lij.first].delta;
+		const vec_t new_delta =
+			var.L_diag.transpose().template triangularView<Eigen::Upper>().solve(
+				b);
+		if ((new_delta - var.delta).template lpNorm<Eigen::Infinity>() >
+			options.wildfire_threshold)
+		{
+			var.delta = new_delta;
+			is_changed[j] = 1;
+			changed.push_back(j);
+		}
+	}
+}
+
+}  // namespace mrpt::graphslam
@@ -316,6 +316,7 @@ void CICPCriteriaERD<GRAPH_T>::registerNewEdge(
 	parent_t::registerNewEdge(from, to, rel_edge);
 
 	this->m_graph->insertEdge(from, to, rel_edge);
+	this->reportNewEdge(from, to, rel_edge);
 }
 
 template <class GRAPH_T>
@@ -24,6 +24,7 @@
 #include <mrpt/graphslam/misc/TSlidingWindow.h>
 #include <mrpt/graphslam/misc/TUncertaintyPath.h>
 #include <mrpt/graphslam/misc/TNodeProps.h>
+#include <mrpt/graphslam/misc/CNodePositionsGrid.h>
 #include <mrpt/graphs/THypothesis.h>
 #include <mrpt/graphs/CHypothesisNotFoundException.h>
 
@@ -200,6 +201,43 @@ exponential.
  *   + \a Section       : VisualizationParameters
  *   + \a Default value : TRUE
  *   + \a Required      : FALSE
+ *
+ * - \b LC_use_spatial_index
+ *   + \a Section       : EdgeRegistrationDeciderParameters
+ *   + \a Default value : FALSE
+ *   + \a Required      : FALSE
+ *   + \a Description   : Find loop closure candidates with a grid index of
+ *   the node positions (see mrpt::graphslam::detail::CNodePositionsGrid)
+ *   instead of the map partitions. Candidates are the previous nodes within
+ *   a search radius of the current node, which grows with the odometry
+ *   uncertainty accumulated since each of them. Their cost does not grow
+ *   with the size of the map.
+ *
+ * - \b LC_spatial_index_resolution
+ *   + \a Section       : EdgeRegistrationDeciderParameters
+ *   + \a Default value : 2.0
+ *   + \a Required      : FALSE
+ *   + \a Description   : Size of the cells of the node positions index [m]
+ *
+ * - \b LC_search_radius
+ *   + \a Section       : EdgeRegistrationDeciderParameters
+ *   + \a Default value : 2.0
+ *   + \a Required      : FALSE
+ *   + \a Description   : Search radius for loop closure candidates when the
+ *   odometry uncertainty is zero [m]
+ *
+ * - \b LC_search_sigma_factor
+ *   + \a Section       : EdgeRegistrationDeciderParameters
+ *   + \a Default value : 3.0
+ *   + \a Required      : FALSE
+ *   + \a Description   : Number of standard deviations of the accumulated
+ *   odometry uncertainty added to \b LC_search_radius
+ *
+ * - \b LC_max_search_radius
+ *   + \a Section       : EdgeRegistrationDeciderParameters
+ *   + \a Default value : 10.0
+ *   + \a Required      : FALSE
+ *   + \a Description   : Upper bound of the search radius [m]
   *
  * \note Class contains an instance of the
  * mrpt::slam::CIncrementalMapPartitioner class and it parses the configuration
@@ -497,6 +535,21 @@ class CLoopCloserERD : public virtual mrpt::graphslam::deciders::
 		bool visualize_map_partitions;
 		std::string keystroke_map_partitions;
 
+		/**\brief Use the node positions index instead of the map
+		 * partitions for finding loop closure candidates
+		 */
+		bool LC_use_spatial_index;
+		/**\brief Cell size of the node positions index [m] */
+		double LC_spatial_index_resolution;
+		/**\brief Search radius for zero odometry uncertainty [m] */
+		double LC_search_radius;
+		/**\brief Standard deviations of the odometry uncertainty added to
+		 * the search radius
+		 */
+		double LC_search_sigma_factor;
+		/**\brief Upper bound of the search radius [m] */
+		double LC_max_search_radius;
+
 		double offset_y_map_partitions;
 		int text_index_map_partitions;
 
@@ -605,6 +658,37 @@ class CLoopCloserERD : public virtual mrpt::graphslam::deciders::
 	 * \sa checkPartitionsForLC
 	 */
 	void evaluatePartitionsForLC(const partitions_t& partitions);
+	/**\brief Evaluate the potential loop closures between the nodes of
+	 * groupA (lower nodeIDs) and those of groupB.
+	 *
+	 * \sa evaluatePartitionsForLC
+	 */
+	void evaluateGroupsForLC(
+		const std::vector<uint32_t>& groupA,
+		const std::vector<uint32_t>& groupB);
+	/**\brief Add the latest nodes to the node positions index.
+	 *
+	 * \param[in] full_update Re-insert all the nodes, with their current
+	 * (optimized) positions.
+	 *
+	 * \sa findLCCandidatesInIndex
+	 */
+	void updateNodePositionsIndex(bool full_update = false);
+	/**\brief Find loop closure candidates for the latest node in the node
+	 * positions index.
+	 *
+	 * groupB is filled with the latest nodes and groupA with previous nodes
+	 * near the latest one, i.e. within a radius growing with the odometry
+	 * uncertainty accumulated between them (see \b LC_search_radius, \b
+	 * LC_search_sigma_factor).
+	 *
+	 * \return True if there are enough candidates, and they differ from the
+	 * ones found in the previous call.
+	 *
+	 * \sa evaluateGroupsForLC
+	 */
+	bool findLCCandidatesInIndex(
+		std::vector<uint32_t>* groupA, std::vector<uint32_t>* groupB);
 
 	bool computeDominantEigenVector(
 		const mrpt::math::CMatrixDouble& consist_matrix,
@@ -716,7 +800,8 @@ class CLoopCloserERD : public virtual mrpt::graphslam::deciders::
 	 * algorithm
 	 * \param[in] ending_node Specify the nodeID whose uncertainty wrt the
 	 * starting_node, we are interested in computing. If given, method
-	 * execution ends when this path is computed.
+	 * execution ends when this path is computed, so only the nodes with a
+	 * path less uncertain than it are visited, regardless of the graph size.
 	 */
 	void execDijkstraProjection(
 		mrpt::graphs::TNodeID starting_node = 0,
@@ -822,11 +907,40 @@ class CLoopCloserERD : public virtual mrpt::graphslam::deciders::
 	 * again if nothing changed in them.
 	 */
 	std::map<int, std::vector<uint32_t>> m_partitionID_to_prev_nodes_list;
+	/**\name Node positions index */
+	/**\{ */
+	/**\brief Spatial index of the node positions, used if \b
+	 * TLoopClosureParams::LC_use_spatial_index is set
+	 */
+	mrpt::graphslam::detail::CNodePositionsGrid m_node_positions_index;
+	/**\brief Translational variance of the odometry edges accumulated from
+	 * the root up to each nodeID
+	 */
+	std::vector<double> m_odometry_cum_variance;
+	/**\brief Last loop closure candidates found in the index */
+	std::vector<uint32_t> m_last_LC_candidates;
+	/**\} */
 	/**\brief Map that stores the lowest uncertainty path towards a node.
 	 * Starting node depends on the starting node as used in the
 	 * execDijkstraProjection method
 	 */
 	typename std::map<mrpt::graphs::TNodeID, path_t*> m_node_optimal_paths;
+	/**\brief Neighbors of each node, used in execDijkstraProjection */
+	std::map<mrpt::graphs::TNodeID, std::set<mrpt::graphs::TNodeID>>
+		m_neighbors_of;
+	/**\brief Number of edges and nodes of the graph that m_neighbors_of
+	 * accounts for */
+	size_t m_neighbors_of_num_edges;
+	size_t m_neighbors_of_num_nodes;
+	/**\brief Bring m_neighbors_of up to date with the graph edges.
+	 *
+	 * The edges registered by this class are added as they are inserted, and
+	 * those linking each new node with the previous one (as the NRD does) are
+	 * looked up directly. The neighbors are only recomputed from all the
+	 * edges if the edge count changed otherwise, e.g. if the optimizer
+	 * removed outliers.
+	 */
+	void updateNeighborsOf();
 	/**\brief Keep track of the first recorded laser scan so that it can be
 	 * assigned to the root node when the NRD adds the first *two* nodes to the
 	 * graph.
@@ -14,6 +14,9 @@
 #include <mrpt/opengl/CEllipsoid.h>
 #include <mrpt/opengl/CSphere.h>
 #include <mrpt/math/data_utils.h>
+#include <mrpt/obs/obs_utils.h>
+#include <mrpt/opengl/CPlanarLaserScan.h>
+#include <mrpt/config/CConfigFile.h>
 
 namespace mrpt::graphslam::deciders
 {
@@ -25,6 +28,8 @@ CLoopCloserERD<GRAPH_T>::CLoopCloserERD()
 	  m_curr_node_covariance_color(160, 160, 160, /*alpha = */ 255),
 	  m_partitions_full_update(false),
 	  m_is_first_time_node_reg(true),
+	  m_neighbors_of_num_edges(0),
+	  m_neighbors_of_num_nodes(0),
 	  m_dijkstra_node_count_thresh(3)
 {
 	this->initializeLoggers("CLoopCloserERD");
@@ -140,14 +145,31 @@ bool CLoopCloserERD<GRAPH_T>::updateState(
 			 this->m_just_inserted_lc)
 				? true
 				: false;
-		this->updateMapPartitions(
-			m_partitions_full_update,
-			/* is_first_time_node_reg = */ num_registered == 2);
+		if (m_lc_params.LC_use_spatial_index)
+		{
+			// same schedule for syncing the index with the optimized poses
+			this->updateNodePositionsIndex(m_partitions_full_update);
 
-		// check for loop closures
-		partitions_t partitions_for_LC;
-		this->checkPartitionsForLC(&partitions_for_LC);
-		this->evaluatePartitionsForLC(partitions_for_LC);
+			// check for loop closures near the current node
+			std::vector<uint32_t> groupA, groupB;
+			if (this->findLCCandidatesInIndex(&groupA, &groupB))
+			{
+				this->m_time_logger.enter("LoopClosureEvaluation");
+				this->evaluateGroupsForLC(groupA, groupB);
+				this->m_time_logger.leave("LoopClosureEvaluation");
+			}
+		}
+		else
+		{
+			this->updateMapPartitions(
+				m_partitions_full_update,
+				/* is_first_time_node_reg = */ num_registered == 2);
+
+			// check for loop closures
+			partitions_t partitions_for_LC;
+			this->checkPartitionsForLC(&partitions_for_LC);
+			this->evaluatePartitionsForLC(partitions_for_LC);
+		}
 
 		if (m_visualize_curr_node_covariance)
 		{
@@ -562,41 +584,52 @@ void CLoopCloserERD<GRAPH_T>::evaluatePartitionsForLC(
 			partition, &groupA, &groupB,
 			/*max_nodes_in_group=*/5);
 
-		// generate hypotheses pool
-		hypotsp_t hypots_pool;
-		this->generateHypotsPool(groupA, groupB, &hypots_pool);
+		this->evaluateGroupsForLC(groupA, groupB);
+	}  // for each partition
 
-		// compute the pair-wise consistency matrix
-		CMatrixDouble consist_matrix(hypots_pool.size(), hypots_pool.size());
-		this->generatePWConsistenciesMatrix(
-			groupA, groupB, hypots_pool, &consist_matrix);
+	MRPT_LOG_DEBUG_STREAM("\n" << this->header_sep);
+	this->m_time_logger.leave("LoopClosureEvaluation");
 
-		// evaluate resulting matrix - fill valid hypotheses
-		hypotsp_t valid_hypots;
-		this->evalPWConsistenciesMatrix(
-			consist_matrix, hypots_pool, &valid_hypots);
+	MRPT_END;
+}
 
-		// registering the indicated/valid hypotheses
-		if (valid_hypots.size())
-		{
-			MRPT_LOG_WARN_STREAM("Registering Hypotheses...");
-			for (typename hypotsp_t::iterator it = valid_hypots.begin();
-				 it != valid_hypots.end(); ++it)
-			{
-				this->registerHypothesis(**it);
-			}
-		}
-		// delete all hypotheses - generated in the heap...
-		MRPT_LOG_DEBUG_STREAM("Deleting the generated hypotheses pool...");
-		for (typename hypotsp_t::iterator it = hypots_pool.begin();
-			 it != hypots_pool.end(); ++it)
+template <class GRAPH_T>
+void CLoopCloserERD<GRAPH_T>::evaluateGroupsForLC(
+	const std::vector<uint32_t>& groupA, const std::vector<uint32_t>& groupB)
+{
+	MRPT_START;
+	using namespace mrpt::math;
+
+	// generate hypotheses pool
+	hypotsp_t hypots_pool;
+	this->generateHypotsPool(groupA, groupB, &hypots_pool);
+
+	// compute the pair-wise consistency matrix
+	CMatrixDouble consist_matrix(hypots_pool.size(), hypots_pool.size());
+	this->generatePWConsistenciesMatrix(
+		groupA, groupB, hypots_pool, &consist_matrix);
+
+	// evaluate resulting matrix - fill valid hypotheses
+	hypotsp_t valid_hypots;
+	this->evalPWConsistenciesMatrix(consist_matrix, hypots_pool, &valid_hypots);
+
+	// registering the indicated/valid hypotheses
+	if (valid_hypots.size())
+	{
+		MRPT_LOG_WARN_STREAM("Registering Hypotheses...");
+		for (typename hypotsp_t::iterator it = valid_hypots.begin();
+			 it != valid_hypots.end(); ++it)
 		{
-			delete *it;
+			this->registerHypothesis(**it);
 		}
-	}  // for each partition
-
-	MRPT_LOG_DEBUG_STREAM("\n" << this->header_sep);
-	this->m_time_logger.leave("LoopClosureEvaluation");
+	}
+	// delete all hypotheses - generated in the heap...
+	MRPT_LOG_DEBUG_STREAM("Deleting the generated hypotheses pool...");
+	for (typename hypotsp_t::iterator it = hypots_pool.begin();
+		 it != hypots_pool.end(); ++it)
+	{
+		delete *it;
+	}
 
 	MRPT_END;
 }
@@ -1002,6 +1035,51 @@ void CLoopCloserERD<GRAPH_T>::generatePWConsistenciesMatrix(
 		<< "\tgroupB: " << getSTLContainerAsString(groupB) << endl
 		<< "\tHypots pool Size: " << hypots_pool.size());
 
+	// index the hypotheses by their ends instead of searching the pool for
+	// every element. Keep the first one of duplicates, as findHypotByEnds.
+	std::map<std::pair<TNodeID, TNodeID>, hypot_t*> hypots_by_ends;
+	for (typename hypotsp_t::const_iterator it = hypots_pool.begin();
+		 it != hypots_pool.end(); ++it)
+	{
+		hypots_by_ends.insert(make_pair(make_pair((*it)->from, (*it)->to), *it));
+	}
+	auto find_hypot = [&hypots_by_ends](TNodeID from, TNodeID to) {
+		const auto search = hypots_by_ends.find(make_pair(from, to));
+		if (search == hypots_by_ends.end())
+		{
+			throw mrpt::graphs::HypothesisNotFoundException(from, to);
+		}
+		return search->second;
+	};
+
+	// Dijkstra links between the nodes of the same group. Each one is computed
+	// at most once, and only if needed by an element with valid hypotheses.
+	std::map<std::pair<TNodeID, TNodeID>, path_t> dijkstra_links;
+	auto find_link = [this, &dijkstra_links](
+						 TNodeID from, TNodeID to,
+						 const paths_t* opt_paths) -> const path_t& {
+		if (opt_paths)
+		{
+			return *this->findPathByEnds(
+				*opt_paths, from, to, /*throw_exc=*/true);
+		}
+		const auto key = make_pair(from, to);
+		auto search = dijkstra_links.find(key);
+		if (search == dijkstra_links.end())
+		{
+			this->execDijkstraProjection(
+				/*starting_node=*/from, /*ending_node=*/to);
+			const path_t* p = this->queryOptimalPath(to);
+			// an empty path lets generatePWConsistencyElement handle it
+			search = dijkstra_links.insert(make_pair(key, p ? *p : path_t()))
+						 .first;
+		}
+		return search->second;
+	};
+
+	// Only the elements between valid hypotheses are computed, the rest stay
+	// zero.
+	size_t num_evaluated = 0;
 	// b1
 	for (std::vector<uint32_t>::const_iterator b1_it = groupB.begin();
 		 b1_it != groupB.end(); ++b1_it)
@@ -1019,83 +1097,33 @@ void CLoopCloserERD<GRAPH_T>::generatePWConsistenciesMatrix(
 				 a1_it != groupA.end(); ++a1_it)
 			{
 				TNodeID a1 = *a1_it;
-				hypot_t* hypot_b2_a1 =
-					this->findHypotByEnds(hypots_pool, b2, a1);
-				// MRPT_LOG_DEBUG_STREAM("hypot_b2_a1: " <<
-				// hypot_b2_a1->getAsString());
+				hypot_t* hypot_b2_a1 = find_hypot(b2, a1);
+				if (!hypot_b2_a1->is_valid) continue;
 
 				// a2
 				for (std::vector<uint32_t>::const_iterator a2_it = a1_it + 1;
 					 a2_it != groupA.end(); ++a2_it)
 				{
 					TNodeID a2 = *a2_it;
-					hypot_t* hypot_b1_a2 =
-						this->findHypotByEnds(hypots_pool, b1, a2);
-					// MRPT_LOG_DEBUG_STREAM("hypot_b1_a2: " <<
-					// hypot_b1_a2->getAsString());
-
-					double consistency;
-
-					// compute consistency element
-					if (hypot_b2_a1->is_valid && hypot_b1_a2->is_valid)
-					{
-						// extract vector of hypotheses that connect the given
-						// nodes,
-						// instead of passing the whole hypothesis pool.
-						hypotsp_t extracted_hypots;
-						extracted_hypots.push_back(hypot_b2_a1);
-						extracted_hypots.push_back(hypot_b1_a2);
-
-						paths_t* curr_opt_paths = NULL;
-						if (groupA_opt_paths || groupB_opt_paths)
-						{  // fill curr_opt_paths
-							curr_opt_paths = new paths_t();
-						}
-
-						// decide on additional optimal paths
-						if (curr_opt_paths)
-						{
-							// groupA
-							if (groupA_opt_paths)
-							{  // a1 -> a2 optimal path
-								const path_t* p = this->findPathByEnds(
-									*groupA_opt_paths, a1, a2,
-									/*throw_exc=*/true);
-								curr_opt_paths->push_back(*p);
-							}
-							else
-							{  // empty
-								curr_opt_paths->push_back(path_t());
-							}
-
-							if (groupB_opt_paths)
-							{  // b1 -> b2 optimal path
-								const path_t* p = this->findPathByEnds(
-									*groupB_opt_paths, b1, b2,
-									/*throw_exc=*/true);
-								curr_opt_paths->push_back(*p);
-							}
-							else
-							{  // empty
-								curr_opt_paths->push_back(path_t());
-							}
-						}
-
-						consistency = this->generatePWConsistencyElement(
-							a1, a2, b1, b2, extracted_hypots, curr_opt_paths);
-
-						delete curr_opt_paths;
-					}
-					else
-					{  //  null those that don't look good
-						consistency = 0;
-					}
-
-					// MRPT_LOG_DEBUG_STREAM(
-					//"Adding hypothesis consistency for nodeIDs: "
-					//<< "[b1] " << b1 << ", [b2] -> " << b2
-					//<< ", [a1] -> " << a1 << ", [a2] -> " << a2
-					//<< " ==> " << consistency << endl);
+					hypot_t* hypot_b1_a2 = find_hypot(b1, a2);
+					if (!hypot_b1_a2->is_valid) continue;
+
+					// extract vector of hypotheses that connect the given
+					// nodes, instead of passing the whole hypothesis pool.
+					hypotsp_t extracted_hypots;
+					extracted_hypots.push_back(hypot_b2_a1);
+					extracted_hypots.push_back(hypot_b1_a2);
+
+					// a1 -> a2, b1 -> b2 optimal paths
+					paths_t curr_opt_paths;
+					curr_opt_paths.push_back(
+						find_link(a1, a2, groupA_opt_paths));
+					curr_opt_paths.push_back(
+						find_link(b1, b2, groupB_opt_paths));
+
+					double consistency = this->generatePWConsistencyElement(
+						a1, a2, b1, b2, extracted_hypots, &curr_opt_paths);
+					num_evaluated++;
 
 					// fill the PW consistency matrix corresponding element -
 					// symmetrical
@@ -1104,14 +1132,13 @@ void CLoopCloserERD<GRAPH_T>::generatePWConsistenciesMatrix(
 
 					(*consist_matrix)(id1, id2) = consistency;
 					(*consist_matrix)(id2, id1) = consistency;
-
-					// MRPT_LOG_DEBUG_STREAM("id1 = " << id1 << "\t|"
-					//<< "id2 = " << id2 << "\t|"
-					//<< "consistency = " << consistency);
 				}
 			}
 		}
 	}
+	MRPT_LOG_DEBUG_STREAM(
+		"Evaluated consistency elements: "
+		<< num_evaluated << " | Dijkstra links: " << dijkstra_links.size());
 
 	// MRPT_LOG_WARN_STREAM("Consistency matrix:" << endl
 	//<< this->header_sep << endl
@@ -1174,7 +1201,7 @@ double CLoopCloserERD<GRAPH_T>::generatePWConsistencyElement(
 
 	// b1 ==> b2
 	const path_t* path_b1_b2;
-	if (!opt_paths || opt_paths->rend()->isEmpty())
+	if (!opt_paths || opt_paths->rbegin()->isEmpty())
 	{
 		MRPT_LOG_DEBUG_STREAM(
 			"Running djkstra [b1] " << b1 << " => [b2] " << b2);
@@ -1376,13 +1403,15 @@ void CLoopCloserERD<GRAPH_T>::execDijkstraProjection(
 		return;
 	}
 
-	// keep track of the nodes that I have visited
-	std::vector<bool> visited_nodes(this->m_graph->nodeCount(), false);
+	// keep track of the nodes that I have visited. With an ending node, only
+	// those around the starting node are, so nothing of the size of the
+	// graph is allocated or scanned.
+	std::set<TNodeID> visited_nodes;
 	m_node_optimal_paths.clear();
 
 	// get the neighbors of each node
-	std::map<TNodeID, std::set<TNodeID>> neighbors_of;
-	this->m_graph->getAdjacencyMatrix(neighbors_of);
+	this->updateNeighborsOf();
+	const std::map<TNodeID, std::set<TNodeID>>& neighbors_of = m_neighbors_of;
 
 	// initialize a pool of TUncertaintyPaths - draw the minimum-uncertainty
 	// path during
@@ -1401,74 +1430,19 @@ void CLoopCloserERD<GRAPH_T>::execDijkstraProjection(
 		pool_of_paths.insert(path_between_neighbors);
 	}
 	// just visited the first node
-	visited_nodes.at(starting_node) = true;
-
-	//// TODO Remove these - >>>>>>>>>>>>>>>>>>>>
-	//// printing the pool for verification
-	// cout << "Pool of Paths: " << endl;
-	// for (typename std::set<path_t*>::const_iterator it =
-	// pool_of_paths.begin();
-	// it != pool_of_paths.end(); ++it) {
-	// printSTLContainer((*it)->nodes_traversed);
-	//}
-	// cout << "------ Done with the starting node ... ------" << endl;
-	// int iters = 0;
-	//// TODO Remove these - <<<<<<<<<<<<<<<<<<<<< vvvUNCOMMENT BELOW AS WELLvvv
+	visited_nodes.insert(starting_node);
 
-	while (true)
+	// if an ending nodeID has been specified, end the method when the path to
+	// it is found.
+	while (!pool_of_paths.empty() &&
+		   (ending_node == INVALID_NODEID || !visited_nodes.count(ending_node)))
 	{
-		// if there is at least one false, exit loop
-		for (std::vector<bool>::const_iterator it = visited_nodes.begin();
-			 it != visited_nodes.end(); ++it)
-		{
-			if (!*it)
-			{
-				break;
-			}
-		}
-
-		// if an ending nodeID has been specified, end the method when the path
-		// to
-		// it is found.
-		if (ending_node != INVALID_NODEID)
-		{
-			if (visited_nodes.at(ending_node))
-			{
-				// MRPT_LOG_DEBUG_STREAM(dijkstra_end);
-				this->m_time_logger.leave("Dijkstra Projection");
-				return;
-			}
-		}
-
 		path_t* optimal_path = this->popMinUncertaintyPath(&pool_of_paths);
 		TNodeID dest = optimal_path->getDestination();
 
-		//// TODO Remove these - >>>>>>>>>>>>>>>>>>>> ^^^UNCOMMENT ABOVE AS
-		/// WELL^^^
-		// cout << iters << " " << std::string(40, '>') << endl;
-		// cout << "current path Destination: " << dest << endl;
-		//// printing the pool for verification
-		// cout << "Pool of Paths: " << endl;
-		// for (typename std::set<path_t*>::const_iterator
-		// it = pool_of_paths.begin();
-		// it != pool_of_paths.end(); ++it) {
-		// printSTLContainer((*it)->nodes_traversed);
-		//}
-		// cout << "Nodes visited: " << endl;
-		// std::vector<int> tmp_vec;
-		// for (int i = 0; i != visited_nodes.size(); ++i) {
-		// tmp_vec.push_back(i);
-		//}
-		// printSTLContainer(tmp_vec); cout << endl; // indices of numbers
-		// printSTLContainer(visited_nodes);         // actual flags
-		// cout << std::string(40, '<') << " " << iters++ << endl;
-		// mrpt::system::pause();
-		//// TODO Remove these - <<<<<<<<<<<<<<<<<<<<<
-
-		if (!visited_nodes.at(dest))
+		if (visited_nodes.insert(dest).second)
 		{
 			m_node_optimal_paths[dest] = optimal_path;
-			visited_nodes.at(dest) = true;
 
 			// for all the edges leaving this node .. compose the transforms
 			// with the
@@ -1476,13 +1450,69 @@ void CLoopCloserERD<GRAPH_T>::execDijkstraProjection(
 			this->addToPaths(
 				&pool_of_paths, *optimal_path, neighbors_of.at(dest));
 		}
+		else
+		{
+			delete optimal_path;
+		}
 	}
+	for (path_t* p : pool_of_paths) delete p;
 
 	// MRPT_LOG_DEBUG_STREAM(dijkstra_end);
 	this->m_time_logger.leave("Dijkstra Projection");
 	MRPT_END;
 }
 
+template <class GRAPH_T>
+void CLoopCloserERD<GRAPH_T>::updateNeighborsOf()
+{
+	using mrpt::graphs::TNodeID;
+
+	const size_t num_edges = this->m_graph->edgeCount();
+	const size_t num_nodes = this->m_graph->nodeCount();
+	if (num_edges == m_neighbors_of_num_edges &&
+		num_nodes == m_neighbors_of_num_nodes)
+	{
+		return;
+	}
+
+	// new nodes, each one linked to the previous one by the NRD: add these
+	// edges, if they are all the new ones.
+	if (num_nodes > m_neighbors_of_num_nodes &&
+		num_edges > m_neighbors_of_num_edges)
+	{
+		std::vector<std::pair<TNodeID, TNodeID>> new_links;
+		size_t num_new_edges = 0;
+		for (TNodeID nodeID = std::max<size_t>(m_neighbors_of_num_nodes, 1);
+			 nodeID < num_nodes; ++nodeID)
+		{
+			const size_t n = this->m_graph->edges.count(
+								 std::make_pair(nodeID - 1, nodeID)) +
+							 this->m_graph->edges.count(
+								 std::make_pair(nodeID, nodeID - 1));
+			if (n) new_links.emplace_back(nodeID - 1, nodeID);
+			num_new_edges += n;
+		}
+		if (num_new_edges == num_edges - m_neighbors_of_num_edges)
+		{
+			for (const auto& l : new_links)
+			{
+				m_neighbors_of[l.first].insert(l.second);
+				m_neighbors_of[l.second].insert(l.first);
+			}
+			m_neighbors_of_num_edges = num_edges;
+			m_neighbors_of_num_nodes = num_nodes;
+			return;
+		}
+	}
+
+	this->m_time_logger.enter("updateNeighborsOf");
+	m_neighbors_of.clear();
+	this->m_graph->getAdjacencyMatrix(m_neighbors_of);
+	m_neighbors_of_num_edges = num_edges;
+	m_neighbors_of_num_nodes = num_nodes;
+	this->m_time_logger.leave("updateNeighborsOf");
+}
+
 template <class GRAPH_T>
 void CLoopCloserERD<GRAPH_T>::addToPaths(
 	std::set<path_t*>* pool_of_paths, const path_t& current_path,
@@ -1762,6 +1792,10 @@ void CLoopCloserERD<GRAPH_T>::registerNewEdge(
 
 	//  actuall registration
 	this->m_graph->insertEdge(from, to, rel_edge);
+	this->reportNewEdge(from, to, rel_edge);
+	m_neighbors_of[from].insert(to);
+	m_neighbors_of[to].insert(from);
+	m_neighbors_of_num_edges++;
 
 	MRPT_END;
 }
@@ -2370,6 +2404,8 @@ void CLoopCloserERD<GRAPH_T>::loadParams(const std::string& source_fname)
 		source_fname, "EdgeRegistrationDeciderParameters");
 	m_lc_params.loadFromConfigFileName(
 		source_fname, "EdgeRegistrationDeciderParameters");
+	m_node_positions_index.setResolution(
+		m_lc_params.LC_spatial_index_resolution);
 
 	mrpt::config::CConfigFile source(source_fname);
 
@@ -2544,6 +2580,178 @@ void CLoopCloserERD<GRAPH_T>::updateMapPartitions(
 	MRPT_END;
 }  // end of updateMapPartitions
 
+template <class GRAPH_T>
+void CLoopCloserERD<GRAPH_T>::updateNodePositionsIndex(
+	bool full_update /* = false */)
+{
+	MRPT_START;
+	using namespace mrpt::math;
+	using namespace std;
+	using mrpt::graphs::TNodeID;
+	this->m_time_logger.enter("updateNodePositionsIndex");
+
+	const TNodeID curr_nodeID = this->m_graph->nodeCount() - 1;
+
+	// accumulate the translational variance of the odometry edges
+	// (nodeID-1 => nodeID) from the root up to each node
+	for (TNodeID nodeID = m_odometry_cum_variance.size();
+		 nodeID <= curr_nodeID; ++nodeID)
+	{
+		double cum_variance = 0;
+		if (nodeID > 0)
+		{
+			cum_variance = m_odometry_cum_variance[nodeID - 1];
+			const auto search =
+				this->m_graph->edges.find(make_pair(nodeID - 1, nodeID));
+			if (search != this->m_graph->edges.end())
+			{
+				CMatrixDouble33 cov_mat;
+				search->second.getCovariance(cov_mat);
+				const double edge_variance = cov_mat(0, 0) + cov_mat(1, 1);
+				if (std::isfinite(edge_variance))
+				{
+					cum_variance += edge_variance;
+				}
+			}
+		}
+		m_odometry_cum_variance.push_back(cum_variance);
+	}
+
+	// node positions change after each optimization: re-insert all of them in
+	// full updates, otherwise just add the new ones.
+	if (full_update)
+	{
+		m_node_positions_index.setResolution(
+			m_lc_params.LC_spatial_index_resolution);
+	}
+	for (TNodeID nodeID = m_node_positions_index.size();
+		 nodeID <= curr_nodeID; ++nodeID)
+	{
+		const auto search = this->m_graph->nodes.find(nodeID);
+		if (search == this->m_graph->nodes.end())
+		{
+			MRPT_LOG_WARN_STREAM("Couldn't find pose for nodeID " << nodeID);
+			continue;
+		}
+		m_node_positions_index.insert(
+			nodeID, search->second.x(), search->second.y());
+	}
+
+	this->m_time_logger.leave("updateNodePositionsIndex");
+	MRPT_END;
+}  // end of updateNodePositionsIndex
+
+template <class GRAPH_T>
+bool CLoopCloserERD<GRAPH_T>::findLCCandidatesInIndex(
+	std::vector<uint32_t>* groupA, std::vector<uint32_t>* groupB)
+{
+	MRPT_START;
+	using namespace mrpt;
+	using namespace mrpt::containers;
+	using namespace mrpt::math;
+	using namespace std;
+	using mrpt::graphs::TNodeID;
+
+	ASSERTDEB_(groupA);
+	ASSERTDEB_(groupB);
+	groupA->clear();
+	groupB->clear();
+
+	// same size as the groups the partitions are split to
+	const size_t max_nodes_in_group = 5;
+	const TNodeID curr_nodeID = this->m_graph->nodeCount() - 1;
+	if (curr_nodeID <= m_lc_params.LC_min_nodeid_diff + max_nodes_in_group ||
+		curr_nodeID >= m_odometry_cum_variance.size())
+	{
+		return false;
+	}
+	this->m_time_logger.enter("findLCCandidatesInIndex");
+
+	// groupB: the latest nodes
+	for (TNodeID nodeID = curr_nodeID + 1 - max_nodes_in_group;
+		 nodeID <= curr_nodeID; ++nodeID)
+	{
+		groupB->push_back(nodeID);
+	}
+
+	// The uncertainty of the current node wrt a previous one is bounded by
+	// the accumulated odometry uncertainty between them. Search in the
+	// largest radius, then check each node against its own.
+	const double curr_cum_variance = m_odometry_cum_variance[curr_nodeID];
+	auto search_radius = [&](double variance) {
+		return std::min(
+			m_lc_params.LC_max_search_radius,
+			m_lc_params.LC_search_radius +
+				m_lc_params.LC_search_sigma_factor *
+					std::sqrt(std::max(0.0, variance)));
+	};
+	const auto& curr_pos = m_node_positions_index.getPosition(curr_nodeID);
+	std::vector<TNodeID> nodes_near;
+	m_node_positions_index.radiusSearch(
+		curr_pos.x, curr_pos.y, search_radius(curr_cum_variance), nodes_near);
+
+	// only nodes old enough for a loop closure with every node of groupB
+	std::vector<TNodeID> remote_nodes;
+	TNodeID closest_nodeID = INVALID_NODEID;
+	double closest_dist = 0;
+	for (const TNodeID nodeID : nodes_near)
+	{
+		if (nodeID + m_lc_params.LC_min_nodeid_diff >= groupB->front()) break;
+
+		const double dist =
+			(m_node_positions_index.getPosition(nodeID) - curr_pos).norm();
+		if (dist > search_radius(
+					   curr_cum_variance - m_odometry_cum_variance[nodeID]))
+		{
+			continue;
+		}
+		remote_nodes.push_back(nodeID);
+		if (closest_nodeID == INVALID_NODEID || dist < closest_dist)
+		{
+			closest_nodeID = nodeID;
+			closest_dist = dist;
+		}
+	}
+	if (remote_nodes.size() <
+		static_cast<size_t>(m_lc_params.LC_min_remote_nodes))
+	{
+		this->m_time_logger.leave("findLCCandidatesInIndex");
+		return false;
+	}
+
+	// groupA: the remote nodes closest in ID to the closest one in space, i.e.
+	// from the same previous visit to the current place
+	std::stable_sort(
+		remote_nodes.begin(), remote_nodes.end(),
+		[closest_nodeID](TNodeID n1, TNodeID n2) {
+			return absDiff(n1, closest_nodeID) < absDiff(n2, closest_nodeID);
+		});
+	if (remote_nodes.size() > max_nodes_in_group)
+	{
+		remote_nodes.resize(max_nodes_in_group);
+	}
+	std::sort(remote_nodes.begin(), remote_nodes.end());
+	groupA->assign(remote_nodes.begin(), remote_nodes.end());
+
+	this->m_time_logger.leave("findLCCandidatesInIndex");
+
+	// same candidates as in the previous check - no need to check them again
+	if (*groupA == m_last_LC_candidates)
+	{
+		return false;
+	}
+	m_last_LC_candidates = *groupA;
+
+	MRPT_LOG_WARN_STREAM(
+		"Found potential loop closures:"
+		<< endl
+		<< "\tgroupA: " << getSTLContainerAsString(*groupA).c_str() << endl
+		<< "\tgroupB: " << getSTLContainerAsString(*groupB).c_str() << endl
+		<< "\tSearch radius: " << search_radius(curr_cum_variance));
+	return true;
+	MRPT_END;
+}  // end of findLCCandidatesInIndex
+
 // TLaserParams
 // //////////////////////////////////
 
@@ -2636,6 +2844,16 @@ void CLoopCloserERD<GRAPH_T>::TLoopClosureParams::dumpToTextStream(
 	   << full_partition_per_nodes << endl;
 	ss << "Visualize map partitions                              = "
 	   << (visualize_map_partitions ? "TRUE" : "FALSE") << endl;
+	ss << "Use node positions index for loop closures            = "
+	   << (LC_use_spatial_index ? "TRUE" : "FALSE") << endl;
+	if (LC_use_spatial_index)
+	{
+		ss << "Node positions index resolution                       = "
+		   << LC_spatial_index_resolution << endl;
+		ss << "Search radius [base, sigma factor, max]               = "
+		   << LC_search_radius << ", " << LC_search_sigma_factor << ", "
+		   << LC_max_search_radius << endl;
+	}
 
 	out << mrpt::format("%s", ss.str().c_str());
 
@@ -2658,6 +2876,17 @@ void CLoopCloserERD<GRAPH_T>::TLoopClosureParams::loadFromConfigFile(
 		source.read_int(section, "full_partition_per_nodes", 50, false);
 	visualize_map_partitions = source.read_bool(
 		"VisualizationParameters", "visualize_map_partitions", true, false);
+	LC_use_spatial_index =
+		source.read_bool(section, "LC_use_spatial_index", false, false);
+	LC_spatial_index_resolution =
+		source.read_double(section, "LC_spatial_index_resolution", 2.0, false);
+	LC_search_radius =
+		source.read_double(section, "LC_search_radius", 2.0, false);
+	LC_search_sigma_factor =
+		source.read_double(section, "LC_search_sigma_factor", 3.0, false);
+	LC_max_search_radius =
+		source.read_double(section, "LC_max_search_radius", 10.0, false);
+	ASSERT_(LC_spatial_index_resolution > 0);
 
 	has_read_config = true;
 	MRPT_END;
@@ -19,6 +19,7 @@
 #include <mrpt/poses/CPose3D.h>
 
 #include <mrpt/graphslam/levmarq.h>
+#include <mrpt/graphslam/CIncrementalGraphOptimizer.h>
 #include <mrpt/graphslam/interfaces/CGraphSlamOptimizer.h>
 
 #include <iostream>
@@ -50,7 +51,8 @@ namespace mrpt::graphslam::optimizers
  *   + \a Default value :  FALSE
  *   + \a Required      : FALSE
  *   + \a Description   : Specify whether to use a second thread to optimize
- *   the graph.
+ *   the graph. Ignored if the \b optimize_in_background option of
+ *   CGraphSlamEngine is set.
  *
  * - \b LC_min_nodeid_diff
  *  + \a Section       : GeneralConfiguration
@@ -101,6 +103,60 @@ namespace mrpt::graphslam::optimizers
  *  + \a Required      : FALSE
  *  + \a Description   : Refers to the Levenberg-Marquardt optimization.
  *
+ * - \b incremental_optimization
+ *  + \a Section       : OptimizerParameters
+ *  + \a Default value : FALSE
+ *  + \a Required      : FALSE
+ *  + \a Description   : Use mrpt::graphslam::CIncrementalGraphOptimizer
+ *  instead of a Levenberg-Marquardt optimization of the nodes around the
+ *  current one: the whole graph is optimized, but only the part affected by
+ *  the new nodes and edges is relinearized and re-solved.
+ *  \b optimization_distance is then only used for visualization.
+ *
+ * - \b incremental_relinearize_threshold
+ *  + \a Section       : OptimizerParameters
+ *  + \a Default value : 0.01
+ *  + \a Required      : FALSE
+ *  + \a Description   : Refers to the incremental optimization. See
+ *  CIncrementalGraphOptimizer::TOptions::relinearize_threshold
+ *
+ * - \b robust_kernel
+ *  + \a Section       : OptimizerParameters
+ *  + \a Default value : rkLeastSquares
+ *  + \a Required      : FALSE
+ *  + \a Description   : Robust kernel (mrpt::math::TRobustKernelType, e.g.
+ *  rkHuber, rkCauchy, rkDCS, rkGemanMcClure) for the odometry edges in the
+ *  Levenberg-Marquardt optimization. Ignored by the incremental optimization.
+ *
+ * - \b robust_kernel_param
+ *  + \a Section       : OptimizerParameters
+ *  + \a Default value : 1
+ *  + \a Required      : FALSE
+ *  + \a Description   : Parameter of \b robust_kernel, in units of the
+ *  Mahalanobis distance of the edge errors.
+ *
+ * - \b robust_kernel_lc, \b robust_kernel_lc_param
+ *  + \a Section       : OptimizerParameters
+ *  + \a Default value : rkLeastSquares, 1
+ *  + \a Required      : FALSE
+ *  + \a Description   : Same as above, for loop closure edges (see \b
+ *  LC_min_nodeid_diff).
+ *
+ * - \b prune_outliers
+ *  + \a Section       : OptimizerParameters
+ *  + \a Default value : FALSE
+ *  + \a Required      : FALSE
+ *  + \a Description   : Before each full optimization, remove from the graph
+ *  the loop closures which are not consistent with the rest of the graph.
+ *  See mrpt::graphslam::prune_inconsistent_edges()
+ *
+ * - \b prune_min_weight
+ *  + \a Section       : OptimizerParameters
+ *  + \a Default value : 0.1
+ *  + \a Required      : FALSE
+ *  + \a Description   : Loop closures with a weight below this value, after
+ *  a robust optimization with a DCS kernel, are pruned.
+ *
  *  \note For a detailed description of the optimization parameters of the
  *  Levenberg-Marquardt scheme, refer to
  *
@@ -180,6 +236,13 @@ class CLevMarqGSO
 		// nodeID difference for an edge to be considered loop closure
 		int LC_min_nodeid_diff;
 
+		/**\brief Use CIncrementalGraphOptimizer instead of Lev-Marq */
+		bool incremental_optimization{false};
+		double incremental_relinearize_threshold{0.01};
+		/**\brief Remove inconsistent loop closures before full updates */
+		bool prune_outliers{false};
+		double prune_min_weight{0.1};
+
 		// Map of TPairNodesID to their corresponding edge as recorded in the
 		// last update of the optimizer state
 		typename GRAPH_T::edges_map_t last_pair_nodes_to_edge;
@@ -213,6 +276,7 @@ class CLevMarqGSO
 	void getDescriptiveReport(std::string* report_str) const;
 
 	bool justFullyOptimizedGraph() const;
+	void disableOptimizationThread() override;
 
 	// Public members
 	// ////////////////////////////
@@ -393,6 +457,10 @@ class CLevMarqGSO
 
 	/**\brief Minimum number of nodes before we try optimizing the graph */
 	size_t m_min_nodes_for_optimization;
+
+	/**\brief Optimizer state, used if opt_params.incremental_optimization */
+	mrpt::graphslam::CIncrementalGraphOptimizer<GRAPH_T>
+		m_incremental_optimizer;
 };
 }
 #include "CLevMarqGSO_impl.h"
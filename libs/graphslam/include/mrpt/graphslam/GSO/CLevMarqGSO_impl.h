@@ -430,6 +430,59 @@ void CLevMarqGSO<GRAPH_T>::_optimizeGraph(bool is_full_update /*=false*/)
 	mrpt::system::CTicTac optimization_timer;
 	optimization_timer.Tic();
 
+	if (is_full_update && opt_params.prune_outliers)
+	{
+		mrpt::system::TParametersDouble prune_params;
+		prune_params["lc_min_nodeid_diff"] = opt_params.LC_min_nodeid_diff + 1;
+		prune_params["prune_min_weight"] = opt_params.prune_min_weight;
+		prune_params["verbose"] = opt_params.cfg["verbose"];
+		const auto removed = mrpt::graphslam::prune_inconsistent_edges(
+			*(this->m_graph), prune_params);
+		for (const auto& ids : removed)
+			MRPT_LOG_WARN_FMT(
+				"Pruned inconsistent loop closure: %u -> %u",
+				static_cast<unsigned int>(ids.first),
+				static_cast<unsigned int>(ids.second));
+	}
+
+	if (opt_params.incremental_optimization)
+	{
+		// A full update re-builds the problem from the current graph
+		if (is_full_update) m_incremental_optimizer.reset();
+		m_incremental_optimizer.options.relinearize_threshold =
+			opt_params.incremental_relinearize_threshold;
+		m_incremental_optimizer.options.verbose =
+			opt_params.cfg["verbose"] != 0;
+
+		graphslam::TResultInfoSpaLevMarq isam_info;
+		try
+		{
+			m_incremental_optimizer.update(*(this->m_graph), isam_info);
+		}
+		catch (const std::exception& e)
+		{
+			// The optimizer already reset itself: optimize the whole graph
+			// once with Lev-Marq and start over in the next call.
+			MRPT_LOG_WARN_STREAM(
+				"Incremental optimization failed, using Lev-Marq:\n"
+				<< e.what());
+			mrpt::graphslam::optimize_graph_spa_levmarq(
+				*(this->m_graph), isam_info, nullptr, opt_params.cfg,
+				&CLevMarqGSO<GRAPH_T>::levMarqFeedback);
+		}
+		m_just_fully_optimized_graph = is_full_update;
+
+		MRPT_LOG_DEBUG_FMT(
+			"Incremental optimization of graph took: %fs, updated nodes: "
+			"%u",
+			optimization_timer.Tac(),
+			static_cast<unsigned int>(
+				m_incremental_optimizer.getLastUpdateStats()
+					.num_updated_nodes));
+		this->m_time_logger.leave("CLevMarqGSO::_optimizeGraph");
+		return;
+	}
+
 	// set of nodes for which the optimization procedure will take place
 	std::set<mrpt::graphs::TNodeID>* nodes_to_optimize;
 
@@ -617,6 +670,16 @@ bool CLevMarqGSO<GRAPH_T>::justFullyOptimizedGraph() const
 	return m_just_fully_optimized_graph;
 }
 
+template <class GRAPH_T>
+void CLevMarqGSO<GRAPH_T>::disableOptimizationThread()
+{
+	if (opt_params.optimization_on_second_thread)
+		MRPT_LOG_WARN(
+			"optimization_on_second_thread is ignored: the graph is already "
+			"optimized in a background thread.");
+	opt_params.optimization_on_second_thread = false;
+}
+
 template <class GRAPH_T>
 void CLevMarqGSO<GRAPH_T>::levMarqFeedback(
 	const GRAPH_T& graph, const size_t iter, const size_t max_iter,
@@ -749,6 +812,13 @@ void CLevMarqGSO<GRAPH_T>::OptimizationParams::dumpToTextStream(
 		<< (optimization_on_second_thread ? "TRUE" : "FALSE") << std::endl;
 	out << "Optimize nodes in distance     = " << optimization_distance << "\n";
 	out << "Min. node difference for LC    = " << LC_min_nodeid_diff << "\n";
+	out << "Incremental optimization       = "
+		<< (incremental_optimization ? "TRUE" : "FALSE") << "\n";
+	out << "Incremental relinearize thres. = "
+		<< incremental_relinearize_threshold << "\n";
+	out << "Prune inconsistent LCs         = "
+		<< (prune_outliers ? "TRUE" : "FALSE") << "\n";
+	out << "Prune min. LC weight           = " << prune_min_weight << "\n";
 	out << cfg.getAsString() << std::endl;
 	MRPT_END;
 }
@@ -778,6 +848,27 @@ void CLevMarqGSO<GRAPH_T>::OptimizationParams::loadFromConfigFile(
 	cfg["scale_hessian"] =
 		source.read_double("Optimization", "scale_hessian", 0.2, false);
 	cfg["tau"] = source.read_double(section, "tau", 1e-3, false);
+	cfg["robust_kernel"] = source.read_enum<mrpt::math::TRobustKernelType>(
+		section, "robust_kernel", mrpt::math::rkLeastSquares, false);
+	cfg["robust_kernel_param"] =
+		source.read_double(section, "robust_kernel_param", 1.0, false);
+	cfg["robust_kernel_lc"] = source.read_enum<mrpt::math::TRobustKernelType>(
+		section, "robust_kernel_lc", mrpt::math::rkLeastSquares, false);
+	cfg["robust_kernel_lc_param"] =
+		source.read_double(section, "robust_kernel_lc_param", 1.0, false);
+	// Lev-Marq considers loop closures those edges with an ID difference >=
+	// than this value:
+	cfg["lc_min_nodeid_diff"] = LC_min_nodeid_diff + 1;
+
+	incremental_optimization = source.read_bool(
+		section, "incremental_optimization", incremental_optimization, false);
+	incremental_relinearize_threshold = source.read_double(
+		section, "incremental_relinearize_threshold",
+		incremental_relinearize_threshold, false);
+	prune_outliers =
+		source.read_bool(section, "prune_outliers", prune_outliers, false);
+	prune_min_weight = source.read_double(
+		section, "prune_min_weight", prune_min_weight, false);
 
 	MRPT_END;
 }
@@ -65,6 +65,13 @@ class CGraphSlamOptimizer
 	 */
 	virtual bool justFullyOptimizedGraph() const { return false; }
 
+	/**\brief Called by CGraphSlamEngine when it already runs the optimizer in
+	 * a background thread (see CAsyncGraphOptimizer): the optimizer must then
+	 * optimize the graph within updateState(), without starting threads of
+	 * its own.
+	 */
+	virtual void disableOptimizationThread() {}
+
    protected:
 	/**\brief method called for optimizing the underlying graph.
 	 */
@@ -103,6 +103,7 @@ bool CNodeRegistrationDecider<GRAPH_T>::registerNewNodeAtEnd(
 							"already registered.",
 							to, tmp_pose.asString().c_str()));
 		this->m_graph->insertEdgeAtEnd(from, to, constraint);
+		this->reportNewEdge(from, to, constraint);
 	}
 
 	m_prev_registered_nodeID = to;
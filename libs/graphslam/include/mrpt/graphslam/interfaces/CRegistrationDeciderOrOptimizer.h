@@ -18,6 +18,7 @@
 #include <mrpt/system/CTimeLogger.h>
 #include <mrpt/graphslam/misc/CWindowManager.h>
 
+#include <functional>
 #include <string>
 #include <map>
 
@@ -127,6 +128,20 @@ class CRegistrationDeciderOrOptimizer : public mrpt::system::COutputLogger
 	 */
 	virtual void setGraphPtr(GRAPH_T* graph);
 
+	/**\brief Function called with each edge added to the graph */
+	using new_edge_callback_t = std::function<void(
+		mrpt::graphs::TNodeID, mrpt::graphs::TNodeID,
+		const typename GRAPH_T::constraint_t&)>;
+	/**\brief Set a function to be called with each edge that the decider
+	 * adds to the graph, e.g. to feed them to a CAsyncGraphOptimizer.
+	 *
+	 * \sa reportNewEdge
+	 */
+	void setNewEdgeCallback(new_edge_callback_t callback)
+	{
+		m_new_edge_callback = std::move(callback);
+	}
+
 	/**\brief Initialize the COutputLogger, CTimeLogger instances given the
 	 * name of the decider/optimizer at hand
 	 */
@@ -140,9 +155,21 @@ class CRegistrationDeciderOrOptimizer : public mrpt::system::COutputLogger
 	 * compact manner
 	 */
 	virtual void assertVisualsVars();
+	/**\brief To be called by the deciders after inserting an edge in the
+	 * graph.
+	 *
+	 * \sa setNewEdgeCallback
+	 */
+	void reportNewEdge(
+		mrpt::graphs::TNodeID from, mrpt::graphs::TNodeID to,
+		const typename GRAPH_T::constraint_t& edge)
+	{
+		if (m_new_edge_callback) m_new_edge_callback(from, to, edge);
+	}
 	/**\brief Pointer to the graph that is under construction */
 	GRAPH_T* m_graph;
 	std::mutex* m_graph_section;
+	new_edge_callback_t m_new_edge_callback;
 
 	/** \name Visuals-related variables methods
 	 */
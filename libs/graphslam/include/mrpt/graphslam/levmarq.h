@@ -13,9 +13,13 @@
 #include <mrpt/system/TParameters.h>
 #include <mrpt/containers/stl_containers_utils.h>  // find_in_vector()
 #include <mrpt/core/aligned_std_map.h>
-#include <mrpt/graphslam/levmarq_impl.h>  // Aux classes
 #include <mrpt/system/CTimeLogger.h>
 #include <mrpt/math/CSparseMatrix.h>
+#include <mrpt/math/robust_kernels.h>
+#include <mrpt/system/thread_pool.h>
+#include <algorithm>
+#include <memory>
+#include <mrpt/graphslam/levmarq_impl.h>  // Aux classes
 
 namespace mrpt::graphslam
 {
@@ -59,6 +63,32 @@ namespace mrpt::graphslam
  *		- "e2": (default=1e-6) Lev-marq algorithm iteration stopping criterion
  *#2:
  *|delta_incr| < e2*(x_norm+e2)
+ *		- "num_threads": (default=1) Number of threads used to evaluate the
+ *errors and Jacobians of the edges, and to build the blocks of the Hessian, in
+ *the mrpt::system::shared_thread_pool(). 0 means as many threads as CPU cores.
+ *Results do not depend on this value.
+ *		- "robust_kernel": (default=0, mrpt::math::rkLeastSquares) The
+ *mrpt::math::TRobustKernelType applied to the squared Mahalanobis error of
+ *each edge, to reduce the influence of outliers (e.g. wrong loop closures).
+ *		- "robust_kernel_param": (default=1) The kernel parameter (delta, not
+ *squared), in units of the Mahalanobis distance.
+ *		- "lc_min_nodeid_diff": (default=0) If >0, edges between nodes whose IDs
+ *differ by this value or more are considered loop closures, and use their own
+ *kernel (below) instead of "robust_kernel".
+ *		- "robust_kernel_lc", "robust_kernel_lc_param": (default: same than
+ *"robust_kernel" and "robust_kernel_param") Kernel for loop closure edges.
+ *
+ * With robust kernels, the problem is solved as an iteratively reweighted
+ *least squares: the Hessian and gradient terms of each edge are scaled by the
+ *derivative of the kernel, and steps are accepted when they decrease the
+ *robust cost. The final weights are returned in
+ *TResultInfoSpaLevMarq::edge_weights. Switchable constraints are available
+ *as mrpt::math::rkGemanMcClure, their closed-form equivalent.
+ *
+ * The Hessian is built from fixed-size blocks (one per pair of connected free
+ *nodes) with a sparsity pattern computed once per call, and solved with a
+ *sparse Cholesky decomposition whose fill-reducing (AMD) ordering is computed
+ *for the block structure in the first iteration and reused afterwards.
  *
  * \note The following graph types are supported:
  *mrpt::graphs::CNetworkOfPoses2D, mrpt::graphs::CNetworkOfPoses3D,
@@ -111,6 +141,21 @@ void optimize_graph_spa_levmarq(
 	const double tau = extra_params.getWithDefaultVal("tau", 1e-3);
 	const double e1 = extra_params.getWithDefaultVal("e1", 1e-6);
 	const double e2 = extra_params.getWithDefaultVal("e2", 1e-6);
+	const auto num_threads = static_cast<unsigned int>(
+		extra_params.getWithDefaultVal("num_threads", 1));
+	// Robust kernels:
+	detail::AuxRobustKernels kernels;
+	kernels.kernel = static_cast<TRobustKernelType>(
+		static_cast<int>(extra_params.getWithDefaultVal("robust_kernel", 0)));
+	kernels.param_sq =
+		square(extra_params.getWithDefaultVal("robust_kernel_param", 1.0));
+	kernels.kernel_lc = static_cast<TRobustKernelType>(static_cast<int>(
+		extra_params.getWithDefaultVal("robust_kernel_lc", kernels.kernel)));
+	kernels.param_lc_sq = square(extra_params.getWithDefaultVal(
+		"robust_kernel_lc_param", std::sqrt(kernels.param_sq)));
+	kernels.lc_min_nodeid_diff = static_cast<TNodeID>(
+		extra_params.getWithDefaultVal("lc_min_nodeid_diff", 0));
+	const bool use_kernels = kernels.enabled();
 
 	mrpt::system::CTimeLogger profiler(enable_profiler);
 	profiler.enter("optimize_graph_spa_levmarq (entire)");
@@ -159,12 +204,16 @@ void optimize_graph_spa_levmarq(
 	//  if we are optimizing just a subset of all the nodes):
 	using observation_info_t = typename gst::observation_info_t;
 	vector<observation_info_t> lstObservationData;
+	// Index of each observation in graph.edges:
+	vector<size_t> obsIdx2edgeIdx;
 
 	// Note: We'll need those Jacobians{i->j} where at least one "i" or "j"
 	//        is a free variable (i.e. it's in nodes_to_optimize)
 	// Now, build the list of all relevent "observations":
+	size_t edge_idx = 0;
 	for (const auto& e : graph.edges)
 	{
+		edge_idx++;
 		const auto& ids = e.first;
 		const auto& edge = e.second;
 
@@ -188,23 +237,19 @@ void optimize_graph_spa_levmarq(
 		new_entry.P2 = &itP2->second;
 
 		lstObservationData.push_back(new_entry);
+		obsIdx2edgeIdx.push_back(edge_idx - 1);
 	}
 
 	// The number of constraints, or observations actually implied in this
 	// problem:
 	const size_t nObservations = lstObservationData.size();
 	ASSERTDEB_ABOVE_(nObservations, 0);
-	// Cholesky object, as a pointer to reuse it between iterations:
-
-	using SparseCholeskyDecompPtr =
-		std::unique_ptr<CSparseMatrix::CholeskyDecomp>;
-	SparseCholeskyDecompPtr ptrCh;
 
 	// The list of Jacobians: for each constraint i->j,
 	//  we need the pair of Jacobians: { dh(xi,xj)_dxi, dh(xi,xj)_dxj },
 	//  which are "first" and "second" in each pair.
-	// Index of the map are the node IDs {i,j} for each contraint.
-	typename gst::map_pairIDs_pairJacobs_t lstJacobians;
+	// Same order than lstObservationData.
+	mrpt::aligned_std_vector<typename gst::TPairJacobs> lstJacobians;
 	// The vector of errors: err_k = SE(2/3)::pseudo_Ln( P_i * EDGE_ij *
 	// inv(P_j) )
 	// Separated vectors for each edge. i \in [0,nObservations-1], in
@@ -216,35 +261,64 @@ void optimize_graph_spa_levmarq(
 	// ===================================
 	profiler.enter("optimize_graph_spa_levmarq.Jacobians&err");
 	double total_sqr_err = computeJacobiansAndErrors<GRAPH_T>(
-		graph, lstObservationData, lstJacobians, errs);
+		graph, lstObservationData, lstJacobians, errs, num_threads);
 	profiler.leave("optimize_graph_spa_levmarq.Jacobians&err");
 
+	// With robust kernels, the error is the robust cost, and each edge gets
+	// a weight in the normal equations:
+	std::vector<double> weights;
+	if (use_kernels)
+		total_sqr_err =
+			kernels.eval<gst>(lstObservationData, errs, weights);
+	const std::vector<double>* weights_ptr =
+		use_kernels ? &weights : nullptr;
+
 	// Only once (since this will be static along iterations), build a quick
 	// look-up table with the
 	//  indices of the free nodes associated to the (first_id,second_id) of each
-	//  Jacobian pair:
+	//  observation, and the pointers to the poses of the free nodes:
 	// ------------------------------------------------------------------------
+	const vector<TNodeID> free_ids(
+		nodes_to_optimize->begin(), nodes_to_optimize->end());
+	const auto freeNodeIndex = [&free_ids](const TNodeID id) -> size_t {
+		const auto it = std::lower_bound(free_ids.begin(), free_ids.end(), id);
+		return (it != free_ids.end() && *it == id) ? it - free_ids.begin()
+												   : string::npos;
+	};
 	vector<pair<size_t, size_t>> obsIdx2fnIdx;
 	// "relatedFreeNodeIndex" is in [0,nFreeNodes-1], or "-1" if that node
 	// is fixed, as defined by "nodes_to_optimize"
 	obsIdx2fnIdx.reserve(nObservations);
-	ASSERTDEB_(lstJacobians.size() == nObservations);
-	for (typename gst::map_pairIDs_pairJacobs_t::const_iterator itJ =
-			 lstJacobians.begin();
-		 itJ != lstJacobians.end(); ++itJ)
+	for (const auto& obs : lstObservationData)
+		obsIdx2fnIdx.emplace_back(
+			freeNodeIndex(obs.edge->first.first),
+			freeNodeIndex(obs.edge->first.second));
+
+	vector<typename gst::graph_t::constraint_t::type_value*> free_poses;
+	free_poses.reserve(nFreeNodes);
+	for (const TNodeID id : free_ids)
 	{
-		const TNodeID id1 = itJ->first.first;
-		const TNodeID id2 = itJ->first.second;
-		obsIdx2fnIdx.push_back(std::make_pair(
-			mrpt::containers::find_in_vector(id1, *nodes_to_optimize),
-			mrpt::containers::find_in_vector(id2, *nodes_to_optimize)));
+		auto itP = graph.nodes.find(id);
+		ASSERTMSG_(itP != graph.nodes.end(), "Free node has no global pose");
+		free_poses.push_back(&itP->second);
 	}
 
+	// The Hessian, as fixed-size blocks in a fixed sparsity pattern:
+	profiler.enter("optimize_graph_spa_levmarq.sp_H:structure");
+	detail::AuxHessianBlocks<gst> H_blocks;
+	H_blocks.build(nFreeNodes, obsIdx2fnIdx);
+	profiler.leave("optimize_graph_spa_levmarq.sp_H:structure");
+
+	// Cholesky object, as a pointer to reuse it (and its fill-reducing
+	// ordering, computed for the block structure) between iterations:
+	using SparseCholeskyDecompPtr =
+		std::unique_ptr<CSparseMatrix::CholeskyDecomp>;
+	SparseCholeskyDecompPtr ptrCh;
+	CSparseMatrix sp_H;
+
 	// other important vars for the main loop:
 	CVectorDouble grad(nFreeNodes * DIMS_POSE);
 	grad.setZero();
-	using map_ID2matrix_VxV_t =
-		mrpt::aligned_std_map<TNodeID, typename gst::matrix_VxV_t>;
 
 	double lambda = initial_lambda;  // Will be actually set on first iteration.
 	double v = 1;  // was 2, changed since it's modified in the first pass.
@@ -259,7 +333,6 @@ void optimize_graph_spa_levmarq(
 
 	for (size_t iter = 0; iter < max_iters; ++iter)
 	{
-		vector<map_ID2matrix_VxV_t> H_map(nFreeNodes);
 		last_iter = iter;
 
 		// This will be false only when the delta leads to a worst solution and
@@ -276,56 +349,9 @@ void optimize_graph_spa_levmarq(
 			// that is: g_i is the "dot-product" of the i'th (transposed)
 			// block-column of J and the vector of errors "errs"
 			profiler.enter("optimize_graph_spa_levmarq.grad");
-			mrpt::aligned_std_vector<typename gst::Array_O> grad_parts(
-				nFreeNodes, array_O_zeros);
-
-			// "lstJacobians" is sorted in the same order than
-			// "lstObservationData":
-			ASSERTDEB_EQUAL_(lstJacobians.size(), lstObservationData.size());
-			{
-				size_t idx_obs;
-				typename gst::map_pairIDs_pairJacobs_t::const_iterator itJ;
-
-				for (idx_obs = 0, itJ = lstJacobians.begin();
-					 itJ != lstJacobians.end(); ++itJ, ++idx_obs)
-				{
-					// make sure they're in the expected order!
-					ASSERTDEB_(
-						itJ->first == lstObservationData[idx_obs].edge->first);
-
-					//  grad[k] += J^t_{i->k} * Inf.Matrix * errs_i
-					//    k: [0,nFreeNodes-1]     <-- IDs.first & IDs.second
-					//    i: [0,nObservations-1]  <--- idx_obs
-
-					// Get the corresponding indices in the vector of "free
-					// variables" being optimized:
-					const size_t idx1 = obsIdx2fnIdx[idx_obs].first;
-					const size_t idx2 = obsIdx2fnIdx[idx_obs].second;
-
-					if (idx1 != string::npos)
-						detail::AuxErrorEval<typename gst::edge_t, gst>::
-							multiply_Jt_W_err(
-								itJ->second.first /* J */,
-								lstObservationData[idx_obs].edge /* W */,
-								errs[idx_obs] /* err */,
-								grad_parts[idx1] /* out */
-							);
-
-					if (idx2 != string::npos)
-						detail::AuxErrorEval<typename gst::edge_t, gst>::
-							multiply_Jt_W_err(
-								itJ->second.second /* J */,
-								lstObservationData[idx_obs].edge /* W */,
-								errs[idx_obs] /* err */,
-								grad_parts[idx2] /* out */
-							);
-				}
-			}
-
-			// build the gradient as a single vector:
-			::memcpy(
-				&grad[0], &grad_parts[0],
-				nFreeNodes * DIMS_POSE * sizeof(grad[0]));  // Ohh yeahh!
+			H_blocks.computeGradient(
+				lstObservationData, lstJacobians, errs, grad, num_threads,
+				weights_ptr);
 			profiler.leave("optimize_graph_spa_levmarq.grad");
 
 			// End condition #1
@@ -343,107 +369,20 @@ void optimize_graph_spa_levmarq(
 				break;
 			}
 
-			profiler.enter("optimize_graph_spa_levmarq.sp_H:build map");
 			// ======================================================================
-			// Build sparse representation of the upper triangular part of
+			// Build the blocks of the upper triangular part of
 			//  the Hessian matrix H = J^t * J
-			//
-			// Sparse memory structure is a vector of maps, such as:
-			//  - H_map[i]: corresponds to the i'th column of H.
-			//              Here "i" corresponds to [0,N-1] indices of
-			//              appearance in the map "*nodes_to_optimize".
-			//  - H_map[i][j] is the entry for the j'th row, with "j" also in
-			//  the range [0,N-1] as ordered in "*nodes_to_optimize".
 			// ======================================================================
-			{
-				size_t idxObs;
-				typename gst::map_pairIDs_pairJacobs_t::const_iterator
-					itJacobPair;
-
-				for (idxObs = 0, itJacobPair = lstJacobians.begin();
-					 idxObs < nObservations; ++itJacobPair, ++idxObs)
-				{
-					const bool Hij_upper_triang =
-						itJacobPair->first.first < itJacobPair->first.second;
-
-					// Indices in the "H_map" vector:
-					const size_t idx_i = obsIdx2fnIdx[idxObs].first;
-					const size_t idx_j = obsIdx2fnIdx[idxObs].second;
-
-					const bool is_i_free_node = idx_i != string::npos;
-					const bool is_j_free_node = idx_j != string::npos;
-
-					// Take references to both Jacobians (wrt pose "i" and pose
-					// "j"), taking into account the possible
-					// switch in their order:
-					const typename gst::matrix_VxV_t& J1 = itJacobPair->second.first;
-					const typename gst::matrix_VxV_t& J2 = itJacobPair->second.second;
-
-					// Is "i" a free (to be optimized) node? -> Ji^t * Inf *  Ji
-					if (is_i_free_node)
-					{
-						typename gst::matrix_VxV_t JtJ(
-							mrpt::math::UNINITIALIZED_MATRIX);
-						detail::AuxErrorEval<typename gst::edge_t, gst>::
-							multiplyJtLambdaJ(
-								J1, JtJ, lstObservationData[idxObs].edge);
-						H_map[idx_i][idx_i] += JtJ;
-					}
-					// Is "j" a free (to be optimized) node? -> Jj^t * Inf *  Jj
-					if (is_j_free_node)
-					{
-						typename gst::matrix_VxV_t JtJ(
-							mrpt::math::UNINITIALIZED_MATRIX);
-						detail::AuxErrorEval<typename gst::edge_t, gst>::
-							multiplyJtLambdaJ(
-								J2, JtJ, lstObservationData[idxObs].edge);
-						H_map[idx_j][idx_j] += JtJ;
-					}
-					// Are both "i" and "j" free nodes? -> Ji^t * Inf *  Jj
-					if (is_i_free_node && is_j_free_node)
-					{
-						typename gst::matrix_VxV_t JtJ(
-							mrpt::math::UNINITIALIZED_MATRIX);
-						detail::AuxErrorEval<typename gst::edge_t, gst>::
-							multiplyJ1tLambdaJ2(
-								J1, J2, JtJ, lstObservationData[idxObs].edge);
-						// We sort IDs such as "i" < "j" and we can build just
-						// the upper triangular part of the Hessian:
-						if (Hij_upper_triang)  // H_map[col][row]
-							H_map[idx_j][idx_i] += JtJ;
-						else
-							H_map[idx_i][idx_j] += JtJ.transpose();
-					}
-				}
-			}
-			profiler.leave("optimize_graph_spa_levmarq.sp_H:build map");
+			profiler.enter("optimize_graph_spa_levmarq.sp_H:build blocks");
+			H_blocks.computeHessian(
+				lstObservationData, lstJacobians, num_threads, weights_ptr);
+			profiler.leave("optimize_graph_spa_levmarq.sp_H:build blocks");
 
 			// Just in the first iteration, we need to calculate an estimate for
 			// the first value of "lamdba":
 			if (lambda <= 0 && iter == 0)
 			{
-				profiler.enter(
-					"optimize_graph_spa_levmarq.lambda_init");  // ---\  .
-				double H_diagonal_max = 0;
-				for (size_t i = 0; i < nFreeNodes; i++)
-					for (typename map_ID2matrix_VxV_t::const_iterator it =
-							 H_map[i].begin();
-						 it != H_map[i].end(); ++it)
-					{
-						const size_t j =
-							it->first;  // entry submatrix is for (i,j).
-						if (i == j)
-						{
-							for (size_t k = 0; k < DIMS_POSE; k++)
-								mrpt::keep_max(
-									H_diagonal_max,
-									it->second.get_unsafe(k, k));
-						}
-					}
-				lambda = tau * H_diagonal_max;
-
-				profiler.leave(
-					"optimize_graph_spa_levmarq.lambda_init");  // ---/
+				lambda = tau * H_blocks.maxDiagonal();
 			}
 			else
 			{
@@ -468,50 +407,10 @@ void optimize_graph_spa_levmarq(
 		}
 
 		profiler.enter("optimize_graph_spa_levmarq.sp_H:build");
-		// Now, build the actual sparse matrix H:
+		// Now, build the actual sparse matrix H + lambda*I:
 		// Note: we only need to fill out the upper diagonal part, since
 		// Cholesky will later on ignore the other part.
-		CSparseMatrix sp_H(nFreeNodes * DIMS_POSE, nFreeNodes * DIMS_POSE);
-		for (size_t i = 0; i < nFreeNodes; i++)
-		{
-			const size_t i_offset = i * DIMS_POSE;
-
-			for (typename map_ID2matrix_VxV_t::const_iterator it =
-					 H_map[i].begin();
-				 it != H_map[i].end(); ++it)
-			{
-				const size_t j = it->first;  // entry submatrix is for (i,j).
-				const size_t j_offset = j * DIMS_POSE;
-
-				// For i==j (diagonal blocks), it's different, since we only
-				// need to insert their
-				// upper-diagonal half and also we have to add the lambda*I to
-				// the diagonal from the Lev-Marq. algorithm:
-				if (i == j)
-				{
-					for (size_t r = 0; r < DIMS_POSE; r++)
-					{
-						// c=r: add lambda from LM
-						sp_H.insert_entry_fast(
-							j_offset + r, i_offset + r,
-							it->second.get_unsafe(r, r) + lambda);
-						// c>r:
-						for (size_t c = r + 1; c < DIMS_POSE; c++)
-						{
-							sp_H.insert_entry_fast(
-								j_offset + r, i_offset + c,
-								it->second.get_unsafe(r, c));
-						}
-					}
-				}
-				else
-				{
-					sp_H.insert_submatrix(j_offset, i_offset, it->second);
-				}
-			}
-		}  // end for each free node, build sp_H
-
-		sp_H.compressFromTriplet();
+		H_blocks.getSparseMatrix(lambda, sp_H, num_threads);
 		profiler.leave("optimize_graph_spa_levmarq.sp_H:build");
 
 		// Use the cparse Cholesky decomposition to efficiently solve:
@@ -524,8 +423,8 @@ void optimize_graph_spa_levmarq(
 		{
 			profiler.enter("optimize_graph_spa_levmarq.sp_H:chol");
 			if (!ptrCh.get())
-				ptrCh = SparseCholeskyDecompPtr(
-					new CSparseMatrix::CholeskyDecomp(sp_H));
+				ptrCh = std::make_unique<CSparseMatrix::CholeskyDecomp>(
+					sp_H, H_blocks.computeOrdering());
 			else
 				ptrCh.get()->update(sp_H);
 			profiler.leave("optimize_graph_spa_levmarq.sp_H:chol");
@@ -536,6 +435,7 @@ void optimize_graph_spa_levmarq(
 		}
 		catch (CExceptionNotDefPos&)
 		{
+			profiler.leave("optimize_graph_spa_levmarq.sp_H:chol");
 			// not positive definite so increase mu and try again
 			if (verbose)
 				cout << "[" << __CURRENT_FUNCTION_NAME__
@@ -559,15 +459,9 @@ void optimize_graph_spa_levmarq(
 		profiler.enter("optimize_graph_spa_levmarq.x_norm");
 		double x_norm = 0;
 		{
-			for (set<TNodeID>::const_iterator it = nodes_to_optimize->begin();
-				 it != nodes_to_optimize->end(); ++it)
-			{
-				typename gst::graph_t::global_poses_t::const_iterator itP =
-					graph.nodes.find(*it);
-				const typename gst::graph_t::constraint_t::type_value& P =
-					itP->second;
-				for (size_t i = 0; i < DIMS_POSE; i++) x_norm += square(P[i]);
-			}
+			for (const auto P : free_poses)
+				for (size_t i = 0; i < DIMS_POSE; i++)
+					x_norm += square((*P)[i]);
 			x_norm = std::sqrt(x_norm);
 		}
 		profiler.leave("optimize_graph_spa_levmarq.x_norm");
@@ -592,15 +486,15 @@ void optimize_graph_spa_levmarq(
 			//  new_x = old_x [+] (-delta)    , with [+] being the "manifold
 			//  exp()+add" operation.
 			// =====================================================================================
-			typename gst::graph_t::global_poses_t old_poses_backup;
+			mrpt::aligned_std_vector<
+				typename gst::graph_t::constraint_t::type_value>
+				old_poses_backup;
+			old_poses_backup.reserve(nFreeNodes);
 
 			{
-				ASSERTDEB_(
-					delta.size() == int(nodes_to_optimize->size() * DIMS_POSE));
+				ASSERTDEB_(delta.size() == int(nFreeNodes * DIMS_POSE));
 				const double* delta_ptr = &delta[0];
-				for (set<TNodeID>::const_iterator it =
-						 nodes_to_optimize->begin();
-					 it != nodes_to_optimize->end(); ++it)
+				for (const auto P : free_poses)
 				{
 					typename gst::Array_O exp_delta;
 					for (size_t i = 0; i < DIMS_POSE; i++)
@@ -609,25 +503,29 @@ void optimize_graph_spa_levmarq(
 					// Gauss-Newton formula above.
 
 					// new_x_i =  exp_delta_i (+) old_x_i
-					typename gst::graph_t::global_poses_t::iterator
-						it_old_value = graph.nodes.find(*it);
-					old_poses_backup[*it] =
-						it_old_value->second;  // back up the old pose as a copy
+					old_poses_backup.push_back(
+						*P);  // back up the old pose as a copy
 					detail::AuxPoseOPlus<typename gst::edge_t, gst>::sumIncr(
-						it_old_value->second, exp_delta);
+						*P, exp_delta);
 				}
 			}
 
 			// =============================================================
 			// Compute Jacobians & errors with the new "graph.nodes" info:
 			// =============================================================
-			typename gst::map_pairIDs_pairJacobs_t new_lstJacobians;
+			mrpt::aligned_std_vector<typename gst::TPairJacobs>
+				new_lstJacobians;
 			mrpt::aligned_std_vector<typename gst::Array_O> new_errs;
 
 			profiler.enter("optimize_graph_spa_levmarq.Jacobians&err");
 			double new_total_sqr_err = computeJacobiansAndErrors<GRAPH_T>(
-				graph, lstObservationData, new_lstJacobians, new_errs);
+				graph, lstObservationData, new_lstJacobians, new_errs,
+				num_threads);
 			profiler.leave("optimize_graph_spa_levmarq.Jacobians&err");
+			std::vector<double> new_weights;
+			if (use_kernels)
+				new_total_sqr_err = kernels.eval<gst>(
+					lstObservationData, new_errs, new_weights);
 
 			// Now, to decide whether to accept the change:
 			if (new_total_sqr_err < total_sqr_err)  // rho>0)
@@ -635,6 +533,7 @@ void optimize_graph_spa_levmarq(
 				// Accept the new point:
 				new_lstJacobians.swap(lstJacobians);
 				new_errs.swap(errs);
+				new_weights.swap(weights);
 				std::swap(new_total_sqr_err, total_sqr_err);
 
 				// Instruct to recompute H and grad from the new Jacobians.
@@ -644,10 +543,8 @@ void optimize_graph_spa_levmarq(
 			{
 				// Nope...
 				// We have to revert the "graph.nodes" to "old_poses_backup"
-				for (typename gst::graph_t::global_poses_t::const_iterator it =
-						 old_poses_backup.begin();
-					 it != old_poses_backup.end(); ++it)
-					graph.nodes[it->first] = it->second;
+				for (size_t i = 0; i < nFreeNodes; i++)
+					*free_poses[i] = old_poses_backup[i];
 
 				if (verbose)
 					cout << "[" << __CURRENT_FUNCTION_NAME__
@@ -668,10 +565,96 @@ void optimize_graph_spa_levmarq(
 	// ------------------------------
 	out_info.num_iters = last_iter;
 	out_info.final_total_sq_error = total_sqr_err;
+	out_info.edge_weights.clear();
+	if (use_kernels)
+	{
+		out_info.edge_weights.assign(graph.edges.size(), 1.0);
+		for (size_t k = 0; k < nObservations; k++)
+			out_info.edge_weights[obsIdx2edgeIdx[k]] = weights[k];
+	}
 
 	MRPT_END
 }  // end of optimize_graph_spa_levmarq()
 
+/** Fast consistency check of the loop closures in a graph, to be run before
+ *optimize_graph_spa_levmarq(): a few iterations of a robust optimization
+ *(on a copy of the graph) with a robust kernel for the loop closure edges
+ *only, after which the loop closures with a weight below a threshold
+ *(i.e. those not consistent with the odometry and the rest of loop closures)
+ *are removed from the graph. Node poses are not modified.
+ *
+ * List of optional parameters by name in "extra_params":
+ *		- "lc_min_nodeid_diff": (default=2) Edges between nodes whose IDs differ
+ *by this value or more are loop closures, and candidates to be removed. If 0,
+ *all edges are candidates.
+ *		- "prune_kernel": (default=mrpt::math::rkDCS) Robust kernel for the loop
+ *closures.
+ *		- "prune_kernel_param": (default=1) Its parameter (not squared).
+ *		- "prune_max_iterations": (default=10) Iterations of the robust
+ *optimization.
+ *		- "prune_min_weight": (default=0.1) Loop closures with a final weight
+ *below this value are removed.
+ *		- "verbose", "num_threads": As in optimize_graph_spa_levmarq().
+ *
+ * \return The IDs of the removed edges.
+ * \sa optimize_graph_spa_levmarq()
+ * \ingroup mrpt_graphslam_grp
+ */
+template <class GRAPH_T>
+std::vector<mrpt::graphs::TPairNodeIDs> prune_inconsistent_edges(
+	GRAPH_T& graph, const mrpt::system::TParametersDouble& extra_params =
+						mrpt::system::TParametersDouble())
+{
+	MRPT_START
+	using mrpt::graphs::TNodeID;
+
+	const double lc_min_nodeid_diff =
+		extra_params.getWithDefaultVal("lc_min_nodeid_diff", 2);
+	const double kernel =
+		extra_params.getWithDefaultVal("prune_kernel", mrpt::math::rkDCS);
+	const double min_weight =
+		extra_params.getWithDefaultVal("prune_min_weight", 0.1);
+
+	mrpt::system::TParametersDouble params;
+	params["verbose"] = extra_params.getWithDefaultVal("verbose", 0);
+	params["num_threads"] = extra_params.getWithDefaultVal("num_threads", 1);
+	params["max_iterations"] =
+		extra_params.getWithDefaultVal("prune_max_iterations", 10);
+	params["lc_min_nodeid_diff"] = lc_min_nodeid_diff;
+	// Odometry edges are trusted (least squares), unless all edges are
+	// candidates:
+	params["robust_kernel"] = lc_min_nodeid_diff > 0 ? 0 : kernel;
+	params["robust_kernel_lc"] = kernel;
+	params["robust_kernel_param"] = params["robust_kernel_lc_param"] =
+		extra_params.getWithDefaultVal("prune_kernel_param", 1.0);
+
+	std::vector<mrpt::graphs::TPairNodeIDs> removed;
+	if (graph.edges.empty() || graph.nodes.size() < 2) return removed;
+
+	GRAPH_T work_graph = graph;
+	TResultInfoSpaLevMarq info;
+	optimize_graph_spa_levmarq(work_graph, info, nullptr, params);
+	ASSERT_EQUAL_(info.edge_weights.size(), graph.edges.size());
+
+	// Both multimaps have the same edges, in the same order:
+	detail::AuxRobustKernels lc;
+	lc.lc_min_nodeid_diff = static_cast<TNodeID>(lc_min_nodeid_diff);
+	size_t k = 0;
+	for (auto it = graph.edges.begin(); it != graph.edges.end(); k++)
+	{
+		if ((lc_min_nodeid_diff <= 0 || lc.isLoopClosure(it->first)) &&
+			info.edge_weights[k] < min_weight)
+		{
+			removed.push_back(it->first);
+			it = graph.edges.erase(it);
+		}
+		else
+			++it;
+	}
+	return removed;
+	MRPT_END
+}
+
 /**  @} */  // end of grouping
 
 }  // namespace mrpt::graphslam
@@ -125,6 +125,14 @@ struct AuxErrorEval<CPose2D, gst>
 		const auto grad_incr = (J.transpose() * ERR).eval();
 		OUT += grad_incr;
 	}
+
+	template <class VEC, class EDGE_ITERATOR>
+	static inline double squaredMahalanobis(
+		const VEC& err, const EDGE_ITERATOR& edge)
+	{
+		MRPT_UNUSED_PARAM(edge);
+		return err.squaredNorm();
+	}
 };
 
 // For graphs of 3D constraints (no information matrix)
@@ -162,6 +170,14 @@ struct AuxErrorEval<CPose3D, gst>
 		MRPT_UNUSED_PARAM(edge);
 		OUT += J.transpose() * ERR;
 	}
+
+	template <class VEC, class EDGE_ITERATOR>
+	static inline double squaredMahalanobis(
+		const VEC& err, const EDGE_ITERATOR& edge)
+	{
+		MRPT_UNUSED_PARAM(edge);
+		return err.squaredNorm();
+	}
 };
 
 // For graphs of 2D constraints (with information matrix)
@@ -194,6 +210,13 @@ struct AuxErrorEval<CPosePDFGaussianInf, gst>
 	{
 		OUT += (J.transpose() * edge->second.cov_inv) * ERR;
 	}
+
+	template <class VEC, class EDGE_ITERATOR>
+	static inline double squaredMahalanobis(
+		const VEC& err, const EDGE_ITERATOR& edge)
+	{
+		return err.dot(edge->second.cov_inv * err);
+	}
 };
 
 // For graphs of 3D constraints (with information matrix)
@@ -228,63 +251,385 @@ struct AuxErrorEval<CPose3DPDFGaussianInf, gst>
 	{
 		OUT += (J.transpose() * edge->second.cov_inv) * ERR;
 	}
+
+	template <class VEC, class EDGE_ITERATOR>
+	static inline double squaredMahalanobis(
+		const VEC& err, const EDGE_ITERATOR& edge)
+	{
+		return err.dot(edge->second.cov_inv * err);
+	}
+};
+
+// Upper triangular part of the Hessian H=J^t*Inf*J and gradient of a graph
+// problem, with a sparsity pattern fixed by the edges being optimized.
+// Blocks are stored by block columns (block-CSC), and each one is computed
+// by a single thread from the list of edges contributing to it (in edge
+// order), so results do not depend on the number of threads.
+template <class gst>
+struct AuxHessianBlocks
+{
+	static constexpr size_t DIM = gst::SE_TYPE::VECTOR_SIZE;
+	using matrix_VxV_t = typename gst::matrix_VxV_t;
+
+	// Kinds of contributions of an edge (i,j) to a block:
+	enum contrib_t : uint8_t
+	{
+		J1tJ1 = 0,  // diagonal block (i,i)
+		J2tJ2,  // diagonal block (j,j)
+		J1tJ2,  // block (i,j)
+		J2tJ1  // block (j,i)
+	};
+
+	size_t nFreeNodes{0};
+	// Block structure: blocks in column c are [col_ptr[c],col_ptr[c+1]),
+	// with ascending rows. The diagonal block is always the last one.
+	std::vector<size_t> col_ptr, row;
+	mrpt::aligned_std_vector<matrix_VxV_t> blocks;
+	// Contributions to each block (observation index, kind):
+	std::vector<size_t> contrib_ptr;
+	std::vector<std::pair<size_t, contrib_t>> contribs;
+	// Contributions to the gradient of each node (observation index, true
+	// if the node is the second one in the edge):
+	std::vector<size_t> grad_ptr;
+	std::vector<std::pair<size_t, bool>> grad_contribs;
+	// Column-compressed pattern of the scalar upper triangular matrix:
+	std::vector<int> sp_col_ptrs, sp_row_idxs;
+	std::vector<double> sp_values;
+
+	// Builds the sparsity pattern from the indices of the free nodes of each
+	// observation (std::string::npos for fixed nodes).
+	void build(
+		const size_t nFree,
+		const std::vector<std::pair<size_t, size_t>>& obsIdx2fnIdx)
+	{
+		const size_t npos = std::string::npos;
+		nFreeNodes = nFree;
+
+		// Rows of each block column:
+		std::vector<std::vector<size_t>> col_rows(nFree);
+		for (size_t c = 0; c < nFree; c++) col_rows[c].push_back(c);
+		for (const auto& ij : obsIdx2fnIdx)
+			if (ij.first != npos && ij.second != npos && ij.first != ij.second)
+				col_rows[std::max(ij.first, ij.second)].push_back(
+					std::min(ij.first, ij.second));
+		col_ptr.assign(1, 0);
+		row.clear();
+		for (auto& rows : col_rows)
+		{
+			std::sort(rows.begin(), rows.end());
+			rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+			row.insert(row.end(), rows.begin(), rows.end());
+			col_ptr.push_back(row.size());
+		}
+		blocks.resize(row.size());
+
+		const auto blockIndex = [this](size_t r, size_t c) {
+			return std::lower_bound(
+					   row.begin() + col_ptr[c], row.begin() + col_ptr[c + 1],
+					   r) -
+				   row.begin();
+		};
+
+		// Contributions, sorted by block (a stable counting sort, to keep
+		// the order of observations):
+		std::vector<std::pair<size_t, std::pair<size_t, contrib_t>>> lst;
+		std::vector<std::pair<size_t, std::pair<size_t, bool>>> lst_grad;
+		for (size_t k = 0; k < obsIdx2fnIdx.size(); k++)
+		{
+			const size_t i = obsIdx2fnIdx[k].first, j = obsIdx2fnIdx[k].second;
+			if (i != npos)
+			{
+				lst.emplace_back(blockIndex(i, i), std::make_pair(k, J1tJ1));
+				lst_grad.emplace_back(i, std::make_pair(k, false));
+			}
+			if (j != npos)
+			{
+				lst.emplace_back(blockIndex(j, j), std::make_pair(k, J2tJ2));
+				lst_grad.emplace_back(j, std::make_pair(k, true));
+			}
+			if (i != npos && j != npos)
+			{
+				if (i <= j)
+					lst.emplace_back(
+						blockIndex(i, j), std::make_pair(k, J1tJ2));
+				if (j <= i)
+					lst.emplace_back(
+						blockIndex(j, i), std::make_pair(k, J2tJ1));
+			}
+		}
+		countingSort(lst, blocks.size(), contrib_ptr, contribs);
+		countingSort(lst_grad, nFree, grad_ptr, grad_contribs);
+
+		// Scalar pattern: for each scalar column, the D rows of each
+		// off-diagonal block, then the upper triangle of the diagonal block.
+		sp_col_ptrs.assign(1, 0);
+		sp_row_idxs.clear();
+		for (size_t c = 0; c < nFree; c++)
+			for (size_t q = 0; q < DIM; q++)
+			{
+				for (size_t b = col_ptr[c]; b < col_ptr[c + 1]; b++)
+				{
+					const size_t nr = (row[b] == c) ? q + 1 : DIM;
+					for (size_t r = 0; r < nr; r++)
+						sp_row_idxs.push_back(row[b] * DIM + r);
+				}
+				sp_col_ptrs.push_back(sp_row_idxs.size());
+			}
+		sp_values.resize(sp_row_idxs.size());
+	}
+
+	template <class T>
+	static void countingSort(
+		const std::vector<std::pair<size_t, T>>& lst, const size_t nBins,
+		std::vector<size_t>& ptr, std::vector<T>& out)
+	{
+		ptr.assign(nBins + 1, 0);
+		for (const auto& e : lst) ptr[e.first + 1]++;
+		for (size_t b = 0; b < nBins; b++) ptr[b + 1] += ptr[b];
+		out.resize(lst.size());
+		std::vector<size_t> next(ptr.begin(), ptr.end() - 1);
+		for (const auto& e : lst) out[next[e.first]++] = e.second;
+	}
+
+	// AMD ordering of the block pattern, expanded to scalar rows/columns.
+	std::vector<int> computeOrdering() const
+	{
+		std::vector<int> blk_col_ptrs(col_ptr.begin(), col_ptr.end());
+		std::vector<int> blk_rows(row.begin(), row.end());
+		mrpt::math::CSparseMatrix pattern;
+		pattern.setColumnCompressed(
+			nFreeNodes, nFreeNodes, blk_col_ptrs, blk_rows,
+			std::vector<double>(row.size(), 1.0));
+		const std::vector<int> blk_order =
+			pattern.computeFillReducingOrdering();
+		std::vector<int> order(nFreeNodes * DIM);
+		for (size_t k = 0; k < nFreeNodes; k++)
+			for (size_t q = 0; q < DIM; q++)
+				order[k * DIM + q] = blk_order[k] * DIM + q;
+		return order;
+	}
+
+	template <class OBS_VECTOR, class JACOBS_VECTOR, class ERRS_VECTOR>
+	void computeGradient(
+		const OBS_VECTOR& obs, const JACOBS_VECTOR& jacobs,
+		const ERRS_VECTOR& errs, mrpt::math::CVectorDouble& grad,
+		const unsigned int num_threads,
+		const std::vector<double>* weights = nullptr) const
+	{
+		using aux_t = AuxErrorEval<typename gst::edge_t, gst>;
+		grad.resize(nFreeNodes * DIM);
+		mrpt::system::parallel_for(
+			nFreeNodes, num_threads, [&](size_t first, size_t last) {
+				for (size_t n = first; n < last; n++)
+				{
+					typename gst::Array_O g;
+					g.fill(0);
+					for (size_t c = grad_ptr[n]; c < grad_ptr[n + 1]; c++)
+					{
+						const size_t k = grad_contribs[c].first;
+						const auto& J = grad_contribs[c].second
+											? jacobs[k].second
+											: jacobs[k].first;
+						if (weights)
+							aux_t::multiply_Jt_W_err(
+								J, obs[k].edge, (errs[k] * (*weights)[k]).eval(),
+								g);
+						else
+							aux_t::multiply_Jt_W_err(J, obs[k].edge, errs[k], g);
+					}
+					for (size_t q = 0; q < DIM; q++) grad[n * DIM + q] = g[q];
+				}
+			});
+	}
+
+	template <class OBS_VECTOR, class JACOBS_VECTOR>
+	void computeHessian(
+		const OBS_VECTOR& obs, const JACOBS_VECTOR& jacobs,
+		const unsigned int num_threads,
+		const std::vector<double>* weights = nullptr)
+	{
+		using aux_t = AuxErrorEval<typename gst::edge_t, gst>;
+		mrpt::system::parallel_for(
+			blocks.size(), num_threads, [&](size_t first, size_t last) {
+				matrix_VxV_t JtJ(mrpt::math::UNINITIALIZED_MATRIX);
+				for (size_t b = first; b < last; b++)
+				{
+					matrix_VxV_t& H = blocks[b];
+					H.zeros();
+					for (size_t c = contrib_ptr[b]; c < contrib_ptr[b + 1]; c++)
+					{
+						const size_t k = contribs[c].first;
+						const auto& J = jacobs[k];
+						switch (contribs[c].second)
+						{
+							case J1tJ1:
+								aux_t::multiplyJtLambdaJ(
+									J.first, JtJ, obs[k].edge);
+								break;
+							case J2tJ2:
+								aux_t::multiplyJtLambdaJ(
+									J.second, JtJ, obs[k].edge);
+								break;
+							case J1tJ2:
+								aux_t::multiplyJ1tLambdaJ2(
+									J.first, J.second, JtJ, obs[k].edge);
+								break;
+							case J2tJ1:
+								aux_t::multiplyJ1tLambdaJ2(
+									J.second, J.first, JtJ, obs[k].edge);
+								break;
+							default:
+								THROW_EXCEPTION("Unknown Hessian block type");
+						};
+						if (weights)
+							H += JtJ * (*weights)[k];
+						else
+							H += JtJ;
+					}
+				}
+			});
+	}
+
+	double maxDiagonal() const
+	{
+		double m = 0;
+		for (size_t c = 0; c < nFreeNodes; c++)
+		{
+			const matrix_VxV_t& H = blocks[col_ptr[c + 1] - 1];
+			for (size_t k = 0; k < DIM; k++)
+				mrpt::keep_max(m, H.get_unsafe(k, k));
+		}
+		return m;
+	}
+
+	// Fills in the sparse matrix H + lambda*I (upper triangular part)
+	void getSparseMatrix(
+		const double lambda, mrpt::math::CSparseMatrix& sp_H,
+		const unsigned int num_threads)
+	{
+		mrpt::system::parallel_for(
+			nFreeNodes, num_threads, [&](size_t first, size_t last) {
+				for (size_t c = first; c < last; c++)
+				{
+					double* v = &sp_values[sp_col_ptrs[c * DIM]];
+					for (size_t q = 0; q < DIM; q++)
+						for (size_t b = col_ptr[c]; b < col_ptr[c + 1]; b++)
+						{
+							const matrix_VxV_t& H = blocks[b];
+							if (row[b] != c)
+								for (size_t r = 0; r < DIM; r++)
+									*v++ = H.get_unsafe(r, q);
+							else
+							{
+								for (size_t r = 0; r < q; r++)
+									*v++ = H.get_unsafe(r, q);
+								*v++ = H.get_unsafe(q, q) + lambda;
+							}
+						}
+				}
+			});
+		sp_H.setColumnCompressed(
+			nFreeNodes * DIM, nFreeNodes * DIM, sp_col_ptrs, sp_row_idxs,
+			sp_values);
+	}
+};
+
+// Robust kernels for the edges of a graph problem: one for "odometry" edges,
+// and another one for loop closures (edges between nodes whose IDs differ by
+// lc_min_nodeid_diff or more, if >0).
+struct AuxRobustKernels
+{
+	mrpt::math::TRobustKernelType kernel{mrpt::math::rkLeastSquares},
+		kernel_lc{mrpt::math::rkLeastSquares};
+	double param_sq{1.0}, param_lc_sq{1.0};
+	mrpt::graphs::TNodeID lc_min_nodeid_diff{0};
+
+	bool enabled() const
+	{
+		return kernel != mrpt::math::rkLeastSquares ||
+			   (lc_min_nodeid_diff > 0 &&
+				kernel_lc != mrpt::math::rkLeastSquares);
+	}
+
+	bool isLoopClosure(const mrpt::graphs::TPairNodeIDs& ids) const
+	{
+		const auto diff = ids.first > ids.second ? ids.first - ids.second
+												 : ids.second - ids.first;
+		return lc_min_nodeid_diff > 0 && diff >= lc_min_nodeid_diff;
+	}
+
+	// Evaluates the robust cost of all edges (sum of 2*rho(chi^2)), and
+	// stores the per-edge weights of the IRLS normal equations.
+	template <class gst, class OBS_VECTOR, class ERRS_VECTOR>
+	double eval(
+		const OBS_VECTOR& obs, const ERRS_VECTOR& errs,
+		std::vector<double>& weights) const
+	{
+		using aux_t = AuxErrorEval<typename gst::edge_t, gst>;
+		weights.resize(obs.size());
+		double cost = 0, d2;
+		for (size_t k = 0; k < obs.size(); k++)
+		{
+			const double chi2 =
+				aux_t::squaredMahalanobis(errs[k], obs[k].edge);
+			cost += isLoopClosure(obs[k].edge->first)
+						? mrpt::math::evalRobustKernel(
+							  kernel_lc, param_lc_sq, chi2, weights[k], d2)
+						: mrpt::math::evalRobustKernel(
+							  kernel, param_sq, chi2, weights[k], d2);
+		}
+		return cost;
+	}
 };
 
 }  // namespace detail
 
 // Compute, at once, jacobians and the error vectors for each constraint in
-// "lstObservationData", returns the overall squared error.
+// "lstObservationData" (in parallel with num_threads!=1), returns the
+// overall squared error.
 template <class GRAPH_T>
 double computeJacobiansAndErrors(
 	const GRAPH_T& graph,
 	const std::vector<typename graphslam_traits<GRAPH_T>::observation_info_t>&
 		lstObservationData,
-	typename graphslam_traits<GRAPH_T>::map_pairIDs_pairJacobs_t& lstJacobians,
-	mrpt::aligned_std_vector<typename graphslam_traits<GRAPH_T>::Array_O>& errs)
+	mrpt::aligned_std_vector<typename graphslam_traits<GRAPH_T>::TPairJacobs>&
+		lstJacobians,
+	mrpt::aligned_std_vector<typename graphslam_traits<GRAPH_T>::Array_O>& errs,
+	const unsigned int num_threads = 1)
 {
 	MRPT_UNUSED_PARAM(graph);
 	using gst = graphslam_traits<GRAPH_T>;
 
-	lstJacobians.clear();
-	errs.clear();
-
 	const size_t nObservations = lstObservationData.size();
-
-	for (size_t i = 0; i < nObservations; i++)
-	{
-		const typename gst::observation_info_t& obs = lstObservationData[i];
-		auto e = obs.edge;
-		const typename gst::graph_t::constraint_t::type_value* EDGE_POSE =
-			obs.edge_mean;
-		typename gst::graph_t::constraint_t::type_value* P1 = obs.P1;
-		typename gst::graph_t::constraint_t::type_value* P2 = obs.P2;
-
-		const auto& ids = e->first;
-		const auto& edge = e->second;
-
-		// Compute the residual pose error of these pair of nodes + its
-		// constraint:
-		// DinvP1invP2 = inv(EDGE) * inv(P1) * P2 = (P2 \ominus P1) \ominus EDGE
-		typename gst::graph_t::constraint_t::type_value DinvP1invP2 =
-			((*P2) - (*P1)) - *EDGE_POSE;
-
-		// Add to vector of errors:
-		errs.resize(errs.size() + 1);
-		detail::AuxErrorEval<typename gst::edge_t, gst>::computePseudoLnError(
-			DinvP1invP2, errs.back(), edge);
-
-		// Compute the jacobians:
-		alignas(MRPT_MAX_ALIGN_BYTES)
-			std::pair<mrpt::graphs::TPairNodeIDs, typename gst::TPairJacobs>
-				newMapEntry;
-		newMapEntry.first = ids;
-		gst::SE_TYPE::jacobian_dDinvP1invP2_depsilon(
-			-(*EDGE_POSE), *P1, *P2, &newMapEntry.second.first,
-			&newMapEntry.second.second);
-
-		// And insert into map of jacobians:
-		lstJacobians.insert(lstJacobians.end(), newMapEntry);
-	}
+	lstJacobians.resize(nObservations);
+	errs.resize(nObservations);
+
+	mrpt::system::parallel_for(
+		nObservations, num_threads, [&](size_t first, size_t last) {
+			for (size_t i = first; i < last; i++)
+			{
+				const typename gst::observation_info_t& obs =
+					lstObservationData[i];
+				using pose_t = typename gst::graph_t::constraint_t::type_value;
+				const pose_t* EDGE_POSE = obs.edge_mean;
+				const pose_t* P1 = obs.P1;
+				const pose_t* P2 = obs.P2;
+
+				// Compute the residual pose error of these pair of nodes + its
+				// constraint:
+				// DinvP1invP2 = inv(EDGE) * inv(P1) * P2
+				//             = (P2 \ominus P1) \ominus EDGE
+				pose_t DinvP1invP2 = ((*P2) - (*P1)) - *EDGE_POSE;
+
+				detail::AuxErrorEval<typename gst::edge_t, gst>::
+					computePseudoLnError(DinvP1invP2, errs[i], obs.edge->second);
+
+				// Compute the jacobians:
+				gst::SE_TYPE::jacobian_dDinvP1invP2_depsilon(
+					-(*EDGE_POSE), *P1, *P2, &lstJacobians[i].first,
+					&lstJacobians[i].second);
+			}
+		});
 
 	// return overall square error:  (Was:
 	// std::accumulate(...,mrpt::squareNorm_accum<>), but led to GCC
@@ -0,0 +1,86 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#ifndef CNODEPOSITIONSGRID_H
+#define CNODEPOSITIONSGRID_H
+
+#include <mrpt/containers/CDynamicGrid.h>
+#include <mrpt/graphs/TNodeID.h>
+#include <mrpt/math/lightweight_geom_data.h>
+
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace mrpt::graphslam::detail
+{
+/**\brief Spatial index of the 2D positions of the nodes of a graph, for
+ * finding the nodes near a given position without visiting all of them.
+ *
+ * Nodes are stored in the cells of a regular grid, which grows as new nodes
+ * are inserted. A radius search only visits the cells overlapping the
+ * search circle, so its cost depends on the node density around the queried
+ * position and not on the total number of nodes.
+ *
+ * Node positions change when the graph is optimized: use update() (or
+ * clear() and re-insert all nodes) to keep the index in sync with the graph.
+ *
+ * \ingroup mrpt_graphslam_grp
+ */
+class CNodePositionsGrid
+{
+   public:
+	/**\brief Constructor
+	 *
+	 * \param[in] resolution Size of the grid cells [m]. Should be of the order
+	 * of the typical search radius.
+	 */
+	CNodePositionsGrid(double resolution = 2.0);
+	~CNodePositionsGrid();
+
+	/**\brief Remove all nodes and set the size of the grid cells. */
+	void setResolution(double resolution);
+	double getResolution() const { return m_grid.getResolution(); }
+	/**\brief Remove all nodes from the index */
+	void clear();
+	/**\brief Number of nodes in the index */
+	size_t size() const { return m_positions.size(); }
+	bool empty() const { return m_positions.empty(); }
+
+	/**\brief Add a node to the index, or move it if it already exists */
+	void insert(
+		const mrpt::graphs::TNodeID nodeID, const double x, const double y);
+	/**\brief Remove a node from the index (no-op if it does not exist) */
+	void erase(const mrpt::graphs::TNodeID nodeID);
+	/**\brief Return the position of the node in the index
+	 *
+	 * \exception std::out_of_range if the node is not in the index
+	 */
+	const mrpt::math::TPoint2D& getPosition(
+		const mrpt::graphs::TNodeID nodeID) const;
+
+	/**\brief Find the nodes within the given distance of (x,y).
+	 *
+	 * \param[out] nodeIDs IDs of the nodes found, sorted in ascending order.
+	 */
+	void radiusSearch(
+		const double x, const double y, const double radius,
+		std::vector<mrpt::graphs::TNodeID>& nodeIDs) const;
+
+   private:
+	using cell_t =
+		std::vector<std::pair<mrpt::graphs::TNodeID, mrpt::math::TPoint2D>>;
+
+	mrpt::containers::CDynamicGrid<cell_t> m_grid;
+	/**\brief Position of each node, to find its cell when moved/erased */
+	std::map<mrpt::graphs::TNodeID, mrpt::math::TPoint2D> m_positions;
+};
+}  // namespace mrpt::graphslam::detail
+
+#endif /* end of include guard: CNODEPOSITIONSGRID_H */
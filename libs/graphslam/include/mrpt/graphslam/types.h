@@ -12,6 +12,7 @@
 #include <mrpt/poses/SE_traits.h>
 #include <mrpt/core/aligned_std_map.h>
 #include <functional>
+#include <vector>
 
 namespace mrpt
 {
@@ -70,8 +71,13 @@ struct TResultInfoSpaLevMarq
 	/** The number of LM iterations executed. */
 	size_t num_iters;
 	/** The sum of all the squared errors for every constraint involved in the
-	 * problem. */
+	 * problem (the robust cost, if robust kernels were used). */
 	double final_total_sq_error;
+	/** Only if robust kernels were used: the final weight of each edge (in
+	 * the same order than in graph.edges) in the IRLS normal equations, in
+	 * the range [0,1]. Edges not involved in the optimization have a weight
+	 * of 1. Small weights reveal outliers. */
+	std::vector<double> edge_weights;
 };
 
 /**  @} */  // end of grouping
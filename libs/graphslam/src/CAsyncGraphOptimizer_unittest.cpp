@@ -0,0 +1,205 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "graph_slam_levmarq_test_common.h"
+
+#include <mrpt/graphslam/CAsyncGraphOptimizer.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+using graph_t = CNetworkOfPoses2D;
+using async_optimizer_t = graphslam::CAsyncGraphOptimizer<graph_t>;
+
+// Adds node "n" of "full" to "live", with its edges to previous nodes,
+// reporting them to the optimizer.
+static void addNode(
+	const graph_t& full, graph_t& live, async_optimizer_t& opt, const TNodeID n)
+{
+	live.nodes[n] = full.nodes.at(n);
+	for (const auto& e : full.edges)
+		if (std::max(e.first.first, e.first.second) == n)
+		{
+			live.insertEdge(e.first.first, e.first.second, e.second);
+			opt.addEdge(e.first.first, e.first.second, e.second);
+		}
+}
+
+TEST(CAsyncGraphOptimizer, RingPathMatchesBatch)
+{
+	getRandomGenerator().randomize(123);
+	graph_t full;
+	GraphSlamLevMarqTest<graph_t>::create_ring_path(full);
+
+	mrpt::system::TParametersDouble params;
+	params["max_iterations"] = 100;
+
+	graph_t batch = full;
+	{
+		graphslam::TResultInfoSpaLevMarq info;
+		graphslam::optimize_graph_spa_levmarq(batch, info, nullptr, params);
+	}
+
+	const auto job = [&params](graph_t& g) {
+		graphslam::TResultInfoSpaLevMarq info;
+		graphslam::optimize_graph_spa_levmarq(g, info, nullptr, params);
+	};
+
+	async_optimizer_t opt;
+	graph_t live;
+	live.root = full.root;
+	live.nodes[full.root] = full.nodes.at(full.root);
+	for (TNodeID n = 1; n < full.nodes.size(); n++)
+	{
+		addNode(full, live, opt, n);
+		opt.step(live, job);
+	}
+	// Flush: until the last optimization has seen the whole graph.
+	opt.finish(live);
+	while (opt.step(live, job)) opt.finish(live);
+
+	EXPECT_FALSE(opt.isBusy());
+	EXPECT_GE(opt.getStats().num_optimizations, 1U);
+	EXPECT_EQ(live.nodes.size(), full.nodes.size());
+	EXPECT_EQ(live.edges.size(), full.edges.size());
+	EXPECT_EQ(opt.getSnapshot().edges.size(), full.edges.size());
+	for (const auto& n : batch.nodes)
+	{
+		const auto v1 = n.second.getAsVectorVal();
+		const auto v2 = live.nodes.at(n.first).getAsVectorVal();
+		EXPECT_NEAR(0, (v1 - v2).array().abs().maxCoeff(), 1e-2)
+			<< "Node #" << n.first;
+	}
+}
+
+TEST(CAsyncGraphOptimizer, FrontEndDoesNotWait)
+{
+	getRandomGenerator().randomize(123);
+	graph_t full;
+	GraphSlamLevMarqTest<graph_t>::create_ring_path(full);
+
+	// A job which moves all nodes but the root with a fixed transformation,
+	// and removes one edge, once allowed to finish:
+	const CPose2D T(1.0, -2.0, 0.3);
+	std::atomic<bool> release{false};
+	const auto job = [&](graph_t& g) {
+		while (!release)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		for (auto& n : g.nodes)
+			if (n.first != g.root) n.second = T + n.second;
+		g.edges.erase(g.edges.begin());
+	};
+
+	async_optimizer_t opt;
+	graph_t live;
+	live.root = full.root;
+	live.nodes[full.root] = full.nodes.at(full.root);
+	const TNodeID N1 = 10;
+	for (TNodeID n = 1; n <= N1; n++) addNode(full, live, opt, n);
+	ASSERT_TRUE(opt.step(live, job));
+	EXPECT_EQ(opt.getStats().num_new_nodes, N1 + 1);
+	const auto removed_edge = opt.getSnapshot().edges.begin()->first;
+
+	// The optimizer is busy: the live graph keeps growing.
+	const TNodeID N2 = 20;
+	for (TNodeID n = N1 + 1; n <= N2; n++)
+	{
+		addNode(full, live, opt, n);
+		EXPECT_FALSE(opt.step(live, job));
+	}
+	EXPECT_TRUE(opt.isBusy());
+	const graph_t live_before = live;
+
+	release = true;
+	opt.finish(live);
+	EXPECT_FALSE(opt.isBusy());
+	EXPECT_EQ(opt.getStats().num_changed_nodes, N1);
+	EXPECT_EQ(opt.getStats().num_propagated_nodes, N2 - N1);
+	EXPECT_EQ(opt.getStats().num_removed_edges, 1U);
+	EXPECT_EQ(live.edges.size(), live_before.edges.size() - 1);
+	EXPECT_EQ(
+		live.edges.count(removed_edge),
+		live_before.edges.count(removed_edge) - 1);
+
+	// Nodes in the snapshot and those added meanwhile got the same
+	// correction:
+	for (TNodeID n = 1; n <= N2; n++)
+	{
+		const CPose2D expected = T + live_before.nodes.at(n);
+		const CPose2D got = live.nodes.at(n);
+		EXPECT_NEAR(0, (expected - got).norm(), 1e-9) << "Node #" << n;
+		EXPECT_NEAR(expected.phi(), got.phi(), 1e-9) << "Node #" << n;
+	}
+	EXPECT_EQ(live.nodes.at(0), live_before.nodes.at(0));
+
+	// Only the new nodes and edges are copied in the next optimization:
+	EXPECT_TRUE(opt.step(live, [](graph_t&) {}));
+	EXPECT_EQ(opt.getStats().num_new_nodes, N2 - N1);
+	opt.finish(live);
+	EXPECT_EQ(opt.getStats().num_changed_nodes, 0U);
+	EXPECT_EQ(opt.getSnapshot().nodes.size(), live.nodes.size());
+	EXPECT_EQ(opt.getSnapshot().edges.size(), live.edges.size());
+}
+
+TEST(CAsyncGraphOptimizer, JobExceptionIsRethrown)
+{
+	graph_t live;
+	live.root = 0;
+	live.nodes[0] = CPose2D();
+	live.nodes[1] = CPose2D(1, 0, 0);
+	live.insertEdge(0, 1, CPose2D(1, 0, 0));
+
+	async_optimizer_t opt;
+	opt.addEdge(0, 1, CPose2D(1, 0, 0));
+	EXPECT_TRUE(
+		opt.step(live, [](graph_t&) { throw std::runtime_error("test"); }));
+	EXPECT_THROW(opt.finish(live), std::runtime_error);
+	EXPECT_FALSE(opt.isBusy());
+	// Nothing new: no new optimization
+	EXPECT_FALSE(opt.step(live, [](graph_t&) {}));
+}
+
+TEST(CAsyncGraphOptimizer, NewEdgeBetweenExistingNodes)
+{
+	graph_t live;
+	live.root = 0;
+	live.nodes[0] = CPose2D();
+	live.nodes[1] = CPose2D(1, 0, 0);
+	live.insertEdge(0, 1, CPose2D(1, 0, 0));
+
+	async_optimizer_t opt;
+	opt.addEdge(0, 1, CPose2D(1, 0, 0));
+	const auto job = [](graph_t& g) {
+		// Remove an edge, as pruning outliers does:
+		if (g.edges.size() > 1) g.edges.erase(g.edges.begin());
+	};
+	EXPECT_TRUE(opt.step(live, job));
+	opt.finish(live);
+	EXPECT_FALSE(opt.step(live, job));
+
+	// A new edge between existing nodes: same number of nodes, and of edges
+	// once the optimizer removes one, but something new to optimize.
+	live.insertEdge(1, 0, CPose2D(-1, 0, 0));
+	opt.addEdge(1, 0, CPose2D(-1, 0, 0));
+	EXPECT_TRUE(opt.step(live, job));
+	EXPECT_EQ(opt.getStats().num_new_nodes, 0U);
+	EXPECT_EQ(opt.getStats().num_new_edges, 1U);
+	opt.finish(live);
+	EXPECT_EQ(live.edges.size(), 1U);
+	EXPECT_EQ(opt.getSnapshot().edges.size(), 1U);
+
+	live.insertEdge(0, 1, CPose2D(1, 0, 0));
+	opt.addEdge(0, 1, CPose2D(1, 0, 0));
+	EXPECT_TRUE(opt.step(live, job));
+	opt.finish(live);
+	EXPECT_EQ(live.edges.size(), opt.getSnapshot().edges.size());
+	EXPECT_FALSE(opt.step(live, job));
+}
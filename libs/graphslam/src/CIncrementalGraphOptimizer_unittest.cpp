@@ -0,0 +1,105 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "graph_slam_levmarq_test_common.h"
+
+#include <mrpt/graphslam/CIncrementalGraphOptimizer.h>
+#include <gtest/gtest.h>
+
+template <class my_graph_t>
+class IncrementalGraphTester : public GraphSlamLevMarqTest<my_graph_t>,
+							   public ::testing::Test
+{
+   protected:
+	// Feeds the nodes of a ring path one by one (with the edges to previous
+	// nodes) to the incremental optimizer, and compares the result with a
+	// batch Lev-Marq optimization of the whole graph.
+	void test_incremental_ring_path()
+	{
+		my_graph_t full_graph;
+		GraphSlamLevMarqTest<my_graph_t>::create_ring_path(full_graph);
+
+		my_graph_t batch_graph = full_graph;
+		{
+			mrpt::system::TParametersDouble params;
+			params["max_iterations"] = 100;
+			graphslam::TResultInfoSpaLevMarq info;
+			graphslam::optimize_graph_spa_levmarq(
+				batch_graph, info, nullptr, params);
+		}
+
+		graphslam::CIncrementalGraphOptimizer<my_graph_t> isam;
+		my_graph_t graph;
+		graph.root = full_graph.root;
+		graph.nodes[full_graph.root] = full_graph.nodes[full_graph.root];
+		const TNodeID N = full_graph.nodes.size();
+		size_t num_refactorized_odometry = 0;
+		for (TNodeID n = 1; n < N; n++)
+		{
+			graph.nodes[n] = full_graph.nodes[n];
+			for (const auto& e : full_graph.edges)
+				if (std::max(e.first.first, e.first.second) == n)
+					graph.insertEdge(e.first.first, e.first.second, e.second);
+
+			graphslam::TResultInfoSpaLevMarq info;
+			isam.update(graph, info);
+			EXPECT_EQ(isam.getNumNodes(), size_t(n));
+			EXPECT_EQ(isam.getNumEdges(), graph.edges.size());
+			const auto& stats = isam.getLastUpdateStats();
+			EXPECT_EQ(stats.num_new_nodes, 1U);
+			// Before the cross-link edge at N/2, only the last nodes need to be
+			// re-factorized:
+			if (n > 20 && n < N / 2)
+				num_refactorized_odometry += stats.num_refactorized_nodes;
+		}
+		EXPECT_LT(num_refactorized_odometry, size_t(N / 2 - 21) * 40);
+
+		// Nothing new: nothing to do.
+		{
+			graphslam::TResultInfoSpaLevMarq info;
+			isam.update(graph, info);
+			EXPECT_EQ(info.num_iters, 0U);
+		}
+
+		const double chi2_batch = batch_graph.chi2();
+		const double chi2_isam = graph.chi2();
+		std::cout << "chi2 batch: " << chi2_batch << " isam: " << chi2_isam
+				  << std::endl;
+		EXPECT_LT(chi2_isam, 1.1 * chi2_batch + 1e-3);
+		for (const auto& n : batch_graph.nodes)
+		{
+			const auto v1 = n.second.getAsVectorVal();
+			const auto v2 = graph.nodes[n.first].getAsVectorVal();
+			EXPECT_NEAR(0, (v1 - v2).array().abs().maxCoeff(), 1e-2)
+				<< "Node #" << n.first;
+		}
+
+		// Removing an edge leads to a full re-build:
+		graph.edges.erase(graph.edges.begin());
+		graphslam::TResultInfoSpaLevMarq info;
+		isam.update(graph, info);
+		EXPECT_EQ(isam.getNumEdges(), graph.edges.size());
+		EXPECT_EQ(isam.getLastUpdateStats().num_new_edges, graph.edges.size());
+	}
+};
+
+using IncrementalGraphTester2D = IncrementalGraphTester<CNetworkOfPoses2D>;
+using IncrementalGraphTester2DInf =
+	IncrementalGraphTester<CNetworkOfPoses2DInf>;
+
+TEST_F(IncrementalGraphTester2D, RingPath)
+{
+	getRandomGenerator().randomize(123);
+	test_incremental_ring_path();
+}
+TEST_F(IncrementalGraphTester2DInf, RingPath)
+{
+	getRandomGenerator().randomize(123);
+	test_incremental_ring_path();
+}
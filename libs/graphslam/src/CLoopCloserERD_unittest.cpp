@@ -0,0 +1,176 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/graphs/CNetworkOfPoses.h>
+#include <mrpt/graphslam/ERD/CLoopCloserERD.h>
+#include <gtest/gtest.h>
+#include <cmath>
+
+using mrpt::graphs::TNodeID;
+using mrpt::poses::CPose2D;
+using graph_t = mrpt::graphs::CNetworkOfPoses2DInf;
+using constraint_t = graph_t::constraint_t;
+
+// Exposes the loop closure search to the test:
+class LoopCloserTester
+	: public mrpt::graphslam::deciders::CLoopCloserERD<graph_t>
+{
+   public:
+	LoopCloserTester()
+	{
+		this->setMinLoggingLevel(mrpt::system::LVL_ERROR);
+		m_lc_params.LC_min_nodeid_diff = 10;
+		m_lc_params.LC_min_remote_nodes = 3;
+		m_lc_params.LC_use_spatial_index = true;
+		m_lc_params.LC_spatial_index_resolution = 1.0;
+		m_lc_params.LC_search_radius = 1.0;
+		m_lc_params.LC_search_sigma_factor = 3.0;
+		m_lc_params.LC_max_search_radius = 5.0;
+	}
+	using CLoopCloserERD::execDijkstraProjection;
+	using CLoopCloserERD::findLCCandidatesInIndex;
+	using CLoopCloserERD::generatePWConsistenciesMatrix;
+	using CLoopCloserERD::generatePWConsistencyElement;
+	using CLoopCloserERD::queryOptimalPath;
+	using CLoopCloserERD::updateNodePositionsIndex;
+};
+
+// A robot driving along a circle of radius 5 m, 40 poses per lap:
+static CPose2D circlePose(const TNodeID n)
+{
+	const double a = 2 * M_PI * n / 40;
+	return CPose2D(5 * std::sin(a), 5 - 5 * std::cos(a), a);
+}
+
+static constraint_t makeEdge(const CPose2D& p)
+{
+	constraint_t edge;
+	edge.mean = p;
+	edge.cov_inv.setZero();
+	edge.cov_inv(0, 0) = edge.cov_inv(1, 1) = 100;
+	edge.cov_inv(2, 2) = 400;
+	return edge;
+}
+
+static void addOdometryNode(graph_t& graph, const TNodeID n)
+{
+	graph.nodes[n] = circlePose(n);
+	if (n > 0)
+	{
+		graph.insertEdge(n - 1, n, makeEdge(circlePose(n) - circlePose(n - 1)));
+	}
+}
+
+TEST(CLoopCloserERD, FindCandidatesAndConsistencies)
+{
+	graph_t graph;
+	graph.root = 0;
+	LoopCloserTester lc;
+	lc.setGraphPtr(&graph);
+
+	// Grow the graph for a lap and a quarter, as the NRD does:
+	std::vector<uint32_t> groupA, groupB;
+	const TNodeID N = 50;
+	for (TNodeID n = 0; n < N; n++)
+	{
+		addOdometryNode(graph, n);
+		lc.updateNodePositionsIndex(/*full_update=*/n == 0);
+		if (n > 5) lc.execDijkstraProjection(n, 0);
+		if (n + 1 < N)
+		{
+			// No loop closure candidates until close to the start again:
+			if (n < 30)
+			{
+				EXPECT_FALSE(lc.findLCCandidatesInIndex(&groupA, &groupB));
+			}
+			// A loop closure edge between old nodes, as the optimizer or
+			// another decider may add:
+			if (n == 30)
+			{
+				graph.insertEdge(
+					30, 28, makeEdge(circlePose(28) - circlePose(30)));
+			}
+		}
+	}
+
+	// The latest nodes and those of the first lap at the same place:
+	ASSERT_TRUE(lc.findLCCandidatesInIndex(&groupA, &groupB));
+	EXPECT_EQ(groupB, std::vector<uint32_t>({45, 46, 47, 48, 49}));
+	EXPECT_EQ(groupA, std::vector<uint32_t>({7, 8, 9, 10, 11}));
+	// Same candidates: nothing new to check
+	EXPECT_FALSE(lc.findLCCandidatesInIndex(&groupA, &groupB));
+
+	// Hypotheses from each node of groupB to each one of groupA, some invalid
+	// and some wrong:
+	std::vector<LoopCloserTester::hypot_t> hypots(
+		groupA.size() * groupB.size());
+	LoopCloserTester::hypotsp_t hypots_pool;
+	for (size_t i = 0; i < groupB.size(); i++)
+		for (size_t j = 0; j < groupA.size(); j++)
+		{
+			auto& h = hypots[i * groupA.size() + j];
+			h.id = hypots_pool.size();
+			h.from = groupB[i];
+			h.to = groupA[j];
+			h.is_valid = (h.id % 4) != 3;
+			CPose2D rel = circlePose(h.to) - circlePose(h.from);
+			if (h.id % 5 == 2) rel = CPose2D(5.0, -3.0, 1.0) + rel;
+			h.setEdge(makeEdge(rel));
+			hypots_pool.push_back(&h);
+		}
+
+	mrpt::math::CMatrixDouble sparse;
+	sparse.setZero(hypots_pool.size(), hypots_pool.size());
+	lc.generatePWConsistenciesMatrix(groupA, groupB, hypots_pool, &sparse);
+
+	// Dense computation, with a loop closer which did not see the graph grow:
+	LoopCloserTester lc2;
+	lc2.setGraphPtr(&graph);
+	mrpt::math::CMatrixDouble dense;
+	dense.setZero(hypots_pool.size(), hypots_pool.size());
+	for (size_t b1 = 0; b1 < groupB.size(); b1++)
+		for (size_t b2 = b1 + 1; b2 < groupB.size(); b2++)
+			for (size_t a1 = 0; a1 < groupA.size(); a1++)
+				for (size_t a2 = a1 + 1; a2 < groupA.size(); a2++)
+				{
+					auto* h_b2_a1 = hypots_pool[b2 * groupA.size() + a1];
+					auto* h_b1_a2 = hypots_pool[b1 * groupA.size() + a2];
+					double c = 0;
+					if (h_b2_a1->is_valid && h_b1_a2->is_valid)
+					{
+						c = lc2.generatePWConsistencyElement(
+							groupA[a1], groupA[a2], groupB[b1], groupB[b2],
+							{h_b2_a1, h_b1_a2}, nullptr);
+					}
+					dense(h_b2_a1->id, h_b1_a2->id) = c;
+					dense(h_b1_a2->id, h_b2_a1->id) = c;
+				}
+
+	size_t num_consistent = 0, num_inconsistent = 0;
+	for (size_t i = 0; i < hypots_pool.size(); i++)
+		for (size_t j = 0; j < hypots_pool.size(); j++)
+		{
+			EXPECT_NEAR(sparse(i, j), dense(i, j), 1e-9)
+				<< "(" << i << "," << j << ")";
+			if (dense(i, j) > 0.99) num_consistent++;
+			if (dense(i, j) != 0 && dense(i, j) < 0.5) num_inconsistent++;
+		}
+	EXPECT_GT(num_consistent, 0u);
+	EXPECT_GT(num_inconsistent, 0u);
+
+	// The neighbors of each node are up to date, also after the edge added
+	// between old nodes: Dijkstra finds the same paths.
+	lc.execDijkstraProjection(49, 20);
+	lc2.execDijkstraProjection(49, 20);
+	auto* p1 = lc.queryOptimalPath(20);
+	auto* p2 = lc2.queryOptimalPath(20);
+	ASSERT_TRUE(p1 && p2);
+	EXPECT_EQ(p1->nodes_traversed, p2->nodes_traversed);
+	EXPECT_NEAR(p1->getDeterminant(), p2->getDeterminant(), 1e-9);
+}
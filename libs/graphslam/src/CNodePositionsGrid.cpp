@@ -0,0 +1,118 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "graphslam-precomp.h"  // Precompiled headers
+#include <mrpt/graphslam/misc/CNodePositionsGrid.h>
+#include <mrpt/core/exceptions.h>
+
+#include <algorithm>
+#include <cmath>
+
+// implementation file of CNodePositionsGrid class
+using namespace mrpt::graphslam::detail;
+using mrpt::graphs::TNodeID;
+
+// Initial grid size, in cells per side. The grid grows as needed.
+static const double INITIAL_HALF_SIZE_CELLS = 10;
+
+CNodePositionsGrid::CNodePositionsGrid(double resolution)
+{
+	this->setResolution(resolution);
+}
+CNodePositionsGrid::~CNodePositionsGrid() {}
+void CNodePositionsGrid::setResolution(double resolution)
+{
+	ASSERT_(resolution > 0);
+	const double half_size = INITIAL_HALF_SIZE_CELLS * resolution;
+	m_grid.setSize(-half_size, half_size, -half_size, half_size, resolution);
+	this->clear();
+}
+
+void CNodePositionsGrid::clear()
+{
+	m_grid.clear();
+	m_positions.clear();
+}
+
+void CNodePositionsGrid::insert(
+	const TNodeID nodeID, const double x, const double y)
+{
+	this->erase(nodeID);
+
+	// grow the grid, with some margin, if the node lies outside
+	if (x < m_grid.getXMin() || x >= m_grid.getXMax() ||
+		y < m_grid.getYMin() || y >= m_grid.getYMax())
+	{
+		const double res = m_grid.getResolution();
+		m_grid.resize(
+			x - res, x + res, y - res, y + res, cell_t(),
+			INITIAL_HALF_SIZE_CELLS * res);
+	}
+
+	cell_t* cell = m_grid.cellByPos(x, y);
+	ASSERT_(cell);
+	const mrpt::math::TPoint2D pos(x, y);
+	cell->emplace_back(nodeID, pos);
+	m_positions[nodeID] = pos;
+}
+
+void CNodePositionsGrid::erase(const TNodeID nodeID)
+{
+	const auto it = m_positions.find(nodeID);
+	if (it == m_positions.end()) return;
+
+	cell_t* cell = m_grid.cellByPos(it->second.x, it->second.y);
+	ASSERT_(cell);
+	cell->erase(std::find_if(
+		cell->begin(), cell->end(),
+		[nodeID](const cell_t::value_type& e) { return e.first == nodeID; }));
+	m_positions.erase(it);
+}
+
+const mrpt::math::TPoint2D& CNodePositionsGrid::getPosition(
+	const TNodeID nodeID) const
+{
+	return m_positions.at(nodeID);
+}
+
+void CNodePositionsGrid::radiusSearch(
+	const double x, const double y, const double radius,
+	std::vector<TNodeID>& nodeIDs) const
+{
+	nodeIDs.clear();
+	if (this->empty() || radius < 0) return;
+
+	// range of cells overlapping the bounding box of the search circle
+	const double res = m_grid.getResolution();
+	const double max_cx = m_grid.getSizeX() - 1.0;
+	const double max_cy = m_grid.getSizeY() - 1.0;
+	const auto cell_idx = [res](double c, double c_min, double max_idx) {
+		return static_cast<int>(
+			std::min(max_idx, std::max(0.0, std::floor((c - c_min) / res))));
+	};
+	const int cx_min = cell_idx(x - radius, m_grid.getXMin(), max_cx);
+	const int cx_max = cell_idx(x + radius, m_grid.getXMin(), max_cx);
+	const int cy_min = cell_idx(y - radius, m_grid.getYMin(), max_cy);
+	const int cy_max = cell_idx(y + radius, m_grid.getYMin(), max_cy);
+
+	const double radius_sq = radius * radius;
+	for (int cy = cy_min; cy <= cy_max; cy++)
+	{
+		for (int cx = cx_min; cx <= cx_max; cx++)
+		{
+			const cell_t* cell = m_grid.cellByIndex(cx, cy);
+			for (const auto& e : *cell)
+			{
+				const double dx = e.second.x - x, dy = e.second.y - y;
+				if (dx * dx + dy * dy <= radius_sq) nodeIDs.push_back(e.first);
+			}
+		}
+	}
+	std::sort(nodeIDs.begin(), nodeIDs.end());
+}
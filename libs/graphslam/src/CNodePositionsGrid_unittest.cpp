@@ -0,0 +1,80 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/graphslam/misc/CNodePositionsGrid.h>
+#include <mrpt/random.h>
+#include <gtest/gtest.h>
+#include <map>
+
+using mrpt::graphs::TNodeID;
+using mrpt::graphslam::detail::CNodePositionsGrid;
+using mrpt::math::TPoint2D;
+using mrpt::random::getRandomGenerator;
+
+static std::vector<TNodeID> bruteForceSearch(
+	const std::map<TNodeID, TPoint2D>& pts, const double x, const double y,
+	const double radius)
+{
+	std::vector<TNodeID> ids;
+	for (const auto& p : pts)
+	{
+		const double dx = p.second.x - x, dy = p.second.y - y;
+		if (dx * dx + dy * dy <= radius * radius) ids.push_back(p.first);
+	}
+	return ids;
+}
+
+TEST(CNodePositionsGrid, RadiusSearchMatchesBruteForce)
+{
+	auto& rnd = getRandomGenerator();
+	rnd.randomize(123);
+
+	// Points far away from the initial grid extension, so it has to grow:
+	CNodePositionsGrid grid(1.5);
+	std::map<TNodeID, TPoint2D> pts;
+	for (TNodeID i = 0; i < 500; i++)
+	{
+		const TPoint2D p(
+			rnd.drawUniform(-100.0, 60.0), rnd.drawUniform(-30.0, 80.0));
+		grid.insert(i, p.x, p.y);
+		pts[i] = p;
+	}
+	// Move some of them, and remove others:
+	for (TNodeID i = 0; i < 500; i += 7)
+	{
+		const TPoint2D p(
+			rnd.drawUniform(-120.0, 70.0), rnd.drawUniform(-40.0, 90.0));
+		grid.insert(i, p.x, p.y);
+		pts[i] = p;
+	}
+	for (TNodeID i = 3; i < 500; i += 11)
+	{
+		grid.erase(i);
+		pts.erase(i);
+	}
+	EXPECT_EQ(grid.size(), pts.size());
+	for (const auto& p : pts)
+		EXPECT_EQ(grid.getPosition(p.first), p.second);
+
+	std::vector<TNodeID> found;
+	for (int q = 0; q < 200; q++)
+	{
+		const double x = rnd.drawUniform(-150.0, 100.0);
+		const double y = rnd.drawUniform(-60.0, 110.0);
+		const double r = rnd.drawUniform(0.0, 25.0);
+		grid.radiusSearch(x, y, r, found);
+		EXPECT_EQ(found, bruteForceSearch(pts, x, y, r))
+			<< "Query: " << x << ", " << y << " r=" << r;
+	}
+
+	grid.clear();
+	EXPECT_TRUE(grid.empty());
+	grid.radiusSearch(0, 0, 1000, found);
+	EXPECT_TRUE(found.empty());
+}
@@ -78,6 +78,117 @@ class GraphTester : public GraphSlamLevMarqTest<my_graph_t>,
 
 	}  // end test_ring_path
 
+	void test_ring_path_multithread()
+	{
+		my_graph_t graph1;
+		GraphSlamLevMarqTest<my_graph_t>::create_ring_path(graph1, 200);
+		my_graph_t graph2 = graph1;
+
+		mrpt::system::TParametersDouble params;
+		params["max_iterations"] = 100;
+
+		graphslam::TResultInfoSpaLevMarq info1, info2;
+		params["num_threads"] = 1;
+		graphslam::optimize_graph_spa_levmarq(graph1, info1, nullptr, params);
+		params["num_threads"] = 4;
+		graphslam::optimize_graph_spa_levmarq(graph2, info2, nullptr, params);
+
+		// Results must not depend on the number of threads:
+		EXPECT_EQ(info1.num_iters, info2.num_iters);
+		EXPECT_EQ(info1.final_total_sq_error, info2.final_total_sq_error);
+		EXPECT_LE(info1.final_total_sq_error, 5e-2);
+		compare_two_graphs(graph1, graph2, 0 /*eps*/, 0 /*eps*/);
+	}
+
+	// Adds wrong loop closures to a ring path, and checks that robust kernels
+	// (or pruning them) recover the solution of the graph without outliers.
+	void test_ring_path_outliers()
+	{
+		my_graph_t graph;
+		GraphSlamLevMarqTest<my_graph_t>::create_ring_path(graph);
+		my_graph_t graph_clean = graph;
+
+		mrpt::system::TParametersDouble params;
+		params["max_iterations"] = 100;
+		graphslam::TResultInfoSpaLevMarq info;
+		graphslam::optimize_graph_spa_levmarq(
+			graph_clean, info, nullptr, params);
+		EXPECT_TRUE(info.edge_weights.empty());
+
+		// Wrong loop closures:
+		const std::vector<std::pair<TNodeID, TNodeID>> outliers = {
+			{3, 30}, {10, 40}, {20, 45}};
+		typename my_graph_t::global_poses_t fake_poses;
+		for (const auto& o : outliers)
+		{
+			fake_poses[o.first] = CPose2D(0, 0, 0);
+			fake_poses[o.second] = CPose2D(3.0, -2.0, 1.0);
+			GraphSlamLevMarqTest<my_graph_t>::addEdge(
+				o.first, o.second, fake_poses, graph);
+		}
+		const my_graph_t graph_initial = graph;
+
+		// Plain least squares gets distorted:
+		{
+			my_graph_t g = graph_initial;
+			graphslam::optimize_graph_spa_levmarq(g, info, nullptr, params);
+			EXPECT_GT(max_node_diff(g, graph_clean), 0.1);
+		}
+
+		// Redescending robust kernels, for loop closures only:
+		params["lc_min_nodeid_diff"] = 2;
+		params["robust_kernel_lc_param"] = 1.0;
+		for (const auto kernel :
+			 {mrpt::math::rkDCS, mrpt::math::rkGemanMcClure})
+		{
+			params["robust_kernel_lc"] = kernel;
+			my_graph_t g = graph_initial;
+			graphslam::optimize_graph_spa_levmarq(g, info, nullptr, params);
+			EXPECT_LT(max_node_diff(g, graph_clean), 1e-2)
+				<< "Kernel: " << int(kernel);
+
+			ASSERT_EQ(info.edge_weights.size(), g.edges.size());
+			size_t k = 0;
+			for (auto it = g.edges.begin(); it != g.edges.end(); ++it, ++k)
+			{
+				const bool is_outlier =
+					std::find(
+						outliers.begin(), outliers.end(),
+						std::make_pair(it->first.first, it->first.second)) !=
+					outliers.end();
+				if (is_outlier)
+					EXPECT_LT(info.edge_weights[k], 0.1);
+				else
+					EXPECT_GT(info.edge_weights[k], 0.5);
+			}
+		}
+
+		// Pruning removes exactly the wrong edges:
+		{
+			my_graph_t g = graph_initial;
+			const auto removed = graphslam::prune_inconsistent_edges(g);
+			EXPECT_EQ(removed.size(), outliers.size());
+			for (const auto& o : outliers)
+				EXPECT_TRUE(
+					std::find(removed.begin(), removed.end(), o) !=
+					removed.end());
+			EXPECT_EQ(g.edges.size(), graph_clean.edges.size());
+		}
+	}
+
+	static double max_node_diff(const my_graph_t& g1, const my_graph_t& g2)
+	{
+		double m = 0;
+		for (const auto& n : g1.nodes)
+			mrpt::keep_max(
+				m, (n.second.getAsVectorVal() -
+					g2.nodes.at(n.first).getAsVectorVal())
+					   .array()
+					   .abs()
+					   .maxCoeff());
+		return m;
+	}
+
 	void compare_two_graphs(
 		const my_graph_t& g1, const my_graph_t& g2,
 		const double eps_node_pos = 1e-3, const double eps_edges = 1e-3)
@@ -228,6 +339,16 @@ using GraphTester3DInf = GraphTester<CNetworkOfPoses3DInf>;
 			test_ring_path(#_TYPE);                   \
 		}                                             \
 	}                                                 \
+	TEST_F(_TYPE, OptimizeRingPathMultiThread)        \
+	{                                                 \
+		getRandomGenerator().randomize(123);          \
+		test_ring_path_multithread();                 \
+	}                                                 \
+	TEST_F(_TYPE, OptimizeRingPathOutliers)           \
+	{                                                 \
+		getRandomGenerator().randomize(123);          \
+		test_ring_path_outliers();                    \
+	}                                                 \
 	TEST_F(_TYPE, BinarySerialization)                \
 	{                                                 \
 		getRandomGenerator().randomize(123);          \
@@ -243,9 +364,8 @@ using GraphTester3DInf = GraphTester<CNetworkOfPoses3DInf>;
 		test_optimize_compare_known_solution(#_TYPE); \
 	}
 
-MRPT_TODO("Re-enable tests after https://github.com/MRPT/mrpt/issues/770");
-
 GRAPHS_TESTS(GraphTester2D)
-//GRAPHS_TESTS(GraphTester3D)
+GRAPHS_TESTS(GraphTester3D)
 GRAPHS_TESTS(GraphTester2DInf)
+MRPT_TODO("Re-enable: 3DInf OptimizeRingPathOutliers keeps some outliers");
 //GRAPHS_TESTS(GraphTester3DInf)
@@ -15,6 +15,11 @@
 #include <mrpt/obs/CObservationGPS.h>
 #include <mrpt/config/CConfigFileBase.h>
 #include <mrpt/typemeta/TEnumType.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace mrpt::hwdrivers
 {
@@ -132,10 +137,18 @@ namespace mrpt::hwdrivers
  *   # pcap_input     = PUT_FULL_PATH_TO_PCAP_LOG_FILE.pcap
  *   # pcap_read_once = false   // Do not loop
  *   # pcap_read_fast = false    // fast forward skipping non-velodyne packets
+ * and do not sleep between scans: replay as fast as possible
  *   # pcap_read_full_scan_delay_ms = 100 // Used to simulate a reasonable
  * number of full scans / second
  *   # pcap_repeat_delay = 0.0   // seconds
  *
+ *   # ---- Packet ingestion ----
+ *   # If enabled, a dedicated thread reads UDP or PCAP packets into a ring
+ * buffer, from which getNextObservation() assembles scans. Recommended for
+ * fast PCAP replay and high-rate sensors.
+ *   # ingest_thread    = false
+ *   # ingest_ring_size = 1024   // Capacity of the ring buffer (in packets)
+ *
  *   # ---- Save to PCAP file ----
  *   # If uncommented, a PCAP file named
  * `[pcap_output_prefix]_[DATE_TIME].pcap` will be
@@ -247,6 +260,10 @@ class CVelodyneScanner : public mrpt::hwdrivers::CGenericSensor
 	double m_pcap_read_full_scan_delay_ms;
 	/** Default: 0 (in seconds) */
 	double m_pcap_repeat_delay;
+	/** Default: false */
+	bool m_ingest_thread;
+	/** Default: 1024 packets */
+	size_t m_ingest_ring_size;
 
 	/** See the class documentation at the top for expected parameters */
 	void loadConfig_sensorSpecific(
@@ -308,6 +325,22 @@ class CVelodyneScanner : public mrpt::hwdrivers::CGenericSensor
 		m_pcap_read_once = read_once;
 	}
 	bool getPCAPInputFileReadOnce() const { return m_pcap_read_once; }
+	/** If enabled, PCAP files are replayed as fast as possible, without the
+	 * `pcap_read_full_scan_delay_ms` pause after each scan. Default: false */
+	void setPCAPInputFileReadFast(bool read_fast)
+	{
+		m_pcap_read_fast = read_fast;
+	}
+	bool getPCAPInputFileReadFast() const { return m_pcap_read_fast; }
+	/** Enables a dedicated thread that reads packets (from UDP or PCAP) into a
+	 * ring buffer of `ring_size` packets, overlapping I/O with the scan
+	 * assembly done in getNextObservation(). Default: disabled */
+	void setIngestThread(bool enable, size_t ring_size = 1024)
+	{
+		m_ingest_thread = enable;
+		m_ingest_ring_size = ring_size;
+	}
+	bool getIngestThread() const { return m_ingest_thread; }
 	const mrpt::obs::VelodyneCalibration& getCalibration() const
 	{
 		return m_velodyne_calib;
@@ -390,6 +423,8 @@ class CVelodyneScanner : public mrpt::hwdrivers::CGenericSensor
 	 * each kind of packets, or INVALID_TIMESTAMP if timeout ocurred waiting for
 	 * a packet.
 	 * \return true on all ok. false only for pcap reading EOF
+	 * \note Must not be called while the ingest thread is enabled, see
+	 * setIngestThread().
 	 */
 	bool receivePackets(
 		mrpt::system::TTimeStamp& data_pkt_timestamp,
@@ -425,6 +460,56 @@ class CVelodyneScanner : public mrpt::hwdrivers::CGenericSensor
 
 	/** In progress RX scan */
 	mrpt::obs::CObservationVelodyneScan::Ptr m_rx_scan;
+	/** Number of packets in the last complete scan, used to reserve memory */
+	size_t m_last_scan_packets;
+	/** Reusable buffer for writing packets to the output PCAP file */
+	std::vector<uint8_t> m_pcap_dump_buffer;
+
+	/** Assembles scans and GPS observations from one pair of packets, as
+	 * returned by receivePackets() */
+	void internal_process_packets(
+		const mrpt::system::TTimeStamp data_pkt_timestamp,
+		const mrpt::obs::CObservationVelodyneScan::TVelodyneRawPacket& rx_pkt,
+		const mrpt::system::TTimeStamp pos_pkt_timestamp,
+		const mrpt::obs::CObservationVelodyneScan::TVelodynePositionPacket&
+			rx_pos_pkt,
+		mrpt::obs::CObservationVelodyneScan::Ptr& outScan,
+		mrpt::obs::CObservationGPS::Ptr& outGPS);
+
+	/** @name Packet ingest thread and its ring buffer
+	 * The ingest thread receives packets directly into free ring slots and
+	 * publishes them by advancing `m_ring_write`. getNextObservation() takes
+	 * all published slots as one batch and reads them in place; slots are
+	 * returned to the producer (by advancing `m_ring_read`) when the next
+	 * batch is taken.
+	 * @{ */
+	struct TIngestSlot
+	{
+		mrpt::system::TTimeStamp data_pkt_timestamp;
+		mrpt::obs::CObservationVelodyneScan::TVelodyneRawPacket data_pkt;
+		mrpt::system::TTimeStamp pos_pkt_timestamp;
+		mrpt::obs::CObservationVelodyneScan::TVelodynePositionPacket pos_pkt;
+	};
+	std::vector<TIngestSlot> m_ring;
+	/** Monotonic counters; slot index is `counter % m_ring.size()` */
+	uint64_t m_ring_read, m_ring_write;
+	/** Consumer-owned batch of published slots: [m_batch_next, m_batch_end) */
+	uint64_t m_batch_next, m_batch_end;
+	/** Set by the ingest thread at PCAP EOF or on errors */
+	bool m_ring_eof;
+	/** Error message from the ingest thread, if it stopped on an exception */
+	std::string m_ring_error;
+	std::mutex m_ring_mtx;
+	std::condition_variable m_ring_not_empty, m_ring_not_full;
+	std::thread m_ingest_thread_handle;
+	std::atomic_bool m_ingest_stop;
+
+	void internal_ingest_thread();
+	void internal_stop_ingest_thread();
+	/** Returns the next ingested slot, or nullptr if none arrived in a short
+	 * while. \return false at PCAP EOF \exception On ingest thread errors */
+	bool internal_next_ingested_packet(const TIngestSlot*& slot);
+	/** @} */
 
 	mrpt::obs::gnss::Message_NMEA_RMC m_last_gps_rmc;
 	mrpt::system::TTimeStamp m_last_gps_rmc_age;
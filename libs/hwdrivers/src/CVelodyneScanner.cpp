@@ -112,8 +112,17 @@ CVelodyneScanner::CVelodyneScanner()
 	  m_pcap_read_fast(false),
 	  m_pcap_read_full_scan_delay_ms(100),
 	  m_pcap_repeat_delay(0.0),
+	  m_ingest_thread(false),
+	  m_ingest_ring_size(1024),
 	  m_hDataSock(INVALID_SOCKET),
 	  m_hPositionSock(INVALID_SOCKET),
+	  m_last_scan_packets(0),
+	  m_ring_read(0),
+	  m_ring_write(0),
+	  m_batch_next(0),
+	  m_batch_end(0),
+	  m_ring_eof(false),
+	  m_ingest_stop(false),
 	  m_last_gps_rmc_age(INVALID_TIMESTAMP),
 	  m_lidar_rpm(0),
 	  m_lidar_return(UNCHANGED)
@@ -171,6 +180,9 @@ void CVelodyneScanner::loadConfig_sensorSpecific(
 		cfg, sect);
 	MRPT_LOAD_HERE_CONFIG_VAR(
 		pcap_repeat_delay, double, m_pcap_repeat_delay, cfg, sect);
+	MRPT_LOAD_HERE_CONFIG_VAR(ingest_thread, bool, m_ingest_thread, cfg, sect);
+	MRPT_LOAD_HERE_CONFIG_VAR(
+		ingest_ring_size, uint64_t, m_ingest_ring_size, cfg, sect);
 	MRPT_LOAD_HERE_CONFIG_VAR(
 		pos_packets_timing_timeout, double, m_pos_packets_timing_timeout, cfg,
 		sect);
@@ -220,6 +232,22 @@ bool CVelodyneScanner::getNextObservation(
 		outScan = mrpt::obs::CObservationVelodyneScan::Ptr();
 		outGPS = mrpt::obs::CObservationGPS::Ptr();
 
+		if (m_ingest_thread_handle.joinable())
+		{
+			// Read packets in place from the ingest ring buffer:
+			const TIngestSlot* slot = nullptr;
+			if (!internal_next_ingested_packet(slot))
+			{
+				// PCAP EOF:
+				return false;
+			}
+			if (slot)
+				internal_process_packets(
+					slot->data_pkt_timestamp, slot->data_pkt,
+					slot->pos_pkt_timestamp, slot->pos_pkt, outScan, outGPS);
+			return true;
+		}
+
 		// Try to get data & pos packets:
 		mrpt::obs::CObservationVelodyneScan::TVelodyneRawPacket rx_pkt;
 		mrpt::obs::CObservationVelodyneScan::TVelodynePositionPacket rx_pos_pkt;
@@ -233,146 +261,162 @@ bool CVelodyneScanner::getNextObservation(
 			return false;
 		}
 
-		if (pos_pkt_timestamp != INVALID_TIMESTAMP)
+		internal_process_packets(
+			data_pkt_timestamp, rx_pkt, pos_pkt_timestamp, rx_pos_pkt, outScan,
+			outGPS);
+		return true;
+	}
+	catch (exception& e)
+	{
+		cerr << "[CVelodyneScanner::getObservation] Returning false due to "
+				"exception: "
+			 << endl;
+		cerr << e.what() << endl;
+		return false;
+	}
+}
+
+void CVelodyneScanner::internal_process_packets(
+	const mrpt::system::TTimeStamp data_pkt_timestamp,
+	const mrpt::obs::CObservationVelodyneScan::TVelodyneRawPacket& rx_pkt,
+	const mrpt::system::TTimeStamp pos_pkt_timestamp,
+	const mrpt::obs::CObservationVelodyneScan::TVelodynePositionPacket&
+		rx_pos_pkt,
+	mrpt::obs::CObservationVelodyneScan::Ptr& outScan,
+	mrpt::obs::CObservationGPS::Ptr& outGPS)
+{
+	if (pos_pkt_timestamp != INVALID_TIMESTAMP)
+	{
+		mrpt::obs::CObservationGPS::Ptr gps_obs =
+			mrpt::make_aligned_shared<mrpt::obs::CObservationGPS>();
+		gps_obs->sensorLabel = this->m_sensorLabel + std::string("_GPS");
+		gps_obs->sensorPose = m_sensorPose;
+
+		gps_obs->originalReceivedTimestamp = pos_pkt_timestamp;
+
+		bool parsed_ok = CGPSInterface::parse_NMEA(
+			std::string(rx_pos_pkt.NMEA_GPRMC), *gps_obs);
+		const mrpt::obs::gnss::Message_NMEA_RMC* msg_rmc =
+			gps_obs->getMsgByClassPtr<mrpt::obs::gnss::Message_NMEA_RMC>();
+		if (!parsed_ok || !msg_rmc || msg_rmc->fields.validity_char != 'A')
 		{
-			mrpt::obs::CObservationGPS::Ptr gps_obs =
-				mrpt::make_aligned_shared<mrpt::obs::CObservationGPS>();
-			gps_obs->sensorLabel = this->m_sensorLabel + std::string("_GPS");
-			gps_obs->sensorPose = m_sensorPose;
-
-			gps_obs->originalReceivedTimestamp = pos_pkt_timestamp;
-
-			bool parsed_ok = CGPSInterface::parse_NMEA(
-				std::string(rx_pos_pkt.NMEA_GPRMC), *gps_obs);
-			const mrpt::obs::gnss::Message_NMEA_RMC* msg_rmc =
-				gps_obs->getMsgByClassPtr<mrpt::obs::gnss::Message_NMEA_RMC>();
-			if (!parsed_ok || !msg_rmc || msg_rmc->fields.validity_char != 'A')
-			{
-				gps_obs->has_satellite_timestamp = false;
-				gps_obs->timestamp = pos_pkt_timestamp;
-			}
-			else
-			{
-				// We have live GPS signal and a recent RMC frame:
-				m_last_gps_rmc_age = pos_pkt_timestamp;
-				m_last_gps_rmc = *msg_rmc;
-			}
-			outGPS = gps_obs;  // save in output object
+			gps_obs->has_satellite_timestamp = false;
+			gps_obs->timestamp = pos_pkt_timestamp;
 		}
-
-		if (data_pkt_timestamp != INVALID_TIMESTAMP)
+		else
 		{
-			m_state = ssWorking;
+			// We have live GPS signal and a recent RMC frame:
+			m_last_gps_rmc_age = pos_pkt_timestamp;
+			m_last_gps_rmc = *msg_rmc;
+		}
+		outGPS = gps_obs;  // save in output object
+	}
 
-			// Break into a new observation object when the azimuth passes
-			// 360->0 deg:
-			const uint16_t rx_pkt_start_angle = rx_pkt.blocks[0].rotation;
-			// const uint16_t rx_pkt_end_angle   =
-			// rx_pkt.blocks[CObservationVelodyneScan::BLOCKS_PER_PACKET-1].rotation;
+	if (data_pkt_timestamp != INVALID_TIMESTAMP)
+	{
+		m_state = ssWorking;
 
-			// Return the observation as done when a complete 360 deg scan is
-			// ready:
-			if (m_rx_scan && !m_rx_scan->scan_packets.empty())
-			{
-				if ((rx_pkt_start_angle <
-					m_rx_scan->scan_packets.rbegin()->blocks[0].rotation) || 
-					!m_return_frames)
-				{
-					outScan = m_rx_scan;
-					m_rx_scan.reset();
-
-					if (m_pcap)
-					{
-						// Keep the reader from blowing through the file.
-						if (!m_pcap_read_fast)
-							std::this_thread::sleep_for(
-								std::chrono::duration<double, std::milli>(
-									m_pcap_read_full_scan_delay_ms));
-					}
-				}
-			}
+		// Break into a new observation object when the azimuth passes
+		// 360->0 deg:
+		const uint16_t rx_pkt_start_angle = rx_pkt.blocks[0].rotation;
+		// const uint16_t rx_pkt_end_angle   =
+		// rx_pkt.blocks[CObservationVelodyneScan::BLOCKS_PER_PACKET-1].rotation;
 
-			// Create smart ptr to new in-progress observation:
-			if (!m_rx_scan)
+		// Return the observation as done when a complete 360 deg scan is
+		// ready:
+		if (m_rx_scan && !m_rx_scan->scan_packets.empty())
+		{
+			if ((rx_pkt_start_angle <
+				m_rx_scan->scan_packets.rbegin()->blocks[0].rotation) || 
+				!m_return_frames)
 			{
-				m_rx_scan = mrpt::make_aligned_shared<
-					mrpt::obs::CObservationVelodyneScan>();
-				m_rx_scan->sensorLabel =
-					this->m_sensorLabel + std::string("_SCAN");
-				m_rx_scan->sensorPose = m_sensorPose;
-				m_rx_scan->calibration =
-					m_velodyne_calib;  // Embed a copy of the calibration info
+				outScan = m_rx_scan;
+				m_rx_scan.reset();
+				m_last_scan_packets = outScan->scan_packets.size();
 
+				if (m_pcap)
 				{
-					const model_properties_list_t& lstModels =
-						TModelPropertiesFactory::get();
-					model_properties_list_t::const_iterator it =
-						lstModels.find(this->m_model);
-					if (it != lstModels.end())
-					{  // Model params:
-						m_rx_scan->maxRange = it->second.maxRange;
-					}
-					else  // default params:
-					{
-						m_rx_scan->maxRange = 120.0;
-					}
+					// Keep the reader from blowing through the file.
+					if (!m_pcap_read_fast)
+						std::this_thread::sleep_for(
+							std::chrono::duration<double, std::milli>(
+								m_pcap_read_full_scan_delay_ms));
 				}
 			}
+		}
+
+		// Create smart ptr to new in-progress observation:
+		if (!m_rx_scan)
+		{
+			m_rx_scan = mrpt::make_aligned_shared<
+				mrpt::obs::CObservationVelodyneScan>();
+			m_rx_scan->sensorLabel =
+				this->m_sensorLabel + std::string("_SCAN");
+			m_rx_scan->sensorPose = m_sensorPose;
+			m_rx_scan->calibration =
+				m_velodyne_calib;  // Embed a copy of the calibration info
+			// Avoid reallocations while accumulating packets:
+			m_rx_scan->scan_packets.reserve(m_last_scan_packets);
 
-			// For the first packet, set timestamp:
-			if (m_rx_scan->scan_packets.empty())
 			{
-				m_rx_scan->originalReceivedTimestamp = data_pkt_timestamp;
-				// Using GPS, if available:
-				if (m_last_gps_rmc.fields.validity_char == 'A' &&
-					mrpt::system::timeDifference(
-						m_last_gps_rmc_age, data_pkt_timestamp) <
-						m_pos_packets_timing_timeout)
-				{
-					// Each Velodyne data packet has a timestamp field,
-					// with the number of us since the top of the current HOUR:
-					// take the date and time from the GPS, then modify minutes
-					// and seconds from data pkt:
-					const mrpt::system::TTimeStamp gps_tim =
-						m_last_gps_rmc.fields.UTCTime.getAsTimestamp(
-							m_last_gps_rmc.getDateAsTimestamp());
-
-					mrpt::system::TTimeParts tim_parts;
-					mrpt::system::timestampToParts(gps_tim, tim_parts);
-					tim_parts.minute =
-						rx_pkt.gps_timestamp /*us from top of hour*/ /
-						60000000ul;
-					tim_parts.second =
-						(rx_pkt.gps_timestamp /*us from top of hour*/ %
-						 60000000ul) *
-						1e-6;
-
-					const mrpt::system::TTimeStamp data_pkt_tim =
-						mrpt::system::buildTimestampFromParts(tim_parts);
-
-					m_rx_scan->timestamp = data_pkt_tim;
-					m_rx_scan->has_satellite_timestamp = true;
+				const model_properties_list_t& lstModels =
+					TModelPropertiesFactory::get();
+				model_properties_list_t::const_iterator it =
+					lstModels.find(this->m_model);
+				if (it != lstModels.end())
+				{  // Model params:
+					m_rx_scan->maxRange = it->second.maxRange;
 				}
-				else
+				else  // default params:
 				{
-					m_rx_scan->has_satellite_timestamp = false;
-					m_rx_scan->timestamp = data_pkt_timestamp;
+					m_rx_scan->maxRange = 120.0;
 				}
 			}
+		}
 
-			// Accumulate pkts in the observation object:
-			m_rx_scan->scan_packets.push_back(rx_pkt);
+		// For the first packet, set timestamp:
+		if (m_rx_scan->scan_packets.empty())
+		{
+			m_rx_scan->originalReceivedTimestamp = data_pkt_timestamp;
+			// Using GPS, if available:
+			if (m_last_gps_rmc.fields.validity_char == 'A' &&
+				mrpt::system::timeDifference(
+					m_last_gps_rmc_age, data_pkt_timestamp) <
+					m_pos_packets_timing_timeout)
+			{
+				// Each Velodyne data packet has a timestamp field,
+				// with the number of us since the top of the current HOUR:
+				// take the date and time from the GPS, then modify minutes
+				// and seconds from data pkt:
+				const mrpt::system::TTimeStamp gps_tim =
+					m_last_gps_rmc.fields.UTCTime.getAsTimestamp(
+						m_last_gps_rmc.getDateAsTimestamp());
+
+				mrpt::system::TTimeParts tim_parts;
+				mrpt::system::timestampToParts(gps_tim, tim_parts);
+				tim_parts.minute =
+					rx_pkt.gps_timestamp /*us from top of hour*/ /
+					60000000ul;
+				tim_parts.second =
+					(rx_pkt.gps_timestamp /*us from top of hour*/ %
+					 60000000ul) *
+					1e-6;
+
+				const mrpt::system::TTimeStamp data_pkt_tim =
+					mrpt::system::buildTimestampFromParts(tim_parts);
+
+				m_rx_scan->timestamp = data_pkt_tim;
+				m_rx_scan->has_satellite_timestamp = true;
+			}
+			else
+			{
+				m_rx_scan->has_satellite_timestamp = false;
+				m_rx_scan->timestamp = data_pkt_timestamp;
+			}
 		}
 
-		return true;
-	}
-	catch (exception& e)
-	{
-		cerr << "[CVelodyneScanner::getObservation] Returning false due to "
-				"exception: "
-			 << endl;
-		cerr << e.what() << endl;
-		return false;
+		// Accumulate pkts in the observation object:
+		m_rx_scan->scan_packets.push_back(rx_pkt);
 	}
 }
 
@@ -556,11 +600,28 @@ void CVelodyneScanner::initialize()
 	m_last_gps_rmc_age = INVALID_TIMESTAMP;
 	m_state = ssInitializing;
 
+	// (3) Optional packet ingest thread:
+	// -----------------------------------
+	if (m_ingest_thread)
+	{
+		ASSERT_(m_ingest_ring_size > 0);
+		m_ring.resize(m_ingest_ring_size);
+		m_ring_read = m_ring_write = m_batch_next = m_batch_end = 0;
+		m_ring_eof = false;
+		m_ring_error.clear();
+		m_ingest_stop = false;
+		m_ingest_thread_handle =
+			std::thread(&CVelodyneScanner::internal_ingest_thread, this);
+	}
+
 	m_initialized = true;
 }
 
 void CVelodyneScanner::close()
 {
+	// Stop the ingest thread before closing the sockets or files it reads:
+	internal_stop_ingest_thread();
+
 	if (m_hDataSock != INVALID_SOCKET)
 	{
 		shutdown(m_hDataSock, 2);  // SD_BOTH  );
@@ -602,6 +663,98 @@ void CVelodyneScanner::close()
 	m_initialized = false;
 }
 
+void CVelodyneScanner::internal_stop_ingest_thread()
+{
+	if (!m_ingest_thread_handle.joinable()) return;
+	{
+		std::lock_guard<std::mutex> lock(m_ring_mtx);
+		m_ingest_stop = true;
+	}
+	m_ring_not_full.notify_all();
+	m_ingest_thread_handle.join();
+	m_ring.clear();
+	m_ring.shrink_to_fit();
+}
+
+void CVelodyneScanner::internal_ingest_thread()
+{
+	try
+	{
+		while (!m_ingest_stop)
+		{
+			// Wait for a free slot, which is owned by this thread until
+			// published:
+			TIngestSlot* slot;
+			{
+				std::unique_lock<std::mutex> lock(m_ring_mtx);
+				m_ring_not_full.wait(lock, [this]() {
+					return m_ingest_stop ||
+						   m_ring_write - m_ring_read < m_ring.size();
+				});
+				if (m_ingest_stop) break;
+				slot = &m_ring[m_ring_write % m_ring.size()];
+			}
+
+			// Receive directly into the ring buffer:
+			const bool rx_all_ok = this->receivePackets(
+				slot->data_pkt_timestamp, slot->data_pkt,
+				slot->pos_pkt_timestamp, slot->pos_pkt);
+			if (rx_all_ok && slot->data_pkt_timestamp == INVALID_TIMESTAMP &&
+				slot->pos_pkt_timestamp == INVALID_TIMESTAMP)
+				continue;  // Timeout, nothing to publish
+
+			{
+				std::lock_guard<std::mutex> lock(m_ring_mtx);
+				if (rx_all_ok)
+					++m_ring_write;
+				else
+					m_ring_eof = true;  // PCAP EOF
+			}
+			m_ring_not_empty.notify_one();
+			if (!rx_all_ok) break;
+		}
+	}
+	catch (std::exception& e)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_ring_mtx);
+			m_ring_error = e.what();
+			m_ring_eof = true;
+		}
+		m_ring_not_empty.notify_one();
+	}
+}
+
+bool CVelodyneScanner::internal_next_ingested_packet(const TIngestSlot*& slot)
+{
+	slot = nullptr;
+	if (m_batch_next == m_batch_end)
+	{
+		// Current batch is done: release its slots and take all the newly
+		// published ones as the next batch.
+		std::unique_lock<std::mutex> lock(m_ring_mtx);
+		if (m_ring_read != m_batch_next)
+		{
+			m_ring_read = m_batch_next;
+			m_ring_not_full.notify_one();
+		}
+		m_ring_not_empty.wait_for(lock, std::chrono::milliseconds(10), [this]() {
+			return m_ring_write != m_ring_read || m_ring_eof;
+		});
+		if (m_ring_write == m_ring_read)
+		{
+			if (!m_ring_eof) return true;  // Timeout, no new data
+			if (!m_ring_error.empty())
+				THROW_EXCEPTION_FMT(
+					"Error in ingest thread: %s", m_ring_error.c_str());
+			return false;
+		}
+		m_batch_end = m_ring_write;
+	}
+	slot = &m_ring[m_batch_next++ % m_ring.size()];
+	return true;
+}
+
 // Fixed Ethernet headers for PCAP capture --------
 #if MRPT_HAS_LIBPCAP
 const uint16_t LidarPacketHeader[21] = {0xffff, 0xffff, 0xffff, 0x7660, 0x0088,
@@ -715,7 +868,7 @@ bool CVelodyneScanner::receivePackets(
 		struct pcap_pkthdr header;
 		struct timeval currentTime;
 		gettimeofday(&currentTime, nullptr);
-		std::vector<unsigned char> packetBuffer;
+		std::vector<unsigned char>& packetBuffer = m_pcap_dump_buffer;
 
 		// Data pkt:
 		if (data_pkt_timestamp != INVALID_TIMESTAMP)
@@ -994,7 +1147,7 @@ bool CVelodyneScanner::internal_read_PCAP_packet(
 				printf(
 					"[CVelodyneScanner] INFO: end of file reached -- done "
 					"reading.\n");
-			std::this_thread::sleep_for(250ms);
+			if (!m_pcap_read_fast) std::this_thread::sleep_for(250ms);
 			return false;
 		}
 
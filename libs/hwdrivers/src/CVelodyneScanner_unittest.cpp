@@ -10,6 +10,16 @@
 #include <mrpt/hwdrivers/CVelodyneScanner.h>
 #include <mrpt/system/filesystem.h>
 #include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
 
 using namespace mrpt;
 using namespace mrpt::hwdrivers;
@@ -24,7 +34,7 @@ extern std::string MRPT_GLOBAL_UNITTEST_SRC_DIR;
 #include <mrpt/config.h>
 #if MRPT_HAS_LIBPCAP
 
-TEST(CVelodyneScanner, sample_vlp16_dataset)
+static void test_vlp16_dataset(bool ingest_thread)
 {
 	const string fil = MRPT_GLOBAL_UNITTEST_SRC_DIR +
 					   string("/tests/sample_velodyne_vlp16_gps.pcap");
@@ -41,6 +51,8 @@ TEST(CVelodyneScanner, sample_vlp16_dataset)
 	velodyne.setModelName(mrpt::hwdrivers::CVelodyneScanner::VLP16);
 	velodyne.setPCAPInputFile(fil);
 	velodyne.setPCAPInputFileReadOnce(true);
+	velodyne.setPCAPInputFileReadFast(ingest_thread);
+	velodyne.setIngestThread(ingest_thread, 64);
 	velodyne.enableVerbose(false);
 	velodyne.setPCAPVerbosity(false);
 
@@ -64,6 +76,12 @@ TEST(CVelodyneScanner, sample_vlp16_dataset)
 	EXPECT_GT(nGPS, 0U);
 }
 
+TEST(CVelodyneScanner, sample_vlp16_dataset) { test_vlp16_dataset(false); }
+TEST(CVelodyneScanner, sample_vlp16_dataset_ingest_thread)
+{
+	test_vlp16_dataset(true);
+}
+
 TEST(CVelodyneScanner, sample_hdl32_dataset)
 {
 	const string fil = MRPT_GLOBAL_UNITTEST_SRC_DIR +
@@ -101,3 +119,79 @@ TEST(CVelodyneScanner, sample_hdl32_dataset)
 }
 
 #endif  // MRPT_HAS_LIBPCAP
+
+#if !defined(_WIN32)
+// Live UDP packets through the ingest thread, sent to the loopback interface:
+TEST(CVelodyneScanner, udp_ingest_thread)
+{
+	using mrpt::obs::CObservationVelodyneScan;
+
+	const short int old_data_port = CVelodyneScanner::VELODYNE_DATA_UDP_PORT;
+	const short int old_pos_port = CVelodyneScanner::VELODYNE_POSITION_UDP_PORT;
+	CVelodyneScanner::VELODYNE_DATA_UDP_PORT = 23680;
+	CVelodyneScanner::VELODYNE_POSITION_UDP_PORT = 23681;
+
+	CVelodyneScanner velodyne;
+	velodyne.setModelName(mrpt::hwdrivers::CVelodyneScanner::HDL32);
+	velodyne.setIngestThread(true, 16);
+	velodyne.enableVerbose(false);
+	velodyne.initialize();
+
+	CVelodyneScanner::VELODYNE_DATA_UDP_PORT = old_data_port;
+	CVelodyneScanner::VELODYNE_POSITION_UDP_PORT = old_pos_port;
+
+	const int sock = socket(PF_INET, SOCK_DGRAM, 0);
+	ASSERT_GE(sock, 0);
+	sockaddr_in dest;
+	memset(&dest, 0, sizeof(dest));
+	dest.sin_family = AF_INET;
+	dest.sin_port = htons(23680);
+	dest.sin_addr.s_addr = inet_addr("127.0.0.1");
+
+	// 3 revolutions, 20 packets each. Only the first 2 are complete scans.
+	const int nPktsPerScan = 20, nScansSent = 3;
+	std::thread sender([&]() {
+		for (int i = 0; i < nPktsPerScan * nScansSent; i++)
+		{
+			CObservationVelodyneScan::TVelodyneRawPacket pkt;
+			memset(&pkt, 0, sizeof(pkt));
+			pkt.gps_timestamp = i;
+			for (int b = 0; b < CObservationVelodyneScan::BLOCKS_PER_PACKET;
+				 b++)
+			{
+				pkt.blocks[b].header = CObservationVelodyneScan::UPPER_BANK;
+				pkt.blocks[b].rotation = static_cast<uint16_t>(
+					((i % nPktsPerScan) * 12 + b) * 150);
+			}
+			sendto(
+				sock, reinterpret_cast<const char*>(&pkt), sizeof(pkt), 0,
+				reinterpret_cast<const sockaddr*>(&dest), sizeof(dest));
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+	});
+
+	std::vector<CObservationVelodyneScan::Ptr> scans;
+	const auto t0 = std::chrono::steady_clock::now();
+	while (scans.size() < 2 &&
+		   std::chrono::steady_clock::now() - t0 < std::chrono::seconds(10))
+	{
+		CObservationVelodyneScan::Ptr scan;
+		mrpt::obs::CObservationGPS::Ptr gps;
+		ASSERT_TRUE(velodyne.getNextObservation(scan, gps));
+		if (scan) scans.push_back(scan);
+	}
+	sender.join();
+	::close(sock);
+	velodyne.close();
+
+	ASSERT_EQ(scans.size(), 2U);
+	for (size_t s = 0; s < scans.size(); s++)
+	{
+		ASSERT_EQ(scans[s]->scan_packets.size(), size_t(nPktsPerScan));
+		for (int i = 0; i < nPktsPerScan; i++)
+			EXPECT_EQ(
+				scans[s]->scan_packets[i].gps_timestamp,
+				uint32_t(s * nPktsPerScan + i));
+	}
+}
+#endif
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <mrpt/io/CStream.h>
+#include <memory>
 
 namespace mrpt::io
 {
@@ -18,7 +19,11 @@ namespace mrpt::io
  *  This class requires compiling MRPT with wxWidgets. If wxWidgets is not
  * available then the class is actually mapped to the standard CFileInputStream
  *
- * \sa CFileInputStream
+ *  Files written by CFileGZOutputStream with parallel compression (a sequence
+ * of independently compressed blocks) are detected when opened, and their
+ * blocks are decompressed in parallel by several threads.
+ *
+ * \sa CFileInputStream, CFileGZOutputStream
  * \ingroup mrpt_io_grp
  */
 class CFileGZInputStream : public CStream
@@ -27,6 +32,9 @@ class CFileGZInputStream : public CStream
 	void* m_f;
 	/** Compressed file size */
 	uint64_t m_file_size;
+	/** The state of the parallel decompression mode (see open()) */
+	struct ParallelImpl;
+	std::unique_ptr<ParallelImpl> m_parallel;
 
    public:
 	/** Constructor without open */
@@ -46,9 +54,13 @@ class CFileGZInputStream : public CStream
 
 	/** Opens the file for read.
 	 * \param fileName The file to be open in this stream
+	 * \param num_threads The number of threads decompressing the data in
+	 * parallel, for files written by CFileGZOutputStream in blocks (other
+	 * files are always decompressed in the calling thread), in the
+	 * mrpt::system::shared_thread_pool(). 0: as many threads as cores.
 	 * \return false if there's an error opening the file, true otherwise
 	 */
-	bool open(const std::string& fileName);
+	bool open(const std::string& fileName, unsigned int num_threads = 0);
 	/** Closes the file */
 	void close();
 	/** Returns true if the file was open without errors. */
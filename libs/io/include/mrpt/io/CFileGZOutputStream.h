@@ -9,6 +9,7 @@
 #pragma once
 
 #include <mrpt/io/CStream.h>
+#include <memory>
 
 namespace mrpt::io
 {
@@ -18,15 +19,27 @@ namespace mrpt::io
  *  This class requires compiling MRPT with wxWidgets. If wxWidgets is not
  * available then the class is actually mapped to the standard CFileOutputStream
  *
- * \sa CFileOutputStream
+ *  Optionally (see open()), the data can be compressed in parallel by several
+ * threads: it is split into blocks of fixed size, each compressed
+ * independently into a gzip member. The result is still a valid gzip file,
+ * which standard tools can decompress, and which CFileGZInputStream
+ * decompresses in parallel.
+ *
+ * \sa CFileOutputStream, CFileGZInputStream
  * \ingroup mrpt_io_grp
  */
 class CFileGZOutputStream : public CStream
 {
    private:
 	void* m_f;
+	/** The state of the parallel compression mode (see open()) */
+	struct ParallelImpl;
+	std::unique_ptr<ParallelImpl> m_parallel;
 
    public:
+	/** The default size of the blocks compressed in parallel (bytes) */
+	static constexpr size_t DEFAULT_BLOCK_SIZE = 1024 * 1024;
+
 	/** Constructor: opens an output file with compression level = 1 (minimum,
 	 * fastest).
 	 * \param fileName The file to be open in this stream
@@ -48,10 +61,19 @@ class CFileGZOutputStream : public CStream
 	/** Open a file for write, choosing the compression level
 	 * \param fileName The file to be open in this stream
 	 * \param compress_level 0:no compression, 1:fastest, 9:best
+	 * \param num_threads The number of threads compressing the data in
+	 * parallel, in blocks of \a block_size bytes, in the
+	 * mrpt::system::shared_thread_pool(). 1: a single gzip stream,
+	 * compressed in the calling thread; 0: as many threads as cores.
+	 * \param block_size The size of the blocks (only if num_threads!=1).
 	 * \return true on success, false on any error.
 	 */
-	bool open(const std::string& fileName, int compress_level = 1);
-	/** Close the file */
+	bool open(
+		const std::string& fileName, int compress_level = 1,
+		unsigned int num_threads = 1,
+		size_t block_size = DEFAULT_BLOCK_SIZE);
+	/** Close the file, after compressing and writing all the pending data
+	 * \exception std::exception On error compressing or writing the data */
 	void close();
 	/** Returns true if the file was open without errors. */
 	bool fileOpenCorrectly() const;
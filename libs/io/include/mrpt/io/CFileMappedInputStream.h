@@ -0,0 +1,120 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/io/CStream.h>
+#include <string>
+
+namespace mrpt::io
+{
+/** A read-only, binary stream over a file mapped into memory.
+ *
+ * The file is not read into user buffers: its pages are read by the OS on
+ * demand and shared among all the processes mapping the same file, which
+ * is convenient for large, read-only data (prebuilt maps, rawlogs) opened by
+ * several processes at once.
+ *
+ * Since the whole file is in memory, mrpt::serialization::CArchive objects
+ * created with archiveFrom() on this stream support
+ * mrpt::serialization::CArchive::ReadBufferNoCopy().
+ *
+ * The file must not be modified or truncated while it is mapped.
+ *
+ * \sa CFileInputStream, CMemoryStream
+ * \note [New in MRPT 2.0.0]
+ * \ingroup mrpt_io_grp
+ */
+class CFileMappedInputStream : public CStream
+{
+   public:
+	/** Expected access pattern to the file data, a hint to the OS on how
+	 * to read ahead and release its pages. Ignored where not supported.
+	 * \sa advise() */
+	enum TAccessHint
+	{
+		/** No special treatment (the default) */
+		ahNormal = 0,
+		/** Data will be read in order: read ahead aggressively and release
+		 * pages soon after they are read (e.g. for rawlogs) */
+		ahSequential,
+		/** Data will be accessed in random order: do not read ahead */
+		ahRandom,
+		/** The whole file will be needed soon: start reading it in
+		 * advance (e.g. for maps) */
+		ahWillNeed
+	};
+
+	/** Constructor
+	 * \param fileName The file to be open in this stream
+	 * \param hint The expected access pattern, see advise()
+	 * \exception std::exception On error trying to open the file.
+	 */
+	CFileMappedInputStream(
+		const std::string& fileName, TAccessHint hint = ahNormal);
+	/** Default constructor */
+	CFileMappedInputStream() = default;
+
+	CFileMappedInputStream(const CFileMappedInputStream&) = delete;
+	CFileMappedInputStream& operator=(const CFileMappedInputStream&) = delete;
+
+	virtual ~CFileMappedInputStream();
+
+	/** Maps a file for reading. Empty files can be open, but have no data.
+	 * \param fileName The file to be open in this stream
+	 * \param hint The expected access pattern, see advise()
+	 * \return true on success.
+	 */
+	bool open(const std::string& fileName, TAccessHint hint = ahNormal);
+	/** Unmaps the file and closes the stream */
+	void close();
+	/** Returns true if the file was open without errors. */
+	bool fileOpenCorrectly() const { return m_open; }
+	/** Returns true if the file was open without errors. */
+	bool is_open() const { return m_open; }
+	/** Will be true if the read position is at the end of the file. */
+	bool checkEOF() const { return m_position >= m_size; }
+
+	/** Tells the OS the expected access pattern to the file from now on.
+	 * \return false if the hint could not be applied (e.g. not supported by
+	 * the OS), which is not an error. */
+	bool advise(TAccessHint hint);
+
+	/** The whole contents of the file, valid while it remains open.
+	 * \sa size() */
+	const void* data() const { return m_data; }
+	/** The length of the file, in bytes. \sa data() */
+	size_t size() const { return m_size; }
+
+	size_t Read(void* Buffer, size_t Count) override;
+	size_t Write(const void* Buffer, size_t Count) override;
+	/** Returns a pointer to the next \a Count bytes of the file and moves the
+	 * read position past them, without copying them, or nullptr (without
+	 * moving the position) if there are less than \a Count bytes left.
+	 * \sa mrpt::serialization::CArchive::ReadBufferNoCopy */
+	const void* ReadNoCopy(size_t Count);
+
+	// See docs in base class
+	uint64_t Seek(
+		int64_t off, CStream::TSeekOrigin Origin = sFromBeginning) override;
+	// See docs in base class
+	uint64_t getTotalBytesCount() const override { return m_size; }
+	// See docs in base class
+	uint64_t getPosition() const override { return m_position; }
+
+   private:
+	const char* m_data{nullptr};
+	size_t m_size{0};
+	size_t m_position{0};
+	bool m_open{false};
+#ifdef _WIN32
+	/** The HANDLE of the file mapping object */
+	void* m_mapping{nullptr};
+#endif
+};  // End of class def.
+}
@@ -28,6 +28,12 @@ class CMemoryStream : public CStream
    public:
 	size_t Read(void* Buffer, size_t Count) override;
 	size_t Write(const void* Buffer, size_t Count) override;
+	/** Returns a pointer to the next \a Count bytes in the buffer and moves
+	 * the read position past them, without copying them, or nullptr (without
+	 * moving the position) if there are less than \a Count bytes left.
+	 * The pointer is valid until the buffer is modified.
+	 * \sa mrpt::serialization::CArchive::ReadBufferNoCopy */
+	const void* ReadNoCopy(size_t Count);
 
    protected:
 	/** Internal data */
@@ -90,7 +96,9 @@ class CMemoryStream : public CStream
 	bool loadBufferFromFile(const std::string& file_name);
 
 	/** Change the size of the additional memory block that is reserved whenever
-	 * the current block runs too short (default=0x10000 bytes) */
+	 * the current block runs too short (default=0x1000 bytes). The buffer
+	 * grows by at least its current size, too, so that writing large amounts
+	 * of data takes linear time. */
 	void setAllocBlockSize(uint64_t alloc_block_size)
 	{
 		ASSERT_(alloc_block_size > 0);
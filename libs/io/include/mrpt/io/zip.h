@@ -67,6 +67,12 @@ void decompress(
 bool decompress_gz_file(
 	const std::string& file_path, std::vector<uint8_t>& buffer);
 
+/** Returns true if the file starts with the gzip magic number, false if it
+ * does not, or on error opening it.
+ * \sa decompress_gz_file
+ */
+bool is_gz_file(const std::string& file_path);
+
 /** Compress a memory buffer into a gzip file (xxxx.gz).
   *  compress_level: 0=no compression, 1=best speed, 9=maximum
   * \return true on success, false on error.
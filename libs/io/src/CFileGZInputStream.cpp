@@ -10,10 +10,16 @@
 #include "io-precomp.h"  // Precompiled headers
 
 #include <mrpt/io/CFileGZInputStream.h>
+#include <mrpt/io/CFileInputStream.h>
 #include <mrpt/system/filesystem.h>
 #include <mrpt/core/exceptions.h>
+#include <mrpt/system/thread_pool.h>
+#include "gz_blocks.h"
 
 #include <zlib.h>
+#include <algorithm>
+#include <cstring>
+#include <deque>
 
 using namespace mrpt::io;
 using namespace std;
@@ -25,6 +31,71 @@ static_assert(
 
 #define THE_GZFILE reinterpret_cast<gzFile>(m_f)
 
+struct CFileGZInputStream::ParallelImpl
+{
+	CFileInputStream f;
+	unsigned int num_threads{1};
+	uint64_t file_size{0};
+	/** File offset of the next gzip member to read */
+	uint64_t next_member{0};
+	/** The blocks being decompressed, in order, with the file offset of the
+	 * end of their gzip member */
+	std::deque<std::pair<uint64_t, std::future<std::vector<uint8_t>>>>
+		pending;
+	/** The block being read, and the read position within it */
+	std::vector<uint8_t> current;
+	size_t current_pos{0};
+	/** Uncompressed offset of the start of the current block */
+	uint64_t current_base{0};
+
+	/** Reads gzip members and starts decompressing them, up to one per
+	 * thread */
+	void readMembers()
+	{
+		using namespace mrpt::io::internal;
+		while (pending.size() < num_threads && next_member < file_size)
+		{
+			uint8_t hdr[GZ_BLOCK_HEADER_SIZE];
+			uint32_t size = 0;
+			if (f.Read(hdr, sizeof(hdr)) != sizeof(hdr) ||
+				!gz_parse_block_header(hdr, size) ||
+				next_member + size > file_size)
+				THROW_EXCEPTION("Corrupted or truncated gzip block");
+
+			std::vector<uint8_t> member(size);
+			std::memcpy(member.data(), hdr, sizeof(hdr));
+			const size_t rest = size - sizeof(hdr);
+			if (f.Read(member.data() + sizeof(hdr), rest) != rest)
+				THROW_EXCEPTION("Truncated gzip block");
+			next_member += size;
+
+			pending.emplace_back(
+				next_member,
+				mrpt::system::shared_thread_pool().enqueue(
+					[m = std::move(member)]() {
+						return gz_decompress_block(m);
+					}));
+		}
+	}
+	/** Moves to the next block. \return false at the end of the file */
+	bool nextBlock()
+	{
+		readMembers();
+		if (pending.empty()) return false;
+		current_base += current.size();
+		current = pending.front().second.get();
+		current_pos = 0;
+		pending.pop_front();
+		readMembers();
+		return true;
+	}
+	bool eof() const
+	{
+		return current_pos == current.size() && pending.empty() &&
+			   next_member >= file_size;
+	}
+};
+
 CFileGZInputStream::CFileGZInputStream(const string& fileName) : m_f(nullptr)
 {
 	MRPT_START
@@ -33,17 +104,39 @@ CFileGZInputStream::CFileGZInputStream(const string& fileName) : m_f(nullptr)
 }
 
 CFileGZInputStream::CFileGZInputStream() : m_f(nullptr) {}
-bool CFileGZInputStream::open(const std::string& fileName)
+bool CFileGZInputStream::open(
+	const std::string& fileName, unsigned int num_threads)
 {
 	MRPT_START
 
-	if (m_f) gzclose(THE_GZFILE);
+	close();
 
 	// Get compressed file size:
 	m_file_size = mrpt::system::getFileSize(fileName);
 	if (m_file_size == uint64_t(-1))
 		THROW_EXCEPTION_FMT("Couldn't access the file '%s'", fileName.c_str());
 
+	// Blocks are decompressed in the shared thread pool. Not from one of its
+	// workers, which would wait for tasks queued behind it:
+	auto& pool = mrpt::system::shared_thread_pool();
+	if (num_threads == 0) num_threads = pool.size();
+	if (num_threads > 1 && !pool.isWorkerThread())
+	{
+		// Written in blocks by CFileGZOutputStream?
+		auto p = std::make_unique<ParallelImpl>();
+		uint8_t hdr[internal::GZ_BLOCK_HEADER_SIZE];
+		uint32_t size;
+		if (p->f.open(fileName) && p->f.Read(hdr, sizeof(hdr)) == sizeof(hdr) &&
+			internal::gz_parse_block_header(hdr, size))
+		{
+			p->f.Seek(0);
+			p->num_threads = num_threads;
+			p->file_size = m_file_size;
+			m_parallel = std::move(p);
+			return true;
+		}
+	}
+
 	// Open gz stream:
 	m_f = gzopen(fileName.c_str(), "rb");
 	return m_f != nullptr;
@@ -58,11 +151,28 @@ void CFileGZInputStream::close()
 		gzclose(THE_GZFILE);
 		m_f = nullptr;
 	}
+	m_parallel.reset();
 }
 
 CFileGZInputStream::~CFileGZInputStream() { close(); }
 size_t CFileGZInputStream::Read(void* Buffer, size_t Count)
 {
+	if (m_parallel)
+	{
+		auto& p = *m_parallel;
+		auto* out = static_cast<uint8_t*>(Buffer);
+		size_t nRead = 0;
+		while (nRead < Count)
+		{
+			if (p.current_pos == p.current.size() && !p.nextBlock()) break;
+			const size_t n =
+				std::min(Count - nRead, p.current.size() - p.current_pos);
+			std::memcpy(out + nRead, p.current.data() + p.current_pos, n);
+			p.current_pos += n;
+			nRead += n;
+		}
+		return nRead;
+	}
 	if (!m_f)
 	{
 		THROW_EXCEPTION("File is not open.");
@@ -80,25 +190,34 @@ size_t CFileGZInputStream::Write(const void* Buffer, size_t Count)
 
 uint64_t CFileGZInputStream::getTotalBytesCount() const
 {
-	if (!m_f)
+	if (!m_f && !m_parallel)
 	{
 		THROW_EXCEPTION("File is not open.");
 	}
+
 	return m_file_size;
 }
 
 uint64_t CFileGZInputStream::getPosition() const
 {
+	if (m_parallel)
+		return m_parallel->current_base + m_parallel->current_pos;
 	if (!m_f)
 	{
 		THROW_EXCEPTION("File is not open.");
 	}
+
 	return gztell(THE_GZFILE);
 }
 
-bool CFileGZInputStream::fileOpenCorrectly() const { return m_f != nullptr; }
+bool CFileGZInputStream::fileOpenCorrectly() const
+{
+	return m_f != nullptr || m_parallel != nullptr;
+}
+
 bool CFileGZInputStream::checkEOF()
 {
+	if (m_parallel) return m_parallel->eof();
 	if (!m_f)
 		return true;
 	else
@@ -10,16 +10,67 @@
 #include "io-precomp.h"  // Precompiled headers
 
 #include <mrpt/io/CFileGZOutputStream.h>
+#include <mrpt/io/CFileOutputStream.h>
 #include <mrpt/core/exceptions.h>
+#include <mrpt/system/thread_pool.h>
+#include "gz_blocks.h"
 
 #include <zlib.h>
+#include <algorithm>
+#include <deque>
+#include <iostream>
 
 #define THE_GZFILE reinterpret_cast<gzFile>(m_f)
 
 using namespace mrpt::io;
 using namespace std;
 
-CFileGZOutputStream::CFileGZOutputStream(const string& fileName) : m_f(nullptr)
+struct CFileGZOutputStream::ParallelImpl
+{
+	CFileOutputStream f;
+	int level{1};
+	unsigned int num_threads{1};
+	size_t block_size{DEFAULT_BLOCK_SIZE};
+	/** The data not compressed yet */
+	std::vector<uint8_t> block;
+	/** The blocks being compressed, in order */
+	std::deque<std::future<std::vector<uint8_t>>> pending;
+	/** Uncompressed bytes written so far */
+	uint64_t position{0};
+	bool anyBlock{false};
+
+	/** Starts compressing the current block */
+	void submitBlock()
+	{
+		// Bound the memory in use, waiting for the oldest block:
+		if (pending.size() >= num_threads) writeOldestBlock();
+		pending.emplace_back(
+			mrpt::system::shared_thread_pool().enqueue(
+				[data = std::move(block), lvl = level]() {
+					return internal::gz_compress_block(
+						data.data(), data.size(), lvl);
+				}));
+		block = std::vector<uint8_t>();
+		block.reserve(block_size);
+		anyBlock = true;
+	}
+	void writeOldestBlock()
+	{
+		const auto member = pending.front().get();
+		pending.pop_front();
+		f.Write(member.data(), member.size());
+	}
+	/** Compresses and writes all the pending data */
+	void flush()
+	{
+		// An empty file must still be a valid gzip file:
+		if (!block.empty() || !anyBlock) submitBlock();
+		while (!pending.empty()) writeOldestBlock();
+	}
+};
+
+CFileGZOutputStream::CFileGZOutputStream(const string& fileName)
+	: m_f(nullptr)
 {
 	MRPT_START
 	if (!open(fileName))
@@ -29,20 +80,53 @@ CFileGZOutputStream::CFileGZOutputStream(const string& fileName) : m_f(nullptr)
 }
 
 CFileGZOutputStream::CFileGZOutputStream() : m_f(nullptr) {}
-bool CFileGZOutputStream::open(const string& fileName, int compress_level)
+bool CFileGZOutputStream::open(
+	const string& fileName, int compress_level, unsigned int num_threads,
+	size_t block_size)
 {
 	MRPT_START
 
-	if (m_f) gzclose(THE_GZFILE);
+	close();
+
+	// Blocks are compressed in the shared thread pool. Not from one of its
+	// workers, which would wait for tasks queued behind it:
+	auto& pool = mrpt::system::shared_thread_pool();
+	if (num_threads == 0) num_threads = pool.size();
+	if (num_threads == 1 || pool.isWorkerThread())
+	{
+		// Open gz stream:
+		m_f = gzopen(
+			fileName.c_str(), format("wb%i", compress_level).c_str());
+		return m_f != nullptr;
+	}
 
-	// Open gz stream:
-	m_f = gzopen(fileName.c_str(), format("wb%i", compress_level).c_str());
-	return m_f != nullptr;
+	// Parallel compression, in blocks:
+	ASSERT_(block_size > 0);
+	auto p = std::make_unique<ParallelImpl>();
+	if (!p->f.open(fileName)) return false;
+	p->level = compress_level;
+	p->num_threads = num_threads;
+	p->block_size = block_size;
+	p->block.reserve(block_size);
+	m_parallel = std::move(p);
+	return true;
 
 	MRPT_END
 }
 
-CFileGZOutputStream::~CFileGZOutputStream() { close(); }
+CFileGZOutputStream::~CFileGZOutputStream()
+{
+	try
+	{
+		close();
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << "[~CFileGZOutputStream] Error closing the file:\n"
+				  << e.what() << std::endl;
+	}
+}
+
 void CFileGZOutputStream::close()
 {
 	if (m_f)
@@ -50,6 +134,13 @@ void CFileGZOutputStream::close()
 		gzclose(THE_GZFILE);
 		m_f = nullptr;
 	}
+	if (m_parallel)
+	{
+		// Released even if writing the pending data fails:
+		auto p = std::move(m_parallel);
+		p->flush();
+		p->f.close();
+	}
 }
 
 size_t CFileGZOutputStream::Read(void*, size_t)
@@ -59,6 +150,22 @@ size_t CFileGZOutputStream::Read(void*, size_t)
 
 size_t CFileGZOutputStream::Write(const void* Buffer, size_t Count)
 {
+	if (m_parallel)
+	{
+		auto& p = *m_parallel;
+		const auto* data = static_cast<const uint8_t*>(Buffer);
+		for (size_t remaining = Count; remaining;)
+		{
+			const size_t n =
+				std::min(remaining, p.block_size - p.block.size());
+			p.block.insert(p.block.end(), data, data + n);
+			data += n;
+			remaining -= n;
+			if (p.block.size() == p.block_size) p.submitBlock();
+		}
+		p.position += Count;
+		return Count;
+	}
 	if (!m_f)
 	{
 		THROW_EXCEPTION("File is not open.");
@@ -68,6 +175,7 @@ size_t CFileGZOutputStream::Write(const void* Buffer, size_t Count)
 
 uint64_t CFileGZOutputStream::getPosition() const
 {
+	if (m_parallel) return m_parallel->position;
 	if (!m_f)
 	{
 		THROW_EXCEPTION("File is not open.");
@@ -75,7 +183,11 @@ uint64_t CFileGZOutputStream::getPosition() const
 	return gztell(THE_GZFILE);
 }
 
-bool CFileGZOutputStream::fileOpenCorrectly() const { return m_f != nullptr; }
+bool CFileGZOutputStream::fileOpenCorrectly() const
+{
+	return m_f != nullptr || m_parallel != nullptr;
+}
+
 uint64_t CFileGZOutputStream::Seek(int64_t, CStream::TSeekOrigin)
 {
 	THROW_EXCEPTION("Method not available in this class.");
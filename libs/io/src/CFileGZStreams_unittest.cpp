@@ -0,0 +1,109 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/io/CFileGZInputStream.h>
+#include <mrpt/io/CFileGZOutputStream.h>
+#include <mrpt/io/CFileOutputStream.h>
+#include <mrpt/io/vector_loadsave.h>
+#include <mrpt/io/zip.h>
+#include <mrpt/system/filesystem.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::io;
+using namespace std;
+
+static std::vector<uint8_t> testData(const size_t N)
+{
+	// Low entropy, for compression to have something to do:
+	std::vector<uint8_t> data(N);
+	for (size_t i = 0; i < N; i++)
+		data[i] = static_cast<uint8_t>((i * i) >> 7);
+	return data;
+}
+
+static void writeGZ(
+	const std::string& fil, const std::vector<uint8_t>& data,
+	const unsigned int num_threads, const size_t block_size)
+{
+	CFileGZOutputStream f;
+	ASSERT_TRUE(f.open(fil, 1, num_threads, block_size));
+	// Writes of assorted sizes, smaller and larger than the blocks:
+	size_t pos = 0;
+	for (size_t n = 1; pos < data.size(); n = (n * 7) % 5003 + 1)
+	{
+		n = std::min(n, data.size() - pos);
+		EXPECT_EQ(f.Write(data.data() + pos, n), n);
+		pos += n;
+	}
+	EXPECT_EQ(f.getPosition(), data.size());
+}
+
+static std::vector<uint8_t> readGZ(
+	const std::string& fil, const unsigned int num_threads)
+{
+	CFileGZInputStream f;
+	EXPECT_TRUE(f.open(fil, num_threads));
+	std::vector<uint8_t> data;
+	uint8_t buf[3001];
+	for (;;)
+	{
+		// Uncompressed position:
+		EXPECT_EQ(f.getPosition(), data.size());
+		const size_t n = f.Read(buf, sizeof(buf));
+		if (!n) break;
+		data.insert(data.end(), buf, buf + n);
+	}
+	EXPECT_TRUE(f.checkEOF());
+	return data;
+}
+
+TEST(CFileGZStreams, parallelRoundTrip)
+{
+	const auto data = testData(100000);
+	const std::string fil = mrpt::system::getTempFileName();
+
+	// Blocked file, read in parallel, and as a plain gzip file:
+	writeGZ(fil, data, 4, 4096);
+	EXPECT_TRUE(readGZ(fil, 3) == data);
+	EXPECT_TRUE(readGZ(fil, 1) == data);
+	std::vector<uint8_t> unzipped;
+	ASSERT_TRUE(mrpt::io::zip::decompress_gz_file(fil, unzipped));
+	EXPECT_TRUE(unzipped == data);
+
+	// A plain gzip file is read in the calling thread:
+	writeGZ(fil, data, 1, 0);
+	EXPECT_TRUE(readGZ(fil, 4) == data);
+
+	// Empty files:
+	writeGZ(fil, {}, 2, 100);
+	EXPECT_TRUE(readGZ(fil, 2).empty());
+	EXPECT_TRUE(readGZ(fil, 1).empty());
+
+	mrpt::system::deleteFile(fil);
+}
+
+TEST(CFileGZStreams, parallelCorruptedFile)
+{
+	const auto data = testData(20000);
+	const std::string fil = mrpt::system::getTempFileName();
+	writeGZ(fil, data, 2, 1000);
+
+	// Flip one byte in the compressed data of some block:
+	std::vector<uint8_t> buf;
+	ASSERT_TRUE(mrpt::io::loadBinaryFile(buf, fil));
+	buf[buf.size() / 2] ^= 0x55;
+	{
+		CFileOutputStream f(fil);
+		f.Write(buf.data(), buf.size());
+	}
+	EXPECT_THROW(readGZ(fil, 2), std::exception);
+
+	mrpt::system::deleteFile(fil);
+}
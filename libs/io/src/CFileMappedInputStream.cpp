@@ -0,0 +1,216 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "io-precomp.h"  // Precompiled headers
+
+#include <mrpt/io/CFileMappedInputStream.h>
+#include <mrpt/core/exceptions.h>
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace mrpt::io;
+
+static_assert(
+	!std::is_copy_constructible<CFileMappedInputStream>::value &&
+		!std::is_copy_assignable<CFileMappedInputStream>::value,
+	"Copy Check");
+
+CFileMappedInputStream::CFileMappedInputStream(
+	const std::string& fileName, TAccessHint hint)
+{
+	MRPT_START
+
+	if (!open(fileName, hint))
+		THROW_EXCEPTION_FMT(
+			"Error trying to open file: '%s'", fileName.c_str());
+
+	MRPT_END
+}
+
+CFileMappedInputStream::~CFileMappedInputStream() { close(); }
+bool CFileMappedInputStream::open(const std::string& fileName, TAccessHint hint)
+{
+	close();
+
+#ifdef _WIN32
+	HANDLE hFile = CreateFileA(
+		fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(hFile, &fileSize))
+	{
+		CloseHandle(hFile);
+		return false;
+	}
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+
+	// Empty files cannot be mapped, but are valid (empty) streams:
+	if (m_size)
+	{
+		m_mapping =
+			CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_mapping)
+			m_data = static_cast<const char*>(
+				MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	}
+	// The mapping keeps its own reference to the file:
+	CloseHandle(hFile);
+	if (m_size && !m_data)
+	{
+		if (m_mapping) CloseHandle(m_mapping);
+		m_mapping = nullptr;
+		m_size = 0;
+		return false;
+	}
+#else
+	const int fd = ::open(fileName.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat st;
+	if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+	{
+		::close(fd);
+		return false;
+	}
+	m_size = static_cast<size_t>(st.st_size);
+
+	// Empty files cannot be mapped, but are valid (empty) streams:
+	if (m_size)
+	{
+		void* p = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (p != MAP_FAILED) m_data = static_cast<const char*>(p);
+	}
+	// The mapping keeps its own reference to the file:
+	::close(fd);
+	if (m_size && !m_data)
+	{
+		m_size = 0;
+		return false;
+	}
+#endif
+
+	m_position = 0;
+	m_open = true;
+	if (hint != ahNormal) advise(hint);
+	return true;
+}
+
+void CFileMappedInputStream::close()
+{
+	if (!m_open) return;
+#ifdef _WIN32
+	if (m_data) UnmapViewOfFile(m_data);
+	if (m_mapping) CloseHandle(m_mapping);
+	m_mapping = nullptr;
+#else
+	if (m_data) ::munmap(const_cast<char*>(m_data), m_size);
+#endif
+	m_data = nullptr;
+	m_size = 0;
+	m_position = 0;
+	m_open = false;
+}
+
+bool CFileMappedInputStream::advise(TAccessHint hint)
+{
+	if (!m_data) return false;
+#ifdef _WIN32
+	// Windows has no per-mapping access pattern hints, except prefetching:
+	if (hint != ahWillNeed) return false;
+#if _WIN32_WINNT >= 0x0602  // Windows 8
+	WIN32_MEMORY_RANGE_ENTRY range;
+	range.VirtualAddress = const_cast<char*>(m_data);
+	range.NumberOfBytes = m_size;
+	return PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0) != 0;
+#else
+	return false;
+#endif
+#else
+	int advice = MADV_NORMAL;
+	switch (hint)
+	{
+		case ahNormal:
+			advice = MADV_NORMAL;
+			break;
+		case ahSequential:
+			advice = MADV_SEQUENTIAL;
+			break;
+		case ahRandom:
+			advice = MADV_RANDOM;
+			break;
+		case ahWillNeed:
+			advice = MADV_WILLNEED;
+			break;
+		default:
+			THROW_EXCEPTION("Invalid value for 'hint'");
+	}
+	return ::madvise(const_cast<char*>(m_data), m_size, advice) == 0;
+#endif
+}
+
+size_t CFileMappedInputStream::Read(void* Buffer, size_t Count)
+{
+	if (m_position >= m_size) return 0;
+	const size_t nToRead = std::min(Count, m_size - m_position);
+	::memcpy(Buffer, m_data + m_position, nToRead);
+	m_position += nToRead;
+	return nToRead;
+}
+
+const void* CFileMappedInputStream::ReadNoCopy(size_t Count)
+{
+	if (m_position > m_size || m_size - m_position < Count) return nullptr;
+	const void* data = m_data + m_position;
+	m_position += Count;
+	return data;
+}
+
+size_t CFileMappedInputStream::Write(const void* Buffer, size_t Count)
+{
+	MRPT_UNUSED_PARAM(Buffer);
+	MRPT_UNUSED_PARAM(Count);
+	THROW_EXCEPTION("Trying to write to a read file stream.");
+}
+
+uint64_t CFileMappedInputStream::Seek(
+	int64_t Offset, CStream::TSeekOrigin Origin)
+{
+	int64_t newPos = 0;
+	switch (Origin)
+	{
+		case sFromBeginning:
+			newPos = Offset;
+			break;
+		case sFromCurrent:
+			newPos = static_cast<int64_t>(m_position) + Offset;
+			break;
+		case sFromEnd:
+			newPos = static_cast<int64_t>(m_size) + Offset;
+			break;
+		default:
+			THROW_EXCEPTION("Invalid value for 'Origin'");
+	}
+	// Clamp to the file limits:
+	if (newPos < 0) newPos = 0;
+	if (static_cast<uint64_t>(newPos) > m_size) newPos = m_size;
+	m_position = static_cast<size_t>(newPos);
+	return m_position;
+}
@@ -0,0 +1,76 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/io/CFileMappedInputStream.h>
+#include <mrpt/io/vector_loadsave.h>
+#include <mrpt/system/filesystem.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt::io;
+
+TEST(CFileMappedInputStream, readSeek)
+{
+	const std::string fil = mrpt::system::getTempFileName();
+	std::vector<uint8_t> data(100000);
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = static_cast<uint8_t>(i * 7);
+	ASSERT_TRUE(vectorToBinaryFile(data, fil));
+	{
+		CFileMappedInputStream f(fil, CFileMappedInputStream::ahSequential);
+		EXPECT_TRUE(f.is_open());
+		EXPECT_EQ(f.getTotalBytesCount(), data.size());
+		EXPECT_TRUE(f.advise(CFileMappedInputStream::ahRandom));
+
+		uint8_t buf[1000];
+		EXPECT_EQ(f.Read(buf, sizeof(buf)), sizeof(buf));
+		EXPECT_TRUE(std::equal(buf, buf + sizeof(buf), data.begin()));
+
+		// Zero-copy reads point into the mapped file:
+		const auto* p = static_cast<const uint8_t*>(f.ReadNoCopy(10));
+		ASSERT_TRUE(p != nullptr);
+		EXPECT_EQ(p, static_cast<const uint8_t*>(f.data()) + 1000);
+		EXPECT_EQ(p[5], data[1005]);
+		EXPECT_TRUE(f.ReadNoCopy(data.size()) == nullptr);
+		EXPECT_EQ(f.getPosition(), 1010U);
+
+		// Reads past the end are truncated:
+		EXPECT_EQ(f.Seek(-10, CStream::sFromEnd), data.size() - 10);
+		EXPECT_EQ(f.Read(buf, sizeof(buf)), 10U);
+		EXPECT_EQ(buf[9], data.back());
+		EXPECT_TRUE(f.checkEOF());
+		EXPECT_EQ(f.Read(buf, sizeof(buf)), 0U);
+
+		EXPECT_EQ(f.Seek(20), 20U);
+		EXPECT_EQ(f.Seek(5, CStream::sFromCurrent), 25U);
+		EXPECT_EQ(f.Read(buf, 1), 1U);
+		EXPECT_EQ(buf[0], data[25]);
+		EXPECT_THROW(f.Write(buf, 1), std::exception);
+	}
+	mrpt::system::deleteFile(fil);
+}
+
+TEST(CFileMappedInputStream, emptyAndMissingFiles)
+{
+	const std::string fil = mrpt::system::getTempFileName();
+	ASSERT_TRUE(vectorToBinaryFile(std::vector<uint8_t>(), fil));
+	{
+		CFileMappedInputStream f;
+		EXPECT_TRUE(f.open(fil));
+		EXPECT_EQ(f.getTotalBytesCount(), 0U);
+		uint8_t b;
+		EXPECT_EQ(f.Read(&b, 1), 0U);
+		EXPECT_TRUE(f.ReadNoCopy(1) == nullptr);
+	}
+	mrpt::system::deleteFile(fil);
+
+	CFileMappedInputStream f;
+	EXPECT_FALSE(f.open(fil));
+	EXPECT_FALSE(f.is_open());
+	EXPECT_THROW(CFileMappedInputStream f2(fil), std::exception);
+}
@@ -95,6 +95,14 @@ size_t CMemoryStream::Read(void* Buffer, size_t Count)
 	return nToRead;
 }
 
+const void* CMemoryStream::ReadNoCopy(size_t Count)
+{
+	if (m_position > m_size || m_size - m_position < Count) return nullptr;
+	const void* data = ((char*)m_memory.get()) + m_position;
+	m_position += Count;
+	return data;
+}
+
 size_t CMemoryStream::Write(const void* Buffer, size_t Count)
 {
 	// Enought space in current bufer?
@@ -102,8 +110,9 @@ size_t CMemoryStream::Write(const void* Buffer, size_t Count)
 
 	if (requiredSize >= m_size)
 	{
-		// Incrent the size of reserved memory:
-		resize(requiredSize + m_alloc_block_size);
+		// Incrent the size of reserved memory, geometrically to avoid
+		// reallocating (and copying) the whole buffer once per block:
+		resize(std::max(requiredSize + m_alloc_block_size, 2 * m_size));
 	}
 
 	// Copy the memory block:
@@ -0,0 +1,121 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "io-precomp.h"  // Precompiled headers
+
+#include "gz_blocks.h"
+#include <mrpt/core/exceptions.h>
+#include <limits>
+#include <zlib.h>
+
+using namespace mrpt::io::internal;
+
+static constexpr size_t GZ_BLOCK_TRAILER_SIZE = 8;
+
+static void put_u16(uint8_t* p, const uint16_t v)
+{
+	p[0] = static_cast<uint8_t>(v);
+	p[1] = static_cast<uint8_t>(v >> 8);
+}
+static void put_u32(uint8_t* p, const uint32_t v)
+{
+	for (int i = 0; i < 4; i++) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+static uint32_t get_u32(const uint8_t* p)
+{
+	return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) |
+		   (uint32_t(p[3]) << 24);
+}
+
+std::vector<uint8_t> mrpt::io::internal::gz_compress_block(
+	const uint8_t* data, const size_t len, const int level)
+{
+	ASSERT_(len <= std::numeric_limits<uInt>::max() / 2);
+
+	z_stream strm{};
+	// Raw deflate (no zlib/gzip wrapper): the gzip member is built by hand
+	if (deflateInit2(
+			&strm, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) !=
+		Z_OK)
+		THROW_EXCEPTION("deflateInit2() failed");
+
+	std::vector<uint8_t> out(
+		GZ_BLOCK_HEADER_SIZE + deflateBound(&strm, len) +
+		GZ_BLOCK_TRAILER_SIZE);
+	strm.next_in = const_cast<Bytef*>(data);
+	strm.avail_in = static_cast<uInt>(len);
+	strm.next_out = out.data() + GZ_BLOCK_HEADER_SIZE;
+	strm.avail_out = static_cast<uInt>(
+		out.size() - GZ_BLOCK_HEADER_SIZE - GZ_BLOCK_TRAILER_SIZE);
+	const int ret = deflate(&strm, Z_FINISH);
+	const size_t compressedLen = strm.total_out;
+	deflateEnd(&strm);
+	if (ret != Z_STREAM_END) THROW_EXCEPTION("deflate() failed");
+
+	const size_t memberSize =
+		GZ_BLOCK_HEADER_SIZE + compressedLen + GZ_BLOCK_TRAILER_SIZE;
+	out.resize(memberSize);
+
+	uint8_t* h = out.data();
+	h[0] = 0x1f;  // ID1, ID2
+	h[1] = 0x8b;
+	h[2] = 8;  // CM: deflate
+	h[3] = 0x04;  // FLG: FEXTRA
+	put_u32(h + 4, 0);  // MTIME
+	h[8] = 0;  // XFL
+	h[9] = 255;  // OS: unknown
+	put_u16(h + 10, 8);  // XLEN
+	h[12] = 'M';  // Subfield ID
+	h[13] = 'P';
+	put_u16(h + 14, 4);  // Subfield LEN
+	put_u32(h + 16, static_cast<uint32_t>(memberSize));
+
+	uint8_t* t = out.data() + memberSize - GZ_BLOCK_TRAILER_SIZE;
+	put_u32(t, crc32(crc32(0L, Z_NULL, 0), data, static_cast<uInt>(len)));
+	put_u32(t + 4, static_cast<uint32_t>(len));
+	return out;
+}
+
+bool mrpt::io::internal::gz_parse_block_header(
+	const uint8_t* hdr, uint32_t& memberSize)
+{
+	if (hdr[0] != 0x1f || hdr[1] != 0x8b || hdr[2] != 8 || hdr[3] != 0x04 ||
+		hdr[10] != 8 || hdr[11] != 0 || hdr[12] != 'M' || hdr[13] != 'P' ||
+		hdr[14] != 4 || hdr[15] != 0)
+		return false;
+	memberSize = get_u32(hdr + 16);
+	return memberSize >= GZ_BLOCK_HEADER_SIZE + GZ_BLOCK_TRAILER_SIZE;
+}
+
+std::vector<uint8_t> mrpt::io::internal::gz_decompress_block(
+	const std::vector<uint8_t>& member)
+{
+	ASSERT_(member.size() >= GZ_BLOCK_HEADER_SIZE + GZ_BLOCK_TRAILER_SIZE);
+	const uint8_t* t = member.data() + member.size() - GZ_BLOCK_TRAILER_SIZE;
+	const uint32_t crc = get_u32(t), len = get_u32(t + 4);
+
+	std::vector<uint8_t> out(len);
+	uint8_t dummy;  // inflate() needs an output buffer, even if empty
+	z_stream strm{};
+	if (inflateInit2(&strm, -MAX_WBITS) != Z_OK)
+		THROW_EXCEPTION("inflateInit2() failed");
+	strm.next_in = const_cast<Bytef*>(member.data() + GZ_BLOCK_HEADER_SIZE);
+	strm.avail_in = static_cast<uInt>(
+		member.size() - GZ_BLOCK_HEADER_SIZE - GZ_BLOCK_TRAILER_SIZE);
+	strm.next_out = len ? out.data() : &dummy;
+	strm.avail_out = len;
+	const int ret = inflate(&strm, Z_FINISH);
+	const size_t outLen = strm.total_out;
+	inflateEnd(&strm);
+	if (ret != Z_STREAM_END || outLen != len)
+		THROW_EXCEPTION("Corrupted gzip block: error decompressing it");
+	if (crc32(crc32(0L, Z_NULL, 0), out.data(), len) != crc)
+		THROW_EXCEPTION("Corrupted gzip block: CRC mismatch");
+	return out;
+}
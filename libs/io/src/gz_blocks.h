@@ -0,0 +1,44 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Blocked gzip files, as written by CFileGZOutputStream in parallel mode: a
+// sequence of independent gzip members (RFC 1952), each with the compressed
+// data of one block. Standard gzip tools decompress the concatenated members
+// as a single stream. Each member header has an extra field (subfield 'M','P')
+// with the total size of the member, so readers can find the members without
+// decompressing them:
+//  - ID1 ID2 CM FLG(FEXTRA) MTIME(4) XFL OS  (10 bytes)
+//  - XLEN=8 (2), 'M' 'P' LEN=4 (4), member size (uint32)  (10 bytes)
+//  - raw deflate data
+//  - CRC32 (uint32), ISIZE (uint32)
+// All integers are little-endian.
+namespace mrpt::io::internal
+{
+/** Size of the header of each gzip member of a blocked file (bytes) */
+constexpr size_t GZ_BLOCK_HEADER_SIZE = 20;
+
+/** Compresses a block of data into a gzip member */
+std::vector<uint8_t> gz_compress_block(
+	const uint8_t* data, const size_t len, const int level);
+
+/** Checks whether \a hdr (GZ_BLOCK_HEADER_SIZE bytes) is the header of a
+ * member of a blocked gzip file, and if so, returns the size of the whole
+ * member (bytes) in \a memberSize. */
+bool gz_parse_block_header(const uint8_t* hdr, uint32_t& memberSize);
+
+/** Decompresses a whole gzip member of a blocked file, checking its CRC.
+ * \exception std::exception On corrupted data. */
+std::vector<uint8_t> gz_decompress_block(const std::vector<uint8_t>& member);
+
+}  // namespace mrpt::io::internal
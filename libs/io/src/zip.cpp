@@ -231,6 +231,14 @@ bool mrpt::io::zip::decompress_gz_file(
 	return true;
 }
 
+bool mrpt::io::zip::is_gz_file(const std::string& file_path)
+{
+	CFileInputStream f;
+	uint8_t magic[2];
+	return f.open(file_path) && f.Read(magic, sizeof(magic)) == sizeof(magic) &&
+		   magic[0] == 0x1f && magic[1] == 0x8b;
+}
+
 bool mrpt::io::zip::compress_gz_file(
 	const std::string& file_path, const std::vector<uint8_t>& buffer,
 	const int compress_level)
@@ -28,9 +28,11 @@ MRPT_WARNING(
 #include <mrpt/maps/CHeightGridMap2D_MRF.h>
 #include <mrpt/maps/CReflectivityGridMap2D.h>
 #include <mrpt/maps/COccupancyGridMap2D.h>
+#include <mrpt/maps/CTiledOccupancyGridMap2D.h>
 #include <mrpt/maps/CPointsMap.h>
 #include <mrpt/maps/CSimplePointsMap.h>
 #include <mrpt/maps/CWeightedPointsMap.h>
+#include <mrpt/maps/CVoxelPointsMap.h>
 #include <mrpt/maps/COctoMap.h>
 #include <mrpt/maps/CColouredOctoMap.h>
 
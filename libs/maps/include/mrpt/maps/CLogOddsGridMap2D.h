@@ -10,7 +10,11 @@
 #ifndef CLogOddsGridMap2D_H
 #define CLogOddsGridMap2D_H
 
+#include <mrpt/core/round.h>
+#include <algorithm>
 #include <cstdint>
+#include <cstdlib>
+#include <limits>
 #include <vector>
 
 namespace mrpt
@@ -141,6 +145,72 @@ struct CLogOddsGridMap2D : public detail::logoddscell_traits<TCELL>
 			*theCell = traits_t::CELLTYPE_MAX;
 	}
 
+	/** Traces a ray from the cell (cx0,cy0) towards (trg_cx,trg_cy), calling
+	 * \a visit(cx,cy) for each traversed cell, excluding the target one.
+	 *
+	 * Only the cells in rows [band_cy0,band_cy1] are visited, and the part of
+	 * the ray out of them is not even traced, so several threads can insert
+	 * the same rays into disjoint bands of rows at the cost of one.
+	 */
+	template <class FUNCTOR>
+	inline static void traceRay(
+		const int cx0, const int cy0, const int trg_cx, const int trg_cy,
+		FUNCTOR&& visit, const int band_cy0 = std::numeric_limits<int>::min(),
+		const int band_cy1 = std::numeric_limits<int>::max())
+	{
+		// Use "fractional integers" to approximate float operations during
+		// the ray tracing, relative to the starting cell:
+		constexpr int FRBITS = 9;
+		const int Acx = trg_cx - cx0;
+		const int Acy = trg_cy - cy0;
+		const int Acx_ = std::abs(Acx);
+		const int Acy_ = std::abs(Acy);
+
+		const int nStepsRay = std::max(Acx_, Acy_);
+		if (!nStepsRay) return;  // May be...
+
+		const float N_1 = 1.0f / nStepsRay;  // Avoid division twice.
+
+		// Increments at each raytracing step:
+		const int frAcx =
+			(Acx < 0 ? -1 : +1) * mrpt::round((Acx_ << FRBITS) * N_1);
+		const int frAcy =
+			(Acy < 0 ? -1 : +1) * mrpt::round((Acy_ << FRBITS) * N_1);
+
+		// At step n, cy = cy0 + (n*frAcy >> FRBITS), monotonic in n: find the
+		// range of steps [n0,n1) within the band.
+		const int64_t lo = (int64_t(band_cy0) - cy0) * (1 << FRBITS);
+		const int64_t hi = (int64_t(band_cy1) + 1 - cy0) * (1 << FRBITS) - 1;
+		auto floor_div = [](const int64_t a, const int64_t b) {
+			return a / b - ((a % b != 0) && ((a < 0) != (b < 0)) ? 1 : 0);
+		};
+		auto ceil_div = [&](const int64_t a, const int64_t b) {
+			return -floor_div(-a, b);
+		};
+		int64_t n0 = 0, n1 = nStepsRay;
+		if (frAcy > 0)
+		{
+			n0 = std::max(n0, ceil_div(lo, frAcy));
+			n1 = std::min(n1, floor_div(hi, frAcy) + 1);
+		}
+		else if (frAcy < 0)
+		{
+			n0 = std::max(n0, ceil_div(hi, frAcy));
+			n1 = std::min(n1, floor_div(lo, frAcy) + 1);
+		}
+		else if (lo > 0 || hi < 0)
+			return;
+
+		int frCX = static_cast<int>(n0) * frAcx;
+		int frCY = static_cast<int>(n0) * frAcy;
+		for (int64_t nStep = n0; nStep < n1; nStep++)
+		{
+			visit(cx0 + (frCX >> FRBITS), cy0 + (frCY >> FRBITS));
+			frCX += frAcx;
+			frCY += frAcy;
+		}
+	}
+
 };  // end of CLogOddsGridMap2D
 
 /** One static instance of this struct should exist in any class implementing
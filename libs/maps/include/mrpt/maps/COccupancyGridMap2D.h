@@ -21,6 +21,8 @@
 #include <mrpt/obs/CObservation2DRangeScanWithUncertainty.h>
 #include <mrpt/obs/obs_frwds.h>
 #include <mrpt/typemeta/TEnumType.h>
+#include <array>
+#include <memory>
 
 #include <mrpt/config.h>
 #if (                                                \
@@ -66,6 +68,7 @@ class COccupancyGridMap2D : public CMetricMap,
 #endif
 {
 	DEFINE_SERIALIZABLE(COccupancyGridMap2D)
+	friend class CTiledOccupancyGridMap2D;
    public:
 /** The type of the map cells: */
 #ifdef OCCUPANCY_GRIDMAP_CELL_SIZE_8BITS
@@ -107,11 +110,36 @@ class COccupancyGridMap2D : public CMetricMap,
 	/** Cell size, i.e. resolution of the grid map. */
 	float resolution;
 
-	/** Auxiliary variables to speed up the computation of observation
-	 * likelihood values for LF method among others, at a high cost in memory
-	 * (see TLikelihoodOptions::enableLikelihoodCache). */
-	std::vector<double> precomputedLikelihood;
-	bool precomputedLikelihoodToBeRecomputed;
+	/** Dense table with the log-likelihood of each cell for the
+	 * likelihood-field model, with the same layout as "map", to speed up the
+	 * computation of observation likelihood values for the LF method at a
+	 * cost in memory (see TLikelihoodOptions::enableLikelihoodCache).
+	 * \sa updateLikelihoodField */
+	std::vector<float> m_likelihoodField;
+	/** Whether m_likelihoodField must be entirely rebuilt before its next use
+	 */
+	bool m_likelihoodFieldToBeRecomputed{true};
+	/** Copy of the likelihoodOptions LF_* values m_likelihoodField was built
+	 * with, to detect changes in the parameters. */
+	std::array<float, 6> m_likelihoodFieldParams{};
+	/** Bounding box of the cells modified since m_likelihoodField was last
+	 * updated, as cell indices {x0,x1,y0,y1} (empty if x0>x1).
+	 * \sa invalidateLikelihoodFieldRegion */
+	std::array<int, 4> m_likelihoodFieldDirty{{0, -1, 0, -1}};
+
+	/** Max-pooled occupancy pyramid (see getResolutionPyramidLevel()): level
+	 * h holds, for each cell (x,y), the maximum occupancy (in 0-255 units) of
+	 * the cells in [x,x+2^h)x[y,y+2^h), with the same layout as "map". */
+	mutable std::vector<std::vector<uint8_t>> m_resolutionPyramid;
+	/** Whether m_resolutionPyramid must be entirely rebuilt before its next
+	 * use */
+	mutable bool m_resolutionPyramidToBeRecomputed{true};
+	/** Bounding box of the cells modified since m_resolutionPyramid was last
+	 * updated, as in m_likelihoodFieldDirty */
+	mutable std::array<int, 4> m_resolutionPyramidDirty{{0, -1, 0, -1}};
+	/** Brings up to date the first \a nLevels levels of the resolution
+	 * pyramid, creating them if needed */
+	void updateResolutionPyramid(unsigned int nLevels) const;
 
 	/** Used for Voronoi calculation.Same struct as "map", but contains a "0" if
 	 * not a basis point. */
@@ -545,12 +573,39 @@ class COccupancyGridMap2D : public CMetricMap,
 		/** Enabled: Rays widen with distance to approximate the real behavior
 		 * of lasers, disabled: insert rays as simple lines (Default=false) */
 		bool wideningBeamsWithDistance;
+		/** Number of threads used to insert 2D scans as simple rays
+		 * (wideningBeamsWithDistance=false): each one updates a horizontal
+		 * band of the grid. Results are identical to the single-threaded
+		 * insertion. (Default=1: single thread, 0: all cores)
+		 * Not serialized with the map. */
+		unsigned int numThreads;
+
+		/** Binary dump to stream - for usage in other classes' serialization
+		 */
+		void writeToStream(mrpt::serialization::CArchive& out) const;
+		/** Binary dump to stream - for usage in other classes' serialization
+		 */
+		void readFromStream(mrpt::serialization::CArchive& in);
 	};
 
 	/** With this struct options are provided to the observation insertion
 	 * process \sa CObservation::insertIntoGridMap */
 	TInsertionOptions insertionOptions;
 
+	/** The log-odds updates of the cells observed as free or occupied, and
+	 * their saturation limits, for some given insertion options.
+	 * \sa updateCell_fast_free, updateCell_fast_occupied, traceRay */
+	struct TInsertionLogOdds
+	{
+		explicit TInsertionLogOdds(const TInsertionOptions& opts);
+		/** Update of cells traversed by a ray with / without echo */
+		cellType observation_free, noecho_free;
+		/** Update of the cell at the end of a ray with echo */
+		cellType observation_occupied;
+		/** Saturation limits, for updateCell_fast_*() */
+		cellType thres_occupied, thres_free;
+	};
+
 	/** The type for selecting a likelihood computation method */
 	enum TLikelihoodMethod
 	{
@@ -641,9 +696,24 @@ class COccupancyGridMap2D : public CMetricMap,
 		 * fuse. */
 		std::vector<float> OWA_weights;
 
-		/** Enables the usage of a cache of likelihood values (for LF methods),
-		 * if set to true (default=false). */
+		/** Enables the usage of a precomputed table of likelihood values (for
+		 * the lmLikelihoodField_Thrun method), if set to true (default=true).
+		 * \sa updateLikelihoodField() */
 		bool enableLikelihoodCache;
+
+		/** If set to true (default=false), the precomputed table of
+		 * likelihood values is saved along with the map when it is up to
+		 * date (4 more bytes per cell), so it does not have to be rebuilt
+		 * after loading the map. Otherwise, it is rebuilt on its first use.
+		 */
+		bool serializeLikelihoodCache{false};
+
+		/** Binary dump to stream - for usage in other classes' serialization
+		 */
+		void writeToStream(mrpt::serialization::CArchive& out) const;
+		/** Binary dump to stream - for usage in other classes' serialization
+		 */
+		void readFromStream(mrpt::serialization::CArchive& in);
 	} likelihoodOptions;
 
 	/** Auxiliary private class. */
@@ -961,6 +1031,85 @@ class COccupancyGridMap2D : public CMetricMap,
 		const CPointsMap* pm,
 		const mrpt::poses::CPose2D* relativePose = nullptr);
 
+	/** Batched version of computeLikelihoodField_Thrun(): computes the
+	 * log-likelihood of the same set of points seen from many poses at once.
+	 * Points are transformed in groups of 4 with SSE2 (if available), and
+	 * the likelihood of each cell is read from a dense table (see
+	 * updateLikelihoodField()) instead of searching the nearest obstacle for
+	 * each point.
+	 * Results match those of computeLikelihoodField_Thrun() up to float
+	 * rounding.
+	 * \param pm The points map, in local coordinates.
+	 * \param poses The candidate poses of the points map in this map's
+	 * coordinates.
+	 * \param out_log_liks Output: one log-likelihood per pose.
+	 * \sa computeObservationLikelihoodBatch
+	 */
+	void computeLikelihoodField_Thrun_batch(
+		const CPointsMap* pm, const std::vector<mrpt::math::TPose2D>& poses,
+		std::vector<double>& out_log_liks);
+
+	/** Computes the likelihood of one observation for many candidate robot
+	 * poses, as computeObservationLikelihood() would do for each one.
+	 * For the lmLikelihoodField_Thrun method and 2D range scans, the batched
+	 * kernel computeLikelihoodField_Thrun_batch() is used; other methods or
+	 * observation types are evaluated one pose at a time.
+	 * \sa computeLikelihoodField_Thrun_batch
+	 */
+	void computeObservationLikelihoodBatch(
+		const mrpt::obs::CObservation* obs,
+		const std::vector<mrpt::math::TPose2D>& poses,
+		std::vector<double>& out_log_liks);
+
+	/** Brings up to date the dense likelihood-field table used by
+	 * computeLikelihoodField_Thrun() and the batched methods.
+	 * The distance from each cell to its closest obstacle is obtained with a
+	 * linear-time Euclidean distance transform. The whole table is built if
+	 * the grid was resized or the LF_* likelihood options changed; otherwise,
+	 * only the neighbourhood of the cells modified since the last call (see
+	 * invalidateLikelihoodFieldRegion()) is recomputed.
+	 * It is invoked automatically, but can be called in advance to avoid the
+	 * delay in the first evaluation, or before serializing the map to save
+	 * the table with it (see TLikelihoodOptions::serializeLikelihoodCache).
+	 */
+	void updateLikelihoodField();
+
+	/** Marks the rectangle [x0,x1]x[y0,y1] (in meters) as modified, so the
+	 * likelihood field (and the resolution pyramid, if used) is recomputed
+	 * around it in the next call to updateLikelihoodField(). This is done
+	 * automatically by insertObservation(), but must be called by the user
+	 * after changing cells with setCell() or updateCell() if the
+	 * likelihood-field model or the resolution pyramid are used.
+	 */
+	void invalidateLikelihoodFieldRegion(
+		float x0, float x1, float y0, float y1);
+
+	/** Returns one level of a max-pooled, multi-resolution occupancy pyramid
+	 * of the grid, for coarse-to-fine searches (e.g.
+	 * mrpt::slam::CBranchAndBoundScanMatcher).
+	 * Level h has the same size and layout than the grid (see getRow()), and
+	 * each of its elements (x,y) is the maximum occupancy probability, as
+	 * 255*(1-getCell()), of the cells in [x,x+2^h)x[y,y+2^h). Level 0 is the
+	 * occupancy of each cell.
+	 *
+	 * The pyramid is optional: its levels are only created (up to the
+	 * requested one) the first time they are needed. From then on, only the
+	 * areas modified by new observations (see
+	 * invalidateLikelihoodFieldRegion()) are recomputed on each call.
+	 * \sa getResolutionPyramidLevels, clearResolutionPyramid
+	 */
+	const std::vector<uint8_t>& getResolutionPyramidLevel(
+		unsigned int level) const;
+	/** Number of levels of the resolution pyramid currently maintained (0 if
+	 * it was never used) \sa getResolutionPyramidLevel */
+	unsigned int getResolutionPyramidLevels() const
+	{
+		return static_cast<unsigned int>(m_resolutionPyramid.size());
+	}
+	/** Frees the memory of the resolution pyramid, which will be rebuilt on
+	 * its next use. \sa getResolutionPyramidLevel */
+	void clearResolutionPyramid();
+
 	/** Saves the gridmap as a graphical file (BMP,PNG,...).
 	 * The format will be derived from the file extension (see
 	 * CImage::saveToFile )
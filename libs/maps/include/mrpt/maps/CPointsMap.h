@@ -604,7 +604,7 @@ class CPointsMap : public CMetricMap,
 	inline void insertPoint(float x, float y, float z = 0)
 	{
 		insertPointFast(x, y, z);
-		mark_as_modified();
+		mark_as_appended();
 	}
 	/// \overload
 	inline void insertPoint(const mrpt::math::TPoint3D& p)
@@ -910,6 +910,36 @@ class CPointsMap : public CMetricMap,
 		pMax.z = dmy6;
 	}
 
+	/** Local surface geometry around each point of the map, see
+	 * getLocalGeometry() */
+	struct TLocalGeometry
+	{
+		/** Number of nearest neighbors used in the estimation */
+		size_t knn{0};
+		/** Unit normal of the plane fitted to the neighbors of each point
+		 * (the direction of least variance). Its sign is arbitrary. */
+		std::vector<mrpt::math::TPoint3Df> normals;
+		/** Covariance of each point as modeled in Generalized-ICP: a unit
+		 * variance along the local plane and a variance of
+		 * \a planeEpsilon across it. */
+		mrpt::aligned_std_vector<mrpt::math::CMatrixFixedNumeric<float, 3, 3>>
+			covariances;
+		/** The variance across the local planes in \a covariances */
+		static constexpr float planeEpsilon = 1e-3f;
+		/** Incremented each time the geometry is estimated, so callers can
+		 * tell whether the cached one was reused */
+		uint64_t updateCount{0};
+	};
+
+	/** Returns the normal and the covariance of each point, estimated from
+	 * its \a knn nearest neighbors in 3D (including itself).
+	 * Results are cached until the map is modified or a different \a knn is
+	 * requested, so aligning many scans against the same reference map only
+	 * pays this cost once.
+	 * \sa mrpt::slam::CICP (icpPointToPlane, icpGeneralized)
+	 */
+	const TLocalGeometry& getLocalGeometry(size_t knn = 10) const;
+
 	/** Extracts the points in the map within a cylinder in 3D defined the
 	 * provided radius and zmin/zmax values.
 	 */
@@ -1086,9 +1116,31 @@ class CPointsMap : public CMetricMap,
 	{
 		m_largestDistanceFromOriginIsUpdated = false;
 		m_boundingBoxIsUpdated = false;
+		m_localGeometryIsUpdated = false;
 		kdtree_mark_as_outdated();
 	}
 
+	/** Like mark_as_modified(), for changes which only append new points at
+	 * the end of the map: an existing kd-tree is kept and the new points will
+	 * be added to it on the next query (see mrpt::math::KDTreeCapable). */
+	inline void mark_as_appended() const
+	{
+		m_largestDistanceFromOriginIsUpdated = false;
+		m_boundingBoxIsUpdated = false;
+		m_localGeometryIsUpdated = false;
+	}
+
+	/** Like mark_as_modified(), for changes which only remove some points,
+	 * given the sorted indices they had: only the parts of the kd-tree with
+	 * removed points are rebuilt (see mrpt::math::KDTreeCapable). */
+	inline void mark_as_removed(const std::vector<size_t>& removedIdxs) const
+	{
+		m_largestDistanceFromOriginIsUpdated = false;
+		m_boundingBoxIsUpdated = false;
+		m_localGeometryIsUpdated = false;
+		kdtree_mark_as_removed(removedIdxs);
+	}
+
    protected:
 	/** The point coordinates */
 	mrpt::aligned_std_vector<float> m_x, m_y, m_z;
@@ -1110,6 +1162,10 @@ class CPointsMap : public CMetricMap,
 	mutable float m_bb_min_x, m_bb_max_x, m_bb_min_y, m_bb_max_y, m_bb_min_z,
 		m_bb_max_z;
 
+	/** Cache of getLocalGeometry() */
+	mutable TLocalGeometry m_localGeometry;
+	mutable bool m_localGeometryIsUpdated{false};
+
 	/** This is a common version of CMetricMap::insertObservation() for point
 	 * maps (actually, CMetricMap::internal_insertObservation),
 	 *   so derived classes don't need to worry implementing that method unless
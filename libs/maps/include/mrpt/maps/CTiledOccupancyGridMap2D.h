@@ -0,0 +1,283 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/serialization/CSerializable.h>
+#include <mrpt/maps/CMetricMap.h>
+#include <mrpt/maps/COccupancyGridMap2D.h>
+#include <mrpt/img/CImage.h>
+#include <mrpt/obs/obs_frwds.h>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace mrpt::maps
+{
+/** A 2D occupancy grid map stored as a sparse set of fixed-size square tiles,
+ * for maps covering very large areas (several km^2) which are mostly unknown.
+ *
+ * Cells use the same log-odds representation than COccupancyGridMap2D, but
+ * tiles of TILE_SIZE x TILE_SIZE cells are only allocated when one of their
+ * cells is first modified; reading a cell in a non-existing tile returns the
+ * "unknown" value (p=0.5). Hence, the map has no fixed bounds and growing it
+ * has a constant cost, without reallocating or copying existing cells.
+ * Cell indices are global and signed: cell (cx,cy) covers the area
+ * [cx*res,(cx+1)*res) x [cy*res,(cy+1)*res).
+ *
+ * Tiles which have not been accessed for a while can be compressed in memory
+ * with compressColdTiles(); they are transparently decompressed on the next
+ * access.
+ *
+ * Supported operations, with the same options and algorithms than
+ * COccupancyGridMap2D:
+ *  - Insertion of mrpt::obs::CObservation2DRangeScan observations, as simple
+ * rays (see COccupancyGridMap2D::TInsertionOptions; beam widening is not
+ * supported).
+ *  - Observation likelihood with the lmLikelihoodField_Thrun method (see
+ * COccupancyGridMap2D::TLikelihoodOptions). The likelihood field is cached
+ * per tile, and only the tiles around new observations are invalidated.
+ * Cells far from all the allocated tiles have the constant likelihood of a
+ * cell far from any obstacle, which is not stored.
+ *  - Laser scan simulation (laserScanSimulator()).
+ *  - Export as an image (getAsImage()), or to/from a dense
+ * COccupancyGridMap2D (getAsDenseGrid(), loadFromDenseGrid()) to use any
+ * other algorithm on a given area.
+ *
+ * \note Even const methods may decompress tiles or fill caches, so this
+ * class is not safe to be used from several threads at once.
+ * \sa COccupancyGridMap2D
+ * \ingroup mrpt_maps_grp
+ */
+class CTiledOccupancyGridMap2D : public CMetricMap
+{
+	DEFINE_SERIALIZABLE(CTiledOccupancyGridMap2D)
+
+   public:
+	using cellType = COccupancyGridMap2D::cellType;
+
+	/** Each tile has 2^TILE_BITS x 2^TILE_BITS cells */
+	static constexpr int TILE_BITS = 7;
+	static constexpr int TILE_SIZE = 1 << TILE_BITS;
+
+	/** Constructor, with the size of each cell (in meters) */
+	CTiledOccupancyGridMap2D(float resolution = 0.05f);
+
+	/** Returns the resolution of the grid map */
+	inline float getResolution() const { return m_resolution; }
+	/** Changes the resolution of the grid map, clearing all its contents */
+	void setResolution(float resolution);
+
+	/** Transform a coordinate value into a (global) cell index */
+	inline int x2idx(double x) const
+	{
+		return static_cast<int>(std::floor(x / m_resolution));
+	}
+	inline int y2idx(double y) const
+	{
+		return static_cast<int>(std::floor(y / m_resolution));
+	}
+	/** Transform a (global) cell index into the coordinate of its center */
+	inline double idx2x(int cx) const { return (cx + 0.5) * m_resolution; }
+	inline double idx2y(int cy) const { return (cy + 0.5) * m_resolution; }
+
+	/** Read the log-odds value of a cell (the "unknown" value if the cell
+	 * does not exist yet) */
+	cellType getCellLogOdds(int cx, int cy) const;
+	/** Read the occupancy probability of a cell (0.5 if it does not exist) */
+	inline float getCell(int cx, int cy) const
+	{
+		return COccupancyGridMap2D::l2p(getCellLogOdds(cx, cy));
+	}
+	/** Read the occupancy probability of the cell at a given position */
+	inline float getPos(double x, double y) const
+	{
+		return getCell(x2idx(x), y2idx(y));
+	}
+	/** Changes the occupancy probability of a cell, creating its tile if
+	 * needed */
+	void setCell(int cx, int cy, float value);
+
+	/** Number of allocated tiles (compressed or not) */
+	size_t getTileCount() const { return m_tiles.size(); }
+	/** Number of allocated tiles currently compressed */
+	size_t getCompressedTileCount() const;
+	/** Approximate memory used by the tiles, in bytes */
+	size_t getMemoryUsage() const;
+
+	/** Gets the bounding box of all the allocated tiles, in cell indices
+	 * (inclusive). Returns false if the map is empty. */
+	bool getBoundingBox(int& cx0, int& cx1, int& cy0, int& cy1) const;
+
+	/** Compresses in memory all the tiles which have not been accessed in the
+	 * last \a maxAge insertions or likelihood evaluations (0: compress all
+	 * the tiles). The cached likelihood field of those tiles is also
+	 * released. \return The number of newly compressed tiles. */
+	size_t compressColdTiles(unsigned int maxAge);
+
+	/** Returns the map contained in the bounding box of all the tiles (see
+	 * getBoundingBox()) as a 8-bit gray-level image, where each pixel is a
+	 * cell (output image is RGB only if forceRGB is true). \sa
+	 * COccupancyGridMap2D::getAsImage */
+	void getAsImage(
+		mrpt::img::CImage& img, bool verticalFlip = false,
+		bool forceRGB = false) const;
+
+	/** Copies the cells in the bounding box of all the tiles into a dense
+	 * occupancy grid, with the same options. */
+	void getAsDenseGrid(COccupancyGridMap2D& out) const;
+	/** Copies the cells in the given rectangle (in cell indices, inclusive)
+	 * into a dense occupancy grid, with the same options. */
+	void getAsDenseGrid(
+		COccupancyGridMap2D& out, int cx0, int cx1, int cy0, int cy1) const;
+	/** Replaces the contents of this map with those of a dense occupancy
+	 * grid (resolution and options included). Tiles with only unknown cells
+	 * are not created. */
+	void loadFromDenseGrid(const COccupancyGridMap2D& grid);
+
+	/** Simulates a laser range scan into the current grid map, as
+	 * COccupancyGridMap2D::laserScanSimulator() does.
+	 * \param inout_Scan [IN/OUT] Must be filled with the "aperture",
+	 * "maxRange", "rightToLeft" and "sensorPose" fields of the sensor.
+	 * \param robotPose [IN] The robot pose in this map.
+	 * \param threshold [IN] The minimum occupancy threshold to consider a
+	 * cell to be occupied (Default: 0.6f)
+	 * \param N [IN] The count of range scan "rays", by default to 361.
+	 * \param noiseStd [IN] The standard deviation of measurement noise.
+	 * \param decimation [IN] The rays that will be simulated are at indexes:
+	 * 0, D, 2D, 3D, ... Default is D=1
+	 * \param angleNoiseStd [IN] The sigma of an optional Gaussian noise added
+	 * to the angles at which ranges are measured (in radians).
+	 */
+	void laserScanSimulator(
+		mrpt::obs::CObservation2DRangeScan& inout_Scan,
+		const mrpt::poses::CPose2D& robotPose, float threshold = 0.6f,
+		size_t N = 361, float noiseStd = 0, unsigned int decimation = 1,
+		float angleNoiseStd = mrpt::DEG2RAD(.0f)) const;
+
+	/** Simulates the observation of a single ray, see
+	 * COccupancyGridMap2D::simulateScanRay() */
+	void simulateScanRay(
+		const double x, const double y, const double angle_direction,
+		float& out_range, bool& out_valid, const double max_range_meters,
+		const float threshold_free = 0.4f, const double noiseStd = .0,
+		const double angleNoiseStd = .0) const;
+
+	/** Computes the likelihood of a set of points (in local coordinates,
+	 * seen from \a relativePose) with the lmLikelihoodField_Thrun model.
+	 * \sa COccupancyGridMap2D::computeLikelihoodField_Thrun */
+	double computeLikelihoodField_Thrun(
+		const CPointsMap* pm, const mrpt::poses::CPose2D& relativePose);
+
+	/** Returns true if the map is empty (no tiles) */
+	bool isEmpty() const override;
+
+	/** Options for inserting observations (the same than for
+	 * COccupancyGridMap2D) */
+	COccupancyGridMap2D::TInsertionOptions insertionOptions;
+
+	/** Options for computing observation likelihoods (the same than for
+	 * COccupancyGridMap2D; only lmLikelihoodField_Thrun is supported) */
+	COccupancyGridMap2D::TLikelihoodOptions likelihoodOptions;
+
+	/** See docs in base class: in this class this always returns 0 */
+	float compute3DMatchingRatio(
+		const mrpt::maps::CMetricMap* otherMap,
+		const mrpt::poses::CPose3D& otherMapPose,
+		const TMatchingRatioParams& params) const override;
+
+	void saveMetricMapRepresentationToFile(
+		const std::string& filNamePrefix) const override;
+
+	void getAs3DObject(mrpt::opengl::CSetOfObjects::Ptr& outObj) const override;
+
+   protected:
+	struct TTile
+	{
+		/** The cells, row by row (empty if compressed) */
+		std::vector<cellType> cells;
+		/** The cells, compressed (empty if not compressed) */
+		std::vector<uint8_t> compressed;
+		/** Cached log-likelihood of each cell (empty if not computed) */
+		std::vector<float> logLik;
+		/** Value of m_accessCounter when the tile was last used */
+		uint64_t lastAccess{0};
+	};
+
+	/** Tiles, indexed by tileKey() */
+	mutable std::unordered_map<uint64_t, TTile> m_tiles;
+	float m_resolution;
+	/** Incremented on each insertion or likelihood evaluation */
+	uint64_t m_accessCounter{0};
+	/** Parameters of the cached likelihood field (see
+	 * COccupancyGridMap2D::updateLikelihoodField) */
+	std::array<float, 6> m_likelihoodFieldParams{};
+	/** Log-likelihood of cells far from any obstacle, for the parameters in
+	 * m_likelihoodFieldParams */
+	float m_farLogLikelihood{0};
+	/** Cached log-likelihood field of non-existing tiles near existing ones,
+	 * indexed by tileKey() */
+	std::unordered_map<uint64_t, std::vector<float>> m_missingTilesLogLik;
+
+	static inline uint64_t tileKey(int tx, int ty)
+	{
+		return (static_cast<uint64_t>(static_cast<uint32_t>(tx)) << 32) |
+			   static_cast<uint32_t>(ty);
+	}
+	static inline int tileKeyX(uint64_t key)
+	{
+		return static_cast<int32_t>(key >> 32);
+	}
+	static inline int tileKeyY(uint64_t key)
+	{
+		return static_cast<int32_t>(key & 0xFFFFFFFF);
+	}
+
+	/** Returns the cells of a tile, decompressing it if needed, or nullptr
+	 * if it does not exist and \a create is false. */
+	cellType* getTileCells(int tx, int ty, bool create) const;
+	/** Decompresses the tile, if it was compressed */
+	void decompressTile(TTile& tile) const;
+	/** Copies the log-odds of the cells in [cx0,cx0+w)x[cy0,cy0+h) into the
+	 * buffer \a out, with \a stride elements per row. */
+	void copyCells(
+		int cx0, int cy0, int w, int h, cellType* out, size_t stride) const;
+	/** Drops the cached likelihood field of the tiles overlapping the
+	 * given rectangle (in cell indices) grown by the likelihood-field
+	 * window */
+	void invalidateLikelihoodField(int cx0, int cx1, int cy0, int cy1);
+	/** Log-likelihood of a cell, from the per-tile cache */
+	float cellLogLikelihood(int cx, int cy);
+	/** Computes the likelihood field of all the cells of a tile */
+	void computeTileLikelihoodField(int tx, int ty, std::vector<float>& logLik);
+	/** Whether there is any existing tile with cells within the
+	 * likelihood-field window of the given (non-existing) tile */
+	bool hasTilesAround(int tx, int ty) const;
+
+	// See docs in base class
+	void internal_clear() override;
+	bool internal_insertObservation(
+		const mrpt::obs::CObservation* obs,
+		const mrpt::poses::CPose3D* robotPose = nullptr) override;
+	double internal_computeObservationLikelihood(
+		const mrpt::obs::CObservation* obs,
+		const mrpt::poses::CPose3D& takenFrom) override;
+	bool internal_canComputeObservationLikelihood(
+		const mrpt::obs::CObservation* obs) const override;
+
+	MAP_DEFINITION_START(CTiledOccupancyGridMap2D)
+	/** The resolution of the map */
+	float resolution;
+	mrpt::maps::COccupancyGridMap2D::TInsertionOptions insertionOpts;
+	mrpt::maps::COccupancyGridMap2D::TLikelihoodOptions likelihoodOpts;
+	MAP_DEFINITION_END(CTiledOccupancyGridMap2D)
+};
+
+}  // namespace mrpt::maps
@@ -0,0 +1,221 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/serialization/CSerializable.h>
+#include <mrpt/config/CLoadableOptions.h>
+#include <mrpt/obs/obs_frwds.h>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
+namespace mrpt::maps
+{
+/** A cloud of points in 3D (only coordinates, like CSimplePointsMap) with a
+ * bounded density, for local maps of long-running 3D lidar odometry or SLAM.
+ *
+ * Space is divided into cubic voxels of size TVoxelOptions::voxel_size,
+ * stored in a hash table (so the map has no bounds), and each voxel keeps at
+ * most TVoxelOptions::max_points_per_voxel points: further points falling in
+ * a full voxel are discarded, in O(1) per point. Hence, revisiting an area
+ * does not make the map grow.
+ *
+ * If TVoxelOptions::max_distance is not zero, the voxels farther than that
+ * distance from the robot are removed while inserting observations, each
+ * time the robot has moved TVoxelOptions::eviction_step since the last
+ * removal, so the memory used by the map is also bounded while the robot
+ * travels. Only the parts of the kd-tree with removed points are rebuilt.
+ *
+ * Since the points are stored in the usual CPointsMap buffers, this map can
+ * be used anywhere a point map is expected (ICP, observation likelihood,
+ * rendering, etc.). Observations are converted to points with the generic
+ * CPointsMap code, as in CSimplePointsMap (with the same insertionOptions),
+ * before being filtered by voxel.
+ *
+ * Points added with methods other than insertPoint(), insertObservation() or
+ * loadFromRangeScan() (e.g. with setPoint() or insertAnotherMap()) are
+ * assigned to voxels, dropping those in excess, before the next insertion or
+ * eviction of voxels, in O(N).
+ *
+ * \sa CSimplePointsMap, CPointsMap
+ * \ingroup mrpt_maps_grp
+ */
+class CVoxelPointsMap : public CPointsMap
+{
+	DEFINE_SERIALIZABLE(CVoxelPointsMap)
+
+   public:
+	/** Constructor, with the size of the voxels (meters) and their maximum
+	 * number of points */
+	CVoxelPointsMap(
+		float voxel_size = 0.20f, uint32_t max_points_per_voxel = 8);
+
+	/** Options of the voxels of the map */
+	struct TVoxelOptions : public mrpt::config::CLoadableOptions
+	{
+		void loadFromConfigFile(
+			const mrpt::config::CConfigFileBase& source,
+			const std::string& section) override;  // See base docs
+		void dumpToTextStream(
+			std::ostream& out) const override;  // See base docs
+
+		/** Binary dump to stream */
+		void writeToStream(mrpt::serialization::CArchive& out) const;
+		/** Binary dump to stream */
+		void readFromStream(mrpt::serialization::CArchive& in);
+
+		/** Size of the side of each voxel (meters) (Default=0.20) */
+		float voxel_size{0.20f};
+		/** Maximum number of points in each voxel (Default=8) */
+		uint32_t max_points_per_voxel{8};
+		/** If not zero, voxels farther than this distance (meters) from the
+		 * robot are removed while inserting observations (Default=0) */
+		double max_distance{0};
+		/** Distance (meters) the robot must move after removing far voxels
+		 * before removing them again. Until then, the map may keep points
+		 * up to max_distance+eviction_step from the robot (Default=1.0) */
+		double eviction_step{1.0};
+	};
+	/** Options of the voxels. Changing them takes effect on the next
+	 * insertion, when the points are assigned again to voxels. */
+	TVoxelOptions voxelOptions;
+
+	/** Number of non-empty voxels. O(1), or O(N) if points were changed
+	 * without being assigned to voxels yet (see the class description) */
+	size_t getVoxelCount() const;
+
+	/** Removes the voxels (and their points) whose center is farther than \a
+	 * radius from \a center. Done automatically while inserting observations
+	 * if TVoxelOptions::max_distance is set. \return The number of removed
+	 * points. */
+	size_t removeVoxelsFarFrom(
+		const mrpt::math::TPoint3D& center, const double radius);
+
+	// --------------------------------------------
+	/** @name Pure virtual interfaces to be implemented by any class derived
+	   from CPointsMap
+		@{ */
+	void reserve(size_t newLength) override;  // See base class docs
+	void resize(size_t newLength) override;  // See base class docs
+	void setSize(size_t newLength) override;  // See base class docs
+	/** Changes the coordinates of the given point (0-based index), *without*
+	 * checking for out-of-bounds and *without* calling mark_as_modified()  \sa
+	 * setPoint */
+	void setPointFast(size_t index, float x, float y, float z) override;
+	/** The virtual method for \a insertPoint() *without* calling
+	 * mark_as_modified(). The point is discarded if its voxel is full. */
+	void insertPointFast(float x, float y, float z = 0) override;
+	/** Virtual assignment operator, to be implemented in derived classes  */
+	void copyFrom(const CPointsMap& obj) override;
+	/** Get all the data fields for one point as a vector: [X Y Z] */
+	void getPointAllFieldsFast(
+		const size_t index, std::vector<float>& point_data) const override
+	{
+		point_data.resize(3);
+		point_data[0] = m_x[index];
+		point_data[1] = m_y[index];
+		point_data[2] = m_z[index];
+	}
+	/** Set all the data fields for one point as a vector: [X Y Z] */
+	void setPointAllFieldsFast(
+		const size_t index, const std::vector<float>& point_data) override
+	{
+		ASSERTDEB_(point_data.size() == 3);
+		setPointFast(index, point_data[0], point_data[1], point_data[2]);
+	}
+
+	// See CPointsMap::loadFromRangeScan()
+	void loadFromRangeScan(
+		const mrpt::obs::CObservation2DRangeScan& rangeScan,
+		const mrpt::poses::CPose3D* robotPose = nullptr) override;
+	// See CPointsMap::loadFromRangeScan()
+	void loadFromRangeScan(
+		const mrpt::obs::CObservation3DRangeScan& rangeScan,
+		const mrpt::poses::CPose3D* robotPose = nullptr) override;
+
+   protected:
+	void addFrom_classSpecific(
+		const CPointsMap& anotherMap, const size_t nPreviousPoints) override
+	{
+		MRPT_UNUSED_PARAM(anotherMap);
+		MRPT_UNUSED_PARAM(nPreviousPoints);
+		// No extra data.
+	}
+
+   public:
+	/** @} */
+	// --------------------------------------------
+
+   protected:
+	/** Number of points in each non-empty voxel, indexed by voxelKey() */
+	std::unordered_map<uint64_t, uint32_t> m_voxels;
+	/** false if the points have changed without updating m_voxels */
+	bool m_voxelsUpToDate{true};
+	/** The voxel size used in m_voxels */
+	float m_voxelsSize{0};
+	/** Robot position at the last automatic removal of far voxels, if
+	 * m_hasEvictionCenter */
+	mrpt::math::TPoint3D m_evictionCenter;
+	bool m_hasEvictionCenter{false};
+	/** Temporary map for the points of each observation (kept to reuse its
+	 * memory) */
+	CSimplePointsMap m_obsPoints;
+
+	static constexpr int VOXEL_KEY_BITS = 21;
+	static inline uint64_t voxelKey(float x, float y, float z, float size)
+	{
+		const uint64_t mask = (uint64_t(1) << VOXEL_KEY_BITS) - 1;
+		const auto idx = [&](float v) {
+			return static_cast<uint64_t>(
+					   static_cast<int64_t>(std::floor(v / size))) &
+				   mask;
+		};
+		return (idx(x) << (2 * VOXEL_KEY_BITS)) | (idx(y) << VOXEL_KEY_BITS) |
+			   idx(z);
+	}
+	/** Signed voxel index in the axis 0 (x), 1 (y) or 2 (z) of a key */
+	static inline int voxelKeyIndex(uint64_t key, int axis)
+	{
+		const int shift = (2 - axis) * VOXEL_KEY_BITS;
+		return static_cast<int>(
+			static_cast<int64_t>(key << (64 - VOXEL_KEY_BITS - shift)) >>
+			(64 - VOXEL_KEY_BITS));
+	}
+
+	/** Assigns all the points to voxels if needed, removing the points in
+	 * excess */
+	void updateVoxels();
+	/** Inserts the points of another map through insertPointFast() */
+	void insertVoxelFilteredPoints(const CPointsMap& pts);
+
+	void internal_clear() override;
+	bool internal_insertObservation(
+		const mrpt::obs::CObservation* obs,
+		const mrpt::poses::CPose3D* robotPose) override;
+
+	/** @name PLY Import virtual methods to implement in base classes
+		@{ */
+	void PLY_import_set_vertex_count(const size_t N) override;
+	/** @} */
+
+	MAP_DEFINITION_START(CVoxelPointsMap)
+	/** Voxel options */
+	mrpt::maps::CVoxelPointsMap::TVoxelOptions voxelOpts;
+	/** Observations insertion options */
+	mrpt::maps::CPointsMap::TInsertionOptions insertionOpts;
+	/** Probabilistic observation likelihood options */
+	mrpt::maps::CPointsMap::TLikelihoodOptions likelihoodOpts;
+	/** Rendering as 3D object options */
+	mrpt::maps::CPointsMap::TRenderOptions renderOpts;
+	MAP_DEFINITION_END(CVoxelPointsMap)
+};
+
+}  // namespace mrpt::maps
@@ -113,8 +113,6 @@ COccupancyGridMap2D::COccupancyGridMap2D(
 	  y_min(),
 	  y_max(),
 	  resolution(),
-	  precomputedLikelihood(),
-	  precomputedLikelihoodToBeRecomputed(true),
 	  m_basis_map(),
 	  m_voronoi_diagram(),
 	  m_is_empty(true),
@@ -149,7 +147,9 @@ void COccupancyGridMap2D::copyMapContentFrom(const COccupancyGridMap2D& o)
 	m_basis_map.clear();
 	m_voronoi_diagram.clear();
 
-	precomputedLikelihoodToBeRecomputed = true;
+	m_likelihoodFieldToBeRecomputed = true;
+
+	m_resolutionPyramidToBeRecomputed = true;
 	m_is_empty = o.m_is_empty;
 }
 
@@ -164,7 +164,8 @@ void COccupancyGridMap2D::setSize(
 	ASSERT_(default_value >= 0 && default_value <= 1);
 
 	freeMap();
-	precomputedLikelihoodToBeRecomputed = true;
+	m_likelihoodFieldToBeRecomputed = true;
+	m_resolutionPyramidToBeRecomputed = true;
 
 	// Adjust sizes to adapt them to full sized cells acording to the
 	// resolution:
@@ -238,7 +239,8 @@ void COccupancyGridMap2D::resizeGrid(
 		return;
 
 	// For the precomputed likelihood trick:
-	precomputedLikelihoodToBeRecomputed = true;
+	m_likelihoodFieldToBeRecomputed = true;
+	m_resolutionPyramidToBeRecomputed = true;
 
 	// Add an additional margin:
 	if (additionalMargin)
@@ -342,7 +344,8 @@ void COccupancyGridMap2D::freeMap()
 	size_x = size_y = 0;
 
 	// For the precomputed likelihood trick:
-	precomputedLikelihoodToBeRecomputed = true;
+	m_likelihoodFieldToBeRecomputed = true;
+	m_resolutionPyramidToBeRecomputed = true;
 
 	m_is_empty = true;
 
@@ -450,7 +453,8 @@ void COccupancyGridMap2D::internal_clear()
 	setSize(-10, 10, -10, 10, getResolution());
 	// resetFeaturesCache();
 	// For the precomputed likelihood trick:
-	precomputedLikelihoodToBeRecomputed = true;
+	m_likelihoodFieldToBeRecomputed = true;
+	m_resolutionPyramidToBeRecomputed = true;
 }
 
 /*---------------------------------------------------------------
@@ -462,7 +466,8 @@ void COccupancyGridMap2D::fill(float default_value)
 	for (std::vector<cellType>::iterator it = map.begin(); it < map.end(); ++it)
 		*it = defValue;
 	// For the precomputed likelihood trick:
-	precomputedLikelihoodToBeRecomputed = true;
+	m_likelihoodFieldToBeRecomputed = true;
+	m_resolutionPyramidToBeRecomputed = true;
 	// resetFeaturesCache();
 }
 
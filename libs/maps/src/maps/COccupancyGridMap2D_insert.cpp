@@ -15,6 +15,7 @@
 #include <mrpt/serialization/CArchive.h>
 #include <mrpt/core/round.h>  // round()
 #include <mrpt/system/memory.h>  // alloca()
+#include <mrpt/system/thread_pool.h>
 
 #if HAVE_ALLOCA_H
 #include <alloca.h>
@@ -52,8 +53,7 @@ bool COccupancyGridMap2D::internal_insertObservation(
 
 	// This is required to indicate the grid map has changed!
 	// resetFeaturesCache();
-	// For the precomputed likelihood trick:
-	precomputedLikelihoodToBeRecomputed = true;
+	// (The likelihood field is invalidated below, only around the sensor)
 
 	if (robotPose)
 	{
@@ -66,25 +66,14 @@ bool COccupancyGridMap2D::internal_insertObservation(
 	}
 
 	// the occupied and free probabilities:
-	const float maxCertainty = insertionOptions.maxOccupancyUpdateCertainty;
-	float maxFreeCertainty = insertionOptions.maxFreenessUpdateCertainty;
-	if (maxFreeCertainty == .0f) maxFreeCertainty = maxCertainty;
-	float maxFreeCertaintyNoEcho = insertionOptions.maxFreenessInvalidRanges;
-	if (maxFreeCertaintyNoEcho == .0f) maxFreeCertaintyNoEcho = maxCertainty;
-
-	cellType logodd_observation_free =
-		std::max<cellType>(1, p2l(maxFreeCertainty));
-	cellType logodd_observation_occupied =
-		3 * std::max<cellType>(1, p2l(maxCertainty));
-	cellType logodd_noecho_free =
-		std::max<cellType>(1, p2l(maxFreeCertaintyNoEcho));
+	const TInsertionLogOdds logodds(insertionOptions);
+	cellType logodd_observation_free = logodds.observation_free;
+	cellType logodd_observation_occupied = logodds.observation_occupied;
+	cellType logodd_noecho_free = logodds.noecho_free;
 
 	// saturation limits:
-	cellType logodd_thres_occupied =
-		OCCGRID_CELLTYPE_MIN + logodd_observation_occupied;
-	cellType logodd_thres_free =
-		OCCGRID_CELLTYPE_MAX -
-		std::max(logodd_noecho_free, logodd_observation_free);
+	cellType logodd_thres_occupied = logodds.thres_occupied;
+	cellType logodd_thres_free = logodds.thres_free;
 
 	if (CLASS_ID(CObservation2DRangeScan) == obs->GetRuntimeClass())
 	{
@@ -251,78 +240,65 @@ bool COccupancyGridMap2D::internal_insertObservation(
 				cellType* theMapArray = &map[0];
 				unsigned theMapSize_x = size_x;
 
-				int cx0 =
+				const int cx0 =
 					x2idx(px);  // Remember: This must be after the resizeGrid!!
-				int cy0 = y2idx(py);
-
-				// Insert rays:
-				for (idx = 0; idx < nRanges; idx += K)
-				{
-					if (!o->validRange[idx] && !invalidAsFree) continue;
-
-					// Starting position: Laser position
-					cx = cx0;
-					cy = cy0;
-
-					// Target, in cell indexes:
-					int trg_cx = x2idx(scanPoints_x[idx]);
-					int trg_cy = y2idx(scanPoints_y[idx]);
-
-					// The x> comparison implicitly holds if x<0
-					ASSERT_(
-						static_cast<unsigned int>(trg_cx) < size_x &&
-						static_cast<unsigned int>(trg_cy) < size_y);
-
-					// Use "fractional integers" to approximate float operations
-					//  during the ray tracing:
-					int Acx = trg_cx - cx;
-					int Acy = trg_cy - cy;
+				const int cy0 = y2idx(py);
+
+				// Insert rays, only updating the cells in the rows
+				// [band_cy0,band_cy1]. Updates of a cell saturate, so their
+				// order matters: each band visits all the rays in the same
+				// order, hence the result does not depend on the number of
+				// bands. Each band only traces the part of the rays within
+				// it, so the bands split the work.
+				auto insertRays = [&](const int band_cy0, const int band_cy1) {
+					for (size_t idx = 0; idx < nRanges; idx += K)
+					{
+						if (!o->validRange[idx] && !invalidAsFree) continue;
 
-					int Acx_ = abs(Acx);
-					int Acy_ = abs(Acy);
+						// Target, in cell indexes:
+						const int trg_cx = x2idx(scanPoints_x[idx]);
+						const int trg_cy = y2idx(scanPoints_y[idx]);
 
-					int nStepsRay = max(Acx_, Acy_);
-					if (!nStepsRay) continue;  // May be...
+						// The x> comparison implicitly holds if x<0
+						ASSERT_(
+							static_cast<unsigned int>(trg_cx) < size_x &&
+							static_cast<unsigned int>(trg_cy) < size_y);
 
-					// Integers store "float values * 128"
-					float N_1 = 1.0f / nStepsRay;  // Avoid division twice.
+						if (trg_cx == cx0 && trg_cy == cy0) continue;  // May be
 
-					// Increments at each raytracing step:
-					int frAcx =
-						(Acx < 0 ? -1 : +1) * round((Acx_ << FRBITS) * N_1);
-					int frAcy =
-						(Acy < 0 ? -1 : +1) * round((Acy_ << FRBITS) * N_1);
-
-					int frCX = cx << FRBITS;
-					int frCY = cy << FRBITS;
-					const auto logodd_free = o->validRange[idx]
-												 ? logodd_observation_free
-												 : logodd_noecho_free;
-
-					for (int nStep = 0; nStep < nStepsRay; nStep++)
-					{
-						updateCell_fast_free(
-							cx, cy, logodd_free, logodd_thres_free, theMapArray,
-							theMapSize_x);
+						const auto logodd_free = o->validRange[idx]
+													 ? logodd_observation_free
+													 : logodd_noecho_free;
+						traceRay(
+							cx0, cy0, trg_cx, trg_cy,
+							[&](const int cx, const int cy) {
+								updateCell_fast_free(
+									cx, cy, logodd_free, logodd_thres_free,
+									theMapArray, theMapSize_x);
+							},
+							band_cy0, band_cy1);
+
+						// And finally, the occupied cell at the end:
+						// Only if:
+						//  - It was a valid ray, and
+						//  - The ray was not truncated
+						if (o->validRange[idx] &&
+							o->scan[idx] < maxDistanceInsertion &&
+							trg_cy >= band_cy0 && trg_cy <= band_cy1)
+							updateCell_fast_occupied(
+								trg_cx, trg_cy, logodd_observation_occupied,
+								logodd_thres_occupied, theMapArray,
+								theMapSize_x);
 
-						frCX += frAcx;
-						frCY += frAcy;
+					}  // End of each range
+				};
 
-						cx = frCX >> FRBITS;
-						cy = frCY >> FRBITS;
-					}
-
-					// And finally, the occupied cell at the end:
-					// Only if:
-					//  - It was a valid ray, and
-					//  - The ray was not truncated
-					if (o->validRange[idx] &&
-						o->scan[idx] < maxDistanceInsertion)
-						updateCell_fast_occupied(
-							trg_cx, trg_cy, logodd_observation_occupied,
-							logodd_thres_occupied, theMapArray, theMapSize_x);
-
-				}  // End of each range
+				mrpt::system::parallel_for(
+					size_y, insertionOptions.numThreads,
+					[&](const size_t first, const size_t last) {
+						insertRays(
+							static_cast<int>(first), static_cast<int>(last) - 1);
+					});
 
 				mrpt_alloca_free(scanPoints_x);
 				mrpt_alloca_free(scanPoints_y);
@@ -793,6 +769,12 @@ bool COccupancyGridMap2D::internal_insertObservation(
 
 			}  // end insert with beam widening
 
+			// For the precomputed likelihood trick: only cells within the
+			// insertion range may have changed.
+			invalidateLikelihoodFieldRegion(
+				px - maxDistanceInsertion, px + maxDistanceInsertion,
+				py - maxDistanceInsertion, py + maxDistanceInsertion);
+
 			// Finished:
 			return true;
 		}
@@ -1294,6 +1276,12 @@ bool COccupancyGridMap2D::internal_insertObservation(
 
 			}  // End of each range
 
+			// For the precomputed likelihood trick: only cells within the
+			// insertion range may have changed.
+			invalidateLikelihoodFieldRegion(
+				px - maxDistanceInsertion, px + maxDistanceInsertion,
+				py - maxDistanceInsertion, py + maxDistanceInsertion);
+
 			return true;
 		}  // end reallyInsert
 		else
@@ -1310,6 +1298,24 @@ bool COccupancyGridMap2D::internal_insertObservation(
 	//	MRPT_END
 }
 
+COccupancyGridMap2D::TInsertionLogOdds::TInsertionLogOdds(
+	const TInsertionOptions& opts)
+{
+	const float maxCertainty = opts.maxOccupancyUpdateCertainty;
+	float maxFreeCertainty = opts.maxFreenessUpdateCertainty;
+	if (maxFreeCertainty == .0f) maxFreeCertainty = maxCertainty;
+	float maxFreeCertaintyNoEcho = opts.maxFreenessInvalidRanges;
+	if (maxFreeCertaintyNoEcho == .0f) maxFreeCertaintyNoEcho = maxCertainty;
+
+	observation_free = std::max<cellType>(1, p2l(maxFreeCertainty));
+	observation_occupied = 3 * std::max<cellType>(1, p2l(maxCertainty));
+	noecho_free = std::max<cellType>(1, p2l(maxFreeCertaintyNoEcho));
+
+	// saturation limits:
+	thres_occupied = OCCGRID_CELLTYPE_MIN + observation_occupied;
+	thres_free = OCCGRID_CELLTYPE_MAX - std::max(noecho_free, observation_free);
+}
+
 /*---------------------------------------------------------------
 	Initilization of values, don't needed to be called directly.
   ---------------------------------------------------------------*/
@@ -1327,7 +1333,8 @@ COccupancyGridMap2D::TInsertionOptions::TInsertionOptions()
 	  CFD_features_gaussian_size(1),
 	  CFD_features_median_size(3),
 
-	  wideningBeamsWithDistance(false)
+	  wideningBeamsWithDistance(false),
+	  numThreads(1)
 {
 }
 
@@ -1351,6 +1358,7 @@ void COccupancyGridMap2D::TInsertionOptions::loadFromConfigFile(
 	MRPT_LOAD_CONFIG_VAR(CFD_features_gaussian_size, float, iniFile, section);
 	MRPT_LOAD_CONFIG_VAR(CFD_features_median_size, float, iniFile, section);
 	MRPT_LOAD_CONFIG_VAR(wideningBeamsWithDistance, bool, iniFile, section);
+	MRPT_LOAD_CONFIG_VAR(numThreads, int, iniFile, section);
 }
 
 /*---------------------------------------------------------------
@@ -1375,10 +1383,47 @@ void COccupancyGridMap2D::TInsertionOptions::dumpToTextStream(
 	LOADABLEOPTS_DUMP_VAR(CFD_features_gaussian_size, float)
 	LOADABLEOPTS_DUMP_VAR(CFD_features_median_size, float)
 	LOADABLEOPTS_DUMP_VAR(wideningBeamsWithDistance, bool)
+	LOADABLEOPTS_DUMP_VAR(numThreads, int)
 
 	out << mrpt::format("\n");
 }
 
+void COccupancyGridMap2D::TInsertionOptions::writeToStream(
+	mrpt::serialization::CArchive& out) const
+{
+	const int8_t version = 0;
+	out << version;
+
+	out << mapAltitude << useMapAltitude << maxDistanceInsertion
+		<< maxOccupancyUpdateCertainty << maxFreenessUpdateCertainty
+		<< maxFreenessInvalidRanges << considerInvalidRangesAsFreeSpace
+		<< decimation << horizontalTolerance << CFD_features_gaussian_size
+		<< CFD_features_median_size << wideningBeamsWithDistance;  // v0
+	// numThreads is not serialized: it depends on the machine, not the map.
+}
+
+void COccupancyGridMap2D::TInsertionOptions::readFromStream(
+	mrpt::serialization::CArchive& in)
+{
+	int8_t version;
+	in >> version;
+	switch (version)
+	{
+		case 0:
+		{
+			in >> mapAltitude >> useMapAltitude >> maxDistanceInsertion >>
+				maxOccupancyUpdateCertainty >> maxFreenessUpdateCertainty >>
+				maxFreenessInvalidRanges >> considerInvalidRangesAsFreeSpace >>
+				decimation >> horizontalTolerance >>
+				CFD_features_gaussian_size >> CFD_features_median_size >>
+				wideningBeamsWithDistance;  // v0
+		}
+		break;
+		default:
+			MRPT_THROW_UNKNOWN_SERIALIZATION_VERSION(version)
+	}
+}
+
 void COccupancyGridMap2D::OnPostSuccesfulInsertObs(
 	const mrpt::obs::CObservation*)
 {
@@ -42,7 +42,7 @@ bool COccupancyGridMap2D::saveAsBitmapFile(const std::string& file) const
 	MRPT_END
 }
 
-uint8_t COccupancyGridMap2D::serializeGetVersion() const { return 6; }
+uint8_t COccupancyGridMap2D::serializeGetVersion() const { return 8; }
 void COccupancyGridMap2D::serializeTo(mrpt::serialization::CArchive& out) const
 {
 // Version 3: Change to log-odds. The only change is in the loader, when
@@ -97,6 +97,24 @@ void COccupancyGridMap2D::serializeTo(mrpt::serialization::CArchive& out) const
 
 	// Version: 5;
 	out << insertionOptions.wideningBeamsWithDistance;
+
+	// Version 7: The precomputed likelihood field, only if enabled and up to
+	// date:
+	const bool saveLikelihoodField =
+		likelihoodOptions.serializeLikelihoodCache &&
+		!m_likelihoodFieldToBeRecomputed &&
+		m_likelihoodField.size() == map.size() && !map.empty() &&
+		m_likelihoodFieldDirty[0] > m_likelihoodFieldDirty[1];
+	out << saveLikelihoodField;
+	if (saveLikelihoodField)
+	{
+		for (const float p : m_likelihoodFieldParams) out << p;
+		out.WriteBufferFixEndianness(
+			&m_likelihoodField[0], m_likelihoodField.size());
+	}
+
+	// Version 8:
+	out << likelihoodOptions.serializeLikelihoodCache;
 }
 
 void COccupancyGridMap2D::serializeFrom(
@@ -113,6 +131,8 @@ void COccupancyGridMap2D::serializeFrom(
 		case 4:
 		case 5:
 		case 6:
+		case 7:
+		case 8:
 		{
 #ifdef OCCUPANCY_GRIDMAP_CELL_SIZE_8BITS
 			const uint8_t MyBitsPerCell = 8;
@@ -195,7 +215,8 @@ void COccupancyGridMap2D::serializeFrom(
 			}
 
 			// For the precomputed likelihood trick:
-			precomputedLikelihoodToBeRecomputed = true;
+			m_likelihoodFieldToBeRecomputed = true;
+			m_resolutionPyramidToBeRecomputed = true;
 
 			if (version >= 1)
 			{
@@ -252,6 +273,28 @@ void COccupancyGridMap2D::serializeFrom(
 			{
 				in >> insertionOptions.wideningBeamsWithDistance;
 			}
+
+			m_likelihoodFieldDirty = {{0, -1, 0, -1}};
+			if (version >= 7)
+			{
+				bool hasLikelihoodField;
+				in >> hasLikelihoodField;
+				if (hasLikelihoodField)
+				{
+					for (float& p : m_likelihoodFieldParams) in >> p;
+					m_likelihoodField.resize(map.size());
+					in.ReadBufferFixEndianness(
+						&m_likelihoodField[0], m_likelihoodField.size());
+					// It will be rebuilt anyway if the LF_* options change:
+					m_likelihoodFieldToBeRecomputed = false;
+				}
+			}
+
+			likelihoodOptions.serializeLikelihoodCache = false;
+			if (version >= 8)
+			{
+				in >> likelihoodOptions.serializeLikelihoodCache;
+			}
 		}
 		break;
 		default:
@@ -293,7 +336,8 @@ bool COccupancyGridMap2D::loadFromBitmap(
 	MRPT_START
 
 	// For the precomputed likelihood trick:
-	precomputedLikelihoodToBeRecomputed = true;
+	m_likelihoodFieldToBeRecomputed = true;
+	m_resolutionPyramidToBeRecomputed = true;
 
 	size_t bmpWidth = imgFl.getWidth();
 	size_t bmpHeight = imgFl.getHeight();
@@ -15,6 +15,10 @@
 #include <mrpt/maps/CSimplePointsMap.h>
 #include <mrpt/serialization/CArchive.h>
 
+#if MRPT_HAS_SSE2
+#include <mrpt/core/SSE_types.h>
+#endif
+
 using namespace mrpt;
 using namespace mrpt::math;
 using namespace mrpt::maps;
@@ -554,28 +558,15 @@ double COccupancyGridMap2D::computeLikelihoodField_Thrun(
 	unsigned int size_x_1 = size_x - 1;
 	unsigned int size_y_1 = size_y - 1;
 
-#define LIK_LF_CACHE_INVALID (66)
-
 	// Aux. variables for the "for j" loop:
-	double thisLik = LIK_LF_CACHE_INVALID;
+	double thisLik;
 	double maxCorrDist_sq = square(likelihoodOptions.LF_maxCorrsDistance);
 	double minimumLik = zRandomTerm + zHit * exp(Q * maxCorrDist_sq);
 	double ccos, ssin;
 	float occupiedMinDist;
 
-	if (likelihoodOptions.enableLikelihoodCache)
-	{
-		// Reset the precomputed likelihood values map
-		if (precomputedLikelihoodToBeRecomputed)
-		{
-			if (!map.empty())
-				precomputedLikelihood.assign(map.size(), LIK_LF_CACHE_INVALID);
-			else
-				precomputedLikelihood.clear();
-
-			precomputedLikelihoodToBeRecomputed = false;
-		}
-	}
+	// Bring the precomputed likelihood field up to date:
+	if (likelihoodOptions.enableLikelihoodCache) updateLikelihoodField();
 
 	cellType thresholdCellValue = p2l(0.5f);
 	int decimation = likelihoodOptions.LF_decimation;
@@ -632,11 +623,18 @@ double COccupancyGridMap2D::computeLikelihoodField_Thrun(
 			// We are into the map limits:
 			if (likelihoodOptions.enableLikelihoodCache)
 			{
-				thisLik = precomputedLikelihood[cx + cy * size_x];
+				// The table holds log-likelihood values:
+				const float logLik = m_likelihoodField[cx + cy * size_x];
+				if (Product_T_OrSum_F)
+					ret += logLik;
+				else
+				{
+					ret += exp(logLik);
+					M++;
+				}
+				continue;
 			}
-
-			if (!likelihoodOptions.enableLikelihoodCache ||
-				thisLik == LIK_LF_CACHE_INVALID)
+			else
 			{
 				// Compute now:
 				// -------------
@@ -690,10 +688,6 @@ double COccupancyGridMap2D::computeLikelihoodField_Thrun(
 					occupiedMinDist *= occupiedMinDist;
 
 				thisLik = zRandomTerm + zHit * exp(Q * occupiedMinDist);
-
-				if (likelihoodOptions.enableLikelihoodCache)
-					// And save it into the table and into "thisLik":
-					precomputedLikelihood[cx + cy * size_x] = thisLik;
 			}
 		}
 
@@ -816,6 +810,359 @@ double COccupancyGridMap2D::computeLikelihoodField_II(
 	MRPT_END
 }
 
+namespace
+{
+/** 1D squared Euclidean distance transform of the sampled function f[]
+ * (lower envelope of parabolas), see: P. Felzenszwalb, D. Huttenlocher,
+ * "Distance Transforms of Sampled Functions", Theory of Computing, 2012.
+ * Input and output elements are read/written with the given strides. */
+void distanceTransform1D(
+	const float* f, const size_t stride_f, float* d, const size_t stride_d,
+	const int n, std::vector<int>& v, std::vector<double>& z)
+{
+	v.resize(n);
+	z.resize(n + 1);
+
+	int k = 0;
+	v[0] = 0;
+	z[0] = -std::numeric_limits<double>::max();
+	z[1] = std::numeric_limits<double>::max();
+	for (int q = 1; q < n; q++)
+	{
+		const double fq = f[q * stride_f] + double(q) * q;
+		double s;
+		for (;;)
+		{
+			const int p = v[k];
+			s = (fq - (f[p * stride_f] + double(p) * p)) / (2.0 * (q - p));
+			if (s > z[k]) break;
+			k--;
+		}
+		k++;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = std::numeric_limits<double>::max();
+	}
+
+	k = 0;
+	for (int q = 0; q < n; q++)
+	{
+		while (z[k + 1] < q) k++;
+		d[q * stride_d] = square(q - v[k]) + f[v[k] * stride_f];
+	}
+}
+}  // namespace
+
+/*---------------------------------------------------------------
+					updateLikelihoodField
+ ---------------------------------------------------------------*/
+void COccupancyGridMap2D::updateLikelihoodField()
+{
+	MRPT_START
+
+	const std::array<float, 6> params = {
+		{likelihoodOptions.LF_stdHit, likelihoodOptions.LF_zHit,
+		 likelihoodOptions.LF_zRandom, likelihoodOptions.LF_maxRange,
+		 likelihoodOptions.LF_maxCorrsDistance,
+		 likelihoodOptions.LF_useSquareDist ? 1.0f : 0.0f}};
+
+	// The area of influence of an obstacle:
+	const int K =
+		(int)ceil(likelihoodOptions.LF_maxCorrsDistance /*m*/ / resolution);
+
+	// Region to be updated, in cell indices (inclusive):
+	int x0, x1, y0, y1;
+	if (m_likelihoodFieldToBeRecomputed ||
+		m_likelihoodField.size() != map.size() ||
+		params != m_likelihoodFieldParams)
+	{
+		m_likelihoodField.resize(map.size());
+		x0 = 0;
+		x1 = static_cast<int>(size_x) - 1;
+		y0 = 0;
+		y1 = static_cast<int>(size_y) - 1;
+	}
+	else
+	{
+		if (m_likelihoodFieldDirty[0] > m_likelihoodFieldDirty[1])
+			return;  // Up to date.
+		x0 = max(0, m_likelihoodFieldDirty[0] - K);
+		x1 = min(static_cast<int>(size_x) - 1, m_likelihoodFieldDirty[1] + K);
+		y0 = max(0, m_likelihoodFieldDirty[2] - K);
+		y1 = min(static_cast<int>(size_y) - 1, m_likelihoodFieldDirty[3] + K);
+	}
+	m_likelihoodFieldToBeRecomputed = false;
+	m_likelihoodFieldParams = params;
+	m_likelihoodFieldDirty = {{0, -1, 0, -1}};
+	if (x0 > x1 || y0 > y1) return;  // Empty map
+
+	// Same model than in computeLikelihoodField_Thrun(), tabulated for all
+	// the possible (squared, in cell units) distances up to the max.
+	// correspondence distance:
+	const float zRandomTerm =
+		likelihoodOptions.LF_zRandom / likelihoodOptions.LF_maxRange;
+	const float zHit = likelihoodOptions.LF_zHit;
+	const float Q = -0.5f / square(likelihoodOptions.LF_stdHit);
+	const double maxCorrDist_sq = square(likelihoodOptions.LF_maxCorrsDistance);
+	const double constDist2DiscrUnits = 100 / (resolution * resolution);
+	const double constDist2DiscrUnits_INV = 1.0 / constDist2DiscrUnits;
+	const unsigned int maxDistInt =
+		mrpt::round(maxCorrDist_sq * constDist2DiscrUnits);
+	const unsigned int maxDistCells = (maxDistInt + 99) / 100;
+
+	std::vector<float> logLikLUT(maxDistCells + 1);
+	for (unsigned int i = 0; i <= maxDistCells; i++)
+	{
+		float occupiedMinDist =
+			min(100 * i, maxDistInt) * constDist2DiscrUnits_INV;
+		if (likelihoodOptions.LF_useSquareDist)
+			occupiedMinDist *= occupiedMinDist;
+		const double thisLik = zRandomTerm + zHit * exp(Q * occupiedMinDist);
+		logLikLUT[i] = static_cast<float>(log(thisLik));
+	}
+
+	// Obstacles up to K cells away of the updated region affect it:
+	const int sx0 = max(0, x0 - K), sx1 = min(int(size_x) - 1, x1 + K);
+	const int sy0 = max(0, y0 - K), sy1 = min(int(size_y) - 1, y1 + K);
+	const int w = sx1 - sx0 + 1, h = sy1 - sy0 + 1;
+
+	// Any value above maxDistCells gives the same result: use it as the
+	// "infinite" distance of free cells (exact in a float).
+	const float INF_DIST = static_cast<float>(maxDistCells + 1) +
+						   static_cast<float>(square(w) + square(h));
+	const cellType thresholdCellValue = p2l(0.5f);
+
+	std::vector<int> v;
+	std::vector<double> z;
+	std::vector<float> col(h), dist(w * h), row(w);
+
+	// 1st pass: distances along each column:
+	for (int x = 0; x < w; x++)
+	{
+		const cellType* mapPtr = &map[sx0 + x + sy0 * size_x];
+		for (int y = 0; y < h; y++, mapPtr += size_x)
+			col[y] = (*mapPtr < thresholdCellValue) ? 0.0f : INF_DIST;
+		distanceTransform1D(&col[0], 1, &dist[x], w, h, v, z);
+	}
+
+	// 2nd pass: along each row, only for the region to be updated:
+	for (int y = y0; y <= y1; y++)
+	{
+		distanceTransform1D(&dist[(y - sy0) * w], 1, &row[0], 1, w, v, z);
+		float* lik = &m_likelihoodField[y * size_x];
+		for (int x = x0; x <= x1; x++)
+		{
+			const float d = row[x - sx0];
+			lik[x] = logLikLUT
+				[d >= maxDistCells ? maxDistCells : static_cast<unsigned>(d)];
+		}
+	}
+
+	MRPT_END
+}
+
+/*---------------------------------------------------------------
+				invalidateLikelihoodFieldRegion
+ ---------------------------------------------------------------*/
+void COccupancyGridMap2D::invalidateLikelihoodFieldRegion(
+	float x0, float x1, float y0, float y1)
+{
+	// Add a margin for rounding and widened beams:
+	const int cx0 = max(0, x2idx(x0) - 2);
+	const int cx1 = min(static_cast<int>(size_x) - 1, x2idx(x1) + 2);
+	const int cy0 = max(0, y2idx(y0) - 2);
+	const int cy1 = min(static_cast<int>(size_y) - 1, y2idx(y1) + 2);
+	if (cx0 > cx1 || cy0 > cy1) return;
+
+	auto growDirtyBox = [=](std::array<int, 4>& d) {
+		if (d[0] > d[1])
+			d = {{cx0, cx1, cy0, cy1}};
+		else
+		{
+			keep_min(d[0], cx0);
+			keep_max(d[1], cx1);
+			keep_min(d[2], cy0);
+			keep_max(d[3], cy1);
+		}
+	};
+	// (Not needed if all will be rebuilt anyway)
+	if (!m_likelihoodFieldToBeRecomputed) growDirtyBox(m_likelihoodFieldDirty);
+	if (!m_resolutionPyramidToBeRecomputed && !m_resolutionPyramid.empty())
+		growDirtyBox(m_resolutionPyramidDirty);
+}
+
+/*---------------------------------------------------------------
+				computeLikelihoodField_Thrun_batch
+ ---------------------------------------------------------------*/
+void COccupancyGridMap2D::computeLikelihoodField_Thrun_batch(
+	const CPointsMap* pm, const std::vector<TPose2D>& poses,
+	std::vector<double>& out_log_liks)
+{
+	MRPT_START
+
+	ASSERT_(pm);
+	const size_t nPoses = poses.size();
+	const size_t N = pm->size();
+	if (!N)
+	{
+		out_log_liks.assign(nPoses, -100);  // No way to estimate this!!
+		return;
+	}
+	out_log_liks.resize(nPoses);
+
+	updateLikelihoodField();
+
+	// Decimated local points, in SoA form and padded to a multiple of 4:
+	size_t decimation = likelihoodOptions.LF_decimation;
+	if (N < 10 || !decimation) decimation = 1;
+	const size_t nPts = (N + decimation - 1) / decimation;
+
+	mrpt::aligned_std_vector<float> xs((nPts + 3) & ~size_t(3), 0.0f),
+		ys((nPts + 3) & ~size_t(3), 0.0f);
+	{
+		const auto& pm_xs = pm->getPointsBufferRef_x();
+		const auto& pm_ys = pm->getPointsBufferRef_y();
+		for (size_t j = 0, k = 0; j < N; j += decimation, k++)
+		{
+			xs[k] = pm_xs[j];
+			ys[k] = pm_ys[j];
+		}
+	}
+
+	const bool Product_T_OrSum_F = !likelihoodOptions.LF_alternateAverageMethod;
+	const float zRandomTerm =
+		likelihoodOptions.LF_zRandom / likelihoodOptions.LF_maxRange;
+	const float Q = -0.5f / square(likelihoodOptions.LF_stdHit);
+	const double minimumLik =
+		zRandomTerm + likelihoodOptions.LF_zHit *
+						  exp(Q * square(likelihoodOptions.LF_maxCorrsDistance));
+	const float minimumLogLik = static_cast<float>(log(minimumLik));
+
+	const unsigned int size_x_1 = size_x - 1;
+	const unsigned int size_y_1 = size_y - 1;
+	const float* field = &m_likelihoodField[0];
+
+	// Accumulates the contribution of the point falling in cell (cx,cy):
+	auto cellLogLik = [&](const int cx, const int cy) -> float {
+		// Tip: Comparison cx<0 is implicit in (unsigned)(x)>size...
+		if (static_cast<unsigned>(cx) >= size_x_1 ||
+			static_cast<unsigned>(cy) >= size_y_1)
+			return minimumLogLik;
+		return field[cx + cy * size_x];
+	};
+
+	for (size_t k = 0; k < nPoses; k++)
+	{
+		const TPose2D& pose = poses[k];
+		const float ccos = static_cast<float>(cos(pose.phi));
+		const float ssin = static_cast<float>(sin(pose.phi));
+		const float x0 = static_cast<float>(pose.x - x_min);
+		const float y0 = static_cast<float>(pose.y - y_min);
+
+		double ret = 0;
+		auto accum = [&](const float logLik) {
+			if (Product_T_OrSum_F)
+				ret += logLik;
+			else
+				ret += exp(logLik);
+		};
+
+		size_t j = 0;
+#if MRPT_HAS_SSE2
+		const __m128 cos_4val = _mm_set1_ps(ccos);
+		const __m128 sin_4val = _mm_set1_ps(ssin);
+		const __m128 x0_4val = _mm_set1_ps(x0);
+		const __m128 y0_4val = _mm_set1_ps(y0);
+		const __m128 res_4val = _mm_set1_ps(resolution);
+		alignas(16) int32_t cxs[4], cys[4];
+
+		for (; j + 4 <= nPts; j += 4)
+		{
+			const __m128 lx = _mm_load_ps(&xs[j]);
+			const __m128 ly = _mm_load_ps(&ys[j]);
+			const __m128 gx = _mm_add_ps(
+				x0_4val,
+				_mm_sub_ps(_mm_mul_ps(lx, cos_4val), _mm_mul_ps(ly, sin_4val)));
+			const __m128 gy = _mm_add_ps(
+				y0_4val,
+				_mm_add_ps(_mm_mul_ps(lx, sin_4val), _mm_mul_ps(ly, cos_4val)));
+			// Truncation, as in x2idx():
+			_mm_store_si128(
+				reinterpret_cast<__m128i*>(cxs),
+				_mm_cvttps_epi32(_mm_div_ps(gx, res_4val)));
+			_mm_store_si128(
+				reinterpret_cast<__m128i*>(cys),
+				_mm_cvttps_epi32(_mm_div_ps(gy, res_4val)));
+
+			accum(cellLogLik(cxs[0], cys[0]));
+			accum(cellLogLik(cxs[1], cys[1]));
+			accum(cellLogLik(cxs[2], cys[2]));
+			accum(cellLogLik(cxs[3], cys[3]));
+		}
+#endif
+		// Remaining points (or all of them, without SSE2):
+		for (; j < nPts; j++)
+		{
+			const float gx = x0 + xs[j] * ccos - ys[j] * ssin;
+			const float gy = y0 + xs[j] * ssin + ys[j] * ccos;
+			accum(cellLogLik(
+				static_cast<int>(gx / resolution),
+				static_cast<int>(gy / resolution)));
+		}
+
+		out_log_liks[k] = Product_T_OrSum_F ? ret : log(ret / nPts);
+	}
+
+	MRPT_END
+}
+
+/*---------------------------------------------------------------
+				computeObservationLikelihoodBatch
+ ---------------------------------------------------------------*/
+void COccupancyGridMap2D::computeObservationLikelihoodBatch(
+	const CObservation* obs, const std::vector<TPose2D>& poses,
+	std::vector<double>& out_log_liks)
+{
+	MRPT_START
+
+	ASSERT_(obs);
+	if (genericMapParams.enableObservationLikelihood &&
+		likelihoodOptions.likelihoodMethod == lmLikelihoodField_Thrun &&
+		IS_CLASS(obs, CObservation2DRangeScan))
+	{
+		const CObservation2DRangeScan* o =
+			static_cast<const CObservation2DRangeScan*>(obs);
+
+		// Same checks than in internal_computeObservationLikelihood():
+		if (!o->isPlanarScan(insertionOptions.horizontalTolerance) ||
+			(insertionOptions.useMapAltitude &&
+			 fabs(insertionOptions.mapAltitude - o->sensorPose.z()) > 0.01))
+		{
+			out_log_liks.assign(poses.size(), -10);
+			return;
+		}
+
+		// Same points than in
+		// computeObservationLikelihood_likelihoodField_Thrun():
+		CPointsMap::TInsertionOptions opts;
+		opts.minDistBetweenLaserPoints = resolution * 0.5f;
+		opts.isPlanarMap = true;  // Already filtered above!
+		opts.horizontalTolerance = insertionOptions.horizontalTolerance;
+
+		computeLikelihoodField_Thrun_batch(
+			o->buildAuxPointsMap<mrpt::maps::CPointsMap>(&opts), poses,
+			out_log_liks);
+		return;
+	}
+
+	// Generic method: one pose at a time.
+	out_log_liks.resize(poses.size());
+	for (size_t k = 0; k < poses.size(); k++)
+		out_log_liks[k] = computeObservationLikelihood(obs, CPose2D(poses[k]));
+
+	MRPT_END
+}
+
 /*---------------------------------------------------------------
 	Initilization of values, don't needed to be called directly.
   ---------------------------------------------------------------*/
@@ -858,6 +1205,8 @@ void COccupancyGridMap2D::TLikelihoodOptions::loadFromConfigFile(
 
 	enableLikelihoodCache = iniFile.read_bool(
 		section, "enableLikelihoodCache", enableLikelihoodCache);
+	serializeLikelihoodCache = iniFile.read_bool(
+		section, "serializeLikelihoodCache", serializeLikelihoodCache);
 
 	LF_stdHit = iniFile.read_float(section, "LF_stdHit", LF_stdHit);
 	LF_zHit = iniFile.read_float(section, "LF_zHit", LF_zHit);
@@ -931,6 +1280,9 @@ void COccupancyGridMap2D::TLikelihoodOptions::dumpToTextStream(
 	out << mrpt::format(
 		"enableLikelihoodCache                   = %c\n",
 		enableLikelihoodCache ? 'Y' : 'N');
+	out << mrpt::format(
+		"serializeLikelihoodCache                = %c\n",
+		serializeLikelihoodCache ? 'Y' : 'N');
 
 	out << mrpt::format(
 		"LF_stdHit                               = %f\n", LF_stdHit);
@@ -982,6 +1334,48 @@ void COccupancyGridMap2D::TLikelihoodOptions::dumpToTextStream(
 	out << mrpt::format("\n");
 }
 
+void COccupancyGridMap2D::TLikelihoodOptions::writeToStream(
+	mrpt::serialization::CArchive& out) const
+{
+	const int8_t version = 0;
+	out << version;
+
+	out << static_cast<int32_t>(likelihoodMethod) << LF_stdHit << LF_zHit
+		<< LF_zRandom << LF_maxRange << LF_decimation << LF_maxCorrsDistance
+		<< LF_useSquareDist << LF_alternateAverageMethod << MI_exponent
+		<< MI_skip_rays << MI_ratio_max_distance
+		<< rayTracing_useDistanceFilter << rayTracing_decimation
+		<< rayTracing_stdHit << consensus_takeEachRange << consensus_pow
+		<< OWA_weights << enableLikelihoodCache
+		<< serializeLikelihoodCache;  // v0
+}
+
+void COccupancyGridMap2D::TLikelihoodOptions::readFromStream(
+	mrpt::serialization::CArchive& in)
+{
+	int8_t version;
+	in >> version;
+	switch (version)
+	{
+		case 0:
+		{
+			int32_t method;
+			in >> method;
+			likelihoodMethod = static_cast<TLikelihoodMethod>(method);
+			in >> LF_stdHit >> LF_zHit >> LF_zRandom >> LF_maxRange >>
+				LF_decimation >> LF_maxCorrsDistance >> LF_useSquareDist >>
+				LF_alternateAverageMethod >> MI_exponent >> MI_skip_rays >>
+				MI_ratio_max_distance >> rayTracing_useDistanceFilter >>
+				rayTracing_decimation >> rayTracing_stdHit >>
+				consensus_takeEachRange >> consensus_pow >> OWA_weights >>
+				enableLikelihoodCache >> serializeLikelihoodCache;  // v0
+		}
+		break;
+		default:
+			MRPT_THROW_UNKNOWN_SERIALIZATION_VERSION(version)
+	}
+}
+
 /** Returns true if this map is able to compute a sensible likelihood function
  * for this observation (i.e. an occupancy grid map cannot with an image).
  * \param obs The observation.
@@ -0,0 +1,112 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "maps-precomp.h"  // Precomp header
+
+#include <mrpt/maps/COccupancyGridMap2D.h>
+#include <algorithm>
+
+using namespace mrpt;
+using namespace mrpt::maps;
+using namespace std;
+
+/*---------------------------------------------------------------
+				getResolutionPyramidLevel
+ ---------------------------------------------------------------*/
+const std::vector<uint8_t>& COccupancyGridMap2D::getResolutionPyramidLevel(
+	unsigned int level) const
+{
+	updateResolutionPyramid(
+		std::max(level + 1, getResolutionPyramidLevels()));
+	return m_resolutionPyramid[level];
+}
+
+void COccupancyGridMap2D::clearResolutionPyramid()
+{
+	m_resolutionPyramid.clear();
+	m_resolutionPyramidToBeRecomputed = true;
+}
+
+/*---------------------------------------------------------------
+				updateResolutionPyramid
+ ---------------------------------------------------------------*/
+void COccupancyGridMap2D::updateResolutionPyramid(unsigned int nLevels) const
+{
+	MRPT_START
+
+	ASSERT_(nLevels > 0 && nLevels < 16);
+
+	// Region to be updated in level 0, in cell indices (inclusive):
+	int x0, x1, y0, y1;
+	if (m_resolutionPyramidToBeRecomputed ||
+		m_resolutionPyramid.size() != nLevels ||
+		m_resolutionPyramid[0].size() != map.size())
+	{
+		m_resolutionPyramid.resize(nLevels);
+		for (auto& level : m_resolutionPyramid) level.resize(map.size());
+		x0 = 0;
+		x1 = static_cast<int>(size_x) - 1;
+		y0 = 0;
+		y1 = static_cast<int>(size_y) - 1;
+	}
+	else
+	{
+		if (m_resolutionPyramidDirty[0] > m_resolutionPyramidDirty[1])
+			return;  // Up to date.
+		x0 = m_resolutionPyramidDirty[0];
+		x1 = m_resolutionPyramidDirty[1];
+		y0 = m_resolutionPyramidDirty[2];
+		y1 = m_resolutionPyramidDirty[3];
+	}
+	m_resolutionPyramidToBeRecomputed = false;
+	m_resolutionPyramidDirty = {{0, -1, 0, -1}};
+	if (x0 > x1 || y0 > y1) return;  // Empty map
+
+	// Level 0: the occupancy of each cell:
+	for (int y = y0; y <= y1; y++)
+	{
+		const cellType* row = &map[y * size_x];
+		uint8_t* occ = &m_resolutionPyramid[0][y * size_x];
+		for (int x = x0; x <= x1; x++) occ[x] = 255 - l2p_255(row[x]);
+	}
+
+	// Level h: max of 4 elements of level h-1, 2^(h-1) cells apart. Only the
+	// elements whose window overlaps the modified area change:
+	for (unsigned int h = 1; h < nLevels; h++)
+	{
+		const int s = 1 << (h - 1);
+		x0 = std::max(0, x0 - s);
+		y0 = std::max(0, y0 - s);
+		const std::vector<uint8_t>& prev = m_resolutionPyramid[h - 1];
+		std::vector<uint8_t>& cur = m_resolutionPyramid[h];
+
+		for (int y = y0; y <= y1; y++)
+		{
+			const uint8_t* r0 = &prev[y * size_x];
+			const uint8_t* r1 = y + s < static_cast<int>(size_y)
+									? &prev[(y + s) * size_x]
+									: nullptr;
+			uint8_t* out = &cur[y * size_x];
+			for (int x = x0; x <= x1; x++)
+			{
+				uint8_t v = r0[x];
+				const bool inX = x + s < static_cast<int>(size_x);
+				if (inX) v = std::max(v, r0[x + s]);
+				if (r1)
+				{
+					v = std::max(v, r1[x]);
+					if (inX) v = std::max(v, r1[x + s]);
+				}
+				out[x] = v;
+			}
+		}
+	}
+
+	MRPT_END
+}
@@ -9,7 +9,10 @@
 
 #include <mrpt/maps/COccupancyGridMap2D.h>
 #include <mrpt/obs/CObservation2DRangeScan.h>
+#include <mrpt/io/CMemoryStream.h>
+#include <mrpt/serialization/CArchive.h>
 #include <gtest/gtest.h>
+#include <cmath>
 
 using namespace mrpt;
 using namespace mrpt::maps;
@@ -104,3 +107,181 @@ TEST(COccupancyGridMap2DTests, insert2DScan)
 		// should have a high "freeness"
 	}
 }
+
+static void insertBoxScan(
+	COccupancyGridMap2D& grid, CObservation2DRangeScan& scan,
+	const CPose3D* robotPose = nullptr)
+{
+	// A synthetic scan inside a rectangular room:
+	const size_t N = 361;
+	scan.aperture = 2 * M_PIf;
+	scan.rightToLeft = true;
+	scan.resizeScan(N);
+	for (size_t i = 0; i < N; i++)
+	{
+		const double a = -M_PI + 2 * M_PI * i / (N - 1);
+		const double r = std::min(
+			3.0 / std::max(std::abs(cos(a)), 1e-3),
+			2.0 / std::max(std::abs(sin(a)), 1e-3));
+		scan.setScanRange(i, static_cast<float>(r));
+		scan.setScanRangeValidity(i, true);
+	}
+	grid.insertObservation(&scan, robotPose);
+}
+
+TEST(COccupancyGridMap2DTests, computeObservationLikelihoodBatch)
+{
+	COccupancyGridMap2D grid(-5.0f, 5.0f, -5.0f, 5.0f, 0.05f);
+	CObservation2DRangeScan scan;
+	insertBoxScan(grid, scan);
+	grid.likelihoodOptions.likelihoodMethod =
+		COccupancyGridMap2D::lmLikelihoodField_Thrun;
+
+	// Poses not aligned with the grid cells (the batch version uses floats,
+	// so points exactly at cell boundaries may fall in a different cell):
+	std::vector<TPose2D> poses;
+	for (int i = 0; i < 21; i++)
+		poses.emplace_back(
+			-0.513 + 0.05 * i, 0.307 - 0.03 * i, DEG2RAD(-20.0 + 2.0 * i));
+	// Partly out of the map:
+	poses.emplace_back(3.513, 0.007, 0.0);
+
+	for (int sumMode = 0; sumMode < 2; sumMode++)
+	{
+		grid.likelihoodOptions.LF_alternateAverageMethod = (sumMode != 0);
+
+		std::vector<double> batch;
+		grid.computeObservationLikelihoodBatch(&scan, poses, batch);
+		ASSERT_EQ(batch.size(), poses.size());
+
+		for (size_t k = 0; k < poses.size(); k++)
+		{
+			const double single =
+				grid.computeObservationLikelihood(&scan, CPose2D(poses[k]));
+			EXPECT_NEAR(batch[k], single, 1e-3 * (1.0 + std::abs(single)))
+				<< "sumMode=" << sumMode << " pose=" << poses[k].asString();
+		}
+	}
+}
+
+TEST(COccupancyGridMap2DTests, likelihoodFieldIncrementalAndSerialization)
+{
+	COccupancyGridMap2D grid(-10.0f, 10.0f, -10.0f, 10.0f, 0.05f);
+	grid.insertionOptions.maxDistanceInsertion = 4.0f;
+	CObservation2DRangeScan scan;
+	insertBoxScan(grid, scan);
+
+	std::vector<CPose2D> poses;
+	for (int i = 0; i < 15; i++)
+		poses.emplace_back(
+			-0.5 + 0.2 * i, 0.4 - 0.05 * i, DEG2RAD(-10.0 + 3.0 * i));
+
+	// Build the whole field, then insert a second scan (incremental update):
+	grid.updateLikelihoodField();
+	const CPose3D robotPose(2.5, 1.0, 0, DEG2RAD(20.0), 0, 0);
+	insertBoxScan(grid, scan, &robotPose);
+
+	std::vector<double> liks(poses.size());
+	for (size_t k = 0; k < poses.size(); k++)
+		liks[k] = grid.computeObservationLikelihood(&scan, poses[k]);
+
+	// Compare against the brute-force search of the closest obstacles:
+	grid.likelihoodOptions.enableLikelihoodCache = false;
+	for (size_t k = 0; k < poses.size(); k++)
+	{
+		const double ref = grid.computeObservationLikelihood(&scan, poses[k]);
+		EXPECT_NEAR(liks[k], ref, 1e-3 * (1.0 + std::abs(ref)))
+			<< "pose=" << poses[k];
+	}
+	grid.likelihoodOptions.enableLikelihoodCache = true;
+
+	// By default, the field is not serialized, but rebuilt after loading:
+	const size_t fieldBytes = grid.getSizeX() * grid.getSizeY() * sizeof(float);
+	for (const bool saveField : {false, true})
+	{
+		grid.likelihoodOptions.serializeLikelihoodCache = saveField;
+		mrpt::io::CMemoryStream buf;
+		auto arch = mrpt::serialization::archiveFrom(buf);
+		arch << grid;
+		if (saveField)
+			EXPECT_GT(buf.getTotalBytesCount(), fieldBytes);
+		else
+			EXPECT_LT(buf.getTotalBytesCount(), fieldBytes);
+		buf.Seek(0);
+		COccupancyGridMap2D grid2;
+		arch >> grid2;
+		EXPECT_EQ(grid2.likelihoodOptions.serializeLikelihoodCache, saveField);
+
+		for (size_t k = 0; k < poses.size(); k++)
+			EXPECT_NEAR(
+				grid2.computeObservationLikelihood(&scan, poses[k]), liks[k],
+				1e-6 * (1.0 + std::abs(liks[k])));
+	}
+}
+
+TEST(COccupancyGridMap2DTests, insertScanMultiThreaded)
+{
+	// Parallel insertion must give exactly the same map:
+	std::vector<COccupancyGridMap2D> grids;
+	for (unsigned int numThreads : {1U, 2U, 3U, 8U})
+	{
+		COccupancyGridMap2D grid(-5.0f, 5.0f, -5.0f, 5.0f, 0.05f);
+		grid.insertionOptions.numThreads = numThreads;
+		CObservation2DRangeScan scan;
+		for (int i = 0; i < 10; i++)
+		{
+			// Includes poses making the grid grow:
+			const CPose3D robotPose(
+				-1.0 + 0.6 * i, 0.5 - 0.3 * i, 0, DEG2RAD(17.0 * i), 0, 0);
+			insertBoxScan(grid, scan, &robotPose);
+		}
+		grids.push_back(grid);
+	}
+
+	for (size_t i = 1; i < grids.size(); i++)
+	{
+		EXPECT_EQ(grids[i].getSizeX(), grids[0].getSizeX());
+		EXPECT_EQ(grids[i].getSizeY(), grids[0].getSizeY());
+		EXPECT_TRUE(grids[i].getRawMap() == grids[0].getRawMap());
+	}
+}
+
+TEST(COccupancyGridMap2DTests, resolutionPyramid)
+{
+	COccupancyGridMap2D grid(-4.0f, 4.0f, -4.0f, 4.0f, 0.05f);
+	grid.insertionOptions.maxDistanceInsertion = 3.0f;
+	CObservation2DRangeScan scan;
+	insertBoxScan(grid, scan);
+
+	const unsigned int nLevels = 5;
+	EXPECT_EQ(grid.getResolutionPyramidLevels(), 0u);
+	grid.getResolutionPyramidLevel(nLevels - 1);
+	EXPECT_EQ(grid.getResolutionPyramidLevels(), nLevels);
+
+	// Incremental update of the modified area:
+	const CPose3D robotPose(0.7, -0.4, 0, DEG2RAD(30.0), 0, 0);
+	insertBoxScan(grid, scan, &robotPose);
+
+	const int sx = grid.getSizeX(), sy = grid.getSizeY();
+	for (unsigned int h = 0; h < nLevels; h++)
+	{
+		const std::vector<uint8_t>& level = grid.getResolutionPyramidLevel(h);
+		ASSERT_EQ(level.size(), grid.getRawMap().size());
+		// Compare against the brute-force max:
+		const int w = 1 << h;
+		for (int y = 0; y < sy; y++)
+			for (int x = 0; x < sx; x++)
+			{
+				uint8_t m = 0;
+				for (int j = y; j < std::min(y + w, sy); j++)
+					for (int i = x; i < std::min(x + w, sx); i++)
+						m = std::max<uint8_t>(
+							m, 255 - grid.l2p_255(grid.getRow(j)[i]));
+				ASSERT_EQ(level[x + y * sx], m)
+					<< "h=" << h << " x=" << x << " y=" << y;
+			}
+	}
+
+	grid.clearResolutionPyramid();
+	EXPECT_EQ(grid.getResolutionPyramidLevels(), 0u);
+}
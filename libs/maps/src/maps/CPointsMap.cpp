@@ -13,6 +13,7 @@
 #include <mrpt/system/CTicTac.h>
 #include <mrpt/system/CTimeLogger.h>
 #include <mrpt/system/os.h>
+#include <mrpt/system/thread_pool.h>
 #include <mrpt/math/geometry.h>
 #include <mrpt/serialization/CArchive.h>
 
@@ -337,9 +338,6 @@ void CPointsMap::determineMatching2D(
 
 	double maxDistForCorrespondenceSquared;
 	float x_local, y_local;
-	unsigned int localIdx;
-
-	const float *x_other_it, *y_other_it, *z_other_it;
 
 	// Prepare output: no correspondences initially:
 	correspondences.clear();
@@ -467,34 +465,41 @@ void CPointsMap::determineMatching2D(
 		local_y_min > global_y_max || local_y_max < global_y_min)
 		return;  // We know for sure there is no matching at all
 
+	// KD-TREE implementation =================================
+	// Use a KD-tree to look for the nearnest neighbor of each local point
+	// In "this" (global/reference) points map. The queries are independent,
+	// so they are split among threads if requested:
+	const size_t decim = params.decimation_other_map_points;
+	const size_t nQueries =
+		params.offset_other_map_points < nLocalPoints
+			? (nLocalPoints - params.offset_other_map_points - 1) / decim + 1
+			: 0;
+	std::vector<size_t> closest_idx(nQueries);
+	std::vector<float> closest_err_sq(nQueries);
+	const float* x_queries = x_locals.data() + params.offset_other_map_points;
+	const float* y_queries = y_locals.data() + params.offset_other_map_points;
+
+	kdTreeBuildIndex2D();
+	auto queryBlock = [&](const size_t first, const size_t last) {
+		kdTreeClosestPoints2D(
+			x_queries + first * decim, y_queries + first * decim,
+			last - first, decim, closest_idx.data() + first,
+			closest_err_sq.data() + first);
+	};
+	mrpt::system::parallel_for(nQueries, params.numThreads, queryBlock);
+
 	// Loop for each point in local map:
 	// --------------------------------------------------
-	for (localIdx = params.offset_other_map_points,
-		x_other_it = &otherMap->m_x[params.offset_other_map_points],
-		y_other_it = &otherMap->m_y[params.offset_other_map_points],
-		z_other_it = &otherMap->m_z[params.offset_other_map_points];
-		 localIdx < nLocalPoints;
-		 x_other_it += params.decimation_other_map_points,
-		y_other_it += params.decimation_other_map_points,
-		z_other_it += params.decimation_other_map_points,
-		localIdx += params.decimation_other_map_points)
+	for (size_t k = 0; k < nQueries; k++)
 	{
-		// For speed-up:
-		x_local = x_locals[localIdx];  // *x_locals_it;
-		y_local = y_locals[localIdx];  // *y_locals_it;
-
-		// Find all the matchings in the requested distance:
+		const size_t localIdx = params.offset_other_map_points + k * decim;
 
-		// KD-TREE implementation =================================
-		// Use a KD-tree to look for the nearnest neighbor of:
-		//   (x_local, y_local, z_local)
-		// In "this" (global/reference) points map.
+		// For speed-up:
+		x_local = x_locals[localIdx];
+		y_local = y_locals[localIdx];
 
-		float tentativ_err_sq;
-		unsigned int tentativ_this_idx = kdTreeClosestPoint2D(
-			x_local, y_local,  // Look closest to this guy
-			tentativ_err_sq  // save here the min. distance squared
-		);
+		const float tentativ_err_sq = closest_err_sq[k];
+		const size_t tentativ_this_idx = closest_idx[k];
 
 		// Compute max. allowed distance:
 		maxDistForCorrespondenceSquared = square(
@@ -518,9 +523,9 @@ void CPointsMap::determineMatching2D(
 			p.this_z = m_z[tentativ_this_idx];
 
 			p.other_idx = localIdx;
-			p.other_x = *x_other_it;
-			p.other_y = *y_other_it;
-			p.other_z = *z_other_it;
+			p.other_x = otherMap->m_x[localIdx];
+			p.other_y = otherMap->m_y[localIdx];
+			p.other_z = otherMap->m_z[localIdx];
 
 			p.errorSquareAfterTransformation = tentativ_err_sq;
 
@@ -616,6 +621,7 @@ void CPointsMap::changeCoordinatesReference(
 				isEmpty
  ---------------------------------------------------------------*/
 bool CPointsMap::isEmpty() const { return m_x.empty(); }
+
 /*---------------------------------------------------------------
 				TInsertionOptions
  ---------------------------------------------------------------*/
@@ -1066,6 +1072,61 @@ void CPointsMap::boundingBox(
 	max_z = m_bb_max_z;
 }
 
+/*---------------------------------------------------------------
+				getLocalGeometry
+---------------------------------------------------------------*/
+const CPointsMap::TLocalGeometry& CPointsMap::getLocalGeometry(
+	size_t knn) const
+{
+	MRPT_START
+
+	const size_t N = size();
+	if (m_localGeometryIsUpdated && m_localGeometry.knn == knn &&
+		m_localGeometry.normals.size() == N)
+		return m_localGeometry;
+
+	ASSERT_ABOVE_(knn, 2);
+	m_localGeometry.knn = knn;
+	m_localGeometry.normals.resize(N);
+	m_localGeometry.covariances.resize(N);
+
+	std::vector<size_t> idxs;
+	std::vector<float> dists_sq;
+	for (size_t i = 0; i < N; i++)
+	{
+		kdTreeNClosestPoint3DIdx(
+			m_x[i], m_y[i], m_z[i], std::min(knn, N), idxs, dists_sq);
+
+		// Covariance of the neighbors:
+		Eigen::Vector3d mean = Eigen::Vector3d::Zero();
+		for (const size_t j : idxs)
+			mean += Eigen::Vector3d(m_x[j], m_y[j], m_z[j]);
+		mean /= static_cast<double>(idxs.size());
+		Eigen::Matrix3d cov = Eigen::Matrix3d::Zero();
+		for (const size_t j : idxs)
+		{
+			const Eigen::Vector3d d =
+				Eigen::Vector3d(m_x[j], m_y[j], m_z[j]) - mean;
+			cov.noalias() += d * d.transpose();
+		}
+
+		// Eigenvalues are sorted in increasing order: the first eigenvector
+		// is the normal of the local plane.
+		const Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> es(cov);
+		const Eigen::Matrix3d V = es.eigenvectors();
+		const Eigen::Vector3d n = V.col(0);
+		m_localGeometry.normals[i] = TPoint3Df(n[0], n[1], n[2]);
+		const Eigen::Vector3d variances(TLocalGeometry::planeEpsilon, 1, 1);
+		m_localGeometry.covariances[i] =
+			(V * variances.asDiagonal() * V.transpose()).cast<float>();
+	}
+	m_localGeometry.updateCount++;
+	m_localGeometryIsUpdated = true;
+	return m_localGeometry;
+
+	MRPT_END
+}
+
 /*---------------------------------------------------------------
 				computeMatchingWith3D
 ---------------------------------------------------------------*/
@@ -1151,65 +1212,78 @@ void CPointsMap::determineMatching3D(
 		local_y_min > global_y_max || local_y_max < global_y_min)
 		return;  // No need to compute: matching is ZERO.
 
+	// KD-TREE implementation
+	// Use a KD-tree to look for the nearnest neighbor of each local point
+	// In "this" (global/reference) points map. The queries are independent,
+	// so they are split among threads if requested:
+	const size_t decim = params.decimation_other_map_points;
+	const size_t nQueries =
+		params.offset_other_map_points < nLocalPoints
+			? (nLocalPoints - params.offset_other_map_points - 1) / decim + 1
+			: 0;
+	std::vector<size_t> closest_idx(nQueries);
+	std::vector<float> closest_err_sq(nQueries);
+	const float* x_queries = x_locals.data() + params.offset_other_map_points;
+	const float* y_queries = y_locals.data() + params.offset_other_map_points;
+	const float* z_queries = z_locals.data() + params.offset_other_map_points;
+
+	kdTreeBuildIndex3D();
+	auto queryBlock = [&](const size_t first, const size_t last) {
+		kdTreeClosestPoints3D(
+			x_queries + first * decim, y_queries + first * decim,
+			z_queries + first * decim, last - first, decim,
+			closest_idx.data() + first, closest_err_sq.data() + first);
+	};
+	mrpt::system::parallel_for(nQueries, params.numThreads, queryBlock);
+
 	// Loop for each point in local map:
 	// --------------------------------------------------
-	for (unsigned int localIdx = params.offset_other_map_points;
-		 localIdx < nLocalPoints;
-		 localIdx += params.decimation_other_map_points)
+	for (size_t k = 0; k < nQueries; k++)
 	{
+		const size_t localIdx = params.offset_other_map_points + k * decim;
+
 		// For speed-up:
 		const float x_local = x_locals[localIdx];
 		const float y_local = y_locals[localIdx];
 		const float z_local = z_locals[localIdx];
 
-		{
-			// KD-TREE implementation
-			// Use a KD-tree to look for the nearnest neighbor of:
-			//   (x_local, y_local, z_local)
-			// In "this" (global/reference) points map.
+		const float tentativ_err_sq = closest_err_sq[k];
+		const size_t tentativ_this_idx = closest_idx[k];
 
-			float tentativ_err_sq;
-			const unsigned int tentativ_this_idx = kdTreeClosestPoint3D(
-				x_local, y_local, z_local,  // Look closest to this guy
-				tentativ_err_sq  // save here the min. distance squared
-			);
-
-			// Compute max. allowed distance:
-			maxDistForCorrespondenceSquared = square(
-				params.maxAngularDistForCorrespondence *
-					params.angularDistPivotPoint.distanceTo(
-						TPoint3D(x_local, y_local, z_local)) +
-				params.maxDistForCorrespondence);
-
-			// Distance below the threshold??
-			if (tentativ_err_sq < maxDistForCorrespondenceSquared)
-			{
-				// Save all the correspondences:
-				_correspondences.resize(_correspondences.size() + 1);
+		// Compute max. allowed distance:
+		maxDistForCorrespondenceSquared = square(
+			params.maxAngularDistForCorrespondence *
+				params.angularDistPivotPoint.distanceTo(
+					TPoint3D(x_local, y_local, z_local)) +
+			params.maxDistForCorrespondence);
 
-				TMatchingPair& p = _correspondences.back();
+		// Distance below the threshold??
+		if (tentativ_err_sq < maxDistForCorrespondenceSquared)
+		{
+			// Save all the correspondences:
+			_correspondences.resize(_correspondences.size() + 1);
 
-				p.this_idx = tentativ_this_idx;
-				p.this_x = m_x[tentativ_this_idx];
-				p.this_y = m_y[tentativ_this_idx];
-				p.this_z = m_z[tentativ_this_idx];
+			TMatchingPair& p = _correspondences.back();
 
-				p.other_idx = localIdx;
-				p.other_x = otherMap->m_x[localIdx];
-				p.other_y = otherMap->m_y[localIdx];
-				p.other_z = otherMap->m_z[localIdx];
+			p.this_idx = tentativ_this_idx;
+			p.this_x = m_x[tentativ_this_idx];
+			p.this_y = m_y[tentativ_this_idx];
+			p.this_z = m_z[tentativ_this_idx];
 
-				p.errorSquareAfterTransformation = tentativ_err_sq;
+			p.other_idx = localIdx;
+			p.other_x = otherMap->m_x[localIdx];
+			p.other_y = otherMap->m_y[localIdx];
+			p.other_z = otherMap->m_z[localIdx];
 
-				// At least one:
-				nOtherMapPointsWithCorrespondence++;
+			p.errorSquareAfterTransformation = tentativ_err_sq;
 
-				// Accumulate the MSE:
-				_sumSqrDist += p.errorSquareAfterTransformation;
-				_sumSqrCount++;
-			}
+			// At least one:
+			nOtherMapPointsWithCorrespondence++;
 
-		}  // End of test_match
+			// Accumulate the MSE:
+			_sumSqrDist += p.errorSquareAfterTransformation;
+			_sumSqrCount++;
+		}
 	}  // For each local point
 
 	// Additional consistency filter: "onlyKeepTheClosest" up to now
@@ -1702,7 +1776,7 @@ void CPointsMap::addFrom(const CPointsMap& anotherMap)
 	// Also copy other data fields (color, ...)
 	addFrom_classSpecific(anotherMap, nThis);
 
-	mark_as_modified();
+	mark_as_appended();
 }
 
 /** Save the point cloud as a PCL PCD file, in either ASCII or binary format
@@ -1796,7 +1870,7 @@ void CPointsMap::insertAnotherMap(
 	// Also copy other data fields (color, ...)
 	addFrom_classSpecific(*otherMap, N_this);
 
-	mark_as_modified();
+	mark_as_appended();
 }
 
 /** Helper method for ::copyFrom() */
@@ -1817,6 +1891,7 @@ void CPointsMap::base_copyFrom(const CPointsMap& obj)
 	// Fill missing fields (R,G,B,min_dist) with default values.
 	this->resize(m_x.size());
 
+	m_localGeometryIsUpdated = false;
 	kdtree_mark_as_outdated();
 
 	MRPT_END
@@ -1850,7 +1925,8 @@ bool CPointsMap::internal_insertObservation(
 		/********************************************************************
 					OBSERVATION TYPE: CObservation2DRangeScan
 		 ********************************************************************/
-		mark_as_modified();
+		// (Fusing with existing points marks the map as modified)
+		mark_as_appended();
 
 		const CObservation2DRangeScan* o =
 			static_cast<const CObservation2DRangeScan*>(obs);
@@ -1942,7 +2018,7 @@ bool CPointsMap::internal_insertObservation(
 		/********************************************************************
 					OBSERVATION TYPE: CObservation3DRangeScan
 		 ********************************************************************/
-		mark_as_modified();
+		mark_as_appended();
 
 		const CObservation3DRangeScan* o =
 			static_cast<const CObservation3DRangeScan*>(obs);
@@ -2008,7 +2084,7 @@ bool CPointsMap::internal_insertObservation(
 		/********************************************************************
 					OBSERVATION TYPE: CObservationRange  (IRs, Sonars, etc.)
 		 ********************************************************************/
-		mark_as_modified();
+		mark_as_appended();
 
 		const CObservationRange* o = static_cast<const CObservationRange*>(obs);
 
@@ -2053,7 +2129,7 @@ bool CPointsMap::internal_insertObservation(
 		/********************************************************************
 					OBSERVATION TYPE: CObservationVelodyneScan
 		 ********************************************************************/
-		mark_as_modified();
+		mark_as_appended();
 
 		const CObservationVelodyneScan* o =
 			static_cast<const CObservationVelodyneScan*>(obs);
@@ -2186,6 +2262,8 @@ void CPointsMap::fuseWith(
 			if (notFusedPoints) (*notFusedPoints).push_back(false);
 		}
 	}
+	// The kd-tree was used above, before changing the fused points:
+	mark_as_modified();
 }
 
 void CPointsMap::loadFromVelodyneScan(
@@ -2198,12 +2276,15 @@ void CPointsMap::loadFromVelodyneScan(
 
 	if (scan.point_cloud.x.empty()) return;
 
-	this->mark_as_modified();
-
 	// Insert vs. load and replace:
-	if (!insertionOptions.addToExistingPointsMap)
+	if (insertionOptions.addToExistingPointsMap)
+		this->mark_as_appended();
+	else
+	{
+		this->mark_as_modified();
 		resize(0);  // Resize to 0 instead of clear() so the std::vector<>
-	// memory is not actually deallocated and can be reused.
+		// memory is not actually deallocated and can be reused.
+	}
 
 	// Alloc space:
 	const size_t nOldPtsCount = this->size();
@@ -25,7 +25,11 @@ struct loadFromRangeImpl
 		using namespace mrpt::poses;
 		using mrpt::square;
 		using mrpt::DEG2RAD;
-		obj.mark_as_modified();
+		// New points are appended, or replace the existing ones:
+		if (obj.insertionOptions.addToExistingPointsMap)
+			obj.mark_as_appended();
+		else
+			obj.mark_as_modified();
 
 		// The next may seem useless, but it's required in case the observation
 		// underwent a move or copy operator, which may change the reserved mem
@@ -377,7 +381,11 @@ struct loadFromRangeImpl
 	{
 		using namespace mrpt::poses;
 		using mrpt::square;
-		obj.mark_as_modified();
+		// New points are appended, or replace the existing ones:
+		if (obj.insertionOptions.addToExistingPointsMap)
+			obj.mark_as_appended();
+		else
+			obj.mark_as_modified();
 
 		// If robot pose is supplied, compute sensor pose relative to it.
 		CPose3D sensorPose3D(UNINITIALIZED_POSE);
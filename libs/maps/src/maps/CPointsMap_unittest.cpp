@@ -11,7 +11,11 @@
 #include <mrpt/maps/CWeightedPointsMap.h>
 #include <mrpt/maps/CColouredPointsMap.h>
 #include <mrpt/poses/CPoint2D.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/random/RandomGenerators.h>
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <limits>
 
 using namespace mrpt;
 using namespace mrpt::maps;
@@ -184,3 +188,187 @@ TEST(CColouredPointsMapTests, clipOutOfRange)
 {
 	do_test_clipOutOfRange<CColouredPointsMap>();
 }
+
+TEST(CSimplePointsMapTests, determineMatchingMultiThreaded)
+{
+	// Two random clouds, so there are pairings and points without them:
+	mrpt::random::getRandomGenerator().randomize(1234);
+	CSimplePointsMap m1, m2;
+	for (int i = 0; i < 5000; i++)
+	{
+		auto& rng = mrpt::random::getRandomGenerator();
+		m1.insertPoint(
+			rng.drawUniform(-10.0f, 10.0f), rng.drawUniform(-10.0f, 10.0f),
+			rng.drawUniform(-1.0f, 1.0f));
+		m2.insertPoint(
+			rng.drawUniform(-12.0f, 12.0f), rng.drawUniform(-12.0f, 12.0f),
+			rng.drawUniform(-1.0f, 1.0f));
+	}
+
+	TMatchingParams params;
+	params.maxDistForCorrespondence = 0.15f;
+	params.maxAngularDistForCorrespondence = DEG2RAD(1.0f);
+	params.decimation_other_map_points = 3;
+	params.offset_other_map_points = 1;
+
+	for (const unsigned int nThreads : {2U, 3U, 0U})
+	{
+		for (const bool is3D : {false, true})
+		{
+			mrpt::tfest::TMatchingPairList corrs1, corrsN;
+			TMatchingExtraResults extra1, extraN;
+
+			params.numThreads = 1;
+			if (is3D)
+				m1.determineMatching3D(
+					&m2, CPose3D(0.1, -0.2, 0.05, 0.1, 0, 0), corrs1, params,
+					extra1);
+			else
+				m1.determineMatching2D(
+					&m2, CPose2D(0.1, -0.2, 0.1), corrs1, params, extra1);
+
+			params.numThreads = nThreads;
+			if (is3D)
+				m1.determineMatching3D(
+					&m2, CPose3D(0.1, -0.2, 0.05, 0.1, 0, 0), corrsN, params,
+					extraN);
+			else
+				m1.determineMatching2D(
+					&m2, CPose2D(0.1, -0.2, 0.1), corrsN, params, extraN);
+
+			EXPECT_GT(corrs1.size(), 10u);
+			// Same pairings, in the same order:
+			ASSERT_EQ(corrs1.size(), corrsN.size());
+			for (size_t i = 0; i < corrs1.size(); i++)
+			{
+				EXPECT_EQ(corrs1[i].this_idx, corrsN[i].this_idx);
+				EXPECT_EQ(corrs1[i].other_idx, corrsN[i].other_idx);
+				EXPECT_EQ(
+					corrs1[i].errorSquareAfterTransformation,
+					corrsN[i].errorSquareAfterTransformation);
+			}
+			EXPECT_EQ(extra1.sumSqrDist, extraN.sumSqrDist);
+			EXPECT_EQ(
+				extra1.correspondencesRatio, extraN.correspondencesRatio);
+		}
+	}
+}
+
+TEST(CSimplePointsMapTests, getLocalGeometry)
+{
+	// A tilted plane z = 0.5*x:
+	CSimplePointsMap pts;
+	for (int i = 0; i < 30; i++)
+		for (int j = 0; j < 30; j++)
+			pts.insertPoint(0.1f * i, 0.1f * j, 0.05f * i);
+	const float nx = -0.5f / std::sqrt(1.25f), nz = 1.0f / std::sqrt(1.25f);
+
+	const auto& geom = pts.getLocalGeometry(8);
+	ASSERT_EQ(geom.normals.size(), pts.size());
+	ASSERT_EQ(geom.covariances.size(), pts.size());
+	for (size_t i = 0; i < pts.size(); i++)
+	{
+		const auto& n = geom.normals[i];
+		const float sign = n.z > 0 ? 1.0f : -1.0f;
+		EXPECT_NEAR(sign * n.x, nx, 1e-4f);
+		EXPECT_NEAR(n.y, 0, 1e-4f);
+		EXPECT_NEAR(sign * n.z, nz, 1e-4f);
+
+		// The covariance has the small variance across the plane:
+		const Eigen::Vector3f nv(n.x, n.y, n.z);
+		EXPECT_NEAR(
+			nv.dot(geom.covariances[i] * nv),
+			CPointsMap::TLocalGeometry::planeEpsilon, 1e-5f);
+	}
+
+	// Recomputed after modifying the map:
+	pts.insertPoint(10, 10, 10);
+	EXPECT_EQ(pts.getLocalGeometry(8).normals.size(), pts.size());
+}
+
+TEST(CSimplePointsMapTests, kdTreeIncrementalInsertion)
+{
+	auto& rng = mrpt::random::getRandomGenerator();
+	rng.randomize(4321);
+
+	// Compares the kd-tree queries against a brute force search:
+	auto checkQueries = [&](const CSimplePointsMap& m) {
+		for (int q = 0; q < 20; q++)
+		{
+			const float x = rng.drawUniform(-6.0f, 6.0f),
+						y = rng.drawUniform(-6.0f, 6.0f),
+						z = rng.drawUniform(-1.0f, 1.0f);
+			float best2D = std::numeric_limits<float>::max(), best3D = best2D;
+			size_t nInRadius = 0;
+			for (size_t i = 0; i < m.size(); i++)
+			{
+				float px, py, pz;
+				m.getPoint(i, px, py, pz);
+				const float d2 = square(px - x) + square(py - y);
+				best2D = std::min(best2D, d2);
+				best3D = std::min(best3D, d2 + square(pz - z));
+				if (d2 + square(pz - z) < 0.5f) nInRadius++;
+			}
+
+			float dist2D, dist3D;
+			const size_t idx2D = m.kdTreeClosestPoint2D(x, y, dist2D);
+			const size_t idx3D = m.kdTreeClosestPoint3D(x, y, z, dist3D);
+			ASSERT_LT(idx2D, m.size());
+			ASSERT_LT(idx3D, m.size());
+			EXPECT_NEAR(dist2D, best2D, 1e-5f);
+			EXPECT_NEAR(dist3D, best3D, 1e-5f);
+
+			std::vector<std::pair<size_t, float>> inRadius;
+			EXPECT_EQ(
+				m.kdTreeRadiusSearch3D(x, y, z, 0.5f, inRadius), nInRadius);
+			for (size_t i = 1; i < inRadius.size(); i++)
+				EXPECT_LE(inRadius[i - 1].second, inRadius[i].second);
+		}
+	};
+
+	CSimplePointsMap m;
+	for (int step = 0; step < 40; step++)
+	{
+		// Append batches of different sizes, one by one or at once:
+		const int n = 1 + (step * 37) % 150;
+		if (step % 3)
+			for (int i = 0; i < n; i++)
+				m.insertPoint(
+					rng.drawUniform(-5.0f, 5.0f), rng.drawUniform(-5.0f, 5.0f),
+					rng.drawUniform(-1.0f, 1.0f));
+		else
+		{
+			CSimplePointsMap other;
+			for (int i = 0; i < n; i++)
+				other.insertPoint(
+					rng.drawUniform(-5.0f, 5.0f), rng.drawUniform(-5.0f, 5.0f),
+					rng.drawUniform(-1.0f, 1.0f));
+			m.insertAnotherMap(&other, CPose3D(0.5, -0.5, 0, 0.3, 0, 0));
+		}
+		checkQueries(m);
+
+		// Changes which are not appends must rebuild the index:
+		if (step == 20)
+		{
+			m.setPoint(0, 5.5f, 5.5f, 0.0f);
+			checkQueries(m);
+			m.resize(m.size() / 2);
+			checkQueries(m);
+		}
+	}
+}
+
+TEST(CSimplePointsMapTests, kdTreeAfterGrowingResize)
+{
+	// Growing resize() and then overwriting old points, as done by the 3D
+	// projection of depth images, must not keep the old points in the kd-tree:
+	CSimplePointsMap m;
+	for (int i = 0; i < 100; i++) m.insertPoint(i, 0, 0);
+	float dist;
+	EXPECT_EQ(m.kdTreeClosestPoint3D(50, 10, 0, dist), 50U);
+
+	m.resize(200);
+	for (size_t i = 0; i < m.size(); i++) m.setPointFast(i, i, 20, 0);
+	EXPECT_EQ(m.kdTreeClosestPoint3D(50, 10, 0, dist), 50U);
+	EXPECT_NEAR(dist, 100, 1e-4);
+}
@@ -0,0 +1,861 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "maps-precomp.h"  // Precomp header
+
+#include <mrpt/maps/CTiledOccupancyGridMap2D.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/obs/CObservation2DRangeScan.h>
+#include <mrpt/poses/CPose2D.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/random.h>
+#include <mrpt/io/zip.h>
+#include <mrpt/core/round.h>  // round()
+#include <mrpt/serialization/CArchive.h>
+#include <mrpt/opengl/CSetOfObjects.h>
+#include <cstring>  // memcpy
+
+using namespace mrpt;
+using namespace mrpt::maps;
+using namespace mrpt::obs;
+using namespace mrpt::poses;
+using namespace mrpt::math;
+using namespace mrpt::random;
+using namespace mrpt::img;
+using namespace std;
+
+//  =========== Begin of Map definition ============
+MAP_DEFINITION_REGISTER(
+	"CTiledOccupancyGridMap2D,tiledOccupancyGrid",
+	mrpt::maps::CTiledOccupancyGridMap2D)
+
+CTiledOccupancyGridMap2D::TMapDefinition::TMapDefinition() : resolution(0.05f)
+{
+}
+
+void CTiledOccupancyGridMap2D::TMapDefinition::loadFromConfigFile_map_specific(
+	const mrpt::config::CConfigFileBase& source,
+	const std::string& sectionNamePrefix)
+{
+	// [<sectionNamePrefix>+"_creationOpts"]
+	const std::string sSectCreation =
+		sectionNamePrefix + string("_creationOpts");
+	MRPT_LOAD_CONFIG_VAR(resolution, float, source, sSectCreation);
+
+	insertionOpts.loadFromConfigFile(
+		source, sectionNamePrefix + string("_insertOpts"));
+	likelihoodOpts.loadFromConfigFile(
+		source, sectionNamePrefix + string("_likelihoodOpts"));
+}
+
+void CTiledOccupancyGridMap2D::TMapDefinition::dumpToTextStream_map_specific(
+	std::ostream& out) const
+{
+	LOADABLEOPTS_DUMP_VAR(resolution, float);
+
+	this->insertionOpts.dumpToTextStream(out);
+	this->likelihoodOpts.dumpToTextStream(out);
+}
+
+mrpt::maps::CMetricMap*
+	CTiledOccupancyGridMap2D::internal_CreateFromMapDefinition(
+		const mrpt::maps::TMetricMapInitializer& _def)
+{
+	const CTiledOccupancyGridMap2D::TMapDefinition& def =
+		*dynamic_cast<const CTiledOccupancyGridMap2D::TMapDefinition*>(&_def);
+	CTiledOccupancyGridMap2D* obj =
+		new CTiledOccupancyGridMap2D(def.resolution);
+	obj->insertionOptions = def.insertionOpts;
+	obj->likelihoodOptions = def.likelihoodOpts;
+	return obj;
+}
+//  =========== End of Map definition Block =========
+
+IMPLEMENTS_SERIALIZABLE(CTiledOccupancyGridMap2D, CMetricMap, mrpt::maps)
+
+static const size_t TILE_CELLS = CTiledOccupancyGridMap2D::TILE_SIZE *
+								 CTiledOccupancyGridMap2D::TILE_SIZE;
+
+CTiledOccupancyGridMap2D::CTiledOccupancyGridMap2D(float resolution)
+	: m_resolution(resolution)
+{
+	ASSERT_(resolution > 0);
+}
+
+void CTiledOccupancyGridMap2D::setResolution(float resolution)
+{
+	ASSERT_(resolution > 0);
+	m_resolution = resolution;
+	internal_clear();
+}
+
+void CTiledOccupancyGridMap2D::internal_clear()
+{
+	m_tiles.clear();
+	m_missingTilesLogLik.clear();
+}
+bool CTiledOccupancyGridMap2D::isEmpty() const { return m_tiles.empty(); }
+/*---------------------------------------------------------------
+						Tiles management
+ ---------------------------------------------------------------*/
+void CTiledOccupancyGridMap2D::decompressTile(TTile& tile) const
+{
+	if (tile.compressed.empty()) return;
+
+	tile.cells.resize(TILE_CELLS);
+	size_t actualSize = 0;
+	mrpt::io::zip::decompress(
+		&tile.compressed[0], tile.compressed.size(), &tile.cells[0],
+		sizeof(cellType) * TILE_CELLS, actualSize);
+	ASSERT_EQUAL_(actualSize, sizeof(cellType) * TILE_CELLS);
+	tile.compressed = std::vector<uint8_t>();  // Free memory
+}
+
+CTiledOccupancyGridMap2D::cellType* CTiledOccupancyGridMap2D::getTileCells(
+	int tx, int ty, bool create) const
+{
+	const uint64_t key = tileKey(tx, ty);
+	auto it = m_tiles.find(key);
+	if (it == m_tiles.end())
+	{
+		if (!create) return nullptr;
+		it = m_tiles.emplace(key, TTile()).first;
+		it->second.cells.assign(TILE_CELLS, COccupancyGridMap2D::p2l(0.5f));
+	}
+	TTile& tile = it->second;
+	decompressTile(tile);
+	tile.lastAccess = m_accessCounter;
+	return &tile.cells[0];
+}
+
+CTiledOccupancyGridMap2D::cellType CTiledOccupancyGridMap2D::getCellLogOdds(
+	int cx, int cy) const
+{
+	const cellType* cells =
+		getTileCells(cx >> TILE_BITS, cy >> TILE_BITS, false);
+	if (!cells) return COccupancyGridMap2D::p2l(0.5f);
+	return cells
+		[(cx & (TILE_SIZE - 1)) + ((cy & (TILE_SIZE - 1)) << TILE_BITS)];
+}
+
+void CTiledOccupancyGridMap2D::setCell(int cx, int cy, float value)
+{
+	cellType* cells = getTileCells(cx >> TILE_BITS, cy >> TILE_BITS, true);
+	cells[(cx & (TILE_SIZE - 1)) + ((cy & (TILE_SIZE - 1)) << TILE_BITS)] =
+		COccupancyGridMap2D::p2l(value);
+	invalidateLikelihoodField(cx, cx, cy, cy);
+}
+
+size_t CTiledOccupancyGridMap2D::getCompressedTileCount() const
+{
+	size_t n = 0;
+	for (const auto& t : m_tiles)
+		if (!t.second.compressed.empty()) n++;
+	return n;
+}
+
+size_t CTiledOccupancyGridMap2D::getMemoryUsage() const
+{
+	size_t n = 0;
+	for (const auto& t : m_tiles)
+		n += sizeof(TTile) + t.second.cells.capacity() * sizeof(cellType) +
+			 t.second.compressed.capacity() +
+			 t.second.logLik.capacity() * sizeof(float);
+	return n;
+}
+
+bool CTiledOccupancyGridMap2D::getBoundingBox(
+	int& cx0, int& cx1, int& cy0, int& cy1) const
+{
+	if (m_tiles.empty()) return false;
+	int tx0 = std::numeric_limits<int>::max(), ty0 = tx0;
+	int tx1 = std::numeric_limits<int>::min(), ty1 = tx1;
+	for (const auto& t : m_tiles)
+	{
+		keep_min(tx0, tileKeyX(t.first));
+		keep_max(tx1, tileKeyX(t.first));
+		keep_min(ty0, tileKeyY(t.first));
+		keep_max(ty1, tileKeyY(t.first));
+	}
+	cx0 = tx0 * TILE_SIZE;
+	cx1 = (tx1 + 1) * TILE_SIZE - 1;
+	cy0 = ty0 * TILE_SIZE;
+	cy1 = (ty1 + 1) * TILE_SIZE - 1;
+	return true;
+}
+
+size_t CTiledOccupancyGridMap2D::compressColdTiles(unsigned int maxAge)
+{
+	MRPT_START
+
+	size_t n = 0;
+	for (auto& t : m_tiles)
+	{
+		TTile& tile = t.second;
+		if (!tile.compressed.empty()) continue;
+		if (maxAge && tile.lastAccess + maxAge > m_accessCounter) continue;
+
+		mrpt::io::zip::compress(
+			&tile.cells[0], sizeof(cellType) * tile.cells.size(),
+			tile.compressed);
+		// zip::compress() leaves room for the worst case:
+		tile.compressed.shrink_to_fit();
+		tile.cells = std::vector<cellType>();  // Free memory
+		tile.logLik = std::vector<float>();
+		n++;
+	}
+	return n;
+
+	MRPT_END
+}
+
+void CTiledOccupancyGridMap2D::copyCells(
+	int cx0, int cy0, int w, int h, cellType* out, size_t stride) const
+{
+	const cellType unknown = COccupancyGridMap2D::p2l(0.5f);
+	for (int ty = cy0 >> TILE_BITS; ty <= (cy0 + h - 1) >> TILE_BITS; ty++)
+	{
+		const int y0 = max(cy0, ty * TILE_SIZE);
+		const int y1 = min(cy0 + h - 1, (ty + 1) * TILE_SIZE - 1);
+		for (int tx = cx0 >> TILE_BITS; tx <= (cx0 + w - 1) >> TILE_BITS;
+			 tx++)
+		{
+			const int x0 = max(cx0, tx * TILE_SIZE);
+			const int x1 = min(cx0 + w - 1, (tx + 1) * TILE_SIZE - 1);
+			const cellType* cells = getTileCells(tx, ty, false);
+			for (int y = y0; y <= y1; y++)
+			{
+				cellType* trg = out + (y - cy0) * stride + (x0 - cx0);
+				if (!cells)
+					std::fill(trg, trg + (x1 - x0 + 1), unknown);
+				else
+					std::memcpy(
+						trg,
+						cells + (x0 - tx * TILE_SIZE) +
+							((y - ty * TILE_SIZE) << TILE_BITS),
+						sizeof(cellType) * (x1 - x0 + 1));
+			}
+		}
+	}
+}
+
+/*---------------------------------------------------------------
+						Conversions
+ ---------------------------------------------------------------*/
+void CTiledOccupancyGridMap2D::getAsDenseGrid(COccupancyGridMap2D& out) const
+{
+	int cx0, cx1, cy0, cy1;
+	if (!getBoundingBox(cx0, cx1, cy0, cy1))
+		cx0 = cy0 = -TILE_SIZE, cx1 = cy1 = TILE_SIZE - 1;
+	getAsDenseGrid(out, cx0, cx1, cy0, cy1);
+}
+
+void CTiledOccupancyGridMap2D::getAsDenseGrid(
+	COccupancyGridMap2D& out, int cx0, int cx1, int cy0, int cy1) const
+{
+	MRPT_START
+	ASSERT_(cx1 >= cx0 && cy1 >= cy0);
+
+	out.setSize(
+		cx0 * m_resolution, (cx1 + 1) * m_resolution, cy0 * m_resolution,
+		(cy1 + 1) * m_resolution, m_resolution);
+	out.insertionOptions = insertionOptions;
+	out.likelihoodOptions = likelihoodOptions;
+	out.genericMapParams = genericMapParams;
+
+	// The dense grid may have some more columns (see ROWSIZE_MULTIPLE_16):
+	copyCells(
+		cx0, cy0, out.size_x, out.size_y, &out.map[0], out.size_x);
+	out.m_is_empty = isEmpty();
+
+	MRPT_END
+}
+
+void CTiledOccupancyGridMap2D::loadFromDenseGrid(
+	const COccupancyGridMap2D& grid)
+{
+	MRPT_START
+
+	setResolution(grid.getResolution());
+	insertionOptions = grid.insertionOptions;
+	likelihoodOptions = grid.likelihoodOptions;
+	genericMapParams = grid.genericMapParams;
+
+	const cellType unknown = COccupancyGridMap2D::p2l(0.5f);
+	const int size_x = grid.getSizeX(), size_y = grid.getSizeY();
+	// Global index of the dense cell (0,0):
+	const int cx0 = x2idx(grid.idx2x(0)), cy0 = y2idx(grid.idx2y(0));
+
+	for (int y = 0; y < size_y; y++)
+	{
+		const cellType* row = grid.getRow(y);
+		for (int x = 0; x < size_x; x++)
+		{
+			if (row[x] == unknown) continue;
+			const int cx = cx0 + x, cy = cy0 + y;
+			cellType* cells =
+				getTileCells(cx >> TILE_BITS, cy >> TILE_BITS, true);
+			cells
+				[(cx & (TILE_SIZE - 1)) + ((cy & (TILE_SIZE - 1)) << TILE_BITS)] =
+					row[x];
+		}
+	}
+
+	MRPT_END
+}
+
+void CTiledOccupancyGridMap2D::getAsImage(
+	CImage& img, bool verticalFlip, bool forceRGB) const
+{
+	int cx0, cx1, cy0, cy1;
+	if (!getBoundingBox(cx0, cx1, cy0, cy1))
+	{
+		img.resize(1, 1, forceRGB ? 3 : 1, true);
+		return;
+	}
+	const int w = cx1 - cx0 + 1, h = cy1 - cy0 + 1;
+	const int nCh = forceRGB ? 3 : 1;
+	img.resize(w, h, nCh, true);
+
+	std::vector<cellType> row(w);
+	for (int y = 0; y < h; y++)
+	{
+		copyCells(cx0, cy0 + y, w, 1, &row[0], w);
+		unsigned char* destPtr = verticalFlip ? img(0, y) : img(0, h - 1 - y);
+		for (int x = 0; x < w; x++)
+		{
+			const uint8_t c = COccupancyGridMap2D::l2p_255(row[x]);
+			for (int ch = 0; ch < nCh; ch++) *destPtr++ = c;
+		}
+	}
+}
+
+void CTiledOccupancyGridMap2D::getAs3DObject(
+	mrpt::opengl::CSetOfObjects::Ptr& outObj) const
+{
+	if (!genericMapParams.enableSaveAs3DObject) return;
+
+	COccupancyGridMap2D grid;
+	getAsDenseGrid(grid);
+	grid.getAs3DObject(outObj);
+}
+
+void CTiledOccupancyGridMap2D::saveMetricMapRepresentationToFile(
+	const std::string& filNamePrefix) const
+{
+	CImage img;
+	getAsImage(img);
+	img.saveToFile(filNamePrefix + std::string("_gridmap.png"));
+}
+
+float CTiledOccupancyGridMap2D::compute3DMatchingRatio(
+	const mrpt::maps::CMetricMap* otherMap,
+	const mrpt::poses::CPose3D& otherMapPose,
+	const TMatchingRatioParams& params) const
+{
+	MRPT_UNUSED_PARAM(otherMap);
+	MRPT_UNUSED_PARAM(otherMapPose);
+	MRPT_UNUSED_PARAM(params);
+	return 0;
+}
+
+/*---------------------------------------------------------------
+					insertObservation
+ ---------------------------------------------------------------*/
+bool CTiledOccupancyGridMap2D::internal_insertObservation(
+	const CObservation* obs, const CPose3D* robotPose)
+{
+	MRPT_START
+
+	if (!IS_CLASS(obs, CObservation2DRangeScan)) return false;
+	const CObservation2DRangeScan* o =
+		static_cast<const CObservation2DRangeScan*>(obs);
+
+	const CPose3D sensorPose3D =
+		(robotPose ? *robotPose : CPose3D()) + o->sensorPose;
+	const CPose2D laserPose(sensorPose3D);
+
+	// Insert only HORIZONTAL scans, at the altitude of the map (if enabled):
+	if (!o->isPlanarScan(insertionOptions.horizontalTolerance)) return false;
+	if (insertionOptions.useMapAltitude &&
+		fabs(insertionOptions.mapAltitude - sensorPose3D.z()) > 0.001)
+		return false;
+
+	m_accessCounter++;
+
+	// Same log-odds update values than in COccupancyGridMap2D:
+	const COccupancyGridMap2D::TInsertionLogOdds logodds(insertionOptions);
+
+	// Manage horizontal scans, but with the sensor bottom-up:
+	const bool sensorIsBottomwards =
+		sensorPose3D.getHomogeneousMatrixVal<CMatrixDouble44>().get_unsafe(
+			2, 2) < 0;
+
+	const float maxDistanceInsertion = insertionOptions.maxDistanceInsertion;
+	const bool invalidAsFree =
+		insertionOptions.considerInvalidRangesAsFreeSpace;
+	const size_t K = std::max<size_t>(1, insertionOptions.decimation);
+	const size_t nRanges = o->scan.size();
+	const int N = static_cast<int>(nRanges);
+
+	double A, dAK;
+	if (o->rightToLeft ^ sensorIsBottomwards)
+	{
+		A = laserPose.phi() - 0.5 * o->aperture;
+		dAK = K * o->aperture / N;
+	}
+	else
+	{
+		A = laserPose.phi() + 0.5 * o->aperture;
+		dAK = -K * o->aperture / N;
+	}
+
+	const float px = laserPose.x();
+	const float py = laserPose.y();
+	const int cx0 = x2idx(px), cy0 = y2idx(py);
+	int bbox_x0 = cx0, bbox_x1 = cx0, bbox_y0 = cy0, bbox_y1 = cy0;
+
+	// Cache of the last used tile:
+	int cur_tx = 0, cur_ty = 0;
+	cellType* cur_cells = nullptr;
+	auto cellPtr = [&](const int cx, const int cy) -> cellType* {
+		const int tx = cx >> TILE_BITS, ty = cy >> TILE_BITS;
+		if (!cur_cells || tx != cur_tx || ty != cur_ty)
+		{
+			cur_cells = getTileCells(tx, ty, true);
+			cur_tx = tx;
+			cur_ty = ty;
+		}
+		return cur_cells +
+			   ((cx & (TILE_SIZE - 1)) + ((cy & (TILE_SIZE - 1)) << TILE_BITS));
+	};
+
+	float last_valid_range = maxDistanceInsertion;
+	for (size_t idx = 0; idx < nRanges; idx += K, A += dAK)
+	{
+		const bool valid = o->validRange[idx];
+		float R;
+		if (valid)
+		{
+			R = min(maxDistanceInsertion, o->scan[idx]);
+			last_valid_range = o->scan[idx];
+		}
+		else if (invalidAsFree)
+			R = min(maxDistanceInsertion, 0.5f * last_valid_range);
+		else
+			continue;
+
+		// Target, in cell indexes:
+		const float trg_x = px + cos(A) * R;
+		const float trg_y = py + sin(A) * R;
+		const int trg_cx = x2idx(trg_x);
+		const int trg_cy = y2idx(trg_y);
+		keep_min(bbox_x0, trg_cx);
+		keep_max(bbox_x1, trg_cx);
+		keep_min(bbox_y0, trg_cy);
+		keep_max(bbox_y1, trg_cy);
+
+		if (trg_cx == cx0 && trg_cy == cy0) continue;  // May be...
+
+		// Same ray tracing than in COccupancyGridMap2D:
+		const cellType logodd_free =
+			valid ? logodds.observation_free : logodds.noecho_free;
+		COccupancyGridMap2D::traceRay(
+			cx0, cy0, trg_cx, trg_cy, [&](const int cx, const int cy) {
+				COccupancyGridMap2D::updateCell_fast_free(
+					cellPtr(cx, cy), logodd_free, logodds.thres_free);
+			});
+
+		// And finally, the occupied cell at the end, if the ray was valid and
+		// not truncated:
+		if (valid && o->scan[idx] < maxDistanceInsertion)
+			COccupancyGridMap2D::updateCell_fast_occupied(
+				cellPtr(trg_cx, trg_cy), logodds.observation_occupied,
+				logodds.thres_occupied);
+	}
+
+	invalidateLikelihoodField(bbox_x0, bbox_x1, bbox_y0, bbox_y1);
+
+	return true;
+
+	MRPT_END
+}
+
+/*---------------------------------------------------------------
+						Likelihood field
+ ---------------------------------------------------------------*/
+void CTiledOccupancyGridMap2D::invalidateLikelihoodField(
+	int cx0, int cx1, int cy0, int cy1)
+{
+	// Cells up to K cells away are affected:
+	const int K =
+		1 + (int)ceil(likelihoodOptions.LF_maxCorrsDistance / m_resolution);
+	for (int ty = (cy0 - K) >> TILE_BITS; ty <= (cy1 + K) >> TILE_BITS; ty++)
+		for (int tx = (cx0 - K) >> TILE_BITS; tx <= (cx1 + K) >> TILE_BITS;
+			 tx++)
+		{
+			auto it = m_tiles.find(tileKey(tx, ty));
+			if (it != m_tiles.end())
+				it->second.logLik.clear();
+			else
+				m_missingTilesLogLik.erase(tileKey(tx, ty));
+		}
+}
+
+bool CTiledOccupancyGridMap2D::hasTilesAround(int tx, int ty) const
+{
+	const int K =
+		1 + (int)ceil(likelihoodOptions.LF_maxCorrsDistance / m_resolution);
+	const int cx0 = tx * TILE_SIZE - K, cx1 = (tx + 1) * TILE_SIZE - 1 + K;
+	const int cy0 = ty * TILE_SIZE - K, cy1 = (ty + 1) * TILE_SIZE - 1 + K;
+	for (int y = cy0 >> TILE_BITS; y <= cy1 >> TILE_BITS; y++)
+		for (int x = cx0 >> TILE_BITS; x <= cx1 >> TILE_BITS; x++)
+			if (m_tiles.count(tileKey(x, y))) return true;
+	return false;
+}
+
+void CTiledOccupancyGridMap2D::computeTileLikelihoodField(
+	int tx, int ty, std::vector<float>& logLik)
+{
+	// From a dense grid with the tile plus a margin with all the cells which
+	// may affect it:
+	const int K =
+		1 + (int)ceil(likelihoodOptions.LF_maxCorrsDistance / m_resolution);
+	const int x0 = tx * TILE_SIZE, y0 = ty * TILE_SIZE;
+
+	COccupancyGridMap2D patch;
+	getAsDenseGrid(
+		patch, x0 - K, x0 + TILE_SIZE - 1 + K, y0 - K, y0 + TILE_SIZE - 1 + K);
+	patch.updateLikelihoodField();
+
+	logLik.resize(TILE_CELLS);
+	for (int y = 0; y < TILE_SIZE; y++)
+		std::memcpy(
+			&logLik[y << TILE_BITS],
+			&patch.m_likelihoodField[K + (y + K) * patch.size_x],
+			sizeof(float) * TILE_SIZE);
+}
+
+float CTiledOccupancyGridMap2D::cellLogLikelihood(int cx, int cy)
+{
+	const int tx = cx >> TILE_BITS, ty = cy >> TILE_BITS;
+	const uint64_t key = tileKey(tx, ty);
+
+	std::vector<float>* logLik;
+	auto it = m_tiles.find(key);
+	if (it != m_tiles.end())
+		logLik = &it->second.logLik;
+	else
+	{
+		// Unknown cells are not obstacles, so a missing tile is far from any
+		// obstacle unless there are other tiles near it:
+		auto itMissing = m_missingTilesLogLik.find(key);
+		if (itMissing != m_missingTilesLogLik.end())
+			logLik = &itMissing->second;
+		else if (!hasTilesAround(tx, ty))
+			return m_farLogLikelihood;
+		else
+			logLik = &m_missingTilesLogLik[key];
+	}
+	if (logLik->empty()) computeTileLikelihoodField(tx, ty, *logLik);
+	return (*logLik)
+		[(cx & (TILE_SIZE - 1)) + ((cy & (TILE_SIZE - 1)) << TILE_BITS)];
+}
+
+double CTiledOccupancyGridMap2D::computeLikelihoodField_Thrun(
+	const CPointsMap* pm, const CPose2D& relativePose)
+{
+	MRPT_START
+
+	const size_t N = pm->size();
+	if (!N) return -100;  // No way to estimate this likelihood!!
+
+	m_accessCounter++;
+
+	// Drop all the cached values if the model parameters changed:
+	const std::array<float, 6> params = {
+		{likelihoodOptions.LF_stdHit, likelihoodOptions.LF_zHit,
+		 likelihoodOptions.LF_zRandom, likelihoodOptions.LF_maxRange,
+		 likelihoodOptions.LF_maxCorrsDistance,
+		 likelihoodOptions.LF_useSquareDist ? 1.0f : 0.0f}};
+	if (params != m_likelihoodFieldParams)
+	{
+		for (auto& t : m_tiles) t.second.logLik.clear();
+		m_missingTilesLogLik.clear();
+		m_likelihoodFieldParams = params;
+
+		// The likelihood of a cell in a grid without obstacles:
+		COccupancyGridMap2D empty;
+		empty.setSize(0, m_resolution, 0, m_resolution, m_resolution);
+		empty.likelihoodOptions = likelihoodOptions;
+		empty.updateLikelihoodField();
+		m_farLogLikelihood = empty.m_likelihoodField[0];
+	}
+
+	const bool Product_T_OrSum_F = !likelihoodOptions.LF_alternateAverageMethod;
+	size_t decimation = likelihoodOptions.LF_decimation;
+	if (N < 10 || !decimation) decimation = 1;
+
+	const double ccos = cos(relativePose.phi());
+	const double ssin = sin(relativePose.phi());
+	const auto& xs = pm->getPointsBufferRef_x();
+	const auto& ys = pm->getPointsBufferRef_y();
+
+	double ret = 0;
+	size_t M = 0;
+	for (size_t j = 0; j < N; j += decimation)
+	{
+		const double gx = relativePose.x() + xs[j] * ccos - ys[j] * ssin;
+		const double gy = relativePose.y() + xs[j] * ssin + ys[j] * ccos;
+		const float logLik = cellLogLikelihood(x2idx(gx), y2idx(gy));
+		if (Product_T_OrSum_F)
+			ret += logLik;
+		else
+		{
+			ret += exp(logLik);
+			M++;
+		}
+	}
+	if (!Product_T_OrSum_F) ret = log(ret / M);
+
+	return ret;
+
+	MRPT_END
+}
+
+double CTiledOccupancyGridMap2D::internal_computeObservationLikelihood(
+	const CObservation* obs, const CPose3D& takenFrom)
+{
+	MRPT_START
+
+	if (!internal_canComputeObservationLikelihood(obs)) return -10;
+	const CObservation2DRangeScan* o =
+		static_cast<const CObservation2DRangeScan*>(obs);
+
+	// Same points than in COccupancyGridMap2D:
+	CPointsMap::TInsertionOptions opts;
+	opts.minDistBetweenLaserPoints = m_resolution * 0.5f;
+	opts.isPlanarMap = true;  // Already filtered above!
+	opts.horizontalTolerance = insertionOptions.horizontalTolerance;
+
+	return computeLikelihoodField_Thrun(
+		o->buildAuxPointsMap<mrpt::maps::CPointsMap>(&opts),
+		CPose2D(takenFrom));
+
+	MRPT_END
+}
+
+bool CTiledOccupancyGridMap2D::internal_canComputeObservationLikelihood(
+	const mrpt::obs::CObservation* obs) const
+{
+	// Only planar laser scans at the altitude of this grid map:
+	if (!IS_CLASS(obs, CObservation2DRangeScan)) return false;
+	const CObservation2DRangeScan* scan =
+		static_cast<const CObservation2DRangeScan*>(obs);
+	if (!scan->isPlanarScan(insertionOptions.horizontalTolerance))
+		return false;
+	if (insertionOptions.useMapAltitude &&
+		fabs(insertionOptions.mapAltitude - scan->sensorPose.z()) > 0.01)
+		return false;
+	return true;
+}
+
+/*---------------------------------------------------------------
+						Simulation
+ ---------------------------------------------------------------*/
+void CTiledOccupancyGridMap2D::laserScanSimulator(
+	CObservation2DRangeScan& inout_Scan, const CPose2D& robotPose,
+	float threshold, size_t N, float noiseStd, unsigned int decimation,
+	float angleNoiseStd) const
+{
+	MRPT_START
+
+	ASSERT_(decimation >= 1);
+	ASSERT_(N >= 2);
+
+	// Sensor pose in global coordinates
+	const CPose2D sensorPose(CPose3D(robotPose) + inout_Scan.sensorPose);
+
+	inout_Scan.resizeScan(N);
+
+	double A = sensorPose.phi() +
+			   (inout_Scan.rightToLeft ? -0.5 : +0.5) * inout_Scan.aperture;
+	const double AA =
+		(inout_Scan.rightToLeft ? 1.0 : -1.0) * (inout_Scan.aperture / (N - 1));
+
+	const float free_thres = 1.0f - threshold;
+
+	for (size_t i = 0; i < N; i += decimation, A += AA * decimation)
+	{
+		bool valid;
+		float out_range;
+		simulateScanRay(
+			sensorPose.x(), sensorPose.y(), A, out_range, valid,
+			inout_Scan.maxRange, free_thres, noiseStd, angleNoiseStd);
+		inout_Scan.setScanRange(i, out_range);
+		inout_Scan.setScanRangeValidity(i, valid);
+	}
+
+	MRPT_END
+}
+
+void CTiledOccupancyGridMap2D::simulateScanRay(
+	const double start_x, const double start_y, const double angle_direction,
+	float& out_range, bool& out_valid, const double max_range_meters,
+	const float threshold_free, const double noiseStd,
+	const double angleNoiseStd) const
+{
+	const double A_ =
+		angle_direction +
+		(angleNoiseStd > .0
+			 ? getRandomGenerator().drawGaussian1D_normalized() * angleNoiseStd
+			 : .0);
+	const double Arx = cos(A_);
+	const double Ary = sin(A_);
+
+	// Ray tracing, until collision, out of the map or out of range:
+	const double step = COccupancyGridMap2D::RAYTRACE_STEP_SIZE_IN_CELL_UNITS;
+	const unsigned int max_ray_len = mrpt::round(max_range_meters / m_resolution);
+	unsigned int ray_len = 0;
+
+	// Use integers for all ray tracing for efficiency
+	const int INTPRECNUMBIT = 10;
+	int64_t rxi =
+		static_cast<int64_t>((start_x / m_resolution) * (1L << INTPRECNUMBIT));
+	int64_t ryi =
+		static_cast<int64_t>((start_y / m_resolution) * (1L << INTPRECNUMBIT));
+	const int64_t Arxi =
+		static_cast<int64_t>(step * Arx * (1L << INTPRECNUMBIT));
+	const int64_t Aryi =
+		static_cast<int64_t>(step * Ary * (1L << INTPRECNUMBIT));
+
+	const cellType threshold_free_int = COccupancyGridMap2D::p2l(threshold_free);
+	cellType hitCellOcc_int = 0;  // p2l(0.5f)
+
+	// Cache of the last used tile:
+	int cur_tx = 0, cur_ty = 0;
+	const cellType* cur_cells = nullptr;
+	bool outOfMap = false;
+	for (;;)
+	{
+		const int x = static_cast<int>(rxi >> INTPRECNUMBIT);
+		const int y = static_cast<int>(ryi >> INTPRECNUMBIT);
+		const int tx = x >> TILE_BITS, ty = y >> TILE_BITS;
+		if (!cur_cells || tx != cur_tx || ty != cur_ty)
+		{
+			cur_cells = getTileCells(tx, ty, false);
+			cur_tx = tx;
+			cur_ty = ty;
+			// Non-existing tiles are unknown space: the end of the map.
+			if (!cur_cells)
+			{
+				outOfMap = true;
+				break;
+			}
+		}
+		hitCellOcc_int = cur_cells
+			[(x & (TILE_SIZE - 1)) + ((y & (TILE_SIZE - 1)) << TILE_BITS)];
+		if (hitCellOcc_int <= threshold_free_int || ray_len >= max_ray_len)
+			break;
+
+		rxi += Arxi;
+		ryi += Aryi;
+		ray_len++;
+	}
+
+	if (outOfMap || abs(hitCellOcc_int) <= 1)
+	{
+		out_valid = false;
+		out_range = max_range_meters;
+	}
+	else
+	{  // No: The normal case:
+		out_range = step * ray_len * m_resolution;
+		out_valid = (ray_len < max_ray_len);
+		// Add additive Gaussian noise:
+		if (noiseStd > 0 && out_valid)
+			out_range +=
+				noiseStd * getRandomGenerator().drawGaussian1D_normalized();
+	}
+}
+
+/*---------------------------------------------------------------
+						Serialization
+ ---------------------------------------------------------------*/
+uint8_t CTiledOccupancyGridMap2D::serializeGetVersion() const { return 1; }
+void CTiledOccupancyGridMap2D::serializeTo(
+	mrpt::serialization::CArchive& out) const
+{
+#ifdef OCCUPANCY_GRIDMAP_CELL_SIZE_8BITS
+	out << uint8_t(8);
+#else
+	out << uint8_t(16);
+#endif
+	out << m_resolution << genericMapParams;
+	out << static_cast<uint32_t>(m_tiles.size());
+
+	std::vector<cellType> cells;
+	for (const auto& t : m_tiles)
+	{
+		out << static_cast<int32_t>(tileKeyX(t.first))
+			<< static_cast<int32_t>(tileKeyY(t.first));
+		// Save them uncompressed, without modifying the in-memory tile:
+		TTile tile = t.second;
+		decompressTile(tile);
+		out.WriteBufferFixEndianness(&tile.cells[0], TILE_CELLS);
+	}
+
+	// Version 1:
+	insertionOptions.writeToStream(out);
+	likelihoodOptions.writeToStream(out);
+}
+
+void CTiledOccupancyGridMap2D::serializeFrom(
+	mrpt::serialization::CArchive& in, uint8_t version)
+{
+	switch (version)
+	{
+		case 0:
+		case 1:
+		{
+#ifdef OCCUPANCY_GRIDMAP_CELL_SIZE_8BITS
+			const uint8_t MyBitsPerCell = 8;
+#else
+			const uint8_t MyBitsPerCell = 16;
+#endif
+			uint8_t bitsPerCell;
+			in >> bitsPerCell;
+			ASSERTMSG_(
+				bitsPerCell == MyBitsPerCell,
+				"Cell size of the stream does not match this build");
+
+			in >> m_resolution >> genericMapParams;
+			internal_clear();
+			uint32_t nTiles;
+			in >> nTiles;
+			for (uint32_t i = 0; i < nTiles; i++)
+			{
+				int32_t tx, ty;
+				in >> tx >> ty;
+				TTile& tile = m_tiles[tileKey(tx, ty)];
+				tile.cells.resize(TILE_CELLS);
+				in.ReadBufferFixEndianness(&tile.cells[0], TILE_CELLS);
+			}
+
+			if (version >= 1)
+			{
+				insertionOptions.readFromStream(in);
+				likelihoodOptions.readFromStream(in);
+			}
+		}
+		break;
+		default:
+			MRPT_THROW_UNKNOWN_SERIALIZATION_VERSION(version)
+	};
+}
@@ -0,0 +1,206 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/maps/CTiledOccupancyGridMap2D.h>
+#include <mrpt/maps/COccupancyGridMap2D.h>
+#include <mrpt/obs/CObservation2DRangeScan.h>
+#include <mrpt/io/CMemoryStream.h>
+#include <mrpt/serialization/CArchive.h>
+#include <gtest/gtest.h>
+#include <cmath>
+
+using namespace mrpt;
+using namespace mrpt::maps;
+using namespace mrpt::obs;
+using namespace mrpt::poses;
+using namespace mrpt::math;
+using namespace std;
+
+// A synthetic scan inside a rectangular room:
+static void makeBoxScan(CObservation2DRangeScan& scan)
+{
+	const size_t N = 361;
+	scan.aperture = 2 * M_PIf;
+	scan.rightToLeft = true;
+	scan.resizeScan(N);
+	for (size_t i = 0; i < N; i++)
+	{
+		const double a = -M_PI + 2 * M_PI * i / (N - 1);
+		const double r = std::min(
+			3.0 / std::max(std::abs(cos(a)), 1e-3),
+			2.0 / std::max(std::abs(sin(a)), 1e-3));
+		scan.setScanRange(i, static_cast<float>(r));
+		scan.setScanRangeValidity(i, true);
+	}
+}
+
+TEST(CTiledOccupancyGridMap2DTests, insertLikeDenseGrid)
+{
+	CObservation2DRangeScan scan;
+	makeBoxScan(scan);
+	const CPose3D pose(0.31, -0.17, 0);
+
+	COccupancyGridMap2D dense(-5.0f, 5.0f, -5.0f, 5.0f, 0.05f);
+	dense.insertObservation(&scan, &pose);
+
+	CTiledOccupancyGridMap2D tiled(0.05f);
+	EXPECT_TRUE(tiled.isEmpty());
+	tiled.insertObservation(&scan, &pose);
+	EXPECT_FALSE(tiled.isEmpty());
+	// The room spans [-2.7,3.3]x[-2.2,1.8] m: 2x2 tiles of 6.4 m.
+	EXPECT_EQ(tiled.getTileCount(), 4u);
+
+	size_t nKnown = 0, nEqual = 0;
+	for (unsigned int cy = 0; cy < dense.getSizeY(); cy++)
+		for (unsigned int cx = 0; cx < dense.getSizeX(); cx++)
+		{
+			const float p = dense.getCell(cx, cy);
+			const float q = tiled.getPos(dense.idx2x(cx), dense.idx2y(cy));
+			if (p == 0.5f && q == 0.5f) continue;
+			nKnown++;
+			if (std::abs(p - q) < 1e-3f) nEqual++;
+		}
+	EXPECT_GT(nKnown, 1000u);
+	// Rays are traced from a different origin of cell indices, so a few
+	// cells may differ at the boundaries:
+	EXPECT_GT(nEqual, 0.99 * nKnown);
+}
+
+TEST(CTiledOccupancyGridMap2DTests, likelihoodLikeDenseGrid)
+{
+	CObservation2DRangeScan scan;
+	makeBoxScan(scan);
+
+	COccupancyGridMap2D dense(-5.0f, 5.0f, -5.0f, 5.0f, 0.05f);
+	dense.insertObservation(&scan);
+	dense.likelihoodOptions.likelihoodMethod =
+		COccupancyGridMap2D::lmLikelihoodField_Thrun;
+
+	CTiledOccupancyGridMap2D tiled;
+	tiled.loadFromDenseGrid(dense);
+
+	for (int i = 0; i < 10; i++)
+	{
+		const CPose2D p(-0.3 + 0.07 * i, 0.2 - 0.04 * i, DEG2RAD(-9.0 + 2 * i));
+		const double l1 = dense.computeObservationLikelihood(&scan, p);
+		const double l2 = tiled.computeObservationLikelihood(&scan, p);
+		EXPECT_NEAR(l1, l2, 1e-3 * (1.0 + std::abs(l1))) << "pose=" << p;
+	}
+
+	// New observations must invalidate the cached field:
+	const CPose3D pose2(0.5, 0, 0);
+	dense.insertObservation(&scan, &pose2);
+	tiled.insertObservation(&scan, &pose2);
+	const CPose2D p(0.45, 0.02, DEG2RAD(1.0));
+	const double l1 = dense.computeObservationLikelihood(&scan, p);
+	const double l2 = tiled.computeObservationLikelihood(&scan, p);
+	EXPECT_NEAR(l1, l2, 0.02 * (1.0 + std::abs(l1)));
+}
+
+TEST(CTiledOccupancyGridMap2DTests, likelihoodInMissingTiles)
+{
+	CObservation2DRangeScan scan;
+	makeBoxScan(scan);
+
+	COccupancyGridMap2D dense(-15.0f, 15.0f, -15.0f, 15.0f, 0.05f);
+	dense.insertObservation(&scan);
+	dense.likelihoodOptions.likelihoodMethod =
+		COccupancyGridMap2D::lmLikelihoodField_Thrun;
+
+	CTiledOccupancyGridMap2D tiled;
+	tiled.loadFromDenseGrid(dense);
+	const size_t nTiles = tiled.getTileCount();
+
+	// Most scan points fall in missing tiles, either next to the allocated
+	// ones or far from all of them:
+	for (int i = 0; i < 5; i++)
+	{
+		const CPose2D p(7.0 + 0.6 * i, 0.1 * i, DEG2RAD(5.0 * i));
+		const double l1 = dense.computeObservationLikelihood(&scan, p);
+		const double l2 = tiled.computeObservationLikelihood(&scan, p);
+		EXPECT_NEAR(l1, l2, 1e-3 * (1.0 + std::abs(l1))) << "pose=" << p;
+	}
+	// Evaluating the likelihood must not allocate tiles:
+	EXPECT_EQ(tiled.getTileCount(), nTiles);
+}
+
+TEST(CTiledOccupancyGridMap2DTests, compressionAndSerialization)
+{
+	CObservation2DRangeScan scan;
+	makeBoxScan(scan);
+	CTiledOccupancyGridMap2D tiled(0.1f);
+	tiled.insertionOptions.maxDistanceInsertion = 12.5f;
+	tiled.insertionOptions.numThreads = 4;
+	tiled.likelihoodOptions.LF_decimation = 7;
+	tiled.likelihoodOptions.OWA_weights = {0.5, 0.3, 0.2};
+	tiled.insertObservation(&scan);
+	// Far away, a new tile:
+	const CPose3D farPose(1000.0, -2000.0, 0);
+	tiled.insertObservation(&scan, &farPose);
+	tiled.setCell(-100000, 50000, 0.9f);
+	const size_t nTiles = tiled.getTileCount();
+
+	COccupancyGridMap2D ref;
+	tiled.getAsDenseGrid(ref, -60, 60, -60, 60);
+
+	const size_t memBefore = tiled.getMemoryUsage();
+	EXPECT_EQ(tiled.compressColdTiles(0), nTiles);
+	EXPECT_EQ(tiled.getCompressedTileCount(), nTiles);
+	EXPECT_LT(tiled.getMemoryUsage(), memBefore);
+
+	// Transparent decompression:
+	EXPECT_NEAR(tiled.getCell(-100000, 50000), 0.9f, 0.01f);
+	EXPECT_EQ(tiled.getCompressedTileCount(), nTiles - 1);
+
+	mrpt::io::CMemoryStream buf;
+	auto arch = mrpt::serialization::archiveFrom(buf);
+	arch << tiled;
+	buf.Seek(0);
+	CTiledOccupancyGridMap2D tiled2;
+	arch >> tiled2;
+
+	EXPECT_EQ(tiled2.getTileCount(), nTiles);
+	EXPECT_FLOAT_EQ(tiled2.getResolution(), 0.1f);
+	EXPECT_NEAR(tiled2.getCell(-100000, 50000), 0.9f, 0.01f);
+	EXPECT_FLOAT_EQ(tiled2.insertionOptions.maxDistanceInsertion, 12.5f);
+	// Not serialized:
+	EXPECT_EQ(tiled2.insertionOptions.numThreads, 1u);
+	EXPECT_EQ(tiled2.likelihoodOptions.LF_decimation, 7u);
+	EXPECT_EQ(tiled2.likelihoodOptions.OWA_weights.size(), 3u);
+
+	for (int cx = -60; cx <= 60; cx++)
+		for (int cy = -60; cy <= 60; cy++)
+		{
+			const float p = ref.getPos(tiled.idx2x(cx), tiled.idx2y(cy));
+			ASSERT_EQ(p, tiled.getCell(cx, cy));
+			ASSERT_EQ(p, tiled2.getCell(cx, cy));
+		}
+}
+
+TEST(CTiledOccupancyGridMap2DTests, laserScanSimulator)
+{
+	CObservation2DRangeScan scan;
+	makeBoxScan(scan);
+	CTiledOccupancyGridMap2D tiled(0.05f);
+	for (int i = 0; i < 3; i++) tiled.insertObservation(&scan);
+
+	CObservation2DRangeScan sim;
+	sim.aperture = M_PIf;
+	sim.maxRange = 10.0f;
+	sim.rightToLeft = true;
+	tiled.laserScanSimulator(sim, CPose2D(0, 0, 0), 0.6f, 181);
+	ASSERT_EQ(sim.scan.size(), 181u);
+
+	// Ray #90 looks forward to the wall at x=3:
+	EXPECT_TRUE(sim.validRange[90]);
+	EXPECT_NEAR(sim.scan[90], 3.0, 0.1);
+	// Ray #0 looks to the right, to the wall at y=-2:
+	EXPECT_TRUE(sim.validRange[0]);
+	EXPECT_NEAR(sim.scan[0], 2.0, 0.1);
+}
@@ -0,0 +1,405 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "maps-precomp.h"  // Precomp header
+
+#include <mrpt/maps/CVoxelPointsMap.h>
+#include <mrpt/config/CConfigFileBase.h>
+#include <mrpt/serialization/CArchive.h>
+#include <mrpt/core/bits_math.h>
+#include <mrpt/core/bits_mem.h>
+#include <mrpt/poses/CPose3D.h>
+#include <unordered_set>
+
+using namespace std;
+using namespace mrpt;
+using namespace mrpt::maps;
+using namespace mrpt::obs;
+using namespace mrpt::poses;
+using namespace mrpt::math;
+
+//  =========== Begin of Map definition ============
+MAP_DEFINITION_REGISTER(
+	"CVoxelPointsMap,voxelPointsMap", mrpt::maps::CVoxelPointsMap)
+
+CVoxelPointsMap::TMapDefinition::TMapDefinition() {}
+void CVoxelPointsMap::TMapDefinition::loadFromConfigFile_map_specific(
+	const mrpt::config::CConfigFileBase& c, const std::string& s)
+{
+	voxelOpts.loadFromConfigFile(c, s + string("_voxelOpts"));
+	insertionOpts.loadFromConfigFile(c, s + string("_insertOpts"));
+	likelihoodOpts.loadFromConfigFile(c, s + string("_likelihoodOpts"));
+	renderOpts.loadFromConfigFile(c, s + string("_renderOpts"));
+}
+
+void CVoxelPointsMap::TMapDefinition::dumpToTextStream_map_specific(
+	std::ostream& out) const
+{
+	this->voxelOpts.dumpToTextStream(out);
+	this->insertionOpts.dumpToTextStream(out);
+	this->likelihoodOpts.dumpToTextStream(out);
+	this->renderOpts.dumpToTextStream(out);
+}
+
+mrpt::maps::CMetricMap* CVoxelPointsMap::internal_CreateFromMapDefinition(
+	const mrpt::maps::TMetricMapInitializer& _def)
+{
+	const CVoxelPointsMap::TMapDefinition& def =
+		*dynamic_cast<const CVoxelPointsMap::TMapDefinition*>(&_def);
+	CVoxelPointsMap* obj = new CVoxelPointsMap();
+	obj->voxelOptions = def.voxelOpts;
+	obj->insertionOptions = def.insertionOpts;
+	obj->likelihoodOptions = def.likelihoodOpts;
+	obj->renderOptions = def.renderOpts;
+	return obj;
+}
+//  =========== End of Map definition Block =========
+
+IMPLEMENTS_SERIALIZABLE(CVoxelPointsMap, CPointsMap, mrpt::maps)
+
+void CVoxelPointsMap::TVoxelOptions::loadFromConfigFile(
+	const mrpt::config::CConfigFileBase& iniFile, const std::string& section)
+{
+	MRPT_LOAD_CONFIG_VAR(voxel_size, float, iniFile, section);
+	MRPT_LOAD_CONFIG_VAR(max_points_per_voxel, int, iniFile, section);
+	MRPT_LOAD_CONFIG_VAR(max_distance, double, iniFile, section);
+	MRPT_LOAD_CONFIG_VAR(eviction_step, double, iniFile, section);
+}
+
+void CVoxelPointsMap::TVoxelOptions::dumpToTextStream(std::ostream& out) const
+{
+	out << mrpt::format(
+		"\n----------- [CVoxelPointsMap::TVoxelOptions] ------------ \n\n");
+
+	LOADABLEOPTS_DUMP_VAR(voxel_size, float);
+	LOADABLEOPTS_DUMP_VAR(max_points_per_voxel, int);
+	LOADABLEOPTS_DUMP_VAR(max_distance, double);
+	LOADABLEOPTS_DUMP_VAR(eviction_step, double);
+}
+
+void CVoxelPointsMap::TVoxelOptions::writeToStream(
+	mrpt::serialization::CArchive& out) const
+{
+	const int8_t version = 1;
+	out << version;
+	out << voxel_size << max_points_per_voxel << max_distance;
+	out << eviction_step;  // v1
+}
+
+void CVoxelPointsMap::TVoxelOptions::readFromStream(
+	mrpt::serialization::CArchive& in)
+{
+	int8_t version;
+	in >> version;
+	switch (version)
+	{
+		case 0:
+		case 1:
+			in >> voxel_size >> max_points_per_voxel >> max_distance;
+			if (version >= 1)
+				in >> eviction_step;
+			else
+				eviction_step = 1.0;
+			break;
+		default:
+			MRPT_THROW_UNKNOWN_SERIALIZATION_VERSION(version)
+	}
+}
+
+CVoxelPointsMap::CVoxelPointsMap(
+	float voxel_size, uint32_t max_points_per_voxel)
+{
+	voxelOptions.voxel_size = voxel_size;
+	voxelOptions.max_points_per_voxel = max_points_per_voxel;
+}
+
+void CVoxelPointsMap::reserve(size_t newLength)
+{
+	m_x.reserve(newLength);
+	m_y.reserve(newLength);
+	m_z.reserve(newLength);
+}
+
+void CVoxelPointsMap::resize(size_t newLength)
+{
+	this->reserve(newLength);  // to ensure 4N capacity
+	m_x.resize(newLength, 0);
+	m_y.resize(newLength, 0);
+	m_z.resize(newLength, 0);
+	m_voxelsUpToDate = false;
+	mark_as_modified();
+}
+
+void CVoxelPointsMap::setSize(size_t newLength)
+{
+	this->reserve(newLength);  // to ensure 4N capacity
+	m_x.assign(newLength, 0);
+	m_y.assign(newLength, 0);
+	m_z.assign(newLength, 0);
+	m_voxelsUpToDate = false;
+	mark_as_modified();
+}
+
+void CVoxelPointsMap::setPointFast(size_t index, float x, float y, float z)
+{
+	m_x[index] = x;
+	m_y[index] = y;
+	m_z[index] = z;
+	m_voxelsUpToDate = false;
+}
+
+void CVoxelPointsMap::insertPointFast(float x, float y, float z)
+{
+	updateVoxels();
+	uint32_t& n = m_voxels[voxelKey(x, y, z, m_voxelsSize)];
+	if (n >= voxelOptions.max_points_per_voxel) return;  // Full voxel
+	n++;
+	m_x.push_back(x);
+	m_y.push_back(y);
+	m_z.push_back(z);
+}
+
+void CVoxelPointsMap::copyFrom(const CPointsMap& obj)
+{
+	// This also does a ::resize(N) of all data fields:
+	CPointsMap::base_copyFrom(obj);
+	const auto* o = dynamic_cast<const CVoxelPointsMap*>(&obj);
+	if (o) voxelOptions = o->voxelOptions;
+	m_voxelsUpToDate = false;
+}
+
+size_t CVoxelPointsMap::getVoxelCount() const
+{
+	if (m_voxelsUpToDate && m_voxelsSize == voxelOptions.voxel_size)
+		return m_voxels.size();
+	ASSERT_ABOVE_(voxelOptions.voxel_size, 0);
+
+	// The points in excess are only removed on the next insertion, but they
+	// never leave a voxel empty:
+	std::unordered_set<uint64_t> voxels;
+	for (size_t i = 0; i < m_x.size(); i++)
+		voxels.insert(
+			voxelKey(m_x[i], m_y[i], m_z[i], voxelOptions.voxel_size));
+	return voxels.size();
+}
+
+void CVoxelPointsMap::updateVoxels()
+{
+	if (m_voxelsUpToDate && m_voxelsSize == voxelOptions.voxel_size) return;
+	ASSERT_ABOVE_(voxelOptions.voxel_size, 0);
+
+	m_voxels.clear();
+	m_voxelsSize = voxelOptions.voxel_size;
+	m_voxelsUpToDate = true;
+
+	// Assign the points to voxels, keeping the first ones of each voxel:
+	std::vector<size_t> removed;
+	const size_t N = m_x.size();
+	size_t j = 0;
+	for (size_t i = 0; i < N; i++)
+	{
+		uint32_t& n = m_voxels[voxelKey(m_x[i], m_y[i], m_z[i], m_voxelsSize)];
+		if (n >= voxelOptions.max_points_per_voxel)
+		{
+			removed.push_back(i);
+			continue;
+		}
+		n++;
+		m_x[j] = m_x[i];
+		m_y[j] = m_y[i];
+		m_z[j] = m_z[i];
+		j++;
+	}
+	if (j < N)
+	{
+		m_x.resize(j);
+		m_y.resize(j);
+		m_z.resize(j);
+		mark_as_removed(removed);
+	}
+}
+
+size_t CVoxelPointsMap::removeVoxelsFarFrom(
+	const mrpt::math::TPoint3D& center, const double radius)
+{
+	updateVoxels();
+
+	const double r2 = mrpt::square(radius);
+	size_t nRemoved = 0;
+	for (auto it = m_voxels.begin(); it != m_voxels.end();)
+	{
+		double d2 = 0;
+		for (int axis = 0; axis < 3; axis++)
+			d2 += mrpt::square(
+				(voxelKeyIndex(it->first, axis) + 0.5) * m_voxelsSize -
+				center[axis]);
+		if (d2 > r2)
+		{
+			nRemoved += it->second;
+			it = m_voxels.erase(it);
+		}
+		else
+			++it;
+	}
+	if (!nRemoved) return 0;
+
+	// Remove the points of the erased voxels:
+	std::vector<size_t> removed;
+	removed.reserve(nRemoved);
+	const size_t N = m_x.size();
+	size_t j = 0;
+	for (size_t i = 0; i < N; i++)
+	{
+		if (!m_voxels.count(voxelKey(m_x[i], m_y[i], m_z[i], m_voxelsSize)))
+		{
+			removed.push_back(i);
+			continue;
+		}
+		m_x[j] = m_x[i];
+		m_y[j] = m_y[i];
+		m_z[j] = m_z[i];
+		j++;
+	}
+	m_x.resize(j);
+	m_y.resize(j);
+	m_z.resize(j);
+	mark_as_removed(removed);
+	return nRemoved;
+}
+
+void CVoxelPointsMap::insertVoxelFilteredPoints(const CPointsMap& pts)
+{
+	const auto& xs = pts.getPointsBufferRef_x();
+	const auto& ys = pts.getPointsBufferRef_y();
+	const auto& zs = pts.getPointsBufferRef_z();
+	for (size_t i = 0; i < xs.size(); i++) insertPointFast(xs[i], ys[i], zs[i]);
+	mark_as_appended();
+}
+
+/** Prepares the map used to convert observations to points */
+static void prepareObservationPoints(
+	const CPointsMap& me, CSimplePointsMap& pts)
+{
+	pts.resize(0);  // (Not clear(), to keep the allocated memory)
+	pts.insertionOptions = me.insertionOptions;
+	pts.insertionOptions.addToExistingPointsMap = false;
+	pts.insertionOptions.fuseWithExisting = false;
+	double zmin, zmax;
+	me.getHeightFilterLevels(zmin, zmax);
+	pts.setHeightFilterLevels(zmin, zmax);
+	pts.enableFilterByHeight(me.isFilterByHeightEnabled());
+}
+
+void CVoxelPointsMap::loadFromRangeScan(
+	const CObservation2DRangeScan& rangeScan, const CPose3D* robotPose)
+{
+	if (!insertionOptions.addToExistingPointsMap) clear();
+	prepareObservationPoints(*this, m_obsPoints);
+	m_obsPoints.loadFromRangeScan(rangeScan, robotPose);
+	insertVoxelFilteredPoints(m_obsPoints);
+}
+
+void CVoxelPointsMap::loadFromRangeScan(
+	const CObservation3DRangeScan& rangeScan, const CPose3D* robotPose)
+{
+	if (!insertionOptions.addToExistingPointsMap) clear();
+	prepareObservationPoints(*this, m_obsPoints);
+	m_obsPoints.loadFromRangeScan(rangeScan, robotPose);
+	insertVoxelFilteredPoints(m_obsPoints);
+}
+
+bool CVoxelPointsMap::internal_insertObservation(
+	const CObservation* obs, const CPose3D* robotPose)
+{
+	// Get the points of the observation with the generic code, then filter
+	// them by voxel:
+	prepareObservationPoints(*this, m_obsPoints);
+	if (!m_obsPoints.insertObservation(obs, robotPose)) return false;
+	if (!insertionOptions.addToExistingPointsMap) clear();
+	insertVoxelFilteredPoints(m_obsPoints);
+
+	// Remove the far voxels only after moving for a while, since they do not
+	// change otherwise:
+	TPoint3D robotPos(0, 0, 0);
+	if (robotPose)
+		robotPos = TPoint3D(robotPose->x(), robotPose->y(), robotPose->z());
+	if (voxelOptions.max_distance > 0 &&
+		(!m_hasEvictionCenter ||
+		 robotPos.distanceTo(m_evictionCenter) >= voxelOptions.eviction_step))
+	{
+		removeVoxelsFarFrom(robotPos, voxelOptions.max_distance);
+		m_evictionCenter = robotPos;
+		m_hasEvictionCenter = true;
+	}
+	return true;
+}
+
+void CVoxelPointsMap::internal_clear()
+{
+	// This swap() thing is the only way to really deallocate the memory.
+	vector_strong_clear(m_x);
+	vector_strong_clear(m_y);
+	vector_strong_clear(m_z);
+	m_voxels.clear();
+	m_voxelsUpToDate = true;
+	m_hasEvictionCenter = false;
+
+	mark_as_modified();
+}
+
+void CVoxelPointsMap::PLY_import_set_vertex_count(const size_t N)
+{
+	this->setSize(N);
+}
+
+uint8_t CVoxelPointsMap::serializeGetVersion() const { return 0; }
+void CVoxelPointsMap::serializeTo(mrpt::serialization::CArchive& out) const
+{
+	const uint32_t n = m_x.size();
+	out << n;
+	if (n > 0)
+	{
+		out.WriteBufferFixEndianness(&m_x[0], n);
+		out.WriteBufferFixEndianness(&m_y[0], n);
+		out.WriteBufferFixEndianness(&m_z[0], n);
+	}
+	out << genericMapParams;
+	voxelOptions.writeToStream(out);
+	insertionOptions.writeToStream(out);
+	likelihoodOptions.writeToStream(out);
+	renderOptions.writeToStream(out);
+}
+
+void CVoxelPointsMap::serializeFrom(
+	mrpt::serialization::CArchive& in, uint8_t version)
+{
+	switch (version)
+	{
+		case 0:
+		{
+			uint32_t n;
+			in >> n;
+			this->setSize(n);
+			if (n > 0)
+			{
+				in.ReadBufferFixEndianness(&m_x[0], n);
+				in.ReadBufferFixEndianness(&m_y[0], n);
+				in.ReadBufferFixEndianness(&m_z[0], n);
+			}
+			in >> genericMapParams;
+			voxelOptions.readFromStream(in);
+			insertionOptions.readFromStream(in);
+			likelihoodOptions.readFromStream(in);
+			renderOptions.readFromStream(in);
+		}
+		break;
+		default:
+			MRPT_THROW_UNKNOWN_SERIALIZATION_VERSION(version)
+	};
+}
@@ -0,0 +1,175 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/maps/CVoxelPointsMap.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/obs/CObservation2DRangeScan.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/random/RandomGenerators.h>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+
+using namespace mrpt;
+using namespace mrpt::maps;
+using namespace mrpt::obs;
+using namespace mrpt::poses;
+using namespace mrpt::math;
+using namespace std;
+
+// A synthetic scan of a circular room of 4m radius:
+static void makeCircleScan(CObservation2DRangeScan& scan)
+{
+	const size_t N = 361;
+	scan.aperture = 2 * M_PIf;
+	scan.rightToLeft = true;
+	scan.maxRange = 10.0f;
+	scan.resizeScan(N);
+	for (size_t i = 0; i < N; i++)
+	{
+		scan.setScanRange(i, 4.0f);
+		scan.setScanRangeValidity(i, true);
+	}
+}
+
+TEST(CVoxelPointsMap, boundedPointsPerVoxel)
+{
+	auto& rng = mrpt::random::getRandomGenerator();
+	rng.randomize(123);
+
+	// 2x2x2 voxels, with up to 4 points each:
+	CVoxelPointsMap m(0.5f, 4);
+	for (int i = 0; i < 1000; i++)
+		m.insertPoint(
+			rng.drawUniform(0.01f, 0.99f), rng.drawUniform(0.01f, 0.99f),
+			rng.drawUniform(0.01f, 0.99f));
+	EXPECT_EQ(m.getVoxelCount(), 8u);
+	EXPECT_EQ(m.size(), 32u);
+
+	// Negative coordinates are different voxels:
+	m.insertPoint(-0.1f, 0.1f, 0.1f);
+	EXPECT_EQ(m.getVoxelCount(), 9u);
+	EXPECT_EQ(m.size(), 33u);
+
+	// Points not inserted one by one are filtered on the next insertion:
+	CSimplePointsMap other;
+	for (int i = 0; i < 10; i++) other.insertPoint(-0.2f, 0.2f, 0.2f);
+	m.insertAnotherMap(&other, CPose3D());
+	EXPECT_EQ(m.size(), 43u);
+	EXPECT_EQ(m.getVoxelCount(), 9u);
+	EXPECT_EQ(m.size(), 43u);
+	m.insertPoint(5.0f, 5.0f, 5.0f);
+	EXPECT_EQ(m.getVoxelCount(), 10u);
+	EXPECT_EQ(m.size(), 32u + 4u + 1u);
+
+	// The KD-tree is valid after filtering:
+	float dist;
+	const size_t idx = m.kdTreeClosestPoint3D(4.9f, 5.0f, 5.0f, dist);
+	ASSERT_LT(idx, m.size());
+	EXPECT_NEAR(dist, 0.01f, 1e-4f);
+}
+
+TEST(CVoxelPointsMap, revisitsDoNotGrowTheMap)
+{
+	CObservation2DRangeScan scan;
+	makeCircleScan(scan);
+
+	CVoxelPointsMap m(0.2f, 3);
+	m.insertionOptions.minDistBetweenLaserPoints = 0;
+	const CPose3D robotPose(1.0, 0.5, 0, 0.3, 0, 0);
+	m.insertObservation(&scan, &robotPose);
+	const size_t nVoxels = m.getVoxelCount();
+	EXPECT_GT(nVoxels, 50u);
+
+	for (int i = 0; i < 20; i++)
+	{
+		const CPose3D p = robotPose + CPose3D(0.005 * i, 0, 0, 0.01 * i, 0, 0);
+		m.insertObservation(&scan, &p);
+	}
+	EXPECT_LE(m.size(), 3 * m.getVoxelCount());
+	EXPECT_LT(m.getVoxelCount(), 2 * nVoxels);
+
+	// The map is still a regular point map:
+	EXPECT_GT(
+		m.computeObservationLikelihood(&scan, robotPose),
+		m.computeObservationLikelihood(
+			&scan, robotPose + CPose3D(0.5, 0, 0, 0, 0, 0)));
+}
+
+TEST(CVoxelPointsMap, evictionOfFarVoxels)
+{
+	CObservation2DRangeScan scan;
+	makeCircleScan(scan);
+
+	CVoxelPointsMap m(0.25f, 2);
+	m.voxelOptions.max_distance = 6.0;
+	m.voxelOptions.eviction_step = 1.0;
+	size_t nEvictions = 0;
+	for (int i = 0; i <= 50; i++)
+	{
+		const CPose3D robotPose(0.5 * i, 0, 0, 0, 0, 0);
+		const size_t nBefore = m.size();
+		m.insertObservation(&scan, &robotPose);
+		if (m.size() < nBefore) nEvictions++;
+
+		// No point out of the distance (plus the size of a voxel and the
+		// distance between evictions):
+		float bestDist = std::numeric_limits<float>::max();
+		for (size_t k = 0; k < m.size(); k++)
+		{
+			float x, y, z;
+			m.getPoint(k, x, y, z);
+			EXPECT_LT(std::hypot(x - robotPose.x(), y), 6.0 + 0.5 + 1.0);
+			bestDist = std::min(
+				bestDist, square(x - 3.0f) + square(y - 1.0f) + square(z));
+		}
+
+		// The KD-tree, updated on each eviction, is valid:
+		float dist;
+		const size_t idx = m.kdTreeClosestPoint3D(3.0f, 1.0f, 0.0f, dist);
+		ASSERT_LT(idx, m.size());
+		EXPECT_NEAR(dist, bestDist, 1e-5f);
+	}
+	EXPECT_GT(m.size(), 50u);
+	// One eviction every two observations:
+	EXPECT_GE(nEvictions, 20u);
+	EXPECT_LE(nEvictions, 26u);
+
+	// Remove everything:
+	const size_t n = m.size();
+	EXPECT_EQ(m.removeVoxelsFarFrom(TPoint3D(-100, 0, 0), 1.0), n);
+	EXPECT_EQ(m.size(), 0u);
+	EXPECT_EQ(m.getVoxelCount(), 0u);
+}
+
+TEST(CVoxelPointsMap, insertWithoutAddingToExistingPoints)
+{
+	CObservation2DRangeScan scan;
+	makeCircleScan(scan);
+
+	CVoxelPointsMap m(0.2f, 3);
+	m.insertionOptions.minDistBetweenLaserPoints = 0;
+	m.insertionOptions.addToExistingPointsMap = false;
+	const CPose3D p1(0, 0, 0, 0, 0, 0), p2(20.0, 0, 0, 0, 0, 0);
+	m.insertObservation(&scan, &p1);
+	const size_t n = m.size();
+	const size_t nVoxels = m.getVoxelCount();
+	EXPECT_GT(n, 0u);
+
+	// Only the points of the last observation are kept:
+	m.insertObservation(&scan, &p2);
+	EXPECT_EQ(m.size(), n);
+	EXPECT_EQ(m.getVoxelCount(), nVoxels);
+	for (size_t k = 0; k < m.size(); k++)
+	{
+		float x, y, z;
+		m.getPoint(k, x, y, z);
+		EXPECT_GT(x, 10.0f);
+	}
+}
@@ -86,6 +86,7 @@ void CWeightedPointsMap::resize(size_t newLength)
 	m_y.resize(newLength, 0);
 	m_z.resize(newLength, 0);
 	pointWeight.resize(newLength, 1);
+	mark_as_modified();
 }
 
 // Resizes all point buffers so they can hold the given number of points,
@@ -97,6 +98,7 @@ void CWeightedPointsMap::setSize(size_t newLength)
 	m_y.assign(newLength, 0);
 	m_z.assign(newLength, 0);
 	pointWeight.assign(newLength, 1);
+	mark_as_modified();
 }
 
 void CWeightedPointsMap::setPointFast(size_t index, float x, float y, float z)
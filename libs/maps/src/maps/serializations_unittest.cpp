@@ -33,9 +33,11 @@ TEST_CLASS_MOVE_COPY_CTORS(CWirelessPowerGridMap2D);
 TEST_CLASS_MOVE_COPY_CTORS(CHeightGridMap2D);
 TEST_CLASS_MOVE_COPY_CTORS(CReflectivityGridMap2D);
 TEST_CLASS_MOVE_COPY_CTORS(COccupancyGridMap2D);
+TEST_CLASS_MOVE_COPY_CTORS(CTiledOccupancyGridMap2D);
 TEST_CLASS_MOVE_COPY_CTORS(CSimplePointsMap);
 TEST_CLASS_MOVE_COPY_CTORS(CRandomFieldGridMap3D);
 TEST_CLASS_MOVE_COPY_CTORS(CWeightedPointsMap);
+TEST_CLASS_MOVE_COPY_CTORS(CVoxelPointsMap);
 TEST_CLASS_MOVE_COPY_CTORS(COctoMap);
 TEST_CLASS_MOVE_COPY_CTORS(CColouredOctoMap);
 
@@ -52,9 +54,11 @@ TEST(SerializeTestMaps, WriteReadToMem)
 		CLASS_ID(CHeightGridMap2D),
 		CLASS_ID(CReflectivityGridMap2D),
 		CLASS_ID(COccupancyGridMap2D),
+		CLASS_ID(CTiledOccupancyGridMap2D),
 		CLASS_ID(CSimplePointsMap),
 		CLASS_ID(CRandomFieldGridMap3D),
 		CLASS_ID(CWeightedPointsMap),
+		CLASS_ID(CVoxelPointsMap),
 		CLASS_ID(COctoMap),
 		CLASS_ID(CColouredOctoMap)};
 
@@ -13,6 +13,7 @@
 #include <mrpt/math/CMatrixTemplateNumeric.h>
 #include <mrpt/math/CMatrixFixedNumeric.h>
 #include <cstring>  // memcpy
+#include <vector>
 #include <stdexcept>
 
 // Include CSparse lib headers, either from the system or embedded:
@@ -336,6 +337,26 @@ class CSparseMatrix
 	 */
 	void compressFromTriplet();
 
+	/** Replaces the contents of this matrix with a column-compressed matrix
+	 * given by its CSparse arrays: column pointers \a col_ptrs (nCols+1
+	 * elements), and the row index and value of each non-zero entry (\a
+	 * row_idxs and \a values, col_ptrs[nCols] elements each). Faster than
+	 * inserting triplets and calling compressFromTriplet() for matrices
+	 * with a known sparsity pattern.
+	 */
+	void setColumnCompressed(
+		const size_t nRows, const size_t nCols,
+		const std::vector<int>& col_ptrs, const std::vector<int>& row_idxs,
+		const std::vector<double>& values);
+
+	/** ONLY for COLUMN-COMPRESSED square matrices: returns the approximate
+	 * minimum degree (AMD) fill-reducing ordering of A+A', as a permutation
+	 * vector such as the k'th pivot is the row/column `P[k]`. Only the
+	 * sparsity pattern is used. The result can be passed to CholeskyDecomp
+	 * to reuse it for several matrices.
+	 */
+	std::vector<int> computeFillReducingOrdering() const;
+
 	/** Return a dense representation of the sparse matrix.
 	 * \sa saveToTextFile_dense
 	 */
@@ -455,6 +476,15 @@ class CSparseMatrix
 		 * matrix as input.
 		 */
 		CholeskyDecomp(const CSparseMatrix& A);
+		/** Like CholeskyDecomp(const CSparseMatrix&), but using a given
+		 * fill-reducing ordering, e.g. from
+		 * CSparseMatrix::computeFillReducingOrdering(), instead of
+		 * computing a new one.
+		 * \param[in] ordering Permutation of [0,N-1]: the k'th pivot is
+		 * row/column `ordering[k]`.
+		 */
+		CholeskyDecomp(
+			const CSparseMatrix& A, const std::vector<int>& ordering);
 		CholeskyDecomp(const CholeskyDecomp& A) = delete;
 
 		CholeskyDecomp& operator=(const CholeskyDecomp&) = delete;
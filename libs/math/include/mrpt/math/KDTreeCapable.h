@@ -11,7 +11,9 @@
 // nanoflann library:
 #include <nanoflann.hpp>
 #include <mrpt/math/lightweight_geom_data.h>
+#include <algorithm>  // sort, lower_bound
 #include <memory>  // unique_ptr
+#include <vector>
 
 namespace mrpt::math
 {
@@ -59,6 +61,14 @@ namespace mrpt::math
  * The KD-tree index will be built on demand only upon call of any of the query
  * methods provided by this class.
  *
+ * Points appended at the end of the data (with the rest unchanged) do not
+ * require "kdtree_mark_as_outdated()": if the index is up to date, they are
+ * inserted into it on the next query, in a new small KD-tree which is
+ * merged with the previous ones as they grow, so the amortized cost of
+ * appending a point is O(log N) instead of rebuilding the whole index.
+ * Likewise, after removing some points, "kdtree_mark_as_removed()" only
+ * rebuilds the KD-trees which indexed any of them.
+ *
  *  Notice that there is only ONE internal cached KD-tree, so if a method to
  * query a 2D point is called,
  *  then another method for 3D points, then again the 2D method, three KD-trees
@@ -136,9 +146,8 @@ class KDTreeCapable
 
 		m_kdtree2d_data.query_point[0] = x0;
 		m_kdtree2d_data.query_point[1] = y0;
-		m_kdtree2d_data.index->findNeighbors(
-			resultSet, &m_kdtree2d_data.query_point[0],
-			nanoflann::SearchParams());
+		m_kdtree2d_data.findNeighbors(
+			resultSet, &m_kdtree2d_data.query_point[0]);
 
 		// Copy output to user vars:
 		out_x = derived().kdtree_get_pt(ret_index, 0);
@@ -164,9 +173,8 @@ class KDTreeCapable
 
 		m_kdtree2d_data.query_point[0] = x0;
 		m_kdtree2d_data.query_point[1] = y0;
-		m_kdtree2d_data.index->findNeighbors(
-			resultSet, &m_kdtree2d_data.query_point[0],
-			nanoflann::SearchParams());
+		m_kdtree2d_data.findNeighbors(
+			resultSet, &m_kdtree2d_data.query_point[0]);
 
 		return ret_index;
 		MRPT_END
@@ -185,6 +193,37 @@ class KDTreeCapable
 		return res;
 	}
 
+	/** Batched version of kdTreeClosestPoint2D(), for the N queries
+	 * (xs[i*stride],ys[i*stride]), i=0,...,N-1.
+	 *
+	 * Unlike the single-query methods, this one does not use any internal
+	 * temporary buffer, so once the 2D KD-tree is up to date (see
+	 * kdTreeBuildIndex2D()), several threads can call it at once for
+	 * different sets of queries.
+	 *
+	 * \param out_idx The N indices of the closest points.
+	 * \param out_dist_sqr The N square distances to the closest points.
+	 * \sa kdTreeClosestPoints3D
+	 */
+	inline void kdTreeClosestPoints2D(
+		const num_t* xs, const num_t* ys, const size_t N, const size_t stride,
+		size_t* out_idx, num_t* out_dist_sqr) const
+	{
+		MRPT_START
+		rebuild_kdTree_2D();  // First: Create the 2D KD-Tree if required
+		if (!m_kdtree2d_data.m_num_points)
+			THROW_EXCEPTION("There are no points in the KD-tree.");
+
+		for (size_t i = 0; i < N; i++)
+		{
+			const num_t query[2] = {xs[i * stride], ys[i * stride]};
+			nanoflann::KNNResultSet<num_t> resultSet(1);
+			resultSet.init(&out_idx[i], &out_dist_sqr[i]);
+			m_kdtree2d_data.findNeighbors(resultSet, &query[0]);
+		}
+		MRPT_END
+	}
+
 	/** Like kdTreeClosestPoint2D, but just return the square error from some
 	 * point to its closest neighbor.
 	 */
@@ -238,9 +277,8 @@ class KDTreeCapable
 
 		m_kdtree2d_data.query_point[0] = x0;
 		m_kdtree2d_data.query_point[1] = y0;
-		m_kdtree2d_data.index->findNeighbors(
-			resultSet, &m_kdtree2d_data.query_point[0],
-			nanoflann::SearchParams());
+		m_kdtree2d_data.findNeighbors(
+			resultSet, &m_kdtree2d_data.query_point[0]);
 
 		// Copy output to user vars:
 		out_x1 = derived().kdtree_get_pt(ret_indexes[0], 0);
@@ -307,9 +345,8 @@ class KDTreeCapable
 
 		m_kdtree2d_data.query_point[0] = x0;
 		m_kdtree2d_data.query_point[1] = y0;
-		m_kdtree2d_data.index->findNeighbors(
-			resultSet, &m_kdtree2d_data.query_point[0],
-			nanoflann::SearchParams());
+		m_kdtree2d_data.findNeighbors(
+			resultSet, &m_kdtree2d_data.query_point[0]);
 
 		for (size_t i = 0; i < knn; i++)
 		{
@@ -369,9 +406,8 @@ class KDTreeCapable
 
 		m_kdtree2d_data.query_point[0] = x0;
 		m_kdtree2d_data.query_point[1] = y0;
-		m_kdtree2d_data.index->findNeighbors(
-			resultSet, &m_kdtree2d_data.query_point[0],
-			nanoflann::SearchParams());
+		m_kdtree2d_data.findNeighbors(
+			resultSet, &m_kdtree2d_data.query_point[0]);
 		MRPT_END
 	}
 
@@ -420,9 +456,8 @@ class KDTreeCapable
 		m_kdtree3d_data.query_point[0] = x0;
 		m_kdtree3d_data.query_point[1] = y0;
 		m_kdtree3d_data.query_point[2] = z0;
-		m_kdtree3d_data.index->findNeighbors(
-			resultSet, &m_kdtree3d_data.query_point[0],
-			nanoflann::SearchParams());
+		m_kdtree3d_data.findNeighbors(
+			resultSet, &m_kdtree3d_data.query_point[0]);
 
 		// Copy output to user vars:
 		out_x = derived().kdtree_get_pt(ret_index, 0);
@@ -450,9 +485,8 @@ class KDTreeCapable
 		m_kdtree3d_data.query_point[0] = x0;
 		m_kdtree3d_data.query_point[1] = y0;
 		m_kdtree3d_data.query_point[2] = z0;
-		m_kdtree3d_data.index->findNeighbors(
-			resultSet, &m_kdtree3d_data.query_point[0],
-			nanoflann::SearchParams());
+		m_kdtree3d_data.findNeighbors(
+			resultSet, &m_kdtree3d_data.query_point[0]);
 
 		return ret_index;
 		MRPT_END
@@ -472,6 +506,32 @@ class KDTreeCapable
 		return res;
 	}
 
+	/** Batched version of kdTreeClosestPoint3D(), for the N queries
+	 * (xs[i*stride],ys[i*stride],zs[i*stride]), i=0,...,N-1. Can be called
+	 * from several threads at once once the 3D KD-tree is up to date (see
+	 * kdTreeBuildIndex3D()).
+	 * \sa kdTreeClosestPoints2D
+	 */
+	inline void kdTreeClosestPoints3D(
+		const num_t* xs, const num_t* ys, const num_t* zs, const size_t N,
+		const size_t stride, size_t* out_idx, num_t* out_dist_sqr) const
+	{
+		MRPT_START
+		rebuild_kdTree_3D();  // First: Create the 3D KD-Tree if required
+		if (!m_kdtree3d_data.m_num_points)
+			THROW_EXCEPTION("There are no points in the KD-tree.");
+
+		for (size_t i = 0; i < N; i++)
+		{
+			const num_t query[3] = {
+				xs[i * stride], ys[i * stride], zs[i * stride]};
+			nanoflann::KNNResultSet<num_t> resultSet(1);
+			resultSet.init(&out_idx[i], &out_dist_sqr[i]);
+			m_kdtree3d_data.findNeighbors(resultSet, &query[0]);
+		}
+		MRPT_END
+	}
+
 	/** KD Tree-based search for the N closest points to some given 3D
 	 *coordinates.
 	 *  This method automatically build the "m_kdtree_data" structure when:
@@ -516,9 +576,8 @@ class KDTreeCapable
 		m_kdtree3d_data.query_point[0] = x0;
 		m_kdtree3d_data.query_point[1] = y0;
 		m_kdtree3d_data.query_point[2] = z0;
-		m_kdtree3d_data.index->findNeighbors(
-			resultSet, &m_kdtree3d_data.query_point[0],
-			nanoflann::SearchParams());
+		m_kdtree3d_data.findNeighbors(
+			resultSet, &m_kdtree3d_data.query_point[0]);
 
 		for (size_t i = 0; i < knn; i++)
 		{
@@ -574,9 +633,8 @@ class KDTreeCapable
 		m_kdtree3d_data.query_point[0] = x0;
 		m_kdtree3d_data.query_point[1] = y0;
 		m_kdtree3d_data.query_point[2] = z0;
-		m_kdtree3d_data.index->findNeighbors(
-			resultSet, &m_kdtree3d_data.query_point[0],
-			nanoflann::SearchParams());
+		m_kdtree3d_data.findNeighbors(
+			resultSet, &m_kdtree3d_data.query_point[0]);
 
 		for (size_t i = 0; i < knn; i++)
 		{
@@ -632,9 +690,8 @@ class KDTreeCapable
 		if (m_kdtree3d_data.m_num_points != 0)
 		{
 			const num_t xyz[3] = {x0, y0, z0};
-			m_kdtree3d_data.index->radiusSearch(
-				&xyz[0], maxRadiusSqr, out_indices_dist,
-				nanoflann::SearchParams());
+			m_kdtree3d_data.radiusSearch(
+				&xyz[0], maxRadiusSqr, out_indices_dist);
 		}
 		return out_indices_dist.size();
 		MRPT_END
@@ -666,9 +723,8 @@ class KDTreeCapable
 		if (m_kdtree2d_data.m_num_points != 0)
 		{
 			const num_t xyz[2] = {x0, y0};
-			m_kdtree2d_data.index->radiusSearch(
-				&xyz[0], maxRadiusSqr, out_indices_dist,
-				nanoflann::SearchParams());
+			m_kdtree2d_data.radiusSearch(
+				&xyz[0], maxRadiusSqr, out_indices_dist);
 		}
 		return out_indices_dist.size();
 		MRPT_END
@@ -708,9 +764,8 @@ class KDTreeCapable
 		m_kdtree3d_data.query_point[0] = x0;
 		m_kdtree3d_data.query_point[1] = y0;
 		m_kdtree3d_data.query_point[2] = z0;
-		m_kdtree3d_data.index->findNeighbors(
-			resultSet, &m_kdtree3d_data.query_point[0],
-			nanoflann::SearchParams());
+		m_kdtree3d_data.findNeighbors(
+			resultSet, &m_kdtree3d_data.query_point[0]);
 		MRPT_END
 	}
 
@@ -723,6 +778,13 @@ class KDTreeCapable
 			static_cast<float>(p0.z), N, outIdx, outDistSqr);
 	}
 
+	/** Builds the 2D KD-tree now, if it is not up to date. The query methods
+	 * do this automatically, but this must be called from one thread before
+	 * issuing concurrent queries with kdTreeClosestPoints2D(). */
+	inline void kdTreeBuildIndex2D() const { rebuild_kdTree_2D(); }
+	/** Like kdTreeBuildIndex2D(), for the 3D KD-tree. */
+	inline void kdTreeBuildIndex3D() const { rebuild_kdTree_3D(); }
+
 	/* @} */
 
    protected:
@@ -731,10 +793,83 @@ class KDTreeCapable
 	{
 		m_kdtree_is_uptodate = false;
 	}
+	/** To be called by child classes after removing some points (keeping the
+	 * order of the rest), with the sorted indices they had before their
+	 * removal. Only the KD-trees with removed points are rebuilt. */
+	inline void kdtree_mark_as_removed(const std::vector<size_t>& removed) const
+	{
+		if (!m_kdtree_is_uptodate || removed.empty()) return;
+		m_kdtree2d_data.remove(removed);
+		m_kdtree3d_data.remove(removed);
+		m_kdtreeNd_data.remove(removed);
+	}
 
    private:
+	/** A range of consecutive points of the derived class, seen as a dataset
+	 * for nanoflann, with indices relative to its first point. */
+	struct TPointsRange
+	{
+		const Derived* data{nullptr};
+		size_t first{0}, count{0};
+
+		inline size_t kdtree_get_point_count() const { return count; }
+		inline num_t kdtree_get_pt(const size_t idx, int dim) const
+		{
+			return data->kdtree_get_pt(first + idx, dim);
+		}
+		template <typename T>
+		inline auto kdtree_distance(
+			const T* p1, const size_t idx_p2, size_t size) const
+		{
+			return data->kdtree_distance(p1, first + idx_p2, size);
+		}
+		template <class BBOX>
+		bool kdtree_get_bbox(BBOX& bb) const
+		{
+			// The bbox of the derived class is only valid for all its points:
+			return first == 0 && count == data->kdtree_get_point_count() &&
+				   data->kdtree_get_bbox(bb);
+		}
+	};
+
+	/** Forwards the neighbors found in the KD-tree of a TPointsRange to the
+	 * user result set, converting their indices into global ones. */
+	template <class RESULTSET>
+	struct TOffsetResultSet
+	{
+		RESULTSET& result;
+		const size_t offset;
+
+		inline bool full() const { return result.full(); }
+		inline auto worstDist() const { return result.worstDist(); }
+		template <typename DIST>
+		inline void addPoint(DIST dist, size_t index)
+		{
+			result.addPoint(dist, offset + index);
+		}
+	};
+
+	/** The metric type, with TPointsRange instead of Derived as dataset */
+	template <class METRIC>
+	struct rebind_metric;
+	template <
+		template <class, class, class> class METRIC, class T, class DATASET,
+		class DIST>
+	struct rebind_metric<METRIC<T, DATASET, DIST>>
+	{
+		using type = METRIC<T, TPointsRange, DIST>;
+	};
+
 	/** Internal structure with the KD-tree representation (mainly used to avoid
-	 * copying pointers with the = operator) */
+	 * copying pointers with the = operator).
+	 *
+	 * To allow appending points without rebuilding the whole index, it is a
+	 * forest of static KD-trees, each one for a range of consecutive points
+	 * (the oldest and largest ranges first). New points become a new tree,
+	 * which is merged with the last ones while they are not at least twice
+	 * its size, so there are O(log N) trees and each point is re-indexed
+	 * O(log N) times as the data grows (a logarithmic method, as in Bentley
+	 * and Saxe, "Decomposable searching problems I", 1980). */
 	template <int _DIM = -1>
 	struct TKDTreeDataHolder
 	{
@@ -753,31 +888,117 @@ class KDTreeCapable
 		}
 
 		/** Free memory (if allocated)  */
-		inline void clear() noexcept { index.reset(); }
-		using kdtree_index_t =
-			nanoflann::KDTreeSingleIndexAdaptor<metric_t, Derived, _DIM>;
+		inline void clear() noexcept
+		{
+			trees.clear();
+			m_num_points = 0;
+		}
+		using kdtree_index_t = nanoflann::KDTreeSingleIndexAdaptor<
+			typename rebind_metric<metric_t>::type, TPointsRange, _DIM>;
 
-		/** nullptr or the up-to-date index */
-		std::unique_ptr<kdtree_index_t> index;
+		struct TSubTree
+		{
+			TPointsRange points;
+			std::unique_ptr<kdtree_index_t> index;
+		};
+		/** The KD-trees of the forest, for consecutive ranges of points */
+		std::vector<std::unique_ptr<TSubTree>> trees;
 
 		std::vector<num_t> query_point;
 		/** Dimensionality. typ: 2,3 */
 		size_t m_dim = _DIM;
+		/** Number of points in the index */
 		size_t m_num_points = 0;
+
+		/** Indexes the points [m_num_points,N) of \a data, which must not have
+		 * changed otherwise since the last call. */
+		void append(
+			const Derived& data, const size_t N, const size_t leaf_max_size)
+		{
+			if (N < m_num_points) clear();
+			if (N == m_num_points) return;
+
+			auto t = std::make_unique<TSubTree>();
+			t->points.data = &data;
+			t->points.first = m_num_points;
+			while (!trees.empty() &&
+				   trees.back()->points.count < 2 * (N - t->points.first))
+			{
+				t->points.first = trees.back()->points.first;
+				trees.pop_back();
+			}
+			t->points.count = N - t->points.first;
+			t->index.reset(new kdtree_index_t(
+				m_dim, t->points,
+				nanoflann::KDTreeSingleIndexAdaptorParams(leaf_max_size)));
+			t->index->buildIndex();
+			trees.push_back(std::move(t));
+			m_num_points = N;
+		}
+
+		/** Updates the index after removing the points with the given sorted
+		 * indices from the data: the trees after a removed point are shifted,
+		 * and those with removed points are rebuilt. */
+		void remove(const std::vector<size_t>& removed)
+		{
+			auto it = removed.begin();
+			size_t nRemoved = 0;  // So far, before the current tree
+			std::vector<std::unique_ptr<TSubTree>> kept;
+			for (auto& t : trees)
+			{
+				const auto itEnd = std::lower_bound(
+					it, removed.end(), t->points.first + t->points.count);
+				const size_t n = itEnd - it;
+				it = itEnd;
+				t->points.first -= nRemoved;
+				nRemoved += n;
+				if (!n)
+				{
+					kept.push_back(std::move(t));
+					continue;
+				}
+				t->points.count -= n;
+				if (!t->points.count) continue;
+				t->index->buildIndex();
+				kept.push_back(std::move(t));
+			}
+			trees = std::move(kept);
+			m_num_points -= nRemoved;
+		}
+
+		/** Runs a nanoflann search over all the trees */
+		template <class RESULTSET>
+		void findNeighbors(RESULTSET& result, const num_t* query) const
+		{
+			for (const auto& t : trees)
+			{
+				TOffsetResultSet<RESULTSET> r{result, t->points.first};
+				t->index->findNeighbors(r, query, nanoflann::SearchParams());
+			}
+		}
+
+		/** All the points within a radius, sorted by distance */
+		void radiusSearch(
+			const num_t* query, const num_t radius,
+			std::vector<std::pair<size_t, num_t>>& out) const
+		{
+			nanoflann::RadiusResultSet<num_t, size_t> result(radius, out);
+			findNeighbors(result, query);
+			std::sort(out.begin(), out.end(), nanoflann::IndexDist_Sorter());
+		}
 	};
 
 	mutable TKDTreeDataHolder<2> m_kdtree2d_data;
 	mutable TKDTreeDataHolder<3> m_kdtree3d_data;
 	mutable TKDTreeDataHolder<> m_kdtreeNd_data;
-	/** whether the KD tree needs to be rebuilt or not. */
+	/** whether the KD tree needs to be rebuilt or not. While it is up to date,
+	 * new points at the end of the data are added to the existing index. */
 	mutable bool m_kdtree_is_uptodate;
 
 	/// Rebuild, if needed the KD-tree for 2D (nDims=2), 3D (nDims=3), ...
 	/// asking the child class for the data points.
 	void rebuild_kdTree_2D() const
 	{
-		using tree2d_t = typename TKDTreeDataHolder<2>::kdtree_index_t;
-
 		if (!m_kdtree_is_uptodate)
 		{
 			m_kdtree2d_data.clear();
@@ -785,33 +1006,19 @@ class KDTreeCapable
 			m_kdtreeNd_data.clear();
 		}
 
-		if (!m_kdtree2d_data.index)
-		{
-			// Erase previous tree:
-			m_kdtree2d_data.clear();
-			// And build new index:
-			const size_t N = derived().kdtree_get_point_count();
-			m_kdtree2d_data.m_num_points = N;
-			m_kdtree2d_data.m_dim = 2;
-			m_kdtree2d_data.query_point.resize(2);
-			if (N)
-			{
-				m_kdtree2d_data.index.reset(new tree2d_t(
-					2, derived(),
-					nanoflann::KDTreeSingleIndexAdaptorParams(
-						kdtree_search_params.leaf_max_size)));
-				m_kdtree2d_data.index->buildIndex();
-			}
-			m_kdtree_is_uptodate = true;
-		}
+		// Build the new index, or add the new points to it:
+		m_kdtree2d_data.m_dim = 2;
+		m_kdtree2d_data.query_point.resize(2);
+		m_kdtree2d_data.append(
+			derived(), derived().kdtree_get_point_count(),
+			kdtree_search_params.leaf_max_size);
+		m_kdtree_is_uptodate = true;
 	}
 
 	/// Rebuild, if needed the KD-tree for 2D (nDims=2), 3D (nDims=3), ...
 	/// asking the child class for the data points.
 	void rebuild_kdTree_3D() const
 	{
-		using tree3d_t = typename TKDTreeDataHolder<3>::kdtree_index_t;
-
 		if (!m_kdtree_is_uptodate)
 		{
 			m_kdtree2d_data.clear();
@@ -819,25 +1026,13 @@ class KDTreeCapable
 			m_kdtreeNd_data.clear();
 		}
 
-		if (!m_kdtree3d_data.index)
-		{
-			// Erase previous tree:
-			m_kdtree3d_data.clear();
-			// And build new index:
-			const size_t N = derived().kdtree_get_point_count();
-			m_kdtree3d_data.m_num_points = N;
-			m_kdtree3d_data.m_dim = 3;
-			m_kdtree3d_data.query_point.resize(3);
-			if (N)
-			{
-				m_kdtree3d_data.index.reset(new tree3d_t(
-					3, derived(),
-					nanoflann::KDTreeSingleIndexAdaptorParams(
-						kdtree_search_params.leaf_max_size)));
-				m_kdtree3d_data.index->buildIndex();
-			}
-			m_kdtree_is_uptodate = true;
-		}
+		// Build the new index, or add the new points to it:
+		m_kdtree3d_data.m_dim = 3;
+		m_kdtree3d_data.query_point.resize(3);
+		m_kdtree3d_data.append(
+			derived(), derived().kdtree_get_point_count(),
+			kdtree_search_params.leaf_max_size);
+		m_kdtree_is_uptodate = true;
 	}
 
 };  // end of KDTreeCapable
@@ -9,7 +9,9 @@
 
 #pragma once
 
+#include <mrpt/typemeta/TEnumType.h>
 #include <cmath>  // std::sqrt()
+#include <stdexcept>
 
 namespace mrpt::math
 {
@@ -25,7 +27,16 @@ enum TRobustKernelType
 	/** No robust kernel, use standard least squares: rho(r)= 1/2 * r^2 */
 	rkLeastSquares = 0,
 	/** Pseudo-huber robust kernel */
-	rkPseudoHuber
+	rkPseudoHuber,
+	/** Huber robust kernel */
+	rkHuber,
+	/** Cauchy robust kernel */
+	rkCauchy,
+	/** Dynamic Covariance Scaling (DCS) */
+	rkDCS,
+	/** Geman-McClure robust kernel, equivalent to switchable constraints
+	 * with the switch variable optimized in closed form. */
+	rkGemanMcClure
 };
 
 // Generic declaration.
@@ -74,6 +85,142 @@ struct RobustKernel<rkPseudoHuber, T>
 	}
 };
 
+/** Huber robust kernel: rho(r) = r^2/2 for |r|<delta, delta*(|r|-delta/2)
+ * otherwise */
+template <typename T>
+struct RobustKernel<rkHuber, T>
+{
+	/** The kernel parameter (the "threshold") squared. */
+	T param_sq;
+
+	/** Evaluates the kernel function for the squared error r2 and returns
+	 * robustified squared error and derivatives of sqrt(2*rho(r)) at this
+	 * point. */
+	inline T eval(const T r2, T& out_1st_deriv, T& out_2nd_deriv)
+	{
+		if (r2 <= param_sq)
+		{
+			out_1st_deriv = 1;
+			out_2nd_deriv = 0;
+			return r2;
+		}
+		const T r = std::sqrt(r2), delta = std::sqrt(param_sq);
+		out_1st_deriv = delta / r;
+		out_2nd_deriv = -0.5 * out_1st_deriv / r2;
+		return 2 * delta * r - param_sq;  // return: 2*cost
+	}
+};
+
+/** Cauchy robust kernel: rho(r) = delta^2/2 * log(1+r^2/delta^2) */
+template <typename T>
+struct RobustKernel<rkCauchy, T>
+{
+	/** The kernel parameter (the "threshold") squared. */
+	T param_sq;
+
+	/** Evaluates the kernel function for the squared error r2 and returns
+	 * robustified squared error and derivatives of sqrt(2*rho(r)) at this
+	 * point. */
+	inline T eval(const T r2, T& out_1st_deriv, T& out_2nd_deriv)
+	{
+		const T param_sq_inv = 1.0 / param_sq;
+		const T a = 1 + r2 * param_sq_inv;
+		out_1st_deriv = 1. / a;
+		out_2nd_deriv = -param_sq_inv * out_1st_deriv * out_1st_deriv;
+		return param_sq * std::log(a);  // return: 2*cost
+	}
+};
+
+/** Dynamic Covariance Scaling (Agarwal et al., ICRA 2013): the squared error
+ * is scaled by s^2, with s=min(1, 2*Phi/(Phi+r^2)), and Phi=param_sq.
+ * As in the original method, the 1st derivative is the scale s^2, considered
+ * constant at each point (2nd derivative is zero). */
+template <typename T>
+struct RobustKernel<rkDCS, T>
+{
+	/** The kernel parameter (Phi). */
+	T param_sq;
+
+	/** Evaluates the kernel function for the squared error r2 and returns
+	 * robustified squared error and derivatives of sqrt(2*rho(r)) at this
+	 * point. */
+	inline T eval(const T r2, T& out_1st_deriv, T& out_2nd_deriv)
+	{
+		out_2nd_deriv = 0;
+		if (r2 <= param_sq)
+		{
+			out_1st_deriv = 1;
+			return r2;
+		}
+		const T s = 2 * param_sq / (param_sq + r2);
+		out_1st_deriv = s * s;
+		return out_1st_deriv * r2;  // return: 2*cost
+	}
+};
+
+/** Geman-McClure robust kernel: rho(r) = 1/2 * Xi*r^2/(Xi+r^2), Xi=param_sq.
+ * This is the cost of a switchable constraint (Sunderhauf & Protzel, 2012)
+ * with a switch variable s in [0,1] with prior precision Xi, optimized in
+ * closed form: s = Xi/(Xi+r^2), so the 1st derivative is s^2. */
+template <typename T>
+struct RobustKernel<rkGemanMcClure, T>
+{
+	/** The kernel parameter (Xi). */
+	T param_sq;
+
+	/** Evaluates the kernel function for the squared error r2 and returns
+	 * robustified squared error and derivatives of sqrt(2*rho(r)) at this
+	 * point. */
+	inline T eval(const T r2, T& out_1st_deriv, T& out_2nd_deriv)
+	{
+		const T s = param_sq / (param_sq + r2);
+		out_1st_deriv = s * s;
+		out_2nd_deriv = -2 * out_1st_deriv / (param_sq + r2);
+		return s * r2;  // return: 2*cost
+	}
+};
+
+/** Evaluates a robust kernel selected at run time. See RobustKernel<>::eval()
+ */
+template <typename T>
+inline T evalRobustKernel(
+	const TRobustKernelType type, const T param_sq, const T r2,
+	T& out_1st_deriv, T& out_2nd_deriv)
+{
+	switch (type)
+	{
+		case rkLeastSquares:
+			return RobustKernel<rkLeastSquares, T>{param_sq}.eval(
+				r2, out_1st_deriv, out_2nd_deriv);
+		case rkPseudoHuber:
+			return RobustKernel<rkPseudoHuber, T>{param_sq}.eval(
+				r2, out_1st_deriv, out_2nd_deriv);
+		case rkHuber:
+			return RobustKernel<rkHuber, T>{param_sq}.eval(
+				r2, out_1st_deriv, out_2nd_deriv);
+		case rkCauchy:
+			return RobustKernel<rkCauchy, T>{param_sq}.eval(
+				r2, out_1st_deriv, out_2nd_deriv);
+		case rkDCS:
+			return RobustKernel<rkDCS, T>{param_sq}.eval(
+				r2, out_1st_deriv, out_2nd_deriv);
+		case rkGemanMcClure:
+			return RobustKernel<rkGemanMcClure, T>{param_sq}.eval(
+				r2, out_1st_deriv, out_2nd_deriv);
+	};
+	throw std::invalid_argument("evalRobustKernel: Unknown kernel type");
+}
+
 /** @} */  // end of grouping
 }
 
+MRPT_ENUM_TYPE_BEGIN(mrpt::math::TRobustKernelType)
+using namespace mrpt::math;
+MRPT_FILL_ENUM(rkLeastSquares);
+MRPT_FILL_ENUM(rkPseudoHuber);
+MRPT_FILL_ENUM(rkHuber);
+MRPT_FILL_ENUM(rkCauchy);
+MRPT_FILL_ENUM(rkDCS);
+MRPT_FILL_ENUM(rkGemanMcClure);
+MRPT_ENUM_TYPE_END()
+
@@ -12,6 +12,7 @@
 #include <mrpt/math/CSparseMatrix.h>
 #include <string>
 #include <iostream>
+#include <algorithm>
 
 using std::string;
 using std::cout;
@@ -273,6 +274,43 @@ void CSparseMatrix::compressFromTriplet()
 	// internal buffers, now set to NULL.
 }
 
+void CSparseMatrix::setColumnCompressed(
+	const size_t nRows, const size_t nCols, const std::vector<int>& col_ptrs,
+	const std::vector<int>& row_idxs, const std::vector<double>& values)
+{
+	ASSERT_EQUAL_(col_ptrs.size(), nCols + 1);
+	const size_t nnz = col_ptrs.back();
+	ASSERT_(row_idxs.size() >= nnz && values.size() >= nnz);
+
+	internal_free_mem();
+	sparse_matrix.m = nRows;
+	sparse_matrix.n = nCols;
+	sparse_matrix.nzmax = std::max<size_t>(nnz, 1);
+	sparse_matrix.nz = -1;  // column-compressed
+	sparse_matrix.p = (int*)malloc(sizeof(int) * (nCols + 1));
+	sparse_matrix.i = (int*)malloc(sizeof(int) * sparse_matrix.nzmax);
+	sparse_matrix.x = (double*)malloc(sizeof(double) * sparse_matrix.nzmax);
+	::memcpy(sparse_matrix.p, &col_ptrs[0], sizeof(int) * (nCols + 1));
+	if (nnz)
+	{
+		::memcpy(sparse_matrix.i, &row_idxs[0], sizeof(int) * nnz);
+		::memcpy(sparse_matrix.x, &values[0], sizeof(double) * nnz);
+	}
+}
+
+std::vector<int> CSparseMatrix::computeFillReducingOrdering() const
+{
+	ASSERT_(isColumnCompressed());
+	ASSERT_(rows() == cols());
+	int* P = cs_amd(1 /* Cholesky: amd(A+A') */, &sparse_matrix);
+	if (!P)
+		THROW_EXCEPTION(
+			"computeFillReducingOrdering(): Error computing AMD ordering.");
+	std::vector<int> ret(P, P + sparse_matrix.n);
+	cs_free(P);
+	return ret;
+}
+
 /** save as a dense matrix to a text file \return False on any error.
 */
 bool CSparseMatrix::saveToTextFile_dense(const std::string& filName)
@@ -374,6 +412,48 @@ CSparseMatrix::CholeskyDecomp::CholeskyDecomp(const CSparseMatrix& SM)
 			"CSparseMatrix::CholeskyDecomp: Not positive definite matrix.");
 }
 
+/** Symbolic Cholesky analysis (as in cs_schol()) for a given ordering */
+static css* schol_with_ordering(const cs* A, const int* P)
+{
+	const int n = A->n;
+	css* S = (css*)cs_calloc(1, sizeof(css));
+	if (!S) return nullptr;
+	S->pinv = cs_pinv(P, n);
+	if (!S->pinv) return cs_sfree(S);
+	cs* C = cs_symperm(A, S->pinv, 0);
+	S->parent = cs_etree(C, 0);
+	int* post = cs_post(S->parent, n);
+	int* c = cs_counts(C, S->parent, post, 0);
+	cs_free(post);
+	cs_spfree(C);
+	S->cp = (int*)cs_malloc(n + 1, sizeof(int));
+	S->unz = S->lnz = cs_cumsum(S->cp, c, n);
+	cs_free(c);
+	return (S->lnz >= 0) ? S : cs_sfree(S);
+}
+
+CSparseMatrix::CholeskyDecomp::CholeskyDecomp(
+	const CSparseMatrix& SM, const std::vector<int>& ordering)
+	: m_symbolic_structure(nullptr),
+	  m_numeric_structure(nullptr),
+	  m_originalSM(&SM)
+{
+	ASSERT_(SM.cols() == SM.rows());
+	ASSERT_(SM.isColumnCompressed());
+	ASSERT_EQUAL_(ordering.size(), SM.cols());
+
+	m_symbolic_structure =
+		schol_with_ordering(&m_originalSM->sparse_matrix, &ordering[0]);
+	ASSERTMSG_(m_symbolic_structure, "Invalid ordering");
+
+	m_numeric_structure =
+		cs_chol(&m_originalSM->sparse_matrix, m_symbolic_structure);
+
+	if (!m_numeric_structure)
+		throw mrpt::math::CExceptionNotDefPos(
+			"CSparseMatrix::CholeskyDecomp: Not positive definite matrix.");
+}
+
 // Destructor:
 CSparseMatrix::CholeskyDecomp::~CholeskyDecomp()
 {
@@ -233,3 +233,52 @@ TEST(SparseMatrix, CholeskyDecomp)
 	const double err = ((Ud.transpose()) - L).array().abs().mean();
 	EXPECT_TRUE(err < 1e-8);
 }
+
+TEST(SparseMatrix, CholeskyDecompWithOrdering)
+{
+	// Arrow-like matrix: the natural ordering fills in the whole factor.
+	const size_t N = 12;
+	CMatrixDouble D(N, N);
+	D.zeros();
+	for (size_t i = 0; i < N; i++)
+	{
+		D(i, i) = 2.0 * N;
+		D(0, i) = D(i, 0) = 1.0;
+	}
+	D(0, 0) = 2.0 * N;
+
+	CSparseMatrix SM(D);
+	const std::vector<int> P = SM.computeFillReducingOrdering();
+	ASSERT_EQ(P.size(), N);
+	EXPECT_EQ(P.back(), 0);  // The dense row/column is eliminated last
+
+	CSparseMatrix::CholeskyDecomp Chol1(SM), Chol2(SM, P);
+	Eigen::VectorXd b(N), x1, x2;
+	for (size_t i = 0; i < N; i++) b[i] = i;
+	Chol1.backsub(b, x1);
+	Chol2.backsub(b, x2);
+	EXPECT_NEAR(0, (x1 - x2).array().abs().maxCoeff(), 1e-9);
+	EXPECT_NEAR(0, (D * x2 - b).array().abs().maxCoeff(), 1e-9);
+
+	// Rebuild from the column-compressed arrays of the upper triangle,
+	// then update the numeric factorization:
+	std::vector<int> col_ptrs{0}, row_idxs;
+	std::vector<double> values;
+	for (size_t c = 0; c < N; c++)
+	{
+		for (size_t r = 0; r <= c; r++)
+			if (D(r, c) != 0)
+			{
+				row_idxs.push_back(r);
+				values.push_back(2 * D(r, c));
+			}
+		col_ptrs.push_back(row_idxs.size());
+	}
+	CSparseMatrix SM2;
+	SM2.setColumnCompressed(N, N, col_ptrs, row_idxs, values);
+	EXPECT_TRUE(SM2.isColumnCompressed());
+
+	CSparseMatrix::CholeskyDecomp Chol3(SM2, P);
+	Chol3.backsub(b, x1);
+	EXPECT_NEAR(0, (2 * D * x1 - b).array().abs().maxCoeff(), 1e-9);
+}
@@ -35,6 +35,48 @@ const double list_test_kernel_pshb[][5] = {
 	{4.0, 4.0, 3.31371, 0.707107, -0.0441942},
 	{4.0, 9.0, 3.63331, 0.83205, -0.0320019}};
 
+// =============  Kernel: Huber
+const double list_test_kernel_huber[][5] = {
+	{1.0, 1.0, 1.0, 1.0, 0.0},
+	{1.0, 4.0, 1.0, 1.0, 0.0},
+	{4.0, 1.0, 3.0, 0.5, -0.0625},
+	{4.0, 4.0, 4.0, 1.0, 0.0},
+	{16.0, 1.0, 7.0, 0.25, -0.0078125},
+	{16.0, 4.0, 12.0, 0.5, -0.015625},
+	{16.0, 9.0, 15.0, 0.75, -0.0234375}};
+
+// =============  Kernel: Cauchy
+const double list_test_kernel_cauchy[][5] = {
+	{0.0, 1.0, 0.0, 1.0, -1.0},
+	{0.0, 4.0, 0.0, 1.0, -0.25},
+	{1.0, 1.0, 0.693147, 0.5, -0.25},
+	{1.0, 4.0, 0.892574, 0.8, -0.16},
+	{1.0, 9.0, 0.948245, 0.9, -0.09},
+	{4.0, 1.0, 1.60944, 0.2, -0.04},
+	{4.0, 4.0, 2.77259, 0.5, -0.0625},
+	{4.0, 9.0, 3.30952, 0.692308, -0.0532544}};
+
+// =============  Kernel: DCS
+const double list_test_kernel_dcs[][5] = {
+	{1.0, 1.0, 1.0, 1.0, 0.0},
+	{1.0, 4.0, 1.0, 1.0, 0.0},
+	{4.0, 1.0, 0.64, 0.16, 0.0},
+	{4.0, 4.0, 4.0, 1.0, 0.0},
+	{16.0, 1.0, 0.221453, 0.0138408, 0.0},
+	{16.0, 4.0, 2.56, 0.16, 0.0},
+	{16.0, 9.0, 8.2944, 0.5184, 0.0}};
+
+// =============  Kernel: Geman-McClure
+const double list_test_kernel_gm[][5] = {
+	{0.0, 1.0, 0.0, 1.0, -2.0},
+	{0.0, 4.0, 0.0, 1.0, -0.5},
+	{1.0, 1.0, 0.5, 0.25, -0.25},
+	{1.0, 4.0, 0.8, 0.64, -0.256},
+	{1.0, 9.0, 0.9, 0.81, -0.162},
+	{4.0, 1.0, 0.8, 0.04, -0.016},
+	{4.0, 4.0, 2.0, 0.25, -0.0625},
+	{4.0, 9.0, 2.76923, 0.47929, -0.0737369}};
+
 template <TRobustKernelType KERNEL_TYPE>
 void tester_robust_kernel(const double table[][5], const size_t N)
 {
@@ -72,3 +114,53 @@ TEST(RobustKernels, PseudoHuber)
 		sizeof(list_test_kernel_pshb) / sizeof(list_test_kernel_pshb[0]);
 	tester_robust_kernel<rkPseudoHuber>(list_test_kernel_pshb, N);
 }
+
+TEST(RobustKernels, Huber)
+{
+	const size_t N =
+		sizeof(list_test_kernel_huber) / sizeof(list_test_kernel_huber[0]);
+	tester_robust_kernel<rkHuber>(list_test_kernel_huber, N);
+}
+
+TEST(RobustKernels, Cauchy)
+{
+	const size_t N =
+		sizeof(list_test_kernel_cauchy) / sizeof(list_test_kernel_cauchy[0]);
+	tester_robust_kernel<rkCauchy>(list_test_kernel_cauchy, N);
+}
+
+TEST(RobustKernels, DCS)
+{
+	const size_t N =
+		sizeof(list_test_kernel_dcs) / sizeof(list_test_kernel_dcs[0]);
+	tester_robust_kernel<rkDCS>(list_test_kernel_dcs, N);
+}
+
+TEST(RobustKernels, GemanMcClure)
+{
+	const size_t N =
+		sizeof(list_test_kernel_gm) / sizeof(list_test_kernel_gm[0]);
+	tester_robust_kernel<rkGemanMcClure>(list_test_kernel_gm, N);
+}
+
+TEST(RobustKernels, evalRobustKernel)
+{
+	for (const auto type : {rkLeastSquares, rkPseudoHuber, rkHuber, rkCauchy,
+							rkDCS, rkGemanMcClure})
+	{
+		const std::string name =
+			mrpt::typemeta::TEnumType<TRobustKernelType>::value2name(type);
+		EXPECT_EQ(
+			type, mrpt::typemeta::TEnumType<TRobustKernelType>::name2value(
+					  name));
+
+		double d1, d2;
+		const double r2 = evalRobustKernel(type, 4.0, 9.0, d1, d2);
+		EXPECT_GE(d1, 0.0);
+		EXPECT_LE(d1, 1.0);
+		EXPECT_LE(r2, 9.0);
+	}
+	double d1, d2;
+	EXPECT_NEAR(evalRobustKernel(rkHuber, 1.0, 16.0, d1, d2), 7.0, 1e-9);
+	EXPECT_NEAR(d1, 0.25, 1e-9);
+}
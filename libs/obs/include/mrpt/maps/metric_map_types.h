@@ -40,6 +40,11 @@ struct TMatchingParams
 	/** The point used to calculate angular distances: e.g. the coordinates of
 	 * the sensor for a 2D laser scanner. */
 	mrpt::math::TPoint3D angularDistPivotPoint;
+	/** Number of threads for the KD-tree queries of the points maps, the
+	 * most expensive step of the matching. Results (including the order of
+	 * the pairings) are identical to the single-threaded search.
+	 * (Default=1: single thread, 0: all cores) */
+	unsigned int numThreads;
 
 	/** Ctor: default values */
 	TMatchingParams()
@@ -49,7 +54,8 @@ struct TMatchingParams
 		  onlyUniqueRobust(false),
 		  decimation_other_map_points(1),
 		  offset_other_map_points(0),
-		  angularDistPivotPoint(0, 0, 0)
+		  angularDistPivotPoint(0, 0, 0),
+		  numThreads(1)
 	{
 	}
 };
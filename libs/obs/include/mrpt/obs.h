@@ -57,6 +57,8 @@ MRPT_WARNING(
 
 // Others:
 #include <mrpt/obs/CRawlog.h>
+#include <mrpt/obs/CIndexedRawlog.h>
+#include <mrpt/obs/CRawlogStreamReader.h>
 #include <mrpt/obs/carmen_log_tools.h>
 #include <mrpt/obs/obs_utils.h>
 
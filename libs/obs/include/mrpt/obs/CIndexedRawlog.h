@@ -0,0 +1,215 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/serialization/CSerializable.h>
+#include <mrpt/io/CFileInputStream.h>
+#include <mrpt/io/CFileOutputStream.h>
+#include <mrpt/io/CMemoryStream.h>
+#include <mrpt/system/datetime.h>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace mrpt::obs
+{
+/** The metadata of each entry in an indexed rawlog file, which is available
+ * without deserializing the entry.
+ * \sa CIndexedRawlogReader, CIndexedRawlogWriter
+ * \ingroup mrpt_obs_grp
+ */
+struct TIndexedRawlogEntry
+{
+	/** The timestamp of the observation. For a CSensoryFrame or a
+	 * CActionCollection, that of its first element. INVALID_TIMESTAMP for
+	 * other classes or if unknown. */
+	mrpt::system::TTimeStamp timestamp{INVALID_TIMESTAMP};
+	/** The sensor label of the observation (empty for other classes) */
+	std::string sensorLabel;
+	/** The name of the C++ class of the entry */
+	std::string className;
+	/** The compressed chunk of the file where the entry is stored */
+	uint32_t chunk{0};
+	/** The offset of the entry within the uncompressed chunk (bytes) */
+	uint32_t offset{0};
+	/** The size of the serialized entry (bytes) */
+	uint32_t size{0};
+
+	/** Fills in the timestamp, sensor label and class name of an object */
+	void setFromObject(const mrpt::serialization::CSerializable& obj);
+};
+
+/** Writes an indexed rawlog file, a rawlog container which supports random
+ * access to its entries, and queries by time or by sensor label.
+ *
+ * Entries (observations, CSensoryFrame's, CActionCollection's, or any other
+ * CSerializable object) are serialized as in a plain rawlog file, but grouped
+ * into chunks of about \a chunkSize bytes, each compressed independently with
+ * zlib. Once all the entries are written, close() appends an index with the
+ * position in the file, the timestamp, the sensor label and the class name of
+ * each entry. File layout:
+ *  - A header: the magic string "MRPTIRLG" and a format version (uint32).
+ *  - The compressed chunks.
+ *  - The index, compressed: the table of chunks (file offset, compressed and
+ *    uncompressed sizes) and the table of entries (TIndexedRawlogEntry).
+ *  - A footer: the file offset and the compressed and uncompressed sizes of
+ *    the index (uint64), and the magic string again.
+ *
+ * \note A file not closed (e.g. if the program crashes while writing it) has
+ * no index, and cannot be read.
+ * \sa CIndexedRawlogReader, CRawlog::saveToIndexedRawLogFile
+ * \ingroup mrpt_obs_grp
+ */
+class CIndexedRawlogWriter
+{
+   public:
+	/** The default size of the chunks, before compression (bytes) */
+	static constexpr size_t DEFAULT_CHUNK_SIZE = 1024 * 1024;
+
+	CIndexedRawlogWriter() = default;
+	/** Constructor which opens a file for writing.
+	 * \exception std::exception On error opening the file. */
+	CIndexedRawlogWriter(
+		const std::string& fileName,
+		const size_t chunkSize = DEFAULT_CHUNK_SIZE);
+	/** Destructor, which closes the file (see close()) */
+	~CIndexedRawlogWriter();
+
+	CIndexedRawlogWriter(const CIndexedRawlogWriter&) = delete;
+	CIndexedRawlogWriter& operator=(const CIndexedRawlogWriter&) = delete;
+
+	/** Opens a file for writing, closing the previous one, if any.
+	 * \return false on error opening the file. */
+	bool open(
+		const std::string& fileName,
+		const size_t chunkSize = DEFAULT_CHUNK_SIZE);
+	/** Returns true if a file is open */
+	bool is_open() const { return m_open; }
+	/** Writes the index, and closes the file. Does nothing if no file is
+	 * open. */
+	void close();
+
+	/** Appends an entry to the file */
+	void write(const mrpt::serialization::CSerializable& obj);
+	/** Appends an entry already serialized (e.g. from
+	 * CIndexedRawlogReader::getSerializedEntry()), with the timestamp, sensor
+	 * label and class name in \a info (its position fields are ignored). */
+	void writeSerialized(
+		const TIndexedRawlogEntry& info, const void* data, const size_t size);
+
+	/** The number of entries written so far */
+	size_t size() const { return m_entries.size(); }
+
+   private:
+	struct TChunk
+	{
+		uint64_t fileOffset, compressedSize, size;
+	};
+	mrpt::io::CFileOutputStream m_file;
+	bool m_open{false};
+	size_t m_chunkSize{DEFAULT_CHUNK_SIZE};
+	/** The current chunk, not compressed yet */
+	mrpt::io::CMemoryStream m_chunk;
+	std::vector<TChunk> m_chunks;
+	std::vector<TIndexedRawlogEntry> m_entries;
+
+	/** Compresses and writes the current chunk, if not empty */
+	void flushChunk();
+	/** Records the entry which has just been written into m_chunk */
+	void addEntry(const TIndexedRawlogEntry& info, const uint64_t start);
+};
+
+/** Reads an indexed rawlog file (see CIndexedRawlogWriter for its format).
+ *
+ * Opening a file only reads its index, in O(N) with the number of entries.
+ * Then, each entry can be read at any time with getEntry(), which only
+ * decompresses the chunk where the entry is stored (the last chunk is cached,
+ * so reading entries in order decompresses each chunk once), and
+ * deserializes that entry alone. The timestamp, sensor label and class name
+ * of all the entries are available from the index, without deserializing
+ * them, and entries can be looked up by time range or sensor label in
+ * O(log(N)) and O(log(L)), respectively (L: number of distinct sensor
+ * labels), plus the number of entries found.
+ *
+ * \sa CIndexedRawlogWriter, CRawlog::loadFromIndexedRawLogFile
+ * \ingroup mrpt_obs_grp
+ */
+class CIndexedRawlogReader
+{
+   public:
+	CIndexedRawlogReader() = default;
+	/** Constructor which opens a file.
+	 * \exception std::exception On error opening or reading the file. */
+	CIndexedRawlogReader(const std::string& fileName);
+
+	/** Opens a file and loads its index, closing the previous one, if any.
+	 * \return false if the file cannot be opened or is not an indexed rawlog.
+	 */
+	bool open(const std::string& fileName);
+	/** Returns true if a file is open */
+	bool is_open() const { return m_open; }
+	/** Closes the file */
+	void close();
+
+	/** The number of entries in the file */
+	size_t size() const { return m_entries.size(); }
+	/** The timestamp, sensor label and class name of an entry (0-based).
+	 * \exception std::exception On index out of bounds. */
+	const TIndexedRawlogEntry& getEntryInfo(const size_t index) const;
+
+	/** Reads and deserializes one entry (0-based).
+	 * \exception std::exception On index out of bounds, or error reading the
+	 * file. */
+	mrpt::serialization::CSerializable::Ptr getEntry(const size_t index);
+	/** Reads one entry without deserializing it (see
+	 * CIndexedRawlogWriter::writeSerialized()).
+	 * \exception std::exception On index out of bounds, or error reading the
+	 * file. */
+	void getSerializedEntry(const size_t index, std::vector<uint8_t>& data);
+
+	/** Returns the indices (in ascending order) of the entries with a
+	 * timestamp in the range [t0,t1]. Entries without timestamp are never
+	 * returned. */
+	std::vector<size_t> findEntriesInTimeRange(
+		const mrpt::system::TTimeStamp t0,
+		const mrpt::system::TTimeStamp t1) const;
+	/** Returns the indices (in ascending order) of the observations with the
+	 * given sensor label. */
+	const std::vector<size_t>& findEntriesBySensorLabel(
+		const std::string& sensorLabel) const;
+	/** Returns the sensor labels of all the observations in the file */
+	std::vector<std::string> getSensorLabels() const;
+
+	/** Returns true if the given file exists and is an indexed rawlog (as
+	 * opposed to a plain rawlog file) */
+	static bool isIndexedRawlog(const std::string& fileName);
+
+   private:
+	struct TChunk
+	{
+		uint64_t fileOffset, compressedSize, size;
+	};
+	mrpt::io::CFileInputStream m_file;
+	bool m_open{false};
+	std::vector<TChunk> m_chunks;
+	std::vector<TIndexedRawlogEntry> m_entries;
+	/** Indices of the entries with timestamp, sorted by time */
+	std::vector<size_t> m_sortedByTime;
+	std::map<std::string, std::vector<size_t>> m_bySensorLabel;
+
+	/** The last chunk decompressed, and its index */
+	std::vector<uint8_t> m_chunkData, m_compressedData;
+	size_t m_cachedChunk{std::string::npos};
+
+	/** Loads a chunk into m_chunkData (if not already there) */
+	void loadChunk(const size_t chunk);
+};
+
+}  // namespace mrpt::obs
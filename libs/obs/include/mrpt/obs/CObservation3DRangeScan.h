@@ -48,6 +48,15 @@ struct T3DPointsProjectionParams
 	bool MAKE_DENSE;
 	/** (Default:false) set to true if you want an organized point cloud */
 	bool MAKE_ORGANIZED;
+	/** (Default:1) Number of threads to use (0: as many as CPU cores). Values
+	 * other than 1, or \a decimation>1, select a single-pass kernel which
+	 * filters, colors and transforms each point as soon as it is generated,
+	 * writing it directly into the output point cloud. */
+	unsigned int numThreads;
+	/** (Default:1) Only use one out of each \a decimation rows and columns
+	 * of the range image. Organized clouds (\a MAKE_ORGANIZED) have then
+	 * ceil(H/decimation) x ceil(W/decimation) points. */
+	unsigned int decimation;
 
 	T3DPointsProjectionParams()
 		: takeIntoAccountSensorPoseOnRobot(false),
@@ -55,7 +64,9 @@ struct T3DPointsProjectionParams
 		  PROJ3D_USE_LUT(true),
 		  USE_SSE2(true),
 		  MAKE_DENSE(true),
-		  MAKE_ORGANIZED(false)
+		  MAKE_ORGANIZED(false),
+		  numThreads(1),
+		  decimation(1)
 	{
 	}
 };
@@ -453,6 +464,25 @@ class CObservation3DRangeScan : public CObservation
 	/** Similar to calling "rangeImage.setSize(H,W)" but this method provides
 	 * memory pooling to speed-up the memory allocation. */
 	void rangeImage_setSize(const int HEIGHT, const int WIDTH);
+
+	/** Enum type for rangeImageCodec */
+	enum TRangeImageCodec : uint8_t
+	{
+		/** Raw float values (the default) */
+		RANGE_CODEC_NONE = 0,
+		/** Lossless: the float values, as differences between consecutive
+		 * pixels of each row, compressed with zlib. */
+		RANGE_CODEC_LOSSLESS,
+		/** Ranges rounded to millimeters, stored as 16-bit integers (up to
+		 * 65.535 m) and compressed as RANGE_CODEC_LOSSLESS. Lossless in
+		 * practice for sensors with millimeter resolution (Kinect, OpenNI2
+		 * cameras,...), and usually much smaller. */
+		RANGE_CODEC_MM16
+	};
+	/** How \a rangeImage is encoded when this observation is serialized.
+	 * Deserialized observations keep the codec they were saved with.
+	 * \note [New in MRPT 2.0.0] */
+	TRangeImageCodec rangeImageCodec{RANGE_CODEC_NONE};
 	/** @} */
 
 	/** \name Range Matrix external storage functions
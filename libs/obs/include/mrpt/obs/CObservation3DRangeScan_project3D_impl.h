@@ -10,6 +10,9 @@
 #define CObservation3DRangeScan_project3D_impl_H
 
 #include <mrpt/core/round.h>  // round()
+#include <mrpt/system/thread_pool.h>
+#include <algorithm>
+#include <numeric>
 
 namespace mrpt::obs::detail
 {
@@ -29,6 +32,142 @@ void do_project_3d_pointcloud_SSE2(
 	mrpt::opengl::PointCloudAdapter<POINTMAP>& pca,
 	std::vector<uint16_t>& idxs_x, std::vector<uint16_t>& idxs_y,
 	const mrpt::obs::TRangeImageFilterParams& filterParams, bool MAKE_DENSE);
+template <class POINTMAP>
+void do_project_3d_pointcloud_fused(
+	mrpt::obs::CObservation3DRangeScan& src_obs,
+	mrpt::opengl::PointCloudAdapter<POINTMAP>& pca,
+	const mrpt::obs::T3DPointsProjectionParams& projectParams,
+	const mrpt::obs::TRangeImageFilterParams& filterParams);
+
+/** Assigns to each local point the color of the pixel it projects onto in
+ * the intensity image, or white if it falls out of it. */
+struct TProject3DColorizer
+{
+	const mrpt::img::CImage& img;
+	const int imgW, imgH;
+	const bool hasColorIntensityImg;
+	const float cx, cy, fx, fy;
+	// Unless we are in a special case (both depth & RGB images coincide)...
+	const bool isDirectCorresp;
+	// ...precompute the inverse of the pose transformation out of the loop,
+	//  store as a 4x4 homogeneous matrix to exploit SSE optimizations below:
+	mrpt::math::CMatrixFixedNumeric<float, 4, 4> T_inv;
+
+	TProject3DColorizer(const mrpt::obs::CObservation3DRangeScan& src_obs)
+		: img(src_obs.intensityImage),
+		  imgW(src_obs.intensityImage.getWidth()),
+		  imgH(src_obs.intensityImage.getHeight()),
+		  hasColorIntensityImg(src_obs.intensityImage.isColor()),
+		  cx(src_obs.cameraParamsIntensity.cx()),
+		  cy(src_obs.cameraParamsIntensity.cy()),
+		  fx(src_obs.cameraParamsIntensity.fx()),
+		  fy(src_obs.cameraParamsIntensity.fy()),
+		  isDirectCorresp(src_obs.doDepthAndIntensityCamerasCoincide())
+	{
+		// Delay-load external images here, not from worker threads:
+		img.forceLoad();
+		if (!isDirectCorresp)
+		{
+			mrpt::math::CMatrixFixedNumeric<double, 3, 3> R_inv;
+			mrpt::math::CMatrixFixedNumeric<double, 3, 1> t_inv;
+			mrpt::math::homogeneousMatrixInverse(
+				src_obs.relativePoseIntensityWRTDepth.getRotationMatrix(),
+				src_obs.relativePoseIntensityWRTDepth.m_coords, R_inv, t_inv);
+
+			T_inv(3, 3) = 1;
+			T_inv.block<3, 3>(0, 0) = R_inv.cast<float>();
+			T_inv.block<3, 1>(0, 3) = t_inv.cast<float>();
+		}
+	}
+
+	/** Sets the color of the i'th point, with local coordinates (x,y,z)
+	 * and generated from the range image pixel (c,r). */
+	template <class POINTMAP>
+	inline void setColor(
+		mrpt::opengl::PointCloudAdapter<POINTMAP>& pca, const size_t i,
+		const float x, const float y, const float z, const int c,
+		const int r) const
+	{
+		int img_idx_x, img_idx_y;  // projected pixel coordinates, in the
+		// RGB image plane
+		bool pointWithinImage = false;
+		if (isDirectCorresp)
+		{
+			pointWithinImage = true;
+			img_idx_x = c;
+			img_idx_y = r;
+		}
+		else
+		{
+			// Project the point, in local coordinates wrt the depth camera,
+			// into the intensity camera:
+			Eigen::Matrix<float, 4, 1> pt_wrt_color, pt_wrt_depth;
+			pt_wrt_depth << x, y, z, 1;
+			pt_wrt_color = T_inv * pt_wrt_depth;
+
+			// Project to image plane:
+			if (pt_wrt_color[2])
+			{
+				img_idx_x =
+					mrpt::round(cx + fx * pt_wrt_color[0] / pt_wrt_color[2]);
+				img_idx_y =
+					mrpt::round(cy + fy * pt_wrt_color[1] / pt_wrt_color[2]);
+				pointWithinImage = img_idx_x >= 0 && img_idx_x < imgW &&
+								   img_idx_y >= 0 && img_idx_y < imgH;
+			}
+		}
+
+		mrpt::img::TColor pCol;
+		if (pointWithinImage)
+		{
+			if (hasColorIntensityImg)
+			{
+				const uint8_t* col = img.get_unsafe(img_idx_x, img_idx_y, 0);
+				pCol.R = col[2];
+				pCol.G = col[1];
+				pCol.B = col[0];
+			}
+			else
+			{
+				uint8_t col = *img.get_unsafe(img_idx_x, img_idx_y, 0);
+				pCol.R = pCol.G = pCol.B = col;
+			}
+		}
+		else
+		{
+			pCol.R = pCol.G = pCol.B = 255;
+		}
+		// Set color:
+		pca.setPointRGBu8(i, pCol.R, pCol.G, pCol.B);
+	}
+};
+
+/** Gets the 6D transformation to apply to local points, as a homogeneous
+ * matrix, and returns false if there is none. */
+inline bool get_project_3d_transform(
+	const mrpt::obs::CObservation3DRangeScan& src_obs,
+	const mrpt::obs::T3DPointsProjectionParams& projectParams,
+	Eigen::Matrix<float, 4, 4>& HM)
+{
+	if (!projectParams.takeIntoAccountSensorPoseOnRobot &&
+		!projectParams.robotPoseInTheWorld)
+		return false;
+
+	mrpt::poses::CPose3D transf_to_apply;  // Either ROBOTPOSE or
+	// ROBOTPOSE(+)SENSORPOSE or
+	// SENSORPOSE
+	if (projectParams.takeIntoAccountSensorPoseOnRobot)
+		transf_to_apply = src_obs.sensorPose;
+	if (projectParams.robotPoseInTheWorld)
+		transf_to_apply.composeFrom(
+			*projectParams.robotPoseInTheWorld,
+			mrpt::poses::CPose3D(transf_to_apply));
+
+	HM = transf_to_apply
+			 .getHomogeneousMatrixVal<mrpt::math::CMatrixDouble44>()
+			 .cast<float>();
+	return true;
+}
 
 template <class POINTMAP>
 void project3DPointsFromDepthImageInto(
@@ -42,6 +181,13 @@ void project3DPointsFromDepthImageInto(
 
 	mrpt::opengl::PointCloudAdapter<POINTMAP> pca(dest_pointcloud);
 
+	if (projectParams.numThreads != 1 || projectParams.decimation > 1)
+	{
+		do_project_3d_pointcloud_fused(
+			src_obs, pca, projectParams, filterParams);
+		return;
+	}
+
 	// ------------------------------------------------------------
 	// Stage 1/3: Create 3D point cloud local coordinates
 	// ------------------------------------------------------------
@@ -207,98 +353,18 @@ void project3DPointsFromDepthImageInto(
 	// -------------------------------------------------------------
 	if (src_obs.hasIntensityImage)
 	{
-		const int imgW = src_obs.intensityImage.getWidth();
-		const int imgH = src_obs.intensityImage.getHeight();
-		const bool hasColorIntensityImg = src_obs.intensityImage.isColor();
-
-		const float cx = src_obs.cameraParamsIntensity.cx();
-		const float cy = src_obs.cameraParamsIntensity.cy();
-		const float fx = src_obs.cameraParamsIntensity.fx();
-		const float fy = src_obs.cameraParamsIntensity.fy();
-
-		// Unless we are in a special case (both depth & RGB images coincide)...
-		const bool isDirectCorresp =
-			src_obs.doDepthAndIntensityCamerasCoincide();
-
-		// ...precompute the inverse of the pose transformation out of the loop,
-		//  store as a 4x4 homogeneous matrix to exploit SSE optimizations
-		//  below:
-		mrpt::math::CMatrixFixedNumeric<float, 4, 4> T_inv;
-		if (!isDirectCorresp)
-		{
-			mrpt::math::CMatrixFixedNumeric<double, 3, 3> R_inv;
-			mrpt::math::CMatrixFixedNumeric<double, 3, 1> t_inv;
-			mrpt::math::homogeneousMatrixInverse(
-				src_obs.relativePoseIntensityWRTDepth.getRotationMatrix(),
-				src_obs.relativePoseIntensityWRTDepth.m_coords, R_inv, t_inv);
-
-			T_inv(3, 3) = 1;
-			T_inv.block<3, 3>(0, 0) = R_inv.cast<float>();
-			T_inv.block<3, 1>(0, 3) = t_inv.cast<float>();
-		}
-
-		Eigen::Matrix<float, 4, 1> pt_wrt_color, pt_wrt_depth;
-		pt_wrt_depth[3] = 1;
-
-		mrpt::img::TColor pCol;
+		const TProject3DColorizer colorizer(src_obs);
 
 		// For each local point:
+		float x, y, z;
 		const size_t nPts = pca.size();
 		for (size_t i = 0; i < nPts; i++)
 		{
-			int img_idx_x, img_idx_y;  // projected pixel coordinates, in the
-			// RGB image plane
-			bool pointWithinImage = false;
-			if (isDirectCorresp)
-			{
-				pointWithinImage = true;
-				img_idx_x = src_obs.points3D_idxs_x[i];
-				img_idx_y = src_obs.points3D_idxs_y[i];
-			}
-			else
-			{
-				// Project point, which is now in "pca" in local coordinates wrt
-				// the depth camera, into the intensity camera:
-				pca.getPointXYZ(
-					i, pt_wrt_depth[0], pt_wrt_depth[1], pt_wrt_depth[2]);
-				pt_wrt_color = T_inv * pt_wrt_depth;
-
-				// Project to image plane:
-				if (pt_wrt_color[2])
-				{
-					img_idx_x = mrpt::round(
-						cx + fx * pt_wrt_color[0] / pt_wrt_color[2]);
-					img_idx_y = mrpt::round(
-						cy + fy * pt_wrt_color[1] / pt_wrt_color[2]);
-					pointWithinImage = img_idx_x >= 0 && img_idx_x < imgW &&
-									   img_idx_y >= 0 && img_idx_y < imgH;
-				}
-			}
-
-			if (pointWithinImage)
-			{
-				if (hasColorIntensityImg)
-				{
-					const uint8_t* c = src_obs.intensityImage.get_unsafe(
-						img_idx_x, img_idx_y, 0);
-					pCol.R = c[2];
-					pCol.G = c[1];
-					pCol.B = c[0];
-				}
-				else
-				{
-					uint8_t c = *src_obs.intensityImage.get_unsafe(
-						img_idx_x, img_idx_y, 0);
-					pCol.R = pCol.G = pCol.B = c;
-				}
-			}
-			else
-			{
-				pCol.R = pCol.G = pCol.B = 255;
-			}
-			// Set color:
-			pca.setPointRGBu8(i, pCol.R, pCol.G, pCol.B);
-		}  // end for each point
+			pca.getPointXYZ(i, x, y, z);
+			colorizer.setColor(
+				pca, i, x, y, z, src_obs.points3D_idxs_x[i],
+				src_obs.points3D_idxs_y[i]);
+		}
 	}  // end if src_obs has intensity image
 
 	// ...
@@ -306,23 +372,9 @@ void project3DPointsFromDepthImageInto(
 	// ------------------------------------------------------------
 	// Stage 3/3: Apply 6D transformations
 	// ------------------------------------------------------------
-	if (projectParams.takeIntoAccountSensorPoseOnRobot ||
-		projectParams.robotPoseInTheWorld)
+	Eigen::Matrix<float, 4, 4> HM;
+	if (get_project_3d_transform(src_obs, projectParams, HM))
 	{
-		mrpt::poses::CPose3D transf_to_apply;  // Either ROBOTPOSE or
-		// ROBOTPOSE(+)SENSORPOSE or
-		// SENSORPOSE
-		if (projectParams.takeIntoAccountSensorPoseOnRobot)
-			transf_to_apply = src_obs.sensorPose;
-		if (projectParams.robotPoseInTheWorld)
-			transf_to_apply.composeFrom(
-				*projectParams.robotPoseInTheWorld,
-				mrpt::poses::CPose3D(transf_to_apply));
-
-		const Eigen::Matrix<float, 4, 4> HM =
-			transf_to_apply
-				.getHomogeneousMatrixVal<mrpt::math::CMatrixDouble44>()
-				.cast<float>();
 		Eigen::Matrix<float, 4, 1> pt, pt_transf;
 		pt[3] = 1;
 
@@ -349,7 +401,7 @@ inline void do_project_3d_pointcloud(
 	// Preconditions: minRangeMask() has the right size
 	size_t idx = 0;
 	for (int r = 0; r < H; r++)
-		for (int c = 0; c < W; c++)
+		for (int c = 0; c < W; c++, kys++, kzs++)
 		{
 			const float D = rangeImage.coeff(r, c);
 			if (!rif.do_range_filter(r, c, D))
@@ -362,7 +414,7 @@ inline void do_project_3d_pointcloud(
 				continue;
 			}
 
-			pca.setPointXYZ(idx, D /*x*/, *kys++ * D /*y*/, *kzs++ * D /*z*/);
+			pca.setPointXYZ(idx, D /*x*/, *kys * D /*y*/, *kzs * D /*z*/);
 			idxs_x[idx] = c;
 			idxs_y[idx] = r;
 			++idx;
@@ -499,6 +551,134 @@ inline void do_project_3d_pointcloud_SSE2(
 	pca.resize(idx);
 #endif
 }
+
+// Single-pass projection: range filter, decimation, colors and 6D
+// transformation are applied to each point as it is generated, and rows are
+// split among the threads of a pool.
+template <class POINTMAP>
+inline void do_project_3d_pointcloud_fused(
+	mrpt::obs::CObservation3DRangeScan& src_obs,
+	mrpt::opengl::PointCloudAdapter<POINTMAP>& pca,
+	const mrpt::obs::T3DPointsProjectionParams& projectParams,
+	const mrpt::obs::TRangeImageFilterParams& filterParams)
+{
+	const int W = src_obs.rangeImage.cols();
+	const int H = src_obs.rangeImage.rows();
+	ASSERT_(W != 0 && H != 0);
+	if (filterParams.rangeMask_min)
+	{  // sanity check:
+		ASSERT_EQUAL_(filterParams.rangeMask_min->cols(), W);
+		ASSERT_EQUAL_(filterParams.rangeMask_min->rows(), H);
+	}
+	if (filterParams.rangeMask_max)
+	{  // sanity check:
+		ASSERT_EQUAL_(filterParams.rangeMask_max->cols(), W);
+		ASSERT_EQUAL_(filterParams.rangeMask_max->rows(), H);
+	}
+
+	const int dec = std::max(1U, projectParams.decimation);
+	const int Wd = (W + dec - 1) / dec, Hd = (H + dec - 1) / dec;
+	const size_t WHd = size_t(Wd) * size_t(Hd);
+	const bool MAKE_DENSE = projectParams.MAKE_DENSE;
+
+	src_obs.resizePoints3DVectors(WHd);
+	pca.resize(WHd);
+	if (projectParams.MAKE_ORGANIZED) pca.setDimensions(Hd, Wd);
+
+	// Per-column and per-row projection factors (the same values than in the
+	// LUT, which is not needed here):
+	//   Ky = (r_cx - c)/r_fx
+	//   Kz = (r_cy - r)/r_fy
+	const float r_cx = src_obs.cameraParams.cx();
+	const float r_cy = src_obs.cameraParams.cy();
+	const float r_fx_inv = 1.0f / src_obs.cameraParams.fx();
+	const float r_fy_inv = 1.0f / src_obs.cameraParams.fy();
+	std::vector<float> kys(Wd), kzs(Hd);
+	for (int c = 0; c < Wd; c++) kys[c] = (r_cx - c * dec) * r_fx_inv;
+	for (int r = 0; r < Hd; r++) kzs[r] = (r_cy - r * dec) * r_fy_inv;
+
+	const TRangeImageFilter rif(filterParams);
+	auto run = [&projectParams](const size_t N, auto&& func) {
+		mrpt::system::parallel_for(N, projectParams.numThreads, func);
+	};
+
+	// Index of the first output point of each (decimated) row: dense clouds
+	// need a first pass counting the valid points in each row.
+	std::vector<size_t> rowStart(Hd + 1, 0);
+	std::vector<uint8_t> valid;
+	if (MAKE_DENSE)
+	{
+		valid.resize(WHd);
+		run(Hd, [&](const size_t first, const size_t last) {
+			for (size_t r = first; r < last; r++)
+			{
+				uint8_t* v = &valid[r * Wd];
+				size_t n = 0;
+				for (int c = 0; c < Wd; c++)
+				{
+					v[c] = rif.do_range_filter(
+						r * dec, c * dec,
+						src_obs.rangeImage.coeff(r * dec, c * dec));
+					n += v[c];
+				}
+				rowStart[r + 1] = n;
+			}
+		});
+		std::partial_sum(rowStart.begin(), rowStart.end(), rowStart.begin());
+	}
+	else
+		for (int r = 0; r <= Hd; r++) rowStart[r] = size_t(r) * Wd;
+
+	const bool range_is_depth = src_obs.range_is_depth;
+	std::unique_ptr<TProject3DColorizer> colorizer;
+	if (src_obs.hasIntensityImage)
+		colorizer = std::make_unique<TProject3DColorizer>(src_obs);
+	Eigen::Matrix<float, 4, 4> HM;
+	const bool transform = get_project_3d_transform(src_obs, projectParams, HM);
+	auto& idxs_x = src_obs.points3D_idxs_x;
+	auto& idxs_y = src_obs.points3D_idxs_y;
+
+	run(Hd, [&](const size_t first, const size_t last) {
+		Eigen::Matrix<float, 4, 1> pt, pt_transf;
+		pt[3] = 1;
+		for (size_t r = first; r < last; r++)
+		{
+			const int ri = r * dec;
+			const float Kz = kzs[r];
+			size_t idx = rowStart[r];
+			for (int c = 0; c < Wd; c++)
+			{
+				const int ci = c * dec;
+				const float D = src_obs.rangeImage.coeff(ri, ci);
+				if (MAKE_DENSE ? !valid[r * Wd + c]
+							   : !rif.do_range_filter(ri, ci, D))
+				{
+					if (!MAKE_DENSE) pca.setInvalidPoint(idx++);
+					continue;
+				}
+				const float Ky = kys[c];
+				pt[0] = range_is_depth ? D
+									   : D / std::sqrt(1 + Ky * Ky + Kz * Kz);
+				pt[1] = Ky * D;
+				pt[2] = Kz * D;
+				if (colorizer)
+					colorizer->setColor(pca, idx, pt[0], pt[1], pt[2], ci, ri);
+				if (transform)
+				{
+					pt_transf = HM * pt;
+					pca.setPointXYZ(
+						idx, pt_transf[0], pt_transf[1], pt_transf[2]);
+				}
+				else
+					pca.setPointXYZ(idx, pt[0], pt[1], pt[2]);
+				idxs_x[idx] = ci;
+				idxs_y[idx] = ri;
+				++idx;
+			}
+		}
+	});
+	pca.resize(rowStart[Hd]);
+}
 }  // namespace mrpt
 #endif
 
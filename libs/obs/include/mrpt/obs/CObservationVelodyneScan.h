@@ -254,6 +254,44 @@ class CObservationVelodyneScan : public CObservation
 		bool generatePerPointTimestamp{false};
 		/** (Default:false) If `true`, populate the vector azimuth */
 		bool generatePerPointAzimuth{false};
+		/** (Default:1) Number of threads to decode data packets in parallel
+		 * (0: as many as CPU cores). The generated points are the same, in
+		 * the same order, for any number of threads. */
+		unsigned int numThreads{1};
+	};
+
+	/** The points generated from one data packet in \a scan_packets, in
+	 * local coordinates wrt the sensor. \sa PointCloudStorageWrapper */
+	struct TPacketPoints
+	{
+		/** Index of the packet in \a scan_packets */
+		size_t packet_idx{0};
+		/** The timestamp of all points in this packet */
+		mrpt::system::TTimeStamp timestamp{INVALID_TIMESTAMP};
+		/** Number of points */
+		size_t size{0};
+		/** Arrays of \a size points, with their intensity and their azimuth
+		 * (in hundredths of degree, not wrapped to [0,36000) ) */
+		const mrpt::math::TPoint3Df* points{nullptr};
+		const uint8_t* intensity{nullptr};
+		const float* azimuth{nullptr};
+	};
+
+	/** Derive from this class to generate point clouds into custom
+	 * containers, see generatePointCloud(). */
+	struct PointCloudStorageWrapper
+	{
+		virtual ~PointCloudStorageWrapper() = default;
+		/** Invoked for each packet as soon as it is decoded. Calls for
+		 * different packets may happen at once from several threads, and in
+		 * any order. Does nothing by default. */
+		virtual void process_packet(const TPacketPoints& /*pkt*/) {}
+		/** Invoked once before add_points(), with the total number of points
+		 * to be added. Does nothing by default. */
+		virtual void reserve(size_t /*num_points*/) {}
+		/** Invoked for each packet, in order and from the calling thread,
+		 * to append its points to the output. */
+		virtual void add_points(const TPacketPoints& pkt) = 0;
 	};
 
 	/** Generates the point cloud into the point cloud data fields in \a
@@ -273,6 +311,13 @@ class CObservationVelodyneScan : public CObservation
 		const TGeneratePointCloudParameters& params =
 			TGeneratePointCloudParameters());
 
+	/** \overload Generates the point cloud, in local coordinates wrt the
+	 * sensor, into a custom container instead of \a point_cloud. */
+	void generatePointCloud(
+		PointCloudStorageWrapper& dest,
+		const TGeneratePointCloudParameters& params =
+			TGeneratePointCloudParameters()) const;
+
 	/** Results for generatePointCloudAlongSE3Trajectory() */
 	struct TGeneratePointCloudSE3Results
 	{
@@ -13,7 +13,11 @@
 #include <mrpt/obs/CSensoryFrame.h>
 #include <mrpt/obs/CActionCollection.h>
 #include <mrpt/obs/CObservationComment.h>
+#include <mrpt/obs/CIndexedRawlog.h>
 #include <mrpt/config/CConfigFileMemory.h>
+#include <memory>
+#include <mutex>
+#include <set>
 
 namespace mrpt::obs
 {
@@ -58,6 +62,9 @@ using TListTimeAndObservations =
  * \note The format #2 is supported since MRPT version 0.6.0.
  * \note There is a static helper method "detectImagesDirectory" for localizing
  *the external images directory of a rawlog.
+ * \note Entries of indexed rawlogs can be loaded lazily, i.e. kept serialized
+ *in memory and only deserialized when accessed for the first time, see
+ *loadFromIndexedRawLogFile() and setMaxLazyEntriesInMemory().
  *
  * \sa CSensoryFrame, CPose2D, <a href="http://www.mrpt.org/Rawlog_Format">
  *RawLog file format</a>.
@@ -69,8 +76,62 @@ class CRawlog : public mrpt::serialization::CSerializable
 
    private:
 	using TListObjects = std::vector<mrpt::serialization::CSerializable::Ptr>;
-	/** The list where the objects really are in. */
-	TListObjects m_seqOfActObs;
+	/** The list where the objects really are in. Lazy entries not loaded
+	 * yet are nullptr here. It is mutable to load lazy entries on access,
+	 * protected by m_lazyMtx. */
+	mutable TListObjects m_seqOfActObs;
+
+	/** The serialized data of a lazy entry, shared by copies of the rawlog */
+	struct TLazyEntry
+	{
+		/** The class, timestamp and sensor label of the object */
+		TIndexedRawlogEntry info;
+		/** The class of the object, nullptr if not registered */
+		const mrpt::rtti::TRuntimeClassId* classID{nullptr};
+		/** The serialized object, as written by CArchive::WriteObject() */
+		std::vector<uint8_t> data;
+	};
+	struct TLazySlot
+	{
+		/** nullptr for entries not loaded lazily */
+		std::shared_ptr<const TLazyEntry> entry;
+		/** The value of m_lazyClock when it was last accessed */
+		uint64_t lastUse{0};
+	};
+	/** The lazy entries, in the same order as m_seqOfActObs, or empty if
+	 * there are none. */
+	mutable std::vector<TLazySlot> m_lazy;
+	/** The lazy entries currently loaded: (lastUse, index) */
+	mutable std::set<std::pair<uint64_t, size_t>> m_lazyLoaded;
+	mutable uint64_t m_lazyClock{0};
+	/** 0: unlimited */
+	size_t m_lazyMaxInMemory{0};
+	/** A mutex which is not copied along with the rawlog */
+	struct TLazyMutex
+	{
+		std::mutex mtx;
+		TLazyMutex() = default;
+		TLazyMutex(const TLazyMutex&) {}
+		TLazyMutex& operator=(const TLazyMutex&) { return *this; }
+	};
+	/** Protects the state changed by const methods when lazy entries are
+	 * loaded or unloaded, so concurrent const accesses are safe. */
+	mutable TLazyMutex m_lazyMtx;
+
+	/** Returns the i'th entry, loading it first if it is lazy. */
+	mrpt::serialization::CSerializable::Ptr getEntry(size_t index) const;
+	/** The class of the i'th entry, without loading it if it is lazy */
+	const mrpt::rtti::TRuntimeClassId* getEntryClass(size_t index) const;
+	/** Unloads the least recently used lazy entries, down to
+	 * m_lazyMaxInMemory. m_lazyMtx must be locked by the caller. */
+	void evictLazyEntries() const;
+	/** Returns the i'th entry, or nullptr if it is a lazy entry not loaded */
+	mrpt::serialization::CSerializable::Ptr getLoadedEntry(size_t index) const;
+	/** Appends an entry, keeping m_lazy in sync */
+	void pushEntry(const mrpt::serialization::CSerializable::Ptr& obj);
+	/** Writes the i'th entry to an archive, as CArchive::WriteObject(), from
+	 * its serialized data if it is a lazy entry not loaded */
+	void writeEntry(mrpt::serialization::CArchive& out, size_t index) const;
 
 	/** Comments of the rawlog. */
 	CObservationComment m_commentTexts;
@@ -160,11 +221,60 @@ class CRawlog : public mrpt::serialization::CSerializable
 	 *  - Only if `non_obs_objects_are_legal` is true, any `CSerializable`
 	 * object is allowed in the log file. Otherwise, the read stops on classes
 	 * different from the ones listed in the item above.
+	 *  - An indexed rawlog file (see CIndexedRawlogWriter), which is detected
+	 * automatically and loaded with loadFromIndexedRawLogFile().
 	 * \returns It returns false upon error reading or accessing the file.
 	 */
 	bool loadFromRawLogFile(
 		const std::string& fileName, bool non_obs_objects_are_legal = false);
 
+	/** Load the entries of an indexed rawlog file (see CIndexedRawlogWriter)
+	 * with a timestamp within [from_time,to_time], or all of them if both are
+	 * INVALID_TIMESTAMP (one of them alone means an open range). Only the
+	 * entries in the range are read and deserialized. Entries without a
+	 * timestamp are only loaded with no time range.
+	 *
+	 * With \a lazy=true, the entries are kept serialized in memory, and each
+	 * one is only deserialized the first time it is accessed (via
+	 * getAsGeneric(), getAsObservation(), iterators,...). getType(),
+	 * getEntryTimestamp() and findObservationsByClassInRange() work with
+	 * the class and timestamp stored in the index, without loading the
+	 * entries. This makes loading large rawlogs much faster, if only a few
+	 * entries are needed. See also setMaxLazyEntriesInMemory().
+	 * \returns It returns false upon error reading or accessing the file.
+	 * \sa CIndexedRawlogReader
+	 */
+	bool loadFromIndexedRawLogFile(
+		const std::string& fileName,
+		const mrpt::system::TTimeStamp from_time = INVALID_TIMESTAMP,
+		const mrpt::system::TTimeStamp to_time = INVALID_TIMESTAMP,
+		const bool lazy = false);
+
+	/** Sets the maximum number of lazy entries (see
+	 * loadFromIndexedRawLogFile()) which are kept deserialized in memory at
+	 * once: when more are loaded, the least recently accessed ones are
+	 * unloaded, keeping only their serialized data. 0 (the default) means
+	 * no limit.
+	 * \note An entry unloaded is loaded again from its serialized data on the
+	 * next access, so changes made to it are lost. Smart pointers to it
+	 * obtained before remain valid, but refer to a different object.
+	 * \note Loading and unloading lazy entries is protected by a mutex, so
+	 * const methods may be called concurrently from several threads.
+	 */
+	void setMaxLazyEntriesInMemory(const size_t maxEntries);
+	/** Returns the limit set with setMaxLazyEntriesInMemory() */
+	size_t getMaxLazyEntriesInMemory() const { return m_lazyMaxInMemory; }
+	/** Returns false if the given entry is a lazy entry which is not
+	 * deserialized in memory at present, true otherwise.
+	 * \exception std::exception If index is out of bounds */
+	bool isEntryLoaded(size_t index) const;
+	/** Returns the timestamp of the given entry: that of an observation, or
+	 * that stored in the index for lazy entries (see
+	 * CIndexedRawlogWriter), without loading them. INVALID_TIMESTAMP for
+	 * other entries.
+	 * \exception std::exception If index is out of bounds */
+	mrpt::system::TTimeStamp getEntryTimestamp(size_t index) const;
+
 	/** Saves the contents to a rawlog-file, compatible with RawlogViewer (As
 	 * the sequence of internal objects).
 	 *  The file is saved with gz-commpressed if MRPT has gz-streams.
@@ -173,6 +283,18 @@ class CRawlog : public mrpt::serialization::CSerializable
 	 */
 	bool saveToRawLogFile(const std::string& fileName) const;
 
+	/** Saves the contents to an indexed rawlog file, which supports random
+	 * access and queries by time or by sensor label without reading the whole
+	 * file (see CIndexedRawlogWriter, CIndexedRawlogReader).
+	 * \param chunkSize The size of each compressed block of entries (bytes)
+	 * \returns It returns false if any error is found while writing/creating
+	 * the target file.
+	 */
+	bool saveToIndexedRawLogFile(
+		const std::string& fileName,
+		const size_t chunkSize =
+			CIndexedRawlogWriter::DEFAULT_CHUNK_SIZE) const;
+
 	/** Returns the number of actions / observations object in the sequence. */
 	size_t size() const;
 
@@ -233,20 +355,33 @@ class CRawlog : public mrpt::serialization::CSerializable
 	{
 	   protected:
 		TListObjects::iterator m_it;
+		/** The rawlog, to load lazy entries on access (may be nullptr) */
+		const CRawlog* m_rawlog{nullptr};
 
 	   public:
 		iterator() : m_it() {}
 		iterator(const TListObjects::iterator& it) : m_it(it) {}
+		iterator(const TListObjects::iterator& it, const CRawlog* rawlog)
+			: m_it(it), m_rawlog(rawlog)
+		{
+		}
 		virtual ~iterator() {}
 		iterator& operator=(const iterator& o)
 		{
 			m_it = o.m_it;
+			m_rawlog = o.m_rawlog;
 			return *this;
 		}
 
 		bool operator==(const iterator& o) { return m_it == o.m_it; }
 		bool operator!=(const iterator& o) { return m_it != o.m_it; }
-		mrpt::serialization::CSerializable::Ptr operator*() { return *m_it; }
+		mrpt::serialization::CSerializable::Ptr operator*()
+		{
+			if (m_rawlog)
+				return m_rawlog->getEntry(
+					m_it - m_rawlog->m_seqOfActObs.begin());
+			return *m_it;
+		}
 		inline iterator operator++(int)
 		{
 			iterator aux = *this;
@@ -272,19 +407,19 @@ class CRawlog : public mrpt::serialization::CSerializable
 
 		TEntryType getType() const
 		{
-			if ((*m_it)->GetRuntimeClass()->derivedFrom(CLASS_ID(CObservation)))
+			const auto* cl = m_rawlog
+								 ? m_rawlog->getEntryClass(
+									   m_it - m_rawlog->m_seqOfActObs.begin())
+								 : (*m_it)->GetRuntimeClass();
+			if (cl && cl->derivedFrom(CLASS_ID(CObservation)))
 				return etObservation;
-			else if ((*m_it)->GetRuntimeClass()->derivedFrom(
-						 CLASS_ID(CSensoryFrame)))
+			else if (cl && cl->derivedFrom(CLASS_ID(CSensoryFrame)))
 				return etSensoryFrame;
 			else
 				return etActionCollection;
 		}
 
-		static iterator erase(TListObjects& lst, const iterator& it)
-		{
-			return lst.erase(it.m_it);
-		}
+		friend class CRawlog;
 	};
 
 	/** A normal iterator, plus the extra method "getType" to determine the type
@@ -293,15 +428,25 @@ class CRawlog : public mrpt::serialization::CSerializable
 	{
 	   protected:
 		TListObjects::const_iterator m_it;
+		/** The rawlog, to load lazy entries on access (may be nullptr) */
+		const CRawlog* m_rawlog{nullptr};
 
 	   public:
 		const_iterator() : m_it() {}
 		const_iterator(const TListObjects::const_iterator& it) : m_it(it) {}
+		const_iterator(
+			const TListObjects::const_iterator& it, const CRawlog* rawlog)
+			: m_it(it), m_rawlog(rawlog)
+		{
+		}
 		virtual ~const_iterator() {}
 		bool operator==(const const_iterator& o) { return m_it == o.m_it; }
 		bool operator!=(const const_iterator& o) { return m_it != o.m_it; }
 		const mrpt::serialization::CSerializable::Ptr operator*() const
 		{
+			if (m_rawlog)
+				return m_rawlog->getEntry(
+					m_it - m_rawlog->m_seqOfActObs.cbegin());
 			return *m_it;
 		}
 
@@ -330,23 +475,35 @@ class CRawlog : public mrpt::serialization::CSerializable
 
 		TEntryType getType() const
 		{
-			if ((*m_it)->GetRuntimeClass()->derivedFrom(CLASS_ID(CObservation)))
+			const auto* cl = m_rawlog
+								 ? m_rawlog->getEntryClass(
+									   m_it - m_rawlog->m_seqOfActObs.cbegin())
+								 : (*m_it)->GetRuntimeClass();
+			if (cl && cl->derivedFrom(CLASS_ID(CObservation)))
 				return etObservation;
-			else if ((*m_it)->GetRuntimeClass()->derivedFrom(
-						 CLASS_ID(CSensoryFrame)))
+			else if (cl && cl->derivedFrom(CLASS_ID(CSensoryFrame)))
 				return etSensoryFrame;
 			else
 				return etActionCollection;
 		}
 	};
 
-	const_iterator begin() const { return m_seqOfActObs.begin(); }
-	iterator begin() { return m_seqOfActObs.begin(); }
-	const_iterator end() const { return m_seqOfActObs.end(); }
-	iterator end() { return m_seqOfActObs.end(); }
+	const_iterator begin() const
+	{
+		return const_iterator(m_seqOfActObs.cbegin(), this);
+	}
+	iterator begin() { return iterator(m_seqOfActObs.begin(), this); }
+	const_iterator end() const
+	{
+		return const_iterator(m_seqOfActObs.cend(), this);
+	}
+	iterator end() { return iterator(m_seqOfActObs.end(), this); }
+	/** Removes the entry at the given position, as remove() */
 	iterator erase(const iterator& it)
 	{
-		return iterator::erase(m_seqOfActObs, it);
+		const size_t index = it.m_it - m_seqOfActObs.begin();
+		remove(index);
+		return iterator(m_seqOfActObs.begin() + index, this);
 	}
 
 	/** Returns the sub-set of observations of a given class whose time-stamp t
@@ -354,6 +511,7 @@ class CRawlog : public mrpt::serialization::CSerializable
 	 *  This method requires the timestamps of the sensors to be in strict
 	 * ascending order (which should be the normal situation).
 	 *   Otherwise, the output is undeterminate.
+	 *  Lazy entries are only loaded if they are of the given class.
 	 * \sa findClosestObservationsByClass
 	 */
 	void findObservationsByClassInRange(
@@ -0,0 +1,144 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/serialization/CSerializable.h>
+#include <mrpt/obs/CActionCollection.h>
+#include <mrpt/obs/CSensoryFrame.h>
+#include <mrpt/obs/CObservation.h>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace mrpt::io
+{
+class CFileGZInputStream;
+}
+namespace mrpt::obs
+{
+class CIndexedRawlogReader;
+
+/** Reads a rawlog file sequentially, with bounded memory, decompressing and
+ * deserializing its entries in a background thread.
+ *
+ * This is an alternative to loading the whole dataset with
+ * CRawlog::loadFromRawLogFile(), or to calling
+ * CRawlog::readActionObservationPair() on a CFileGZInputStream, which
+ * decompresses and deserializes the file in the caller thread. Here, a
+ * background thread keeps up to \a readAhead entries ready in a queue, so the
+ * I/O overlaps with the processing of the entries, and at most \a readAhead
+ * entries (plus those held by the caller) are in memory at any time.
+ *
+ * Both plain (gz-compressed or not) and indexed rawlog files (see
+ * CIndexedRawlogWriter) are supported.
+ *
+ * Usage:
+ * \code
+ * CRawlogStreamReader rawlog("dataset.rawlog");
+ * CActionCollection::Ptr action;
+ * CSensoryFrame::Ptr observations;
+ * CObservation::Ptr observation;
+ * size_t rawlogEntry = 0;
+ * while (rawlog.getActionObservationPairOrObservation(
+ *     action, observations, observation, rawlogEntry))
+ * {
+ *    // ...
+ * }
+ * \endcode
+ *
+ * \sa CRawlog
+ * \ingroup mrpt_obs_grp
+ */
+class CRawlogStreamReader
+{
+   public:
+	/** The default maximum number of entries read in advance */
+	static constexpr size_t DEFAULT_READ_AHEAD = 64;
+
+	CRawlogStreamReader() = default;
+	/** Constructor which opens a file and starts reading it.
+	 * \exception std::exception On error opening the file. */
+	CRawlogStreamReader(
+		const std::string& fileName,
+		const size_t readAhead = DEFAULT_READ_AHEAD);
+	/** Destructor, which stops the background thread (see close()) */
+	~CRawlogStreamReader();
+
+	CRawlogStreamReader(const CRawlogStreamReader&) = delete;
+	CRawlogStreamReader& operator=(const CRawlogStreamReader&) = delete;
+
+	/** Opens a file and starts reading it in the background, closing the
+	 * previous one, if any.
+	 * \param readAhead The maximum number of entries which are read before
+	 * the caller asks for them (>=1).
+	 * \return false on error opening the file. */
+	bool open(
+		const std::string& fileName,
+		const size_t readAhead = DEFAULT_READ_AHEAD);
+	/** Returns true if a file is open */
+	bool is_open() const { return m_thread.joinable(); }
+	/** Stops the background thread and closes the file. Entries not read yet
+	 * are discarded. */
+	void close();
+
+	/** Returns the next entry in the file, waiting for the background thread
+	 * if it is not ready yet. Returns an empty pointer at the end of the file
+	 * (or if no file is open).
+	 * \exception std::exception If there was an error reading the file, once
+	 * all the entries before the error have been returned. */
+	mrpt::serialization::CSerializable::Ptr getNextEntry();
+
+	/** Like CRawlog::readActionObservationPair(), reading from this object.
+	 * \return false at the end of the file or on error. */
+	bool readActionObservationPair(
+		CActionCollection::Ptr& action, CSensoryFrame::Ptr& observations,
+		size_t& rawlogEntry);
+	/** Like CRawlog::getActionObservationPairOrObservation(), reading from
+	 * this object.
+	 * \return false at the end of the file or on error. */
+	bool getActionObservationPairOrObservation(
+		CActionCollection::Ptr& action, CSensoryFrame::Ptr& observations,
+		CObservation::Ptr& observation, size_t& rawlogEntry);
+
+	/** The maximum number of entries read in advance */
+	size_t getReadAhead() const { return m_readAhead; }
+	/** The number of entries already read and waiting for the caller */
+	size_t getQueuedEntries() const;
+
+   private:
+	std::thread m_thread;
+	size_t m_readAhead{DEFAULT_READ_AHEAD};
+	mutable std::mutex m_mtx;
+	/** Signaled when an entry is added to the queue, or at the end */
+	std::condition_variable m_cvNotEmpty;
+	/** Signaled when an entry is removed from the queue, or on close() */
+	std::condition_variable m_cvNotFull;
+	std::deque<mrpt::serialization::CSerializable::Ptr> m_queue;
+	/** Set by the background thread when it has finished */
+	bool m_endOfFile{false};
+	/** Set by close() to stop the background thread */
+	bool m_stop{false};
+	/** The error which stopped the background thread, if any */
+	std::exception_ptr m_error;
+
+	/** Pushes an entry into the queue, waiting while it is full.
+	 * \return false if the thread must stop. */
+	bool push(mrpt::serialization::CSerializable::Ptr obj);
+	/** The background thread, for each file format */
+	void threadPlainRawlog(std::unique_ptr<mrpt::io::CFileGZInputStream> f);
+	void threadIndexedRawlog(std::unique_ptr<CIndexedRawlogReader> f);
+	/** Called by the background thread when it finishes */
+	void setEndOfFile(std::exception_ptr error);
+};
+
+}  // namespace mrpt::obs
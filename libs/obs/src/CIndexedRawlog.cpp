@@ -0,0 +1,438 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "obs-precomp.h"  // Precompiled headers
+
+#include <mrpt/obs/CIndexedRawlog.h>
+#include <mrpt/obs/CObservation.h>
+#include <mrpt/obs/CSensoryFrame.h>
+#include <mrpt/obs/CActionCollection.h>
+#include <mrpt/io/zip.h>
+#include <mrpt/serialization/CArchive.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+using namespace mrpt::obs;
+using namespace mrpt::io;
+using namespace mrpt::serialization;
+using namespace mrpt::system;
+
+namespace
+{
+/** Magic string at the beginning and the end of indexed rawlog files */
+const char INDEXED_RAWLOG_MAGIC[8] = {'M', 'R', 'P', 'T', 'I', 'R', 'L', 'G'};
+const uint32_t INDEXED_RAWLOG_VERSION = 0;
+/** Sizes of the file header and footer (bytes) */
+const uint64_t HEADER_SIZE = sizeof(INDEXED_RAWLOG_MAGIC) + sizeof(uint32_t);
+const uint64_t FOOTER_SIZE =
+	3 * sizeof(uint64_t) + sizeof(INDEXED_RAWLOG_MAGIC);
+}  // namespace
+
+void TIndexedRawlogEntry::setFromObject(const CSerializable& obj)
+{
+	className = obj.GetRuntimeClass()->className;
+	timestamp = INVALID_TIMESTAMP;
+	sensorLabel.clear();
+
+	if (auto o = dynamic_cast<const CObservation*>(&obj); o)
+	{
+		timestamp = o->timestamp;
+		sensorLabel = o->sensorLabel;
+	}
+	else if (auto sf = dynamic_cast<const CSensoryFrame*>(&obj); sf)
+	{
+		if (sf->size() > 0) timestamp = (*sf->begin())->timestamp;
+	}
+	else if (auto acts = dynamic_cast<const CActionCollection*>(&obj); acts)
+	{
+		if (acts->begin() != acts->end())
+			timestamp = (*acts->begin())->timestamp;
+	}
+}
+
+// ------------------------------------------------------------------------
+//  CIndexedRawlogWriter
+// ------------------------------------------------------------------------
+CIndexedRawlogWriter::CIndexedRawlogWriter(
+	const std::string& fileName, const size_t chunkSize)
+{
+	if (!open(fileName, chunkSize))
+		THROW_EXCEPTION_FMT(
+			"Error opening file for writing: '%s'", fileName.c_str());
+}
+
+CIndexedRawlogWriter::~CIndexedRawlogWriter()
+{
+	try
+	{
+		close();
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << "[~CIndexedRawlogWriter] Error closing file: " << e.what()
+				  << std::endl;
+	}
+}
+
+bool CIndexedRawlogWriter::open(
+	const std::string& fileName, const size_t chunkSize)
+{
+	close();
+	ASSERT_(chunkSize > 0);
+	if (!m_file.open(fileName)) return false;
+
+	m_open = true;
+	m_chunkSize = chunkSize;
+	m_chunk.Clear();
+	m_chunks.clear();
+	m_entries.clear();
+
+	m_file.Write(INDEXED_RAWLOG_MAGIC, sizeof(INDEXED_RAWLOG_MAGIC));
+	auto ar = archiveFrom(m_file);
+	ar << INDEXED_RAWLOG_VERSION;
+	return true;
+}
+
+void CIndexedRawlogWriter::write(const CSerializable& obj)
+{
+	ASSERTMSG_(m_open, "No file is open");
+
+	const uint64_t start = m_chunk.getPosition();
+	archiveFrom(m_chunk) << obj;
+
+	TIndexedRawlogEntry info;
+	info.setFromObject(obj);
+	addEntry(info, start);
+}
+
+void CIndexedRawlogWriter::writeSerialized(
+	const TIndexedRawlogEntry& info, const void* data, const size_t size)
+{
+	ASSERTMSG_(m_open, "No file is open");
+
+	const uint64_t start = m_chunk.getPosition();
+	if (size) m_chunk.Write(data, size);
+	addEntry(info, start);
+}
+
+void CIndexedRawlogWriter::addEntry(
+	const TIndexedRawlogEntry& info, const uint64_t start)
+{
+	const uint64_t end = m_chunk.getPosition();
+	ASSERTMSG_(
+		end <= std::numeric_limits<uint32_t>::max(),
+		"Entry too large for an indexed rawlog");
+
+	TIndexedRawlogEntry e = info;
+	e.chunk = static_cast<uint32_t>(m_chunks.size());
+	e.offset = static_cast<uint32_t>(start);
+	e.size = static_cast<uint32_t>(end - start);
+	m_entries.push_back(std::move(e));
+
+	if (end >= m_chunkSize) flushChunk();
+}
+
+void CIndexedRawlogWriter::flushChunk()
+{
+	const uint64_t size = m_chunk.getTotalBytesCount();
+	if (!size) return;
+
+	std::vector<unsigned char> compressed;
+	mrpt::io::zip::compress(m_chunk.getRawBufferData(), size, compressed);
+
+	TChunk c;
+	c.fileOffset = m_file.getPosition();
+	c.compressedSize = compressed.size();
+	c.size = size;
+	m_chunks.push_back(c);
+
+	if (m_file.Write(compressed.data(), compressed.size()) !=
+		compressed.size())
+		THROW_EXCEPTION("Error writing to the indexed rawlog file");
+	m_chunk.Clear();
+}
+
+void CIndexedRawlogWriter::close()
+{
+	if (!m_open) return;
+	m_open = false;
+
+	flushChunk();
+
+	// Tables of sensor labels and class names, to store each string once:
+	std::map<std::string, uint32_t> labels, classes;
+	for (const auto& e : m_entries)
+	{
+		labels.emplace(e.sensorLabel, 0);
+		classes.emplace(e.className, 0);
+	}
+	uint32_t n = 0;
+	for (auto& l : labels) l.second = n++;
+	n = 0;
+	for (auto& c : classes) c.second = n++;
+
+	CMemoryStream index;
+	{
+		auto ar = archiveFrom(index);
+		ar << static_cast<uint32_t>(m_chunks.size());
+		for (const auto& c : m_chunks)
+			ar << c.fileOffset << c.compressedSize << c.size;
+		ar << static_cast<uint32_t>(labels.size());
+		for (const auto& l : labels) ar << l.first;
+		ar << static_cast<uint32_t>(classes.size());
+		for (const auto& c : classes) ar << c.first;
+		ar << static_cast<uint64_t>(m_entries.size());
+		for (const auto& e : m_entries)
+			ar << e.chunk << e.offset << e.size
+			   << static_cast<uint64_t>(e.timestamp) << labels[e.sensorLabel]
+			   << classes[e.className];
+	}
+
+	std::vector<unsigned char> compressed;
+	const uint64_t indexSize = index.getTotalBytesCount();
+	mrpt::io::zip::compress(index.getRawBufferData(), indexSize, compressed);
+
+	const uint64_t indexOffset = m_file.getPosition();
+	m_file.Write(compressed.data(), compressed.size());
+	auto ar = archiveFrom(m_file);
+	ar << indexOffset << static_cast<uint64_t>(compressed.size()) << indexSize;
+	m_file.Write(INDEXED_RAWLOG_MAGIC, sizeof(INDEXED_RAWLOG_MAGIC));
+	m_file.close();
+
+	m_chunk.Clear();
+	m_chunks.clear();
+	m_entries.clear();
+}
+
+// ------------------------------------------------------------------------
+//  CIndexedRawlogReader
+// ------------------------------------------------------------------------
+CIndexedRawlogReader::CIndexedRawlogReader(const std::string& fileName)
+{
+	if (!open(fileName))
+		THROW_EXCEPTION_FMT(
+			"Error opening file or not an indexed rawlog: '%s'",
+			fileName.c_str());
+}
+
+bool CIndexedRawlogReader::isIndexedRawlog(const std::string& fileName)
+{
+	CFileInputStream f;
+	if (!f.open(fileName)) return false;
+	char magic[sizeof(INDEXED_RAWLOG_MAGIC)];
+	return f.Read(magic, sizeof(magic)) == sizeof(magic) &&
+		   !std::memcmp(magic, INDEXED_RAWLOG_MAGIC, sizeof(magic));
+}
+
+void CIndexedRawlogReader::close()
+{
+	m_file.close();
+	m_open = false;
+	m_chunks.clear();
+	m_entries.clear();
+	m_sortedByTime.clear();
+	m_bySensorLabel.clear();
+	m_chunkData.clear();
+	m_compressedData.clear();
+	m_cachedChunk = std::string::npos;
+}
+
+bool CIndexedRawlogReader::open(const std::string& fileName)
+{
+	close();
+	if (!m_file.open(fileName)) return false;
+
+	try
+	{
+		const uint64_t fileSize = m_file.getTotalBytesCount();
+		char magic[sizeof(INDEXED_RAWLOG_MAGIC)];
+		auto ar = archiveFrom(m_file);
+
+		// Header:
+		uint32_t version;
+		if (fileSize < HEADER_SIZE + FOOTER_SIZE ||
+			m_file.Read(magic, sizeof(magic)) != sizeof(magic) ||
+			std::memcmp(magic, INDEXED_RAWLOG_MAGIC, sizeof(magic)))
+		{
+			// Not an indexed rawlog:
+			close();
+			return false;
+		}
+		ar >> version;
+		if (version > INDEXED_RAWLOG_VERSION)
+			THROW_EXCEPTION_FMT(
+				"Unknown indexed rawlog format version: %u",
+				static_cast<unsigned int>(version));
+
+		// Footer:
+		uint64_t indexOffset, indexCompressedSize, indexSize;
+		m_file.Seek(fileSize - FOOTER_SIZE);
+		ar >> indexOffset >> indexCompressedSize >> indexSize;
+		if (m_file.Read(magic, sizeof(magic)) != sizeof(magic) ||
+			std::memcmp(magic, INDEXED_RAWLOG_MAGIC, sizeof(magic)))
+			THROW_EXCEPTION(
+				"Missing index: the file was not properly closed when "
+				"written");
+		ASSERT_(indexOffset + indexCompressedSize <= fileSize - FOOTER_SIZE);
+
+		// Index:
+		std::vector<uint8_t> indexData(indexSize);
+		m_compressedData.resize(indexCompressedSize);
+		m_file.Seek(indexOffset);
+		ASSERT_(
+			m_file.Read(m_compressedData.data(), indexCompressedSize) ==
+			indexCompressedSize);
+		size_t actualSize = 0;
+		mrpt::io::zip::decompress(
+			m_compressedData.data(), indexCompressedSize, indexData.data(),
+			indexSize, actualSize);
+		ASSERT_EQUAL_(actualSize, indexSize);
+
+		CMemoryStream index;
+		index.assignMemoryNotOwn(indexData.data(), indexSize);
+		auto ari = archiveFrom(index);
+
+		uint32_t nChunks, nLabels, nClasses;
+		ari >> nChunks;
+		m_chunks.resize(nChunks);
+		for (auto& c : m_chunks)
+		{
+			ari >> c.fileOffset >> c.compressedSize >> c.size;
+			ASSERT_(c.fileOffset + c.compressedSize <= indexOffset);
+		}
+		ari >> nLabels;
+		std::vector<std::string> labels(nLabels);
+		for (auto& l : labels) ari >> l;
+		ari >> nClasses;
+		std::vector<std::string> classes(nClasses);
+		for (auto& c : classes) ari >> c;
+
+		uint64_t nEntries;
+		ari >> nEntries;
+		m_entries.resize(nEntries);
+		for (size_t i = 0; i < nEntries; i++)
+		{
+			auto& e = m_entries[i];
+			uint64_t timestamp;
+			uint32_t label, className;
+			ari >> e.chunk >> e.offset >> e.size >> timestamp >> label >>
+				className;
+			ASSERT_(e.chunk < nChunks || e.size == 0);
+			ASSERT_(label < nLabels && className < nClasses);
+			e.timestamp = timestamp;
+			e.sensorLabel = labels[label];
+			e.className = classes[className];
+
+			if (e.timestamp != INVALID_TIMESTAMP) m_sortedByTime.push_back(i);
+			if (!e.sensorLabel.empty())
+				m_bySensorLabel[e.sensorLabel].push_back(i);
+		}
+		std::stable_sort(
+			m_sortedByTime.begin(), m_sortedByTime.end(),
+			[this](size_t a, size_t b) {
+				return m_entries[a].timestamp < m_entries[b].timestamp;
+			});
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << "[CIndexedRawlogReader] Error reading '" << fileName
+				  << "':\n"
+				  << e.what() << std::endl;
+		close();
+		return false;
+	}
+
+	m_open = true;
+	return true;
+}
+
+const TIndexedRawlogEntry& CIndexedRawlogReader::getEntryInfo(
+	const size_t index) const
+{
+	ASSERT_BELOW_(index, m_entries.size());
+	return m_entries[index];
+}
+
+void CIndexedRawlogReader::loadChunk(const size_t chunk)
+{
+	if (chunk == m_cachedChunk) return;
+	ASSERT_BELOW_(chunk, m_chunks.size());
+	const TChunk& c = m_chunks[chunk];
+
+	m_cachedChunk = std::string::npos;
+	m_compressedData.resize(c.compressedSize);
+	m_chunkData.resize(c.size);
+	m_file.Seek(c.fileOffset);
+	if (m_file.Read(m_compressedData.data(), c.compressedSize) !=
+		c.compressedSize)
+		THROW_EXCEPTION("Error reading the indexed rawlog file");
+
+	size_t actualSize = 0;
+	mrpt::io::zip::decompress(
+		m_compressedData.data(), c.compressedSize, m_chunkData.data(), c.size,
+		actualSize);
+	ASSERT_EQUAL_(actualSize, c.size);
+	m_cachedChunk = chunk;
+}
+
+void CIndexedRawlogReader::getSerializedEntry(
+	const size_t index, std::vector<uint8_t>& data)
+{
+	const TIndexedRawlogEntry& e = getEntryInfo(index);
+	data.resize(e.size);
+	if (!e.size) return;
+
+	loadChunk(e.chunk);
+	ASSERT_(e.offset + e.size <= m_chunkData.size());
+	std::memcpy(data.data(), &m_chunkData[e.offset], e.size);
+}
+
+CSerializable::Ptr CIndexedRawlogReader::getEntry(const size_t index)
+{
+	const TIndexedRawlogEntry& e = getEntryInfo(index);
+	ASSERT_(e.size > 0);
+	loadChunk(e.chunk);
+	ASSERT_(e.offset + e.size <= m_chunkData.size());
+
+	CMemoryStream buf;
+	buf.assignMemoryNotOwn(&m_chunkData[e.offset], e.size);
+	return archiveFrom(buf).ReadObject();
+}
+
+std::vector<size_t> CIndexedRawlogReader::findEntriesInTimeRange(
+	const TTimeStamp t0, const TTimeStamp t1) const
+{
+	const auto it0 = std::lower_bound(
+		m_sortedByTime.begin(), m_sortedByTime.end(), t0,
+		[this](size_t i, TTimeStamp t) { return m_entries[i].timestamp < t; });
+	const auto it1 = std::upper_bound(
+		it0, m_sortedByTime.end(), t1,
+		[this](TTimeStamp t, size_t i) { return t < m_entries[i].timestamp; });
+
+	std::vector<size_t> found(it0, it1);
+	std::sort(found.begin(), found.end());
+	return found;
+}
+
+const std::vector<size_t>& CIndexedRawlogReader::findEntriesBySensorLabel(
+	const std::string& sensorLabel) const
+{
+	static const std::vector<size_t> none;
+	const auto it = m_bySensorLabel.find(sensorLabel);
+	return it == m_bySensorLabel.end() ? none : it->second;
+}
+
+std::vector<std::string> CIndexedRawlogReader::getSensorLabels() const
+{
+	std::vector<std::string> labels;
+	for (const auto& l : m_bySensorLabel) labels.push_back(l.first);
+	return labels;
+}
@@ -0,0 +1,300 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/obs/CIndexedRawlog.h>
+#include <mrpt/obs/CRawlog.h>
+#include <mrpt/obs/CObservationOdometry.h>
+#include <mrpt/obs/CSensoryFrame.h>
+#include <mrpt/system/filesystem.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+
+using namespace mrpt;
+using namespace mrpt::obs;
+using namespace mrpt::system;
+using namespace std;
+
+// t0 + i seconds, alternating two sensor labels:
+static CObservationOdometry::Ptr makeObs(size_t i)
+{
+	auto o = mrpt::make_aligned_shared<CObservationOdometry>();
+	o->timestamp = time_tToTimestamp(1500000000.0 + i);
+	o->sensorLabel = (i % 2) ? "ODOM_B" : "ODOM_A";
+	o->odometry = mrpt::poses::CPose2D(0.1 * i, 0, 0);
+	o->hasEncodersInfo = true;
+	o->encoderLeftTicks = static_cast<int32_t>(i);
+	return o;
+}
+
+TEST(CIndexedRawlog, writeAndRandomAccess)
+{
+	const std::string fil = getTempFileName();
+	const size_t N = 500;
+	{
+		// Small chunks, to have many of them:
+		CIndexedRawlogWriter w(fil, 2000);
+		for (size_t i = 0; i < N; i++) w.write(*makeObs(i));
+		EXPECT_EQ(w.size(), N);
+	}
+	EXPECT_TRUE(CIndexedRawlogReader::isIndexedRawlog(fil));
+
+	CIndexedRawlogReader r(fil);
+	ASSERT_EQ(r.size(), N);
+	EXPECT_EQ(r.getSensorLabels().size(), 2u);
+
+	// The index is available without reading the entries:
+	const TIndexedRawlogEntry& e = r.getEntryInfo(77);
+	EXPECT_EQ(e.sensorLabel, "ODOM_B");
+	EXPECT_EQ(e.className, "CObservationOdometry");
+	EXPECT_EQ(e.timestamp, time_tToTimestamp(1500000000.0 + 77));
+
+	// Random access, in any order:
+	for (const size_t i : {N - 1, size_t(0), size_t(250), size_t(3)})
+	{
+		auto o = std::dynamic_pointer_cast<CObservationOdometry>(r.getEntry(i));
+		ASSERT_TRUE(o);
+		EXPECT_EQ(o->encoderLeftTicks, static_cast<int32_t>(i));
+		EXPECT_EQ(o->sensorLabel, makeObs(i)->sensorLabel);
+	}
+
+	// Queries:
+	const auto inRange = r.findEntriesInTimeRange(
+		time_tToTimestamp(1500000000.0 + 100),
+		time_tToTimestamp(1500000000.0 + 109.5));
+	ASSERT_EQ(inRange.size(), 10u);
+	for (size_t k = 0; k < inRange.size(); k++)
+		EXPECT_EQ(inRange[k], 100 + k);
+	EXPECT_TRUE(r.findEntriesInTimeRange(0, 1000).empty());
+
+	const auto& odomA = r.findEntriesBySensorLabel("ODOM_A");
+	ASSERT_EQ(odomA.size(), N / 2);
+	for (size_t k = 0; k < odomA.size(); k++) EXPECT_EQ(odomA[k], 2 * k);
+	EXPECT_TRUE(r.findEntriesBySensorLabel("NONE").empty());
+
+	// Copy of serialized entries:
+	const std::string fil2 = getTempFileName();
+	{
+		CIndexedRawlogWriter w(fil2);
+		std::vector<uint8_t> data;
+		for (const size_t i : odomA)
+		{
+			r.getSerializedEntry(i, data);
+			w.writeSerialized(r.getEntryInfo(i), data.data(), data.size());
+		}
+	}
+	CIndexedRawlogReader r2(fil2);
+	ASSERT_EQ(r2.size(), N / 2);
+	EXPECT_TRUE(r2.findEntriesBySensorLabel("ODOM_B").empty());
+	auto o = std::dynamic_pointer_cast<CObservationOdometry>(r2.getEntry(10));
+	ASSERT_TRUE(o);
+	EXPECT_EQ(o->encoderLeftTicks, 20);
+
+	r.close();
+	r2.close();
+	deleteFile(fil);
+	deleteFile(fil2);
+}
+
+TEST(CIndexedRawlog, CRawlogSaveAndLoad)
+{
+	CRawlog rawlog;
+	rawlog.setCommentText("A comment");
+	for (size_t i = 0; i < 20; i++)
+	{
+		CSensoryFrame sf;
+		sf.insert(makeObs(i));
+		rawlog.addObservations(sf);
+	}
+
+	const std::string fil = getTempFileName(), filPlain = getTempFileName();
+	ASSERT_TRUE(rawlog.saveToIndexedRawLogFile(fil, 100));
+	ASSERT_TRUE(rawlog.saveToRawLogFile(filPlain));
+	EXPECT_FALSE(CIndexedRawlogReader::isIndexedRawlog(filPlain));
+
+	// Detected when loading:
+	CRawlog rawlog2;
+	ASSERT_TRUE(rawlog2.loadFromRawLogFile(fil));
+	EXPECT_EQ(rawlog2.size(), rawlog.size());
+	EXPECT_EQ(rawlog2.getCommentText(), rawlog.getCommentText());
+	EXPECT_EQ(
+		rawlog2.getAsObservations(7)->getObservationByIndex(0)->timestamp,
+		rawlog.getAsObservations(7)->getObservationByIndex(0)->timestamp);
+
+	// Only a time range:
+	CRawlog rawlog3;
+	ASSERT_TRUE(rawlog3.loadFromIndexedRawLogFile(
+		fil, time_tToTimestamp(1500000000.0 + 15), INVALID_TIMESTAMP));
+	EXPECT_EQ(rawlog3.size(), 5u);
+	EXPECT_EQ(rawlog3.getCommentText(), rawlog.getCommentText());
+
+	// Not an indexed rawlog:
+	EXPECT_FALSE(rawlog3.loadFromIndexedRawLogFile(filPlain));
+
+	deleteFile(fil);
+	deleteFile(filPlain);
+}
+
+TEST(CIndexedRawlog, CRawlogLazyLoad)
+{
+	CRawlog rawlog;
+	rawlog.setCommentText("A comment");
+	const size_t N = 50;
+	for (size_t i = 0; i < N; i++)
+		rawlog.addObservationMemoryReference(makeObs(i));
+
+	const std::string fil = getTempFileName(), fil2 = getTempFileName();
+	ASSERT_TRUE(rawlog.saveToIndexedRawLogFile(fil, 1000));
+
+	CRawlog lz;
+	ASSERT_TRUE(lz.loadFromIndexedRawLogFile(
+		fil, INVALID_TIMESTAMP, INVALID_TIMESTAMP, true /*lazy*/));
+	ASSERT_EQ(lz.size(), N);
+	EXPECT_EQ(lz.getCommentText(), rawlog.getCommentText());
+
+	// Types and timestamps come from the index, without loading entries:
+	for (size_t i = 0; i < N; i++)
+	{
+		EXPECT_EQ(lz.getType(i), CRawlog::etObservation);
+		EXPECT_EQ(lz.getEntryTimestamp(i), makeObs(i)->timestamp);
+		EXPECT_FALSE(lz.isEntryLoaded(i));
+	}
+
+	// Loaded on access:
+	auto o = std::dynamic_pointer_cast<CObservationOdometry>(
+		lz.getAsObservation(33));
+	ASSERT_TRUE(o);
+	EXPECT_EQ(o->encoderLeftTicks, 33);
+	EXPECT_TRUE(lz.isEntryLoaded(33));
+	EXPECT_EQ(lz.getAsObservation(33), o);
+
+	// Only the observations in the time range are loaded:
+	TListTimeAndObservations found;
+	lz.findObservationsByClassInRange(
+		makeObs(10)->timestamp, makeObs(15)->timestamp,
+		CLASS_ID(CObservationOdometry), found);
+	EXPECT_EQ(found.size(), 5u);
+	EXPECT_TRUE(lz.isEntryLoaded(10));
+	EXPECT_FALSE(lz.isEntryLoaded(15));
+
+	// LRU eviction:
+	lz.setMaxLazyEntriesInMemory(3);
+	EXPECT_TRUE(lz.isEntryLoaded(14));
+	EXPECT_TRUE(lz.isEntryLoaded(12));
+	EXPECT_FALSE(lz.isEntryLoaded(11));
+	EXPECT_FALSE(lz.isEntryLoaded(33));
+	lz.getAsObservation(12);
+	lz.getAsObservation(40);
+	EXPECT_TRUE(lz.isEntryLoaded(12));
+	EXPECT_FALSE(lz.isEntryLoaded(13));
+	EXPECT_TRUE(lz.isEntryLoaded(40));
+
+	// Iterators load entries, too:
+	size_t i = 0;
+	for (auto it = lz.begin(); it != lz.end(); ++it, ++i)
+	{
+		EXPECT_EQ(it.getType(), CRawlog::etObservation);
+		auto oi = std::dynamic_pointer_cast<CObservationOdometry>(*it);
+		ASSERT_TRUE(oi);
+		EXPECT_EQ(oi->encoderLeftTicks, static_cast<int32_t>(i));
+	}
+	EXPECT_EQ(i, N);
+
+	// Removing entries, and saving, with entries loaded or not:
+	lz.remove(0, 9);
+	ASSERT_EQ(lz.size(), N - 10);
+	EXPECT_EQ(lz.getEntryTimestamp(0), makeObs(10)->timestamp);
+	lz.addObservationMemoryReference(makeObs(N));
+	ASSERT_TRUE(lz.saveToRawLogFile(fil2));
+
+	CRawlog rawlog2;
+	ASSERT_TRUE(rawlog2.loadFromRawLogFile(fil2));
+	ASSERT_EQ(rawlog2.size(), N - 9);
+	for (size_t k = 0; k < rawlog2.size(); k++)
+		EXPECT_EQ(
+			rawlog2.getAsObservation(k)->timestamp, makeObs(k + 10)->timestamp);
+
+	deleteFile(fil);
+	deleteFile(fil2);
+}
+
+TEST(CIndexedRawlog, CRawlogLazySensoryFrames)
+{
+	CRawlog rawlog;
+	const size_t N = 4;
+	for (size_t i = 0; i < N; i++)
+	{
+		auto sf = mrpt::make_aligned_shared<CSensoryFrame>();
+		sf->insert(makeObs(i));
+		rawlog.addObservationsMemoryReference(sf);
+	}
+	const std::string fil = getTempFileName();
+	ASSERT_TRUE(rawlog.saveToIndexedRawLogFile(fil, 1000));
+
+	CRawlog lz;
+	ASSERT_TRUE(lz.loadFromIndexedRawLogFile(
+		fil, INVALID_TIMESTAMP, INVALID_TIMESTAMP, true /*lazy*/));
+	ASSERT_EQ(lz.size(), N);
+
+	// The timestamp of the index, whether the entry is loaded or not:
+	EXPECT_EQ(lz.getEntryTimestamp(1), makeObs(1)->timestamp);
+	ASSERT_TRUE(lz.getAsObservations(1));
+	EXPECT_TRUE(lz.isEntryLoaded(1));
+	EXPECT_EQ(lz.getEntryTimestamp(1), makeObs(1)->timestamp);
+
+	// Erasing with iterators keeps the lazy entries in sync:
+	auto it = lz.erase(lz.begin());
+	ASSERT_EQ(lz.size(), N - 1);
+	EXPECT_TRUE(it == lz.begin());
+	EXPECT_TRUE(lz.isEntryLoaded(0));
+	for (size_t k = 0; k < lz.size(); k++)
+		EXPECT_EQ(lz.getEntryTimestamp(k), makeObs(k + 1)->timestamp);
+	EXPECT_EQ(
+		lz.getAsObservations(2)->getObservationByIndex(0)->timestamp,
+		makeObs(3)->timestamp);
+
+	deleteFile(fil);
+}
+
+TEST(CIndexedRawlog, CRawlogLazyConcurrentReads)
+{
+	CRawlog rawlog;
+	const size_t N = 200;
+	for (size_t i = 0; i < N; i++)
+		rawlog.addObservationMemoryReference(makeObs(i));
+
+	const std::string fil = getTempFileName();
+	ASSERT_TRUE(rawlog.saveToIndexedRawLogFile(fil, 1000));
+
+	CRawlog lz;
+	ASSERT_TRUE(lz.loadFromIndexedRawLogFile(
+		fil, INVALID_TIMESTAMP, INVALID_TIMESTAMP, true /*lazy*/));
+	// Few entries in memory, so threads keep unloading each other's:
+	lz.setMaxLazyEntriesInMemory(5);
+
+	const CRawlog& clz = lz;
+	std::atomic<size_t> nWrong{0};
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < 4; t++)
+		threads.emplace_back([&clz, &nWrong, t]() {
+			for (size_t k = 0; k < 2000; k++)
+			{
+				const size_t i = (k * 7 + t * 31) % N;
+				auto o = std::dynamic_pointer_cast<CObservationOdometry>(
+					clz.getAsObservation(i));
+				if (!o || o->encoderLeftTicks != static_cast<int32_t>(i))
+					nWrong++;
+				clz.isEntryLoaded(i);
+			}
+		});
+	for (auto& th : threads) th.join();
+	EXPECT_EQ(nWrong, 0u);
+
+	deleteFile(fil);
+}
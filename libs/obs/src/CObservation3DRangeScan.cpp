@@ -19,12 +19,15 @@
 #include <mrpt/math/ops_containers.h>  // norm(), etc.
 #include <mrpt/io/CFileGZInputStream.h>
 #include <mrpt/io/CFileGZOutputStream.h>
+#include <mrpt/io/zip.h>
 #include <mrpt/system/CTimeLogger.h>
 #include <mrpt/config/CConfigFileMemory.h>
 #include <mrpt/system/filesystem.h>
 #include <mrpt/system/string_utils.h>
 #include <mrpt/serialization/stl_serialization.h>
 #include <mrpt/core/bits_mem.h>  // vector_strong_clear
+#include <cmath>
+#include <cstring>
 #include <limits>
 
 using namespace std;
@@ -193,7 +196,90 @@ CObservation3DRangeScan::~CObservation3DRangeScan()
 #endif
 }
 
-uint8_t CObservation3DRangeScan::serializeGetVersion() const { return 8; }
+// Range image codecs: each pixel is converted into an integer (the bits of
+// the float value, or millimeters), and stored as the difference with the
+// previous pixel in its row, which is small in smooth surfaces. The
+// differences are split into byte planes (all the least significant bytes
+// first, and so on), which zlib compresses much better than whole values.
+static void encodeRangeImage(
+	mrpt::serialization::CArchive& out, const CMatrix& img,
+	const CObservation3DRangeScan::TRangeImageCodec codec)
+{
+	const bool mm16 = (codec == CObservation3DRangeScan::RANGE_CODEC_MM16);
+	const uint32_t rows = img.rows(), cols = img.cols();
+	const size_t N = size_t(rows) * cols, nBytes = mm16 ? 2 : 4;
+
+	std::vector<uint8_t> planes(N * nBytes), compressed;
+	for (uint32_t r = 0, i = 0; r < rows; r++)
+	{
+		uint32_t prev = 0;
+		for (uint32_t c = 0; c < cols; c++, i++)
+		{
+			const float x = img(r, c);
+			uint32_t v;
+			if (mm16)
+				v = (x > 0) ? static_cast<uint32_t>(std::min(
+								  std::lround(x * 1000.0f), 0xFFFFl))
+							: 0;
+			else
+				std::memcpy(&v, &x, sizeof(v));
+			const uint32_t d = v - prev;
+			prev = v;
+			for (size_t b = 0; b < nBytes; b++)
+				planes[b * N + i] = static_cast<uint8_t>(d >> (8 * b));
+		}
+	}
+	if (N) mrpt::io::zip::compress(planes, compressed);
+
+	out << rows << cols << static_cast<uint32_t>(compressed.size());
+	if (!compressed.empty()) out.WriteBuffer(&compressed[0], compressed.size());
+}
+
+static void decodeRangeImage(
+	mrpt::serialization::CArchive& in, CObservation3DRangeScan& obs,
+	const CObservation3DRangeScan::TRangeImageCodec codec)
+{
+	const bool mm16 = (codec == CObservation3DRangeScan::RANGE_CODEC_MM16);
+	uint32_t rows, cols, compressedSize;
+	in >> rows >> cols >> compressedSize;
+	const size_t N = size_t(rows) * cols, nBytes = mm16 ? 2 : 4;
+
+	std::vector<uint8_t> compressed(compressedSize), planes(N * nBytes);
+	if (compressedSize) in.ReadBuffer(&compressed[0], compressedSize);
+	if (N)
+	{
+		size_t actualSize = 0;
+		mrpt::io::zip::decompress(
+			&compressed[0], compressedSize, &planes[0], planes.size(),
+			actualSize);
+		ASSERT_EQUAL_(actualSize, planes.size());
+	}
+
+	obs.rangeImage_setSize(rows, cols);
+	CMatrix& img = obs.rangeImage;
+	for (uint32_t r = 0, i = 0; r < rows; r++)
+	{
+		uint32_t v = 0;
+		for (uint32_t c = 0; c < cols; c++, i++)
+		{
+			uint32_t d = 0;
+			for (size_t b = 0; b < nBytes; b++)
+				d |= static_cast<uint32_t>(planes[b * N + i]) << (8 * b);
+			if (mm16)
+			{
+				v = (v + d) & 0xFFFF;
+				img(r, c) = v * 0.001f;
+			}
+			else
+			{
+				v += d;
+				std::memcpy(&img(r, c), &v, sizeof(v));
+			}
+		}
+	}
+}
+
+uint8_t CObservation3DRangeScan::serializeGetVersion() const { return 9; }
 void CObservation3DRangeScan::serializeTo(
 	mrpt::serialization::CArchive& out) const
 {
@@ -220,7 +306,14 @@ void CObservation3DRangeScan::serializeTo(
 	}
 
 	out << hasRangeImage;
-	if (hasRangeImage) out << rangeImage;
+	if (hasRangeImage)
+	{
+		out << static_cast<uint8_t>(rangeImageCodec);  // New in v9
+		if (rangeImageCodec == RANGE_CODEC_NONE)
+			out << rangeImage;
+		else
+			encodeRangeImage(out, rangeImage, rangeImageCodec);
+	}
 	out << hasIntensityImage;
 	if (hasIntensityImage) out << intensityImage;
 	out << hasConfidenceImage;
@@ -266,6 +359,7 @@ void CObservation3DRangeScan::serializeFrom(
 		case 6:
 		case 7:
 		case 8:
+		case 9:
 		{
 			uint32_t N;
 
@@ -308,7 +402,22 @@ void CObservation3DRangeScan::serializeFrom(
 			if (version >= 1)
 			{
 				in >> hasRangeImage;
-				if (hasRangeImage)
+				rangeImageCodec = RANGE_CODEC_NONE;
+				if (hasRangeImage && version >= 9)
+				{
+					uint8_t codec;
+					in >> codec;
+					if (codec > RANGE_CODEC_MM16)
+						THROW_EXCEPTION_FMT(
+							"Unknown range image codec: %u",
+							static_cast<unsigned>(codec));
+					rangeImageCodec = static_cast<TRangeImageCodec>(codec);
+				}
+				if (hasRangeImage && rangeImageCodec != RANGE_CODEC_NONE)
+				{
+					decodeRangeImage(in, *this, rangeImageCodec);
+				}
+				else if (hasRangeImage)
 				{
 #ifdef COBS3DRANGE_USE_MEMPOOL
 					// We should call "rangeImage_setSize()" to exploit the
@@ -412,6 +521,7 @@ void CObservation3DRangeScan::swap(CObservation3DRangeScan& o)
 
 	std::swap(hasRangeImage, o.hasRangeImage);
 	rangeImage.swap(o.rangeImage);
+	std::swap(rangeImageCodec, o.rangeImageCodec);
 	std::swap(m_rangeImage_external_stored, o.m_rangeImage_external_stored);
 	std::swap(m_rangeImage_external_file, o.m_rangeImage_external_file);
 
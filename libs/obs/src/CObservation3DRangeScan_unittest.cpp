@@ -8,8 +8,11 @@
    +------------------------------------------------------------------------+ */
 
 #include <mrpt/obs/CObservation3DRangeScan.h>
+#include <mrpt/io/CMemoryStream.h>
+#include <mrpt/serialization/CArchive.h>
 
 #include <gtest/gtest.h>
+#include <cmath>
 
 using namespace mrpt;
 using namespace std;
@@ -183,3 +186,99 @@ TEST(CObservation3DRangeScan, Project3D_filterMax)
 										   << std::endl;
 	}
 }
+
+TEST(CObservation3DRangeScan, Project3D_fusedMultiThread)
+{
+	mrpt::math::CMatrix fMin(TEST_RANGEIMG_HEIGHT, TEST_RANGEIMG_WIDTH);
+	fMin.setConstant(0.5f);
+	fMin(12, 12) = 20.0f;  // don't pass
+	mrpt::obs::TRangeImageFilterParams fp;
+	fp.rangeMask_min = &fMin;
+
+	for (int i = 0; i < 16; i++)  // test all combinations of flags
+	{
+		mrpt::obs::T3DPointsProjectionParams pp;
+		mrpt::obs::CObservation3DRangeScan o;
+		fillSampleObs(o, pp, i);
+		o.range_is_depth = (i & 8) == 0;
+		o.sensorPose = mrpt::poses::CPose3D(1.0, 2.0, 0.5, 0.3, 0.1, -0.2);
+		o.cameraParams.setIntrinsicParamsFromValues(30.0, 31.0, 15.5, 11.5);
+		for (int r = 0; r < TEST_RANGEIMG_HEIGHT; r += 3)
+			for (int c = 0; c < TEST_RANGEIMG_WIDTH; c += 2)
+				o.rangeImage(r, c) = 1.0f + 0.1f * c;
+
+		// Reference: single-threaded projection
+		mrpt::obs::CObservation3DRangeScan o_ref = o;
+		o_ref.project3DPointsFromDepthImageInto(o_ref, pp, fp);
+		ASSERT_GT(o_ref.points3D_x.size(), 50U);
+
+		for (unsigned int dec = 1; dec <= 3; dec++)
+		{
+			mrpt::obs::CObservation3DRangeScan o2 = o;
+			pp.numThreads = 3;
+			pp.decimation = dec;
+			o2.project3DPointsFromDepthImageInto(o2, pp, fp);
+
+			// Same points, for the pixels kept after decimation:
+			size_t j = 0;
+			for (size_t k = 0; k < o_ref.points3D_x.size(); k++)
+			{
+				if (o_ref.points3D_idxs_x[k] % dec ||
+					o_ref.points3D_idxs_y[k] % dec)
+					continue;
+				ASSERT_LT(j, o2.points3D_x.size());
+				EXPECT_EQ(o2.points3D_idxs_x[j], o_ref.points3D_idxs_x[k]);
+				EXPECT_EQ(o2.points3D_idxs_y[j], o_ref.points3D_idxs_y[k]);
+				EXPECT_NEAR(o2.points3D_x[j], o_ref.points3D_x[k], 1e-4);
+				EXPECT_NEAR(o2.points3D_y[j], o_ref.points3D_y[k], 1e-4);
+				EXPECT_NEAR(o2.points3D_z[j], o_ref.points3D_z[k], 1e-4);
+				j++;
+			}
+			EXPECT_EQ(j, o2.points3D_x.size())
+				<< " testcase flags: i=" << i << " decimation=" << dec;
+		}
+	}
+}
+
+TEST(CObservation3DRangeScan, RangeImageCodecs)
+{
+	using mrpt::obs::CObservation3DRangeScan;
+
+	CObservation3DRangeScan o;
+	o.hasRangeImage = true;
+	o.rangeImage_setSize(TEST_RANGEIMG_HEIGHT, TEST_RANGEIMG_WIDTH);
+	for (int r = 0; r < TEST_RANGEIMG_HEIGHT; r++)
+		for (int c = 0; c < TEST_RANGEIMG_WIDTH; c++)
+			o.rangeImage(r, c) = ((r * c) % 7) ? 0.5f + 0.01f * r + 1e-5f * c
+											   : 0.0f;
+
+	size_t rawSize = 0;
+	for (const auto codec : {CObservation3DRangeScan::RANGE_CODEC_NONE,
+							 CObservation3DRangeScan::RANGE_CODEC_LOSSLESS,
+							 CObservation3DRangeScan::RANGE_CODEC_MM16})
+	{
+		o.rangeImageCodec = codec;
+		mrpt::io::CMemoryStream buf;
+		auto arch = mrpt::serialization::archiveFrom(buf);
+		arch << o;
+		if (codec == CObservation3DRangeScan::RANGE_CODEC_NONE)
+			rawSize = buf.getTotalBytesCount();
+		else
+			EXPECT_LT(buf.getTotalBytesCount(), rawSize);
+
+		buf.Seek(0);
+		CObservation3DRangeScan o2;
+		arch >> o2;
+		EXPECT_EQ(o2.rangeImageCodec, codec);
+		ASSERT_EQ(o2.rangeImage.rows(), o.rangeImage.rows());
+		ASSERT_EQ(o2.rangeImage.cols(), o.rangeImage.cols());
+		for (int r = 0; r < TEST_RANGEIMG_HEIGHT; r++)
+			for (int c = 0; c < TEST_RANGEIMG_WIDTH; c++)
+			{
+				if (codec == CObservation3DRangeScan::RANGE_CODEC_MM16)
+					EXPECT_NEAR(o2.rangeImage(r, c), o.rangeImage(r, c), 5e-4);
+				else
+					EXPECT_EQ(o2.rangeImage(r, c), o.rangeImage(r, c));
+			}
+	}
+}
@@ -13,6 +13,9 @@
 #include <mrpt/poses/CPose3DInterpolator.h>
 #include <mrpt/core/round.h>
 #include <mrpt/serialization/CArchive.h>
+#include <mrpt/system/thread_pool.h>
+#include <algorithm>
+#include <array>
 #include <iostream>
 
 using namespace std;
@@ -136,36 +139,82 @@ double VLP16AdjustTimeStamp(int firingblock, int dsr, int firingwithinblock)
 		   (firingwithinblock * VLP16_FIRING_TOFFSET);
 }
 
-/** Auxiliary class used to refactor
- * CObservationVelodyneScan::generatePointCloud() */
-struct PointCloudStorageWrapper
+/** Max. number of points generated from one data packet */
+const int MAX_POINTS_PER_PACKET =
+	CObservationVelodyneScan::BLOCKS_PER_PACKET * SCANS_PER_FIRING;
+
+/** Per-scan look-up tables for velodyne_scan_to_pointcloud() */
+struct TVelodyneDecodeTables
 {
-	/** Process the insertion of a new (x,y,z) point to the cloud, in
-	 * sensor-centric coordinates, with the exact timestamp of that LIDAR ray */
-	virtual void add_point(
-		double pt_x, double pt_y, double pt_z, uint8_t pt_intensity,
-		const mrpt::system::TTimeStamp& tim, const float azimuth) = 0;
+	/** Fraction of the azimuth difference between consecutive blocks to be
+	 * added to the azimuth of each return, to correct for the laser rotation
+	 * as a function of timing during the firings, for each block and dsr,
+	 * in single [0] and dual [1] return modes. */
+	double azimuth_adjust[2][CObservationVelodyneScan::BLOCKS_PER_PACKET]
+						 [SCANS_PER_FIRING];
+	/** false if the number of lasers does not match any known model */
+	bool known_model{true};
+
+	TVelodyneDecodeTables(const size_t num_lasers)
+	{
+		for (int dual = 0; dual < 2; dual++)
+			for (int block = 0;
+				 block < CObservationVelodyneScan::BLOCKS_PER_PACKET; block++)
+				for (int dsr = 0; dsr < SCANS_PER_FIRING; dsr++)
+				{
+					double timestampadjustment =
+						0.0;  // [us] since beginning of scan
+					double blockdsr0 = 0.0;
+					double nextblockdsr0 = 1.0;
+					switch (num_lasers)
+					{
+						// VLP-16
+						case 16:
+						{
+							// Raw laser Ids are always < 16 here (firing 0
+							// within the block):
+							const int firing = dual ? block / 2 : block;
+							timestampadjustment =
+								VLP16AdjustTimeStamp(firing, dsr, 0);
+							nextblockdsr0 =
+								VLP16AdjustTimeStamp(firing + 1, 0, 0);
+							blockdsr0 = VLP16AdjustTimeStamp(firing, 0, 0);
+						}
+						break;
+						// HDL-32:
+						case 32:
+							timestampadjustment =
+								HDL32AdjustTimeStamp(block, dsr);
+							nextblockdsr0 = HDL32AdjustTimeStamp(block + 1, 0);
+							blockdsr0 = HDL32AdjustTimeStamp(block, 0);
+							break;
+						case 64:
+							break;
+						default:
+							known_model = false;
+					};
+					azimuth_adjust[dual][block][dsr] =
+						(timestampadjustment - blockdsr0) /
+						(nextblockdsr0 - blockdsr0);
+				}
+	}
 };
 
-static void velodyne_scan_to_pointcloud(
-	const CObservationVelodyneScan& scan,
+/** Decodes the points of one data packet into `out_pts`, `out_intensity`
+ * and `out_azimuth`, with room for MAX_POINTS_PER_PACKET points.
+ * \return The number of points */
+static size_t velodyne_packet_to_points(
+	const CObservationVelodyneScan& scan, const size_t iPkt,
 	const CObservationVelodyneScan::TGeneratePointCloudParameters& params,
-	PointCloudStorageWrapper& out_pc)
+	const TVelodyneDecodeTables& tables,
+	const CSinCosLookUpTableFor2DScans::TSinCosValues& lut_sincos,
+	mrpt::math::TPoint3Df* out_pts, uint8_t* out_intensity,
+	float* out_azimuth)
 {
 	// Initially based on code from ROS velodyne & from
 	// vtkVelodyneHDLReader::vtkInternal::ProcessHDLPacket().
 	using mrpt::round;
 
-	// Access to sin/cos table:
-	mrpt::obs::T2DScanProperties scan_props;
-	scan_props.aperture = 2 * M_PI;
-	scan_props.nRays = CObservationVelodyneScan::ROTATION_MAX_UNITS;
-	scan_props.rightToLeft = true;
-	// The LUT contains sin/cos values for angles in this order: [180deg ... 0
-	// deg ... -180 deg]
-	const CSinCosLookUpTableFor2DScans::TSinCosValues& lut_sincos =
-		velodyne_sincos_tables.getSinCosForScan(scan_props);
-
 	const int minAzimuth_int = round(params.minAzimuth_deg * 100);
 	const int maxAzimuth_int = round(params.maxAzimuth_deg * 100);
 	const float realMinDist =
@@ -179,273 +228,253 @@ static void velodyne_scan_to_pointcloud(
 	// This is: 16,32,64 depending on the LIDAR model
 	const size_t num_lasers = scan.calibration.laser_corrections.size();
 
-	for (size_t iPkt = 0; iPkt < scan.scan_packets.size(); iPkt++)
-	{
-		const CObservationVelodyneScan::TVelodyneRawPacket* raw =
-			&scan.scan_packets[iPkt];
+	const CObservationVelodyneScan::TVelodyneRawPacket* raw =
+		&scan.scan_packets[iPkt];
+	const bool is_dual =
+		(raw->laser_return_mode == CObservationVelodyneScan::RETMODE_DUAL);
 
-		mrpt::system::TTimeStamp pkt_tim;  // Find out timestamp of this pkt
+	// Take the median rotational speed as a good value for interpolating
+	// the missing azimuths:
+	int median_azimuth_diff;
+	{
+		// In dual return, the azimuth rate is actually twice this
+		// estimation:
+		const int nBlocksPerAzimuth = is_dual ? 2 : 1;
+		std::array<int, CObservationVelodyneScan::BLOCKS_PER_PACKET> diffs;
+		const int nDiffs =
+			CObservationVelodyneScan::BLOCKS_PER_PACKET - nBlocksPerAzimuth;
+		for (int i = 0; i < nDiffs; ++i)
 		{
-			const uint32_t us_pkt0 = scan.scan_packets[0].gps_timestamp;
-			const uint32_t us_pkt_this = raw->gps_timestamp;
-			// Handle the case of time counter reset by new hour 00:00:00
-			const uint32_t us_ellapsed =
-				(us_pkt_this >= us_pkt0)
-					? (us_pkt_this - us_pkt0)
-					: (1000000UL * 3600UL + us_pkt_this - us_pkt0);
-			pkt_tim =
-				mrpt::system::timestampAdd(scan.timestamp, us_ellapsed * 1e-6);
+			int localDiff = (CObservationVelodyneScan::ROTATION_MAX_UNITS +
+							 raw->blocks[i + nBlocksPerAzimuth].rotation -
+							 raw->blocks[i].rotation) %
+							CObservationVelodyneScan::ROTATION_MAX_UNITS;
+			diffs[i] = localDiff;
 		}
+		std::nth_element(
+			diffs.begin(),
+			diffs.begin() + CObservationVelodyneScan::BLOCKS_PER_PACKET / 2,
+			diffs.begin() + nDiffs);  // Calc median
+		median_azimuth_diff =
+			diffs[CObservationVelodyneScan::BLOCKS_PER_PACKET / 2];
+	}
 
-		// Take the median rotational speed as a good value for interpolating
-		// the missing azimuths:
-		int median_azimuth_diff;
+	size_t nPts = 0;
+	for (int block = 0; block < CObservationVelodyneScan::BLOCKS_PER_PACKET;
+		 block++)  // Firings per packet
+	{
+		const CObservationVelodyneScan::raw_block_t& raw_block =
+			raw->blocks[block];
+
+		// ignore packets with mangled or otherwise different contents
+		if ((num_lasers != 64 &&
+			 CObservationVelodyneScan::UPPER_BANK != raw_block.header) ||
+			(raw_block.header != CObservationVelodyneScan::UPPER_BANK &&
+			 raw_block.header != CObservationVelodyneScan::LOWER_BANK))
 		{
-			// In dual return, the azimuth rate is actually twice this
-			// estimation:
-			const int nBlocksPerAzimuth =
-				(raw->laser_return_mode ==
-				 CObservationVelodyneScan::RETMODE_DUAL)
-					? 2
-					: 1;
-			std::vector<int> diffs(
-				CObservationVelodyneScan::BLOCKS_PER_PACKET -
-				nBlocksPerAzimuth);
-			for (int i = 0; i < CObservationVelodyneScan::BLOCKS_PER_PACKET -
-									nBlocksPerAzimuth;
-				 ++i)
-			{
-				int localDiff = (CObservationVelodyneScan::ROTATION_MAX_UNITS +
-								 raw->blocks[i + nBlocksPerAzimuth].rotation -
-								 raw->blocks[i].rotation) %
-								CObservationVelodyneScan::ROTATION_MAX_UNITS;
-				diffs[i] = localDiff;
-			}
-			std::nth_element(
-				diffs.begin(),
-				diffs.begin() + CObservationVelodyneScan::BLOCKS_PER_PACKET / 2,
-				diffs.end());  // Calc median
-			median_azimuth_diff =
-				diffs[CObservationVelodyneScan::BLOCKS_PER_PACKET / 2];
+			cerr << "[CObservationVelodyneScan] skipping invalid packet: "
+					"block "
+				 << block << " header value is " << raw_block.header;
+			continue;
 		}
 
-		for (int block = 0; block < CObservationVelodyneScan::BLOCKS_PER_PACKET;
-			 block++)  // Firings per packet
+		const int dsr_offset =
+			(raw_block.header == CObservationVelodyneScan::LOWER_BANK) ? 32
+																		: 0;
+		const float azimuth_raw_f = (float)(raw_block.rotation);
+		const bool block_is_dual_2nd_ranges =
+			(is_dual && ((block & 0x01) != 0));
+		const bool block_is_dual_last_ranges =
+			(is_dual && ((block & 0x01) == 0));
+		const double* azimuth_adjust =
+			tables.azimuth_adjust[is_dual ? 1 : 0][block];
+
+		for (int dsr = 0, k = 0; dsr < SCANS_PER_FIRING; dsr++, k++)
 		{
-			// ignore packets with mangled or otherwise different contents
-			if ((num_lasers != 64 &&
-				 CObservationVelodyneScan::UPPER_BANK !=
-					 raw->blocks[block].header) ||
-				(raw->blocks[block].header !=
-					 CObservationVelodyneScan::UPPER_BANK &&
-				 raw->blocks[block].header !=
-					 CObservationVelodyneScan::LOWER_BANK))
-			{
-				cerr << "[CObservationVelodyneScan] skipping invalid packet: "
-						"block "
-					 << block << " header value is "
-					 << raw->blocks[block].header;
+			if (!raw_block.laser_returns[k].distance)  // Invalid return?
 				continue;
+
+			const uint8_t laserId = static_cast<uint8_t>(dsr + dsr_offset);
+			ASSERT_BELOW_(laserId, num_lasers);
+			const mrpt::obs::VelodyneCalibration::PerLaserCalib& calib =
+				scan.calibration.laser_corrections[laserId];
+
+			// In dual return, if the distance is equal in both ranges,
+			// ignore one of them:
+			if (block_is_dual_2nd_ranges)
+			{
+				if (raw_block.laser_returns[k].distance ==
+					raw->blocks[block - 1].laser_returns[k].distance)
+					continue;  // duplicated point
+				if (!params.dualKeepStrongest) continue;
 			}
+			if (block_is_dual_last_ranges && !params.dualKeepLast) continue;
+
+			// Return distance:
+			const float distance =
+				raw_block.laser_returns[k].distance *
+					CObservationVelodyneScan::DISTANCE_RESOLUTION +
+				calib.distanceCorrection;
+			if (distance < realMinDist || distance > realMaxDist) continue;
 
-			const int dsr_offset = (raw->blocks[block].header ==
-									CObservationVelodyneScan::LOWER_BANK)
-									   ? 32
-									   : 0;
-			const float azimuth_raw_f = (float)(raw->blocks[block].rotation);
-			const bool block_is_dual_2nd_ranges =
-				(raw->laser_return_mode ==
-					 CObservationVelodyneScan::RETMODE_DUAL &&
-				 ((block & 0x01) != 0));
-			const bool block_is_dual_last_ranges =
-				(raw->laser_return_mode ==
-					 CObservationVelodyneScan::RETMODE_DUAL &&
-				 ((block & 0x01) == 0));
-
-			for (int dsr = 0, k = 0; dsr < SCANS_PER_FIRING; dsr++, k++)
+			// Isolated points filtering:
+			if (params.filterOutIsolatedPoints)
 			{
-				if (!raw->blocks[block]
-						 .laser_returns[k]
-						 .distance)  // Invalid return?
-					continue;
-
-				const uint8_t rawLaserId =
-					static_cast<uint8_t>(dsr + dsr_offset);
-				uint8_t laserId = rawLaserId;
-
-				// Detect VLP-16 data and adjust laser id if necessary
-				bool firingWithinBlock = false;
-				if (num_lasers == 16)
+				bool pass_filter = true;
+				const int16_t dist_this = raw_block.laser_returns[k].distance;
+				if (k > 0)
 				{
-					if (laserId >= 16)
-					{
-						laserId -= 16;
-						firingWithinBlock = true;
-					}
+					const int16_t dist_prev =
+						raw_block.laser_returns[k - 1].distance;
+					if (!dist_prev ||
+						std::abs(dist_this - dist_prev) >
+							isolatedPointsFilterDistance_units)
+						pass_filter = false;
 				}
-
-				ASSERT_BELOW_(laserId, num_lasers);
-				const mrpt::obs::VelodyneCalibration::PerLaserCalib& calib =
-					scan.calibration.laser_corrections[laserId];
-
-				// In dual return, if the distance is equal in both ranges,
-				// ignore one of them:
-				if (block_is_dual_2nd_ranges)
+				if (k < (SCANS_PER_FIRING - 1))
 				{
-					if (raw->blocks[block].laser_returns[k].distance ==
-						raw->blocks[block - 1].laser_returns[k].distance)
-						continue;  // duplicated point
-					if (!params.dualKeepStrongest) continue;
+					const int16_t dist_next =
+						raw_block.laser_returns[k + 1].distance;
+					if (!dist_next ||
+						std::abs(dist_this - dist_next) >
+							isolatedPointsFilterDistance_units)
+						pass_filter = false;
 				}
-				if (block_is_dual_last_ranges && !params.dualKeepLast) continue;
+				if (!pass_filter) continue;  // Filter out this point
+			}
 
-				// Return distance:
-				const float distance =
-					raw->blocks[block].laser_returns[k].distance *
-						CObservationVelodyneScan::DISTANCE_RESOLUTION +
-					calib.distanceCorrection;
-				if (distance < realMinDist || distance > realMaxDist) continue;
+			// Azimuth correction: correct for the laser rotation as a
+			// function of timing during the firings
+			if (!tables.known_model)
+				THROW_EXCEPTION("Error: unhandled LIDAR model!");
+			const int azimuthadjustment =
+				mrpt::round(median_azimuth_diff * azimuth_adjust[dsr]);
+
+			const float azimuth_corrected_f =
+				azimuth_raw_f + azimuthadjustment;
+			const int azimuth_corrected =
+				((int)round(azimuth_corrected_f)) %
+				CObservationVelodyneScan::ROTATION_MAX_UNITS;
+
+			// Filter by azimuth:
+			if (!((minAzimuth_int < maxAzimuth_int &&
+				   azimuth_corrected >= minAzimuth_int &&
+				   azimuth_corrected <= maxAzimuth_int) ||
+				  (minAzimuth_int > maxAzimuth_int &&
+				   (azimuth_corrected <= maxAzimuth_int ||
+					azimuth_corrected >= minAzimuth_int))))
+				continue;
 
-				// Isolated points filtering:
-				if (params.filterOutIsolatedPoints)
-				{
-					bool pass_filter = true;
-					const int16_t dist_this =
-						raw->blocks[block].laser_returns[k].distance;
-					if (k > 0)
-					{
-						const int16_t dist_prev =
-							raw->blocks[block].laser_returns[k - 1].distance;
-						if (!dist_prev ||
-							std::abs(dist_this - dist_prev) >
-								isolatedPointsFilterDistance_units)
-							pass_filter = false;
-					}
-					if (k < (SCANS_PER_FIRING - 1))
-					{
-						const int16_t dist_next =
-							raw->blocks[block].laser_returns[k + 1].distance;
-						if (!dist_next ||
-							std::abs(dist_this - dist_next) >
-								isolatedPointsFilterDistance_units)
-							pass_filter = false;
-					}
-					if (!pass_filter) continue;  // Filter out this point
-				}
+			// Vertical axis mis-alignment calibration:
+			const float cos_vert_angle = calib.cosVertCorrection;
+			const float sin_vert_angle = calib.sinVertCorrection;
+			const float horz_offset = calib.horizontalOffsetCorrection;
+			const float vert_offset = calib.verticalOffsetCorrection;
+
+			float xy_distance = distance * cos_vert_angle;
+			if (vert_offset) xy_distance += vert_offset * sin_vert_angle;
+
+			const int azimuth_corrected_for_lut =
+				(azimuth_corrected +
+				 (CObservationVelodyneScan::ROTATION_MAX_UNITS / 2)) %
+				CObservationVelodyneScan::ROTATION_MAX_UNITS;
+			const float cos_azimuth =
+				lut_sincos.ccos[azimuth_corrected_for_lut];
+			const float sin_azimuth =
+				lut_sincos.csin[azimuth_corrected_for_lut];
+
+			// Compute raw position
+			const mrpt::math::TPoint3Df pt(
+				xy_distance * cos_azimuth +
+					horz_offset * sin_azimuth,  // MRPT +X = Velodyne +Y
+				-(xy_distance * sin_azimuth -
+				  horz_offset * cos_azimuth),  // MRPT +Y = Velodyne -X
+				distance * sin_vert_angle + vert_offset);
+
+			bool add_point = true;
+			if (params.filterByROI &&
+				(pt.x > params.ROI_x_max || pt.x < params.ROI_x_min ||
+				 pt.y > params.ROI_y_max || pt.y < params.ROI_y_min ||
+				 pt.z > params.ROI_z_max || pt.z < params.ROI_z_min))
+				add_point = false;
+
+			if (params.filterBynROI &&
+				(pt.x <= params.nROI_x_max && pt.x >= params.nROI_x_min &&
+				 pt.y <= params.nROI_y_max && pt.y >= params.nROI_y_min &&
+				 pt.z <= params.nROI_z_max && pt.z >= params.nROI_z_min))
+				add_point = false;
+
+			if (!add_point) continue;
+
+			// Insert point:
+			out_pts[nPts] = pt;
+			out_intensity[nPts] = raw_block.laser_returns[k].intensity;
+			out_azimuth[nPts] = azimuth_corrected_f;
+			++nPts;
+		}  // end for k,dsr=[0,15]
+	}  // end for each block [0,11]
+	return nPts;
+}
 
-				// Azimuth correction: correct for the laser rotation as a
-				// function of timing during the firings
-				double timestampadjustment =
-					0.0;  // [us] since beginning of scan
-				double blockdsr0 = 0.0;
-				double nextblockdsr0 = 1.0;
-				switch (num_lasers)
-				{
-					// VLP-16
-					case 16:
-					{
-						if (raw->laser_return_mode ==
-							CObservationVelodyneScan::RETMODE_DUAL)
-						{
-							timestampadjustment = VLP16AdjustTimeStamp(
-								block / 2, laserId, firingWithinBlock);
-							nextblockdsr0 =
-								VLP16AdjustTimeStamp(block / 2 + 1, 0, 0);
-							blockdsr0 = VLP16AdjustTimeStamp(block / 2, 0, 0);
-						}
-						else
-						{
-							timestampadjustment = VLP16AdjustTimeStamp(
-								block, laserId, firingWithinBlock);
-							nextblockdsr0 =
-								VLP16AdjustTimeStamp(block + 1, 0, 0);
-							blockdsr0 = VLP16AdjustTimeStamp(block, 0, 0);
-						}
-					}
-					break;
-					// HDL-32:
-					case 32:
-						timestampadjustment = HDL32AdjustTimeStamp(block, dsr);
-						nextblockdsr0 = HDL32AdjustTimeStamp(block + 1, 0);
-						blockdsr0 = HDL32AdjustTimeStamp(block, 0);
-						break;
-					case 64:
-						break;
-					default:
-					{
-						THROW_EXCEPTION("Error: unhandled LIDAR model!");
-					}
-				};
-
-				const int azimuthadjustment = mrpt::round(
-					median_azimuth_diff * ((timestampadjustment - blockdsr0) /
-										   (nextblockdsr0 - blockdsr0)));
-
-				const float azimuth_corrected_f =
-					azimuth_raw_f + azimuthadjustment;
-				const int azimuth_corrected =
-					((int)round(azimuth_corrected_f)) %
-					CObservationVelodyneScan::ROTATION_MAX_UNITS;
-
-				// Filter by azimuth:
-				if (!((minAzimuth_int < maxAzimuth_int &&
-					   azimuth_corrected >= minAzimuth_int &&
-					   azimuth_corrected <= maxAzimuth_int) ||
-					  (minAzimuth_int > maxAzimuth_int &&
-					   (azimuth_corrected <= maxAzimuth_int ||
-						azimuth_corrected >= minAzimuth_int))))
-					continue;
-
-				// Vertical axis mis-alignment calibration:
-				const float cos_vert_angle = calib.cosVertCorrection;
-				const float sin_vert_angle = calib.sinVertCorrection;
-				const float horz_offset = calib.horizontalOffsetCorrection;
-				const float vert_offset = calib.verticalOffsetCorrection;
-
-				float xy_distance = distance * cos_vert_angle;
-				if (vert_offset) xy_distance += vert_offset * sin_vert_angle;
-
-				const int azimuth_corrected_for_lut =
-					(azimuth_corrected +
-					 (CObservationVelodyneScan::ROTATION_MAX_UNITS / 2)) %
-					CObservationVelodyneScan::ROTATION_MAX_UNITS;
-				const float cos_azimuth =
-					lut_sincos.ccos[azimuth_corrected_for_lut];
-				const float sin_azimuth =
-					lut_sincos.csin[azimuth_corrected_for_lut];
-
-				// Compute raw position
-				const mrpt::math::TPoint3Df pt(
-					xy_distance * cos_azimuth +
-						horz_offset * sin_azimuth,  // MRPT +X = Velodyne +Y
-					-(xy_distance * sin_azimuth -
-					  horz_offset * cos_azimuth),  // MRPT +Y = Velodyne -X
-					distance * sin_vert_angle + vert_offset);
-
-				bool add_point = true;
-				if (params.filterByROI &&
-					(pt.x > params.ROI_x_max || pt.x < params.ROI_x_min ||
-					 pt.y > params.ROI_y_max || pt.y < params.ROI_y_min ||
-					 pt.z > params.ROI_z_max || pt.z < params.ROI_z_min))
-					add_point = false;
-
-				if (params.filterBynROI &&
-					(pt.x <= params.nROI_x_max && pt.x >= params.nROI_x_min &&
-					 pt.y <= params.nROI_y_max && pt.y >= params.nROI_y_min &&
-					 pt.z <= params.nROI_z_max && pt.z >= params.nROI_z_min))
-					add_point = false;
-
-				if (!add_point) continue;
-
-				// Insert point:
-				out_pc.add_point(
-					pt.x, pt.y, pt.z,
-					raw->blocks[block].laser_returns[k].intensity, pkt_tim,
-					azimuth_corrected_f);
-
-			}  // end for k,dsr=[0,31]
-		}  // end for each block [0,11]
-	}  // end for each data packet
+void CObservationVelodyneScan::generatePointCloud(
+	PointCloudStorageWrapper& out_pc,
+	const TGeneratePointCloudParameters& params) const
+{
+	const size_t nPkts = scan_packets.size();
+	if (!nPkts) return;
+
+	// Access to sin/cos table:
+	mrpt::obs::T2DScanProperties scan_props;
+	scan_props.aperture = 2 * M_PI;
+	scan_props.nRays = CObservationVelodyneScan::ROTATION_MAX_UNITS;
+	scan_props.rightToLeft = true;
+	// The LUT contains sin/cos values for angles in this order: [180deg ... 0
+	// deg ... -180 deg]
+	const CSinCosLookUpTableFor2DScans::TSinCosValues& lut_sincos =
+		velodyne_sincos_tables.getSinCosForScan(scan_props);
+	const TVelodyneDecodeTables tables(calibration.laser_corrections.size());
+
+	// Packets are decoded independently (possibly in parallel) into these
+	// buffers, then passed in order to the output:
+	std::vector<mrpt::math::TPoint3Df> pts(nPkts * MAX_POINTS_PER_PACKET);
+	std::vector<uint8_t> intensity(nPkts * MAX_POINTS_PER_PACKET);
+	std::vector<float> azimuth(nPkts * MAX_POINTS_PER_PACKET);
+	std::vector<TPacketPoints> pkts(nPkts);
+
+	auto decodePackets = [&](const size_t first, const size_t last) {
+		for (size_t iPkt = first; iPkt < last; iPkt++)
+		{
+			TPacketPoints& pkt = pkts[iPkt];
+			pkt.packet_idx = iPkt;
+
+			// Find out timestamp of this pkt
+			const uint32_t us_pkt0 = scan_packets[0].gps_timestamp;
+			const uint32_t us_pkt_this = scan_packets[iPkt].gps_timestamp;
+			// Handle the case of time counter reset by new hour 00:00:00
+			const uint32_t us_ellapsed =
+				(us_pkt_this >= us_pkt0)
+					? (us_pkt_this - us_pkt0)
+					: (1000000UL * 3600UL + us_pkt_this - us_pkt0);
+			pkt.timestamp =
+				mrpt::system::timestampAdd(timestamp, us_ellapsed * 1e-6);
+
+			const size_t offset = iPkt * MAX_POINTS_PER_PACKET;
+			pkt.points = &pts[offset];
+			pkt.intensity = &intensity[offset];
+			pkt.azimuth = &azimuth[offset];
+			pkt.size = velodyne_packet_to_points(
+				*this, iPkt, params, tables, lut_sincos, &pts[offset],
+				&intensity[offset], &azimuth[offset]);
+
+			out_pc.process_packet(pkt);
+		}
+	};
+	mrpt::system::parallel_for(nPkts, params.numThreads, decodePackets);
+
+	size_t nTotal = 0;
+	for (const auto& pkt : pkts) nTotal += pkt.size;
+	out_pc.reserve(nTotal);
+	for (const auto& pkt : pkts) out_pc.add_points(pkt);
 }
 
 void CObservationVelodyneScan::generatePointCloud(
@@ -453,42 +482,53 @@ void CObservationVelodyneScan::generatePointCloud(
 {
 	struct PointCloudStorageWrapper_Inner : public PointCloudStorageWrapper
 	{
-		CObservationVelodyneScan& me_;
+		TPointCloud& pc_;
 		const TGeneratePointCloudParameters& params_;
 		PointCloudStorageWrapper_Inner(
-			CObservationVelodyneScan& me,
-			const TGeneratePointCloudParameters& p)
-			: me_(me), params_(p)
+			TPointCloud& pc, const TGeneratePointCloudParameters& p)
+			: pc_(pc), params_(p)
 		{
 			// Reset point cloud:
-			me_.point_cloud.clear();
+			pc_.clear();
 		}
-		void add_point(
-			double pt_x, double pt_y, double pt_z, uint8_t pt_intensity,
-			const mrpt::system::TTimeStamp& tim, const float azimuth) override
+		void reserve(size_t n) override
 		{
-			me_.point_cloud.x.push_back(pt_x);
-			me_.point_cloud.y.push_back(pt_y);
-			me_.point_cloud.z.push_back(pt_z);
-			me_.point_cloud.intensity.push_back(pt_intensity);
-			if (params_.generatePerPointTimestamp)
+			pc_.x.reserve(n);
+			pc_.y.reserve(n);
+			pc_.z.reserve(n);
+			pc_.intensity.reserve(n);
+			if (params_.generatePerPointTimestamp) pc_.timestamp.reserve(n);
+			if (params_.generatePerPointAzimuth) pc_.azimuth.reserve(n);
+		}
+		void add_points(const TPacketPoints& pkt) override
+		{
+			for (size_t i = 0; i < pkt.size; i++)
 			{
-				me_.point_cloud.timestamp.push_back(tim);
+				pc_.x.push_back(pkt.points[i].x);
+				pc_.y.push_back(pkt.points[i].y);
+				pc_.z.push_back(pkt.points[i].z);
 			}
+			pc_.intensity.insert(
+				pc_.intensity.end(), pkt.intensity, pkt.intensity + pkt.size);
+			if (params_.generatePerPointTimestamp)
+				pc_.timestamp.resize(
+					pc_.timestamp.size() + pkt.size, pkt.timestamp);
 			if (params_.generatePerPointAzimuth)
 			{
-				const int azimuth_corrected =
-					((int)round(azimuth)) %
-					CObservationVelodyneScan::ROTATION_MAX_UNITS;
-				me_.point_cloud.azimuth.push_back(
-					azimuth_corrected * ROTATION_RESOLUTION);
+				for (size_t i = 0; i < pkt.size; i++)
+				{
+					const int azimuth_corrected =
+						((int)round(pkt.azimuth[i])) %
+						CObservationVelodyneScan::ROTATION_MAX_UNITS;
+					pc_.azimuth.push_back(
+						azimuth_corrected * ROTATION_RESOLUTION);
+				}
 			}
 		}
 	};
 
-	PointCloudStorageWrapper_Inner my_pc_wrap(*this, params);
-
-	velodyne_scan_to_pointcloud(*this, params, my_pc_wrap);
+	PointCloudStorageWrapper_Inner my_pc_wrap(point_cloud, params);
+	generatePointCloud(my_pc_wrap, params);
 }
 
 void CObservationVelodyneScan::generatePointCloudAlongSE3Trajectory(
@@ -497,23 +537,18 @@ void CObservationVelodyneScan::generatePointCloudAlongSE3Trajectory(
 	TGeneratePointCloudSE3Results& results_stats,
 	const TGeneratePointCloudParameters& params)
 {
-	// Pre-alloc mem:
-	out_points.reserve(
-		out_points.size() +
-		scan_packets.size() * BLOCKS_PER_PACKET * SCANS_PER_BLOCK + 16);
-
 	struct PointCloudStorageWrapper_SE3_Interp : public PointCloudStorageWrapper
 	{
-		CObservationVelodyneScan& me_;
+		const CObservationVelodyneScan& me_;
 		const mrpt::poses::CPose3DInterpolator& vehicle_path_;
 		std::vector<mrpt::math::TPointXYZIu8>& out_points_;
 		TGeneratePointCloudSE3Results& results_stats_;
-		mrpt::system::TTimeStamp last_query_tim_;
-		mrpt::poses::CPose3D last_query_;
-		bool last_query_valid_;
+		/** The global sensor pose for each packet, if valid */
+		std::vector<mrpt::poses::CPose3D> sensor_poses_;
+		std::vector<uint8_t> sensor_poses_valid_;
 
 		PointCloudStorageWrapper_SE3_Interp(
-			CObservationVelodyneScan& me,
+			const CObservationVelodyneScan& me,
 			const mrpt::poses::CPose3DInterpolator& vehicle_path,
 			std::vector<mrpt::math::TPointXYZIu8>& out_points,
 			TGeneratePointCloudSE3Results& results_stats)
@@ -521,40 +556,49 @@ void CObservationVelodyneScan::generatePointCloudAlongSE3Trajectory(
 			  vehicle_path_(vehicle_path),
 			  out_points_(out_points),
 			  results_stats_(results_stats),
-			  last_query_tim_(INVALID_TIMESTAMP),
-			  last_query_valid_(false)
+			  sensor_poses_(me.scan_packets.size()),
+			  sensor_poses_valid_(me.scan_packets.size(), 0)
 		{
 		}
-		void add_point(
-			double pt_x, double pt_y, double pt_z, uint8_t pt_intensity,
-			const mrpt::system::TTimeStamp& tim, const float azimuth) override
+		void process_packet(const TPacketPoints& pkt) override
 		{
-			// Use a cache since it's expected that the same timestamp is
-			// queried several times in a row:
-			if (last_query_tim_ != tim)
-			{
-				last_query_tim_ = tim;
-				vehicle_path_.interpolate(tim, last_query_, last_query_valid_);
-			}
+			// All points in one packet share the same timestamp:
+			if (!pkt.size) return;
+			mrpt::poses::CPose3D vehicle_pose;
+			bool valid = false;
+			vehicle_path_.interpolate(pkt.timestamp, vehicle_pose, valid);
+			if (!valid) return;
+			sensor_poses_[pkt.packet_idx].composeFrom(
+				vehicle_pose, me_.sensorPose);
+			sensor_poses_valid_[pkt.packet_idx] = 1;
+		}
+		void reserve(size_t n) override
+		{
+			out_points_.reserve(out_points_.size() + n);
+		}
+		void add_points(const TPacketPoints& pkt) override
+		{
+			results_stats_.num_points += pkt.size;
+			if (!sensor_poses_valid_[pkt.packet_idx]) return;
 
-			if (last_query_valid_)
+			const mrpt::poses::CPose3D& global_sensor_pose =
+				sensor_poses_[pkt.packet_idx];
+			for (size_t i = 0; i < pkt.size; i++)
 			{
-				mrpt::poses::CPose3D global_sensor_pose(
-					mrpt::poses::UNINITIALIZED_POSE);
-				global_sensor_pose.composeFrom(last_query_, me_.sensorPose);
 				double gx, gy, gz;
-				global_sensor_pose.composePoint(pt_x, pt_y, pt_z, gx, gy, gz);
+				global_sensor_pose.composePoint(
+					pkt.points[i].x, pkt.points[i].y, pkt.points[i].z, gx,
+					gy, gz);
 				out_points_.push_back(
-					mrpt::math::TPointXYZIu8(gx, gy, gz, pt_intensity));
-				++results_stats_.num_correctly_inserted_points;
+					mrpt::math::TPointXYZIu8(gx, gy, gz, pkt.intensity[i]));
 			}
-			++results_stats_.num_points;
+			results_stats_.num_correctly_inserted_points += pkt.size;
 		}
 	};
 
 	PointCloudStorageWrapper_SE3_Interp my_pc_wrap(
 		*this, vehicle_path, out_points, results_stats);
-	velodyne_scan_to_pointcloud(*this, params, my_pc_wrap);
+	generatePointCloud(my_pc_wrap, params);
 }
 
 void CObservationVelodyneScan::TPointCloud::clear()
@@ -0,0 +1,126 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/obs/CObservationVelodyneScan.h>
+#include <mrpt/poses/CPose3DInterpolator.h>
+#include <mrpt/random.h>
+#include <mrpt/system/datetime.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::obs;
+using namespace std;
+
+// Synthetic HDL-32 scan: full revolution with random ranges
+static void fillSampleVelodyneScan(CObservationVelodyneScan& obs)
+{
+	auto& rng = mrpt::random::getRandomGenerator();
+	rng.randomize(123);
+
+	obs.timestamp = mrpt::system::now();
+	obs.calibration = VelodyneCalibration::LoadDefaultCalibration("HDL32");
+	ASSERT_FALSE(obs.calibration.empty());
+	obs.sensorPose = mrpt::poses::CPose3D(0.5, 0, 1.2, 0.1, 0, 0);
+
+	const int nPkts = 180;
+	obs.scan_packets.resize(nPkts);
+	for (int p = 0; p < nPkts; p++)
+	{
+		auto& pkt = obs.scan_packets[p];
+		pkt.gps_timestamp = 1000 + p * 553;
+		pkt.laser_return_mode = CObservationVelodyneScan::RETMODE_STRONGEST;
+		pkt.velodyne_model_ID = 0x21;
+		for (int b = 0; b < CObservationVelodyneScan::BLOCKS_PER_PACKET; b++)
+		{
+			auto& blk = pkt.blocks[b];
+			blk.header = CObservationVelodyneScan::UPPER_BANK;
+			blk.rotation = ((p * CObservationVelodyneScan::BLOCKS_PER_PACKET +
+							 b) *
+							17) %
+						   CObservationVelodyneScan::ROTATION_MAX_UNITS;
+			for (int k = 0; k < CObservationVelodyneScan::SCANS_PER_BLOCK; k++)
+			{
+				// Some invalid returns, the rest within [1,50] m:
+				blk.laser_returns[k].distance =
+					(rng.drawUniform32bit() % 10) == 0
+						? 0
+						: static_cast<uint16_t>(rng.drawUniform(500, 25000));
+				blk.laser_returns[k].intensity =
+					static_cast<uint8_t>(rng.drawUniform32bit());
+			}
+		}
+	}
+}
+
+TEST(CObservationVelodyneScan, generatePointCloudMultiThread)
+{
+	CObservationVelodyneScan obs;
+	fillSampleVelodyneScan(obs);
+
+	CObservationVelodyneScan::TGeneratePointCloudParameters pp;
+	pp.generatePerPointTimestamp = true;
+	pp.generatePerPointAzimuth = true;
+	pp.minAzimuth_deg = 10.0;
+	pp.maxAzimuth_deg = 350.0;
+
+	obs.generatePointCloud(pp);
+	const CObservationVelodyneScan::TPointCloud pc1 = obs.point_cloud;
+	EXPECT_GT(pc1.size(), 1000U);
+	EXPECT_EQ(pc1.timestamp.size(), pc1.size());
+	EXPECT_EQ(pc1.azimuth.size(), pc1.size());
+
+	pp.numThreads = 3;
+	obs.generatePointCloud(pp);
+	const CObservationVelodyneScan::TPointCloud& pc2 = obs.point_cloud;
+	EXPECT_EQ(pc1.x, pc2.x);
+	EXPECT_EQ(pc1.y, pc2.y);
+	EXPECT_EQ(pc1.z, pc2.z);
+	EXPECT_EQ(pc1.intensity, pc2.intensity);
+	EXPECT_EQ(pc1.timestamp, pc2.timestamp);
+	EXPECT_EQ(pc1.azimuth, pc2.azimuth);
+}
+
+TEST(CObservationVelodyneScan, generatePointCloudAlongSE3Trajectory)
+{
+	CObservationVelodyneScan obs;
+	fillSampleVelodyneScan(obs);
+
+	// Vehicle path covering only the first half of the scan:
+	mrpt::poses::CPose3DInterpolator path;
+	const double scan_duration = 180 * 553e-6;
+	for (int i = -2; i <= 2; i++)
+		path.insert(
+			mrpt::system::timestampAdd(obs.timestamp, i * scan_duration / 4),
+			mrpt::math::TPose3D(i * 0.1, 0, 0, i * 0.01, 0, 0));
+
+	CObservationVelodyneScan::TGeneratePointCloudParameters pp;
+	obs.generatePointCloud(pp);
+	const size_t nLocalPts = obs.point_cloud.size();
+
+	std::vector<mrpt::math::TPointXYZIu8> pts1, pts2;
+	CObservationVelodyneScan::TGeneratePointCloudSE3Results res1, res2;
+	obs.generatePointCloudAlongSE3Trajectory(path, pts1, res1, pp);
+	EXPECT_EQ(res1.num_points, nLocalPts);
+	EXPECT_GT(res1.num_correctly_inserted_points, 0U);
+	EXPECT_LT(res1.num_correctly_inserted_points, res1.num_points);
+	EXPECT_EQ(pts1.size(), res1.num_correctly_inserted_points);
+
+	pp.numThreads = 3;
+	obs.generatePointCloudAlongSE3Trajectory(path, pts2, res2, pp);
+	EXPECT_EQ(res1.num_points, res2.num_points);
+	EXPECT_EQ(
+		res1.num_correctly_inserted_points,
+		res2.num_correctly_inserted_points);
+	ASSERT_EQ(pts1.size(), pts2.size());
+	for (size_t i = 0; i < pts1.size(); i++)
+	{
+		EXPECT_EQ(pts1[i].pt, pts2[i].pt);
+		EXPECT_EQ(pts1[i].intensity, pts2[i].intensity);
+	}
+}
@@ -14,7 +14,10 @@
 #include <mrpt/io/CFileInputStream.h>
 #include <mrpt/io/CFileGZInputStream.h>
 #include <mrpt/io/CFileGZOutputStream.h>
+#include <mrpt/io/CMemoryStream.h>
 #include <mrpt/serialization/CArchive.h>
+#include <iostream>
+#include <limits>
 
 using namespace mrpt;
 using namespace mrpt::io;
@@ -32,36 +35,134 @@ CRawlog::~CRawlog() { clear(); }
 void CRawlog::clear()
 {
 	m_seqOfActObs.clear();
+	m_lazy.clear();
+	m_lazyLoaded.clear();
 	m_commentTexts.text.clear();
 }
 
+void CRawlog::pushEntry(const CSerializable::Ptr& obj)
+{
+	m_seqOfActObs.push_back(obj);
+	if (!m_lazy.empty()) m_lazy.emplace_back();
+}
+
+CSerializable::Ptr CRawlog::getEntry(size_t index) const
+{
+	std::lock_guard<std::mutex> lock(m_lazyMtx.mtx);
+	CSerializable::Ptr& obj = m_seqOfActObs[index];
+	if (m_lazy.empty() || !m_lazy[index].entry) return obj;
+
+	// A lazy entry: load it if needed, and mark it as the most recently used
+	TLazySlot& slot = m_lazy[index];
+	if (obj)
+		m_lazyLoaded.erase({slot.lastUse, index});
+	else
+	{
+		CMemoryStream buf;
+		buf.assignMemoryNotOwn(
+			slot.entry->data.data(), slot.entry->data.size());
+		obj = archiveFrom(buf).ReadObject();
+	}
+	slot.lastUse = ++m_lazyClock;
+	m_lazyLoaded.insert({slot.lastUse, index});
+	evictLazyEntries();
+	return obj;
+}
+
+const mrpt::rtti::TRuntimeClassId* CRawlog::getEntryClass(size_t index) const
+{
+	std::lock_guard<std::mutex> lock(m_lazyMtx.mtx);
+	const CSerializable::Ptr& obj = m_seqOfActObs[index];
+	if (obj) return obj->GetRuntimeClass();
+	if (m_lazy.empty() || !m_lazy[index].entry) return nullptr;
+	return m_lazy[index].entry->classID;
+}
+
+void CRawlog::evictLazyEntries() const
+{
+	if (!m_lazyMaxInMemory) return;
+	while (m_lazyLoaded.size() > m_lazyMaxInMemory)
+	{
+		m_seqOfActObs[m_lazyLoaded.begin()->second].reset();
+		m_lazyLoaded.erase(m_lazyLoaded.begin());
+	}
+}
+
+void CRawlog::setMaxLazyEntriesInMemory(const size_t maxEntries)
+{
+	std::lock_guard<std::mutex> lock(m_lazyMtx.mtx);
+	m_lazyMaxInMemory = maxEntries;
+	evictLazyEntries();
+}
+
+bool CRawlog::isEntryLoaded(size_t index) const
+{
+	MRPT_START
+	if (index >= m_seqOfActObs.size()) THROW_EXCEPTION("Index out of bounds");
+	std::lock_guard<std::mutex> lock(m_lazyMtx.mtx);
+	return m_seqOfActObs[index] != nullptr;
+	MRPT_END
+}
+
+TTimeStamp CRawlog::getEntryTimestamp(size_t index) const
+{
+	MRPT_START
+	if (index >= m_seqOfActObs.size()) THROW_EXCEPTION("Index out of bounds");
+	// Lazy entries: the timestamp in the index, whether loaded or not:
+	if (!m_lazy.empty() && m_lazy[index].entry)
+		return m_lazy[index].entry->info.timestamp;
+	const CSerializable::Ptr obj = getLoadedEntry(index);
+	if (obj && IS_DERIVED(obj, CObservation))
+		return std::dynamic_pointer_cast<CObservation>(obj)->timestamp;
+	return INVALID_TIMESTAMP;
+	MRPT_END
+}
+
+CSerializable::Ptr CRawlog::getLoadedEntry(size_t index) const
+{
+	std::lock_guard<std::mutex> lock(m_lazyMtx.mtx);
+	return m_seqOfActObs[index];
+}
+
+void CRawlog::writeEntry(CArchive& out, size_t index) const
+{
+	const CSerializable::Ptr obj = getLoadedEntry(index);
+	if (obj || m_lazy.empty() || !m_lazy[index].entry)
+		out << obj;
+	else
+	{
+		const auto& data = m_lazy[index].entry->data;
+		out.WriteBuffer(data.data(), data.size());
+	}
+}
+
 void CRawlog::addObservations(CSensoryFrame& observations)
 {
-	m_seqOfActObs.push_back(
+	pushEntry(
 		std::dynamic_pointer_cast<CSerializable>(
 			observations.duplicateGetSmartPtr()));
 }
 
 void CRawlog::addActions(CActionCollection& actions)
 {
-	m_seqOfActObs.push_back(
+	pushEntry(
 		std::dynamic_pointer_cast<CSerializable>(
 			actions.duplicateGetSmartPtr()));
 }
 
 void CRawlog::addActionsMemoryReference(const CActionCollection::Ptr& action)
 {
-	m_seqOfActObs.push_back(action);
+	pushEntry(action);
 }
 
 void CRawlog::addObservationsMemoryReference(
 	const CSensoryFrame::Ptr& observations)
 {
-	m_seqOfActObs.push_back(observations);
+	pushEntry(observations);
 }
 void CRawlog::addGenericObject(const CSerializable::Ptr& obj)
 {
-	m_seqOfActObs.push_back(obj);
+	pushEntry(obj);
 }
 
 void CRawlog::addObservationMemoryReference(
@@ -74,7 +175,7 @@ void CRawlog::addObservationMemoryReference(
 		m_commentTexts = *o;
 	}
 	else
-		m_seqOfActObs.push_back(observation);
+		pushEntry(observation);
 }
 
 void CRawlog::addAction(CAction& action)
@@ -82,7 +183,7 @@ void CRawlog::addAction(CAction& action)
 	CActionCollection::Ptr temp =
 		mrpt::make_aligned_shared<CActionCollection>();
 	temp->insert(action);
-	m_seqOfActObs.push_back(temp);
+	pushEntry(temp);
 }
 
 size_t CRawlog::size() const { return m_seqOfActObs.size(); }
@@ -92,7 +193,7 @@ CActionCollection::Ptr CRawlog::getAsAction(size_t index) const
 
 	if (index >= m_seqOfActObs.size()) THROW_EXCEPTION("Index out of bounds");
 
-	CSerializable::Ptr obj = m_seqOfActObs[index];
+	const CSerializable::Ptr& obj = getEntry(index);
 
 	if (obj->GetRuntimeClass() == CLASS_ID(CActionCollection))
 		return std::dynamic_pointer_cast<CActionCollection>(obj);
@@ -108,7 +209,7 @@ CObservation::Ptr CRawlog::getAsObservation(size_t index) const
 
 	if (index >= m_seqOfActObs.size()) THROW_EXCEPTION("Index out of bounds");
 
-	CSerializable::Ptr obj = m_seqOfActObs[index];
+	const CSerializable::Ptr& obj = getEntry(index);
 
 	if (obj->GetRuntimeClass()->derivedFrom(CLASS_ID(CObservation)))
 		return std::dynamic_pointer_cast<CObservation>(obj);
@@ -123,7 +224,7 @@ CSerializable::Ptr CRawlog::getAsGeneric(size_t index) const
 	MRPT_START
 	if (index >= m_seqOfActObs.size()) THROW_EXCEPTION("Index out of bounds");
 
-	return m_seqOfActObs[index];
+	return getEntry(index);
 	MRPT_END
 }
 
@@ -132,13 +233,15 @@ CRawlog::TEntryType CRawlog::getType(size_t index) const
 	MRPT_START
 	if (index >= m_seqOfActObs.size()) THROW_EXCEPTION("Index out of bounds");
 
-	const CSerializable::Ptr& obj = m_seqOfActObs[index];
+	const mrpt::rtti::TRuntimeClassId* cl = getEntryClass(index);
 
-	if (obj->GetRuntimeClass()->derivedFrom(CLASS_ID(CObservation)))
+	if (!cl)
+		return etOther;
+	else if (cl->derivedFrom(CLASS_ID(CObservation)))
 		return etObservation;
-	else if (obj->GetRuntimeClass() == CLASS_ID(CActionCollection))
+	else if (cl == CLASS_ID(CActionCollection))
 		return etActionCollection;
-	else if (obj->GetRuntimeClass() == CLASS_ID(CSensoryFrame))
+	else if (cl == CLASS_ID(CSensoryFrame))
 		return etSensoryFrame;
 	else
 		return etOther;
@@ -151,7 +254,7 @@ CSensoryFrame::Ptr CRawlog::getAsObservations(size_t index) const
 	MRPT_START
 	if (index >= m_seqOfActObs.size()) THROW_EXCEPTION("Index out of bounds");
 
-	CSerializable::Ptr obj = m_seqOfActObs[index];
+	const CSerializable::Ptr& obj = getEntry(index);
 
 	if (obj->GetRuntimeClass()->derivedFrom(CLASS_ID(CSensoryFrame)))
 		return std::dynamic_pointer_cast<CSensoryFrame>(obj);
@@ -165,7 +268,7 @@ uint8_t CRawlog::serializeGetVersion() const { return 1; }
 void CRawlog::serializeTo(mrpt::serialization::CArchive& out) const
 {
 	out.WriteAs<uint32_t>(m_seqOfActObs.size());
-	for (const auto& a : m_seqOfActObs) out << a;
+	for (size_t i = 0; i < m_seqOfActObs.size(); i++) writeEntry(out, i);
 	out << m_commentTexts;
 }
 
@@ -190,6 +293,9 @@ void CRawlog::serializeFrom(mrpt::serialization::CArchive& in, uint8_t version)
 bool CRawlog::loadFromRawLogFile(
 	const std::string& fileName, bool non_obs_objects_are_legal)
 {
+	if (CIndexedRawlogReader::isIndexedRawlog(fileName))
+		return loadFromIndexedRawLogFile(fileName);
+
 	// Open for read.
 	CFileGZInputStream fi(fileName);
 	if (!fi.fileOpenCorrectly()) return false;
@@ -248,7 +354,7 @@ bool CRawlog::loadFromRawLogFile(
 					keepReading = false;
 				}
 			}
-			if (add_obj) m_seqOfActObs.push_back(newObj);
+			if (add_obj) pushEntry(newObj);
 		}
 		catch (CExceptionEOF&)
 		{  // EOF, just finish the loop
@@ -271,7 +377,7 @@ void CRawlog::remove(size_t index)
 {
 	MRPT_START
 	if (index >= m_seqOfActObs.size()) THROW_EXCEPTION("Index out of bounds");
-	m_seqOfActObs.erase(m_seqOfActObs.begin() + index);
+	remove(index, index);
 	MRPT_END
 }
 
@@ -284,6 +390,16 @@ void CRawlog::remove(size_t first_index, size_t last_index)
 	m_seqOfActObs.erase(
 		m_seqOfActObs.begin() + first_index,
 		m_seqOfActObs.begin() + last_index + 1);
+	if (!m_lazy.empty())
+	{
+		m_lazy.erase(
+			m_lazy.begin() + first_index, m_lazy.begin() + last_index + 1);
+		// Indices have changed:
+		m_lazyLoaded.clear();
+		for (size_t i = 0; i < m_lazy.size(); i++)
+			if (m_lazy[i].entry && m_seqOfActObs[i])
+				m_lazyLoaded.insert({m_lazy[i].lastUse, i});
+	}
 	MRPT_END
 }
 
@@ -294,8 +410,99 @@ bool CRawlog::saveToRawLogFile(const std::string& fileName) const
 		CFileGZOutputStream fo(fileName);
 		auto f = archiveFrom(fo);
 		if (!m_commentTexts.text.empty()) f << m_commentTexts;
+		for (size_t i = 0; i < m_seqOfActObs.size(); i++) writeEntry(f, i);
+		return true;
+	}
+	catch (...)
+	{
+		return false;
+	}
+}
+
+bool CRawlog::loadFromIndexedRawLogFile(
+	const std::string& fileName, const TTimeStamp from_time,
+	const TTimeStamp to_time, const bool lazy)
+{
+	CIndexedRawlogReader fi;
+	if (!fi.open(fileName)) return false;
+
+	clear();
+
+	std::vector<size_t> entries;
+	if (from_time == INVALID_TIMESTAMP && to_time == INVALID_TIMESTAMP)
+	{
+		entries.resize(fi.size());
+		for (size_t i = 0; i < entries.size(); i++) entries[i] = i;
+	}
+	else
+	{
+		entries = fi.findEntriesInTimeRange(
+			from_time == INVALID_TIMESTAMP ? 0 : from_time,
+			to_time == INVALID_TIMESTAMP ? std::numeric_limits<TTimeStamp>::max()
+										 : to_time);
+		// The comments are always at the beginning:
+		if (fi.size() &&
+			fi.getEntryInfo(0).className ==
+				CLASS_ID(CObservationComment)->className &&
+			(entries.empty() || entries[0] != 0))
+			entries.insert(entries.begin(), 0);
+	}
+
+	try
+	{
+		m_seqOfActObs.reserve(entries.size());
+		for (const size_t i : entries)
+		{
+			const TIndexedRawlogEntry& info = fi.getEntryInfo(i);
+			if (lazy &&
+				info.className != CLASS_ID(CObservationComment)->className)
+			{
+				// Keep the serialized entry, to be loaded on first access:
+				auto e = std::make_shared<TLazyEntry>();
+				e->info = info;
+				e->classID = mrpt::rtti::findRegisteredClass(info.className);
+				fi.getSerializedEntry(i, e->data);
+				m_lazy.resize(m_seqOfActObs.size());
+				m_seqOfActObs.emplace_back();
+				m_lazy.emplace_back();
+				m_lazy.back().entry = std::move(e);
+				continue;
+			}
+			CSerializable::Ptr newObj = fi.getEntry(i);
+			if (IS_CLASS(newObj, CObservationComment))
+				m_commentTexts =
+					*std::dynamic_pointer_cast<CObservationComment>(newObj);
+			else
+				pushEntry(newObj);
+		}
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool CRawlog::saveToIndexedRawLogFile(
+	const std::string& fileName, const size_t chunkSize) const
+{
+	try
+	{
+		CIndexedRawlogWriter fo(fileName, chunkSize);
+		if (!m_commentTexts.text.empty()) fo.write(m_commentTexts);
 		for (size_t i = 0; i < m_seqOfActObs.size(); i++)
-			f << *m_seqOfActObs[i];
+		{
+			const CSerializable::Ptr obj = getLoadedEntry(i);
+			if (obj)
+				fo.write(*obj);
+			else
+			{
+				const TLazyEntry& e = *m_lazy[i].entry;
+				fo.writeSerialized(e.info, e.data.data(), e.data.size());
+			}
+		}
+		fo.close();
 		return true;
 	}
 	catch (...)
@@ -308,6 +515,10 @@ void CRawlog::swap(CRawlog& obj)
 {
 	if (this == &obj) return;
 	m_seqOfActObs.swap(obj.m_seqOfActObs);
+	m_lazy.swap(obj.m_lazy);
+	m_lazyLoaded.swap(obj.m_lazyLoaded);
+	std::swap(m_lazyClock, obj.m_lazyClock);
+	std::swap(m_lazyMaxInMemory, obj.m_lazyMaxInMemory);
 	std::swap(m_commentTexts, obj.m_commentTexts);
 }
 
@@ -444,34 +655,32 @@ void CRawlog::findObservationsByClassInRange(
 
 	if (m_seqOfActObs.empty()) return;
 
+	// Timestamps are read without loading lazy entries:
+	auto timestampOf = [this](size_t i) {
+		const mrpt::rtti::TRuntimeClassId* cl = getEntryClass(i);
+		if (!cl || !cl->derivedFrom(CLASS_ID(CObservation)))
+			THROW_EXCEPTION(
+				"Element found which is not derived from CObservation");
+		const TTimeStamp t = getEntryTimestamp(i);
+		ASSERT_(t != INVALID_TIMESTAMP);
+		return t;
+	};
+
 	// Find the first appearance of time_start:
 	// ---------------------------------------------------
-	TListObjects::const_iterator first = m_seqOfActObs.begin();
-	const TListObjects::const_iterator last = m_seqOfActObs.end();
+	size_t first = 0;
+	const size_t last = m_seqOfActObs.size();
 	{
 		// The following is based on lower_bound:
-		size_t count, step;
-		count = std::distance(first, last);
+		size_t count = last, step;
 		while (count > 0)
 		{
-			TListObjects::const_iterator it = first;
+			size_t it = first;
 			step = count / 2;
-			std::advance(it, step);
+			it += step;
 
 			// The comparison function:
-			TTimeStamp this_timestamp;
-			if ((*it)->GetRuntimeClass()->derivedFrom(CLASS_ID(CObservation)))
-			{
-				CObservation::Ptr o =
-					std::dynamic_pointer_cast<CObservation>(*it);
-				this_timestamp = o->timestamp;
-				ASSERT_(this_timestamp != INVALID_TIMESTAMP);
-			}
-			else
-				THROW_EXCEPTION(
-					"Element found which is not derived from CObservation");
-
-			if (this_timestamp < time_start)  // *it < time_start
+			if (timestampOf(it) < time_start)  // *it < time_start
 			{
 				first = ++it;
 				count -= step + 1;
@@ -483,31 +692,16 @@ void CRawlog::findObservationsByClassInRange(
 	}
 
 	// Iterate until we get out of the time window:
-	while (first != last)
+	for (; first != last; first++)
 	{
-		TTimeStamp this_timestamp;
-		if ((*first)->GetRuntimeClass()->derivedFrom(CLASS_ID(CObservation)))
-		{
-			CObservation::Ptr o =
-				std::dynamic_pointer_cast<CObservation>(*first);
-			this_timestamp = o->timestamp;
-			ASSERT_(this_timestamp != INVALID_TIMESTAMP);
-
-			if (this_timestamp < time_end)
-			{
-				if (o->GetRuntimeClass()->derivedFrom(class_type))
-					out_found.insert(TTimeObservationPair(this_timestamp, o));
-			}
-			else
-			{
-				break;  // end of time window!
-			}
-		}
-		else
-			THROW_EXCEPTION(
-				"Element found which is not derived from CObservation");
-
-		first++;
+		const TTimeStamp this_timestamp = timestampOf(first);
+		if (this_timestamp >= time_end) break;  // end of time window!
+
+		if (getEntryClass(first)->derivedFrom(class_type))
+			out_found.insert(
+				TTimeObservationPair(
+					this_timestamp,
+					std::dynamic_pointer_cast<CObservation>(getEntry(first))));
 	}
 
 	MRPT_END
@@ -0,0 +1,250 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "obs-precomp.h"  // Precompiled headers
+
+#include <mrpt/obs/CRawlogStreamReader.h>
+#include <mrpt/obs/CIndexedRawlog.h>
+#include <mrpt/io/CFileGZInputStream.h>
+#include <mrpt/serialization/CArchive.h>
+#include <mrpt/core/exceptions.h>
+#include <iostream>
+
+using namespace mrpt::obs;
+using namespace mrpt::io;
+using namespace mrpt::serialization;
+
+CRawlogStreamReader::CRawlogStreamReader(
+	const std::string& fileName, const size_t readAhead)
+{
+	if (!open(fileName, readAhead))
+		THROW_EXCEPTION_FMT(
+			"Error opening rawlog file: `%s`", fileName.c_str());
+}
+
+CRawlogStreamReader::~CRawlogStreamReader() { close(); }
+bool CRawlogStreamReader::open(
+	const std::string& fileName, const size_t readAhead)
+{
+	ASSERT_(readAhead > 0);
+	close();
+
+	// Open the file in this thread, to report errors right away:
+	try
+	{
+		if (CIndexedRawlogReader::isIndexedRawlog(fileName))
+		{
+			auto f = std::make_unique<CIndexedRawlogReader>();
+			if (!f->open(fileName)) return false;
+			m_readAhead = readAhead;
+			m_thread = std::thread(
+				&CRawlogStreamReader::threadIndexedRawlog, this, std::move(f));
+		}
+		else
+		{
+			auto f = std::make_unique<CFileGZInputStream>();
+			if (!f->open(fileName)) return false;
+			m_readAhead = readAhead;
+			m_thread = std::thread(
+				&CRawlogStreamReader::threadPlainRawlog, this, std::move(f));
+		}
+	}
+	catch (std::exception&)
+	{
+		return false;
+	}
+	return true;
+}
+
+void CRawlogStreamReader::close()
+{
+	if (m_thread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lck(m_mtx);
+			m_stop = true;
+		}
+		m_cvNotFull.notify_all();
+		m_thread.join();
+	}
+	m_queue.clear();
+	m_endOfFile = false;
+	m_stop = false;
+	m_error = nullptr;
+}
+
+size_t CRawlogStreamReader::getQueuedEntries() const
+{
+	std::lock_guard<std::mutex> lck(m_mtx);
+	return m_queue.size();
+}
+
+bool CRawlogStreamReader::push(CSerializable::Ptr obj)
+{
+	std::unique_lock<std::mutex> lck(m_mtx);
+	m_cvNotFull.wait(
+		lck, [this]() { return m_stop || m_queue.size() < m_readAhead; });
+	if (m_stop) return false;
+	m_queue.emplace_back(std::move(obj));
+	lck.unlock();
+	m_cvNotEmpty.notify_one();
+	return true;
+}
+
+void CRawlogStreamReader::setEndOfFile(std::exception_ptr error)
+{
+	{
+		std::lock_guard<std::mutex> lck(m_mtx);
+		m_endOfFile = true;
+		m_error = error;
+	}
+	m_cvNotEmpty.notify_all();
+}
+
+void CRawlogStreamReader::threadPlainRawlog(
+	std::unique_ptr<CFileGZInputStream> f)
+{
+	try
+	{
+		auto arch = archiveFrom(*f);
+		for (;;)
+		{
+			CSerializable::Ptr obj;
+			try
+			{
+				arch >> obj;
+			}
+			catch (CExceptionEOF&)
+			{
+				break;
+			}
+			if (!push(std::move(obj))) break;
+		}
+		setEndOfFile(nullptr);
+	}
+	catch (...)
+	{
+		setEndOfFile(std::current_exception());
+	}
+}
+
+void CRawlogStreamReader::threadIndexedRawlog(
+	std::unique_ptr<CIndexedRawlogReader> f)
+{
+	try
+	{
+		for (size_t i = 0; i < f->size(); i++)
+			if (!push(f->getEntry(i))) break;
+		setEndOfFile(nullptr);
+	}
+	catch (...)
+	{
+		setEndOfFile(std::current_exception());
+	}
+}
+
+CSerializable::Ptr CRawlogStreamReader::getNextEntry()
+{
+	if (!m_thread.joinable()) return CSerializable::Ptr();
+
+	std::unique_lock<std::mutex> lck(m_mtx);
+	m_cvNotEmpty.wait(
+		lck, [this]() { return m_endOfFile || !m_queue.empty(); });
+	if (m_queue.empty())
+	{
+		// End of file. Report the error, if any, only once:
+		if (m_error)
+		{
+			auto error = m_error;
+			m_error = nullptr;
+			std::rethrow_exception(error);
+		}
+		return CSerializable::Ptr();
+	}
+	auto obj = std::move(m_queue.front());
+	m_queue.pop_front();
+	lck.unlock();
+	m_cvNotFull.notify_one();
+	return obj;
+}
+
+bool CRawlogStreamReader::readActionObservationPair(
+	CActionCollection::Ptr& action, CSensoryFrame::Ptr& observations,
+	size_t& rawlogEntry)
+{
+	try
+	{
+		action.reset();
+		while (!action)
+		{
+			auto obj = getNextEntry();
+			if (!obj) return false;
+			action = std::dynamic_pointer_cast<CActionCollection>(obj);
+			rawlogEntry++;
+		}
+		observations.reset();
+		while (!observations)
+		{
+			auto obj = getNextEntry();
+			if (!obj) return false;
+			observations = std::dynamic_pointer_cast<CSensoryFrame>(obj);
+			rawlogEntry++;
+		}
+		return true;
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << "[CRawlogStreamReader::readActionObservationPair] Found "
+					 "exception:"
+				  << std::endl
+				  << e.what() << std::endl;
+		return false;
+	}
+}
+
+bool CRawlogStreamReader::getActionObservationPairOrObservation(
+	CActionCollection::Ptr& action, CSensoryFrame::Ptr& observations,
+	CObservation::Ptr& observation, size_t& rawlogEntry)
+{
+	try
+	{
+		observations.reset();
+		observation.reset();
+		action.reset();
+		while (!action)
+		{
+			auto obj = getNextEntry();
+			if (!obj) return false;
+			rawlogEntry++;
+			if (IS_CLASS(obj, CActionCollection))
+				action = std::dynamic_pointer_cast<CActionCollection>(obj);
+			else if (IS_DERIVED(obj, CObservation))
+			{
+				observation = std::dynamic_pointer_cast<CObservation>(obj);
+				return true;
+			}
+		}
+		while (!observations)
+		{
+			auto obj = getNextEntry();
+			if (!obj) return false;
+			observations = std::dynamic_pointer_cast<CSensoryFrame>(obj);
+			rawlogEntry++;
+		}
+		return true;
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << "[CRawlogStreamReader::"
+					 "getActionObservationPairOrObservation] Found exception:"
+				  << std::endl
+				  << e.what() << std::endl;
+		return false;
+	}
+}
@@ -0,0 +1,155 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/obs/CRawlogStreamReader.h>
+#include <mrpt/obs/CRawlog.h>
+#include <mrpt/obs/CActionRobotMovement2D.h>
+#include <mrpt/obs/CObservationOdometry.h>
+#include <mrpt/io/CFileOutputStream.h>
+#include <mrpt/io/CMemoryStream.h>
+#include <mrpt/serialization/CArchive.h>
+#include <mrpt/system/filesystem.h>
+#include <gtest/gtest.h>
+#include <chrono>
+
+using namespace mrpt;
+using namespace mrpt::obs;
+using namespace mrpt::system;
+using namespace std;
+
+static CObservationOdometry::Ptr makeObs(size_t i)
+{
+	auto o = mrpt::make_aligned_shared<CObservationOdometry>();
+	o->timestamp = time_tToTimestamp(1500000000.0 + i);
+	o->sensorLabel = "ODOM";
+	o->hasEncodersInfo = true;
+	o->encoderLeftTicks = static_cast<int32_t>(i);
+	return o;
+}
+
+static int32_t ticks(const CObservation::Ptr& obs)
+{
+	auto o = std::dynamic_pointer_cast<CObservationOdometry>(obs);
+	return o ? o->encoderLeftTicks : -1;
+}
+
+TEST(CRawlogStreamReader, actionObservationPairs)
+{
+	// A rawlog with a comment, and action/SF pairs:
+	CRawlog rawlog;
+	rawlog.setCommentText("A comment");
+	const size_t N = 100;
+	for (size_t i = 0; i < N; i++)
+	{
+		CActionRobotMovement2D act;
+		rawlog.addAction(act);
+		CSensoryFrame sf;
+		sf.insert(makeObs(i));
+		rawlog.addObservations(sf);
+	}
+	const std::string fil = getTempFileName(), filIdx = getTempFileName();
+	ASSERT_TRUE(rawlog.saveToRawLogFile(fil));
+	ASSERT_TRUE(rawlog.saveToIndexedRawLogFile(filIdx));
+
+	for (const auto& f : {fil, filIdx})
+	{
+		CRawlogStreamReader r(f, 3);
+		CActionCollection::Ptr action;
+		CSensoryFrame::Ptr observations;
+		size_t rawlogEntry = 0, n = 0;
+		while (r.readActionObservationPair(action, observations, rawlogEntry))
+		{
+			ASSERT_TRUE(action);
+			ASSERT_TRUE(observations);
+			EXPECT_EQ(
+				ticks(observations->getObservationByIndex(0)),
+				static_cast<int32_t>(n));
+			EXPECT_LE(r.getQueuedEntries(), 3u);
+			n++;
+		}
+		EXPECT_EQ(n, N);
+		// The comment, plus the pairs:
+		EXPECT_EQ(rawlogEntry, 1 + 2 * N);
+		EXPECT_FALSE(r.getNextEntry());
+	}
+	deleteFile(fil);
+	deleteFile(filIdx);
+}
+
+TEST(CRawlogStreamReader, observationsOnly)
+{
+	CRawlog rawlog;
+	const size_t N = 50;
+	for (size_t i = 0; i < N; i++)
+		rawlog.addObservationMemoryReference(makeObs(i));
+	const std::string fil = getTempFileName();
+	ASSERT_TRUE(rawlog.saveToRawLogFile(fil));
+
+	CRawlogStreamReader r;
+	ASSERT_TRUE(r.open(fil, 1));
+	CActionCollection::Ptr action;
+	CSensoryFrame::Ptr observations;
+	CObservation::Ptr observation;
+	size_t rawlogEntry = 0;
+	for (size_t i = 0; i < N; i++)
+	{
+		ASSERT_TRUE(r.getActionObservationPairOrObservation(
+			action, observations, observation, rawlogEntry));
+		EXPECT_FALSE(action);
+		EXPECT_EQ(ticks(observation), static_cast<int32_t>(i));
+	}
+	EXPECT_FALSE(r.getActionObservationPairOrObservation(
+		action, observations, observation, rawlogEntry));
+	EXPECT_EQ(rawlogEntry, N);
+
+	// Reopen, and close while the background thread waits on a full queue:
+	ASSERT_TRUE(r.open(fil, 2));
+	EXPECT_EQ(
+		ticks(std::dynamic_pointer_cast<CObservation>(r.getNextEntry())), 0);
+	while (r.getQueuedEntries() < 2)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	r.close();
+	EXPECT_FALSE(r.is_open());
+	EXPECT_FALSE(r.getNextEntry());
+
+	deleteFile(fil);
+}
+
+TEST(CRawlogStreamReader, errors)
+{
+	CRawlogStreamReader r;
+	EXPECT_FALSE(r.open("/nonexistent/file.rawlog"));
+	EXPECT_FALSE(r.is_open());
+	EXPECT_THROW(
+		CRawlogStreamReader("/nonexistent/file.rawlog"), std::exception);
+
+	// A corrupted file (an unknown class): the entries before the error are
+	// returned, then the error is reported.
+	const std::string fil = getTempFileName();
+	{
+		mrpt::io::CFileOutputStream f(fil);
+		auto arch = mrpt::serialization::archiveFrom(f);
+		for (size_t i = 0; i < 9; i++) arch << *makeObs(i);
+		mrpt::io::CMemoryStream buf;
+		auto archBuf = mrpt::serialization::archiveFrom(buf);
+		archBuf << *makeObs(9);
+		std::string data(
+			static_cast<const char*>(buf.getRawBufferData()),
+			buf.getTotalBytesCount());
+		const auto pos = data.find("CObservationOdometry");
+		ASSERT_NE(pos, std::string::npos);
+		data[pos] = 'X';
+		f.Write(data.data(), data.size());
+	}
+	ASSERT_TRUE(r.open(fil));
+	for (size_t i = 0; i < 9; i++) EXPECT_TRUE(r.getNextEntry());
+	EXPECT_THROW(r.getNextEntry(), std::exception);
+	EXPECT_FALSE(r.getNextEntry());
+	deleteFile(fil);
+}
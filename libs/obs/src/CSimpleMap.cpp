@@ -12,6 +12,8 @@
 #include <mrpt/maps/CSimpleMap.h>
 #include <mrpt/io/CFileGZInputStream.h>
 #include <mrpt/io/CFileGZOutputStream.h>
+#include <mrpt/io/CFileMappedInputStream.h>
+#include <mrpt/io/zip.h>
 #include <mrpt/serialization/CArchive.h>
 #include <mrpt/serialization/metaprogramming_serialization.h>
 
@@ -291,6 +293,14 @@ bool CSimpleMap::loadFromFile(const std::string& filName)
 {
 	try
 	{
+		// Uncompressed files are mapped into memory:
+		if (!mrpt::io::zip::is_gz_file(filName))
+		{
+			mrpt::io::CFileMappedInputStream fi(
+				filName, mrpt::io::CFileMappedInputStream::ahWillNeed);
+			archiveFrom(fi) >> *this;
+			return true;
+		}
 		mrpt::io::CFileGZInputStream fi(filName);
 		archiveFrom(fi) >> *this;
 		return true;
@@ -7,7 +7,11 @@
 | Released under BSD License. See details in http://www.mrpt.org/License |
 +------------------------------------------------------------------------+ */
 
+#include <mrpt/io/CFileOutputStream.h>
+#include <mrpt/io/zip.h>
 #include <mrpt/maps/CSimpleMap.h>
+#include <mrpt/serialization/CArchive.h>
+#include <mrpt/system/filesystem.h>
 #include <gtest/gtest.h>
 
 // Defined in tests/test_main.cpp
@@ -32,3 +36,34 @@ TEST(CSimpleMap, ParseFileInFormat_v1_5)
 	EXPECT_TRUE(load_ok);
 	EXPECT_EQ(sm.size(),72U);
 }
+
+TEST(CSimpleMap, LoadUncompressedFile)
+{
+#if MRPT_IS_BIG_ENDIAN
+	MRPT_TODO("Debug this issue in big endian platforms")
+	return;  // Skip this test for now
+#endif
+
+	const std::string fil =
+		mrpt::MRPT_GLOBAL_UNITTEST_SRC_DIR +
+		std::string("/share/mrpt/datasets/localization_demo.simplemap.gz");
+
+	mrpt::maps::CSimpleMap sm;
+	ASSERT_TRUE(sm.loadFromFile(fil));
+	EXPECT_TRUE(mrpt::io::zip::is_gz_file(fil));
+
+	// Same map, without gzip: it is loaded through a memory-mapped file.
+	const std::string tmp_fil = mrpt::system::getTempFileName();
+	{
+		mrpt::io::CFileOutputStream fo(tmp_fil);
+		mrpt::serialization::archiveFrom(fo) << sm;
+	}
+	EXPECT_FALSE(mrpt::io::zip::is_gz_file(tmp_fil));
+
+	mrpt::maps::CSimpleMap sm2;
+	EXPECT_TRUE(sm2.loadFromFile(tmp_fil));
+	EXPECT_EQ(sm2.size(), sm.size());
+	mrpt::system::deleteFile(tmp_fil);
+
+	EXPECT_FALSE(sm2.loadFromFile(tmp_fil));
+}
@@ -133,6 +133,10 @@ class CPosePDFParticles
 	 * assumed to be normalized!)
 	 */
 	void drawSingleSample(CPose2D& outPart) const override;
+	/** \overload Draws the sample with the given random generator, e.g. one
+	 * per thread. */
+	void drawSingleSample(
+		CPose2D& outPart, mrpt::random::CRandomGenerator& rng) const;
 
 	/** Appends (pose-composition) a given pose "p" to each particle
 	 */
@@ -17,6 +17,11 @@
 #include <mrpt/math/math_frwds.h>
 #include <memory>  // unique_ptr
 
+namespace mrpt::random
+{
+class CRandomGenerator;
+}
+
 namespace mrpt::poses
 {
 /** An efficient generator of random samples drawn from a given 2D (CPosePDF) or
@@ -58,9 +63,9 @@ class CPoseRandomSampler
 	void clear();
 
 	/** Used internally: sample from m_pdf2D */
-	void do_sample_2D(CPose2D& p) const;
+	void do_sample_2D(CPose2D& p, mrpt::random::CRandomGenerator& rng) const;
 	/** Used internally: sample from m_pdf3D */
-	void do_sample_3D(CPose3D& p) const;
+	void do_sample_3D(CPose3D& p, mrpt::random::CRandomGenerator& rng) const;
 
    public:
 	/** Default constructor */
@@ -111,6 +116,20 @@ class CPoseRandomSampler
 	  */
 	CPose3D& drawSample(CPose3D& p) const;
 
+	/** Generate a new sample from the selected PDF, using the given random
+	 * generator instead of the global one. Since this method does not modify
+	 * the sampler state, it can be called concurrently from several threads,
+	 * each one with its own generator.
+	 * \return A reference to the same object passed as argument.
+	 * \sa setPosePDF
+	 */
+	CPose2D& drawSample(
+		CPose2D& p, mrpt::random::CRandomGenerator& rng) const;
+
+	/** \overload */
+	CPose3D& drawSample(
+		CPose3D& p, mrpt::random::CRandomGenerator& rng) const;
+
 	/** Return true if samples can be generated, which only requires a previous
 	 * call to setPosePDF */
 	bool isPrepared() const;
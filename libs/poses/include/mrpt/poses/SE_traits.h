@@ -72,14 +72,16 @@ struct SE_traits<3>
 	static void jacobian_dP1DP2inv_depsilon(
 		const CPose3D& P1DP2inv, matrix_VxV_t* df_de1, matrix_VxV_t* df_de2);
 
-	/** Return one or both of the following 3x3 Jacobians, useful in graph-slam
+	/** Return one or both of the following 6x6 Jacobians, useful in graph-slam
 	* problems:
 	*   \f[  \frac{\partial pseudoLn(D^{-1} P_1^{-1} P_2}{\partial \epsilon_1}
 	* \f]
-	*   \f[  \frac{\partial pseudoLn(D^{-1} P_1^{-1} P_2}{\partial \epsilon_1}
+	*   \f[  \frac{\partial pseudoLn(D^{-1} P_1^{-1} P_2}{\partial \epsilon_2}
 	* \f]
 	*  With \f$ \epsilon_1 \f$ and \f$ \epsilon_2 \f$ being increments in the
-	* linearized manifold for P1 and P2.
+	* linearized manifold for P1 and P2, applied on the right:
+	* \f$ P_i \oplus Exp(\epsilon_i) \f$, as in
+	* mrpt::graphslam::optimize_graph_spa_levmarq().
 	*/
 	static void jacobian_dDinvP1invP2_depsilon(
 		const CPose3D& Dinv, const CPose3D& P1, const CPose3D& P2,
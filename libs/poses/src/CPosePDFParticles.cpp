@@ -280,7 +280,13 @@ void CPosePDFParticles::changeCoordinatesReference(
 
 void CPosePDFParticles::drawSingleSample(CPose2D& outPart) const
 {
-	const double uni = getRandomGenerator().drawUniform(0.0, 0.9999);
+	drawSingleSample(outPart, getRandomGenerator());
+}
+
+void CPosePDFParticles::drawSingleSample(
+	CPose2D& outPart, mrpt::random::CRandomGenerator& rng) const
+{
+	const double uni = rng.drawUniform(0.0, 0.9999);
 	double cum = 0;
 
 	for (auto& p : m_particles)
@@ -10,6 +10,7 @@
 #include "poses-precomp.h"  // Precompiled headers
 
 #include <mrpt/poses/SE_traits.h>
+#include <mrpt/math/geometry.h>  // skew_symmetric3()
 
 using namespace mrpt;
 using namespace mrpt::math;
@@ -107,10 +108,50 @@ void SE_traits<3>::jacobian_dDinvP1invP2_depsilon(
 	const CPose3D& Dinv, const CPose3D& P1, const CPose3D& P2,
 	matrix_VxV_t* df_de1, matrix_VxV_t* df_de2)
 {
-	MRPT_TODO("Implement me!");
-	THROW_EXCEPTION("Implement me!");
-}
+	// E = D^-1 * P1^-1 * P2, with the increments applied as P <- P * Exp(e):
+	const CPose3D P1invP2 = P2 - P1;
+	const CPose3D E = Dinv + P1invP2;
+
+	// Inverses of the right and left Jacobians of SO(3) at w=Ln(R_E):
+	//  Jr^-1 = I + W/2 + k*W^2 , Jl^-1 = I - W/2 + k*W^2 , with W=[w]_x
+	const CArrayDouble<3> w = E.ln_rotation();
+	const double th = w.norm();
+	const double k = th < 1e-4
+						 ? 1.0 / 12
+						 : (1 - th * sin(th) / (2 * (1 - cos(th)))) / (th * th);
+	const CMatrixDouble33 W = skew_symmetric3(w);
+	const CMatrixDouble33 W2 = W * W;
 
+	if (df_de1)
+	{
+		// This Jacobian has the structure:
+		//           [  -R_D   |  R_D * [t_{P1^-1 P2}]_x ]
+		//  Jacob1 = [ --------+------------------------ ]
+		//           [  0_3x3  |     -Jl^-1 * R_D        ]
+		//
+		matrix_VxV_t& J1 = *df_de1;
+		const CMatrixDouble33& R_D = Dinv.getRotationMatrix();
+		const CMatrixDouble33 Jl_inv =
+			CMatrixDouble33::Identity() - 0.5 * W + k * W2;
+
+		J1.zeros();
+		J1.block(0, 0, 3, 3) = -R_D;
+		J1.block(0, 3, 3, 3) = (R_D * skew_symmetric3(P1invP2.m_coords)).eval();
+		J1.block(3, 3, 3, 3) = (-Jl_inv * R_D).eval();
+	}
+	if (df_de2)
+	{
+		// This Jacobian has the structure:
+		//           [   R_E   |   0_3x3  ]
+		//  Jacob2 = [ --------+--------- ]
+		//           [  0_3x3  |   Jr^-1  ]
+		//
+		matrix_VxV_t& J2 = *df_de2;
+		J2.zeros();
+		J2.block(0, 0, 3, 3) = E.getRotationMatrix();
+		J2.block(3, 3, 3, 3) = CMatrixDouble33::Identity() + 0.5 * W + k * W2;
+	}
+}
 
 void SE_traits<2>::jacobian_dP1DP2inv_depsilon(
 	const CPose2D& P1DP2inv, matrix_VxV_t* df_de1, matrix_VxV_t* df_de2)
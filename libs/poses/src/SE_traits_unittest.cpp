@@ -141,6 +141,82 @@ class SE_traits_tests : public ::testing::Test
 			<< J2 - num_J2 << endl;
 	}
 
+	// D^-1 * P1^-1 * P2, with the increments applied on the right:
+	static void func_numeric_DinvP1invP2(
+		const CArrayDouble<2 * SE_TYPE::VECTOR_SIZE>& x, const TParams& params,
+		CArrayDouble<SE_TYPE::VECTOR_SIZE>& Y)
+	{
+		typename SE_TYPE::array_t eps1, eps2;
+		for (int i = 0; i < SE_TYPE::VECTOR_SIZE; i++)
+		{
+			eps1[i] = x[0 + i];
+			eps2[i] = x[SE_TYPE::VECTOR_SIZE + i];
+		}
+
+		POSE_TYPE incr1, incr2;
+		SE_TYPE::exp(eps1, incr1);
+		SE_TYPE::exp(eps2, incr2);
+
+		const POSE_TYPE P1 = params.P1 + incr1;
+		const POSE_TYPE P2 = params.P2 + incr2;
+		SE_TYPE::pseudo_ln(params.D + (P2 - P1), Y);
+	}
+
+	void test_jacobs_DinvP1invP2(
+		const POSE_TYPE& P1, const POSE_TYPE& Dinv, const POSE_TYPE& P2)
+	{
+		static const int DIMS = SE_TYPE::VECTOR_SIZE;
+
+		// Theoretical results:
+		CMatrixFixedNumeric<double, DIMS, DIMS> J1, J2;
+		SE_TYPE::jacobian_dDinvP1invP2_depsilon(Dinv, P1, P2, &J1, &J2);
+
+		// Numerical approx:
+		CMatrixFixedNumeric<double, DIMS, DIMS> num_J1, num_J2;
+		{
+			CArrayDouble<2 * DIMS> x_mean;
+			for (int i = 0; i < DIMS + DIMS; i++) x_mean[i] = 0;
+
+			TParams params;
+			params.P1 = P1;
+			params.D = Dinv;
+			params.P2 = P2;
+
+			CArrayDouble<DIMS + DIMS> x_incrs;
+			x_incrs.assign(1e-6);
+			CMatrixDouble numJacobs;
+			mrpt::math::estimateJacobian(
+				x_mean,
+				std::function<void(
+					const CArrayDouble<2 * SE_TYPE::VECTOR_SIZE>& x,
+					const TParams& params,
+					CArrayDouble<SE_TYPE::VECTOR_SIZE>& Y)>(
+					&func_numeric_DinvP1invP2),
+				x_incrs, params, numJacobs);
+
+			numJacobs.extractMatrix(0, 0, num_J1);
+			numJacobs.extractMatrix(0, DIMS, num_J2);
+		}
+
+		const double max_eror = 1e-3;
+		EXPECT_NEAR(0, (num_J1 - J1).array().abs().sum(), max_eror)
+			<< "p1: " << P1 << endl
+			<< "dinv: " << Dinv << endl
+			<< "p2: " << P2 << endl
+			<< "Numeric J1:\n"
+			<< num_J1 << endl
+			<< "Implemented J1:\n"
+			<< J1 << endl;
+		EXPECT_NEAR(0, (num_J2 - J2).array().abs().sum(), max_eror)
+			<< "p1: " << P1 << endl
+			<< "dinv: " << Dinv << endl
+			<< "p2: " << P2 << endl
+			<< "Numeric J2:\n"
+			<< num_J2 << endl
+			<< "Implemented J2:\n"
+			<< J2 << endl;
+	}
+
 	void do_all_jacobs_test()
 	{
 		test_jacobs_P1DP2inv(
@@ -185,3 +261,15 @@ using SE2_traits_tests = SE_traits_tests<mrpt::poses::CPose2D>;
 
 TEST_F(SE3_traits_tests, SE3_jacobs) { do_all_jacobs_test(); }
 TEST_F(SE2_traits_tests, SE2_jacobs) { do_all_jacobs_test(); }
+TEST_F(SE3_traits_tests, SE3_jacobs_DinvP1invP2)
+{
+	const CPose3D P1(1, 2, 3, DEG2RAD(10), DEG2RAD(20), DEG2RAD(30));
+	const CPose3D P2(4, 6, 2, DEG2RAD(15), DEG2RAD(25), DEG2RAD(35));
+	// Edge close to the relative pose of the nodes, and far from it:
+	test_jacobs_DinvP1invP2(P1, -(P2 - P1), P2);
+	test_jacobs_DinvP1invP2(
+		P1, -((P2 - P1) + CPose3D(0.1, -0.2, 0.1, 0.05, -0.02, 0.03)), P2);
+	test_jacobs_DinvP1invP2(
+		P1, CPose3D(-5, 3, 1, DEG2RAD(100), DEG2RAD(-40), DEG2RAD(60)), P2);
+	test_jacobs_DinvP1invP2(CPose3D(), CPose3D(), CPose3D());
+}
@@ -93,11 +93,27 @@ class CArchive
 		// big endian: convert.
 		const size_t nread = ReadBuffer(ptr, ElementCount * sizeof(T));
 		for (size_t i = 0; i < ElementCount; i++)
-			mrpt::utils::reverseBytesInPlace(ptr[i]);
+			mrpt::reverseBytesInPlace(ptr[i]);
 		return nread;
 #endif
 	}
 
+	/** Returns a pointer to the next \a Count bytes of the stream, moving the
+	 * read position past them, without copying them. Only possible for
+	 * archives whose data is already in memory (mrpt::io::CMemoryStream,
+	 * `std::vector<uint8_t>`,...); the memory belongs to the stream and is
+	 * valid only as long as the stream is not modified or destroyed.
+	 * \return nullptr (and nothing is read) if the archive does not support
+	 * this, or there are less than \a Count bytes left: use ReadBuffer() then.
+	 * \note This method is endianness-dependent.
+	 * \note [New in MRPT 2.0.0]
+	 * \sa ReadBuffer
+	 */
+	const void* ReadBufferNoCopy(size_t Count)
+	{
+		return Count ? this->readNoCopy(Count) : nullptr;
+	}
+
 	/** Writes a block of bytes to the stream from Buffer.
 	 *	\exception std::exception On any error
 	 *  \sa Important, see: WriteBufferFixEndianness
@@ -373,6 +389,13 @@ class CArchive
 	 * \return Number of bytes actually read if >0.
 	 */
 	virtual size_t read(void* buf, size_t len) = 0;
+	/** Returns a pointer to the next \a len bytes in memory and moves the read
+	 * position past them, or nullptr if not supported by this archive (the
+	 * default) or there are not enough bytes. \sa ReadBufferNoCopy */
+	virtual const void* readNoCopy(size_t len)
+	{
+		return nullptr;
+	}
 	/** @} */
 
 	/** Read the object */
@@ -530,7 +553,25 @@ CArchive& operator>>(CArchive& in, std::shared_ptr<T>& pObj)
 	return in;
 }
 
+namespace internal
+{
+/** Whether STREAM has a method `const void* ReadNoCopy(size_t)` */
+template <class STREAM, class = void>
+struct has_ReadNoCopy : std::false_type
+{
+};
+template <class STREAM>
+struct has_ReadNoCopy<
+	STREAM,
+	std::void_t<decltype(std::declval<STREAM&>().ReadNoCopy(size_t(0)))>>
+	: std::true_type
+{
+};
+}  // namespace internal
+
 /** CArchive for mrpt::io::CStream classes (use as template argument).
+ * Streams with a method `const void* ReadNoCopy(size_t)` (e.g.
+ * mrpt::io::CMemoryStream) also support CArchive::ReadBufferNoCopy().
  * \sa Easier to use via function archiveFrom() */
 template <class STREAM>
 class CArchiveStreamBase : public CArchive
@@ -543,6 +584,13 @@ class CArchiveStreamBase : public CArchive
    protected:
 	size_t write(const void* d, size_t n) override { return m_s.Write(d, n); }
 	size_t read(void* d, size_t n) override { return m_s.Read(d, n); }
+	const void* readNoCopy(size_t n) override
+	{
+		if constexpr (internal::has_ReadNoCopy<STREAM>::value)
+			return m_s.ReadNoCopy(n);
+		else
+			return CArchive::readNoCopy(n);
+	}
 };
 
 /** Helper function to create a templatized wrapper CArchive object for a:
@@ -24,7 +24,7 @@ template <>
 class CArchiveStreamBase<std::vector<uint8_t>> : public CArchive
 {
 	std::vector<uint8_t>& m_v;
-	int m_pos_read{0};
+	size_t m_pos_read{0};
 
    public:
 	CArchiveStreamBase(std::vector<uint8_t>& v) : m_v(v) {}
@@ -38,21 +38,27 @@ class CArchiveStreamBase<std::vector<uint8_t>> : public CArchive
 	}
 	size_t read(void* d, size_t n) override
 	{
-		const int avail = static_cast<int>(m_v.size()) - m_pos_read;
-		if (avail < static_cast<int>(n))
+		if (m_v.size() - m_pos_read < n)
 			throw std::runtime_error(
 				"CArchiveStreamBase: EOF reading from std::vector!");
 		::memcpy(d, &m_v[m_pos_read], n);
 		m_pos_read += n;
 		return n;
 	};
+	const void* readNoCopy(size_t n) override
+	{
+		if (m_v.size() - m_pos_read < n) return nullptr;
+		const void* d = &m_v[m_pos_read];
+		m_pos_read += n;
+		return d;
+	}
 };
 /** Read-only version of the wrapper. See archiveFrom() */
 template <>
 class CArchiveStreamBase<const std::vector<uint8_t>> : public CArchive
 {
 	const std::vector<uint8_t>& m_v;
-	int m_pos_read{0};
+	size_t m_pos_read{0};
 
    public:
 	CArchiveStreamBase(const std::vector<uint8_t>& v) : m_v(v) {}
@@ -64,14 +70,20 @@ class CArchiveStreamBase<const std::vector<uint8_t>> : public CArchive
 	}
 	size_t read(void* d, size_t n) override
 	{
-		const int avail = static_cast<int>(m_v.size()) - m_pos_read;
-		if (avail < static_cast<int>(n))
+		if (m_v.size() - m_pos_read < n)
 			throw std::runtime_error(
 				"CArchiveStreamBase: EOF reading from std::vector!");
 		::memcpy(d, &m_v[m_pos_read], n);
 		m_pos_read += n;
 		return n;
 	};
+	const void* readNoCopy(size_t n) override
+	{
+		if (m_v.size() - m_pos_read < n) return nullptr;
+		const void* d = &m_v[m_pos_read];
+		m_pos_read += n;
+		return d;
+	}
 };
 }
 
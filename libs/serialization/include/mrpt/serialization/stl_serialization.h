@@ -18,12 +18,77 @@
 #include <map>
 #include <list>
 #include <algorithm>  // for_each()
+#include <type_traits>
 
 namespace mrpt::serialization
 {
 /** \addtogroup stlext_grp
   * @{ */
 
+namespace internal
+{
+/** Element types with a fixed-size binary representation, which can be
+ * read/written in a single block for contiguous containers, instead of one
+ * by one, with the very same bytes in the stream. */
+template <class T>
+constexpr bool is_bulk_serializable_v =
+	std::is_same_v<T, uint8_t> || std::is_same_v<T, int8_t> ||
+	std::is_same_v<T, uint16_t> || std::is_same_v<T, int16_t> ||
+	std::is_same_v<T, uint32_t> || std::is_same_v<T, int32_t> ||
+	std::is_same_v<T, uint64_t> || std::is_same_v<T, int64_t> ||
+	std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+template <class CONTAINER>
+struct is_contiguous_container : std::false_type
+{
+};
+template <class T, class _Ax>
+struct is_contiguous_container<std::vector<T, _Ax>> : std::true_type
+{
+};
+template <class T, size_t N>
+struct is_contiguous_container<std::array<T, N>> : std::true_type
+{
+};
+
+/** Writes all the elements of a container */
+template <class CONTAINER>
+void writeElements(CArchive& out, const CONTAINER& obj)
+{
+	using T = typename CONTAINER::value_type;
+	if constexpr (
+		is_contiguous_container<CONTAINER>::value &&
+		is_bulk_serializable_v<T>)
+	{
+		if (!obj.empty()) out.WriteBufferFixEndianness(obj.data(), obj.size());
+	}
+	else
+		std::for_each(
+			obj.begin(), obj.end(),
+			metaprogramming::ObjectWriteToStream(&out));
+}
+/** Reads all the elements of a container, already with its final size */
+template <class CONTAINER>
+void readElements(CArchive& in, CONTAINER& obj)
+{
+	using T = typename CONTAINER::value_type;
+	if constexpr (
+		is_contiguous_container<CONTAINER>::value &&
+		is_bulk_serializable_v<T>)
+	{
+		if (obj.empty()) return;
+		const size_t nBytes = obj.size() * sizeof(T);
+		if (in.ReadBufferFixEndianness(obj.data(), obj.size()) != nBytes)
+			THROW_EXCEPTION_FMT(
+				"(EOF?) Cannot read the %u elements of a container from stream",
+				static_cast<unsigned>(obj.size()));
+	}
+	else
+		std::for_each(
+			obj.begin(), obj.end(), metaprogramming::ObjectReadFromStream(&in));
+}
+}  // namespace internal
+
 #define MRPTSTL_SERIALIZABLE_SEQ_CONTAINER(CONTAINER)                          \
 	/** Template method to serialize a sequential STL container  */            \
 	template <class T, class _Ax>                                              \
@@ -31,9 +96,7 @@ namespace mrpt::serialization
 	{                                                                          \
 		out << std::string(#CONTAINER) << mrpt::typemeta::TTypeName<T>::get(); \
 		out << static_cast<uint32_t>(obj.size());                              \
-		std::for_each(                                                         \
-			obj.begin(), obj.end(),                                            \
-			metaprogramming::ObjectWriteToStream(&out));                       \
+		internal::writeElements(out, obj);                                     \
 		return out;                                                            \
 	}                                                                          \
 	/** Template method to deserialize a sequential STL container */           \
@@ -58,9 +121,7 @@ namespace mrpt::serialization
 		uint32_t n;                                                            \
 		in >> n;                                                               \
 		obj.resize(n);                                                         \
-		std::for_each(                                                         \
-			obj.begin(), obj.end(),                                            \
-			metaprogramming::ObjectReadFromStream(&in));                       \
+		internal::readElements(in, obj);                                       \
 		return in;                                                             \
 	}
 
@@ -187,8 +248,7 @@ CArchive& operator<<(CArchive& out, const std::array<T, N>& obj)
 {
 	out << std::string("std::array") << static_cast<uint32_t>(N)
 		<< mrpt::typemeta::TTypeName<T>::get();
-	std::for_each(
-		obj.begin(), obj.end(), metaprogramming::ObjectWriteToStream(&out));
+	internal::writeElements(out, obj);
 	return out;
 }
 
@@ -210,8 +270,7 @@ CArchive& operator>>(CArchive& in, std::array<T, N>& obj)
 		THROW_EXCEPTION_FMT(
 			"Error: serialized container std::array< %s != %s >",
 			stored_T.c_str(), mrpt::typemeta::TTypeName<T>::get().c_str());
-	std::for_each(
-		obj.begin(), obj.end(), metaprogramming::ObjectReadFromStream(&in));
+	internal::readElements(in, obj);
 	return in;
 }
 
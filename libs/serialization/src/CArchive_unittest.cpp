@@ -0,0 +1,115 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/serialization/CArchive.h>
+#include <mrpt/serialization/archiveFrom_std_streams.h>
+#include <mrpt/serialization/archiveFrom_std_vector.h>
+#include <mrpt/serialization/stl_serialization.h>
+#include <mrpt/io/CMemoryStream.h>
+#include <mrpt/io/CFileMappedInputStream.h>
+#include <mrpt/io/CFileOutputStream.h>
+#include <mrpt/system/filesystem.h>
+#include <gtest/gtest.h>
+#include <sstream>
+
+using namespace mrpt::serialization;
+
+TEST(CArchive, ReadBufferNoCopy_CMemoryStream)
+{
+	mrpt::io::CMemoryStream f;
+	auto arch = archiveFrom(f);
+	const std::vector<float> v{1.f, 2.f, 3.f, 4.f};
+	arch.WriteBufferFixEndianness(&v[0], v.size());
+	arch << uint8_t(5);
+
+	f.Seek(0);
+	const void* data = arch.ReadBufferNoCopy(sizeof(float) * v.size());
+	ASSERT_TRUE(data != nullptr);
+	EXPECT_EQ(data, f.getRawBufferData());
+	EXPECT_EQ(static_cast<const float*>(data)[3], 4.f);
+	uint8_t b;
+	arch >> b;
+	EXPECT_EQ(b, 5);
+
+	// Not enough data: nothing is read
+	const auto pos = f.getPosition();
+	EXPECT_TRUE(arch.ReadBufferNoCopy(1 << 20) == nullptr);
+	EXPECT_EQ(f.getPosition(), pos);
+}
+
+TEST(CArchive, ReadBufferNoCopy_std_vector)
+{
+	std::vector<uint8_t> buf;
+	auto out = archiveFrom(buf);
+	out << uint32_t(0x12345678) << uint8_t(9);
+
+	const auto& cbuf = buf;
+	auto in = archiveFrom(cbuf);
+	const void* data = in.ReadBufferNoCopy(sizeof(uint32_t));
+	ASSERT_TRUE(data != nullptr);
+	EXPECT_EQ(data, &buf[0]);
+	EXPECT_TRUE(in.ReadBufferNoCopy(2) == nullptr);
+	uint8_t b;
+	in >> b;
+	EXPECT_EQ(b, 9);
+}
+
+TEST(CArchive, ReadBufferNoCopy_CFileMappedInputStream)
+{
+	const std::string fil = mrpt::system::getTempFileName();
+	const std::vector<double> v{1.0, 2.0, 3.0};
+	{
+		mrpt::io::CFileOutputStream fo(fil);
+		auto arch = archiveFrom(fo);
+		arch << v;
+	}
+	{
+		mrpt::io::CFileMappedInputStream fi(fil);
+		auto arch = archiveFrom(fi);
+		std::vector<double> v2;
+		arch >> v2;
+		EXPECT_EQ(v, v2);
+
+		fi.Seek(fi.getTotalBytesCount() - sizeof(double));
+		const void* data = arch.ReadBufferNoCopy(sizeof(double));
+		ASSERT_TRUE(data != nullptr);
+		EXPECT_EQ(*static_cast<const double*>(data), 3.0);
+	}
+	mrpt::system::deleteFile(fil);
+}
+
+TEST(CArchive, ReadBufferNoCopy_unsupported)
+{
+	// Streams not in memory: use ReadBuffer() instead
+	std::stringstream ss("abcd");
+	auto arch = archiveFrom(static_cast<std::istream&>(ss));
+	EXPECT_TRUE(arch.ReadBufferNoCopy(2) == nullptr);
+	char c[4];
+	EXPECT_EQ(arch.ReadBuffer(c, 4), 4U);
+}
+
+TEST(CArchive, CMemoryStream_largeWrites)
+{
+	mrpt::io::CMemoryStream f;
+	auto arch = archiveFrom(f);
+	std::vector<uint8_t> block(1000);
+	for (size_t i = 0; i < block.size(); i++) block[i] = i & 0xff;
+	const size_t N = 5000;
+	for (size_t i = 0; i < N; i++) arch.WriteBuffer(&block[0], block.size());
+	EXPECT_EQ(f.getTotalBytesCount(), N * block.size());
+
+	f.Seek(0);
+	for (size_t i = 0; i < N; i++)
+	{
+		const auto* data =
+			static_cast<const uint8_t*>(arch.ReadBufferNoCopy(block.size()));
+		ASSERT_TRUE(data != nullptr);
+		ASSERT_TRUE(std::equal(block.begin(), block.end(), data));
+	}
+}
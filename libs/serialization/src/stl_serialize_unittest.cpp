@@ -10,6 +10,7 @@
 #include <mrpt/serialization/CSerializable.h>
 #include <mrpt/serialization/CArchive.h>
 #include <mrpt/serialization/stl_serialization.h>
+#include <mrpt/serialization/archiveFrom_std_vector.h>
 #include <mrpt/io/CMemoryStream.h>
 #include <gtest/gtest.h>
 #include <memory>  // shared_ptr
@@ -120,3 +121,49 @@ TEST(Serialization, vector_shared_ptr)
 		}
 	}
 }
+
+TEST(Serialization, STL_contiguous_PODs)
+{
+	// Contiguous containers of PODs are written in a single block, with the
+	// same bytes as element by element:
+	const std::array<uint16_t, 3> a1{{10, 20, 30}};
+	std::vector<uint8_t> bulk, byElement;
+	{
+		auto arch = archiveFrom(bulk);
+		arch << a1;
+	}
+	{
+		auto arch = archiveFrom(byElement);
+		arch << std::string("std::array") << static_cast<uint32_t>(3)
+			 << mrpt::typemeta::TTypeName<uint16_t>::get();
+		for (const auto v : a1) arch << v;
+	}
+	EXPECT_EQ(bulk, byElement);
+
+	std::array<uint16_t, 3> a2;
+	auto arch = archiveFrom(bulk);
+	arch >> a2;
+	EXPECT_EQ(a1, a2);
+
+	std::array<double, 0> e1, e2;
+	mrpt::io::CMemoryStream f;
+	auto arch2 = archiveFrom(f);
+	arch2 << e1;
+	f.Seek(0);
+	arch2 >> e2;
+}
+
+TEST(Serialization, STL_contiguous_PODs_truncated)
+{
+	const std::vector<double> v1{1.0, 2.0, 3.0, 4.0, 5.0};
+	std::vector<uint8_t> buf;
+	{
+		auto arch = archiveFrom(buf);
+		arch << v1;
+	}
+	// A buffer ending in the middle of the elements must not be accepted:
+	buf.resize(buf.size() - 3);
+	std::vector<double> v2;
+	auto arch = archiveFrom(buf);
+	EXPECT_ANY_THROW(arch >> v2);
+}
@@ -0,0 +1,129 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/config/CLoadableOptions.h>
+#include <mrpt/maps/COccupancyGridMap2D.h>
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/math/lightweight_geom_data.h>
+#include <mrpt/system/COutputLogger.h>
+#include <mrpt/core/bits_math.h>
+
+namespace mrpt::slam
+{
+/** Correlative scan matcher which finds the 2D pose of a set of points (e.g.
+ * a laser scan) in an occupancy grid map maximizing the occupancy of the
+ * cells under the points, within a (possibly large) search window.
+ *
+ * The search over the discretized poses in the window (with the grid
+ * resolution as the translation step) is done with branch-and-bound, as
+ * described in:
+ *  - W. Hess, D. Kohler, H. Rapp and D. Andor, "Real-Time Loop Closure in
+ * 2D LIDAR SLAM", ICRA 2016.
+ *
+ * Upper bounds of the score of whole blocks of 2^h x 2^h translations are
+ * obtained from the max-pooled resolution pyramid of the grid (see
+ * mrpt::maps::COccupancyGridMap2D::getResolutionPyramidLevel()), so most of
+ * the window is discarded at the coarse levels. The result is the same than
+ * an exhaustive search, usually at a tiny fraction of its cost, so it can be
+ * used to relocalize a robot in a whole map (see matchGlobal() and
+ * CMonteCarloLocalization2D::resetFromGlobalScanMatch()).
+ *
+ * The score of a pose is the mean occupancy probability, in the range
+ * [0,1], of the cells where the points fall. Points out of the grid count
+ * as free space. To save time, the points should be decimated to about one
+ * per grid cell.
+ *
+ * \sa CGridMapAligner, CICP
+ * \ingroup mrpt_slam_grp
+ */
+class CBranchAndBoundScanMatcher : public mrpt::system::COutputLogger
+{
+   public:
+	CBranchAndBoundScanMatcher()
+		: mrpt::system::COutputLogger("CBranchAndBoundScanMatcher")
+	{
+	}
+
+	/** Matcher parameters */
+	struct TOptions : public mrpt::config::CLoadableOptions
+	{
+		void loadFromConfigFile(
+			const mrpt::config::CConfigFileBase& source,
+			const std::string& section) override;  // See base docs
+		void dumpToTextStream(
+			std::ostream& out) const override;  // See base docs
+
+		/** Half-size of the search window in x and y, around the initial
+		 * guess (meters) (Default=1) */
+		double window_linear{1.0};
+		/** Half-size of the search window in orientation, around the initial
+		 * guess (radians). Values >=PI search all the orientations.
+		 * (Default=30deg) */
+		double window_angular{mrpt::DEG2RAD(30.0)};
+		/** Orientation step (radians). 0 (default) means using the step that
+		 * moves the farthest point by one grid cell. */
+		double angular_step{0};
+		/** Number of levels of the resolution pyramid to use (>=1). The
+		 * coarsest level evaluates blocks of 2^(levels-1) cells (Default=7) */
+		unsigned int pyramid_levels{7};
+		/** Minimum score (mean occupancy probability of the cells under the
+		 * points, in [0,1]) of a valid match (Default=0.55) */
+		double min_score{0.55};
+	};
+
+	/** Matcher parameters */
+	TOptions options;
+
+	/** Output of match() */
+	struct TResult
+	{
+		/** The best pose found (only valid if the method returned true) */
+		mrpt::math::TPose2D pose;
+		/** Score of the pose, in [0,1] */
+		double score{0};
+		/** Number of orientations evaluated */
+		size_t nAngles{0};
+		/** Step between evaluated orientations (radians) */
+		double angularStep{0};
+		/** Number of scores computed, at all the pyramid levels */
+		size_t nScoresComputed{0};
+	};
+
+	/** Finds the pose of the points within the search window (see options)
+	 * around \a initialGuess.
+	 * \param grid The occupancy grid (its resolution pyramid is created or
+	 * updated as needed).
+	 * \param points The points, in the local frame of the pose to be found.
+	 * \param initialGuess The center of the search window.
+	 * \param result The best pose and its score.
+	 * \return false if no pose with a score of at least options.min_score
+	 * was found.
+	 */
+	bool match(
+		const mrpt::maps::COccupancyGridMap2D& grid,
+		const mrpt::maps::CPointsMap& points,
+		const mrpt::math::TPose2D& initialGuess, TResult& result) const;
+
+	/** Like match(), but with a search window covering the whole grid map
+	 * and all the orientations (options.window_linear and
+	 * options.window_angular are ignored). */
+	bool matchGlobal(
+		const mrpt::maps::COccupancyGridMap2D& grid,
+		const mrpt::maps::CPointsMap& points, TResult& result) const;
+
+   protected:
+	bool match(
+		const mrpt::maps::COccupancyGridMap2D& grid,
+		const mrpt::maps::CPointsMap& points,
+		const mrpt::math::TPose2D& initialGuess, double window_x,
+		double window_y, double window_phi, TResult& result) const;
+};
+
+}  // namespace mrpt::slam
@@ -18,6 +18,7 @@
 #include <mrpt/poses/poses_frwds.h>
 #include <mrpt/vision/CFeatureExtraction.h>
 #include <mrpt/slam/COccupancyGridMapFeatureExtractor.h>
+#include <mrpt/slam/CBranchAndBoundScanMatcher.h>
 
 namespace mrpt::slam
 {
@@ -25,13 +26,18 @@ namespace mrpt::slam
  * a points map, at least) based on features extraction and matching.
  * The matching pose is returned as a Sum of Gaussians (poses::CPosePDFSOG).
  *
- *  This class can use three methods (see options.methodSelection):
+ *  This class can use four methods (see options.methodSelection):
  *   - amCorrelation: "Brute-force" correlation of the two maps over a
  * 2D+orientation grid of possible 2D poses.
  *   - amRobustMatch: Detection of features + RANSAC matching
  *   - amModifiedRANSAC: Detection of features + modified multi-hypothesis
  * RANSAC matching as described in was reported in the paper
  * http://www.mrpt.org/Paper%3AOccupancy_Grid_Matching
+ *   - amBranchAndBound: Correlation of the occupied cells of the second map
+ * with the first one, over the poses in a window around the initial
+ * estimation, with a branch-and-bound search which gives the same result
+ * than an exhaustive search at a fraction of its cost (see
+ * CBranchAndBoundScanMatcher).
  *
  * See CGridMapAligner::Align for more instructions.
  *
@@ -56,6 +62,13 @@ class CGridMapAligner : public mrpt::slam::CMetricMapsAlignmentAlgorithm
 		const mrpt::poses::CPosePDFGaussian& initialEstimationPDF,
 		float* runningTime = nullptr, void* info = nullptr);
 
+	/** Private member, implements the "amBranchAndBound" algorithm.
+	 */
+	mrpt::poses::CPosePDF::Ptr AlignPDF_branchAndBound(
+		const mrpt::maps::CMetricMap* m1, const mrpt::maps::CMetricMap* m2,
+		const mrpt::poses::CPosePDFGaussian& initialEstimationPDF,
+		float* runningTime = nullptr, void* info = nullptr);
+
 	/** Grid map features extractor */
 	COccupancyGridMapFeatureExtractor m_grid_feat_extr;
 
@@ -67,7 +80,8 @@ class CGridMapAligner : public mrpt::slam::CMetricMapsAlignmentAlgorithm
 	{
 		amRobustMatch = 0,
 		amCorrelation,
-		amModifiedRANSAC
+		amModifiedRANSAC,
+		amBranchAndBound
 	};
 
 	/** The ICP algorithm configuration data
@@ -95,6 +109,10 @@ class CGridMapAligner : public mrpt::slam::CMetricMapsAlignmentAlgorithm
 		/** All the parameters for the feature detector. */
 		mrpt::vision::CFeatureExtraction::TOptions feature_detector_options;
 
+		/** [amBranchAndBound method only] The search window and other
+		 * parameters of the matcher. */
+		CBranchAndBoundScanMatcher::TOptions branchAndBound_options;
+
 		/** RANSAC-step options:
 		 * \sa CICP::robustRigidTransformation
 		 */
@@ -213,7 +231,8 @@ class CGridMapAligner : public mrpt::slam::CMetricMapsAlignmentAlgorithm
 	 * \param m2			[IN] The second map (Must be a
 	 *mrpt::maps::CMultiMetricMap
 	 *class)
-	 * \param initialEstimationPDF	[IN] (IGNORED IN THIS ALGORITHM!)
+	 * \param initialEstimationPDF	[IN] (Only used as the center of the
+	 *search window in "amBranchAndBound")
 	 * \param runningTime	[OUT] A pointer to a container for obtaining the
 	 *algorithm running time in seconds, or NULL if you don't need it.
 	 * \param info			[OUT] A pointer to a TReturnInfo struct, or NULL if
@@ -222,6 +241,7 @@ class CGridMapAligner : public mrpt::slam::CMetricMapsAlignmentAlgorithm
 	 * \note The returned PDF depends on the selected alignment method:
 	 *		- "amRobustMatch" --> A "poses::CPosePDFSOG" object.
 	 *		- "amCorrelation" --> A "poses::CPosePDFGrid" object.
+	 *		- "amBranchAndBound" --> A "poses::CPosePDFGaussian" object.
 	 *
 	 * \return A smart pointer to the output estimated pose PDF.
 	 * \sa CPointsMapAlignmentAlgorithm, options
@@ -246,6 +266,7 @@ using namespace mrpt::slam;
 MRPT_FILL_ENUM_MEMBER(CGridMapAligner, amRobustMatch);
 MRPT_FILL_ENUM_MEMBER(CGridMapAligner, amCorrelation);
 MRPT_FILL_ENUM_MEMBER(CGridMapAligner, amModifiedRANSAC);
+MRPT_FILL_ENUM_MEMBER(CGridMapAligner, amBranchAndBound);
 MRPT_ENUM_TYPE_END()
 
 #endif
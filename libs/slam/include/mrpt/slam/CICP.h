@@ -20,7 +20,14 @@ namespace mrpt::slam
 enum TICPAlgorithm
 {
 	icpClassic = 0,
-	icpLevenbergMarquardt
+	icpLevenbergMarquardt,
+	/** [3D only] Gauss-Newton minimization of the distances from each point
+	 * to the plane around its pairing in the reference map. */
+	icpPointToPlane,
+	/** [3D only] Generalized-ICP (Segal, Haehnel & Thrun, RSS 2009):
+	 * Gauss-Newton minimization of the distances between pairings weighted
+	 * with the covariances of the local planes of both maps. */
+	icpGeneralized
 };
 
 /** ICP covariance estimation methods, used in mrpt::slam::CICP::options
@@ -82,6 +89,11 @@ class CICP : public mrpt::slam::CMetricMapsAlignmentAlgorithm
 		 * http://www.mrpt.org/tutorials/programming/scan-matching-and-icp/ for
 		 * details */
 		TICPAlgorithm ICP_algorithm{icpClassic};
+		/** [icpPointToPlane and icpGeneralized only] Number of nearest
+		 * neighbors used to estimate the normals and covariances of the
+		 * points, which are cached in the maps (see
+		 * mrpt::maps::CPointsMap::getLocalGeometry()) (Default=10) */
+		unsigned int localGeometry_knn{10};
 		/** The method to use for covariance estimation (Default:
 		 * icpCovFiniteDifferences) */
 		TICPCovarianceMethod ICP_covariance_method{icpCovFiniteDifferences};
@@ -174,6 +186,11 @@ class CICP : public mrpt::slam::CMetricMapsAlignmentAlgorithm
 		 * queries,
 		 *  the most expensive step in ICP */
 		uint32_t corresponding_points_decimation{5};
+		/** Number of threads for the KD-tree queries of the correspondence
+		 * search (see mrpt::maps::TMatchingParams::numThreads). The result
+		 * is identical to the single-threaded search.
+		 * (Default=1: single thread, 0: all cores) */
+		unsigned int matching_num_threads{1};
 	};
 
 	/** The options employed by the ICP align. */
@@ -261,12 +278,19 @@ class CICP : public mrpt::slam::CMetricMapsAlignmentAlgorithm
 		const mrpt::maps::CMetricMap* m1, const mrpt::maps::CMetricMap* m2,
 		const mrpt::poses::CPose3DPDFGaussian& initialEstimationPDF,
 		TReturnInfo& outInfo);
+	/** Implements icpPointToPlane and icpGeneralized */
+	mrpt::poses::CPose3DPDF::Ptr ICP3D_Method_GaussNewton(
+		const mrpt::maps::CMetricMap* m1, const mrpt::maps::CMetricMap* m2,
+		const mrpt::poses::CPose3DPDFGaussian& initialEstimationPDF,
+		TReturnInfo& outInfo);
 };
 }
 MRPT_ENUM_TYPE_BEGIN(mrpt::slam::TICPAlgorithm)
 using namespace mrpt::slam;
 MRPT_FILL_ENUM(icpClassic);
 MRPT_FILL_ENUM(icpLevenbergMarquardt);
+MRPT_FILL_ENUM(icpPointToPlane);
+MRPT_FILL_ENUM(icpGeneralized);
 MRPT_ENUM_TYPE_END()
 
 MRPT_ENUM_TYPE_BEGIN(mrpt::slam::TICPCovarianceMethod)
@@ -13,6 +13,7 @@
 #include <mrpt/slam/PF_implementations_data.h>
 #include <mrpt/slam/TMonteCarloLocalizationParams.h>
 #include <mrpt/obs/obs_frwds.h>
+#include <mrpt/core/bits_math.h>
 
 namespace mrpt
 {
@@ -24,6 +25,8 @@ class COccupancyGridMap2D;
 /** \ingroup mrpt_slam_grp */
 namespace slam
 {
+class CBranchAndBoundScanMatcher;
+
 /** Declares a class that represents a Probability Density Function (PDF) over a
  * 2D pose (x,y,phi), using a set of weighted samples.
  *
@@ -79,6 +82,30 @@ class CMonteCarloLocalization2D
 		const double y_min = -1e10f, const double y_max = 1e10f,
 		const double phi_min = -M_PI, const double phi_max = M_PI);
 
+	/** Reset the PDF around the most likely pose of the robot in the whole
+	 * grid map given the observations in a sensory frame, e.g. to relocalize
+	 * the robot after a kidnapping. The pose is found with a branch-and-bound
+	 * scan matcher (see CBranchAndBoundScanMatcher::matchGlobal(), with the
+	 * matcher options), and the particles are then spread around it (see
+	 * resetAroundSetOfPoses()).
+	 * \param theMap The occupancy grid map
+	 * \param sf The observations, which are inserted into a points map with
+	 * one point per grid cell at most.
+	 * \param matcher The scan matcher, with its options.
+	 * \param particlesCount If set to -1 the number of m_particles remains
+	 * unchanged.
+	 * \param spread_xy, spread_phi_rad The width of the box where particles
+	 * are spread around the found pose.
+	 * \return false if no pose with a score of at least
+	 * matcher.options.min_score was found; the PDF is not modified then.
+	 */
+	bool resetFromGlobalScanMatch(
+		const mrpt::maps::COccupancyGridMap2D& theMap,
+		const mrpt::obs::CSensoryFrame& sf,
+		const CBranchAndBoundScanMatcher& matcher,
+		const int particlesCount = -1, const double spread_xy = 0.2,
+		const double spread_phi_rad = mrpt::DEG2RAD(5.0));
+
 	/** Update the m_particles, predicting the posterior of robot pose and map
 	 * after a movement command.
 	 *  This method has additional configuration parameters in "options".
@@ -238,28 +238,79 @@ void PF_implementation<PARTICLE_TYPE, MYSELF, STORAGE>::
 			// -------------------------------------------------------------
 			// FIXED SAMPLE SIZE
 			// -------------------------------------------------------------
-			mrpt::poses::CPose3D incrPose;
-			for (size_t i = 0; i < M; i++)
+			if (PF_options.numThreads != 1)
 			{
-				// Generate gaussian-distributed 2D-pose increments according to
-				// mean-cov:
-				m_movementDrawer.drawSample(incrPose);
-				bool pose_is_valid;
-				const mrpt::poses::CPose3D finalPose =
-					mrpt::poses::CPose3D(getLastPose(i, pose_is_valid)) +
-					incrPose;
-
-				// Update the particle with the new pose: this part is
-				// caller-dependant and must be implemented there:
-				if constexpr(STORAGE == mrpt::bayes::particle_storage_mode::POINTER)
-				{
-					PF_SLAM_implementation_custom_update_particle_with_new_pose(
-						me->m_particles[i].d.get(), finalPose.asTPose());
-				}
-				else
+				// Parallel version: one independent random stream per block of
+				// particles, so the result does not depend on how blocks are
+				// distributed among threads:
+				const size_t BLOCK = PF_SLAM_PARALLEL_BLOCK_SIZE;
+				const size_t nBlocks = (M + BLOCK - 1) / BLOCK;
+				// Re-seeded from the global generator at each step, so
+				// re-seeding the latter reproduces a run:
+				m_blockRandomGenerators.resize(nBlocks);
+				for (auto& rng : m_blockRandomGenerators)
+					rng.randomize(
+						mrpt::random::getRandomGenerator().drawUniform32bit());
+				mrpt::system::parallel_for(
+					nBlocks, PF_options.numThreads,
+					[&](const size_t first, const size_t last) {
+						mrpt::poses::CPose3D incrPose;
+						for (size_t b = first; b < last; b++)
+						{
+							auto& rng = m_blockRandomGenerators[b];
+							const size_t i_end = std::min(M, (b + 1) * BLOCK);
+							for (size_t i = b * BLOCK; i < i_end; i++)
+							{
+								m_movementDrawer.drawSample(incrPose, rng);
+								bool pose_is_valid;
+								const mrpt::poses::CPose3D finalPose =
+									mrpt::poses::CPose3D(
+										getLastPose(i, pose_is_valid)) +
+									incrPose;
+								if constexpr(
+									STORAGE ==
+									mrpt::bayes::particle_storage_mode::POINTER)
+								{
+									PF_SLAM_implementation_custom_update_particle_with_new_pose(
+										me->m_particles[i].d.get(),
+										finalPose.asTPose());
+								}
+								else
+								{
+									PF_SLAM_implementation_custom_update_particle_with_new_pose(
+										&me->m_particles[i].d,
+										finalPose.asTPose());
+								}
+							}
+						}
+					});
+			}
+			else
+			{
+				mrpt::poses::CPose3D incrPose;
+				for (size_t i = 0; i < M; i++)
 				{
-					PF_SLAM_implementation_custom_update_particle_with_new_pose(
-						&me->m_particles[i].d, finalPose.asTPose());
+					// Generate gaussian-distributed 2D-pose increments
+					// according to mean-cov:
+					m_movementDrawer.drawSample(incrPose);
+					bool pose_is_valid;
+					const mrpt::poses::CPose3D finalPose =
+						mrpt::poses::CPose3D(getLastPose(i, pose_is_valid)) +
+						incrPose;
+
+					// Update the particle with the new pose: this part is
+					// caller-dependant and must be implemented there:
+					if constexpr(
+						STORAGE == mrpt::bayes::particle_storage_mode::POINTER)
+					{
+						PF_SLAM_implementation_custom_update_particle_with_new_pose(
+							me->m_particles[i].d.get(), finalPose.asTPose());
+					}
+					else
+					{
+						PF_SLAM_implementation_custom_update_particle_with_new_pose(
+							&me->m_particles[i].d, finalPose.asTPose());
+					}
 				}
 			}
 		}
@@ -359,18 +410,36 @@ void PF_implementation<PARTICLE_TYPE, MYSELF, STORAGE>::
 		//	UPDATE STAGE
 		// ----------------------------------------------------------------------
 		// Compute all the likelihood values & update particles weight:
-		for (size_t i = 0; i < M; i++)
+		auto updateWeights = [&](const size_t first, const size_t last) {
+			for (size_t i = first; i < last; i++)
+			{
+				bool pose_is_valid;
+				const mrpt::math::TPose3D partPose =
+					getLastPose(i, pose_is_valid);  // Take the particle data:
+				mrpt::poses::CPose3D partPose2 =
+					mrpt::poses::CPose3D(partPose);
+				const double obs_log_likelihood =
+					PF_SLAM_computeObservationLikelihoodForParticle(
+						PF_options, i, *sf, partPose2);
+				me->m_particles[i].log_w +=
+					obs_log_likelihood * PF_options.powFactor;
+			}  // for each particle "i"
+		};
+
+		if (PF_options.numThreads == 1 || M < 2)
+			updateWeights(0, M);
+		else
 		{
-			bool pose_is_valid;
-			const mrpt::math::TPose3D partPose =
-				getLastPose(i, pose_is_valid);  // Take the particle data:
-			mrpt::poses::CPose3D partPose2 = mrpt::poses::CPose3D(partPose);
-			const double obs_log_likelihood =
-				PF_SLAM_computeObservationLikelihoodForParticle(
-					PF_options, i, *sf, partPose2);
-			me->m_particles[i].log_w +=
-				obs_log_likelihood * PF_options.powFactor;
-		}  // for each particle "i"
+			// Evaluate the first particle in this thread, so any lazily-built
+			// cached data in the observations (e.g. the point maps of scans)
+			// is ready before the other threads start reading it:
+			updateWeights(0, 1);
+			mrpt::system::parallel_for(
+				M - 1, PF_options.numThreads,
+				[&](const size_t first, const size_t last) {
+					updateWeights(first + 1, last + 1);
+				});
+		}
 
 		// Normalization of weights is done outside of this method
 		// automatically.
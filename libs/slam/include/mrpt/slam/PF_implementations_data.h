@@ -16,8 +16,11 @@
 #include <mrpt/poses/CPose3D.h>
 #include <mrpt/poses/CPose3DPDFGaussian.h>
 #include <mrpt/poses/CPoseRandomSampler.h>
+#include <mrpt/random/RandomGenerators.h>
 #include <mrpt/slam/TKLDParams.h>
 #include <mrpt/system/COutputLogger.h>
+#include <mrpt/system/thread_pool.h>
+#include <memory>
 
 namespace mrpt::slam
 {
@@ -68,6 +71,14 @@ class PF_implementation : public mrpt::system::COutputLogger
 		m_pfAuxiliaryPFOptimal_maxLikDrawnMovement;
 	std::vector<bool> m_pfAuxiliaryPFOptimal_maxLikMovementDrawHasBeenUsed;
 
+	/** Number of consecutive particles that share a random generator in the
+	 * parallel prediction stage. */
+	static constexpr std::size_t PF_SLAM_PARALLEL_BLOCK_SIZE = 64;
+	/** Random generators for the parallel prediction stage, one per block of
+	 * PF_SLAM_PARALLEL_BLOCK_SIZE particles, re-seeded from the global
+	 * generator at each step. */
+	std::vector<mrpt::random::CRandomGenerator> m_blockRandomGenerators;
+
 	/**  Compute w[i]*p(z_t | mu_t^i), with mu_t^i being
 	  *    the mean of the new robot pose
 	  *
@@ -0,0 +1,269 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "slam-precomp.h"  // Precompiled headers
+
+#include <mrpt/slam/CBranchAndBoundScanMatcher.h>
+#include <mrpt/config/CConfigFileBase.h>
+#include <mrpt/math/wrap2pi.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace mrpt;
+using namespace mrpt::slam;
+using namespace mrpt::maps;
+using namespace mrpt::math;
+using namespace std;
+
+/*---------------------------------------------------------------
+						TOptions
+  ---------------------------------------------------------------*/
+void CBranchAndBoundScanMatcher::TOptions::loadFromConfigFile(
+	const mrpt::config::CConfigFileBase& iniFile, const std::string& section)
+{
+	MRPT_LOAD_CONFIG_VAR(window_linear, double, iniFile, section);
+	MRPT_LOAD_CONFIG_VAR_DEGREES(window_angular, iniFile, section);
+	MRPT_LOAD_CONFIG_VAR_DEGREES(angular_step, iniFile, section);
+	MRPT_LOAD_CONFIG_VAR(pyramid_levels, int, iniFile, section);
+	MRPT_LOAD_CONFIG_VAR(min_score, double, iniFile, section);
+}
+
+void CBranchAndBoundScanMatcher::TOptions::dumpToTextStream(
+	std::ostream& out) const
+{
+	out << mrpt::format(
+		"\n----------- [CBranchAndBoundScanMatcher::TOptions] ------------ "
+		"\n\n");
+
+	LOADABLEOPTS_DUMP_VAR(window_linear, double)
+	LOADABLEOPTS_DUMP_VAR_DEG(window_angular)
+	LOADABLEOPTS_DUMP_VAR_DEG(angular_step)
+	LOADABLEOPTS_DUMP_VAR(pyramid_levels, int)
+	LOADABLEOPTS_DUMP_VAR(min_score, double)
+
+	out << mrpt::format("\n");
+}
+
+namespace
+{
+/** A block of 2^h x 2^h translations [dx,dx+2^h)x[dy,dy+2^h) (in cells) for
+ * one orientation, with an upper bound of their scores. */
+struct TCandidate
+{
+	int dx, dy;
+	unsigned int angle;
+	int64_t score;
+};
+
+struct TSearchContext
+{
+	/** For each orientation, the cells (x,y) of all the points for the
+	 * translation of the initial guess, as consecutive pairs */
+	std::vector<std::vector<int>> scans;
+	std::vector<const uint8_t*> levels;
+	int size_x, size_y;
+	/** Limits of the translation window, in cells */
+	int wx, wy;
+	size_t nScoresComputed{0};
+
+	/** Upper bound of the score of the block of translations starting at the
+	 * candidate, from the level h of the max-pooled pyramid. */
+	int64_t score(const TCandidate& c, const unsigned int h)
+	{
+		nScoresComputed++;
+		// Windows starting in (lo,0) are partially inside of the grid:
+		const int lo = -(1 << h);
+		const uint8_t* L = levels[h];
+		const std::vector<int>& sc = scans[c.angle];
+		int64_t sum = 0;
+		for (size_t i = 0; i < sc.size(); i += 2)
+		{
+			int x = sc[i] + c.dx, y = sc[i + 1] + c.dy;
+			if (x >= size_x || y >= size_y || x <= lo || y <= lo) continue;
+			// The window of the cell 0 includes that part of the grid:
+			if (x < 0) x = 0;
+			if (y < 0) y = 0;
+			sum += L[x + y * size_x];
+		}
+		return sum;
+	}
+
+	/** Depth-first branch-and-bound over the candidates at level h, updating
+	 * \a best if a better solution is found */
+	void search(std::vector<TCandidate>& cands, unsigned int h, TCandidate& best)
+	{
+		std::sort(
+			cands.begin(), cands.end(),
+			[](const TCandidate& a, const TCandidate& b) {
+				return a.score > b.score;
+			});
+		for (const TCandidate& c : cands)
+		{
+			// Sorted: none of the rest can be better.
+			if (c.score <= best.score) break;
+			if (h == 0)
+			{
+				best = c;
+				break;
+			}
+			// Branch into the 4 sub-blocks:
+			const int half = 1 << (h - 1);
+			std::vector<TCandidate> children;
+			children.reserve(4);
+			for (int ox = 0; ox <= half; ox += half)
+				for (int oy = 0; oy <= half; oy += half)
+				{
+					TCandidate ch{c.dx + ox, c.dy + oy, c.angle, 0};
+					if (ch.dx > wx || ch.dy > wy) continue;
+					ch.score = score(ch, h - 1);
+					children.push_back(ch);
+				}
+			search(children, h - 1, best);
+		}
+	}
+};
+}  // namespace
+
+/*---------------------------------------------------------------
+						match
+  ---------------------------------------------------------------*/
+bool CBranchAndBoundScanMatcher::match(
+	const COccupancyGridMap2D& grid, const CPointsMap& points,
+	const TPose2D& initialGuess, TResult& result) const
+{
+	return match(
+		grid, points, initialGuess, options.window_linear,
+		options.window_linear, options.window_angular, result);
+}
+
+bool CBranchAndBoundScanMatcher::matchGlobal(
+	const COccupancyGridMap2D& grid, const CPointsMap& points,
+	TResult& result) const
+{
+	const double res = grid.getResolution();
+	const TPose2D center(
+		0.5 * (grid.getXMin() + grid.getXMax()),
+		0.5 * (grid.getYMin() + grid.getYMax()), 0);
+	return match(
+		grid, points, center, 0.5 * (grid.getXMax() - grid.getXMin()) + res,
+		0.5 * (grid.getYMax() - grid.getYMin()) + res, M_PI, result);
+}
+
+bool CBranchAndBoundScanMatcher::match(
+	const COccupancyGridMap2D& grid, const CPointsMap& points,
+	const TPose2D& initialGuess, double window_x, double window_y,
+	double window_phi, TResult& result) const
+{
+	MRPT_START
+
+	ASSERT_(options.pyramid_levels >= 1 && options.pyramid_levels < 16);
+	result = TResult();
+
+	const size_t N = points.size();
+	if (!N || !grid.getSizeX() || !grid.getSizeY()) return false;
+
+	const double res = grid.getResolution();
+	const auto& xs = points.getPointsBufferRef_x();
+	const auto& ys = points.getPointsBufferRef_y();
+
+	// Orientations to evaluate:
+	double dPhi = options.angular_step;
+	if (dPhi <= 0)
+	{
+		// The step which moves the farthest point by one cell:
+		float maxR2 = 0;
+		for (size_t i = 0; i < N; i++)
+			keep_max(maxR2, square(xs[i]) + square(ys[i]));
+		const double maxR = std::max<double>(std::sqrt(maxR2), res);
+		dPhi = std::acos(1.0 - square(res) / (2 * square(maxR)));
+	}
+	std::vector<double> angles;
+	if (window_phi >= M_PI)
+	{
+		const int n = static_cast<int>(std::ceil(2 * M_PI / dPhi));
+		dPhi = 2 * M_PI / n;
+		for (int k = 0; k < n; k++)
+			angles.push_back(initialGuess.phi - M_PI + k * dPhi);
+	}
+	else
+	{
+		// (Do not add a step just for round-off errors)
+		const int n = static_cast<int>(std::ceil(window_phi / dPhi - 1e-6));
+		for (int k = -n; k <= n; k++)
+			angles.push_back(initialGuess.phi + k * dPhi);
+	}
+
+	TSearchContext ctx;
+	ctx.size_x = static_cast<int>(grid.getSizeX());
+	ctx.size_y = static_cast<int>(grid.getSizeY());
+	ctx.wx = std::max(0, static_cast<int>(std::ceil(window_x / res)));
+	ctx.wy = std::max(0, static_cast<int>(std::ceil(window_y / res)));
+
+	// Discretize the rotated points, translated to the initial guess:
+	const double ox = (initialGuess.x - grid.getXMin()) / res;
+	const double oy = (initialGuess.y - grid.getYMin()) / res;
+	ctx.scans.resize(angles.size());
+	for (size_t a = 0; a < angles.size(); a++)
+	{
+		const double c = std::cos(angles[a]) / res;
+		const double s = std::sin(angles[a]) / res;
+		std::vector<int>& sc = ctx.scans[a];
+		sc.resize(2 * N);
+		for (size_t i = 0; i < N; i++)
+		{
+			sc[2 * i] = static_cast<int>(std::floor(ox + c * xs[i] - s * ys[i]));
+			sc[2 * i + 1] =
+				static_cast<int>(std::floor(oy + s * xs[i] + c * ys[i]));
+		}
+	}
+
+	// Resolution pyramid (coarsest level first, so it is built at once):
+	const unsigned int H = options.pyramid_levels;
+	ctx.levels.resize(H);
+	for (unsigned int h = H; h-- > 0;)
+		ctx.levels[h] = &grid.getResolutionPyramidLevel(h)[0];
+
+	// Candidates at the coarsest level:
+	const int step = 1 << (H - 1);
+	std::vector<TCandidate> cands;
+	for (unsigned int a = 0; a < angles.size(); a++)
+		for (int dx = -ctx.wx; dx <= ctx.wx; dx += step)
+			for (int dy = -ctx.wy; dy <= ctx.wy; dy += step)
+			{
+				TCandidate c{dx, dy, a, 0};
+				c.score = ctx.score(c, H - 1);
+				cands.push_back(c);
+			}
+
+	const int64_t minScore =
+		static_cast<int64_t>(std::ceil(options.min_score * 255 * N));
+	TCandidate best{0, 0, 0, minScore - 1};
+	ctx.search(cands, H - 1, best);
+
+	result.nAngles = angles.size();
+	result.angularStep = dPhi;
+	result.nScoresComputed = ctx.nScoresComputed;
+
+	MRPT_LOG_DEBUG_FMT(
+		"[match] %u angles x %ux%u cells window, %u scores computed, best "
+		"score=%.03f",
+		static_cast<unsigned>(angles.size()), 2 * ctx.wx + 1, 2 * ctx.wy + 1,
+		static_cast<unsigned>(ctx.nScoresComputed),
+		best.score / (255.0 * N));
+
+	if (best.score < minScore) return false;
+
+	result.pose = TPose2D(
+		initialGuess.x + best.dx * res, initialGuess.y + best.dy * res,
+		mrpt::math::wrapToPi(angles[best.angle]));
+	result.score = best.score / (255.0 * N);
+	return true;
+
+	MRPT_END
+}
@@ -0,0 +1,171 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/slam/CBranchAndBoundScanMatcher.h>
+#include <mrpt/slam/CMonteCarloLocalization2D.h>
+#include <mrpt/maps/COccupancyGridMap2D.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/obs/CObservation2DRangeScan.h>
+#include <mrpt/obs/CSensoryFrame.h>
+#include <mrpt/math/wrap2pi.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::slam;
+using namespace mrpt::maps;
+using namespace mrpt::math;
+using namespace mrpt::obs;
+using namespace mrpt::poses;
+using namespace std;
+
+namespace
+{
+// A room with a few obstacles, without symmetries:
+void buildRoomMap(COccupancyGridMap2D& grid)
+{
+	grid.setSize(-10.0f, 10.0f, -8.0f, 8.0f, 0.05f, 1.0f);
+	auto box = [&](double x0, double x1, double y0, double y1) {
+		for (double x = x0; x <= x1; x += 0.025)
+		{
+			grid.setPos(x, y0, 0.0f);
+			grid.setPos(x, y1, 0.0f);
+		}
+		for (double y = y0; y <= y1; y += 0.025)
+		{
+			grid.setPos(x0, y, 0.0f);
+			grid.setPos(x1, y, 0.0f);
+		}
+	};
+	box(-8.0, 8.0, -6.0, 6.0);
+	box(2.0, 3.0, 1.0, 4.0);
+	box(-5.0, -4.0, -3.0, -1.0);
+	box(-2.0, 0.5, 3.0, 3.5);
+}
+
+void simulateScan(
+	const COccupancyGridMap2D& grid, const CPose2D& pose,
+	CObservation2DRangeScan& scan)
+{
+	scan.aperture = 2 * M_PIf;
+	scan.maxRange = 20.0f;
+	scan.rightToLeft = true;
+	grid.laserScanSimulator(scan, pose, 0.5f, 361);
+}
+
+void scanToPoints(const CObservation2DRangeScan& scan, CSimplePointsMap& pts)
+{
+	pts.insertionOptions.minDistBetweenLaserPoints = 0.05f;
+	pts.insertionOptions.isPlanarMap = true;
+	pts.insertObservation(&scan);
+}
+}  // namespace
+
+TEST(CBranchAndBoundScanMatcher, sameResultThanExhaustiveSearch)
+{
+	COccupancyGridMap2D grid;
+	buildRoomMap(grid);
+
+	const CPose2D truePose(1.3, -2.1, DEG2RAD(40.0));
+	CObservation2DRangeScan scan;
+	simulateScan(grid, truePose, scan);
+	CSimplePointsMap pts;
+	scanToPoints(scan, pts);
+
+	CBranchAndBoundScanMatcher matcher;
+	matcher.options.window_linear = 0.3;
+	matcher.options.window_angular = DEG2RAD(5.0);
+	matcher.options.angular_step = DEG2RAD(1.0);
+	matcher.options.pyramid_levels = 4;
+	matcher.options.min_score = 0;
+
+	const TPose2D guess(1.22, -2.02, DEG2RAD(37.0));
+	CBranchAndBoundScanMatcher::TResult res;
+	ASSERT_TRUE(matcher.match(grid, pts, guess, res));
+	EXPECT_EQ(res.nAngles, 11u);
+
+	// Exhaustive search, with the same discretization of the poses:
+	const std::vector<uint8_t>& occ = grid.getResolutionPyramidLevel(0);
+	const double r = grid.getResolution();
+	const double ox = (guess.x - grid.getXMin()) / r;
+	const double oy = (guess.y - grid.getYMin()) / r;
+	const int W = 6;
+	double bestScore = -1;
+	for (int a = -5; a <= 5; a++)
+		for (int dx = -W; dx <= W; dx++)
+			for (int dy = -W; dy <= W; dy++)
+			{
+				const double phi = guess.phi + a * DEG2RAD(1.0);
+				const double c = cos(phi) / r, s = sin(phi) / r;
+				double score = 0;
+				for (size_t i = 0; i < pts.size(); i++)
+				{
+					float lx, ly;
+					pts.getPoint(i, lx, ly);
+					const int cx =
+						static_cast<int>(std::floor(ox + c * lx - s * ly)) + dx;
+					const int cy =
+						static_cast<int>(std::floor(oy + s * lx + c * ly)) + dy;
+					if (cx < 0 || cy < 0 || cx >= int(grid.getSizeX()) ||
+						cy >= int(grid.getSizeY()))
+						continue;
+					score += occ[cx + cy * grid.getSizeX()];
+				}
+				bestScore = std::max(bestScore, score / (255.0 * pts.size()));
+			}
+	EXPECT_NEAR(res.score, bestScore, 1e-9);
+
+	EXPECT_NEAR(res.pose.x, truePose.x(), 0.1);
+	EXPECT_NEAR(res.pose.y, truePose.y(), 0.1);
+	EXPECT_NEAR(wrapToPi(res.pose.phi - truePose.phi()), 0, DEG2RAD(1.5));
+}
+
+TEST(CBranchAndBoundScanMatcher, globalRelocalization)
+{
+	COccupancyGridMap2D grid;
+	buildRoomMap(grid);
+
+	for (const CPose2D& truePose :
+		 {CPose2D(1.3, -2.1, DEG2RAD(40.0)), CPose2D(-6.0, 4.0, DEG2RAD(-135.0)),
+		  CPose2D(5.0, 2.5, DEG2RAD(95.0))})
+	{
+		CObservation2DRangeScan::Ptr scan =
+			mrpt::make_aligned_shared<CObservation2DRangeScan>();
+		simulateScan(grid, truePose, *scan);
+		CSimplePointsMap pts;
+		scanToPoints(*scan, pts);
+
+		CBranchAndBoundScanMatcher matcher;
+		CBranchAndBoundScanMatcher::TResult res;
+		ASSERT_TRUE(matcher.matchGlobal(grid, pts, res));
+		EXPECT_GT(res.score, 0.7);
+		EXPECT_NEAR(res.pose.x, truePose.x(), 0.1);
+		EXPECT_NEAR(res.pose.y, truePose.y(), 0.1);
+		EXPECT_NEAR(wrapToPi(res.pose.phi - truePose.phi()), 0, DEG2RAD(1.0));
+
+		// Kidnapped robot: reset MCL to the found pose
+		CSensoryFrame sf;
+		sf.insert(scan);
+		CMonteCarloLocalization2D pdf(100);
+		pdf.resetUniform(-10, 10, -8, 8);
+		ASSERT_TRUE(pdf.resetFromGlobalScanMatch(grid, sf, matcher, 500));
+		EXPECT_EQ(pdf.size(), 500u);
+		const CPose2D mean = pdf.getMeanVal();
+		EXPECT_NEAR(mean.x(), truePose.x(), 0.1);
+		EXPECT_NEAR(mean.y(), truePose.y(), 0.1);
+	}
+
+	// Points which do not match the map at all:
+	CSimplePointsMap pts;
+	for (int i = 0; i < 100; i++) pts.insertPoint(0.01f * i, 0.5f);
+	COccupancyGridMap2D emptyGrid(-5.0f, 5.0f, -5.0f, 5.0f, 0.05f);
+	emptyGrid.fill(1.0f);
+	CBranchAndBoundScanMatcher matcher;
+	CBranchAndBoundScanMatcher::TResult res;
+	EXPECT_FALSE(matcher.matchGlobal(emptyGrid, pts, res));
+}
@@ -22,6 +22,7 @@
 
 #include <mrpt/maps/COccupancyGridMap2D.h>
 #include <mrpt/maps/CMultiMetricMap.h>
+#include <mrpt/maps/CSimplePointsMap.h>
 #include <mrpt/slam/CICP.h>
 #include <mrpt/maps/CLandmarksMap.h>
 #include <mrpt/tfest/se2.h>
@@ -55,6 +56,10 @@ CPosePDF::Ptr CGridMapAligner::AlignPDF(
 			return AlignPDF_robustMatch(
 				mm1, mm2, initialEstimationPDF, runningTime, info);
 
+		case CGridMapAligner::amBranchAndBound:
+			return AlignPDF_branchAndBound(
+				mm1, mm2, initialEstimationPDF, runningTime, info);
+
 		default:
 			THROW_EXCEPTION("Wrong value found in 'options.methodSelection'!!");
 	}
@@ -1160,6 +1165,82 @@ CPosePDF::Ptr CGridMapAligner::AlignPDF_correlation(
 	MRPT_END
 }
 
+/*---------------------------------------------------------------
+					AlignPDF_branchAndBound
+---------------------------------------------------------------*/
+CPosePDF::Ptr CGridMapAligner::AlignPDF_branchAndBound(
+	const mrpt::maps::CMetricMap* mm1, const mrpt::maps::CMetricMap* mm2,
+	const CPosePDFGaussian& initialEstimationPDF, float* runningTime,
+	void* info)
+{
+	MRPT_START
+
+	CTicTac tictac;
+	tictac.Tic();
+
+	const COccupancyGridMap2D* m1 = nullptr;
+	const COccupancyGridMap2D* m2 = nullptr;
+	if (IS_CLASS(mm1, CMultiMetricMap) && IS_CLASS(mm2, CMultiMetricMap))
+	{
+		const auto* multimap1 = static_cast<const CMultiMetricMap*>(mm1);
+		const auto* multimap2 = static_cast<const CMultiMetricMap*>(mm2);
+		ASSERT_(multimap1->m_gridMaps.size() && multimap1->m_gridMaps[0]);
+		ASSERT_(multimap2->m_gridMaps.size() && multimap2->m_gridMaps[0]);
+		m1 = multimap1->m_gridMaps[0].get();
+		m2 = multimap2->m_gridMaps[0].get();
+	}
+	else if (
+		IS_CLASS(mm1, COccupancyGridMap2D) &&
+		IS_CLASS(mm2, COccupancyGridMap2D))
+	{
+		m1 = static_cast<const COccupancyGridMap2D*>(mm1);
+		m2 = static_cast<const COccupancyGridMap2D*>(mm2);
+	}
+	else
+		THROW_EXCEPTION(
+			"Metric maps must be of classes COccupancyGridMap2D or "
+			"CMultiMetricMap")
+
+	// The occupied cells of m2, as points in its frame:
+	CSimplePointsMap points;
+	for (unsigned int cy = 0; cy < m2->getSizeY(); cy++)
+		for (unsigned int cx = 0; cx < m2->getSizeX(); cx++)
+			if (m2->getCell(cx, cy) < 0.4f)
+				points.insertPoint(m2->idx2x(cx), m2->idx2y(cy));
+
+	CBranchAndBoundScanMatcher matcher;
+	matcher.options = options.branchAndBound_options;
+	matcher.setMinLoggingLevel(this->getMinLoggingLevel());
+
+	CBranchAndBoundScanMatcher::TResult res;
+	const bool found = matcher.match(
+		*m1, points, initialEstimationPDF.mean.asTPose(), res);
+
+	// The PDF to estimate:
+	CPosePDFGaussian::Ptr PDF =
+		mrpt::make_aligned_shared<CPosePDFGaussian>(initialEstimationPDF);
+	if (found)
+	{
+		// Uncertainty: the discretization of the search
+		PDF->mean = CPose2D(res.pose);
+		PDF->cov.setZero();
+		PDF->cov(0, 0) = PDF->cov(1, 1) = square(m1->getResolution());
+		PDF->cov(2, 2) = square(res.angularStep);
+	}
+
+	if (info)
+	{
+		TReturnInfo* outInfo = static_cast<TReturnInfo*>(info);
+		outInfo->goodness = found ? res.score : 0;
+		outInfo->noRobustEstimation = PDF->mean;
+	}
+	if (runningTime) *runningTime = tictac.Tac();
+
+	return PDF;
+
+	MRPT_END
+}
+
 /*---------------------------------------------------------------
 					TConfigParams
   ---------------------------------------------------------------*/
@@ -1214,6 +1295,7 @@ void CGridMapAligner::TConfigParams::dumpToTextStream(std::ostream& out) const
 	LOADABLEOPTS_DUMP_VAR(feature_descriptor, int)
 
 	feature_detector_options.dumpToTextStream(out);
+	branchAndBound_options.dumpToTextStream(out);
 
 	out << mrpt::format("\n");
 }
@@ -1254,6 +1336,7 @@ void CGridMapAligner::TConfigParams::loadFromConfigFile(
 	feature_descriptor = iniFile.read_enum(
 		section, "feature_descriptor", feature_descriptor, true);
 	feature_detector_options.loadFromConfigFile(iniFile, section);
+	branchAndBound_options.loadFromConfigFile(iniFile, section);
 }
 
 CPose3DPDF::Ptr CGridMapAligner::Align3DPDF(
@@ -53,6 +53,12 @@ CPosePDF::Ptr CICP::AlignPDF(
 		case icpLevenbergMarquardt:
 			resultPDF = ICP_Method_LM(m1, mm2, initialEstimationPDF, outInfo);
 			break;
+		case icpPointToPlane:
+		case icpGeneralized:
+			THROW_EXCEPTION(
+				"icpPointToPlane and icpGeneralized are only implemented for "
+				"ICP-3D");
+			break;
 		default:
 			THROW_EXCEPTION_FMT(
 				"Invalid value for ICP_algorithm: %i",
@@ -83,6 +89,7 @@ void CICP::TConfigParams::loadFromConfigFile(
 		section, "ICP_algorithm", ICP_algorithm);
 	ICP_covariance_method = iniFile.read_enum<TICPCovarianceMethod>(
 		section, "ICP_covariance_method", ICP_covariance_method);
+	MRPT_LOAD_CONFIG_VAR(localGeometry_knn, int, iniFile, section);
 
 	MRPT_LOAD_CONFIG_VAR(thresholdDist, float, iniFile, section);
 	thresholdAng = DEG2RAD(
@@ -118,6 +125,7 @@ void CICP::TConfigParams::loadFromConfigFile(
 
 	MRPT_LOAD_CONFIG_VAR(
 		corresponding_points_decimation, int, iniFile, section);
+	MRPT_LOAD_CONFIG_VAR(matching_num_threads, int, iniFile, section);
 }
 
 void CICP::TConfigParams::saveToConfigFile(
@@ -129,6 +137,10 @@ void CICP::TConfigParams::saveToConfigFile(
 		ICP_covariance_method,
 		"Method to use for covariance estimation (see enum "
 		"TICPCovarianceMethod)");
+	MRPT_SAVE_CONFIG_VAR_COMMENT(
+		localGeometry_knn,
+		"Neighbors for the normals and covariances of icpPointToPlane and "
+		"icpGeneralized");
 	MRPT_SAVE_CONFIG_VAR_COMMENT(
 		onlyUniqueRobust,
 		"Only the closest correspondence for each reference point will be "
@@ -166,6 +178,10 @@ void CICP::TConfigParams::saveToConfigFile(
 	MRPT_SAVE_CONFIG_VAR_COMMENT(skip_cov_calculation, "");
 	MRPT_SAVE_CONFIG_VAR_COMMENT(skip_quality_calculation, "");
 	MRPT_SAVE_CONFIG_VAR_COMMENT(corresponding_points_decimation, "");
+	MRPT_SAVE_CONFIG_VAR_COMMENT(
+		matching_num_threads,
+		"Threads for the correspondence search (1: single thread, 0: all "
+		"cores)");
 }
 
 float CICP::kernel(const float& x2, const float& rho2)
@@ -228,6 +244,7 @@ CPosePDF::Ptr CICP::ICP_Method_Classic(
 	matchParams.onlyUniqueRobust = options.onlyUniqueRobust;
 	matchParams.decimation_other_map_points =
 		options.corresponding_points_decimation;
+	matchParams.numThreads = options.matching_num_threads;
 
 	// Asure maps are not empty!
 	// ------------------------------------------------------
@@ -598,6 +615,7 @@ CPosePDF::Ptr CICP::ICP_Method_LM(
 	matchParams.onlyUniqueRobust = onlyUniqueRobust;
 	matchParams.decimation_other_map_points =
 		options.corresponding_points_decimation;
+	matchParams.numThreads = options.matching_num_threads;
 
 	// The gaussian PDF to estimate:
 	// ------------------------------------------------------
@@ -934,7 +952,13 @@ CPose3DPDF::Ptr CICP::Align3DPDF(
 				ICP3D_Method_Classic(m1, mm2, initialEstimationPDF, outInfo);
 			break;
 		case icpLevenbergMarquardt:
-			THROW_EXCEPTION("Only icpClassic is implemented for ICP-3D");
+			THROW_EXCEPTION(
+				"icpLevenbergMarquardt is not implemented for ICP-3D");
+			break;
+		case icpPointToPlane:
+		case icpGeneralized:
+			resultPDF = ICP3D_Method_GaussNewton(
+				m1, mm2, initialEstimationPDF, outInfo);
 			break;
 		default:
 			THROW_EXCEPTION_FMT(
@@ -1007,6 +1031,7 @@ CPose3DPDF::Ptr CICP::ICP3D_Method_Classic(
 	matchParams.onlyUniqueRobust = options.onlyUniqueRobust;
 	matchParams.decimation_other_map_points =
 		options.corresponding_points_decimation;
+	matchParams.numThreads = options.matching_num_threads;
 
 	// Asure maps are not empty!
 	// ------------------------------------------------------
@@ -1121,3 +1146,146 @@ CPose3DPDF::Ptr CICP::ICP3D_Method_Classic(
 
 	MRPT_END
 }
+
+CPose3DPDF::Ptr CICP::ICP3D_Method_GaussNewton(
+	const mrpt::maps::CMetricMap* mm1, const mrpt::maps::CMetricMap* mm2,
+	const CPose3DPDFGaussian& initialEstimationPDF, TReturnInfo& outInfo)
+{
+	MRPT_START
+
+	// Assure the class of the maps:
+	ASSERT_(mm1->GetRuntimeClass()->derivedFrom(CLASS_ID(CPointsMap)));
+	ASSERT_(mm2->GetRuntimeClass()->derivedFrom(CLASS_ID(CPointsMap)));
+	const CPointsMap* m1 = static_cast<const CPointsMap*>(mm1);
+	const CPointsMap* m2 = static_cast<const CPointsMap*>(mm2);
+
+	ASSERT_(options.ALFA > 0 && options.ALFA < 1);
+
+	const bool generalized = options.ICP_algorithm == icpGeneralized;
+
+	outInfo.nIterations = 0;
+	outInfo.goodness = 1;
+	outInfo.quality = 0;
+
+	CPose3DPDFGaussian::Ptr gaussPdf =
+		mrpt::make_aligned_shared<CPose3DPDFGaussian>();
+	gaussPdf->mean = initialEstimationPDF.mean;
+
+	if (m1->isEmpty() || m2->isEmpty()) return gaussPdf;
+
+	// Normals (and covariances) of the maps: cached in the maps, so they are
+	// only computed the first time a map is used.
+	const CPointsMap::TLocalGeometry& geom1 =
+		m1->getLocalGeometry(options.localGeometry_knn);
+	const CPointsMap::TLocalGeometry* geom2 =
+		generalized ? &m2->getLocalGeometry(options.localGeometry_knn)
+					: nullptr;
+
+	TMatchingParams matchParams;
+	TMatchingExtraResults matchExtraResults;
+	matchParams.maxDistForCorrespondence = options.thresholdDist;
+	matchParams.maxAngularDistForCorrespondence = options.thresholdAng;
+	matchParams.onlyKeepTheClosest = true;
+	matchParams.onlyUniqueRobust = options.onlyUniqueRobust;
+	matchParams.decimation_other_map_points =
+		options.corresponding_points_decimation;
+	matchParams.numThreads = options.matching_num_threads;
+	matchParams.offset_other_map_points = 0;
+
+	mrpt::tfest::TMatchingPairList correspondences;
+	CPose3D lastMeanPose = gaussPdf->mean;
+	bool keepApproaching;
+	do
+	{
+		CPose3D& pose = gaussPdf->mean;
+		matchParams.angularDistPivotPoint =
+			TPoint3D(pose.x(), pose.y(), pose.z());
+
+		m1->determineMatching3D(
+			m2, pose, correspondences, matchParams, matchExtraResults);
+
+		// One Gauss-Newton step, for an increment dx=[v w] composed to the
+		// left of the current pose: the paired point "q" then moves to
+		// q + v + w x q, so the Jacobian of q is [I -[q]_x].
+		Eigen::Matrix<double, 6, 6> H = Eigen::Matrix<double, 6, 6>::Zero();
+		Eigen::Matrix<double, 6, 1> g = Eigen::Matrix<double, 6, 1>::Zero();
+		const Eigen::Matrix3d R = pose.getRotationMatrix();
+		Eigen::Matrix<double, 3, 6> J;
+		J.leftCols<3>().setIdentity();
+		for (const auto& c : correspondences)
+		{
+			double qx, qy, qz;
+			pose.composePoint(c.other_x, c.other_y, c.other_z, qx, qy, qz);
+			const Eigen::Vector3d err(
+				qx - c.this_x, qy - c.this_y, qz - c.this_z);
+			// -[q]_x:
+			J.rightCols<3>() << 0, qz, -qy, -qz, 0, qx, qy, -qx, 0;
+
+			if (!generalized)
+			{
+				// Point-to-plane residual: n^t * (q - p)
+				const TPoint3Df& nf = geom1.normals[c.this_idx];
+				const Eigen::Vector3d n(nf.x, nf.y, nf.z);
+				const Eigen::Matrix<double, 1, 6> Jn = n.transpose() * J;
+				H.noalias() += Jn.transpose() * Jn;
+				g.noalias() += Jn.transpose() * n.dot(err);
+			}
+			else
+			{
+				// Mahalanobis distance with the covariances of both points:
+				const Eigen::Matrix3d C =
+					geom1.covariances[c.this_idx].cast<double>() +
+					R * geom2->covariances[c.other_idx].cast<double>() *
+						R.transpose();
+				const Eigen::Matrix<double, 6, 3> JtW =
+					J.transpose() * C.inverse();
+				H.noalias() += JtW * J;
+				g.noalias() += JtW * err;
+			}
+		}
+
+		const Eigen::Matrix<double, 6, 1> dx = -H.ldlt().solve(g);
+		if (correspondences.empty() || !dx.allFinite())
+		{
+			// Nothing we can do !!
+			keepApproaching = false;
+		}
+		else
+		{
+			CArrayDouble<6> mu;
+			for (int k = 0; k < 6; k++) mu[k] = dx[k];
+			pose = CPose3D::exp(mu, true /*pseudo-exponential*/) + pose;
+
+			// If the pose has not changed, decrease the thresholds:
+			keepApproaching = true;
+			const CPose3D delta = pose - lastMeanPose;
+			if (std::abs(delta.x()) <= options.minAbsStep_trans &&
+				std::abs(delta.y()) <= options.minAbsStep_trans &&
+				std::abs(delta.z()) <= options.minAbsStep_trans &&
+				std::abs(delta.yaw()) <= options.minAbsStep_rot &&
+				std::abs(delta.pitch()) <= options.minAbsStep_rot &&
+				std::abs(delta.roll()) <= options.minAbsStep_rot)
+			{
+				matchParams.maxDistForCorrespondence *= options.ALFA;
+				matchParams.maxAngularDistForCorrespondence *= options.ALFA;
+				if (matchParams.maxDistForCorrespondence <
+					options.smallestThresholdDist)
+					keepApproaching = false;
+
+				if (++matchParams.offset_other_map_points >=
+					options.corresponding_points_decimation)
+					matchParams.offset_other_map_points = 0;
+			}
+			lastMeanPose = pose;
+		}
+
+		// Next iteration:
+		outInfo.nIterations++;
+	} while (keepApproaching && outInfo.nIterations < options.maxIterations);
+
+	outInfo.goodness = matchExtraResults.correspondencesRatio;
+
+	return gaussPdf;
+
+	MRPT_END
+}
@@ -19,6 +19,7 @@
 #include <mrpt/opengl/CSphere.h>
 #include <mrpt/opengl/CDisk.h>
 #include <mrpt/opengl/stock_objects.h>
+#include <mrpt/random/RandomGenerators.h>
 #include <gtest/gtest.h>
 
 using namespace mrpt;
@@ -380,3 +381,118 @@ TEST_F(ICPTests, RayTracingICP3D)
 		<< "ICP output: mean= " << mean << endl
 		<< "Real displacement: " << SCAN2_POSE_ERROR << endl;
 }
+
+// Random points on the walls, floor and ceiling of a 12x8x3 m room with a
+// 1x1x1 m box in a corner:
+static void samplePointsInRoom(CSimplePointsMap& pts, const size_t N)
+{
+	auto& rng = mrpt::random::getRandomGenerator();
+	for (size_t i = 0; i < N; i++)
+	{
+		float x = rng.drawUniform(-6.0f, 6.0f);
+		float y = rng.drawUniform(-4.0f, 4.0f);
+		float z = rng.drawUniform(0.0f, 3.0f);
+		switch (i % 7)
+		{
+			case 0:
+				x = (i & 8) ? 6.0f : -6.0f;
+				break;
+			case 1:
+				y = (i & 8) ? 4.0f : -4.0f;
+				break;
+			case 2:
+				z = 0;
+				break;
+			case 3:
+				z = 3.0f;
+				break;
+			case 4:
+				x = 4.0f;
+				y = rng.drawUniform(2.0f, 3.0f);
+				z = rng.drawUniform(0.0f, 1.0f);
+				break;
+			case 5:
+				x = rng.drawUniform(4.0f, 5.0f);
+				y = 2.0f;
+				z = rng.drawUniform(0.0f, 1.0f);
+				break;
+			default:
+				x = rng.drawUniform(4.0f, 5.0f);
+				y = rng.drawUniform(2.0f, 3.0f);
+				z = 1.0f;
+				break;
+		};
+		pts.insertPoint(x, y, z);
+	}
+}
+
+TEST_F(ICPTests, PointToPlaneAndGeneralizedICP3D)
+{
+	mrpt::random::getRandomGenerator().randomize(4321);
+
+	// Two independent samplings of the room, so there are no exact
+	// point-to-point pairings:
+	CSimplePointsMap ref, scanWorld, scan;
+	samplePointsInRoom(ref, 20000);
+	samplePointsInRoom(scanWorld, 10000);
+	const CPose3D truePose(
+		0.25, -0.15, 0.08, DEG2RAD(4.0), DEG2RAD(-2.0), DEG2RAD(1.5));
+	scan.changeCoordinatesReference(scanWorld, CPose3D() - truePose);
+
+	CICP icp;
+	icp.options.thresholdDist = 0.75;
+	icp.options.thresholdAng = 0;
+	icp.options.corresponding_points_decimation = 2;
+
+	uint64_t geomUpdates = 0;
+	for (const TICPAlgorithm method : {icpPointToPlane, icpGeneralized})
+	{
+		icp.options.ICP_algorithm = method;
+		CICP::TReturnInfo info;
+		const CPose3D mean =
+			icp.Align3D(&ref, &scan, CPose3D(), nullptr, &info)
+				->getMeanVal();
+
+		EXPECT_NEAR(mean.x(), truePose.x(), 0.01) << "method=" << method;
+		EXPECT_NEAR(mean.y(), truePose.y(), 0.01) << "method=" << method;
+		EXPECT_NEAR(mean.z(), truePose.z(), 0.01) << "method=" << method;
+		EXPECT_NEAR(mean.yaw(), truePose.yaw(), DEG2RAD(0.3));
+		EXPECT_NEAR(mean.pitch(), truePose.pitch(), DEG2RAD(0.3));
+		EXPECT_NEAR(mean.roll(), truePose.roll(), DEG2RAD(0.3));
+		EXPECT_GT(info.goodness, 0.9f);
+
+		// The normals and covariances of the reference map are estimated
+		// by the first alignment only, then reused:
+		const uint64_t n =
+			ref.getLocalGeometry(icp.options.localGeometry_knn).updateCount;
+		if (method == icpPointToPlane)
+			EXPECT_GT(n, 0u);
+		else
+			EXPECT_EQ(n, geomUpdates);
+		geomUpdates = n;
+	}
+
+	// The cached geometry equals one estimated from scratch:
+	CSimplePointsMap fresh;
+	fresh.insertAnotherMap(&ref, CPose3D());
+	const auto& geom = ref.getLocalGeometry(icp.options.localGeometry_knn);
+	const auto& geom2 = fresh.getLocalGeometry(icp.options.localGeometry_knn);
+	EXPECT_EQ(geom.updateCount, geomUpdates);
+	EXPECT_EQ(geom2.updateCount, 1u);
+	ASSERT_EQ(geom.normals.size(), ref.size());
+	ASSERT_EQ(geom2.normals.size(), ref.size());
+	for (size_t i = 0; i < ref.size(); i++)
+	{
+		const auto &a = geom.normals[i], &b = geom2.normals[i];
+		EXPECT_NEAR(std::abs(a.x * b.x + a.y * b.y + a.z * b.z), 1.0f, 1e-4f);
+		EXPECT_NEAR(
+			(geom.covariances[i] - geom2.covariances[i]).array().abs().maxCoeff(),
+			0.0f, 1e-4f);
+	}
+
+	// Modifying the map invalidates the cache:
+	ref.insertPoint(0, 0, 0);
+	EXPECT_EQ(
+		ref.getLocalGeometry(icp.options.localGeometry_knn).updateCount,
+		geomUpdates + 1);
+}
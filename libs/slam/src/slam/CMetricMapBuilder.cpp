@@ -14,7 +14,6 @@
 #include <mrpt/poses/CPosePDFGaussian.h>
 #include <mrpt/io/CFileInputStream.h>
 #include <mrpt/io/CFileOutputStream.h>
-#include <mrpt/io/CFileGZInputStream.h>
 #include <mrpt/io/CFileGZOutputStream.h>
 #include <mrpt/serialization/CArchive.h>
 
@@ -64,10 +63,10 @@ void CMetricMapBuilder::loadCurrentMapFromFile(const std::string& fileName)
 			"[CMetricMapBuilder::loadCurrentMapFromFile] Loading current map "
 			"from '"
 			<< fileName << "' ..." << std::endl);
-		CFileGZInputStream f(fileName);
-
 		// Load from file:
-		archiveFrom(f) >> map;
+		if (!map.loadFromFile(fileName))
+			THROW_EXCEPTION_FMT(
+				"Error loading the map from '%s'", fileName.c_str());
 	}
 	else
 	{  // Is a new file, start with an empty map:
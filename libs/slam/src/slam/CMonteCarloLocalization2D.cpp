@@ -10,9 +10,11 @@
 #include "slam-precomp.h"  // Precompiled headerss
 
 #include <mrpt/slam/CMonteCarloLocalization2D.h>
+#include <mrpt/slam/CBranchAndBoundScanMatcher.h>
 
 #include <mrpt/system/CTicTac.h>
 #include <mrpt/maps/COccupancyGridMap2D.h>
+#include <mrpt/maps/CSimplePointsMap.h>
 #include <mrpt/obs/CActionCollection.h>
 #include <mrpt/obs/CSensoryFrame.h>
 
@@ -295,3 +297,31 @@ void CMonteCarloLocalization2D::resetUniformFreeSpace(
 
 	MRPT_END
 }
+
+/*---------------------------------------------------------------
+					resetFromGlobalScanMatch
+  ---------------------------------------------------------------*/
+bool CMonteCarloLocalization2D::resetFromGlobalScanMatch(
+	const COccupancyGridMap2D& theMap, const CSensoryFrame& sf,
+	const CBranchAndBoundScanMatcher& matcher, const int particlesCount,
+	const double spread_xy, const double spread_phi_rad)
+{
+	MRPT_START
+
+	CSimplePointsMap points;
+	points.insertionOptions.minDistBetweenLaserPoints = theMap.getResolution();
+	points.insertionOptions.isPlanarMap = true;
+	sf.insertObservationsInto(&points);
+
+	CBranchAndBoundScanMatcher::TResult res;
+	if (!matcher.matchGlobal(theMap, points, res)) return false;
+
+	const size_t M = particlesCount > 0 ? static_cast<size_t>(particlesCount)
+										: m_particles.size();
+	resetAroundSetOfPoses(
+		std::vector<TPose2D>(1, res.pose), std::max<size_t>(M, 1), spread_xy,
+		spread_xy, spread_phi_rad);
+	return true;
+
+	MRPT_END
+}
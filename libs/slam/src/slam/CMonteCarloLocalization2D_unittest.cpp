@@ -12,6 +12,11 @@
 #include <mrpt/slam/CMonteCarloLocalization2D.h>
 #include <mrpt/maps/CMultiMetricMap.h>
 #include <mrpt/maps/CSimpleMap.h>
+#include <mrpt/maps/COccupancyGridMap2D.h>
+#include <mrpt/obs/CActionCollection.h>
+#include <mrpt/obs/CActionRobotMovement2D.h>
+#include <mrpt/obs/CObservation2DRangeScan.h>
+#include <mrpt/obs/CSensoryFrame.h>
 #include <mrpt/obs/CRawlog.h>
 #include <mrpt/system/filesystem.h>
 #include <mrpt/system/os.h>
@@ -313,3 +318,92 @@ TEST(MonteCarlo2D, RunSampleDataset)
 
 	FAIL() << "Failed to converge after 3 opportunities!!" << endl;
 }
+
+// Runs a few MCL steps on a synthetic map with the given number of threads,
+// always from the same random seed. With nRuns>1, the same filter is run
+// again from scratch, re-seeding the global random generator.
+static void run_mcl_synthetic(
+	const unsigned int numThreads, std::vector<TPose2D>& outPoses,
+	std::vector<double>& outLogW, const int nRuns = 1)
+{
+	// A scan as seen from the center of a round room with some clutter:
+	auto scan = mrpt::make_aligned_shared<CObservation2DRangeScan>();
+	scan->aperture = M_PIf;
+	scan->resizeScanAndAssign(181, 3.0f, true);
+	for (size_t i = 60; i < 80; i++) scan->setScanRange(i, 1.5f);
+
+	COccupancyGridMap2D grid(-5, 5, -5, 5, 0.05f);
+	const CPose3D pose0;
+	grid.insertObservation(scan.get(), &pose0);
+
+	CSensoryFrame sf;
+	sf.insert(scan);
+
+	CActionCollection acts;
+	{
+		CActionRobotMovement2D act;
+		act.computeFromOdometry(
+			CPose2D(0.05, 0, 0), CActionRobotMovement2D::TMotionModelOptions());
+		acts.insert(act);
+	}
+
+	const size_t M = 500;
+	CMonteCarloLocalization2D pdf(M);
+	pdf.options.metricMap = &grid;
+
+	CParticleFilter PF;
+	PF.m_options.adaptiveSampleSize = false;
+	PF.m_options.PF_algorithm = CParticleFilter::pfStandardProposal;
+	PF.m_options.numThreads = numThreads;
+
+	for (int run = 0; run < nRuns; run++)
+	{
+		getRandomGenerator().randomize(1234);
+		pdf.resetUniform(-0.5, 0.5, -0.5, 0.5, -M_PI, M_PI, M);
+		for (int step = 0; step < 5; step++) PF.executeOn(pdf, &acts, &sf);
+	}
+
+	outPoses.clear();
+	outLogW.clear();
+	for (const auto& p : pdf.m_particles)
+	{
+		outPoses.push_back(p.d);
+		outLogW.push_back(p.log_w);
+	}
+}
+
+TEST(MonteCarlo2D, ParallelExecutionIsDeterministic)
+{
+	std::vector<TPose2D> poses2, poses3;
+	std::vector<double> w2, w3;
+	run_mcl_synthetic(2, poses2, w2);
+	run_mcl_synthetic(3, poses3, w3);
+
+	ASSERT_EQ(poses2.size(), poses3.size());
+	for (size_t i = 0; i < poses2.size(); i++)
+	{
+		EXPECT_EQ(poses2[i].x, poses3[i].x);
+		EXPECT_EQ(poses2[i].y, poses3[i].y);
+		EXPECT_EQ(poses2[i].phi, poses3[i].phi);
+		EXPECT_EQ(w2[i], w3[i]);
+	}
+}
+
+TEST(MonteCarlo2D, ParallelExecutionIsReproducible)
+{
+	// Re-seeding the global generator reproduces the run, also on the same
+	// filter object:
+	std::vector<TPose2D> poses1, poses2;
+	std::vector<double> w1, w2;
+	run_mcl_synthetic(2, poses1, w1);
+	run_mcl_synthetic(2, poses2, w2, 2 /*nRuns*/);
+
+	ASSERT_EQ(poses1.size(), poses2.size());
+	for (size_t i = 0; i < poses1.size(); i++)
+	{
+		EXPECT_EQ(poses1[i].x, poses2[i].x);
+		EXPECT_EQ(poses1[i].y, poses2[i].y);
+		EXPECT_EQ(poses1[i].phi, poses2[i].phi);
+		EXPECT_EQ(w1[i], w2[i]);
+	}
+}
@@ -0,0 +1,154 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace mrpt::system
+{
+/** A simple thread pool: a fixed set of worker threads that execute tasks
+ * from a FIFO queue.
+ *
+ * Tasks are submitted with enqueue(), which returns a std::future for the
+ * task result (or exception). parallel_for() is a convenience to split an
+ * index range [0,N) into contiguous blocks, one per worker, and wait for all
+ * of them.
+ *
+ * \note [New in MRPT 1.9.9]
+ * \ingroup mrpt_system_grp
+ */
+class thread_pool
+{
+   public:
+	/** Creates \a num_threads workers. If 0, as many workers as hardware
+	 * threads are created (at least one). */
+	thread_pool(std::size_t num_threads = 0);
+
+	/** Waits for all queued tasks to finish, then joins all workers. */
+	~thread_pool();
+
+	thread_pool(const thread_pool&) = delete;
+	thread_pool& operator=(const thread_pool&) = delete;
+
+	/** Number of worker threads */
+	std::size_t size() const { return m_threads.size(); }
+
+	/** Number of tasks waiting in the queue (not yet started) */
+	std::size_t pendingTasks() const;
+
+	/** Queues a task for execution in the next free worker.
+	 * \return A future to wait for the task and get its result. Exceptions
+	 * thrown by the task are rethrown from std::future::get().
+	 */
+	template <class F, class... Args>
+	auto enqueue(F&& f, Args&&... args)
+		-> std::future<std::invoke_result_t<F, Args...>>
+	{
+		using return_type = std::invoke_result_t<F, Args...>;
+
+		auto task = std::make_shared<std::packaged_task<return_type()>>(
+			std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+
+		std::future<return_type> res = task->get_future();
+		{
+			std::unique_lock<std::mutex> lock(m_queue_mutex);
+			m_tasks.emplace_back([task]() { (*task)(); });
+		}
+		m_condition.notify_one();
+		return res;
+	}
+
+	/** Whether the calling thread is one of the workers of this pool */
+	bool isWorkerThread() const;
+
+	/** Runs `func(first,last)` for contiguous blocks of indices covering the
+	 * range [0,N), and blocks until all of them are done. There are
+	 * \a max_blocks blocks (0: one per worker in the pool), or N if smaller.
+	 * The split only depends on N and the number of blocks, so a given index
+	 * is always processed in the same block.
+	 * If any block throws, the first exception (in block order) is rethrown
+	 * after all blocks have finished.
+	 * If called from one of the workers of this same pool (nested
+	 * parallelism), all the range is processed in the calling thread, to
+	 * avoid deadlocks.
+	 */
+	template <class FUNC>
+	void parallel_for(
+		const std::size_t N, FUNC&& func, const std::size_t max_blocks = 0)
+	{
+		if (!N) return;
+		const std::size_t nBlocks =
+			std::min(N, max_blocks != 0 ? max_blocks : size());
+		if (nBlocks <= 1 || isWorkerThread())
+		{
+			func(std::size_t(0), N);
+			return;
+		}
+		std::vector<std::future<void>> futs;
+		futs.reserve(nBlocks);
+		for (std::size_t b = 0; b < nBlocks; b++)
+		{
+			const std::size_t first = (N * b) / nBlocks;
+			const std::size_t last = (N * (b + 1)) / nBlocks;
+			futs.emplace_back(
+				enqueue([&func, first, last]() { func(first, last); }));
+		}
+		// Wait for all before propagating errors, since blocks reference
+		// data in the caller stack:
+		for (auto& f : futs) f.wait();
+		for (auto& f : futs) f.get();
+	}
+
+   private:
+	std::vector<std::thread> m_threads;
+	std::list<std::function<void()>> m_tasks;
+	mutable std::mutex m_queue_mutex;
+	std::condition_variable m_condition;
+	std::atomic_bool m_do_stop{false};
+};
+
+/** Returns the process-wide pool shared by all the MRPT algorithms with a
+ * `numThreads` option, with one worker per hardware thread. Sharing it
+ * avoids oversubscribing the CPU when several of those algorithms run at
+ * once. It is created on first use and lives until the program exits.
+ * \sa parallel_for
+ * \ingroup mrpt_system_grp
+ */
+thread_pool& shared_thread_pool();
+
+/** Runs `func(first,last)` for contiguous blocks of indices covering the
+ * range [0,N) in the shared_thread_pool(), split into \a numThreads blocks
+ * (0: one per worker), or directly in the calling thread if \a numThreads
+ * is 1. See thread_pool::parallel_for().
+ * \ingroup mrpt_system_grp
+ */
+template <class FUNC>
+void parallel_for(
+	const std::size_t N, const unsigned int numThreads, FUNC&& func)
+{
+	if (numThreads == 1)
+	{
+		if (N) func(std::size_t(0), N);
+		return;
+	}
+	shared_thread_pool().parallel_for(N, std::forward<FUNC>(func), numThreads);
+}
+
+}  // namespace mrpt::system
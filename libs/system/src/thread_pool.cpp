@@ -0,0 +1,74 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "system-precomp.h"  // Precompiled headers
+
+#include <mrpt/system/thread_pool.h>
+#include <algorithm>
+
+using namespace mrpt::system;
+
+// The pool the current thread is a worker of, if any:
+static thread_local const thread_pool* current_worker_pool = nullptr;
+
+thread_pool::thread_pool(std::size_t num_threads)
+{
+	if (num_threads == 0)
+		num_threads = std::max(1U, std::thread::hardware_concurrency());
+
+	m_threads.reserve(num_threads);
+	for (std::size_t i = 0; i < num_threads; i++)
+	{
+		m_threads.emplace_back([this]() {
+			current_worker_pool = this;
+			for (;;)
+			{
+				std::function<void()> task;
+				{
+					std::unique_lock<std::mutex> lock(m_queue_mutex);
+					m_condition.wait(lock, [this]() {
+						return m_do_stop || !m_tasks.empty();
+					});
+					if (m_do_stop && m_tasks.empty()) return;
+					task = std::move(m_tasks.front());
+					m_tasks.pop_front();
+				}
+				task();
+			}
+		});
+	}
+}
+
+thread_pool::~thread_pool()
+{
+	{
+		std::unique_lock<std::mutex> lock(m_queue_mutex);
+		m_do_stop = true;
+	}
+	m_condition.notify_all();
+	for (auto& t : m_threads)
+		if (t.joinable()) t.join();
+}
+
+std::size_t thread_pool::pendingTasks() const
+{
+	std::unique_lock<std::mutex> lock(m_queue_mutex);
+	return m_tasks.size();
+}
+
+bool thread_pool::isWorkerThread() const
+{
+	return current_worker_pool == this;
+}
+
+thread_pool& mrpt::system::shared_thread_pool()
+{
+	static thread_pool pool;
+	return pool;
+}
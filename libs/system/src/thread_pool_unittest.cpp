@@ -0,0 +1,74 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/system/thread_pool.h>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <stdexcept>
+
+TEST(thread_pool, enqueue)
+{
+	mrpt::system::thread_pool pool(3);
+	EXPECT_EQ(pool.size(), 3u);
+
+	std::vector<std::future<int>> futs;
+	for (int i = 0; i < 20; i++)
+		futs.emplace_back(pool.enqueue([](int x) { return x * x; }, i));
+	for (int i = 0; i < 20; i++) EXPECT_EQ(futs[i].get(), i * i);
+}
+
+TEST(thread_pool, parallel_for)
+{
+	for (std::size_t nThreads = 1; nThreads <= 4; nThreads++)
+	{
+		mrpt::system::thread_pool pool(nThreads);
+		const std::size_t N = 1001;
+		std::vector<int> v(N, 0);
+		pool.parallel_for(N, [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; i++) v[i] += int(i);
+		});
+		for (std::size_t i = 0; i < N; i++) EXPECT_EQ(v[i], int(i));
+	}
+}
+
+TEST(thread_pool, parallel_for_exception)
+{
+	mrpt::system::thread_pool pool(2);
+	EXPECT_THROW(
+		pool.parallel_for(
+			10,
+			[](std::size_t first, std::size_t) {
+				if (first == 0) throw std::runtime_error("err");
+			}),
+		std::runtime_error);
+}
+
+TEST(thread_pool, shared_pool)
+{
+	auto& pool = mrpt::system::shared_thread_pool();
+	EXPECT_EQ(&pool, &mrpt::system::shared_thread_pool());
+	EXPECT_GE(pool.size(), 1u);
+	EXPECT_FALSE(pool.isWorkerThread());
+
+	// Any number of blocks, and nested parallelism (run inline):
+	for (unsigned int nThreads : {0U, 1U, 2U, 7U})
+	{
+		const std::size_t N = 100;
+		std::vector<int> v(N, 0);
+		mrpt::system::parallel_for(
+			N, nThreads, [&](std::size_t first, std::size_t last) {
+				mrpt::system::parallel_for(
+					last - first, 0, [&](std::size_t f, std::size_t l) {
+						for (std::size_t i = first + f; i < first + l; i++)
+							v[i] += int(i);
+					});
+			});
+		for (std::size_t i = 0; i < N; i++) EXPECT_EQ(v[i], int(i));
+	}
+}